@@ -40,9 +40,115 @@
 #include "detect/SWFaceDetection.h"
 #include "mesh/SWMesh.h"
 
+#include "devices/SWFramePipeline.h"
+
+#include <boost/thread/mutex.hpp>
+
 typedef boost::shared_ptr<swDetect::SWStasm> SWStasmPtr; /**< boost shared pointer for SWStasm */
 typedef boost::shared_ptr<swDetect::SWFaceDetection> SWFaceDetectionPtr; /**< boost shared pointer for SWFaceDetection */
 
+/**
+ * \class SWDebugImageSink
+ * \brief Receives the intermediate images of the avatar construction, the default sink ignores them.
+ */
+class SWDebugImageSink
+{
+    public :
+
+        /**
+         * \brief SWDebugImageSink destructor
+         */
+        virtual ~SWDebugImageSink(){}
+
+        /**
+         * \brief Handle an intermediate image, does nothing.
+         * \param [in] sPath  : image path
+         * \param [in] oImage : image, can be modified by the caller after the call
+         */
+        virtual void save(const std::string &sPath, const cv::Mat &oImage){}
+};
+
+typedef boost::shared_ptr<SWDebugImageSink> SWDebugImageSinkPtr; /**< boost shared pointer for SWDebugImageSink */
+
+/**
+ * \struct SWDebugImage
+ * \brief Image waiting to be written by SWAsyncDebugImageWriter
+ */
+struct SWDebugImage
+{
+    std::string m_sPath;    /**< image path */
+    cv::Mat m_oImage;       /**< image copy */
+};
+
+/**
+ * \class SWAsyncDebugImageWriter
+ * \brief Writes the intermediate images on a background thread.
+ *        The images are copied in a bounded queue, they are dropped when the queue is full so the avatar construction never waits for the encoding.
+ */
+class SWAsyncDebugImageWriter : public SWDebugImageSink
+{
+    public :
+
+        /**
+         * \brief SWAsyncDebugImageWriter constructor, launch the writing thread
+         * \param [in] ui32Capacity : maximum number of images waiting to be written
+         */
+        SWAsyncDebugImageWriter(cuint ui32Capacity = 16);
+
+        /**
+         * \brief SWAsyncDebugImageWriter destructor, the images already queued are written before the end of the thread
+         */
+        virtual ~SWAsyncDebugImageWriter();
+
+        /**
+         * \brief Queue a copy of the image, or drop it if the queue is full.
+         * \param [in] sPath  : image path
+         * \param [in] oImage : image
+         */
+        virtual void save(const std::string &sPath, const cv::Mat &oImage);
+
+        /**
+         * \brief Return the number of images dropped because the queue was full.
+         */
+        uint droppedImagesNb() const;
+
+        /**
+         * \brief Return the number of images which could not be written.
+         */
+        uint failedImagesNb() const;
+
+    private :
+
+        /**
+         * \brief Writing thread loop.
+         */
+        void doWrite();
+
+        uint m_ui32Capacity;                                /**< capacity of the queue */
+        uint m_ui32DroppedImagesNb;                         /**< number of dropped images, only modified by the producer */
+        uint m_ui32FailedImagesNb;                          /**< number of failed writings, only modified by the writing thread */
+
+        swDevice::SWFrameQueue<SWDebugImage> m_oQueue;      /**< images waiting to be written */
+        boost::thread m_oWritingThread;                     /**< writing thread */
+};
+
+/**
+ * \struct SWAvatarFrame
+ * \brief Data computed from one rgbd frame by SWCreateAvatar::prepareCloud and used by SWCreateAvatar::integrateCloud
+ */
+struct SWAvatarFrame
+{
+    cv::Mat m_oRgb;                                 /**< rgb image resized to the depth size */
+    cv::Mat m_oDepth;                               /**< depth cloud map */
+    cv::Mat m_oRgbForeGround;                       /**< rgb image without the background */
+    cv::Rect m_oRectFace;                           /**< face rectangle */
+    cv::Rect m_oRectNose;                           /**< nose rectangle */
+    swCloud::SWCloud m_oFaceCloud;                  /**< face cloud */
+    swCloud::SWCloud m_oNoseCloud;                  /**< nose cloud */
+    bool m_bStasmComputed;                          /**< have the stasm points been computed for this frame ? */
+    std::vector<cv::Point3f> m_vP3FStasm3DPoints;   /**< stasm 3D points */
+};
+
 /**
  * \class SWCreateAvatar
  * \brief Use rgbd device data to create a 3D avatar
@@ -105,6 +211,23 @@ class SWCreateAvatar
          */
         bool addCloudToAvatar(const cv::Mat &oRgb, const cv::Mat &oDepth);
 
+        /**
+         * @brief First part of addCloudToAvatar : detect the face and the nose and build the face and nose clouds.
+         *  Can be called in another thread than integrateCloud, the frames must be integrated in the same order.
+         * @param [in] oRgb    : input rgb image
+         * @param [in] oDepth  : input depth image
+         * @param [out] oFrame : computed frame data
+         * @return false if the face has never been detected, else return true
+         */
+        bool prepareCloud(const cv::Mat &oRgb, const cv::Mat &oDepth, SWAvatarFrame &oFrame);
+
+        /**
+         * @brief Second part of addCloudToAvatar : align the frame clouds with the reference and add the face cloud to the total face cloud
+         * @param [in] oFrame : frame data computed by prepareCloud
+         * @return false if the cloud has been rejected, else return true
+         */
+        bool integrateCloud(const SWAvatarFrame &oFrame);
+
         /**
          * @brief constructAvatar
          */
@@ -158,6 +281,19 @@ class SWCreateAvatar
          */
         void setUseStasm(cbool bUseStasm);
 
+        /**
+         * @brief setSaveDebugImages, save the texture and the intermediate radial projections in the data directory
+         *  with a SWAsyncDebugImageWriter (disabled by default)
+         * @param bSaveDebugImages
+         */
+        void setSaveDebugImages(cbool bSaveDebugImages);
+
+        /**
+         * @brief setDebugImageSink, set the sink receiving the texture and the intermediate radial projections
+         * @param [in] pDebugImageSink : sink, a NULL pointer disables the debug images
+         */
+        void setDebugImageSink(SWDebugImageSinkPtr pDebugImageSink);
+
         /**
          * @brief setErodeValue
          * @param ui32Erode
@@ -221,9 +357,17 @@ class SWCreateAvatar
 
     private:
 
+        /**
+         * @brief Give an intermediate image of the avatar construction to the debug images sink
+         * @param [in] sPath  : image path
+         * @param [in] oImage : image to save
+         */
+        void saveDebugImage(const std::string &sPath, const cv::Mat &oImage) const;
+
         // parameters
         //  miscellaneous
         bool m_bVerbose;                        /**< enable verbose display info mode */
+        SWDebugImageSinkPtr m_pDebugImageSink;  /**< receives the texture and the radial projection steps images, does nothing by default */
         //  alignment
         float m_fTemplateDownScale;             /**< template cloud reduction scale */
         float m_fTargetDownScale;               /**< target cloud reduction scale*/
@@ -254,6 +398,7 @@ class SWCreateAvatar
         // alignment
         swCloud::SWCloudBBox m_oCloudFaceBBox;              /**< face cloud bbox */
         swCloud::SWCloud m_oFaceCloudRef;                   /**< face cloud reference used for alignment */
+        swCloud::SWCloudIndex m_oFaceCloudRefIndex;         /**< index of the face cloud reference, built once per capture for the alignment score */
         swCloud::SWCloud m_oNoseCloudRef;                   /**< nose cloud reference used for alignment */
         swCloud::SWAlignClouds m_oAlignClouds;              /**< swooz clouds alignment */
 
@@ -273,6 +418,7 @@ class SWCreateAvatar
 //        std::vector<cv::Point3f> m_vP3FTotalStasm3DPoints;  /**< sum of array of stasms 3D points*/
         std::vector<std::vector<cv::Point3f> > m_vStasm3DPoints;  /**< sum of array of stasms 3D points*/
         std::vector<int> m_vMeshIdSTASMPoints;              /**< ... */
+        boost::mutex m_oStasmMutex;                         /**< protects m_vStasm3DPoints between prepareCloud and integrateCloud */
 
 
     public:
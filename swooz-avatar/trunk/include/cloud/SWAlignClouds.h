@@ -38,6 +38,7 @@
 #include "commonTypes.h"
 #include "emicp/3dregistration.h"
 #include "cloud/SWCloud.h"
+#include "filterUtility.h"
 #include <list>
 
 namespace swCloud
@@ -111,6 +112,18 @@ namespace swCloud
              */
             void setSmoothingParams(cuint ui32K = 5, cfloat fSmoothTransConst = 50.f, cfloat fSmoothRotConst = 50.f);
 
+            /**
+             * \brief Set the low-latency filter of the rigid motion (One-Euro or alpha-beta predictor on the translation and the rotation angles),
+             *        if enabled it replaces the K window smoothing.
+             * \param [in] oParams : filter parameters
+             */
+            void setMotionFilter(const swUtil::SWFilterParams &oParams);
+
+            /**
+             * \brief Reset the state of the rigid motion filter, the next rigid motion will be sent untouched.
+             */
+            void resetMotionFilter();
+
             /**
              * \brief launch the alignement of the template cloud and the target cloud
              */
@@ -166,6 +179,8 @@ namespace swCloud
             SWRigidMotion m_oRigidMotion;                   /**< last computed rigid motion */
             SWRigidMotion m_oSmoothedRigidMotion;           /**< last computed smoothed rigid motion */
             std::list<SWRigidMotion> m_lRigidMotion;        /**< list of the K last computed rigid motions */
+            swUtil::SWSignalFilter m_oMotionFilter;         /**< filter of the translation and the rotation angles */
+            SWRigidMotion m_oFilteredRigidMotion;           /**< last computed filtered rigid motion */
 
             // clouds
             SWCloud *m_oTemplate;                           /**< template cloud */
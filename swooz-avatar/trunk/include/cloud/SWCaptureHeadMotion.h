@@ -35,14 +35,57 @@
 #define _SWCAPTUREHEADMOTION_
 
 #include "devices/rgbd/SWKinectParams.h"
+#include "devices/SWFramePipeline.h"
 #include "cloud/SWAlignClouds.h"
 #include "detect/SWFaceDetection.h"
 
+#include "boost/date_time/posix_time/posix_time.hpp"
+
 
 typedef boost::shared_ptr<swDetect::SWFaceDetection> SWFaceDetectionPtr;	/**< boost shared pointer for SWFaceDetection */
+typedef boost::shared_ptr<swCloud::SWCloud> SWCloudPtr;	/**< boost shared pointer for SWCloud */
 
 namespace swCloud
 {	
+    /**
+     * \struct SWHeadMotionTimings
+     * \brief Times in ms spent by each stage of a head motion computing.
+     */
+    struct SWHeadMotionTimings
+    {
+        SWHeadMotionTimings() : m_dBackground(0.), m_dFaceDetection(0.), m_dNose(0.), m_dCloud(0.), m_dAlignment(0.), m_dLatency(0.)
+        {}
+
+        double m_dBackground;       /**< background removal */
+        double m_dFaceDetection;    /**< face detection */
+        double m_dNose;             /**< nose detection and nose tip search */
+        double m_dCloud;            /**< face cloud creation */
+        double m_dAlignment;        /**< reference cloud initialization or emicp alignment */
+        double m_dLatency;          /**< time between the input of the frame and the rigid motion result */
+    };
+
+    /**
+     * \struct SWHeadDetection
+     * \brief Result of the detection stage for one frame, input of the alignment stage.
+     */
+    struct SWHeadDetection
+    {
+        SWHeadDetection() : m_i32Status(-1), m_ui32FrameId(0), m_oInputTime(boost::posix_time::microsec_clock::local_time())
+        {}
+
+        int m_i32Status;                        /**< -1 : face not detected, 1 : the face cloud is valid */
+        uint m_ui32FrameId;                     /**< id of the input frame */
+
+        boost::posix_time::ptime m_oInputTime;  /**< input time of the frame, used for the latency */
+
+        cv::Rect m_oFaceRect;                   /**< face rectangle used for the cloud */
+        cv::Rect m_oNoseRect;                   /**< rectangle around the nose tip used for the cloud */
+        cv::Mat m_oDisplayDetectFace;           /**< face detection display rgb image */
+
+        SWCloudPtr m_pFaceCloud;                /**< face cloud to align */
+        SWHeadMotionTimings m_oTimings;         /**< times of the detection stage */
+    };
+
 	/**
 	 * \class SWCaptureHeadMotion
      * \brief Capture Head motion from rgbd device using haarcascade for face detection and emicp to compute the head
@@ -82,8 +125,28 @@ namespace swCloud
             int computeHeadMotion(SWRigidMotion &oHeadRigidMotion, const cv::Mat &oRgb, const cv::Mat &oDepth, cv::Mat &oDisplayDetectFace,
                                   cv::Point3f oNoseTip = cv::Point3f(0.f,0.f,0.f));
 
+            /**
+             * \brief Detection stage of computeHeadMotion : background removal, face and nose detection, nose tip search and face cloud creation.
+             *  Only uses the detection data of the class, it can run on another thread than alignHead (see SWHeadMotionPipeline).
+             *
+             * \param [out] oDetection : detection result
+             * \param [in] oRgb        : input rgb image
+             * \param [in] oDepth      : input depth image
+             * \return -1 : face not detected and no previous face rectangle, 1 : success
+             */
+            int detectHead(SWHeadDetection &oDetection, const cv::Mat &oRgb, const cv::Mat &oDepth);
+
+            /**
+             * \brief Alignment stage of computeHeadMotion : the first valid detection inits the reference cloud, the next ones are aligned on it.
+             *
+             * \param [out] oHeadRigidMotion   : result computed head rigid motion
+             * \param [in] oDetection          : result of detectHead
+             * \return same values as computeHeadMotion
+             */
+            int alignHead(SWRigidMotion &oHeadRigidMotion, const SWHeadDetection &oDetection);
+
 			/**
-             * \brief reset reference cloud
+             * \brief reset reference cloud, must not be called while a SWHeadMotionPipeline is running
 			 */			
             void reset();
 
@@ -103,6 +166,12 @@ namespace swCloud
             void setParameters(cdouble dTemplateCoeffReduc, cdouble dTargetCoeffReduc, cdouble dScoreComputingReduc,
                                cint i32KSmooth = 5, cdouble dKTransSmooth = 50., cdouble dKRotSmooth = 50.,
                                cdouble dP2 = -1., cdouble dINF = -1., cdouble dFactor = -1., cdouble dD02 = -1.);
+
+            /**
+             * @brief Set the low-latency filter of the head rigid motion, if enabled it replaces the K smoothing of setParameters
+             * @param [in] oParams : filter parameters
+             */
+            void setMotionFilter(const swUtil::SWFilterParams &oParams);
 						
             /**
              * @brief Return the rectangle used for the alignment computing
@@ -111,6 +180,11 @@ namespace swCloud
              */
             void getRect(cv::Rect &oFaceRect, cv::Rect &oNoseRect);
 
+            /**
+             * @brief Return the stage times of the last alignHead / computeHeadMotion call
+             */
+            SWHeadMotionTimings lastTimings() const;
+
 
             // DEBUG
                 swCloud::SWCloud debugFaceCloudRef()const{return m_oFaceCloudRef;}
@@ -139,6 +213,8 @@ namespace swCloud
             cv::Rect m_oNoseRectToDisplay;              /**< nose rectangle returned by getRect */
             cv::Rect m_oLastDetectedRectFace;           /**< last detected face rectangle */
 
+            SWHeadMotionTimings m_oLastTimings;         /**< stage times of the last result */
+
             swCloud::SWRigidMotion m_oLastRigidMotion;
 
             swCloud::SWCloud m_oFaceCloudRef;           /**< reference face cloud */
@@ -148,6 +224,98 @@ namespace swCloud
             SWAlignClouds m_oAlignClouds;
             SWFaceDetectionPtr m_CFaceDetectPtr;        /**< detect face pointer */
 	};
+
+
+    /**
+     * \struct SWHeadMotionFrame
+     * \brief Rgbd frame waiting for the detection stage of a SWHeadMotionPipeline.
+     */
+    struct SWHeadMotionFrame
+    {
+        uint m_ui32FrameId;                     /**< id of the frame */
+        boost::posix_time::ptime m_oInputTime;  /**< input time of the frame */
+        cv::Mat m_oRgb;                         /**< rgb image */
+        cv::Mat m_oDepth;                       /**< depth image */
+    };
+
+    /**
+     * \class SWHeadMotionPipeline
+     * \brief Run the detection stage of a SWCaptureHeadMotion on its own thread, so the detection of the next frames
+     *  overlaps the alignment of the current one, which is done on the caller thread.
+     *
+     *  Two modes :
+     *      - default : every frame is processed, at most ui32Depth frames are waiting in the pipeline, a result is delayed by ui32Depth calls,
+     *      - low latency : the calls do not wait, a frame not yet started by the detection stage is replaced by the newer one
+     *        and a call aligns the most recent detection if there is a new one, the stale ones are skipped (ui32Depth is not used).
+     *        The source frame id given with the frame tells if it is new, a call with the id of the previous frame only polls the results.
+     *  The input mats are shallow copied, they must not be modified after the call.
+     */
+    class SWHeadMotionPipeline
+    {
+        public :
+
+            /**
+             * \brief SWHeadMotionPipeline constructor, launch the detection thread
+             * \param [in] pCaptureHeadMotion : capture head motion used by the 2 stages, must not be used elsewhere while the pipeline is alive
+             * \param [in] ui32Depth          : number of frames detected ahead of the alignment (>= 1)
+             * \param [in] bLowLatency        : skip the stale frames
+             */
+            SWHeadMotionPipeline(SWCaptureHeadMotion *pCaptureHeadMotion, cuint ui32Depth = 1, cbool bLowLatency = false);
+
+            /**
+             * \brief SWHeadMotionPipeline destructor, stop the detection thread
+             */
+            ~SWHeadMotionPipeline();
+
+            /**
+             * \brief Add a frame to the pipeline and compute the head rigid motion of a previous one.
+             *
+             * \param [out] oHeadRigidMotion   : result computed head rigid motion
+             * \param [in] oRgb                : input rgb image
+             * \param [in] oDepth              : input depth image
+             * \param [out] oDisplayDetectFace : face detection display rgb image of the result frame
+             * \param [in] i32SourceFrameId    : id of the frame given by the source (ex : device frame counter), used by the low latency mode
+             *                                   to not detect the same frame twice, -1 : the frame is always new
+             * \return 2 : no result yet (the pipeline is filling), otherwise same values as SWCaptureHeadMotion::computeHeadMotion
+             */
+            int computeHeadMotion(SWRigidMotion &oHeadRigidMotion, const cv::Mat &oRgb, const cv::Mat &oDepth, cv::Mat &oDisplayDetectFace, cint i32SourceFrameId = -1);
+
+            /**
+             * \brief Id of the frame of the last result, the first frame has the id 0
+             */
+            uint lastResultFrameId() const;
+
+            /**
+             * \brief Number of input frames skipped by the low latency mode
+             */
+            uint skippedFramesNb();
+
+        private :
+
+            /**
+             * \brief Work function of the detection thread.
+             * \param [out] oDetection : detection of the next input frame
+             * \return 1 if a frame has been detected, 0 if no frame is available
+             */
+            int detectionStage(SWHeadDetection &oDetection);
+
+            bool m_bLowLatency;                                         /**< skip the stale frames ? */
+            uint m_ui32Depth;                                           /**< number of frames detected ahead of the alignment */
+            uint m_ui32InputFramesNb;                                   /**< number of input frames */
+            uint m_ui32ResultsNb;                                       /**< number of results retrieved */
+            uint m_ui32LastResultFrameId;                               /**< id of the frame of the last result */
+
+            SWCaptureHeadMotion *m_pCaptureHeadMotion;                  /**< capture head motion */
+
+            int m_i32LastSourceFrameId;                                 /**< low latency mode : source id of the last input frame, the same frame is not detected twice */
+
+            swDevice::SWFrameQueue<SWHeadMotionFrame>   m_oInputQueue;      /**< default mode : frames waiting for the detection */
+            swDevice::SWLatestFrame<SWHeadMotionFrame>  m_oLatestInput;     /**< low latency mode : newest frame waiting for the detection */
+            swDevice::SWFrameQueue<SWHeadDetection>     m_oDetectionQueue;  /**< default mode : detections waiting for the alignment */
+            swDevice::SWLatestFrame<SWHeadDetection>    m_oLatestDetection; /**< low latency mode : newest detection */
+
+            swDevice::SWFrameStage_thread<SWHeadDetection> m_oDetectionStage; /**< detection thread */
+    };
 }
 		
 
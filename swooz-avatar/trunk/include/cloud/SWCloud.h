@@ -76,6 +76,7 @@
 
 #include "commonTypes.h"
 #include <vector>
+#include <cfloat>
 
 //! namespace for classes based on the use of SWCloud
 namespace swCloud
@@ -548,13 +549,14 @@ namespace swCloud
 			bool transform(cfloat *m_aFRotationMatrix, cfloat *m_aFTranslationMatrix);
 			
 			/**
-             * \brief compute a "distanc" value of the cloud from the input cloud
+             * \brief compute a "distanc" value of the cloud from the input cloud (the cloud is indexed for each call, use SWCloudIndex
+             *        to index a reference cloud only once)
 			 * \param [in] oCloud          : input cloud
              * \param [in] bReduce         : reduce the cloud ?
-			 * \param [in] ui32CoeffReduce : reduce factor of the cloud
+			 * \param [in] ui32CoeffReduce : reduce factor of the cloud (one point out of ui32CoeffReduce is used)
 			 * \return the square distance mean	 
 			 */				
-			float squareDistanceCloud(const SWCloud &oCloud, cbool bReduce = false, cfloat ui32CoeffReduce = 50);
+			float squareDistanceCloud(const SWCloud &oCloud, cbool bReduce = false, cfloat ui32CoeffReduce = 50) const;
 			
 			/**
 			 * \brief get the distance of the point from the cloud
@@ -645,6 +647,102 @@ namespace swCloud
 			 */				
             void upSize(cuint ui32SizeToAdd = 0);
 	};
+
+    /**
+     * \struct SWCloudDistanceStats
+     * \brief Statistics of the square distances between the points of a cloud and their nearest points in a reference cloud.
+     */
+    struct SWCloudDistanceStats
+    {
+        uint  m_ui32SamplesNb;  /**< number of points of the cloud used */
+        float m_fMean;          /**< mean of the square distances */
+        float m_fMedian;        /**< median of the square distances */
+        float m_fTrimmedMean;   /**< mean of the lowest square distances (see the trim ratio) */
+        float m_fInlierRatio;   /**< ratio of the points whose square distance is below the inlier threshold */
+    };
+
+    /**
+     * \class SWCloudIndex
+     * \brief Uniform grid on the points of a reference cloud for exact nearest point queries.
+     *        Build it once when the reference cloud is defined and query it for each new cloud, the queries are thread safe.
+     */
+    class SWCloudIndex
+    {
+        public:
+
+            /**
+             * \brief Default constructor of SWCloudIndex, the index is empty.
+             */
+            SWCloudIndex();
+
+            /**
+             * \brief Build the index on the points of the reference cloud (the coordinates are copied), O(n).
+             * \param [in] oCloud : reference cloud
+             */
+            void build(const SWCloud &oCloud);
+
+            /**
+             * \brief Erase the index.
+             */
+            void clear();
+
+            /**
+             * \brief Return the number of indexed points.
+             */
+            uint size() const;
+
+            /**
+             * \brief Compute the square distance between the input point and its nearest point in the reference cloud.
+             * \param [in] fX, fY, fZ : input point
+             * \param [out] pI32Id    : if not NULL, id of the nearest point in the reference cloud (-1 if the index is empty)
+             * \return the square distance, FLT_MAX if the index is empty
+             */
+            float squareDistancePoint(cfloat fX, cfloat fY, cfloat fZ, int *pI32Id = NULL) const;
+
+            /**
+             * \brief Compute the mean square distance between the points of the input cloud and the reference cloud (parallel and deterministic).
+             * \param [in] oCloud    : input cloud
+             * \param [in] ui32Step  : only one point out of ui32Step of the input cloud is used
+             * \return the square distance mean
+             */
+            float squareDistanceCloud(const SWCloud &oCloud, cuint ui32Step = 1) const;
+
+            /**
+             * \brief Compute robust statistics of the square distances between the points of the input cloud and the reference cloud.
+             * \param [in] oCloud            : input cloud
+             * \param [out] oStats           : statistics
+             * \param [in] ui32Step          : only one point out of ui32Step of the input cloud is used
+             * \param [in] fInlierSquareDist : square distance threshold of the inliers
+             * \param [in] fTrimRatio        : ratio of the lowest square distances used for the trimmed mean
+             */
+            void squareDistanceStats(const SWCloud &oCloud, SWCloudDistanceStats &oStats, cuint ui32Step = 1,
+                                     cfloat fInlierSquareDist = FLT_MAX, cfloat fTrimRatio = 0.9f) const;
+
+        private:
+
+            /**
+             * \brief Compute the square distances of the sampled points of the input cloud in parallel.
+             */
+            void squareDistances(const SWCloud &oCloud, cuint ui32Step, std::vector<float> &vSquareDistances) const;
+
+            /**
+             * \brief Return the id of a grid cell.
+             */
+            int cellId(cint i32X, cint i32Y, cint i32Z) const;
+
+            /**
+             * \brief Update the nearest point with the points of a grid cell.
+             */
+            void searchCell(cint i32CellId, cfloat fX, cfloat fY, cfloat fZ, float &fMinDist, int &i32MinId) const;
+
+            float m_fCellSize;              /**< size of the grid cells */
+            float m_aFMin[3];               /**< origin of the grid */
+            int m_aI32CellsNb[3];           /**< number of cells of the grid along each axis */
+
+            std::vector<uint> m_vCellsStart;/**< id of the first point of each cell in m_vPoints, cells number + 1 values */
+            std::vector<float> m_vPoints;   /**< coordinates of the points sorted by cell [x1,y1,z1,x2,...] */
+            std::vector<uint> m_vIds;       /**< id in the reference cloud of each sorted point */
+    };
 }
 
 #endif
@@ -42,57 +42,80 @@ namespace swImage
 	namespace swUtil
 	{		
         /**
-         * @brief return a rgb mat image with the background colored
-         * @param [in] oRgb      : input RGB mat image
-         * @param [in] oDepth    : input Depth mat image
+         * @brief compute the foreground mask of a depth image in one row pass (1 : foreground, 0 : background or no depth)
+         * @param [in] oDepth    : input Depth mat image (CV_16U in mm or CV_32FC3 cloud in m)
          * @param [in] fDepthMin : minimum depth value before a point is considered as a member of the background
-         * @param [in] i32DilatationBackground : dilation value used to fill holes
-         * @param [in] v3bColor  : color used for background pixels
-         * @return a new mat rgb image
+         * @param [out] oMask    : CV_8U mask with the size of the depth image
          */
-        static cv::Mat removeBackground(const cv::Mat &oRgb, const cv::Mat &oDepth, cfloat fDepthMin = 1.1, cint i32DilatationBackground = 3, const cv::Vec3b v3bColor = cv::Vec3b(122,122,122))
+        static void foregroundMask(const cv::Mat &oDepth, cfloat fDepthMin, cv::Mat &oMask)
         {
-            cv::Mat l_oFore = oRgb.clone();
-            cv::Mat l_oMask(oRgb.rows, oRgb.cols, CV_32F, cv::Scalar(1.f));
+            oMask.create(oDepth.rows, oDepth.cols, CV_8U);
 
             if(oDepth.depth() == CV_16U && oDepth.channels() == 1)
             {
-                for(int ii = 0; ii < oDepth.rows * oDepth.cols ; ++ii)
+                const float l_fDepthMin = fDepthMin*1000;
+
+                for(int ii = 0; ii < oDepth.rows; ++ii)
                 {
-                    if(oDepth.at<unsigned short >(ii) > fDepthMin*1000 ||
-                       oDepth.at<unsigned short >(ii) == 0)
+                    const unsigned short *l_pDepthRow = oDepth.ptr<unsigned short>(ii);
+                    uchar *l_pMaskRow = oMask.ptr<uchar>(ii);
+
+                    for(int jj = 0; jj < oDepth.cols; ++jj)
                     {
-                        l_oMask.at<float>(ii) = 0.f;
+                        l_pMaskRow[jj] = (l_pDepthRow[jj] > l_fDepthMin || l_pDepthRow[jj] == 0) ? 0 : 1;
                     }
                 }
             }
             else
             {
-                for(int ii = 0; ii < oDepth.rows * oDepth.cols ; ++ii)
+                for(int ii = 0; ii < oDepth.rows; ++ii)
                 {
-                    if(oDepth.at<cv::Vec3f>(ii)[2] > fDepthMin ||
-                       oDepth.at<cv::Vec3f>(ii)[2] == 0)
+                    const cv::Vec3f *l_pDepthRow = oDepth.ptr<cv::Vec3f>(ii);
+                    uchar *l_pMaskRow = oMask.ptr<uchar>(ii);
+
+                    for(int jj = 0; jj < oDepth.cols; ++jj)
                     {
-                        l_oMask.at<float>(ii) = 0.f;
+                        float l_fDepth = l_pDepthRow[jj][2];
+                        l_pMaskRow[jj] = (l_fDepth > fDepthMin || l_fDepth == 0) ? 0 : 1;
                     }
                 }
             }
+        }
+
+        /**
+         * @brief return a rgb mat image with the background colored
+         * @param [in] oRgb      : input RGB mat image
+         * @param [in] oDepth    : input Depth mat image
+         * @param [in] fDepthMin : minimum depth value before a point is considered as a member of the background
+         * @param [in] i32DilatationBackground : dilation value used to fill holes
+         * @param [in] v3bColor  : color used for background pixels
+         * @return a new mat rgb image
+         */
+        static cv::Mat removeBackground(const cv::Mat &oRgb, const cv::Mat &oDepth, cfloat fDepthMin = 1.1, cint i32DilatationBackground = 3, const cv::Vec3b v3bColor = cv::Vec3b(122,122,122))
+        {
+            cv::Mat l_oFore = oRgb.clone();
 
+            cv::Mat l_oMask;
+            foregroundMask(oDepth, fDepthMin, l_oMask);
             cv::dilate(l_oMask, l_oMask, cv::Mat(), cv::Point(-1,-1), i32DilatationBackground);
 
-            for(int ii = 0; ii < l_oMask.rows * l_oMask.cols; ++ii)
+            for(int ii = 0; ii < l_oMask.rows; ++ii)
             {
-                if(l_oMask.at<float>(ii) < 1.f)
+                const uchar *l_pMaskRow = l_oMask.ptr<uchar>(ii);
+                cv::Vec3b *l_pForeRow = l_oFore.ptr<cv::Vec3b>(ii);
+
+                for(int jj = 0; jj < l_oMask.cols; ++jj)
                 {
-                    l_oFore.at<cv::Vec3b>(ii) = v3bColor;
+                    if(!l_pMaskRow[jj])
+                    {
+                        l_pForeRow[jj] = v3bColor;
+                    }
                 }
             }
 
-
             return l_oFore;
         }
 
-
 				
 		/**
          * \brief  Scale an opencv rectangle by two value
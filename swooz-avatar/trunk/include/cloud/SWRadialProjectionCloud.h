@@ -803,15 +803,15 @@ namespace swCloud
     static void retrieveTextureCoordFromRadialProj(const std::vector<float> &vFX, const std::vector<float> &vFY, const SWCloudBBox &sBBoxFaceCloud,
                                                    std::vector<std::vector<float> > &v2FTextureCoord)
     {
-        v2FTextureCoord.clear();
+        int l_i32VertexNb = static_cast<int>(vFX.size());
+        v2FTextureCoord.assign(l_i32VertexNb, std::vector<float>(2));
 
-        for(uint ii = 0; ii < vFX.size(); ++ii)
+        #pragma omp parallel for
+        for(int ii = 0; ii < l_i32VertexNb; ++ii)
         {
             // compute relative texture coordinate
-            std::vector<float> l_vCoord2D(2);
-            l_vCoord2D[0] = (vFX[ii] - sBBoxFaceCloud.m_fMinX )/check0Div(sBBoxFaceCloud.m_fMaxX - sBBoxFaceCloud.m_fMinX);
-            l_vCoord2D[1] = (vFY[ii] - sBBoxFaceCloud.m_fMinY )/check0Div(sBBoxFaceCloud.m_fMaxY - sBBoxFaceCloud.m_fMinY);
-            v2FTextureCoord.push_back(l_vCoord2D);
+            v2FTextureCoord[ii][0] = (vFX[ii] - sBBoxFaceCloud.m_fMinX )/check0Div(sBBoxFaceCloud.m_fMaxX - sBBoxFaceCloud.m_fMinX);
+            v2FTextureCoord[ii][1] = (vFY[ii] - sBBoxFaceCloud.m_fMinY )/check0Div(sBBoxFaceCloud.m_fMaxY - sBBoxFaceCloud.m_fMinY);
         }
     }
 
@@ -873,120 +873,158 @@ namespace swCloud
 
 
     /**
-     * @brief retrieveFacesFromRadialProj2
-     * @param oIndexMask
-     * @param oDepthVertex
-     * @param v3UIFacesId
+     * @brief radialProjQuadFaces, compute the triangles of the quad defined by the pixels (ii,jj), (ii,jj+1), (ii+1,jj), (ii+1,jj+1)
+     *  of the vertex index mat
+     * @param [in] aI32IdRow        : vertex index of the row ii (0 : no vertex)
+     * @param [in] aI32IdNextRow    : vertex index of the row ii+1
+     * @param [in] aFDepthRow       : vertex depth of the row ii
+     * @param [in] aFDepthNextRow   : vertex depth of the row ii+1
+     * @param [in] i32J             : column jj
+     * @param [out] aUI32Faces      : index of the triangles of the quad, can be NULL if only the number is needed
+     * @return the number of triangles (0, 1 or 2)
      */
-    static void retrieveFacesFromRadialProj2(const cv::Mat &oIndexMask, const cv::Mat &oDepthVertex, std::vector<std::vector<uint> > &v3UIFacesId)
+    static int radialProjQuadFaces(const int *aI32IdRow, const int *aI32IdNextRow, const float *aFDepthRow, const float *aFDepthNextRow,
+                                   cint i32J, uint *aUI32Faces)
     {
-        v3UIFacesId.clear();
-
-        for(int ii = 0; ii < oIndexMask.rows-1; ++ii)
+        // 1 - 2
+        // |   |
+        // 3 - 4
+        uint l_ui1 = (uint)aI32IdRow[i32J],     l_ui2 = (uint)aI32IdRow[i32J+1];
+        uint l_ui3 = (uint)aI32IdNextRow[i32J], l_ui4 = (uint)aI32IdNextRow[i32J+1];
+        bool l_b1 = l_ui1 != 0, l_b2 = l_ui2 != 0, l_b3 = l_ui3 != 0, l_b4 = l_ui4 != 0;
+        uint l_aUI32Faces[6];
+
+        // . - .
+        // |   |
+        // . - .
+        if(l_b1 && l_b2 && l_b3 && l_b4)
         {
-            for(int jj = 0; jj < oIndexMask.cols-1; ++jj)
+            if(aUI32Faces)
             {
-                std::vector<uint> l_vFace1(3), l_vFace2(3);
-
-                // 1 - 2
-                // |   |
-                // 3 - 4
-                bool l_b1 = oIndexMask.at<int>(ii,jj)    != 0;
-                bool l_b2 = oIndexMask.at<int>(ii,jj+1)  != 0;
-                bool l_b3 = oIndexMask.at<int>(ii+1,jj)  != 0;
-                bool l_b4 = oIndexMask.at<int>(ii+1,jj+1)!= 0;
-
-                // . - .
-                // |   |
-                // . - .
-                if(l_b1 && l_b2 && l_b3 && l_b4)
-                {
-                    float l_fDiff14 = oDepthVertex.at<float>(ii,jj) - oDepthVertex.at<float>(ii+1,jj+1);
-                    l_fDiff14 *= l_fDiff14;
+                float l_fDiff14 = aFDepthRow[i32J] - aFDepthNextRow[i32J+1];
+                l_fDiff14 *= l_fDiff14;
 
-                    float l_fDiff23 = oDepthVertex.at<float>(ii,jj+1) - oDepthVertex.at<float>(ii+1,jj);
-                    l_fDiff23 *= l_fDiff23;
+                float l_fDiff23 = aFDepthRow[i32J+1] - aFDepthNextRow[i32J];
+                l_fDiff23 *= l_fDiff23;
 
-                    if(l_fDiff14 > l_fDiff23)
-                    {
-                        // 1 - 2
-                        //   \ |
-                        //     4
-                        l_vFace1[0] = (uint)oIndexMask.at<int>(ii,jj);
-                        l_vFace1[1] = (uint)oIndexMask.at<int>(ii+1,jj+1);
-                        l_vFace1[2] = (uint)oIndexMask.at<int>(ii,jj+1);
-                        v3UIFacesId.push_back(l_vFace1);
-
-                        // 1
-                        // | \
-                        // 3 - 4
-                        l_vFace2[0] = (uint)oIndexMask.at<int>(ii,jj);
-                        l_vFace2[1] = (uint)oIndexMask.at<int>(ii+1,jj);
-                        l_vFace2[2] = (uint)oIndexMask.at<int>(ii+1,jj+1);
-                        v3UIFacesId.push_back(l_vFace2);
-                    }
-                    else
-                    {
-                        // 1 - 2
-                        // | /
-                        // 3
-                        l_vFace1[0] = (uint)oIndexMask.at<int>(ii,jj);
-                        l_vFace1[1] = (uint)oIndexMask.at<int>(ii+1,jj);
-                        l_vFace1[2] = (uint)oIndexMask.at<int>(ii,jj+1);
-                        v3UIFacesId.push_back(l_vFace1);
-
-                        //     2
-                        //   / |
-                        // 3 - 4
-                        l_vFace2[0] = (uint)oIndexMask.at<int>(ii,jj+1);
-                        l_vFace2[1] = (uint)oIndexMask.at<int>(ii+1,jj);
-                        l_vFace2[2] = (uint)oIndexMask.at<int>(ii+1,jj+1);
-                        v3UIFacesId.push_back(l_vFace2);
-                    }
-                }
-                // . - .
-                // |   |
-                // x - .
-                else if(l_b1 && l_b2 && l_b4)
+                if(l_fDiff14 > l_fDiff23)
                 {
-                    l_vFace1[0] = (uint)oIndexMask.at<int>(ii,jj);
-                    l_vFace1[1] = (uint)oIndexMask.at<int>(ii+1,jj+1);
-                    l_vFace1[2] = (uint)oIndexMask.at<int>(ii,jj+1);
-                    v3UIFacesId.push_back(l_vFace1);
+                    // 1 - 2        1
+                    //   \ |        | \
+                    //     4        3 - 4
+                    aUI32Faces[0] = l_ui1; aUI32Faces[1] = l_ui4; aUI32Faces[2] = l_ui2;
+                    aUI32Faces[3] = l_ui1; aUI32Faces[4] = l_ui3; aUI32Faces[5] = l_ui4;
                 }
-                // . - .
-                // |   |
-                // . - x
-                else if(l_b1 && l_b2 && l_b3)
+                else
                 {
-                    l_vFace1[0] = (uint)oIndexMask.at<int>(ii,jj);
-                    l_vFace1[1] = (uint)oIndexMask.at<int>(ii+1,jj);
-                    l_vFace1[2] = (uint)oIndexMask.at<int>(ii,jj+1);
-
-                    v3UIFacesId.push_back(l_vFace1);
+                    // 1 - 2            2
+                    // | /            / |
+                    // 3            3 - 4
+                    aUI32Faces[0] = l_ui1; aUI32Faces[1] = l_ui3; aUI32Faces[2] = l_ui2;
+                    aUI32Faces[3] = l_ui2; aUI32Faces[4] = l_ui3; aUI32Faces[5] = l_ui4;
                 }
-                // . - x
-                // |   |
-                // . - .
-                else if(l_b1 && l_b3 && l_b4)
+            }
+
+            return 2;
+        }
+
+        // . - .
+        // |   |
+        // x - .
+        if(l_b1 && l_b2 && l_b4)
+        {
+            l_aUI32Faces[0] = l_ui1; l_aUI32Faces[1] = l_ui4; l_aUI32Faces[2] = l_ui2;
+        }
+        // . - .
+        // |   |
+        // . - x
+        else if(l_b1 && l_b2 && l_b3)
+        {
+            l_aUI32Faces[0] = l_ui1; l_aUI32Faces[1] = l_ui3; l_aUI32Faces[2] = l_ui2;
+        }
+        // . - x
+        // |   |
+        // . - .
+        else if(l_b1 && l_b3 && l_b4)
+        {
+            l_aUI32Faces[0] = l_ui1; l_aUI32Faces[1] = l_ui3; l_aUI32Faces[2] = l_ui4;
+        }
+        // x - .
+        // |   |
+        // . - .
+        else if(l_b2 && l_b3 && l_b4)
+        {
+            l_aUI32Faces[0] = l_ui2; l_aUI32Faces[1] = l_ui3; l_aUI32Faces[2] = l_ui4;
+        }
+        else
+        {
+            return 0;
+        }
+
+        if(aUI32Faces)
+        {
+            aUI32Faces[0] = l_aUI32Faces[0]; aUI32Faces[1] = l_aUI32Faces[1]; aUI32Faces[2] = l_aUI32Faces[2];
+        }
+
+        return 1;
+    }
+
+    /**
+     * @brief retrieveFacesFromRadialProj2, build the triangles of the vertex index mat, row after row.
+     *  Two parallel passes : the triangles of each row are counted, then written at the offset given by the prefix sum of the counts,
+     *  the result is the same as a sequential walk of the mat.
+     * @param [in] oIndexMask    : vertex index mat (CV_32S, 0 : no vertex)
+     * @param [in] oDepthVertex  : vertex depth mat (CV_32F)
+     * @param [out] v3UIFacesId  : triangles index
+     */
+    static void retrieveFacesFromRadialProj2(const cv::Mat &oIndexMask, const cv::Mat &oDepthVertex, std::vector<std::vector<uint> > &v3UIFacesId)
+    {
+        int l_i32RowsNb = std::max(oIndexMask.rows - 1, 0);
+        std::vector<int> l_vRowFacesOffset(l_i32RowsNb + 1, 0);
+
+        // count the triangles of each row
+            #pragma omp parallel for
+            for(int ii = 0; ii < l_i32RowsNb; ++ii)
+            {
+                const int *l_aI32IdRow = oIndexMask.ptr<int>(ii), *l_aI32IdNextRow = oIndexMask.ptr<int>(ii+1);
+                int l_i32FacesNb = 0;
+
+                for(int jj = 0; jj < oIndexMask.cols-1; ++jj)
                 {
-                    l_vFace1[0] = (uint)oIndexMask.at<int>(ii,jj);
-                    l_vFace1[1] = (uint)oIndexMask.at<int>(ii+1,jj);
-                    l_vFace1[2] = (uint)oIndexMask.at<int>(ii+1,jj+1);
-                    v3UIFacesId.push_back(l_vFace1);
+                    l_i32FacesNb += radialProjQuadFaces(l_aI32IdRow, l_aI32IdNextRow, NULL, NULL, jj, NULL);
                 }
-                // x - .
-                // |   |
-                // . - .
-                else if(l_b2 && l_b3 && l_b4)
+
+                l_vRowFacesOffset[ii+1] = l_i32FacesNb;
+            }
+
+            for(int ii = 0; ii < l_i32RowsNb; ++ii)
+            {
+                l_vRowFacesOffset[ii+1] += l_vRowFacesOffset[ii];
+            }
+
+        // fill the triangles of each row at its offset
+            v3UIFacesId.assign(l_vRowFacesOffset[l_i32RowsNb], std::vector<uint>(3));
+
+            #pragma omp parallel for
+            for(int ii = 0; ii < l_i32RowsNb; ++ii)
+            {
+                const int *l_aI32IdRow = oIndexMask.ptr<int>(ii), *l_aI32IdNextRow = oIndexMask.ptr<int>(ii+1);
+                const float *l_aFDepthRow = oDepthVertex.ptr<float>(ii), *l_aFDepthNextRow = oDepthVertex.ptr<float>(ii+1);
+                int l_i32IdFace = l_vRowFacesOffset[ii];
+                uint l_aUI32Faces[6];
+
+                for(int jj = 0; jj < oIndexMask.cols-1; ++jj)
                 {
-                    l_vFace1[0] = (uint)oIndexMask.at<int>(ii,jj+1);
-                    l_vFace1[1] = (uint)oIndexMask.at<int>(ii+1,jj);
-                    l_vFace1[2] = (uint)oIndexMask.at<int>(ii+1,jj+1);
-                    v3UIFacesId.push_back(l_vFace1);
+                    int l_i32FacesNb = radialProjQuadFaces(l_aI32IdRow, l_aI32IdNextRow, l_aFDepthRow, l_aFDepthNextRow, jj, l_aUI32Faces);
+
+                    for(int kk = 0; kk < l_i32FacesNb; ++kk, ++l_i32IdFace)
+                    {
+                        v3UIFacesId[l_i32IdFace][0] = l_aUI32Faces[3*kk];
+                        v3UIFacesId[l_i32IdFace][1] = l_aUI32Faces[3*kk+1];
+                        v3UIFacesId[l_i32IdFace][2] = l_aUI32Faces[3*kk+2];
+                    }
                 }
             }
-        }
     }
 
     /**
@@ -1012,101 +1050,109 @@ namespace swCloud
 
             float l_fMaxHeight = (oTotalCloudBBox.m_fMaxY - oTotalCloudBBox.m_fMinY);
 
-        // vector containing the vertex coordinates
-            std::vector<float> l_vFX, l_vFY, l_vFZ;
-
-        // mat containing index of the vertex
-            cv::Mat l_oIdVertex 	 = oRadialProj.clone();
+        // mat containing index of the vertex (0 : no vertex)
+            cv::Mat l_oIdVertex(oRadialProj.rows, oRadialProj.cols, CV_32SC1, cv::Scalar(0));
         // mat containing the depth of the vertex
-            cv::Mat l_oIdVertexDepth = oRadialProj.clone();
+            cv::Mat l_oIdVertexDepth(oRadialProj.rows, oRadialProj.cols, CV_32FC1, cv::Scalar(0.f));
+        // mat containing the coordinates of the vertex
+            cv::Mat l_oVertexCoords(oRadialProj.rows, oRadialProj.cols, CV_32FC3);
 
-        uint l_ui32CurrVertex = 0;
-        for(int ii = 0; ii < oRadialProj.rows; ++ii)
-        {
-            for(int jj = 0; jj < oRadialProj.cols; ++jj)
+        // first pass : compute the vertices of each row, the index mat receives the index of the vertex in its row
+            std::vector<int> l_vRowVertexOffset(oRadialProj.rows + 1, 0);
+
+            #pragma omp parallel for
+            for(int ii = 0; ii < oRadialProj.rows; ++ii)
             {
-                if(oRadialProj.at<float>(ii,jj) > 0.f)
+                const float *l_aFRadialProj = oRadialProj.ptr<float>(ii);
+                int *l_aI32IdVertex         = l_oIdVertex.ptr<int>(ii);
+                float *l_aFIdVertexDepth    = l_oIdVertexDepth.ptr<float>(ii);
+                cv::Vec3f *l_aV3FCoords     = l_oVertexCoords.ptr<cv::Vec3f>(ii);
+                int l_i32RowVertexNb        = 0;
+
+                for(int jj = 0; jj < oRadialProj.cols; ++jj)
                 {
-                    float l_fAlpha = 360.f * jj/(ui32WidthImage*1.f);
-                    float l_fAngle,l_fDist, l_fX, l_fY, l_fZ;
+                    if(l_aFRadialProj[jj] > 0.f)
+                    {
+                        float l_fAlpha = 360.f * jj/(ui32WidthImage*1.f);
+                        float l_fAngle,l_fDist, l_fX, l_fY, l_fZ;
 
-                    int l_i32SensX, l_i32SensZ;
+                        int l_i32SensX, l_i32SensZ;
 
-                    // localisation of the projection on the cylinder for computing the angle and the distance
-                        if(l_fAlpha < 90.f)
-                        {
-                            l_fAngle = l_fAlpha;
-                            l_i32SensX = 1;
-                            l_i32SensZ = 1;
-                        }
-                        else if(l_fAlpha < 180.f)
-                        {
-                            l_fAngle = 180-l_fAlpha;
-                            l_i32SensX = 1;
-                            l_i32SensZ = -1;
-                        }
-                        else if(l_fAlpha < 270.f)
-                        {
-                            l_fAngle = l_fAlpha - 180;
-                            l_i32SensX = -1;
-                            l_i32SensZ = -1;
-                        }
-                        else
+                        // localisation of the projection on the cylinder for computing the angle and the distance
+                            if(l_fAlpha < 90.f)
+                            {
+                                l_fAngle = l_fAlpha;
+                                l_i32SensX = 1;
+                                l_i32SensZ = 1;
+                            }
+                            else if(l_fAlpha < 180.f)
+                            {
+                                l_fAngle = 180-l_fAlpha;
+                                l_i32SensX = 1;
+                                l_i32SensZ = -1;
+                            }
+                            else if(l_fAlpha < 270.f)
+                            {
+                                l_fAngle = l_fAlpha - 180;
+                                l_i32SensX = -1;
+                                l_i32SensZ = -1;
+                            }
+                            else
+                            {
+                                l_fAngle = 360 - l_fAlpha;
+                                l_i32SensX = -1;
+                                l_i32SensZ = 1;
+                            }
+
+                            l_fAngle /= (180.f/(float)M_PI);
+                            l_fDist = (l_aFRadialProj[jj]/255.f) * fCylinderRadius;
+
+                        // update current vertex coordinates
+                            l_fX = l_oAxePoint[0] + sin(l_fAngle) * l_fDist * l_i32SensX;
+                            l_fY = (-ii + 1.f*ui32HeightImage)/(ui32HeightImage*1.f/l_fMaxHeight) + oTotalCloudBBox.m_fMinY;
+                            l_fZ = l_oAxePoint[2] + cos(l_fAngle) * l_fDist * l_i32SensZ;
+
+                        if(oBBoxFaceCloud.isInside(l_fX, l_fY))
                         {
-                            l_fAngle = 360 - l_fAlpha;
-                            l_i32SensX = -1;
-                            l_i32SensZ = 1;
+                            l_aV3FCoords[jj]        = cv::Vec3f(l_fX, l_fY, l_fZ);
+                            l_aFIdVertexDepth[jj]   = l_fZ;
+                            l_aI32IdVertex[jj]      = ++l_i32RowVertexNb;
                         }
+                    }
+                }
 
-                        l_fAngle /= (180.f/(float)M_PI);
-                        l_fDist = (oRadialProj.at<float>(ii,jj)/255.f) * fCylinderRadius;
+                l_vRowVertexOffset[ii+1] = l_i32RowVertexNb;
+            }
 
-                    // update current vertex coordinates
-                        l_fX = l_oAxePoint[0] + sin(l_fAngle) * l_fDist * l_i32SensX;
-                        l_fY = (-ii + 1.f*ui32HeightImage)/(ui32HeightImage*1.f/l_fMaxHeight) + oTotalCloudBBox.m_fMinY;
-                        l_fZ = l_oAxePoint[2] + cos(l_fAngle) * l_fDist * l_i32SensZ;
+            for(int ii = 0; ii < oRadialProj.rows; ++ii)
+            {
+                l_vRowVertexOffset[ii+1] += l_vRowVertexOffset[ii];
+            }
 
+        // second pass : the vertices are numbered in the order of the mat (from 1) and written in the preallocated arrays
+            int l_i32VertexNb = l_vRowVertexOffset[oRadialProj.rows];
+            std::vector<std::vector<float> > l_vVertexCoords(l_i32VertexNb, std::vector<float>(3));
+            std::vector<float> l_vFX(l_i32VertexNb), l_vFY(l_i32VertexNb);
 
-                    bool l_bInsideFaceBBox = oBBoxFaceCloud.isInside(l_fX, l_fY);
+            #pragma omp parallel for
+            for(int ii = 0; ii < oRadialProj.rows; ++ii)
+            {
+                int *l_aI32IdVertex             = l_oIdVertex.ptr<int>(ii);
+                const cv::Vec3f *l_aV3FCoords   = l_oVertexCoords.ptr<cv::Vec3f>(ii);
+                int l_i32RowOffset              = l_vRowVertexOffset[ii];
 
-                    if(l_bInsideFaceBBox)
+                for(int jj = 0; jj < oRadialProj.cols; ++jj)
+                {
+                    if(l_aI32IdVertex[jj] != 0)
                     {
-                        // add vertex coordinates in the arrays
-                            l_vFX.push_back(l_fX);
-                            l_vFY.push_back(l_fY);
-                            l_vFZ.push_back(l_fZ);
-
-                        // update index of the current vertex
-                            l_ui32CurrVertex++;
+                        l_aI32IdVertex[jj] += l_i32RowOffset;
 
-                        // update mat containing the index and the depth
-                            l_oIdVertex.at<int>(ii,jj) 	  = l_ui32CurrVertex;
-                            l_oIdVertexDepth.at<float>(ii,jj) = l_fZ;
-                    }
-                    else
-                    {
-                        l_oIdVertex.at<int>(ii,jj) 	 = 0;
-                        l_oIdVertexDepth.at<float>(ii,jj)= 0;
+                        int l_i32Id = l_aI32IdVertex[jj] - 1;
+                        l_vVertexCoords[l_i32Id][0] = l_vFX[l_i32Id] = l_aV3FCoords[jj][0];
+                        l_vVertexCoords[l_i32Id][1] = l_vFY[l_i32Id] = l_aV3FCoords[jj][1];
+                        l_vVertexCoords[l_i32Id][2] = l_aV3FCoords[jj][2];
                     }
                 }
-                else
-                {
-                    // if there is no vertex on the current location
-                        l_oIdVertex.at<int>(ii,jj) 	 = 0;
-                        l_oIdVertexDepth.at<float>(ii,jj)= 0;
-                }
-            }
-        }
-
-        // retrive vertex coordinates
-            std::vector<std::vector<float> > l_vVertexCoords;
-            for(uint ii = 0; ii < l_vFX.size(); ++ii)
-            {
-                std::vector<float> l_vP(3);
-                l_vP[0] = l_vFX[ii];
-                l_vP[1] = l_vFY[ii];
-                l_vP[2] = l_vFZ[ii];
-                l_vVertexCoords.push_back(l_vP);
             }
 
         // retrieve faces index
@@ -37,9 +37,17 @@
 #include "opencv2/imgproc/imgproc.hpp"
 
 
+#define SW_MAT_BACKEND_GPU 0 /**< matrix utilities computed with CUDA/CULA (gpuMat.cu) */
+#define SW_MAT_BACKEND_CPU 1 /**< matrix utilities computed on the CPU (cpuMat.cpp) */
+
+// GPU functions, not available when SW_CPU_MAT is defined
+#ifndef SW_CPU_MAT
+
 int doCulaSgesv(float *aFInputMat, float *aFOutputInvMat, int i32SizeSquareMat);
 //int doCulaSgesv(float *aFInputMat, float *aFOutputInvMat, int i32N, int i32NRHS);
 
+int doCulaSolve(float *aFMatA, float *aFMatB, int i32N, int i32NRHS, bool bSymmetricPositive);
+
 void transpose(float *idata, float *odata, int size_x, int size_y);
 
 void matMult(const Matrix A, const Matrix B, Matrix C, const int blockSize = 16);
@@ -48,10 +56,132 @@ void cudaDummyCall();
 
 int LUDecomposition(float *aFMat, int i32SizeSquareMat);
 
+#endif
+
+// CPU functions
+
+/**
+ * \brief Return the backend used by the swCuda functions (SW_MAT_BACKEND_GPU or SW_MAT_BACKEND_CPU).
+ *
+ * Default is GPU, or CPU if SW_CPU_MAT is defined or if the SW_MAT_BACKEND environment variable is set to "cpu".
+ */
+int matBackend();
+
+/**
+ * \brief Set the backend used by the swCuda functions.
+ * \param [in] i32Backend : SW_MAT_BACKEND_GPU or SW_MAT_BACKEND_CPU
+ */
+void setMatBackend(int i32Backend);
+
+/**
+ * \brief Cache-blocked multithreaded matrix multiplication C = A*B (row-major matrices).
+ */
+void cpuMatMult(const Matrix A, const Matrix B, Matrix C);
+
+/**
+ * \brief Solve A*X = B with a LU decomposition (column-major matrices, A is overwritten by its LU factors and B by X)
+ * \return 0 if success, -1 if A is singular
+ */
+int cpuSgesv(float *aFA, float *aFB, int i32N, int i32NRHS);
+
+/**
+ * \brief Solve A*X = B with a Cholesky decomposition (column-major matrices, A must be symmetric positive definite, A is overwritten and B by X)
+ * \return 0 if success, -1 if A is not positive definite
+ */
+int cpuSposv(float *aFA, float *aFB, int i32N, int i32NRHS);
+
 namespace swUtil
 {
     namespace swCuda
     {
+        /**
+         * \brief Matrix multiplication with the current backend.
+         * \param [in]  A         : input A matrix
+         * \param [in]  B         : input B matrix
+         * \param [out] C         : res C matrix
+         * \param [in]  blockSize : CUDA block size
+         */
+        static void multiply(const Matrix A, const Matrix B, Matrix C, const int blockSize = 16)
+        {
+#ifndef SW_CPU_MAT
+            if(matBackend() == SW_MAT_BACKEND_GPU)
+            {
+                matMult(A, B, C, blockSize);
+                return;
+            }
+#endif
+            cpuMatMult(A, B, C);
+        }
+
+        /**
+         * \brief Resolve A*X = B without computing the inverse of A, much faster than matrixInversion followed by matrixMultiplication.
+         * \param [in]  oMatA              : input square matrix
+         * \param [in]  oMatB              : input B matrix
+         * \param [out] oMatX              : output float X matrix
+         * \param [in]  bSymmetricPositive : if true A is considered symmetric positive definite and a Cholesky decomposition is used instead of a LU
+         * \return false if the system can't be solved
+         */
+        static bool solve(const cv::Mat &oMatA, const cv::Mat &oMatB, cv::Mat &oMatX, cbool bSymmetricPositive = false)
+        {
+            cv::Mat l_oA, l_oB;
+            oMatA.convertTo(l_oA, CV_32FC1);
+            oMatB.convertTo(l_oB, CV_32FC1);
+
+            int l_i32N = l_oA.rows, l_i32NRHS = l_oB.cols;
+
+            // column-major copies
+            float *l_aFA = new float[l_i32N * l_i32N];
+            float *l_aFX = new float[l_i32N * l_i32NRHS];
+
+            for(int ii = 0; ii < l_i32N; ++ii)
+            {
+                const float *l_aFRowA = l_oA.ptr<float>(ii);
+                for(int jj = 0; jj < l_i32N; ++jj)
+                {
+                    l_aFA[jj * l_i32N + ii] = l_aFRowA[jj];
+                }
+
+                const float *l_aFRowB = l_oB.ptr<float>(ii);
+                for(int jj = 0; jj < l_i32NRHS; ++jj)
+                {
+                    l_aFX[jj * l_i32N + ii] = l_aFRowB[jj];
+                }
+            }
+
+            int l_i32Status;
+#ifndef SW_CPU_MAT
+            if(matBackend() == SW_MAT_BACKEND_GPU)
+            {
+                l_i32Status = doCulaSolve(l_aFA, l_aFX, l_i32N, l_i32NRHS, bSymmetricPositive);
+            }
+            else
+#endif
+            if(bSymmetricPositive)
+            {
+                l_i32Status = cpuSposv(l_aFA, l_aFX, l_i32N, l_i32NRHS);
+            }
+            else
+            {
+                l_i32Status = cpuSgesv(l_aFA, l_aFX, l_i32N, l_i32NRHS);
+            }
+
+            delete[] l_aFA;
+
+            oMatX = cv::Mat(l_i32N, l_i32NRHS, CV_32FC1);
+            for(int ii = 0; ii < l_i32N; ++ii)
+            {
+                float *l_aFRowX = oMatX.ptr<float>(ii);
+                for(int jj = 0; jj < l_i32NRHS; ++jj)
+                {
+                    l_aFRowX[jj] = l_aFX[jj * l_i32N + ii];
+                }
+            }
+
+            delete[] l_aFX;
+
+            return l_i32Status == 0;
+        }
+
         /**
          * \brief GPU matrix inversion.
          * \param [in]  oInput   : float input square matrix
@@ -82,8 +212,17 @@ namespace swUtil
                 }
             }
 
-            // compute inverse mat            
-            doCulaSgesv(l_aFDataIn, l_aFDataOut, oInput.rows);
+            // compute inverse mat
+#ifndef SW_CPU_MAT
+            if(matBackend() == SW_MAT_BACKEND_GPU)
+            {
+                doCulaSgesv(l_aFDataIn, l_aFDataOut, oInput.rows);
+            }
+            else
+#endif
+            {
+                cpuSgesv(l_aFDataIn, l_aFDataOut, oInput.rows, oInput.rows);
+            }
             delete[] l_aFDataIn;
 
             // fill result mat
@@ -207,7 +346,7 @@ namespace swUtil
                 }
             }
 
-            matMult(A, B, C, l_i32BlockSize);
+            multiply(A, B, C, l_i32BlockSize);
 
             delete[] A.elements;
             delete[] B.elements;
@@ -357,7 +496,7 @@ namespace swUtil
 
                             block(oMatB, subB.elements, kk, jj, subB.height, subB.width);
 
-                            matMult(subA, subB, subC);
+                            multiply(subA, subB, subC);
 
                             for(int ll = 0; ll < subC.height* subC.width; ++ll)
                             {
@@ -501,7 +640,7 @@ namespace swUtil
 
                         block(oSMatB, subB.elements, kk, jj, subB.height, subB.width);
 
-                        matMult(subA, subB, subC);
+                        multiply(subA, subB, subC);
 
                         for(int ll = 0; ll < subC.height* subC.width; ++ll)
                         {
@@ -114,9 +114,7 @@ class SWGLCloudWidget : public SWGLWidget
 
 //        QReadWriteLock m_oCloudMutex;
 
-        QGLBuffer m_vertexBufferCloud;       /**< ... */
-        QGLBuffer m_indexBufferCloud;        /**< ... */
-        QGLBuffer m_colorBufferCloud;        /**< ... */
+        SWGLCloudRenderer m_oCloudRenderer;  /**< buffers and draw calls of the cloud */
 
         bool m_bInitCamWithCloudPosition; /**< init the camera with the cloud bbox at the first frame */
         bool m_bApplyRigidMotion;   /**< ... */
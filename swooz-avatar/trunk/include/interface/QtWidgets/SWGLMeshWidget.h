@@ -131,10 +131,7 @@ class SWGLMeshWidget : public SWGLWidget
 
         QImage m_oTexture;
 
-        QGLBuffer m_vertexBufferMesh; /**< ... */
-        QGLBuffer m_indexBufferMesh; /**< ... */
-        QGLBuffer m_normalBufferMesh; /**< ... */
-        QGLBuffer m_textureBufferMesh; /**< ... */
+        SWGLMeshRenderer m_oMeshRenderer; /**< buffers and draw calls of the mesh */
 
         GLuint m_textureLocation;
         GLuint m_texHandle;
@@ -47,11 +47,17 @@
 #include <boost/shared_ptr.hpp>
 
 #include <QReadWriteLock>
+#include <QAtomicInt>
+#include <QTime>
 
 typedef boost::shared_ptr<swCloud::SWCloud> SWCloudPtr;	/**< boost shared pointer for SWCloud */
 
 typedef boost::shared_ptr<QGLBuffer> QGLBufferPtr;
 
+typedef boost::shared_ptr<SWGLObjectRenderer> SWGLObjectRendererPtr;   /**< boost shared pointer for SWGLObjectRenderer */
+typedef boost::shared_ptr<SWGLCloudRenderer> SWGLCloudRendererPtr;     /**< boost shared pointer for SWGLCloudRenderer */
+typedef boost::shared_ptr<SWGLMeshRenderer> SWGLMeshRendererPtr;       /**< boost shared pointer for SWGLMeshRenderer */
+
 
 typedef boost::shared_ptr<swMesh::SWMesh> SWMeshPtr;	/**< boost shared pointer for SWMesh */
 
@@ -69,6 +75,64 @@ struct SWAnimationSendData
 };
 
 
+/**
+ * \class SWAnimationTripleBuffer
+ * \brief Lock-free single producer / single consumer channel for the animation data of one object.
+ *
+ * Three preallocated slots are rotated : the producer fills the back slot and publishes it, the consumer
+ * takes the newest published slot. Neither side blocks, and the QVectors of each slot keep their capacity.
+ */
+class SWAnimationTripleBuffer
+{
+    public :
+
+        /**
+         * \brief constructor of SWAnimationTripleBuffer
+         * \param [in] i32PointsNumber : number of points of the object, used to preallocate the slots
+         */
+        SWAnimationTripleBuffer(cint i32PointsNumber = 0);
+
+        /**
+         * \brief Return the slot to be filled by the producer
+         */
+        SWAnimationSendData &backSlot();
+
+        /**
+         * \brief Publish the back slot filled by the producer, the previous published slot becomes the new back slot
+         */
+        void publish();
+
+        /**
+         * \brief Take the newest published slot if any
+         * \return true if a new slot has been published since the last call
+         */
+        bool update();
+
+        /**
+         * \brief Return the slot currently read by the consumer (valid until the next update call)
+         */
+        const SWAnimationSendData &frontSlot() const;
+
+        /**
+         * \brief Return the number of slots published since the creation of the channel
+         */
+        int publishedNumber() const;
+
+    private :
+
+        static const int m_i32FreshFlag = 4;    /**< flag set on the middle index when it has not been read yet */
+
+        SWAnimationSendData m_aSlots[3];        /**< preallocated slots */
+
+        int m_i32BackIndex;                     /**< slot owned by the producer */
+        int m_i32FrontIndex;                    /**< slot owned by the consumer */
+        QAtomicInt m_aI32MiddleIndex;           /**< last published slot | m_i32FreshFlag */
+        QAtomicInt m_aI32PublishedNumber;       /**< published slots counter */
+};
+
+typedef boost::shared_ptr<SWAnimationTripleBuffer> SWAnimationTripleBufferPtr; /**< boost shared pointer for SWAnimationTripleBuffer */
+
+
 
 struct SWGLObjectInfos
 {
@@ -109,11 +173,8 @@ struct SWGLObjectParameters
 
         // animation
             bool m_animationStarted;
-            QVector<float> m_animationOffsetsX;
-            QVector<float> m_animationOffsetsY;
-            QVector<float> m_animationOffsetsZ;
-            QVector<float> m_animationRigidMotion;
-            int m_animationIndexRotTrans;
+            SWAnimationTripleBufferPtr m_animationBuffer;   /**< animation data written by the animation worker */
+            int m_animationConsumedNumber;                  /**< number of animation slots read by the widget */
 
         // others
             QReadWriteLock m_animationMutex;
@@ -170,6 +231,20 @@ class SWGLMultiObjectWidget : public SWGLWidget
          */
         void meshParameters(cuint ui32Index,SWGLObjectParameters &oParams);
 
+        /**
+         * @brief animationBuffer
+         * @param isCloudItem
+         * @param indexItem
+         * @return the animation channel of the object, an empty pointer if the index is invalid
+         */
+        SWAnimationTripleBufferPtr animationBuffer(cbool isCloudItem, cint indexItem);
+
+        /**
+         * @brief setVerbosePacing, display the paint and animation rates every 5 s (disabled by default)
+         * @param bVerbose
+         */
+        void setVerbosePacing(cbool bVerbose);
+
 
     protected:
 
@@ -249,12 +324,6 @@ class SWGLMultiObjectWidget : public SWGLWidget
 //        void setAnimationOffset(bool isCloudItem, int indexItem, QVector<float> offsetValuesX,QVector<float> offsetValuesY,
 //                                QVector<float> offsetValueZ, QVector<float> rigidMotion, int indexRotTrans);
 
-        /**
-         * @brief setAnimationOffset
-         * @param animationSendData
-         */
-        void setAnimationOffset(SWAnimationSendDataPtr animationSendData);
-
 
     private :
 
@@ -268,6 +337,10 @@ class SWGLMultiObjectWidget : public SWGLWidget
          */
         void drawMeshes();
 
+        /**
+         * @brief updateFramePacing, display periodically the paint and animation rates
+         */
+        void updateFramePacing();
 
 
 
@@ -290,24 +363,23 @@ class SWGLMultiObjectWidget : public SWGLWidget
         QList<SWGLObjectParametersPtr> m_vMeshesParameters; /**< ... */
 
 
-//        QVector
-        QList<QGLBufferPtr> m_vCloudsVertexBuffer;
-        QList<QGLBufferPtr> m_vCloudsIndexBuffer;
-        QList<QGLBufferPtr> m_vCloudsNormalBuffer;
-        QList<QGLBufferPtr> m_vCloudsTextureBuffer;
-        QList<QGLBufferPtr> m_vCloudsColorBuffer;
-
-        QList<QGLBufferPtr> m_vMeshesVertexBuffer;
-        QList<QGLBufferPtr> m_vMeshesIndexBuffer;
-        QList<QGLBufferPtr> m_vMeshesNormalBuffer;
-        QList<QGLBufferPtr> m_vMeshesTextureBuffer;
-        QList<QGLBufferPtr> m_vMeshesColorBuffer;
+        QList<SWGLCloudRendererPtr> m_vCloudsRenderer;  /**< buffers and draw calls of the clouds */
+        QList<SWGLMeshRendererPtr> m_vMeshesRenderer;   /**< buffers and draw calls of the meshes */
 
-        QVector<QGLBufferPtr> m_vBuffersToDelete;
+        QVector<SWGLObjectRendererPtr> m_vRenderersToDelete; /**< renderers of the removed objects */
 
         QReadWriteLock m_pListCloudsMutex;
         QReadWriteLock m_pListMeshesMutex;
 
+        // frame pacing
+        QTime m_oPacingTime;                /**< time since the last pacing display */
+        int m_i32PaintedFrames;             /**< frames painted since the last pacing display */
+        int m_i32AnimationFrames;           /**< new animation slots displayed since the last pacing display */
+        int m_i32StaleAnimationFrames;      /**< painted animated frames without new animation slot */
+        int m_i32DroppedAnimationFrames;    /**< animation slots overwritten before being displayed */
+        int m_i32MaxPaintTime;              /**< max paint duration (ms) since the last pacing display */
+        bool m_bVerbosePacing;              /**< display the frame pacing ? */
+
 
 
 
@@ -56,7 +56,9 @@ struct SWGLBufferList
     QGLBuffer m_colorBuffer;
     QGLBuffer m_normalBuffer;
     QGLBuffer m_textureBuffer;
-    bool m_bUpdate;
+    bool m_bUpdate;         /**< the vertices positions and normals have changed */
+    bool m_bUpdateTopology; /**< the triangles, colors or texture coordinates have changed too (used with m_bUpdate) */
+    bool m_bUpdateTextures; /**< only the texture coordinates have changed too (used with m_bUpdate) */
 };
 
 
@@ -110,7 +112,9 @@ class SWGLOptimalStepNonRigidICP : public SWGLWidget
 
 
         /**
-         * @brief bufferUpdate
+         * @brief bufferUpdate : set the morphed template buffers to update, only the positions and the normals are rewritten,
+         *        the triangles and colors buffers are kept (see resetMorphing for a full update), the texture coordinates
+         *        are rewritten only if the correspondences modified them (SWM_TEXTURES dirty stream of the template)
          */
         void bufferUpdate();
 
@@ -313,6 +317,12 @@ class SWGLOptimalStepNonRigidICP : public SWGLWidget
          */
         void setCoeffAlpha(double dVal);
 
+        /**
+         * \brief Set the number of levels of the coarse to fine morphing, 1 for the single resolution path (mutex protection)
+         * \param i32Val : value
+         */
+        void setLevelsNumber(int i32Val);
+
         /**
          * \brief Compute distance weights and correspondances between source and target.
          */
@@ -330,6 +340,16 @@ class SWGLOptimalStepNonRigidICP : public SWGLWidget
          */
         double morph(cdouble dAlpha);
 
+        /**
+         * \brief Build the decimated templates pyramid before a morphing, the morphing starts on the coarsest template.
+         */
+        void startMultiResolution();
+
+        /**
+         * \brief Go back to the full resolution template at the end of a morphing and display the levels convergence reports.
+         */
+        void endMultiResolution();
+
         /**
          * \brief Reset morphing.
          */
@@ -514,6 +534,7 @@ class SWGLOptimalStepNonRigidICP : public SWGLWidget
         double m_dBeta;                     /**< beta : landmarks  value */
         double m_dGama;                     /**< gama : neighbours value */
         double m_dCoeffAlpha;               /**< alpha coeff to be used */
+        int m_i32LevelsNb;                  /**< number of levels of the coarse to fine morphing, 1 for the single resolution path */
 
         std::string m_sPathSourceMesh;      /**< mesh source obj file path */
         std::string m_sPathTargetMesh;      /**< mesh target obj file path */
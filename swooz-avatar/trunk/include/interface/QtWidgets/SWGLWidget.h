@@ -37,6 +37,7 @@
 // Swooz
 #include "swExceptions.h"
 #include "interface/SWQtCamera.h"
+#include "interface/SWGLRenderer.h"
 
 // Qt
 #include <QtGui>
@@ -46,12 +47,6 @@
 #include <QGLContext>
 #include <QGLBuffer>
 
-
-enum GLObjectDisplayMode
-{
-    GLO_ORIGINAL_COLOR,GLO_UNI_COLOR,GLO_TEXTURE,GLO_TEXTURE_NO_LIGHT
-};
-
 /**
  * \class SWGLWidget
  * \brief Base class for rendering opengl in Qt widget.
@@ -0,0 +1,202 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWGLRenderer.h
+ * \brief Defines SWGLObjectRenderer, SWGLCloudRenderer and SWGLMeshRenderer
+ */
+
+#ifndef _SWGLRENDERER_
+#define _SWGLRENDERER_
+
+#include "commonTypes.h"
+#include "cloud/SWCloud.h"
+#include "mesh/SWMesh.h"
+
+#include <QGLBuffer>
+#include <QGLShaderProgram>
+#include <QVector>
+#include <QVector3D>
+#include <QMatrix4x4>
+
+
+enum GLObjectDisplayMode
+{
+    GLO_ORIGINAL_COLOR,GLO_UNI_COLOR,GLO_TEXTURE,GLO_TEXTURE_NO_LIGHT
+};
+
+/**
+ * \class SWGLObjectRenderer
+ * \brief Base class of the scene objects renderers : owns the opengl buffers of an object and draws it with the shader
+ *        of the caller, independently of any QGLWidget (a current opengl context is enough, an offscreen one included).
+ */
+class SWGLObjectRenderer
+{
+    public:
+
+        /**
+         * \brief constructor of SWGLObjectRenderer
+         */
+        SWGLObjectRenderer();
+
+        /**
+         * \brief destructor of SWGLObjectRenderer
+         */
+        virtual ~SWGLObjectRenderer();
+
+        /**
+         * \brief Create the opengl buffers (the context must be current).
+         */
+        void initBuffers();
+
+        /**
+         * \brief Shrink the opengl buffers before the renderer is released (the context must be current).
+         */
+        void clearBuffers();
+
+        /**
+         * \brief Set the object transformation uniforms of the multi objects shaders (cloudViewer, meshViewer).
+         * \param [in,out] oShader      : bound shader
+         * \param [in] oCenter          : center of the object, the rotation and the scaling are applied around it
+         * \param [in] oRotation        : rotation angles (degrees)
+         * \param [in] oTranslation     : translation
+         * \param [in] fScaling         : scaling
+         * \param [in] oMVPMatrix       : model view projection matrix
+         */
+        static void setTransformationUniforms(QGLShaderProgram &oShader, const QVector3D &oCenter, const QVector3D &oRotation,
+                                              const QVector3D &oTranslation, cfloat fScaling, const QMatrix4x4 &oMVPMatrix);
+
+    protected :
+
+        QGLBuffer m_vertexBuffer;   /**< positions [x y z] */
+        QGLBuffer m_indexBuffer;    /**< primitives index */
+        QGLBuffer m_colorBuffer;    /**< colors [r g b] */
+        QGLBuffer m_normalBuffer;   /**< normals [x y z] */
+        QGLBuffer m_textureBuffer;  /**< texture coordinates [u v] */
+};
+
+
+/**
+ * \class SWGLCloudRenderer
+ * \brief Draw a cloud with colored points.
+ */
+class SWGLCloudRenderer : public SWGLObjectRenderer
+{
+    public:
+
+        /**
+         * \brief Upload the positions and the colors of the cloud, the index is rewritten only when the size changes.
+         * \param [in] oCloud : cloud to display
+         */
+        void updateBuffers(const swCloud::SWCloud &oCloud);
+
+        /**
+         * \brief Draw the cloud points.
+         * \param [in,out] oShader : bound shader, with its uniforms already set
+         */
+        void draw(QGLShaderProgram &oShader);
+
+        /**
+         * \brief Draw a rectangle behind the cloud, at the input depth.
+         * \param [in,out] oShader  : bound shader
+         * \param [in] oMVPMatrix   : model view projection matrix
+         * \param [in] oBBox        : cloud bounding box
+         * \param [in] fDepth       : depth of the rectangle
+         */
+        void drawDepthRect(QGLShaderProgram &oShader, const QMatrix4x4 &oMVPMatrix, const swCloud::SWCloudBBox &oBBox, cfloat fDepth);
+
+    private :
+
+        QGLBuffer m_depthRectVertexBuffer;  /**< depth rectangle positions */
+        QGLBuffer m_depthRectIndexBuffer;   /**< depth rectangle triangles */
+};
+
+
+/**
+ * \class SWGLMeshRenderer
+ * \brief Draw a mesh with colors, texture or a unique color, the positions buffer can be rewritten at each frame (morphing, animation).
+ */
+class SWGLMeshRenderer : public SWGLObjectRenderer
+{
+    public:
+
+        /**
+         * \brief constructor of SWGLMeshRenderer
+         */
+        SWGLMeshRenderer();
+
+        /**
+         * \brief Create the opengl buffers (the context must be current).
+         * \param [in] bDynamicPositions : the positions and the normals will be rewritten frequently
+         */
+        void initBuffers(cbool bDynamicPositions = false);
+
+        /**
+         * \brief Upload all the mesh streams : triangles, colors, texture coordinates, positions and normals.
+         * \param [in] oMesh : mesh to display
+         */
+        void updateBuffers(const swMesh::SWMesh &oMesh);
+
+        /**
+         * \brief Upload only the positions and the normals of the mesh, the topology must be unchanged.
+         * \param [in] oMesh : mesh to display
+         */
+        void updateVertexBuffers(const swMesh::SWMesh &oMesh);
+
+        /**
+         * \brief Write the animated positions of the mesh directly in the positions buffer :
+         *        R * (p - c + offset) + t + c, with c the point i32CenterId and (R,t) the rigid motion.
+         * \param [in] oMesh            : animated mesh
+         * \param [in] vOffsetX         : x offsets of each point
+         * \param [in] vOffsetY         : y offsets of each point
+         * \param [in] vOffsetZ         : z offsets of each point
+         * \param [in] vRigidMotion     : rigid motion [tx ty tz rx ry rz] of the animation
+         * \param [in] i32CenterId      : id of the center of the rigid motion
+         */
+        void updateAnimatedVertexBuffer(const swMesh::SWMesh &oMesh, const QVector<float> &vOffsetX, const QVector<float> &vOffsetY,
+                                        const QVector<float> &vOffsetZ, const QVector<float> &vRigidMotion, cint i32CenterId = 352);
+
+        /**
+         * \brief Draw the mesh triangles with the streams of the display mode, as the multi objects viewer did before the renderers.
+         *        GLO_TEXTURE_NO_LIGHT draws nothing.
+         * \param [in,out] oShader      : bound shader, with its uniforms already set
+         * \param [in] oDisplayMode     : display mode
+         * \param [in] ui32Texture      : texture location used with GLO_TEXTURE
+         */
+        void draw(QGLShaderProgram &oShader, const GLObjectDisplayMode oDisplayMode, const GLuint ui32Texture = 0);
+
+        /**
+         * \brief Draw the mesh triangles with the texture coordinates stream, even if the mesh has no texture coordinates.
+         * \param [in,out] oShader      : bound shader, with its uniforms already set
+         * \param [in] ui32Texture      : texture location, 0 keeps the current bound texture
+         */
+        void drawWithTexture(QGLShaderProgram &oShader, const GLuint ui32Texture = 0);
+
+    private :
+
+        std::vector<float> m_vAnimationVertexBuffer;/**< animated positions, used only when the positions buffer can't be mapped */
+};
+
+#endif
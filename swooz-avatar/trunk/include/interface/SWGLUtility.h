@@ -38,6 +38,7 @@
 #include "swExceptions.h"
 #include <QGLBuffer>
 #include <QGLShaderProgram>
+#include <vector>
 
 /**
  * @brief checkGlError : check gl error
@@ -135,6 +136,111 @@ static void allocateBuffer(QGLBuffer &oBuffer, const void * pData, cint i32SizeD
         if(checkGlError(true) != GL_NO_ERROR) qWarning() << "allocateBuffer -> oBuffer.release()";
 }
 
+/**
+ * \brief Updates the input QGL buffer, the content is rewritten in place (glBufferSubData) if the size is unchanged, else the buffer is reallocated
+ *        (a NULL data only allocates the buffer).
+ * \param [in,out] oBuffer  : buffer to be updated.
+ * \param [in] pData        : data
+ * \param [in] i32SizeData  : size of the data
+ */
+static void updateBuffer(QGLBuffer &oBuffer, const void * pData, cint i32SizeData)
+{
+    if(!pData || oBuffer.size() != i32SizeData)
+    {
+        allocateBuffer(oBuffer, pData, i32SizeData);
+        return;
+    }
+
+    oBuffer.bind();
+        if(checkGlError(true) != GL_NO_ERROR) qWarning() << "updateBuffer -> oBuffer.bind()";
+    oBuffer.write(0, pData, i32SizeData);
+        if(checkGlError(true) != GL_NO_ERROR) qWarning() << "updateBuffer -> oBuffer.write(0, pData, i32SizeData) " << oBuffer.size() << " " << oBuffer.bufferId() ;
+    oBuffer.release();
+        if(checkGlError(true) != GL_NO_ERROR) qWarning() << "updateBuffer -> oBuffer.release()";
+}
+
+/**
+ * \brief Map the input QGL buffer for writing, the previous content is discarded (new storage, no wait for the draws still using it).
+ * \param [in,out] oBuffer  : buffer to be mapped, bound until unmapBuffer is called
+ * \param [in] i32SizeData  : size of the data
+ * \return a pointer on the buffer memory, or NULL if the mapping failed (the buffer is then released)
+ */
+static void *mapBufferForWriting(QGLBuffer &oBuffer, cint i32SizeData)
+{
+    oBuffer.bind();
+        if(checkGlError(true) != GL_NO_ERROR) qWarning() << "mapBufferForWriting -> oBuffer.bind()";
+    oBuffer.allocate(i32SizeData);
+        if(checkGlError(true) != GL_NO_ERROR) qWarning() << "mapBufferForWriting -> oBuffer.allocate(i32SizeData) " << oBuffer.size() << " " << oBuffer.bufferId() ;
+
+    void *l_pData = oBuffer.map(QGLBuffer::WriteOnly);
+
+    if(!l_pData)
+    {
+        checkGlError(false);
+        oBuffer.release();
+    }
+
+    return l_pData;
+}
+
+/**
+ * \brief Unmap and release a buffer mapped with mapBufferForWriting.
+ * \param [in,out] oBuffer  : mapped buffer
+ */
+static void unmapBuffer(QGLBuffer &oBuffer)
+{
+    if(!oBuffer.unmap())
+    {
+        qWarning() << "unmapBuffer -> the buffer content has been corrupted. ";
+    }
+    oBuffer.release();
+        if(checkGlError(true) != GL_NO_ERROR) qWarning() << "unmapBuffer -> oBuffer.release()";
+}
+
+/**
+ * \brief Updates a vertex QGL buffer with planar coordinates [x0 x1 ... xn] [y0 ... yn] [z0 ... zn],
+ *        interleaved directly in the mapped buffer memory, with a temporary copy only if the mapping is not available.
+ * \param [in,out] oBuffer  : buffer to be updated.
+ * \param [in] aFX          : x coordinates
+ * \param [in] aFY          : y coordinates
+ * \param [in] aFZ          : z coordinates
+ * \param [in] i32PointsNb  : number of points
+ */
+static void updatePlanarVertexBuffer(QGLBuffer &oBuffer, const float *aFX, const float *aFY, const float *aFZ, cint i32PointsNb)
+{
+    if(i32PointsNb <= 0)
+    {
+        allocateBuffer(oBuffer, NULL, 0);
+        return;
+    }
+
+    cint l_i32SizeData = i32PointsNb * 3 * static_cast<int>(sizeof(float));
+    float *l_aFVertex  = static_cast<float*>(mapBufferForWriting(oBuffer, l_i32SizeData));
+    std::vector<float> l_vFVertex;
+
+    if(!l_aFVertex)
+    {
+        l_vFVertex.resize(i32PointsNb * 3);
+        l_aFVertex = &l_vFVertex[0];
+    }
+
+    for(int ii = 0; ii < i32PointsNb; ++ii)
+    {
+        l_aFVertex[ii*3]     = aFX[ii];
+        l_aFVertex[ii*3 + 1] = aFY[ii];
+        l_aFVertex[ii*3 + 2] = aFZ[ii];
+    }
+
+    if(l_vFVertex.size() == 0)
+    {
+        unmapBuffer(oBuffer);
+    }
+    else
+    {
+        updateBuffer(oBuffer, l_aFVertex, l_i32SizeData);
+    }
+}
+
 /**
  * \brief Check if gl shader is linked.
  * \param [in,out] oShader : input gl shader
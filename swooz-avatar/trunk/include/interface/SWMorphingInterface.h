@@ -227,6 +227,7 @@ class SWMorphingInterface : public QMainWindow
         double m_dGamaDefaultValue;
         double m_dCoeffValueDefaultValue;
         double m_dAngleMaxDefaultValue;
+        int m_i32LevelsDefaultValue;
 
         // widgets
 //        QPushButton *m_pPBStart;
@@ -37,9 +37,19 @@
 #include "cloud/SWCloud.h"
 #include "geometryUtility.h"
 
+#include <cfloat>
+
 //! namespace for classes based on the use of SWMesh
 namespace swMesh
 {
+    /**
+     * \brief Streams of a SWMesh, used as bit flags by the dirty tracking (see SWMesh::dirtyStreams)
+     */
+    enum SWMeshStream
+    {
+        SWM_VERTICES = 1, SWM_NORMALS = 2, SWM_TEXTURES = 4, SWM_TOPOLOGY = 8, SWM_ALL_STREAMS = 15
+    };
+
     /**
      * \class SWMesh
      * \brief A mesh class using a SWCloud for the cloud geometry, useful for saving/loading obj,
@@ -240,11 +250,18 @@ namespace swMesh
             }
 
             /**
-             * @brief Apply a transformation on the mesh normals (see transform in SWCloud)
-             * @param m_aFRotationMatrix (rigid motion)
+             * @brief Apply a rotation on the cached mesh normals (vertices, non oriented vertices and non oriented triangles normals)
+             * @param [in] aFRotationMatrix : rotation matrix of the rigid motion (see transform in SWCloud)
+             */
+            void transformNormals(cfloat *aFRotationMatrix);
+
+            /**
+             * @brief Apply a rigid motion on the mesh : the points are transformed and the cached normals rotated instead of being recomputed.
+             * @param [in] aFRotationMatrix    : rotation matrix
+             * @param [in] aFTranslationMatrix : translation vector
              * @return true
              */
-//            bool transformNormals(cfloat *aFRotationMatrix);
+            bool transform(cfloat *aFRotationMatrix, cfloat *aFTranslationMatrix);
 
             /**
              * \brief Get the triangle normal corresonding to the input id.
@@ -287,10 +304,36 @@ namespace swMesh
 
             /**
              * \brief Scale the mesh by multipliying all the coordinates points by the input value.
+             *        An uniform positive scaling doesn't change the normals, they are only recomputed for a non positive value.
              * \param [in] fScaleValue   : scaling value
              */
             void scale(cfloat fScaleValue);
 
+            /**
+             * \brief Copy the points and the normals of a mesh with the same topology (the triangles and texture coordinates are kept).
+             * \param [in] oMesh : mesh to copy the geometry from
+             * \return false if the points number doesn't match
+             */
+            bool copyGeometry(const SWMesh &oMesh);
+
+            /**
+             * \brief Return the streams modified since the last call of clearDirtyStreams (combination of SWMeshStream flags).
+             *        The modifications done directly on the cloud (see cloud()) must be notified with setDirtyStreams.
+             */
+            uint dirtyStreams() const;
+
+            /**
+             * \brief Mark the input streams as modified.
+             * \param [in] ui32Streams : combination of SWMeshStream flags
+             */
+            void setDirtyStreams(cuint ui32Streams);
+
+            /**
+             * \brief Mark the input streams as up to date for the consumer.
+             * \param [in] ui32Streams : combination of SWMeshStream flags
+             */
+            void clearDirtyStreams(cuint ui32Streams = SWM_ALL_STREAMS);
+
             /**
              * \brief Get a copy of all the index of the triangles vertex [uint32] (used for opengl)
              * \return the uint32 array
@@ -321,6 +364,24 @@ namespace swMesh
              */
             float *textureBuffer() const;
 
+            /**
+             * \brief Get a pointer on the index of the triangles vertex [uint32] without copy (used to update opengl buffers)
+             * \return the array or a NULL pointer, valid until the mesh is modified
+             */
+            const uint *indexVertexTriangleBufferData() const;
+
+            /**
+             * \brief Get a pointer on the normals coordinates [float float float] without copy (used to update opengl buffers)
+             * \return the array or a NULL pointer, valid until the mesh is modified
+             */
+            const float *normalBufferData() const;
+
+            /**
+             * \brief Get a pointer on the texture coordinates [float float] without copy (used to update opengl buffers)
+             * \return the array or a NULL pointer, valid until the mesh is modified
+             */
+            const float *textureBufferData() const;
+
             /**
              * \brief Return the number of edges of the mesh.
              * \return the edges number.
@@ -390,6 +451,14 @@ namespace swMesh
              */
             void updateNonOrientedVerticesNormals();
 
+            /**
+             * \brief Update the non oriented normals after a partial edit of the vertices : only the triangles using the modified vertices
+             *        and the normals of their vertices (one-ring) are recomputed, with the same result than a full update
+             *        (except for the unmodified vertices without triangles, oriented toward the previous mean point).
+             * \param [in] vModifiedVertices : id of the moved vertices
+             */
+            void updateNonOrientedNormals(const std::vector<uint> &vModifiedVertices);
+
             /**
              * @brief invertAllNormals
              */
@@ -409,6 +478,7 @@ namespace swMesh
 
                 m_a2FTextures[idVertex*2] = vCoords[0];
                 m_a2FTextures[idVertex*2+1] = vCoords[1];
+                m_ui32DirtyStreams |= SWM_TEXTURES;
             }
 
             /**
@@ -437,12 +507,32 @@ namespace swMesh
              */
             void deletePointsWithNoFaces();
 
+            /**
+             * \brief Simplify the mesh with quadric error metric edge collapses (Garland and Heckbert) ordered by a heap, in O(n log n).
+             *        Each vertex is collapsed onto one of its neighbours, so the kept vertices keep their positions and texture coordinates.
+             *        The border vertices (see vertexOnBorder) and the pinned vertices are never removed.
+             * \param [out] oDecimatedMesh  : simplified mesh
+             * \param [out] vOldToNew       : id in the simplified mesh of the vertex each vertex of the mesh has been collapsed onto
+             * \param [in] ui32TrianglesNb  : triangles budget, 0 to only use the error bound
+             * \param [in] fMaxError        : the simplification stops before a collapse with a larger quadric error (squared distance * area)
+             * \param [in] vPinnedVertices  : ids of the vertices to keep (landmarks)
+             * \return the number of triangles of the simplified mesh
+             */
+            uint decimate(SWMesh &oDecimatedMesh, std::vector<uint> &vOldToNew, cuint ui32TrianglesNb, cfloat fMaxError = FLT_MAX,
+                          const std::vector<uint> &vPinnedVertices = std::vector<uint>()) const;
+
             /**
              * \brief Return a pointer on the mesh cloud (memory managed by SWMesh destructor)
              * \return m_oCloud pointer
              */
             swCloud::SWCloud *cloud();
 
+            /**
+             * \brief Return a const pointer on the mesh cloud
+             * \return m_oCloud pointer
+             */
+            const swCloud::SWCloud *cloud() const;
+
             bool m_meshLoadSucess;
 
 
@@ -466,12 +556,21 @@ namespace swMesh
             void buildVerticesNeighbors();
 
 
+            /**
+             * \brief Compute the non oriented normal of the vertex corresponding to the input id from its triangles normals,
+             *        in the same order than updateNonOrientedVerticesNormals.
+             * \param [in] ui32IdVertex   : vertex id
+             * \return false if the normal is null (vertex without triangles), the normal is then not normalized
+             */
+            bool computeNonOrientedVertexNormal(cuint ui32IdVertex);
+
             bool isQuadFace(std::ifstream &l_oFileStream);
             void checkObjFile(std::ifstream &l_oFileStream, bool &bIsTextureCoords, bool &bIsNormals);
 
 
             uint m_ui32EdgesNumber;             /**< number of edges of the mesh */
             uint m_ui32TrianglesNumber;         /**< number of triangles of the mesh */
+            uint m_ui32DirtyStreams;            /**< streams modified since the last clearDirtyStreams (SWMeshStream flags) */
 
             std::vector<float> m_a2FTextures;   /**< texture coordinates of each vertex [v0x, v0y, v1x, v1y, ..., vnx, vny] */
             std::vector<float> m_a3FNormals;    /**< normals of each vertex [v0x, v0y, v0z, v1x, v1y, ..., vnx, vny, vnz] */
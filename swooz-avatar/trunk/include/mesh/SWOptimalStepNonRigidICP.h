@@ -38,10 +38,28 @@
 #include "cloud/SWAlignClouds.h"
 #include "mesh/SWMesh.h"
 
+#include <map>
+
 #include "opencv2/imgproc/imgproc.hpp"
 
 namespace swMesh
 {
+    /**
+     * \brief Convergence report of a resolution level of the morphing.
+     */
+    struct SWOSNRICPLevelStats
+    {
+        int m_i32Level;             /**< level id, 0 is the full resolution template */
+        uint m_ui32VerticesNb;      /**< vertices number of the level template */
+        int m_i32AlphaStepsNb;      /**< number of alpha values resolved on the level */
+        int m_i32IterationsNb;      /**< number of resolve calls on the level */
+        float m_fFirstAlpha;        /**< first alpha resolved on the level */
+        float m_fLastAlpha;         /**< last alpha resolved on the level */
+        float m_fLastDiff;          /**< last deformation difference returned by resolve */
+        float m_fResidual;          /**< RMS distance between the deformed template and its correspondences after the last resolve */
+        double m_dTime;             /**< time spent in resolve on the level (s) */
+    };
+
     class SWOptimalStepNonRigidICP
     {
         public :
@@ -79,6 +97,58 @@ namespace swMesh
             void updateLandmarksWithSTASM();
             void updateLandmarksWithManualSelection(std::vector<int> &idSource, std::vector<int> &idTarget);
 
+            // ############################################# COARSE TO FINE
+
+            /**
+             * \brief Build a pyramid of decimated templates from the current source mesh and start the morphing on the coarsest one.
+             *        With one level the single resolution path is used, only the levels stats are reset.
+             * \param [in] i32LevelsNb      : number of levels, full resolution included
+             * \param [in] fReductionRatio  : triangles ratio kept between two consecutive levels
+             * \return the number of levels built
+             */
+            int buildPyramid(cint i32LevelsNb, cfloat fReductionRatio = 0.25f);
+
+            /**
+             * \brief Prolong the per-vertex affine transforms of the current level to a finer level, whose deformed template becomes the source mesh.
+             * \param [in] i32Level : finer level to reach, 0 is the full resolution template
+             * \return false if the level is not finer than the current one
+             */
+            bool prolongToLevel(cint i32Level);
+
+            /**
+             * \brief Level to use for an alpha value : the stiff steps go to the coarse levels, the full resolution is kept for the last low alpha steps.
+             * \param [in] fAlpha      : current alpha
+             * \param [in] fStartAlpha : first alpha of the morphing
+             * \param [in] fMinAlpha   : alpha ending the morphing
+             * \return the level id
+             */
+            int levelForAlpha(cfloat fAlpha, cfloat fStartAlpha, cfloat fMinAlpha) const;
+
+            /**
+             * \brief Return the number of levels of the pyramid (1 with the single resolution path).
+             */
+            int levelsNumber() const;
+
+            /**
+             * \brief Return the current level, 0 is the full resolution template.
+             */
+            int currentLevel() const;
+
+            /**
+             * \brief Return the convergence reports of the levels already resolved, the coarsest first.
+             */
+            const std::vector<SWOSNRICPLevelStats> &levelsStats() const;
+
+            /**
+             * \brief Display the convergence reports of the levels.
+             */
+            void displayLevelsStats() const;
+
+            /**
+             * \brief Compute the RMS distance between the weighted source vertices and their target correspondences.
+             */
+            float residual() const;
+
      private :
 
             cv::Mat *m_X;  /**< current X */
@@ -125,6 +195,34 @@ namespace swMesh
 
             std::string m_sPathSourceStasmCorr;
             std::string m_sPathTargetStasmCorr;
+
+            /**
+             * \brief Decimate a template for the pyramid with SWMesh::decimate.
+             * \param [in] oMesh            : template to decimate
+             * \param [in] fReductionRatio  : triangles ratio to keep
+             * \param [in] mLandmarks       : landmarks of the template, their vertices are not removed
+             * \param [out] oCoarseMesh     : decimated template
+             * \param [out] vFineToCoarse   : id of the coarse vertex of each template vertex
+             */
+            static void decimateTemplate(const SWMesh &oMesh, cfloat fReductionRatio, const std::map<uint,uint> &mLandmarks,
+                                         SWMesh &oCoarseMesh, std::vector<uint> &vFineToCoarse);
+
+            /**
+             * \brief Compose the accumulated transform of a vertex with a resolve transform, blended as applied to the source cloud.
+             */
+            void accumulateTransform(cuint ui32Vertex, const cv::Mat &oTr, cfloat fCoeff);
+
+            /**
+             * \brief Resize the per vertex arrays to the current source mesh.
+             */
+            void resizeVerticesArrays();
+
+            int m_i32CurrentLevel;                                  /**< current level of the pyramid, 0 is the full resolution template */
+            std::vector<SWMesh> m_vPyramidMeshes;                   /**< undeformed template of each level */
+            std::vector<std::vector<uint> > m_vFineToCoarse;        /**< for each level, id of the coarser level vertex of each vertex */
+            std::vector<std::map<uint,uint> > m_vPyramidLandmarks;  /**< landmarks of each level */
+            cv::Mat m_oAccumulatedX;                                /**< transforms from the undeformed current level template to the source mesh */
+            std::vector<SWOSNRICPLevelStats> m_vLevelsStats;        /**< convergence reports of the levels */
     };
 }
 
@@ -43,9 +43,81 @@
 
 using namespace swDevice;
 
+// ############################################# SWAsyncDebugImageWriter
+
+SWAsyncDebugImageWriter::SWAsyncDebugImageWriter(cuint ui32Capacity) : m_ui32Capacity(ui32Capacity > 0 ? ui32Capacity : 1),
+    m_ui32DroppedImagesNb(0), m_ui32FailedImagesNb(0), m_oQueue(m_ui32Capacity)
+{
+    m_oWritingThread = boost::thread(boost::bind(&SWAsyncDebugImageWriter::doWrite, this));
+}
+
+SWAsyncDebugImageWriter::~SWAsyncDebugImageWriter()
+{
+    m_oQueue.close();
+    m_oWritingThread.join();
+
+    if(m_ui32DroppedImagesNb > 0 || m_ui32FailedImagesNb > 0)
+    {
+        std::cerr << "SWAsyncDebugImageWriter : " << m_ui32DroppedImagesNb << " debug images dropped, " << m_ui32FailedImagesNb << " not written. " << std::endl;
+    }
+}
+
+void SWAsyncDebugImageWriter::save(const std::string &sPath, const cv::Mat &oImage)
+{
+    // the writing thread only removes images, the queue can't be full after this test
+    if(m_oQueue.size() >= m_ui32Capacity)
+    {
+        ++m_ui32DroppedImagesNb;
+        return;
+    }
+
+    SWDebugImage l_oImage;
+    l_oImage.m_sPath  = sPath;
+    l_oImage.m_oImage = oImage.clone();
+    m_oQueue.push(l_oImage);
+}
+
+uint SWAsyncDebugImageWriter::droppedImagesNb() const
+{
+    return m_ui32DroppedImagesNb;
+}
+
+uint SWAsyncDebugImageWriter::failedImagesNb() const
+{
+    return m_ui32FailedImagesNb;
+}
+
+void SWAsyncDebugImageWriter::doWrite()
+{
+    SWDebugImage l_oImage;
+
+    while(m_oQueue.pop(l_oImage))
+    {
+        bool l_bWritten = false;
+
+        try
+        {
+            l_bWritten = cv::imwrite(l_oImage.m_sPath, l_oImage.m_oImage);
+        }
+        catch(const cv::Exception &e)
+        {
+            std::cerr << "SWAsyncDebugImageWriter : " << e.what() << std::endl;
+        }
+
+        if(!l_bWritten)
+        {
+            // the directory is probably missing, reported once
+            if(m_ui32FailedImagesNb++ == 0)
+            {
+                std::cerr << "SWAsyncDebugImageWriter : can't write " << l_oImage.m_sPath << std::endl;
+            }
+        }
+    }
+}
+
 // ############################################# CONSTRUCTORS / DESTRUCTORS
 
-SWCreateAvatar::SWCreateAvatar(cbool bVerbose) : m_bVerbose(bVerbose), m_i32NumCloud(0)
+SWCreateAvatar::SWCreateAvatar(cbool bVerbose) : m_bVerbose(bVerbose), m_pDebugImageSink(new SWDebugImageSink()), m_i32NumCloud(0)
 {
     // detection
         m_bDetectStasmPoints        = false;
@@ -106,6 +178,7 @@ void SWCreateAvatar::resetData()
     m_oLastRectFace.width = 0;
     m_oLastRectNose.width = 0;
     m_oFaceCloudRef.erase();
+    m_oFaceCloudRefIndex.clear();
     m_oNoseCloudRef.erase();
     m_oAccumulatedFaceClouds.erase();
     m_vUi32CloudNumbersOfPoints.clear();
@@ -166,6 +239,23 @@ void SWCreateAvatar::setUseStasm(cbool bUseStasm)
     m_CStasmDetectPtr->resetParams();
 }
 
+void SWCreateAvatar::setSaveDebugImages(cbool bSaveDebugImages)
+{
+    if(bSaveDebugImages)
+    {
+        m_pDebugImageSink = SWDebugImageSinkPtr(new SWAsyncDebugImageWriter());
+    }
+    else
+    {
+        m_pDebugImageSink = SWDebugImageSinkPtr(new SWDebugImageSink());
+    }
+}
+
+void SWCreateAvatar::setDebugImageSink(SWDebugImageSinkPtr pDebugImageSink)
+{
+    m_pDebugImageSink = pDebugImageSink ? pDebugImageSink : SWDebugImageSinkPtr(new SWDebugImageSink());
+}
+
 void SWCreateAvatar::setErodeValue(cuint ui32Erode)
 {
     m_i32Erode = ui32Erode;
@@ -231,8 +321,18 @@ bool SWCreateAvatar::addCloudToAvatar(const cv::Mat &oRgb, const cv::Mat &oDepth
     clock_t l_timeTraining = clock();
     std::cout << "1 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
 
+    SWAvatarFrame l_oFrame;
 
+    if(!prepareCloud(oRgb, oDepth, l_oFrame))
+    {
+        return false;
+    }
+
+    return integrateCloud(l_oFrame);
+}
 
+bool SWCreateAvatar::prepareCloud(const cv::Mat &oRgb, const cv::Mat &oDepth, SWAvatarFrame &oFrame)
+{
    // copy input data
        cv::Mat l_oRgb   = oRgb.clone();
        cv::Mat l_oDepth = oDepth.clone();
@@ -248,8 +348,6 @@ bool SWCreateAvatar::addCloudToAvatar(const cv::Mat &oRgb, const cv::Mat &oDepth
    // remove background
        cv::Mat l_oRgbForeGround    = swImage::swUtil::removeBackground(l_oRgb, l_oDepth, m_fRemoveBackGroundDistance);
 
-//       std::cout << "2 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
-
    // detect face
        if(!m_CFaceDetectPtr->detectFace(l_oRgbForeGround))
        {
@@ -258,10 +356,6 @@ bool SWCreateAvatar::addCloudToAvatar(const cv::Mat &oRgb, const cv::Mat &oDepth
                std::cerr << "Face not detected. The face must be detected in the first frame. " << std::endl;
                return false;
            }
-           else
-           {
-//               std::cout << "Face not detected. Use previous face rectangle. " << std::endl;
-           }
        }
        else
        {
@@ -275,13 +369,9 @@ bool SWCreateAvatar::addCloudToAvatar(const cv::Mat &oRgb, const cv::Mat &oDepth
                 m_oLastRectFace.height += (int)(m_oLastRectFace.height *0.1);
         }
 
-//       std::cout << "3 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
-
     // detect nose
        cv::Rect l_oCurrentNoseRect = m_CFaceDetectPtr->detectNose(l_oRgbForeGround(m_oLastRectFace));
 
-//       std::cout << "4 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
-
    // compute nose tip
        int l_i32IdNoseX, l_i32IdNoseY;
        cv::Point3f l_oNoseTip;
@@ -302,31 +392,49 @@ bool SWCreateAvatar::addCloudToAvatar(const cv::Mat &oRgb, const cv::Mat &oDepth
             l_oRectangleFromNoseTip.y = m_oLastRectFace.y + l_i32IdNoseY - 50;
        }
 
-//       std::cout << "5 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
-
        l_oRectangleFromNoseTip.width   = 60;
        l_oRectangleFromNoseTip.height  = 70;
        m_oLastRectNose = l_oRectangleFromNoseTip;
 
    // detect stasm features points
-        cv::Mat l_oStasmMask;
-        if(m_bDetectStasmPoints && m_vStasm3DPoints.size() < 5)
+        bool l_bComputeStasm = false;
+        if(m_bDetectStasmPoints)
+        {
+            boost::mutex::scoped_lock l_oLock(m_oStasmMutex);
+            l_bComputeStasm = m_vStasm3DPoints.size() < 5;
+        }
+
+        oFrame.m_bStasmComputed = l_bComputeStasm;
+
+        if(l_bComputeStasm)
         {
+            cv::Mat l_oStasmMask;
             m_CStasmDetectPtr->resetParams();
             m_CStasmDetectPtr->launchAsmSearch(l_oRgbForeGround, m_oLastRectFace);
             m_CStasmDetectPtr->setStasmMask(l_oDepth, l_oStasmMask);
             l_oStasmMask = l_oStasmMask(m_oLastRectFace);
-            m_CStasmDetectPtr->compute3DPoints(l_oDepth, m_vP3FStasm3DPoints);           
+            m_CStasmDetectPtr->compute3DPoints(l_oDepth, m_vP3FStasm3DPoints);
+            oFrame.m_vP3FStasm3DPoints = m_vP3FStasm3DPoints;
         }
 
-//        std::cout << "6 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
-
     // create cloud
-        swCloud::SWCloud l_oFaceCloud, l_oNoseCloud;
-        swCloud::convCloudMat2SWCloud(l_oDepth(m_oLastRectFace), l_oRgb(m_oLastRectFace), l_oFaceCloud, l_oNoseTip.z-0.5f, m_fDepthCloud+0.5f);
-        swCloud::convCloudMat2SWCloud(l_oDepth(m_oLastRectNose), l_oRgb(m_oLastRectNose), l_oNoseCloud, l_oNoseTip.z-0.5f, m_fDepthCloud+0.5f );
+        swCloud::convCloudMat2SWCloud(l_oDepth(m_oLastRectFace), l_oRgb(m_oLastRectFace), oFrame.m_oFaceCloud, l_oNoseTip.z-0.5f, m_fDepthCloud+0.5f);
+        swCloud::convCloudMat2SWCloud(l_oDepth(m_oLastRectNose), l_oRgb(m_oLastRectNose), oFrame.m_oNoseCloud, l_oNoseTip.z-0.5f, m_fDepthCloud+0.5f );
 
-//        std::cout << "7 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
+    // save frame data
+        oFrame.m_oRgb           = l_oRgb;
+        oFrame.m_oDepth         = l_oDepth;
+        oFrame.m_oRgbForeGround = l_oRgbForeGround;
+        oFrame.m_oRectFace      = m_oLastRectFace;
+        oFrame.m_oRectNose      = m_oLastRectNose;
+
+    return true;
+}
+
+bool SWCreateAvatar::integrateCloud(const SWAvatarFrame &oFrame)
+{
+    swCloud::SWCloud l_oFaceCloud;
+    l_oFaceCloud.copy(oFrame.m_oFaceCloud);
 
     bool l_bIsLastCloudValid = false;
 
@@ -334,47 +442,42 @@ bool SWCreateAvatar::addCloudToAvatar(const cv::Mat &oRgb, const cv::Mat &oDepth
     {
         // save reference face cloud
             m_oFaceCloudRef.copy(l_oFaceCloud);
+            m_oFaceCloudRefIndex.build(m_oFaceCloudRef);
 //            m_oFaceCloudRef.reduce2(40);
 
         // save reference nose cloud
-            m_oNoseCloudRef.copy(l_oNoseCloud);
+            m_oNoseCloudRef.copy(oFrame.m_oNoseCloud);
         // retrieve face texture
-            m_oTextureMat = l_oRgbForeGround(m_oLastRectFace).clone();
+            m_oTextureMat = oFrame.m_oRgbForeGround(oFrame.m_oRectFace).clone();
         // apply median blur on the texture
 //            cv::medianBlur(m_oTextureMat, m_oTextureMat, 3);
         // save the texture
-            string l_sPath = "../data/textures/avatars/";
-            cv::imwrite(l_sPath + "texture.png" , m_oTextureMat);
+            saveDebugImage("../data/textures/avatars/texture.png", m_oTextureMat);
 
         // compute cloud bbox of the texture
-            swImage::swUtil::computeSizeCloudRect(m_oLastRectFace, oDepth, m_oCloudFaceBBox);
+            swImage::swUtil::computeSizeCloudRect(oFrame.m_oRectFace, oFrame.m_oDepth, m_oCloudFaceBBox);
        }
    // save next clouds
        else
        {
            // align clouds
-//        std::cout << "7_1 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
-           m_oAlignClouds.setClouds(m_oNoseCloudRef, l_oNoseCloud);
-//        std::cout << "7_2 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
+           m_oAlignClouds.setClouds(m_oNoseCloudRef, oFrame.m_oNoseCloud);
 //           m_oAlignClouds.setCloudDownscale(m_fTargetDownScale, m_fTemplateDownScale);
            m_oAlignClouds.setCloudDownscale(40, 40);
-//        std::cout << "7_3 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
            m_oAlignClouds.alignClouds();
 
-//           std::cout << "8_1 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
-
            // transform clouds
            m_oAlignClouds.transformedCloud(l_oFaceCloud);
 
-//            std::cout << "8_2 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
-
 //           float l_fScore = m_oFaceCloudRef.squareDistanceCloud(l_oFaceCloud, true, 0.1f);
-           float l_fScore = m_oFaceCloudRef.squareDistanceCloud(l_oFaceCloud, true, 40);
-//           std::cout << "8_3 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
+           swCloud::SWCloudDistanceStats l_oScoreStats;
+           m_oFaceCloudRefIndex.squareDistanceStats(l_oFaceCloud, l_oScoreStats, 40, m_fDistMaxAlignment);
+           float l_fScore = l_oScoreStats.m_fMean;
 
            if(m_bVerbose)
            {
-               std::cout << "Score : " << l_fScore << " --- " << m_fDistMaxAlignment << " : " << endl;
+               std::cout << "Score : " << l_fScore << " --- " << m_fDistMaxAlignment << " : median " << l_oScoreStats.m_fMedian
+                         << " inliers " << l_oScoreStats.m_fInlierRatio << endl;
            }
 
            if(l_fScore > m_fDistMaxAlignment)
@@ -387,22 +490,21 @@ bool SWCreateAvatar::addCloudToAvatar(const cv::Mat &oRgb, const cv::Mat &oDepth
            {
                l_bIsLastCloudValid = true;
            }
-
-//           std::cout << "9_1 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
        }
 
    // add cloud to the sum of clouds
        if(l_bIsLastCloudValid)
        {
-//           std::cout << "9_2 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
            m_oAccumulatedFaceClouds += l_oFaceCloud;
-//           std::cout << "9_3 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
            m_vUi32CloudNumbersOfPoints.push_back(l_oFaceCloud.size());
-//           std::cout << "9_4 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
 
-           if(m_bDetectStasmPoints && m_vStasm3DPoints.size() < 5)
+           if(oFrame.m_bStasmComputed)
            {
-                m_vStasm3DPoints.push_back(m_vP3FStasm3DPoints);
+                boost::mutex::scoped_lock l_oLock(m_oStasmMutex);
+                if(m_vStasm3DPoints.size() < 5)
+                {
+                    m_vStasm3DPoints.push_back(oFrame.m_vP3FStasm3DPoints);
+                }
            }
        }
 
@@ -462,27 +564,27 @@ void SWCreateAvatar::constructAvatar()
                 l_oFinalMat.at<float>(ii) = 0.f;
             }
         }
-        cv::imwrite("../data/images/radialProj/1_finalTemporal.png" ,l_oFinalMat);
+        saveDebugImage("../data/images/radialProj/1_finalTemporal.png", l_oFinalMat);
 
     // keep only one connex aggregat
         swCloud::keepBiggestConnexAggregate(l_oFinalMat, 50);
-            cv::imwrite("../data/images/radialProj/2_keepConnexe.png" ,l_oFinalMat);
+            saveDebugImage("../data/images/radialProj/2_keepConnexe.png", l_oFinalMat);
 
     // expand contours
         swCloud::expandContoursRadialProj(l_oFinalMat, m_i32ExpandValue, m_i32ExpandConnex);
-            cv::imwrite("../data/images/radialProj/3_expanded.png" ,l_oFinalMat);
+            saveDebugImage("../data/images/radialProj/3_expanded.png", l_oFinalMat);
 
     // dilate / erode
         if(m_i32Dilate >= 3)
         {
             cv::dilate(l_oFinalMat,  l_oFinalMat, cv::Mat(), cv::Point(-1, -1), m_i32Dilate);
         }
-            cv::imwrite("../data/images/radialProj/4_dilate.png" ,l_oFinalMat);
+            saveDebugImage("../data/images/radialProj/4_dilate.png", l_oFinalMat);
         if(m_i32Erode >= 3)
         {
             cv::erode(l_oFinalMat,  l_oFinalMat, cv::Mat(), cv::Point(-1, -1), m_i32Erode);
         }
-            cv::imwrite("../data/images/radialProj/5_erode.png" ,l_oFinalMat);
+            saveDebugImage("../data/images/radialProj/5_erode.png", l_oFinalMat);
 
     // spatial filtering
         cv::Mat l_oFinalFilteredMat;
@@ -492,7 +594,7 @@ void SWCreateAvatar::constructAvatar()
         if(m_bUseBilateralFilter)
         {
             cv::bilateralFilter(l_oFinalMat, l_oFinalFilteredMat, m_i32BilateralFilter, m_i32ColorFilterValue, m_i32SpaceFilterValue);
-                 cv::imwrite("../data/images/radialProj/6_biolateral.png" ,l_oFinalFilteredMat);
+                 saveDebugImage("../data/images/radialProj/6_biolateral.png", l_oFinalFilteredMat);
 
             // cancel the effects of the filter on the borders
                 for(int ii = 0; ii < l_oFinalMat.rows * l_oFinalMat.cols; ++ii)
@@ -503,7 +605,7 @@ void SWCreateAvatar::constructAvatar()
                     }
                 }
 
-                cv::imwrite("../data/images/radialProj/7_cancelBorder.png" ,l_oFinalFilteredMat);
+                saveDebugImage("../data/images/radialProj/7_cancelBorder.png", l_oFinalFilteredMat);
         }
         else
         {
@@ -512,18 +614,18 @@ void SWCreateAvatar::constructAvatar()
 
     // erase contours
         swCloud::eraseContoursRadialProj(l_oFinalFilteredMat, m_i32EraseValue, m_i32EraseConnex);
-            cv::imwrite("../data/images/radialProj/8_eraseContours.png" ,l_oFinalFilteredMat);
+            saveDebugImage("../data/images/radialProj/8_eraseContours.png", l_oFinalFilteredMat);
 
     // apply manual zone selection
         for(uint ii = 0; ii < m_vPixelToDelete.size(); ++ii)
         {
             l_oFinalFilteredMat.at<float>(m_vPixelToDelete[ii][1], m_vPixelToDelete[ii][0]) = 0.f;
         }
-            cv::imwrite("../data/images/radialProj/9_pixelsDeleted.png" ,l_oFinalMat);
+            saveDebugImage("../data/images/radialProj/9_pixelsDeleted.png", l_oFinalMat);
 
     // keep only one connex aggregat
         swCloud::keepBiggestConnexAggregate(l_oFinalFilteredMat, 50);
-            cv::imwrite("../data/images/radialProj/10_keepConnexe.png" ,l_oFinalFilteredMat);
+            saveDebugImage("../data/images/radialProj/10_keepConnexe.png", l_oFinalFilteredMat);
 
     // save radial projection for display
         m_oFilteredRadialProjection = l_oFinalFilteredMat.clone();
@@ -537,6 +639,11 @@ void SWCreateAvatar::constructAvatar()
     }
 }
 
+void SWCreateAvatar::saveDebugImage(const std::string &sPath, const cv::Mat &oImage) const
+{
+    m_pDebugImageSink->save(sPath, oImage);
+}
+
 void SWCreateAvatar::totalCloud(swCloud::SWCloud &oTotalCloud)
 {    
     oTotalCloud.copy(m_oAccumulatedFaceClouds);
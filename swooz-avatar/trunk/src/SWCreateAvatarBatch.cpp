@@ -0,0 +1,532 @@
+
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWCreateAvatarBatch.cpp
+ * \brief Headless avatar reconstruction from rgbd recordings saved with SWSaveKinectData
+ *
+ *  The frames loading, the face detection and the clouds alignment are pipelined on three threads,
+ *  the -deterministic option runs all the stages sequentially on one thread with a fixed random seed.
+ */
+
+#include "SWCreateAvatar.h"
+#include "devices/rgbd/SWLoadKinectData.h"
+#include "timeUtility.h"
+
+#include <iostream>
+#include <iomanip>
+#include <deque>
+#include <algorithm>
+#include <cstdlib>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+
+/**
+ * \class SWBlockingQueue
+ * \brief Bounded FIFO used between two stages of the pipeline.
+ */
+template<typename T>
+class SWBlockingQueue
+{
+    public :
+
+        /**
+         * \brief constructor of SWBlockingQueue
+         * \param [in] ui32Capacity : max number of elements in the queue
+         */
+        SWBlockingQueue(cuint ui32Capacity) : m_ui32Capacity(ui32Capacity), m_bClosed(false)
+        {}
+
+        /**
+         * \brief Add an element, wait while the queue is full
+         * \param [in] oElement : element to add
+         * \return false if the queue has been closed
+         */
+        bool push(const T &oElement)
+        {
+            boost::mutex::scoped_lock l_oLock(m_oMutex);
+
+            while(!m_bClosed && m_dElements.size() >= m_ui32Capacity)
+            {
+                m_oNotFull.wait(l_oLock);
+            }
+
+            if(m_bClosed)
+            {
+                return false;
+            }
+
+            m_dElements.push_back(oElement);
+            m_oNotEmpty.notify_one();
+
+            return true;
+        }
+
+        /**
+         * \brief Retrieve the oldest element, wait while the queue is empty
+         * \param [out] oElement : retrieved element
+         * \return false if the queue is closed and empty
+         */
+        bool pop(T &oElement)
+        {
+            boost::mutex::scoped_lock l_oLock(m_oMutex);
+
+            while(!m_bClosed && m_dElements.empty())
+            {
+                m_oNotEmpty.wait(l_oLock);
+            }
+
+            if(m_dElements.empty())
+            {
+                return false;
+            }
+
+            oElement = m_dElements.front();
+            m_dElements.pop_front();
+            m_oNotFull.notify_one();
+
+            return true;
+        }
+
+        /**
+         * \brief Close the queue : the waiting producers and consumers are released.
+         *  If bDiscard is true, the remaining elements are removed.
+         */
+        void close(cbool bDiscard = false)
+        {
+            boost::mutex::scoped_lock l_oLock(m_oMutex);
+
+            m_bClosed = true;
+
+            if(bDiscard)
+            {
+                m_dElements.clear();
+            }
+
+            m_oNotFull.notify_all();
+            m_oNotEmpty.notify_all();
+        }
+
+    private :
+
+        uint m_ui32Capacity;                        /**< max number of elements */
+        bool m_bClosed;                             /**< is the queue closed ? */
+        std::deque<T> m_dElements;                  /**< elements */
+        boost::mutex m_oMutex;                      /**< queue mutex */
+        boost::condition_variable m_oNotFull;       /**< notified when an element is removed */
+        boost::condition_variable m_oNotEmpty;      /**< notified when an element is added */
+};
+
+
+/**
+ * \struct SWStageTiming
+ * \brief Timing statistics of one stage of the reconstruction.
+ */
+struct SWStageTiming
+{
+    SWStageTiming(const std::string &sName = "") : m_sName(sName), m_dTotal(0.), m_dMax(0.), m_i32Count(0)
+    {}
+
+    /**
+     * \brief Add a duration in ms
+     */
+    void add(cdouble dDuration)
+    {
+        m_dTotal += dDuration;
+        m_dMax    = std::max(m_dMax, dDuration);
+        ++m_i32Count;
+    }
+
+    /**
+     * \brief Display the statistics of the stage
+     */
+    void display() const
+    {
+        std::cout << std::setw(12) << m_sName << " : " << std::setw(6) << m_i32Count << " calls, total " << std::setw(10) << m_dTotal
+                  << " ms, mean " << std::setw(8) << (m_i32Count ? m_dTotal / m_i32Count : 0.) << " ms, max " << std::setw(8) << m_dMax << " ms" << std::endl;
+    }
+
+    std::string m_sName;    /**< stage name */
+    double m_dTotal;        /**< total time (ms) */
+    double m_dMax;          /**< max time (ms) */
+    int m_i32Count;         /**< number of measures */
+};
+
+typedef boost::shared_ptr<SWAvatarFrame> SWAvatarFramePtr; /**< boost shared pointer for SWAvatarFrame */
+
+/**
+ * \struct SWLoadedFrame
+ * \brief Raw rgbd frame loaded from the recording.
+ */
+struct SWLoadedFrame
+{
+    int m_i32Id;        /**< frame id in the recording */
+    cv::Mat m_oBgr;     /**< bgr image */
+    cv::Mat m_oCloud;   /**< cloud map */
+};
+
+
+/**
+ * \class SWCreateAvatarBatch
+ * \brief Load the frames of a recording, build the avatar and save the mesh and the texture.
+ */
+class SWCreateAvatarBatch
+{
+    public :
+
+        /**
+         * \brief constructor of SWCreateAvatarBatch
+         */
+        SWCreateAvatarBatch(const std::string &sRecordingPath, cint i32CloudsNumber, cint i32FramesToSkip, cbool bUseStasm, cbool bVerbose) :
+            m_sRecordingPath(sRecordingPath), m_i32CloudsNumber(i32CloudsNumber), m_i32FramesToSkip(i32FramesToSkip),
+            m_oLoadQueue(4), m_oDetectQueue(4), m_oAvatar(bVerbose),
+            m_oLoadTiming("load"), m_oDetectTiming("detect"), m_oAlignTiming("align"), m_oConstructTiming("construct"), m_oSaveTiming("save"),
+            m_i32FramesLoaded(0), m_i32FramesRejected(0), m_i32CloudsAdded(0)
+        {
+            m_oAvatar.setSaveDebugImages(false);
+            m_oAvatar.setUseStasm(bUseStasm);
+            m_oAvatar.resetData();
+        }
+
+        /**
+         * \brief Build the total face cloud with the frames of the recording
+         * \param [in] bPipelined : load, detect and align the frames on separate threads
+         * \return true if at least one cloud has been added
+         */
+        bool accumulateClouds(cbool bPipelined)
+        {
+            swDevice::SWLoadKinectData l_oLoader(m_sRecordingPath);
+            l_oLoader.start();
+
+            if(bPipelined)
+            {
+                boost::thread l_oLoadThread(&SWCreateAvatarBatch::loadFrames, this, &l_oLoader);
+                boost::thread l_oDetectThread(&SWCreateAvatarBatch::detectFaces, this);
+
+                SWAvatarFramePtr l_pFrame;
+                while(m_i32CloudsAdded < m_i32CloudsNumber && m_oDetectQueue.pop(l_pFrame))
+                {
+                    alignFrame(*l_pFrame);
+                }
+
+                // stop the upstream stages
+                m_oLoadQueue.close(true);
+                m_oDetectQueue.close(true);
+                l_oLoadThread.join();
+                l_oDetectThread.join();
+            }
+            else
+            {
+                SWLoadedFrame l_oLoadedFrame;
+                while(m_i32CloudsAdded < m_i32CloudsNumber && loadFrame(l_oLoader, l_oLoadedFrame))
+                {
+                    SWAvatarFramePtr l_pFrame = detectFace(l_oLoadedFrame);
+
+                    if(l_pFrame)
+                    {
+                        alignFrame(*l_pFrame);
+                    }
+                }
+            }
+
+            l_oLoader.stop();
+
+            return m_i32CloudsAdded > 0;
+        }
+
+        /**
+         * \brief Construct the avatar mesh with the total cloud and save it
+         * \param [in] sOutputPath : path of the obj file, the texture and the material are saved in the same directory
+         * \return true if the files have been saved
+         */
+        bool constructAndSave(const std::string &sOutputPath)
+        {
+            boost::posix_time::ptime l_oTime = boost::posix_time::microsec_clock::local_time();
+                m_oAvatar.constructAvatar();
+            m_oConstructTiming.add(swUtil::elapsedMs(l_oTime));
+
+            l_oTime = boost::posix_time::microsec_clock::local_time();
+
+            swMesh::SWMesh l_oMesh;
+            m_oAvatar.lastResultFaceMesh(l_oMesh);
+
+            // split the output path
+                size_t l_ui32Separator = sOutputPath.find_last_of("/\\");
+                std::string l_sDirectory = (l_ui32Separator == std::string::npos) ? "" : sOutputPath.substr(0, l_ui32Separator + 1);
+                std::string l_sNameObj   = sOutputPath.substr(l_sDirectory.size());
+                std::string l_sBaseName  = l_sNameObj.substr(0, l_sNameObj.find_last_of('.'));
+
+            bool l_bSaved = l_oMesh.saveToObj(l_sDirectory, l_sNameObj, l_sBaseName + ".mtl", l_sBaseName + ".png");
+            l_bSaved = cv::imwrite(l_sDirectory + l_sBaseName + ".png", m_oAvatar.m_oTextureMat) && l_bSaved;
+
+            m_oSaveTiming.add(swUtil::elapsedMs(l_oTime));
+
+            std::cout << "Mesh : " << l_oMesh.pointsNumber() << " points, " << l_oMesh.trianglesNumber() << " triangles saved in " << sOutputPath << std::endl;
+
+            return l_bSaved;
+        }
+
+        /**
+         * \brief Display the timing report
+         */
+        void displayReport(cdouble dTotalTime) const
+        {
+            std::cout << std::endl << "Frames loaded : " << m_i32FramesLoaded << ", clouds added : " << m_i32CloudsAdded
+                      << ", frames rejected : " << m_i32FramesRejected << std::endl;
+            m_oLoadTiming.display();
+            m_oDetectTiming.display();
+            m_oAlignTiming.display();
+            m_oConstructTiming.display();
+            m_oSaveTiming.display();
+            std::cout << std::setw(12) << "total" << " : " << dTotalTime << " ms (" << 1000. * m_i32FramesLoaded / std::max(dTotalTime, 1.) << " frames/s)" << std::endl;
+        }
+
+    private :
+
+        /**
+         * \brief Load the next frame to process (the frames to skip are ignored)
+         */
+        bool loadFrame(swDevice::SWLoadKinectData &oLoader, SWLoadedFrame &oFrame)
+        {
+            boost::posix_time::ptime l_oTime = boost::posix_time::microsec_clock::local_time();
+
+            bool l_bLoaded = false;
+            for(int ii = 0; ii <= m_i32FramesToSkip; ++ii)
+            {
+                l_bLoaded = oLoader.grabVideo(oFrame.m_oBgr) && oLoader.grabCloud(oFrame.m_oCloud);
+
+                if(!l_bLoaded)
+                {
+                    break;
+                }
+            }
+
+            if(l_bLoaded)
+            {
+                oFrame.m_i32Id = m_i32FramesLoaded++;
+                m_oLoadTiming.add(swUtil::elapsedMs(l_oTime));
+            }
+
+            return l_bLoaded;
+        }
+
+        /**
+         * \brief Loading stage of the pipeline
+         */
+        void loadFrames(swDevice::SWLoadKinectData *pLoader)
+        {
+            SWLoadedFrame l_oFrame;
+            while(loadFrame(*pLoader, l_oFrame))
+            {
+                // the grabbed mats may be reused by the loader, they are cloned before being queued
+                l_oFrame.m_oBgr   = l_oFrame.m_oBgr.clone();
+                l_oFrame.m_oCloud = l_oFrame.m_oCloud.clone();
+
+                if(!m_oLoadQueue.push(l_oFrame))
+                {
+                    break;
+                }
+            }
+
+            m_oLoadQueue.close();
+        }
+
+        /**
+         * \brief Detect the face and build the clouds of a frame
+         * \return an empty pointer if the face has never been detected
+         */
+        SWAvatarFramePtr detectFace(const SWLoadedFrame &oLoadedFrame)
+        {
+            boost::posix_time::ptime l_oTime = boost::posix_time::microsec_clock::local_time();
+
+            SWAvatarFramePtr l_pFrame(new SWAvatarFrame());
+            if(!m_oAvatar.prepareCloud(oLoadedFrame.m_oBgr, oLoadedFrame.m_oCloud, *l_pFrame))
+            {
+                l_pFrame.reset();
+            }
+
+            m_oDetectTiming.add(swUtil::elapsedMs(l_oTime));
+
+            return l_pFrame;
+        }
+
+        /**
+         * \brief Detection stage of the pipeline
+         */
+        void detectFaces()
+        {
+            SWLoadedFrame l_oLoadedFrame;
+            while(m_oLoadQueue.pop(l_oLoadedFrame))
+            {
+                SWAvatarFramePtr l_pFrame = detectFace(l_oLoadedFrame);
+
+                if(l_pFrame && !m_oDetectQueue.push(l_pFrame))
+                {
+                    break;
+                }
+            }
+
+            m_oDetectQueue.close();
+        }
+
+        /**
+         * \brief Alignment stage : align the frame clouds and add the face cloud to the total cloud
+         */
+        void alignFrame(const SWAvatarFrame &oFrame)
+        {
+            boost::posix_time::ptime l_oTime = boost::posix_time::microsec_clock::local_time();
+
+            if(m_oAvatar.integrateCloud(oFrame))
+            {
+                ++m_i32CloudsAdded;
+            }
+            else
+            {
+                ++m_i32FramesRejected;
+            }
+
+            m_oAlignTiming.add(swUtil::elapsedMs(l_oTime));
+        }
+
+
+        std::string m_sRecordingPath;                       /**< recording path */
+        int m_i32CloudsNumber;                              /**< number of clouds to accumulate */
+        int m_i32FramesToSkip;                              /**< frames skipped between two processed frames */
+
+        SWBlockingQueue<SWLoadedFrame> m_oLoadQueue;        /**< loaded frames */
+        SWBlockingQueue<SWAvatarFramePtr> m_oDetectQueue;   /**< frames with the face detected */
+
+        SWCreateAvatar m_oAvatar;                           /**< avatar reconstruction */
+
+        SWStageTiming m_oLoadTiming;                        /**< loading stage timing (loading thread) */
+        SWStageTiming m_oDetectTiming;                      /**< detection stage timing (detection thread) */
+        SWStageTiming m_oAlignTiming;                       /**< alignment stage timing (main thread) */
+        SWStageTiming m_oConstructTiming;                   /**< mesh construction timing */
+        SWStageTiming m_oSaveTiming;                        /**< saving timing */
+
+        int m_i32FramesLoaded;                              /**< number of loaded frames (loading thread) */
+        int m_i32FramesRejected;                            /**< number of frames rejected by the alignment */
+        int m_i32CloudsAdded;                               /**< number of clouds added to the total cloud */
+};
+
+
+/**
+ * \brief Display the command line usage
+ */
+static void displayUsage()
+{
+    std::cerr << "Usage : SWCreateAvatarBatch <recording path> <output obj path> [options]" << std::endl;
+    std::cerr << "  -clouds <n>      : number of clouds to accumulate (default 20)" << std::endl;
+    std::cerr << "  -skip <n>        : frames skipped between two processed frames (default 0)" << std::endl;
+    std::cerr << "  -stasm           : detect the stasm features points" << std::endl;
+    std::cerr << "  -deterministic   : run the stages sequentially on one thread with a fixed random seed" << std::endl;
+    std::cerr << "  -seed <n>        : random seed used by the deterministic mode (default 0)" << std::endl;
+    std::cerr << "  -verbose         : display the alignment scores" << std::endl;
+}
+
+
+int main(int argc, char* argv[])
+{
+    if(argc < 3)
+    {
+        displayUsage();
+        return -1;
+    }
+
+    std::string l_sRecordingPath(argv[1]), l_sOutputPath(argv[2]);
+    int l_i32CloudsNumber = 20, l_i32FramesToSkip = 0;
+    unsigned int l_ui32Seed = 0;
+    bool l_bUseStasm = false, l_bDeterministic = false, l_bVerbose = false;
+
+    for(int ii = 3; ii < argc; ++ii)
+    {
+        std::string l_sOption(argv[ii]);
+
+        if(l_sOption == "-clouds" && ii + 1 < argc)
+        {
+            l_i32CloudsNumber = std::max(1, atoi(argv[++ii]));
+        }
+        else if(l_sOption == "-skip" && ii + 1 < argc)
+        {
+            l_i32FramesToSkip = std::max(0, atoi(argv[++ii]));
+        }
+        else if(l_sOption == "-seed" && ii + 1 < argc)
+        {
+            l_ui32Seed = static_cast<unsigned int>(atoi(argv[++ii]));
+        }
+        else if(l_sOption == "-stasm")
+        {
+            l_bUseStasm = true;
+        }
+        else if(l_sOption == "-deterministic")
+        {
+            l_bDeterministic = true;
+        }
+        else if(l_sOption == "-verbose")
+        {
+            l_bVerbose = true;
+        }
+        else
+        {
+            std::cerr << "Unknown option : " << l_sOption << std::endl;
+            displayUsage();
+            return -1;
+        }
+    }
+
+    if(l_bDeterministic)
+    {
+        // the clouds random sampling and the openmp reductions must not depend on the run
+        srand(l_ui32Seed);
+        #ifdef _OPENMP
+            omp_set_num_threads(1);
+        #endif
+    }
+
+    boost::posix_time::ptime l_oStartTime = boost::posix_time::microsec_clock::local_time();
+
+    SWCreateAvatarBatch l_oBatch(l_sRecordingPath, l_i32CloudsNumber, l_i32FramesToSkip, l_bUseStasm, l_bVerbose);
+
+    if(!l_oBatch.accumulateClouds(!l_bDeterministic))
+    {
+        std::cerr << "No cloud has been built from the recording " << l_sRecordingPath << std::endl;
+        return -1;
+    }
+
+    bool l_bSaved = l_oBatch.constructAndSave(l_sOutputPath);
+
+    l_oBatch.displayReport(swUtil::elapsedMs(l_oStartTime));
+
+    return l_bSaved ? 0 : -1;
+}
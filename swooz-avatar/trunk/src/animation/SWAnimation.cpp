@@ -417,33 +417,43 @@ bool swAnimation::SWAnimation::retrieveTransfosToApply(int numLine ,QVector<floa
         return false;
     }
 
-    transfoX.clear();
-    transfoY.clear();
-    transfoZ.clear();
-    rigidMotion.clear();
-
     if(numLine == m_animationSeq.m_transFactors.size())
     {
         return false;
     }
 
-    for(uint ii = 0; ii < m_pCloudCorr->size(); ++ii)
+    // the vectors are resized instead of cleared to keep their capacity when they are reused frame after frame
+    int l_i32PointsNumber = static_cast<int>(m_pCloudCorr->size());
+    transfoX.resize(l_i32PointsNumber);
+    transfoY.resize(l_i32PointsNumber);
+    transfoZ.resize(l_i32PointsNumber);
+    rigidMotion.resize(6);
+
+    const std::vector<float> &l_vTransFactors = m_animationSeq.m_transFactors[numLine];
+
+    for(int ii = 0; ii < l_i32PointsNumber; ++ii)
     {
-        transfoX.push_back(0.f);
-        transfoY.push_back(0.f);
-        transfoZ.push_back(0.f);
+        const std::vector<float> &l_vTx = m_animationMod.m_vtx[m_idCorr[ii]];
+        const std::vector<float> &l_vTy = m_animationMod.m_vty[m_idCorr[ii]];
+        const std::vector<float> &l_vTz = m_animationMod.m_vtz[m_idCorr[ii]];
+
+        float l_fX = 0.f, l_fY = 0.f, l_fZ = 0.f;
 
         for(uint jj = 0; jj < m_animationMod.m_vtx[0].size(); ++jj)
         {
-            transfoX.last() += (m_animationMod.m_vtx[m_idCorr[ii]][jj]* m_animationSeq.m_transFactors[numLine][jj])/40.f;
-            transfoY.last() += (m_animationMod.m_vty[m_idCorr[ii]][jj]* m_animationSeq.m_transFactors[numLine][jj])/40.f;
-            transfoZ.last() -= (m_animationMod.m_vtz[m_idCorr[ii]][jj]* m_animationSeq.m_transFactors[numLine][jj])/40.f;
+            l_fX += (l_vTx[jj]* l_vTransFactors[jj])/40.f;
+            l_fY += (l_vTy[jj]* l_vTransFactors[jj])/40.f;
+            l_fZ -= (l_vTz[jj]* l_vTransFactors[jj])/40.f;
         }
+
+        transfoX[ii] = l_fX;
+        transfoY[ii] = l_fY;
+        transfoZ[ii] = l_fZ;
     }
 
     for(int ii = 0; ii < 6; ++ii)
     {
-        rigidMotion.push_back(m_animationSeq.m_rigidMotion[numLine][ii]);
+        rigidMotion[ii] = m_animationSeq.m_rigidMotion[numLine][ii];
     }
 //    qDebug() << " time -> " << ((float)(clock() - l_oProgramTime) / CLOCKS_PER_SEC);
 
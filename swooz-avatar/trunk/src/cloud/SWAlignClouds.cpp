@@ -36,6 +36,8 @@
 
 #include <iostream>
 
+#include "opencv2/core/core.hpp"
+
 using namespace std;
 using namespace registration;
 using namespace swCloud;
@@ -100,6 +102,16 @@ void SWAlignClouds::setSmoothingParams(cuint ui32K, cfloat fSmoothTransConst, cf
     m_fHRot   = fSmoothRotConst;
 }
 
+void SWAlignClouds::setMotionFilter(const swUtil::SWFilterParams &oParams)
+{
+    m_oMotionFilter.reset(6, oParams);
+}
+
+void SWAlignClouds::resetMotionFilter()
+{
+    m_oMotionFilter.reset();
+}
+
 void SWAlignClouds::alignClouds()
 {
     // launch emicp
@@ -117,7 +129,28 @@ void SWAlignClouds::alignClouds()
             delete[] l_fRotationMatrix;
             delete[] l_fTranslationMatrix;
 
-            if(m_ui32K > 0)
+            if(m_oMotionFilter.isEnabled())
+            {
+                // filter the translation and the rotation angles, the rotation matrix is rebuilt from the filtered angles
+                // wall clock time base, clock() counts the cpu time of the process
+                double l_dTime = static_cast<double>(cv::getTickCount()) / cv::getTickFrequency();
+
+                m_oFilteredRigidMotion = SWRigidMotion(m_oRigidMotion);
+
+                for(uint jj = 0; jj < 3; ++jj)
+                {
+                    m_oFilteredRigidMotion.m_aFTranslation[jj] = static_cast<float>(m_oMotionFilter.filter(jj,     m_oRigidMotion.m_aFTranslation[jj], l_dTime));
+                    m_oFilteredRigidMotion.m_aFRotAngles[jj]   = static_cast<float>(m_oMotionFilter.filter(jj + 3, m_oRigidMotion.m_aFRotAngles[jj],   l_dTime));
+                }
+
+                m_oFilteredRigidMotion.computeRotationMatrixWithRotationAngles();
+
+                if(m_bVerbose)
+                {
+                    std::cout << "F  : "; rigidMotion().display();
+                }
+            }
+            else if(m_ui32K > 0)
             {
                 // compute the smoothed rigid motion
                 //	 stock emicp result
@@ -217,6 +250,11 @@ void SWAlignClouds::alignClouds()
 
 SWRigidMotion SWAlignClouds::rigidMotion()
 {
+    if(m_oMotionFilter.isEnabled())
+    {
+        return m_oFilteredRigidMotion;
+    }
+
     if(m_ui32K > 0)
     {
         return m_oSmoothedRigidMotion;
@@ -36,13 +36,12 @@
 #include "cloud/SWImageProcessing.h"
 #include "cloud/SWConvCloud.h"
 #include "opencvUtility.h"
+#include "timeUtility.h"
 
 using namespace swCloud;
 using namespace swDevice;
 using namespace cv;
 
-#include <time.h>
-
 // ############################################# CONSTRUCTORS / DESTRUCTORS
  
 SWCaptureHeadMotion::SWCaptureHeadMotion(cfloat fAlignmentReducCoeff, cfloat fScoreReducCoeff) :
@@ -64,20 +63,39 @@ SWCaptureHeadMotion::SWCaptureHeadMotion(cfloat fAlignmentReducCoeff, cfloat fSc
 int SWCaptureHeadMotion::computeHeadMotion(SWRigidMotion &oHeadRigidMotion, const cv::Mat &oRgb, const cv::Mat &oDepth,
                                            cv::Mat &oDisplayDetectFace, cv::Point3f oNoseTip)
 {
-     clock_t l_oFirstTime = clock();
+    SWHeadDetection l_oDetection;
+    detectHead(l_oDetection, oRgb, oDepth);
+
+    oDisplayDetectFace = l_oDetection.m_oDisplayDetectFace;
+
+    return alignHead(oHeadRigidMotion, l_oDetection);
+}
 
+int SWCaptureHeadMotion::detectHead(SWHeadDetection &oDetection, const cv::Mat &oRgb, const cv::Mat &oDepth)
+{
+    boost::posix_time::ptime l_oStageTime = boost::posix_time::microsec_clock::local_time();
 
-    cv::Mat l_oRgbForeGround    = swImage::swUtil::removeBackground(oRgb, oDepth, 1.5);//, 5, cv::Vec3b(0,255,0 ));
-    oDisplayDetectFace          = l_oRgbForeGround.clone();
+    // remove background
+        cv::Mat l_oRgbForeGround = swImage::swUtil::removeBackground(oRgb, oDepth, 1.5);//, 5, cv::Vec3b(0,255,0 ));
 
-    std::cout << "1 -> " << (float)(clock() - l_oFirstTime) / CLOCKS_PER_SEC << std::endl;
+        oDetection.m_oTimings.m_dBackground = swUtil::elapsedMs(l_oStageTime);
+        l_oStageTime = boost::posix_time::microsec_clock::local_time();
 
     // detect face
-        if(!m_CFaceDetectPtr->detectFace(l_oRgbForeGround))
+        bool l_bFaceDetected = m_CFaceDetectPtr->detectFace(l_oRgbForeGround);
+
+        oDetection.m_oDisplayDetectFace = l_oRgbForeGround.clone();
+        cv::Mat &l_oDisplayDetectFace   = oDetection.m_oDisplayDetectFace;
+
+        oDetection.m_oTimings.m_dFaceDetection = swUtil::elapsedMs(l_oStageTime);
+        l_oStageTime = boost::posix_time::microsec_clock::local_time();
+
+        if(!l_bFaceDetected)
         {
             if(m_oLastDetectedRectFace.width == 0)
             {
                 std::cerr << "Face not detected. Head rigid motion cannot be computed. " << std::endl;
+                oDetection.m_i32Status = -1;
                 return -1;
             }
             else
@@ -93,8 +111,6 @@ int SWCaptureHeadMotion::computeHeadMotion(SWRigidMotion &oHeadRigidMotion, cons
             m_oLastDetectedRectFace = m_CFaceDetectPtr->faceRect();
         }
 
-    std::cout << "2 -> " << (float)(clock() - l_oFirstTime) / CLOCKS_PER_SEC << std::endl;
-
     // detect nose
        cv::Rect l_oCurrentNoseRect = m_CFaceDetectPtr->detectNose(l_oRgbForeGround(m_oLastDetectedRectFace));
 
@@ -121,31 +137,56 @@ int SWCaptureHeadMotion::computeHeadMotion(SWRigidMotion &oHeadRigidMotion, cons
         l_oRectangleFromNoseTip.width  = 60;
         l_oRectangleFromNoseTip.height  = 70;
 
-         std::cout << "3 -> " << (float)(clock() - l_oFirstTime) / CLOCKS_PER_SEC << std::endl;
+        oDetection.m_oTimings.m_dNose = swUtil::elapsedMs(l_oStageTime);
+        l_oStageTime = boost::posix_time::microsec_clock::local_time();
+
     // display
-        if(swUtil::isInside(m_oLastDetectedRectFace, oDisplayDetectFace))
+        if(swUtil::isInside(m_oLastDetectedRectFace, l_oDisplayDetectFace))
         {
-            cv::rectangle(oDisplayDetectFace, cv::Point(m_oLastDetectedRectFace.x, m_oLastDetectedRectFace.y),
+            cv::rectangle(l_oDisplayDetectFace, cv::Point(m_oLastDetectedRectFace.x, m_oLastDetectedRectFace.y),
                 cv::Point(m_oLastDetectedRectFace.x+m_oLastDetectedRectFace.width, m_oLastDetectedRectFace.y+m_oLastDetectedRectFace.height), RED,1);
         }
 
-        if(swUtil::isInside(l_oRectangleFromNoseTip,oDisplayDetectFace))
+        if(swUtil::isInside(l_oRectangleFromNoseTip,l_oDisplayDetectFace))
         {
-            cv::rectangle(oDisplayDetectFace, cv::Point(l_oRectangleFromNoseTip.x, l_oRectangleFromNoseTip.y),
+            cv::rectangle(l_oDisplayDetectFace, cv::Point(l_oRectangleFromNoseTip.x, l_oRectangleFromNoseTip.y),
                     cv::Point(l_oRectangleFromNoseTip.x + l_oRectangleFromNoseTip.width, l_oRectangleFromNoseTip.y + l_oRectangleFromNoseTip.height), GREEN,1);
         }
 
-    // update rectangles returned by the getRect function
-        m_oFaceRectToDisplay = m_oLastDetectedRectFace;
-        m_oNoseRectToDisplay = l_oRectangleFromNoseTip;
+    // rectangles returned by the getRect function once the frame is aligned
+        oDetection.m_oFaceRect = m_oLastDetectedRectFace;
+        oDetection.m_oNoseRect = l_oRectangleFromNoseTip;
 
     // init face depth images
         cv::Mat l_oFaceDepth      = oDepth(l_oRectangleFromNoseTip);
 
     // create cloud
-        SWCloud l_oFaceCloud;
-        swCloud::convCloudMat2SWCloud(l_oFaceDepth, l_oFaceCloud, l_oNoseTip.z-0.10f, m_fDepthCloud + 0.10f, 0, 0, 255);
-        uint l_ui32SizeCurrentFaceCloud = l_oFaceCloud.size();       
+        oDetection.m_pFaceCloud = SWCloudPtr(new SWCloud());
+        swCloud::convCloudMat2SWCloud(l_oFaceDepth, *oDetection.m_pFaceCloud, l_oNoseTip.z-0.10f, m_fDepthCloud + 0.10f, 0, 0, 255);
+
+        oDetection.m_oTimings.m_dCloud = swUtil::elapsedMs(l_oStageTime);
+        oDetection.m_i32Status = 1;
+
+    return 1;
+}
+
+int SWCaptureHeadMotion::alignHead(SWRigidMotion &oHeadRigidMotion, const SWHeadDetection &oDetection)
+{
+    boost::posix_time::ptime l_oStageTime = boost::posix_time::microsec_clock::local_time();
+    m_oLastTimings = oDetection.m_oTimings;
+
+    if(oDetection.m_i32Status == -1)
+    {
+        m_oLastTimings.m_dLatency = swUtil::elapsedMs(oDetection.m_oInputTime);
+        return -1;
+    }
+
+    // update rectangles returned by the getRect function
+        m_oFaceRectToDisplay = oDetection.m_oFaceRect;
+        m_oNoseRectToDisplay = oDetection.m_oNoseRect;
+
+    const SWCloud &l_oFaceCloud = *oDetection.m_pFaceCloud;
+    uint l_ui32SizeCurrentFaceCloud = l_oFaceCloud.size();
 
     // save reference cloud
         if(!m_bReferenceCloudInitialized)
@@ -156,6 +197,8 @@ int SWCaptureHeadMotion::computeHeadMotion(SWRigidMotion &oHeadRigidMotion, cons
             m_oFaceCloudRef.reduce(m_fAlignmentReductionCoeffTemplate);
             m_bReferenceCloudInitialized = true;
 
+            m_oLastTimings.m_dAlignment = swUtil::elapsedMs(l_oStageTime);
+            m_oLastTimings.m_dLatency   = swUtil::elapsedMs(oDetection.m_oInputTime);
             return 0;
         }
 
@@ -165,9 +208,9 @@ int SWCaptureHeadMotion::computeHeadMotion(SWRigidMotion &oHeadRigidMotion, cons
         {
             std::cerr << "Input face cloud not valid, the cloud does not contain enough points. " << std::endl;
             oHeadRigidMotion = SWRigidMotion();
+            m_oLastTimings.m_dLatency = swUtil::elapsedMs(oDetection.m_oInputTime);
             return -1;
         }
-
     // apply previous good rigid motion
 //        if(m_bApplyPreviousRigidMotion)
 //        {
@@ -206,6 +249,9 @@ int SWCaptureHeadMotion::computeHeadMotion(SWRigidMotion &oHeadRigidMotion, cons
             m_oLastRigidMotion     = oHeadRigidMotion;
         }
 
+        m_oLastTimings.m_dAlignment = swUtil::elapsedMs(l_oStageTime);
+        m_oLastTimings.m_dLatency   = swUtil::elapsedMs(oDetection.m_oInputTime);
+
     return 1;
 }
 
@@ -214,6 +260,7 @@ void SWCaptureHeadMotion::reset()
     m_bReferenceCloudInitialized = false;
     m_oLastRigidMotion = SWRigidMotion();
     m_oLastDetectedRectFace = cv::Rect();
+    m_oAlignClouds.resetMotionFilter();
 
     m_oFaceCloudRef.erase();
     m_oDisplayFaceCloud.erase();
@@ -236,12 +283,133 @@ void SWCaptureHeadMotion::setParameters(cdouble dTemplateCoeffReduc, cdouble dTa
     }
 }
 
+void SWCaptureHeadMotion::setMotionFilter(const swUtil::SWFilterParams &oParams)
+{
+    m_oAlignClouds.setMotionFilter(oParams);
+}
+
 void SWCaptureHeadMotion::getRect(cv::Rect &oFaceRect, cv::Rect &oNoseRect)
 {
     oFaceRect = m_oFaceRectToDisplay;
     oNoseRect = m_oNoseRectToDisplay;
 }
 
+SWHeadMotionTimings SWCaptureHeadMotion::lastTimings() const
+{
+    return m_oLastTimings;
+}
+
+// ############################################# SWHeadMotionPipeline
+
+SWHeadMotionPipeline::SWHeadMotionPipeline(SWCaptureHeadMotion *pCaptureHeadMotion, cuint ui32Depth, cbool bLowLatency) :
+    m_bLowLatency(bLowLatency), m_ui32Depth(ui32Depth > 0 ? ui32Depth : 1), m_ui32InputFramesNb(0), m_ui32ResultsNb(0), m_ui32LastResultFrameId(0),
+    m_pCaptureHeadMotion(pCaptureHeadMotion), m_i32LastSourceFrameId(-1), m_oInputQueue(m_ui32Depth + 1), m_oDetectionQueue(m_ui32Depth + 1),
+    m_oDetectionStage(boost::bind(&SWHeadMotionPipeline::detectionStage, this, _1))
+{
+    // at most ui32Depth + 1 frames are in flight in the default mode, the pushes in the queues never wait
+    if(m_bLowLatency)
+    {
+        m_oDetectionStage.addOutput(&m_oLatestDetection);
+    }
+    else
+    {
+        m_oDetectionStage.addOutput(&m_oDetectionQueue);
+    }
+
+    m_oDetectionStage.startListening();
+}
+
+SWHeadMotionPipeline::~SWHeadMotionPipeline()
+{
+    m_oDetectionStage.stopListening();
+    m_oInputQueue.close();
+    m_oLatestInput.close();
+}
+
+int SWHeadMotionPipeline::computeHeadMotion(SWRigidMotion &oHeadRigidMotion, const cv::Mat &oRgb, const cv::Mat &oDepth, cv::Mat &oDisplayDetectFace, cint i32SourceFrameId)
+{
+    SWHeadMotionFrame l_oFrame;
+    l_oFrame.m_ui32FrameId  = m_ui32InputFramesNb;
+    l_oFrame.m_oInputTime   = boost::posix_time::microsec_clock::local_time();
+    l_oFrame.m_oRgb         = oRgb;
+    l_oFrame.m_oDepth       = oDepth;
+
+    SWHeadDetection l_oDetection;
+
+    // the detection stage has been stopped by an exception, the inputs are not consumed anymore
+    if(m_oDetectionStage.hasFailed())
+    {
+        std::cerr << "-ERROR : SWHeadMotionPipeline::computeHeadMotion -> detection stage stopped : " << m_oDetectionStage.errorMessage() << std::endl;
+        return -1;
+    }
+
+    if(m_bLowLatency)
+    {
+        // the same source frame is not detected twice
+        if(i32SourceFrameId < 0 || i32SourceFrameId != m_i32LastSourceFrameId)
+        {
+            m_i32LastSourceFrameId = i32SourceFrameId;
+            m_oLatestInput.push(l_oFrame);
+            ++m_ui32InputFramesNb;
+        }
+
+        // newest detection, without waiting
+        if(!m_oLatestDetection.pop(l_oDetection, 0))
+        {
+            return 2;
+        }
+    }
+    else
+    {
+        m_oInputQueue.push(l_oFrame);
+        ++m_ui32InputFramesNb;
+
+        if(m_ui32InputFramesNb - m_ui32ResultsNb <= m_ui32Depth)
+        {
+            return 2;
+        }
+
+        if(!m_oDetectionQueue.pop(l_oDetection))
+        {
+            return -1;
+        }
+    }
+
+    ++m_ui32ResultsNb;
+    m_ui32LastResultFrameId = l_oDetection.m_ui32FrameId;
+    oDisplayDetectFace      = l_oDetection.m_oDisplayDetectFace;
+
+    return m_pCaptureHeadMotion->alignHead(oHeadRigidMotion, l_oDetection);
+}
+
+uint SWHeadMotionPipeline::lastResultFrameId() const
+{
+    return m_ui32LastResultFrameId;
+}
+
+uint SWHeadMotionPipeline::skippedFramesNb()
+{
+    return m_oLatestInput.skippedFramesNb() + m_oLatestDetection.skippedFramesNb();
+}
+
+int SWHeadMotionPipeline::detectionStage(SWHeadDetection &oDetection)
+{
+    SWHeadMotionFrame l_oFrame;
+
+    if(!(m_bLowLatency ? m_oLatestInput.pop(l_oFrame, 100) : m_oInputQueue.pop(l_oFrame, 100)))
+    {
+        return 0;
+    }
+
+    // new detection : the previous one may still be in the alignment stage
+    oDetection = SWHeadDetection();
+    m_pCaptureHeadMotion->detectHead(oDetection, l_oFrame.m_oRgb, l_oFrame.m_oDepth);
+    oDetection.m_ui32FrameId = l_oFrame.m_ui32FrameId;
+    oDetection.m_oInputTime  = l_oFrame.m_oInputTime;
+
+    return 1;
+}
+
 //cv::Point3f SWCaptureHeadMotion::computeNoseTip(cv::Mat &oFaceDepth, int &idX, int &idY)
 //{
 //    float l_fMinDist = FLT_MAX;
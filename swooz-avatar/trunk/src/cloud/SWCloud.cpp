@@ -40,6 +40,8 @@
 #include <time.h>
 #include <iterator>
 #include <sstream>
+#include <algorithm>
+#include <cmath>
 
 #include "geometryUtility.h"
 
@@ -1208,24 +1210,12 @@ float SWCloud::squareDistancePoint(const SWCloud &oCloud, cuint ui32IndiceP)
 	return l_fMinDist;
 }
 
-float SWCloud::squareDistanceCloud(const SWCloud &oCloud, cbool bReduce, cfloat ui32CoeffReduce)
+float SWCloud::squareDistanceCloud(const SWCloud &oCloud, cbool bReduce, cfloat ui32CoeffReduce) const
 {
-	SWCloud l_oCloud;
-	l_oCloud.copy(oCloud);
-	
-	float l_squareDistance = 0;
-	
-	if(bReduce)
-	{
-        l_oCloud.reduce2(static_cast<int>(ui32CoeffReduce));
-	}
-    #pragma omp parallel for num_threads(4)
-        for(int ii = 0; ii < static_cast<int>(l_oCloud.size()); ++ii)
-        {
-            l_squareDistance += squareDistancePoint(l_oCloud,ii);
-        }
-	
-	return l_squareDistance/l_oCloud.size();
+    SWCloudIndex l_oIndex;
+    l_oIndex.build(*this);
+
+    return l_oIndex.squareDistanceCloud(oCloud, bReduce ? static_cast<uint>(ui32CoeffReduce) : 1);
 }
 
 std::vector<float> SWCloud::moveToOrigine()
@@ -1667,3 +1657,291 @@ bool SWCloud::saveToObj(const std::string &path, const std::string &nameObj)
 
     return true;
 }
+
+
+// ############################################# SWCloudIndex
+
+SWCloudIndex::SWCloudIndex() : m_fCellSize(1.f)
+{
+    clear();
+}
+
+void SWCloudIndex::clear()
+{
+    for(int ii = 0; ii < 3; ++ii)
+    {
+        m_aFMin[ii]       = 0.f;
+        m_aI32CellsNb[ii] = 0;
+    }
+
+    m_vCellsStart.clear();
+    m_vPoints.clear();
+    m_vIds.clear();
+}
+
+uint SWCloudIndex::size() const
+{
+    return static_cast<uint>(m_vIds.size());
+}
+
+int SWCloudIndex::cellId(cint i32X, cint i32Y, cint i32Z) const
+{
+    return (i32Z * m_aI32CellsNb[1] + i32Y) * m_aI32CellsNb[0] + i32X;
+}
+
+void SWCloudIndex::build(const SWCloud &oCloud)
+{
+    clear();
+
+    cuint l_ui32PointsNb = oCloud.size();
+    if(l_ui32PointsNb == 0)
+    {
+        return;
+    }
+
+    // bounding box
+        float l_aFMax[3];
+        for(int ii = 0; ii < 3; ++ii)
+        {
+            m_aFMin[ii] = l_aFMax[ii] = oCloud.coord(ii)[0];
+
+            for(uint jj = 1; jj < l_ui32PointsNb; ++jj)
+            {
+                float l_fValue = oCloud.coord(ii)[jj];
+                m_aFMin[ii] = (l_fValue < m_aFMin[ii]) ? l_fValue : m_aFMin[ii];
+                l_aFMax[ii] = (l_fValue > l_aFMax[ii]) ? l_fValue : l_aFMax[ii];
+            }
+        }
+
+    // the clouds are surfaces : about 4 points per cell on the plane of the two largest extents, the cells number is bounded for volumes
+        float l_aFExtents[3] = {l_aFMax[0] - m_aFMin[0], l_aFMax[1] - m_aFMin[1], l_aFMax[2] - m_aFMin[2]};
+        std::vector<float> l_vSortedExtents(l_aFExtents, l_aFExtents + 3);
+        std::sort(l_vSortedExtents.begin(), l_vSortedExtents.end());
+
+        m_fCellSize = sqrt(4.f * l_vSortedExtents[2] * l_vSortedExtents[1] / l_ui32PointsNb);
+        if(m_fCellSize <= 0.f)
+        {
+            m_fCellSize = (l_vSortedExtents[2] > 0.f) ? l_vSortedExtents[2] / l_ui32PointsNb : 1.f;
+        }
+
+        double l_dCellsNb;
+        do
+        {
+            l_dCellsNb = 1.0;
+            for(int ii = 0; ii < 3; ++ii)
+            {
+                m_aI32CellsNb[ii] = static_cast<int>(l_aFExtents[ii] / m_fCellSize) + 1;
+                l_dCellsNb *= m_aI32CellsNb[ii];
+            }
+
+            if(l_dCellsNb > 8.0 * l_ui32PointsNb + 64.0)
+            {
+                m_fCellSize *= 1.25f;
+            }
+        }
+        while(l_dCellsNb > 8.0 * l_ui32PointsNb + 64.0);
+
+    // counting sort of the points by cell
+        std::vector<int> l_vPointsCell(l_ui32PointsNb);
+        m_vCellsStart.assign(static_cast<uint>(l_dCellsNb) + 1, 0);
+
+        for(uint ii = 0; ii < l_ui32PointsNb; ++ii)
+        {
+            int l_aI32Cell[3];
+            for(int jj = 0; jj < 3; ++jj)
+            {
+                l_aI32Cell[jj] = static_cast<int>((oCloud.coord(jj)[ii] - m_aFMin[jj]) / m_fCellSize);
+                l_aI32Cell[jj] = (l_aI32Cell[jj] < m_aI32CellsNb[jj]) ? l_aI32Cell[jj] : m_aI32CellsNb[jj] - 1;
+            }
+
+            l_vPointsCell[ii] = cellId(l_aI32Cell[0], l_aI32Cell[1], l_aI32Cell[2]);
+            ++m_vCellsStart[l_vPointsCell[ii] + 1];
+        }
+
+        for(uint ii = 1; ii < m_vCellsStart.size(); ++ii)
+        {
+            m_vCellsStart[ii] += m_vCellsStart[ii-1];
+        }
+
+        std::vector<uint> l_vCellsFill(m_vCellsStart.begin(), m_vCellsStart.end() - 1);
+        m_vPoints.resize(3 * l_ui32PointsNb);
+        m_vIds.resize(l_ui32PointsNb);
+
+        for(uint ii = 0; ii < l_ui32PointsNb; ++ii)
+        {
+            uint l_ui32Id = l_vCellsFill[l_vPointsCell[ii]]++;
+            m_vPoints[3 * l_ui32Id]     = oCloud.coord(0)[ii];
+            m_vPoints[3 * l_ui32Id + 1] = oCloud.coord(1)[ii];
+            m_vPoints[3 * l_ui32Id + 2] = oCloud.coord(2)[ii];
+            m_vIds[l_ui32Id] = ii;
+        }
+}
+
+void SWCloudIndex::searchCell(cint i32CellId, cfloat fX, cfloat fY, cfloat fZ, float &fMinDist, int &i32MinId) const
+{
+    for(uint ii = m_vCellsStart[i32CellId]; ii < m_vCellsStart[i32CellId + 1]; ++ii)
+    {
+        float l_fDX = m_vPoints[3 * ii]     - fX;
+        float l_fDY = m_vPoints[3 * ii + 1] - fY;
+        float l_fDZ = m_vPoints[3 * ii + 2] - fZ;
+        float l_fDist = l_fDX * l_fDX + l_fDY * l_fDY + l_fDZ * l_fDZ;
+
+        // equal distances : the lowest id is kept, the result doesn't depend on the grid
+        if(l_fDist < fMinDist || (l_fDist == fMinDist && static_cast<int>(m_vIds[ii]) < i32MinId))
+        {
+            fMinDist = l_fDist;
+            i32MinId = static_cast<int>(m_vIds[ii]);
+        }
+    }
+}
+
+float SWCloudIndex::squareDistancePoint(cfloat fX, cfloat fY, cfloat fZ, int *pI32Id) const
+{
+    float l_fMinDist = FLT_MAX;
+    int l_i32MinId   = -1;
+
+    if(m_vIds.size() > 0)
+    {
+        // cell of the point, clamped to the grid
+            cfloat l_aFPt[3] = {fX, fY, fZ};
+            int l_aI32Cell[3];
+            for(int ii = 0; ii < 3; ++ii)
+            {
+                l_aI32Cell[ii] = static_cast<int>(floor((l_aFPt[ii] - m_aFMin[ii]) / m_fCellSize));
+                l_aI32Cell[ii] = (l_aI32Cell[ii] < 0) ? 0 : ((l_aI32Cell[ii] >= m_aI32CellsNb[ii]) ? m_aI32CellsNb[ii] - 1 : l_aI32Cell[ii]);
+            }
+
+            int l_i32MaxRing = std::max(m_aI32CellsNb[0], std::max(m_aI32CellsNb[1], m_aI32CellsNb[2]));
+
+        // visit the cells ring by ring, the points of the ring r are at least at (r-1) cells of the input point
+            for(int r = 0; r <= l_i32MaxRing; ++r)
+            {
+                float l_fRingDist = (r - 1) * m_fCellSize;
+                if(r > 1 && l_fRingDist * l_fRingDist >= l_fMinDist)
+                {
+                    break;
+                }
+
+                int l_aI32Begin[3], l_aI32End[3];
+                for(int ii = 0; ii < 3; ++ii)
+                {
+                    l_aI32Begin[ii] = std::max(l_aI32Cell[ii] - r, 0);
+                    l_aI32End[ii]   = std::min(l_aI32Cell[ii] + r, m_aI32CellsNb[ii] - 1);
+                }
+
+                for(int z = l_aI32Begin[2]; z <= l_aI32End[2]; ++z)
+                {
+                    bool l_bBorderZ = (abs(z - l_aI32Cell[2]) == r);
+
+                    for(int y = l_aI32Begin[1]; y <= l_aI32End[1]; ++y)
+                    {
+                        bool l_bBorderY = l_bBorderZ || (abs(y - l_aI32Cell[1]) == r);
+
+                        if(l_bBorderY)
+                        {
+                            for(int x = l_aI32Begin[0]; x <= l_aI32End[0]; ++x)
+                            {
+                                searchCell(cellId(x, y, z), fX, fY, fZ, l_fMinDist, l_i32MinId);
+                            }
+                        }
+                        else
+                        {
+                            // only the two cells of the ring surface, the inside has been visited before
+                            if(l_aI32Cell[0] - r >= 0)
+                            {
+                                searchCell(cellId(l_aI32Cell[0] - r, y, z), fX, fY, fZ, l_fMinDist, l_i32MinId);
+                            }
+                            if(l_aI32Cell[0] + r < m_aI32CellsNb[0])
+                            {
+                                searchCell(cellId(l_aI32Cell[0] + r, y, z), fX, fY, fZ, l_fMinDist, l_i32MinId);
+                            }
+                        }
+                    }
+                }
+            }
+    }
+
+    if(pI32Id)
+    {
+        *pI32Id = l_i32MinId;
+    }
+
+    return l_fMinDist;
+}
+
+void SWCloudIndex::squareDistances(const SWCloud &oCloud, cuint ui32Step, std::vector<float> &vSquareDistances) const
+{
+    cuint l_ui32Step = (ui32Step > 0) ? ui32Step : 1;
+    cint l_i32SamplesNb = static_cast<int>((oCloud.size() + l_ui32Step - 1) / l_ui32Step);
+    vSquareDistances.resize(l_i32SamplesNb);
+
+    const float *l_aFX = oCloud.coord(0), *l_aFY = oCloud.coord(1), *l_aFZ = oCloud.coord(2);
+
+    // fixed sampling (no random reduction) and one result per sample : the values don't depend on the threads number
+    #pragma omp parallel for schedule(dynamic, 64)
+        for(int ii = 0; ii < l_i32SamplesNb; ++ii)
+        {
+            uint l_ui32Id = ii * l_ui32Step;
+            vSquareDistances[ii] = squareDistancePoint(l_aFX[l_ui32Id], l_aFY[l_ui32Id], l_aFZ[l_ui32Id]);
+        }
+}
+
+float SWCloudIndex::squareDistanceCloud(const SWCloud &oCloud, cuint ui32Step) const
+{
+    std::vector<float> l_vSquareDistances;
+    squareDistances(oCloud, ui32Step, l_vSquareDistances);
+
+    if(l_vSquareDistances.size() == 0 || size() == 0)
+    {
+        return 0.f;
+    }
+
+    // sequential sum in double, the result is the same for any number of threads
+        double l_dSum = 0.0;
+        for(uint ii = 0; ii < l_vSquareDistances.size(); ++ii)
+        {
+            l_dSum += l_vSquareDistances[ii];
+        }
+
+    return static_cast<float>(l_dSum / l_vSquareDistances.size());
+}
+
+void SWCloudIndex::squareDistanceStats(const SWCloud &oCloud, SWCloudDistanceStats &oStats, cuint ui32Step, cfloat fInlierSquareDist, cfloat fTrimRatio) const
+{
+    std::vector<float> l_vSquareDistances;
+    squareDistances(oCloud, ui32Step, l_vSquareDistances);
+
+    oStats.m_ui32SamplesNb = static_cast<uint>(l_vSquareDistances.size());
+    oStats.m_fMean = oStats.m_fMedian = oStats.m_fTrimmedMean = oStats.m_fInlierRatio = 0.f;
+
+    if(oStats.m_ui32SamplesNb == 0 || size() == 0)
+    {
+        return;
+    }
+
+    std::sort(l_vSquareDistances.begin(), l_vSquareDistances.end());
+
+    cuint l_ui32TrimmedNb = std::max(1u, std::min(oStats.m_ui32SamplesNb, static_cast<uint>(fTrimRatio * oStats.m_ui32SamplesNb)));
+    double l_dSum = 0.0, l_dTrimmedSum = 0.0;
+    uint l_ui32InliersNb = 0;
+
+    for(uint ii = 0; ii < oStats.m_ui32SamplesNb; ++ii)
+    {
+        l_dSum += l_vSquareDistances[ii];
+
+        if(ii < l_ui32TrimmedNb)
+        {
+            l_dTrimmedSum += l_vSquareDistances[ii];
+        }
+
+        if(l_vSquareDistances[ii] <= fInlierSquareDist)
+        {
+            ++l_ui32InliersNb;
+        }
+    }
+
+    oStats.m_fMean        = static_cast<float>(l_dSum / oStats.m_ui32SamplesNb);
+    oStats.m_fMedian      = l_vSquareDistances[oStats.m_ui32SamplesNb / 2];
+    oStats.m_fTrimmedMean = static_cast<float>(l_dTrimmedSum / l_ui32TrimmedNb);
+    oStats.m_fInlierRatio = static_cast<float>(l_ui32InliersNb) / oStats.m_ui32SamplesNb;
+}
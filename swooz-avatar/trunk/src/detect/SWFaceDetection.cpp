@@ -278,46 +278,29 @@ void SWFaceDetection::displayFace(cv::Mat &oRgbImg, cv::Scalar oColor)
 
 cv::Point3f SWFaceDetection::computeNoseTip(cv::Mat &oMatDepth, int &idX, int &idY)
 {
+    // the nose tip is the mean position of the points closer than the closest point + 0.0035,
+    // the points are gathered in the same pass than the min search : a point under the final threshold is also under the current
+    // one when it is visited, the candidates are filtered with the final threshold at the end
+    const float l_fDepthRange = 0.0035f;
     float l_fMinDist = FLT_MAX;
     cv::Point3f l_oNoseTip;
 
-    // find the closest point
-
-    for(int ii = 0; ii < oMatDepth.rows; ++ii)
-    {
-        for(int jj = 0; jj < oMatDepth.cols; ++jj)
-        {
-            float l_fCurrDepth = oMatDepth.at<cv::Vec3f>(ii,jj)[2]; // retrieve current depth
-
-            if(l_fCurrDepth == 0)
-            {
-                // if null value of to the next value
-                continue;
-            }
-
-            if(l_fCurrDepth < l_fMinDist)
-            {
-                l_fMinDist = l_fCurrDepth;
-            }
-        }
-    }
-
-    float l_fMaxDist = l_fMinDist + 0.0035f;
-//    float l_fMaxDist = l_fMinDist + 0.01f;
-
     struct PointCoordinate
     {
         int ii;
         int jj;
+        float depth;
     };
 
     std::vector<PointCoordinate> l_oMinPoints;
 
     for(int ii = 0; ii < oMatDepth.rows; ++ii)
     {
+        const cv::Vec3f *l_pRow = oMatDepth.ptr<cv::Vec3f>(ii);
+
         for(int jj = 0; jj < oMatDepth.cols; ++jj)
         {
-            float l_fCurrDepth = oMatDepth.at<cv::Vec3f>(ii,jj)[2]; // retrieve current depth
+            float l_fCurrDepth = l_pRow[jj][2]; // retrieve current depth
 
             if(l_fCurrDepth == 0)
             {
@@ -325,29 +308,46 @@ cv::Point3f SWFaceDetection::computeNoseTip(cv::Mat &oMatDepth, int &idX, int &i
                 continue;
             }
 
-            if(l_fCurrDepth < l_fMaxDist)
+            if(l_fCurrDepth < l_fMinDist)
+            {
+                l_fMinDist = l_fCurrDepth;
+            }
+
+            if(l_fCurrDepth < l_fMinDist + l_fDepthRange)
             {
                 PointCoordinate pt;
                 pt.ii = ii;
                 pt.jj = jj;
+                pt.depth = l_fCurrDepth;
                 l_oMinPoints.push_back(pt);
             }
         }
     }
 
+    if(l_oMinPoints.size() == 0)
+    {
+        idX = idY = 0;
+        return l_oNoseTip;
+    }
+
+    float l_fMaxDist = l_fMinDist + l_fDepthRange;
 
     int l_i32SumII = 0;
     int l_i32SumJJ = 0;
+    int l_i32PointsNb = 0;
 
     for(uint ii = 0; ii < l_oMinPoints.size(); ++ii)
     {
-        l_i32SumII += l_oMinPoints[ii].ii;
-        l_i32SumJJ += l_oMinPoints[ii].jj;
+        if(l_oMinPoints[ii].depth < l_fMaxDist)
+        {
+            l_i32SumII += l_oMinPoints[ii].ii;
+            l_i32SumJJ += l_oMinPoints[ii].jj;
+            ++l_i32PointsNb;
+        }
     }
 
-    l_i32SumII /= static_cast<int>(l_oMinPoints.size());
-    l_i32SumJJ /= static_cast<int>(l_oMinPoints.size());
-
+    l_i32SumII /= l_i32PointsNb;
+    l_i32SumJJ /= l_i32PointsNb;
 
     idY = l_i32SumII;
     idX = l_i32SumJJ;
@@ -355,7 +355,6 @@ cv::Point3f SWFaceDetection::computeNoseTip(cv::Mat &oMatDepth, int &idX, int &i
     l_oNoseTip = oMatDepth.at<cv::Vec3f>(l_i32SumII,l_i32SumJJ);
 
     return l_oNoseTip;
-
 }
 
 //cv::Point3f SWFaceDetection::computeNoseTip(cv::Mat &oFaceDepth, int &idX, int &idY)
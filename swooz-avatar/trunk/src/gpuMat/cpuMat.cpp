@@ -0,0 +1,303 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file cpuMat.cpp
+ * \brief CPU implementation of the swCuda matrix utilities (used on computers without CUDA/CULA)
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#include <iostream>
+
+#include "gpuMat/gpuMatUtility.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define CPU_GEMM_BLOCK 64    /**< size of the square blocks used by cpuMatMult to stay in the L1/L2 caches */
+
+static int initMatBackend()
+{
+#ifdef SW_CPU_MAT
+    return SW_MAT_BACKEND_CPU;
+#else
+    // SW_MAT_BACKEND=cpu forces the CPU backend on a CUDA build
+    const char *l_sBackend = getenv("SW_MAT_BACKEND");
+
+    if(l_sBackend && (strcmp(l_sBackend, "cpu") == 0 || strcmp(l_sBackend, "CPU") == 0))
+    {
+        return SW_MAT_BACKEND_CPU;
+    }
+
+    return SW_MAT_BACKEND_GPU;
+#endif
+}
+
+static int g_i32MatBackend = initMatBackend();
+
+int matBackend()
+{
+    return g_i32MatBackend;
+}
+
+void setMatBackend(int i32Backend)
+{
+#ifdef SW_CPU_MAT
+    if(i32Backend != SW_MAT_BACKEND_CPU)
+    {
+        std::cerr << "-WARNING : setMatBackend -> built without CUDA, only the CPU backend is available. " << std::endl;
+    }
+#else
+    g_i32MatBackend = i32Backend;
+#endif
+}
+
+void cpuMatMult(const Matrix A, const Matrix B, Matrix C)
+{
+    std::fill_n(C.elements, C.height * C.width, 0.f);
+
+    // C(ii,jj) += A(ii,kk) * B(kk,jj), blocked on the three dimensions, the inner loop is contiguous in B and C
+    #pragma omp parallel for schedule(dynamic)
+    for(int ii0 = 0; ii0 < A.height; ii0 += CPU_GEMM_BLOCK)
+    {
+        int l_i32IIEnd = std::min(ii0 + CPU_GEMM_BLOCK, A.height);
+
+        for(int kk0 = 0; kk0 < A.width; kk0 += CPU_GEMM_BLOCK)
+        {
+            int l_i32KKEnd = std::min(kk0 + CPU_GEMM_BLOCK, A.width);
+
+            for(int jj0 = 0; jj0 < B.width; jj0 += CPU_GEMM_BLOCK)
+            {
+                int l_i32JJEnd = std::min(jj0 + CPU_GEMM_BLOCK, B.width);
+
+                for(int ii = ii0; ii < l_i32IIEnd; ++ii)
+                {
+                    float *l_aFC = &C.elements[ii * C.width];
+                    const float *l_aFA = &A.elements[ii * A.width];
+
+                    for(int kk = kk0; kk < l_i32KKEnd; ++kk)
+                    {
+                        const float l_fA = l_aFA[kk];
+
+                        if(l_fA == 0.f)
+                        {
+                            continue;
+                        }
+
+                        const float *l_aFB = &B.elements[kk * B.width];
+
+                        for(int jj = jj0; jj < l_i32JJEnd; ++jj)
+                        {
+                            l_aFC[jj] += l_fA * l_aFB[jj];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+int cpuSgesv(float *aFA, float *aFB, int i32N, int i32NRHS)
+{
+    // LU decomposition with partial pivoting, column-major storage as LAPACK/CULA (A(ii,jj) = aFA[jj*i32N + ii])
+    std::vector<int> l_vPivots(i32N);
+
+    for(int kk = 0; kk < i32N; ++kk)
+    {
+        float *l_aFColK = &aFA[kk * i32N];
+
+        // find pivot
+            int l_i32Pivot = kk;
+            float l_fMax = std::fabs(l_aFColK[kk]);
+            for(int ii = kk + 1; ii < i32N; ++ii)
+            {
+                if(std::fabs(l_aFColK[ii]) > l_fMax)
+                {
+                    l_fMax = std::fabs(l_aFColK[ii]);
+                    l_i32Pivot = ii;
+                }
+            }
+
+            if(l_fMax == 0.f)
+            {
+                std::cerr << "-ERROR : cpuSgesv -> singular matrix. " << std::endl;
+                return -1;
+            }
+
+            l_vPivots[kk] = l_i32Pivot;
+
+        // swap rows
+            if(l_i32Pivot != kk)
+            {
+                for(int jj = 0; jj < i32N; ++jj)
+                {
+                    std::swap(aFA[jj * i32N + kk], aFA[jj * i32N + l_i32Pivot]);
+                }
+            }
+
+        // compute L column
+            const float l_fInvPivot = 1.f / l_aFColK[kk];
+            for(int ii = kk + 1; ii < i32N; ++ii)
+            {
+                l_aFColK[ii] *= l_fInvPivot;
+            }
+
+        // update trailing sub-matrix, each column is independent
+            #pragma omp parallel for if(i32N - kk > 256)
+            for(int jj = kk + 1; jj < i32N; ++jj)
+            {
+                float *l_aFColJ = &aFA[jj * i32N];
+                const float l_fAKJ = l_aFColJ[kk];
+
+                if(l_fAKJ != 0.f)
+                {
+                    for(int ii = kk + 1; ii < i32N; ++ii)
+                    {
+                        l_aFColJ[ii] -= l_aFColK[ii] * l_fAKJ;
+                    }
+                }
+            }
+    }
+
+    // solve L.U.X = P.B for each right hand side
+    #pragma omp parallel for
+    for(int rr = 0; rr < i32NRHS; ++rr)
+    {
+        float *l_aFX = &aFB[rr * i32N];
+
+        for(int kk = 0; kk < i32N; ++kk)
+        {
+            std::swap(l_aFX[kk], l_aFX[l_vPivots[kk]]);
+        }
+
+        // forward substitution (unit lower)
+        for(int kk = 0; kk < i32N; ++kk)
+        {
+            const float l_fXK = l_aFX[kk];
+            const float *l_aFColK = &aFA[kk * i32N];
+
+            for(int ii = kk + 1; ii < i32N; ++ii)
+            {
+                l_aFX[ii] -= l_aFColK[ii] * l_fXK;
+            }
+        }
+
+        // backward substitution (upper)
+        for(int kk = i32N - 1; kk >= 0; --kk)
+        {
+            const float *l_aFColK = &aFA[kk * i32N];
+            l_aFX[kk] /= l_aFColK[kk];
+
+            const float l_fXK = l_aFX[kk];
+            for(int ii = 0; ii < kk; ++ii)
+            {
+                l_aFX[ii] -= l_aFColK[ii] * l_fXK;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int cpuSposv(float *aFA, float *aFB, int i32N, int i32NRHS)
+{
+    // Cholesky decomposition A = L.LT, only the lower part of the column-major input is used
+    for(int kk = 0; kk < i32N; ++kk)
+    {
+        float *l_aFColK = &aFA[kk * i32N];
+
+        // not reported, the caller falls back on the LU solve
+        if(l_aFColK[kk] <= 0.f)
+        {
+            return -1;
+        }
+
+        const float l_fLKK = std::sqrt(l_aFColK[kk]);
+        l_aFColK[kk] = l_fLKK;
+
+        const float l_fInvLKK = 1.f / l_fLKK;
+        for(int ii = kk + 1; ii < i32N; ++ii)
+        {
+            l_aFColK[ii] *= l_fInvLKK;
+        }
+
+        // update trailing lower part
+        #pragma omp parallel for schedule(dynamic, 16) if(i32N - kk > 256)
+        for(int jj = kk + 1; jj < i32N; ++jj)
+        {
+            float *l_aFColJ = &aFA[jj * i32N];
+            const float l_fLJK = l_aFColK[jj];
+
+            if(l_fLJK != 0.f)
+            {
+                for(int ii = jj; ii < i32N; ++ii)
+                {
+                    l_aFColJ[ii] -= l_aFColK[ii] * l_fLJK;
+                }
+            }
+        }
+    }
+
+    // solve L.LT.X = B for each right hand side
+    #pragma omp parallel for
+    for(int rr = 0; rr < i32NRHS; ++rr)
+    {
+        float *l_aFX = &aFB[rr * i32N];
+
+        // L.Y = B
+        for(int kk = 0; kk < i32N; ++kk)
+        {
+            const float *l_aFColK = &aFA[kk * i32N];
+            l_aFX[kk] /= l_aFColK[kk];
+
+            const float l_fYK = l_aFX[kk];
+            for(int ii = kk + 1; ii < i32N; ++ii)
+            {
+                l_aFX[ii] -= l_aFColK[ii] * l_fYK;
+            }
+        }
+
+        // LT.X = Y
+        for(int kk = i32N - 1; kk >= 0; --kk)
+        {
+            const float *l_aFColK = &aFA[kk * i32N];
+
+            float l_fSum = l_aFX[kk];
+            for(int ii = kk + 1; ii < i32N; ++ii)
+            {
+                l_fSum -= l_aFColK[ii] * l_aFX[ii];
+            }
+
+            l_aFX[kk] = l_fSum / l_aFColK[kk];
+        }
+    }
+
+    return 0;
+}
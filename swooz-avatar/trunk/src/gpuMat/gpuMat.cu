@@ -38,6 +38,42 @@ int doCulaSgesv(float *aFInputMat, float *aFOutputInvMat, int i32SizeSquareMat)
     return 0;
 }
 
+int doCulaSolve(float *aFMatA, float *aFMatB, int i32N, int i32NRHS, bool bSymmetricPositive)
+{
+    culaStatus l_oStatus;
+
+    // init cula
+    l_oStatus = culaInitialize();
+    // check error
+    if(l_oStatus != culaNoError)
+    {
+        std::cerr << "Error cuda init : " << culaGetErrorInfo() << std::endl;
+        return -1;
+    }
+
+    // launch gpu computing
+    if(bSymmetricPositive)
+    {
+        l_oStatus = culaSposv('L', i32N, i32NRHS, aFMatA, i32N, aFMatB, i32N);
+    }
+    else
+    {
+        int *l_aI32Ipiv = new int[i32N];
+        l_oStatus = culaSgesv(i32N, i32NRHS, aFMatA, i32N, l_aI32Ipiv, aFMatB, i32N);
+        delete[] l_aI32Ipiv;
+    }
+
+    // a failed Cholesky solve is not reported, the caller falls back on the LU solve
+    if(l_oStatus != culaNoError && !bSymmetricPositive)
+    {
+        std::cerr << "Error doCulaSolve : " << culaGetErrorInfo() << std::endl;
+    }
+
+    culaShutdown();
+
+    return (l_oStatus == culaNoError) ? 0 : -1;
+}
+
 int LUDecomposition(float *aFMat, int i32SizeSquareMat)
 {
     culaStatus l_oStatus;
@@ -103,8 +103,7 @@ void SWGLCloudWidget::paintGL()
         if(m_pCloud->size() > 0)
         {
             drawCloud(m_oShader, m_glFSizePoint, m_oMVPMatrix);
-            swCloud::SWCloudBBox l_oBBox = m_pCloud->bBox();
-            drawDepthRect(m_oShader, m_oMVPMatrix, l_oBBox.m_fMinZ + m_fDepthRect);
+            drawDepthRect(m_oShader, m_oMVPMatrix, m_oCloudBBox.m_fMinZ + m_fDepthRect);
         }
     }
 }
@@ -153,6 +152,7 @@ void SWGLCloudWidget::setCloud(swCloud::SWCloud *oCloud, bool bResetCamera)
 
     deleteAndNullify(m_pCloud);
     m_pCloud = new swCloud::SWCloud(*oCloud);
+    m_oCloudBBox = m_pCloud->bBox();
     deleteAndNullify(oCloud);
     m_bNewCloud = true;
 
@@ -161,13 +161,7 @@ void SWGLCloudWidget::setCloud(swCloud::SWCloud *oCloud, bool bResetCamera)
 
 void SWGLCloudWidget::initCloudBuffers()
 {
-    initIndexBuffer(m_indexBufferCloud);
-    initVertexBuffer(m_vertexBufferCloud);
-    initVertexBuffer(m_colorBufferCloud);
-
-    m_indexBufferCloud.setUsagePattern(QGLBuffer::StaticDraw);
-    m_vertexBufferCloud.setUsagePattern(QGLBuffer::StaticDraw);
-    m_colorBufferCloud.setUsagePattern(QGLBuffer::StaticDraw);
+    m_oCloudRenderer.initBuffers();
 }
 
 
@@ -180,46 +174,8 @@ void SWGLCloudWidget::drawDepthRect(QGLShaderProgram &oShader, QMatrix4x4 &mvpMa
     // set mode
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
-    // release buffers
-    QGLBuffer::release(QGLBuffer::VertexBuffer);
-    QGLBuffer::release(QGLBuffer::IndexBuffer);
-
-    // allocate buffers
-    int l_i32SizeIndex      = sizeof(GLuint);
-    int l_i32SizeVertex     = sizeof(float) * 3;
-    uint32 *l_aDepthRectI   = new uint32[6];
-    float  *l_aDepthRectV   = new float[3*4];
-
-    // defines points    
-    l_aDepthRectV[2] = l_aDepthRectV[5] = l_aDepthRectV[8] = l_aDepthRectV[11] = fDepth;
-    l_aDepthRectV[0] = m_oCloudBBox.m_fMinX; l_aDepthRectV[3] = m_oCloudBBox.m_fMinX; l_aDepthRectV[6] = m_oCloudBBox.m_fMaxX; l_aDepthRectV[9]  = m_oCloudBBox.m_fMaxX;
-    l_aDepthRectV[1] = m_oCloudBBox.m_fMaxY; l_aDepthRectV[4] = m_oCloudBBox.m_fMinY; l_aDepthRectV[7] = m_oCloudBBox.m_fMinY; l_aDepthRectV[10] = m_oCloudBBox.m_fMaxY;
-    // define index
-    l_aDepthRectI[0] = 0;
-    l_aDepthRectI[1] = 1;
-    l_aDepthRectI[2] = 2;
-    l_aDepthRectI[3] = 2;
-    l_aDepthRectI[4] = 3;
-    l_aDepthRectI[5] = 0;
-
-    QGLBuffer l_indexBufferDepthRect,l_vertexBufferDepthRect;
-    initIndexBuffer(l_indexBufferDepthRect);
-    initVertexBuffer(l_vertexBufferDepthRect);
-
-    allocateBuffer(l_indexBufferDepthRect,  l_aDepthRectI, 6 * l_i32SizeIndex);
-    allocateBuffer(l_vertexBufferDepthRect, l_aDepthRectV, 4 * l_i32SizeVertex);
-
-    deleteAndNullifyArray(l_aDepthRectI);
-    deleteAndNullifyArray(l_aDepthRectV);
-
-    // set uniform values parameters
-    oShader.setUniformValue("displayMode", 1);
-    oShader.setUniformValue("uniColor", 22, 39, 51);
-    oShader.setUniformValue("mvpMatrix", mvpMatrix);
-    oShader.setUniformValue("opacity", 0.8f);
-
-    // draw primitives
-        drawBuffer(l_indexBufferDepthRect, l_vertexBufferDepthRect, oShader, GL_TRIANGLES);
+    // draw the rectangle with the cloud bounding box
+        m_oCloudRenderer.drawDepthRect(oShader, mvpMatrix, m_oCloudBBox, fDepth);
 
     oShader.release();
         checkGlError();
@@ -254,27 +210,12 @@ void SWGLCloudWidget::drawCloud(QGLShaderProgram &oShader, cfloat fSizePoint, QM
 
     if(m_bNewCloud)
     {
-        // allocate buffers
-        int l_i32SizeIndex      = sizeof(GLuint);
-        int l_i32SizeVertex     = sizeof(float) * 3;
-        uint32 *l_aCloudI       = m_pCloud->indexBuffer();
-        float  *l_aCloudV       = m_pCloud->vertexBuffer();
-        float  *l_aCloudC       = m_pCloud->colorBuffer();
-
-        allocateBuffer(m_indexBufferCloud,  l_aCloudI, m_pCloud->size() * l_i32SizeIndex);
-        allocateBuffer(m_vertexBufferCloud, l_aCloudV, m_pCloud->size() * l_i32SizeVertex);
-        allocateBuffer(m_colorBufferCloud  ,l_aCloudC, m_pCloud->size() * l_i32SizeVertex);
-
-        deleteAndNullifyArray(l_aCloudI);
-        deleteAndNullifyArray(l_aCloudV);
-        deleteAndNullifyArray(l_aCloudC);
-
+        m_oCloudRenderer.updateBuffers(*m_pCloud);
         m_bNewCloud = false;
     }
 
-
     // draw primitives
-        drawBufferWithColor(m_indexBufferCloud, m_vertexBufferCloud, m_colorBufferCloud, oShader, GL_POINTS);
+        m_oCloudRenderer.draw(oShader);
 
     oShader.release();
         checkGlError();
@@ -201,17 +201,7 @@ void SWGLMeshWidget::setMesh(swMesh::SWMesh *pMesh, bool bResetCamera)
 
 void SWGLMeshWidget::initMeshBuffers()
 {
-    // init
-        initIndexBuffer(m_indexBufferMesh);
-        initVertexBuffer(m_vertexBufferMesh);
-        initVertexBuffer(m_normalBufferMesh);
-        initVertexBuffer(m_textureBufferMesh);
-
-    // define the usage pattern
-        m_vertexBufferMesh.setUsagePattern(QGLBuffer::StaticDraw);
-        m_indexBufferMesh.setUsagePattern(QGLBuffer::StaticDraw);
-        m_normalBufferMesh.setUsagePattern(QGLBuffer::StaticDraw);
-        m_textureBufferMesh.setUsagePattern(QGLBuffer::StaticDraw);
+    m_oMeshRenderer.initBuffers();
 }
 
 void SWGLMeshWidget::drawMesh()
@@ -219,13 +209,6 @@ void SWGLMeshWidget::drawMesh()
     m_oShaderMesh.bind();
         checkGlError();
 
-    // bind texture
-        if(m_bApplyTexture)
-        {
-            glBindTexture(GL_TEXTURE_2D, m_textureLocation);
-                checkGlError();
-        }
-
     // set mode
     m_oParamMutex.lockForRead();
         if(m_bLinesRender)
@@ -240,28 +223,9 @@ void SWGLMeshWidget::drawMesh()
         }
     m_oParamMutex.unlock();
 
-    // release buffers
-    QGLBuffer::release(QGLBuffer::VertexBuffer);
-    QGLBuffer::release(QGLBuffer::IndexBuffer);
-
     if(m_bNewMesh)
     {
-        float *l_aFVertexBuffer = m_pMesh->vertexBuffer();
-        uint32 *l_aUI32IndexBuffer = m_pMesh->indexVertexTriangleBuffer();
-        float *l_aFNormalBuffer = m_pMesh->normalBuffer();
-        float *l_aFTextureBuffer = m_pMesh->textureBuffer();
-
-        // allocate QGL buffers
-        allocateBuffer(m_vertexBufferMesh, l_aFVertexBuffer, m_pMesh->pointsNumber() * 3 * sizeof(float) );
-        allocateBuffer(m_indexBufferMesh, l_aUI32IndexBuffer, m_pMesh->trianglesNumber() * 3 * sizeof(GLuint) );
-        allocateBuffer(m_normalBufferMesh, l_aFNormalBuffer, m_pMesh->pointsNumber() * 3 * sizeof(float) );
-        allocateBuffer(m_textureBufferMesh, l_aFTextureBuffer, m_pMesh->pointsNumber() * 2 * sizeof(float) );
-
-        deleteAndNullifyArray(l_aFVertexBuffer);
-        deleteAndNullifyArray(l_aUI32IndexBuffer);
-        deleteAndNullifyArray(l_aFNormalBuffer);
-        deleteAndNullifyArray(l_aFTextureBuffer);
-
+        m_oMeshRenderer.updateBuffers(*m_pMesh);
         m_bNewMesh = false;
     }
 
@@ -279,7 +243,7 @@ void SWGLMeshWidget::drawMesh()
     m_oShaderMesh.setUniformValue("viewDirection", -m_pCamera->lookAt());
 
 
-    drawBufferWithTexture(m_indexBufferMesh, m_vertexBufferMesh, m_textureBufferMesh, m_normalBufferMesh, m_oShaderMesh, GL_TRIANGLES);
+    m_oMeshRenderer.drawWithTexture(m_oShaderMesh, m_bApplyTexture ? m_textureLocation : 0);
 
     m_oShaderMesh.release();
         checkGlError();
@@ -33,6 +33,7 @@
 
 #include "interface/QtWidgets/SWGLMultiObjectWidget.h"
 #include <iostream>
+#include <algorithm>
 
 #include "moc_SWGLMultiObjectWidget.cpp"
 
@@ -40,10 +41,62 @@
 
 #include <QGLFunctions>
 
+
+SWAnimationTripleBuffer::SWAnimationTripleBuffer(cint i32PointsNumber) : m_i32BackIndex(0), m_i32FrontIndex(1), m_aI32MiddleIndex(2), m_aI32PublishedNumber(0)
+{
+    for(int ii = 0; ii < 3; ++ii)
+    {
+        m_aSlots[ii].m_isCloud = false;
+        m_aSlots[ii].m_index = -1;
+        m_aSlots[ii].m_animationStarted = false;
+        m_aSlots[ii].m_animationOffsetsX = QVector<float>(i32PointsNumber, 0.f);
+        m_aSlots[ii].m_animationOffsetsY = QVector<float>(i32PointsNumber, 0.f);
+        m_aSlots[ii].m_animationOffsetsZ = QVector<float>(i32PointsNumber, 0.f);
+        m_aSlots[ii].m_animationRigidMotion = QVector<float>(6, 0.f);
+    }
+}
+
+SWAnimationSendData &SWAnimationTripleBuffer::backSlot()
+{
+    return m_aSlots[m_i32BackIndex];
+}
+
+void SWAnimationTripleBuffer::publish()
+{
+    // swap the back slot with the middle one, the release ordering makes the slot content visible before its index
+    m_i32BackIndex = m_aI32MiddleIndex.fetchAndStoreOrdered(m_i32BackIndex | m_i32FreshFlag) & ~m_i32FreshFlag;
+    m_aI32PublishedNumber.fetchAndAddRelaxed(1);
+}
+
+bool SWAnimationTripleBuffer::update()
+{
+    if(!(m_aI32MiddleIndex.fetchAndAddAcquire(0) & m_i32FreshFlag))
+    {
+        return false;
+    }
+
+    // swap the front slot with the middle one, the read slot is given back without the fresh flag
+    m_i32FrontIndex = m_aI32MiddleIndex.fetchAndStoreOrdered(m_i32FrontIndex) & ~m_i32FreshFlag;
+
+    return true;
+}
+
+const SWAnimationSendData &SWAnimationTripleBuffer::frontSlot() const
+{
+    return m_aSlots[m_i32FrontIndex];
+}
+
+int SWAnimationTripleBuffer::publishedNumber() const
+{
+    return const_cast<QAtomicInt&>(m_aI32PublishedNumber).fetchAndAddRelaxed(0);
+}
+
+
 SWGLMultiObjectWidget::SWGLMultiObjectWidget(QGLContext *context, QWidget* parent) :
-    SWGLWidget(context, parent)
+    SWGLWidget(context, parent), m_i32PaintedFrames(0), m_i32AnimationFrames(0), m_i32StaleAnimationFrames(0), m_i32DroppedAnimationFrames(0), m_i32MaxPaintTime(0), m_bVerbosePacing(false)
 {
     m_sendAnimations = true;
+    m_oPacingTime.start();
 }
 
 SWGLMultiObjectWidget::~SWGLMultiObjectWidget()
@@ -211,9 +264,8 @@ void SWGLMultiObjectWidget::addCloud(const QString &sPathCloud)
         l_pCloudParam->m_vUnicolor = QVector3D(255.,0.,0.);        
         // animation
         l_pCloudParam->m_animationStarted = false;
-        l_pCloudParam->m_animationOffsetsX = QVector<float>(l_pCloud->size(),0.f);
-        l_pCloudParam->m_animationOffsetsY = QVector<float>(l_pCloud->size(),0.f);
-        l_pCloudParam->m_animationOffsetsZ = QVector<float>(l_pCloud->size(),0.f);
+        l_pCloudParam->m_animationBuffer = SWAnimationTripleBufferPtr(new SWAnimationTripleBuffer(l_pCloud->size()));
+        l_pCloudParam->m_animationConsumedNumber = 0;
 
     // infos
         SWGLObjectInfos l_cloudInfos;
@@ -221,33 +273,14 @@ void SWGLMultiObjectWidget::addCloud(const QString &sPathCloud)
         l_cloudInfos.m_triangles = 0;
 
     // init buffers
-        QGLBufferPtr l_indexBuffer = QGLBufferPtr(new QGLBuffer());
-        QGLBufferPtr l_vertexBuffer = QGLBufferPtr(new QGLBuffer());
-        QGLBufferPtr l_colorBuffer = QGLBufferPtr(new QGLBuffer());
-        QGLBufferPtr l_normalBuffer = QGLBufferPtr(new QGLBuffer());
-        QGLBufferPtr l_textureBuffer = QGLBufferPtr(new QGLBuffer());
-        initIndexBuffer(*l_indexBuffer);
-        initVertexBuffer(*l_vertexBuffer);
-        initVertexBuffer(*l_normalBuffer);
-        initVertexBuffer(*l_textureBuffer);
-        initVertexBuffer(*l_colorBuffer);
-
-    // set usage pattern
-        l_indexBuffer->setUsagePattern(QGLBuffer::StaticDraw);
-        l_vertexBuffer->setUsagePattern(QGLBuffer::StaticDraw);
-        l_normalBuffer->setUsagePattern(QGLBuffer::StaticDraw);
-        l_textureBuffer->setUsagePattern(QGLBuffer::StaticDraw);
-        l_colorBuffer->setUsagePattern(QGLBuffer::StaticDraw);
+        SWGLCloudRendererPtr l_pCloudRenderer = SWGLCloudRendererPtr(new SWGLCloudRenderer());
+        l_pCloudRenderer->initBuffers();
 
     m_pListCloudsMutex.lockForWrite();
         m_vClouds.push_back(l_pCloud);
         m_vCloudsParameters.push_back(l_pCloudParam);
         m_cloudsInfos.push_back(l_cloudInfos);
-        m_vCloudsVertexBuffer.push_back(l_vertexBuffer);
-        m_vCloudsIndexBuffer.push_back(l_indexBuffer);
-        m_vCloudsNormalBuffer.push_back(l_normalBuffer);
-        m_vCloudsTextureBuffer.push_back(l_textureBuffer);
-        m_vCloudsColorBuffer.push_back(l_colorBuffer);
+        m_vCloudsRenderer.push_back(l_pCloudRenderer);
         m_vCloudsBufferToUpdate.push_back(true);
     m_pListCloudsMutex.unlock();
 
@@ -291,43 +324,23 @@ void SWGLMultiObjectWidget::addMesh(const QString &sPathMesh)
         l_pMeshesParam->m_dSpecularP = 10.;
         // animation
         l_pMeshesParam->m_animationStarted = false;
-        l_pMeshesParam->m_animationOffsetsX = QVector<float>(l_pMesh->pointsNumber(),0.f);
-        l_pMeshesParam->m_animationOffsetsY = QVector<float>(l_pMesh->pointsNumber(),0.f);
-        l_pMeshesParam->m_animationOffsetsZ = QVector<float>(l_pMesh->pointsNumber(),0.f);
+        l_pMeshesParam->m_animationBuffer = SWAnimationTripleBufferPtr(new SWAnimationTripleBuffer(l_pMesh->pointsNumber()));
+        l_pMeshesParam->m_animationConsumedNumber = 0;
 
     // infos
         SWGLObjectInfos l_meshesInfos;
         l_meshesInfos.m_points = l_pMesh->pointsNumber();
         l_meshesInfos.m_triangles = l_pMesh->trianglesNumber();
 
-    // init buffers
-        QGLBufferPtr l_indexBuffer = QGLBufferPtr(new QGLBuffer());
-        QGLBufferPtr l_vertexBuffer = QGLBufferPtr(new QGLBuffer());
-        QGLBufferPtr l_colorBuffer = QGLBufferPtr(new QGLBuffer());
-        QGLBufferPtr l_normalBuffer = QGLBufferPtr(new QGLBuffer());
-        QGLBufferPtr l_textureBuffer = QGLBufferPtr(new QGLBuffer());
-        initIndexBuffer(*l_indexBuffer);
-        initVertexBuffer(*l_vertexBuffer);
-        initVertexBuffer(*l_normalBuffer);
-        initVertexBuffer(*l_textureBuffer);
-        initVertexBuffer(*l_colorBuffer);
-
-    // set usage pattern
-        l_indexBuffer->setUsagePattern(QGLBuffer::StaticDraw);
-        l_vertexBuffer->setUsagePattern(QGLBuffer::StaticDraw);
-        l_normalBuffer->setUsagePattern(QGLBuffer::StaticDraw);
-        l_textureBuffer->setUsagePattern(QGLBuffer::StaticDraw);
-        l_colorBuffer->setUsagePattern(QGLBuffer::StaticDraw);
+    // init buffers, the positions are rewritten by the animation
+        SWGLMeshRendererPtr l_pMeshRenderer = SWGLMeshRendererPtr(new SWGLMeshRenderer());
+        l_pMeshRenderer->initBuffers(true);
 
     m_pListMeshesMutex.lockForWrite();
         m_vMeshes.push_back(l_pMesh);       
         m_vMeshesParameters.push_back(l_pMeshesParam);
         m_meshesInfos.push_back(l_meshesInfos);
-        m_vMeshesVertexBuffer.push_back(l_vertexBuffer);
-        m_vMeshesIndexBuffer.push_back(l_indexBuffer);
-        m_vMeshesNormalBuffer.push_back(l_normalBuffer);
-        m_vMeshesTextureBuffer.push_back(l_textureBuffer);
-        m_vMeshesColorBuffer.push_back(l_colorBuffer);
+        m_vMeshesRenderer.push_back(l_pMeshRenderer);
         m_vMeshesBufferToUpdate.push_back(true);
     m_pListMeshesMutex.unlock();
 
@@ -341,30 +354,12 @@ void SWGLMultiObjectWidget::removeCloud(cuint ui32Index)
 
     m_pListCloudsMutex.lockForWrite();
 
-    QGLBuffer::release(QGLBuffer::VertexBuffer);
-    QGLBuffer::release(QGLBuffer::IndexBuffer);
-
     if(ui32Index < static_cast<uint>(m_vClouds.size()))
-    {        
-        float l_aFNULL[1];
-        uint32 l_aUI32NUL[1];
-        allocateBuffer(*m_vCloudsVertexBuffer[ui32Index],  l_aFNULL, 1 * sizeof(float) );
-        allocateBuffer(*m_vCloudsIndexBuffer[ui32Index],  l_aFNULL, 1 * sizeof(float) );
-        allocateBuffer(*m_vCloudsTextureBuffer[ui32Index],  l_aFNULL, 1 * sizeof(float) );
-        allocateBuffer(*m_vCloudsColorBuffer[ui32Index],  l_aFNULL, 1 * sizeof(float) );
-        allocateBuffer(*m_vCloudsColorBuffer[ui32Index],  l_aUI32NUL, 1 * sizeof(GLuint) );
-
-        m_vBuffersToDelete.push_back(m_vCloudsVertexBuffer[ui32Index]);
-        m_vBuffersToDelete.push_back(m_vCloudsIndexBuffer[ui32Index]);
-        m_vBuffersToDelete.push_back(m_vCloudsTextureBuffer[ui32Index]);
-        m_vBuffersToDelete.push_back(m_vCloudsNormalBuffer[ui32Index]);
-        m_vBuffersToDelete.push_back(m_vCloudsColorBuffer[ui32Index]);
-
-        m_vCloudsVertexBuffer.removeAt(ui32Index);
-        m_vCloudsNormalBuffer.removeAt(ui32Index);
-        m_vCloudsIndexBuffer.removeAt(ui32Index);
-        m_vCloudsTextureBuffer.removeAt(ui32Index);
-        m_vCloudsColorBuffer.removeAt(ui32Index);
+    {
+        m_vCloudsRenderer[ui32Index]->clearBuffers();
+        m_vRenderersToDelete.push_back(m_vCloudsRenderer[ui32Index]);
+
+        m_vCloudsRenderer.removeAt(ui32Index);
         m_vCloudsBufferToUpdate.removeAt(ui32Index);
 
         m_vClouds.removeAt(ui32Index);
@@ -389,30 +384,12 @@ void SWGLMultiObjectWidget::removeMesh(cuint ui32Index)
 
     m_pListMeshesMutex.lockForWrite();
 
-    QGLBuffer::release(QGLBuffer::VertexBuffer);
-    QGLBuffer::release(QGLBuffer::IndexBuffer);
-
     if(ui32Index < static_cast<uint>(m_vMeshes.size()))
     {
-        float l_aFNULL[1];
-        uint32 l_aUI32NUL[1];
-        allocateBuffer(*m_vMeshesVertexBuffer[ui32Index],  l_aFNULL, 1 * sizeof(float) );
-        allocateBuffer(*m_vMeshesTextureBuffer[ui32Index],  l_aFNULL, 1 * sizeof(float) );
-        allocateBuffer(*m_vMeshesColorBuffer[ui32Index],  l_aFNULL, 1* sizeof(float) );
-        allocateBuffer(*m_vMeshesNormalBuffer[ui32Index],  l_aFNULL, 1* sizeof(float) );
-        allocateBuffer(*m_vMeshesIndexBuffer[ui32Index],  l_aUI32NUL, 1 * sizeof(GLuint) );
-
-        m_vBuffersToDelete.push_back(m_vMeshesVertexBuffer[ui32Index]);
-        m_vBuffersToDelete.push_back(m_vMeshesTextureBuffer[ui32Index]);
-        m_vBuffersToDelete.push_back(m_vMeshesColorBuffer[ui32Index]);
-        m_vBuffersToDelete.push_back(m_vMeshesNormalBuffer[ui32Index]);
-        m_vBuffersToDelete.push_back(m_vMeshesIndexBuffer[ui32Index]);
-
-        m_vMeshesVertexBuffer.removeAt(ui32Index);
-        m_vMeshesNormalBuffer.removeAt(ui32Index);
-        m_vMeshesIndexBuffer.removeAt(ui32Index);
-        m_vMeshesTextureBuffer.removeAt(ui32Index);
-        m_vMeshesColorBuffer.removeAt(ui32Index);
+        m_vMeshesRenderer[ui32Index]->clearBuffers();
+        m_vRenderersToDelete.push_back(m_vMeshesRenderer[ui32Index]);
+
+        m_vMeshesRenderer.removeAt(ui32Index);
         m_vMeshesBufferToUpdate.removeAt(ui32Index);
 
         m_vMeshes.removeAt(ui32Index);
@@ -515,36 +492,35 @@ void SWGLMultiObjectWidget::stopAnimation(cbool isCloudItem, cuint indexItem)
 }
 
 
-void SWGLMultiObjectWidget::setAnimationOffset(SWAnimationSendDataPtr animationSendData)
+SWAnimationTripleBufferPtr SWGLMultiObjectWidget::animationBuffer(cbool isCloudItem, cint indexItem)
 {
-    int indexItem = animationSendData->m_index;
+    SWAnimationTripleBufferPtr l_pAnimationBuffer;
 
-    if(animationSendData->m_isCloud)
+    if(isCloudItem)
     {
-        if(indexItem < static_cast<int>(m_vCloudsParameters.size()))
-        {
-            m_vCloudsParameters[indexItem]->m_animationMutex.lockForWrite();
-                m_vCloudsParameters[indexItem]->m_animationOffsetsX = animationSendData->m_animationOffsetsX;
-                m_vCloudsParameters[indexItem]->m_animationOffsetsY = animationSendData->m_animationOffsetsY;
-                m_vCloudsParameters[indexItem]->m_animationOffsetsZ = animationSendData->m_animationOffsetsZ;
-                m_vCloudsParameters[indexItem]->m_animationRigidMotion = animationSendData->m_animationRigidMotion;
-//                m_vCloudsParameters[indexItem]->m_animationIndexRotTrans = animationSendData->m_;
-            m_vCloudsParameters[indexItem]->m_animationMutex.unlock();
-        }
+        m_pListCloudsMutex.lockForRead();
+            if(indexItem > -1 && indexItem < m_vCloudsParameters.size())
+            {
+                l_pAnimationBuffer = m_vCloudsParameters[indexItem]->m_animationBuffer;
+            }
+        m_pListCloudsMutex.unlock();
     }
     else
     {
-        if(indexItem < static_cast<int>(m_vMeshesParameters.size()))
-        {
-            m_vMeshesParameters[indexItem]->m_animationMutex.lockForWrite();
-                m_vMeshesParameters[indexItem]->m_animationOffsetsX = animationSendData->m_animationOffsetsX;
-                m_vMeshesParameters[indexItem]->m_animationOffsetsY = animationSendData->m_animationOffsetsY;
-                m_vMeshesParameters[indexItem]->m_animationOffsetsZ = animationSendData->m_animationOffsetsZ;
-                m_vMeshesParameters[indexItem]->m_animationRigidMotion = animationSendData->m_animationRigidMotion;
-//                m_vMeshesParameters[indexItem]->m_animationIndexRotTrans = indexRotTrans;
-            m_vMeshesParameters[indexItem]->m_animationMutex.unlock();
-        }
+        m_pListMeshesMutex.lockForRead();
+            if(indexItem > -1 && indexItem < m_vMeshesParameters.size())
+            {
+                l_pAnimationBuffer = m_vMeshesParameters[indexItem]->m_animationBuffer;
+            }
+        m_pListMeshesMutex.unlock();
     }
+
+    return l_pAnimationBuffer;
+}
+
+void SWGLMultiObjectWidget::setVerbosePacing(cbool bVerbose)
+{
+    m_bVerbosePacing = bVerbose;
 }
 
 void SWGLMultiObjectWidget::drawClouds()
@@ -581,46 +557,21 @@ void SWGLMultiObjectWidget::drawClouds()
 
             // apply transformations
                 std::vector<float> l_v3FMeanPoint = m_vClouds[ii]->meanPoint();
-                QVector3D l_v3FTranslationToCenter(-l_v3FMeanPoint[0], -l_v3FMeanPoint[1], -l_v3FMeanPoint[2]);
-                swCloud::SWRigidMotion l_oTransfo(l_vRotation.x(), l_vRotation.y(), l_vRotation.z());
-                l_oTransfo.m_aFTranslation[0] = l_vTranslation.x();
-                l_oTransfo.m_aFTranslation[1] = l_vTranslation.y();
-                l_oTransfo.m_aFTranslation[2] = l_vTranslation.z();
-
-                QMatrix4x4 l_oTransformation(l_oTransfo.m_aFRotation[0], l_oTransfo.m_aFRotation[1], l_oTransfo.m_aFRotation[2],l_oTransfo.m_aFTranslation[0],
-                                             l_oTransfo.m_aFRotation[3], l_oTransfo.m_aFRotation[4], l_oTransfo.m_aFRotation[5],l_oTransfo.m_aFTranslation[1],
-                                             l_oTransfo.m_aFRotation[6], l_oTransfo.m_aFRotation[7], l_oTransfo.m_aFRotation[8],l_oTransfo.m_aFTranslation[2],
-                                             0.0, 0.0, 0.0, 1.0);
+                QVector3D l_v3FCenter(l_v3FMeanPoint[0], l_v3FMeanPoint[1], l_v3FMeanPoint[2]);
 
             // uniform
-                m_oShaderCloud.setUniformValue("scaling", l_fScaling);
-                m_oShaderCloud.setUniformValue("translationToCenter", l_v3FTranslationToCenter);
-                m_oShaderCloud.setUniformValue("applyTransformation", true);
+                SWGLObjectRenderer::setTransformationUniforms(m_oShaderCloud, l_v3FCenter, l_vRotation, l_vTranslation, l_fScaling, m_oMVPMatrix);
                 m_oShaderCloud.setUniformValue("displayMode", l_oDisplayMode);
                 m_oShaderCloud.setUniformValue("uniColor", l_vUnicolor.x()/255., l_vUnicolor.y()/255., l_vUnicolor.z()/255.);
-                m_oShaderCloud.setUniformValue("mvpMatrix", m_oMVPMatrix);
-                m_oShaderCloud.setUniformValue("transformation", l_oTransformation);
 
             if(m_vCloudsBufferToUpdate[ii])
             {
-                // allocate buffers
-                    float  *l_aFVertexBuffer   = m_vClouds[ii]->vertexBuffer();
-                    float  *l_aFColorBuffer    = m_vClouds[ii]->colorBuffer();
-                    uint32 *l_aUI32IndexBuffer = m_vClouds[ii]->indexBuffer();
-                        allocateBuffer(*m_vCloudsVertexBuffer[ii], l_aFVertexBuffer,   m_vClouds[ii]->size() *  3 * sizeof(float) );
-                        allocateBuffer(*m_vCloudsIndexBuffer[ii], l_aUI32IndexBuffer, m_vClouds[ii]->size() * sizeof(GLuint) );
-                        allocateBuffer(*m_vCloudsColorBuffer[ii], l_aFColorBuffer,    m_vClouds[ii]->size() *  3 * sizeof(float));
-                    deleteAndNullifyArray(l_aFVertexBuffer);
-                    deleteAndNullifyArray(l_aUI32IndexBuffer);
-                    deleteAndNullifyArray(l_aFColorBuffer);
-
+                m_vCloudsRenderer[ii]->updateBuffers(*m_vClouds[ii]);
                 m_vCloudsBufferToUpdate[ii] = false;
             }
 
-
             // draw
-                drawBufferWithColor(*m_vCloudsIndexBuffer[ii], *m_vCloudsVertexBuffer[ii],
-                                    *m_vCloudsColorBuffer[ii], m_oShaderCloud, GL_POINTS);
+                m_vCloudsRenderer[ii]->draw(m_oShaderCloud);
         }
 
     m_oShaderCloud.release();
@@ -663,12 +614,33 @@ void SWGLMultiObjectWidget::drawMeshes()
                     bool l_animationStarted = m_vMeshesParameters[ii]->m_animationStarted;
                 m_vMeshesParameters[ii]->m_parametersMutex.unlock();
 
-                m_vMeshesParameters[ii]->m_animationMutex.lockForRead();
-                    QVector<float> l_animationOffsetsX = m_vMeshesParameters[ii]->m_animationOffsetsX;
-                    QVector<float> l_animationOffsetsY = m_vMeshesParameters[ii]->m_animationOffsetsY;
-                    QVector<float> l_animationOffsetsZ = m_vMeshesParameters[ii]->m_animationOffsetsZ;
-                    QVector<float> l_animationRigidMotion = m_vMeshesParameters[ii]->m_animationRigidMotion;
-                m_vMeshesParameters[ii]->m_animationMutex.unlock();
+            // retrieve the newest animation slot without blocking the animation worker
+                SWAnimationTripleBuffer &l_oAnimationBuffer = *m_vMeshesParameters[ii]->m_animationBuffer;
+                bool l_newAnimationData = l_oAnimationBuffer.update();
+                const SWAnimationSendData &l_oAnimationData = l_oAnimationBuffer.frontSlot();
+                const QVector<float> &l_animationOffsetsX = l_oAnimationData.m_animationOffsetsX;
+                const QVector<float> &l_animationOffsetsY = l_oAnimationData.m_animationOffsetsY;
+                const QVector<float> &l_animationOffsetsZ = l_oAnimationData.m_animationOffsetsZ;
+                const QVector<float> &l_animationRigidMotion = l_oAnimationData.m_animationRigidMotion;
+
+                if(l_animationStarted)
+                {
+                    if(l_animationOffsetsX.size() < static_cast<int>(m_vMeshes[ii]->pointsNumber()) || l_animationRigidMotion.size() < 6)
+                    {
+                        l_animationStarted = false;
+                    }
+                    else if(l_newAnimationData)
+                    {
+                        int l_i32Published = l_oAnimationBuffer.publishedNumber();
+                        m_i32DroppedAnimationFrames += std::max(0, l_i32Published - m_vMeshesParameters[ii]->m_animationConsumedNumber - 1);
+                        m_vMeshesParameters[ii]->m_animationConsumedNumber = l_i32Published;
+                        ++m_i32AnimationFrames;
+                    }
+                    else
+                    {
+                        ++m_i32StaleAnimationFrames;
+                    }
+                }
 
 
             // check visibility
@@ -690,26 +662,13 @@ void SWGLMultiObjectWidget::drawMeshes()
 
                 // apply transformations
                     std::vector<float> l_v3FMeanPoint = m_vMeshes[ii]->cloud()->meanPoint();
-                    QVector3D l_v3FTranslationToCenter(-l_v3FMeanPoint[0], -l_v3FMeanPoint[1], -l_v3FMeanPoint[2]);
-                    swCloud::SWRigidMotion l_oTransfo(l_vRotation.x(), l_vRotation.y(), l_vRotation.z());
-                    l_oTransfo.m_aFTranslation[0] = l_vTranslation.x();
-                    l_oTransfo.m_aFTranslation[1] = l_vTranslation.y();
-                    l_oTransfo.m_aFTranslation[2] = l_vTranslation.z();
-
-                    QMatrix4x4 l_oTransformation(l_oTransfo.m_aFRotation[0], l_oTransfo.m_aFRotation[1], l_oTransfo.m_aFRotation[2],l_oTransfo.m_aFTranslation[0],
-                                                 l_oTransfo.m_aFRotation[3], l_oTransfo.m_aFRotation[4], l_oTransfo.m_aFRotation[5],l_oTransfo.m_aFTranslation[1],
-                                                 l_oTransfo.m_aFRotation[6], l_oTransfo.m_aFRotation[7], l_oTransfo.m_aFRotation[8],l_oTransfo.m_aFTranslation[2],
-                                                 0.0, 0.0, 0.0, 1.0);
+                    QVector3D l_v3FCenter(l_v3FMeanPoint[0], l_v3FMeanPoint[1], l_v3FMeanPoint[2]);
 
                 // uniform
                     // camera
                         m_oShaderMesh.setUniformValue("viewDirection", -m_pCamera->lookAt());
                     // transformations
-                        m_oShaderMesh.setUniformValue("scaling", l_fScaling);
-                        m_oShaderMesh.setUniformValue("translationToCenter", l_v3FTranslationToCenter);
-                        m_oShaderMesh.setUniformValue("applyTransformation", true);
-                        m_oShaderMesh.setUniformValue("transformation", l_oTransformation);
-                        m_oShaderMesh.setUniformValue("mvpMatrix", m_oMVPMatrix);
+                        SWGLObjectRenderer::setTransformationUniforms(m_oShaderMesh, l_v3FCenter, l_vRotation, l_vTranslation, l_fScaling, m_oMVPMatrix);
                     // color / texture
                         m_oShaderMesh.setUniformValue("displayMode", l_oDisplayMode);
                         m_oShaderMesh.setUniformValue("uniColor", l_vUnicolor.x()/255., l_vUnicolor.y()/255., l_vUnicolor.z()/255.);
@@ -723,135 +682,28 @@ void SWGLMultiObjectWidget::drawMeshes()
                         m_oShaderMesh.setUniformValue("lDiffus" , l_vDiffusLight);
                         m_oShaderMesh.setUniformValue("lSpecular" , l_vSpecularLight);
 
+            SWGLMeshRenderer &l_oMeshRenderer = *m_vMeshesRenderer[ii];
+
             if(m_vMeshesBufferToUpdate[ii])
             {
-                // allocate buffers
-                    float  *l_aFVertexBuffer = NULL;
+                // update buffers from the mesh data, without intermediate copies
+                    l_oMeshRenderer.updateBuffers(*m_vMeshes[ii]);
 
                     if(l_animationStarted)
                     {
-                        swCloud::SWCloud l_cloudAnim;
-                        l_cloudAnim.copy(*m_vMeshes[ii]->cloud());
-
-
-                        std::vector<float> l_off(3,0.f);
-                        l_off[0] = -l_cloudAnim.coord(0)[352];
-                        l_off[1] = -l_cloudAnim.coord(1)[352];
-                        l_off[2] = -l_cloudAnim.coord(2)[352];
-
-                        l_cloudAnim += l_off;
-
-//                        qDebug() << "verif :" << l_cloudAnim.coord(0)[352] << " " << l_cloudAnim.coord(1)[352] << " " << l_cloudAnim.coord(2)[352];
-
-                        for(uint jj = 0; jj < l_cloudAnim.size(); ++jj)
-                        {
-                            l_cloudAnim.coord(0)[jj] += l_animationOffsetsX[jj];
-                            l_cloudAnim.coord(1)[jj] += l_animationOffsetsY[jj];
-                            l_cloudAnim.coord(2)[jj] += l_animationOffsetsZ[jj];
-                        }
-
-                        swCloud::SWRigidMotion l_rigidMotion((180.f/3.14)*l_animationRigidMotion[3],(180.f/3.14)*l_animationRigidMotion[4],(-180.f/3.14)*l_animationRigidMotion[5]);
-                        l_rigidMotion.m_aFTranslation[0] = l_animationRigidMotion[0]/40.f;
-                        l_rigidMotion.m_aFTranslation[1] = l_animationRigidMotion[1]/40.f;
-                        l_rigidMotion.m_aFTranslation[2] = -l_animationRigidMotion[2]/40.f;
-                        l_cloudAnim.transform(l_rigidMotion.m_aFRotation, l_rigidMotion.m_aFTranslation);
-
-                        l_off[0] = -l_off[0];
-                        l_off[1] = -l_off[1];
-                        l_off[2] = -l_off[2];
-
-                        l_cloudAnim += l_off;
-
-//                        qDebug() << "verif :" << l_cloudAnim.coord(0)[352] << " " << l_cloudAnim.coord(1)[352] << " " << l_cloudAnim.coord(2)[352];
-
-                        l_aFVertexBuffer = l_cloudAnim.vertexBuffer();
-                    }
-                    else
-                    {
-                        l_aFVertexBuffer = m_vMeshes[ii]->vertexBuffer();
+                        l_oMeshRenderer.updateAnimatedVertexBuffer(*m_vMeshes[ii], l_animationOffsetsX, l_animationOffsetsY, l_animationOffsetsZ, l_animationRigidMotion);
                     }
 
-                    float  *l_aFColorBuffer    = m_vMeshes[ii]->cloud()->colorBuffer();
-                    uint32 *l_aUI32IndexBuffer = m_vMeshes[ii]->indexVertexTriangleBuffer();
-                    float  *l_aFNormalBuffer   = m_vMeshes[ii]->normalBuffer();
-                    float  *l_aFTextureBuffer  = m_vMeshes[ii]->textureBuffer();
-                        allocateBuffer(*m_vMeshesVertexBuffer[ii],  l_aFVertexBuffer,     m_vMeshes[ii]->pointsNumber() *  3 * sizeof(float) );
-                        allocateBuffer(*m_vMeshesIndexBuffer[ii],   l_aUI32IndexBuffer,   m_vMeshes[ii]->trianglesNumber() * 3* sizeof(GLuint) );
-                        allocateBuffer(*m_vMeshesColorBuffer[ii],   l_aFColorBuffer,      m_vMeshes[ii]->pointsNumber() *  3 * sizeof(float));
-                        allocateBuffer(*m_vMeshesNormalBuffer[ii],  l_aFNormalBuffer,     m_vMeshes[ii]->pointsNumber() *  3 * sizeof(float));
-                        allocateBuffer(*m_vMeshesTextureBuffer[ii], l_aFTextureBuffer,    m_vMeshes[ii]->pointsNumber() *  2 * sizeof(float) );
-                    deleteAndNullifyArray(l_aFVertexBuffer);
-                    deleteAndNullifyArray(l_aUI32IndexBuffer);
-                    deleteAndNullifyArray(l_aFColorBuffer);
-                    deleteAndNullifyArray(l_aFNormalBuffer);
-                    deleteAndNullifyArray(l_aFTextureBuffer);
-
                 m_vMeshesBufferToUpdate[ii] = false;
             }
-            else if(l_animationStarted)
+            else if(l_animationStarted && l_newAnimationData)
             {
-                float  *l_aFVertexBuffer   = NULL;
-
-                swCloud::SWCloud l_cloudAnim;
-                l_cloudAnim.copy(*m_vMeshes[ii]->cloud());
-
-
-                std::vector<float> l_off(3,0.f);
-                l_off[0] = -l_cloudAnim.coord(0)[352];
-                l_off[1] = -l_cloudAnim.coord(1)[352];
-                l_off[2] = -l_cloudAnim.coord(2)[352];
-
-                l_cloudAnim += l_off;
-
-                for(uint jj = 0; jj < l_cloudAnim.size(); ++jj)
-                {
-                    l_cloudAnim.coord(0)[jj] += l_animationOffsetsX[jj];
-                    l_cloudAnim.coord(1)[jj] += l_animationOffsetsY[jj];
-                    l_cloudAnim.coord(2)[jj] += l_animationOffsetsZ[jj];
-                }
-
-                swCloud::SWRigidMotion l_rigidMotion((180.f/3.14)*l_animationRigidMotion[3],(180.f/3.14)*l_animationRigidMotion[4],(-180.f/3.14)*l_animationRigidMotion[5]);
-                l_rigidMotion.m_aFTranslation[0] = l_animationRigidMotion[0]/40.f;
-                l_rigidMotion.m_aFTranslation[1] = l_animationRigidMotion[1]/40.f;
-                l_rigidMotion.m_aFTranslation[2] = -l_animationRigidMotion[2]/40.f;
-                l_cloudAnim.transform(l_rigidMotion.m_aFRotation, l_rigidMotion.m_aFTranslation);
-
-                l_off[0] = -l_off[0];
-                l_off[1] = -l_off[1];
-                l_off[2] = -l_off[2];
-
-                l_cloudAnim += l_off;
-
-
-                l_aFVertexBuffer = l_cloudAnim.vertexBuffer();
-
-                allocateBuffer(*m_vMeshesVertexBuffer[ii],  l_aFVertexBuffer,     m_vMeshes[ii]->pointsNumber() *  3 * sizeof(float) );
-                deleteAndNullifyArray(l_aFVertexBuffer);
+                // the vertex buffer is only updated when a new animation slot has been published
+                l_oMeshRenderer.updateAnimatedVertexBuffer(*m_vMeshes[ii], l_animationOffsetsX, l_animationOffsetsY, l_animationOffsetsZ, l_animationRigidMotion);
             }
 
             // draw
-                    if(l_oDisplayMode == GLO_ORIGINAL_COLOR)
-                    {
-                        drawBufferWithColor(*m_vMeshesIndexBuffer[ii], *m_vMeshesVertexBuffer[ii],
-                                            *m_vMeshesColorBuffer[ii], *m_vMeshesNormalBuffer[ii], m_oShaderMesh, GL_TRIANGLES);
-                    }
-                    else if(l_oDisplayMode == GLO_TEXTURE)
-                    {
-                        glEnable(GL_TEXTURE_2D);
-
-                        // bind texture
-                            glBindTexture(GL_TEXTURE_2D, m_vMeshesParameters[ii]->m_textureLocation);
-
-                        drawBufferWithTexture(*m_vMeshesIndexBuffer[ii], *m_vMeshesVertexBuffer[ii],
-                                              *m_vMeshesTextureBuffer[ii],*m_vMeshesNormalBuffer[ii], m_oShaderMesh, GL_TRIANGLES);
-
-                        glDisable(GL_TEXTURE_2D);
-                    }
-                    else if(l_oDisplayMode == GLO_UNI_COLOR)
-                    {
-                        drawBuffer(*m_vMeshesIndexBuffer[ii], *m_vMeshesVertexBuffer[ii],
-                                   *m_vMeshesNormalBuffer[ii], m_oShaderMesh, GL_TRIANGLES);
-                    }
+                l_oMeshRenderer.draw(m_oShaderMesh, l_oDisplayMode, m_vMeshesParameters[ii]->m_textureLocation);
         }
 
         m_oShaderMesh.release();
@@ -859,6 +711,9 @@ void SWGLMultiObjectWidget::drawMeshes()
 
 void SWGLMultiObjectWidget::drawScene()
 {
+    QTime l_oPaintTime;
+    l_oPaintTime.start();
+
     drawAxes(m_oShaderCloud, m_oMVPMatrix, 0.02f);
     drawCubeMap(m_oShaderCloud, m_oMVPMatrix);
 
@@ -869,6 +724,31 @@ void SWGLMultiObjectWidget::drawScene()
     m_pListMeshesMutex.lockForRead();
         drawMeshes();
     m_pListMeshesMutex.unlock();
+
+    m_i32MaxPaintTime = std::max(m_i32MaxPaintTime, l_oPaintTime.elapsed());
+    ++m_i32PaintedFrames;
+
+    updateFramePacing();
+}
+
+void SWGLMultiObjectWidget::updateFramePacing()
+{
+    int l_i32Elapsed = m_oPacingTime.elapsed();
+
+    if(l_i32Elapsed < 5000)
+    {
+        return;
+    }
+
+    if(m_bVerbosePacing && (m_i32AnimationFrames > 0 || m_i32StaleAnimationFrames > 0))
+    {
+        qDebug() << "[SWGLMultiObjectWidget] paint : " << 1000.f * m_i32PaintedFrames / l_i32Elapsed << " fps (max " << m_i32MaxPaintTime << " ms)"
+                 << " | animation : " << 1000.f * m_i32AnimationFrames / l_i32Elapsed << " fps, stale paints : " << m_i32StaleAnimationFrames
+                 << ", dropped slots : " << m_i32DroppedAnimationFrames;
+    }
+
+    m_i32PaintedFrames = m_i32AnimationFrames = m_i32StaleAnimationFrames = m_i32DroppedAnimationFrames = m_i32MaxPaintTime = 0;
+    m_oPacingTime.restart();
 }
 
 
@@ -71,6 +71,7 @@ SWGLOptimalStepNonRigidICP::SWGLOptimalStepNonRigidICP(QGLContext *context, QWid
 
         // OptimalStepNonRigidICP
             m_bUseLandMarks = true;
+            m_i32LevelsNb   = 1;
 
         // translations
             m_fXTransTarget = m_fYTransTarget = m_fZTransTarget = 0.f;
@@ -169,7 +170,8 @@ void SWGLOptimalStepNonRigidICP::initResolve()
         m_pOSNRICP->updateSourceMeshNormals();
     m_pSourceMeshMutex->unlock();
 
-    m_pSourceMeshMutex->lockForRead();
+    // the correspondences rewrite the template texture coordinates
+    m_pSourceMeshMutex->lockForWrite();
     m_pTargetMeshMutex->lockForRead();
         m_pUMutex->lockForWrite();
             m_pOSNRICP->computeCorrespondences();
@@ -198,12 +200,32 @@ double SWGLOptimalStepNonRigidICP::morph(cdouble dAlpha)
     double l_dBeta        = m_dBeta;
     double l_dGama        = m_dGama;
     double l_dUseLandmarks= m_bUseLandMarks;
+    float l_fStartAlpha   = static_cast<float>(m_dStartAlpha);
+    float l_fMinAlpha     = static_cast<float>(m_dMinAlpha);
 
 //    qDebug() << "Start alpha : " << m_dStartAlpha << "\nAlpha : " << dAlpha << "\nBeta : " << m_dBeta << "\nGama : " << m_dGama << "\nUse landmarks : " << m_bUseLandMarks;
 //    qDebug() << "Min Alpha : " << m_dMinAlpha << "\nCoeff : " << m_dCoeffAlpha;
 
     m_pParamMutex->unlock();
 
+    // go to a finer template of the pyramid when the alpha is low enough
+    int l_i32Level = m_pOSNRICP->levelForAlpha(static_cast<float>(dAlpha), l_fStartAlpha, l_fMinAlpha);
+    if(l_i32Level < m_pOSNRICP->currentLevel())
+    {
+        m_pSourceMeshMutex->lockForWrite();
+        m_pUMutex->lockForWrite();
+        m_pWMutex->lockForWrite();
+            m_pOSNRICP->prolongToLevel(l_i32Level);
+        m_pWMutex->unlock();
+        m_pUMutex->unlock();
+        m_pSourceMeshMutex->unlock();
+
+        m_templateCloudBuffer.m_bUpdate = true;
+        m_templateMeshBuffer.m_bUpdate = true;
+        m_templateVerticesNormalesBuffer.m_bUpdate = true;
+        m_templateTrianglesNormalesBuffer.m_bUpdate = true;
+    }
+
     initResolve();
     double l_dDiff;
 
@@ -224,6 +246,64 @@ double SWGLOptimalStepNonRigidICP::morph(cdouble dAlpha)
     return l_dDiff;
 }
 
+void SWGLOptimalStepNonRigidICP::startMultiResolution()
+{
+    if(!m_pOSNRICP)
+    {
+        return;
+    }
+
+    m_pParamMutex->lock();
+        int l_i32LevelsNb = m_i32LevelsNb;
+    m_pParamMutex->unlock();
+
+    m_pSourceMeshMutex->lockForWrite();
+    m_pUMutex->lockForWrite();
+    m_pWMutex->lockForWrite();
+        int l_i32LevelsBuilt = m_pOSNRICP->buildPyramid(l_i32LevelsNb);
+    m_pWMutex->unlock();
+    m_pUMutex->unlock();
+    m_pSourceMeshMutex->unlock();
+
+    if(l_i32LevelsBuilt < l_i32LevelsNb)
+    {
+        qWarning() << "Template too small for " << l_i32LevelsNb << " levels, " << l_i32LevelsBuilt << " levels used.";
+    }
+
+    m_templateCloudBuffer.m_bUpdate = true;
+    m_templateMeshBuffer.m_bUpdate = true;
+    m_templateMeshBuffer.m_bUpdateTopology = true;
+    m_templateVerticesNormalesBuffer.m_bUpdate = true;
+    m_templateTrianglesNormalesBuffer.m_bUpdate = true;
+}
+
+void SWGLOptimalStepNonRigidICP::endMultiResolution()
+{
+    if(!m_pOSNRICP)
+    {
+        return;
+    }
+
+    if(m_pOSNRICP->currentLevel() > 0)
+    {
+        m_pSourceMeshMutex->lockForWrite();
+        m_pUMutex->lockForWrite();
+        m_pWMutex->lockForWrite();
+            m_pOSNRICP->prolongToLevel(0);
+        m_pWMutex->unlock();
+        m_pUMutex->unlock();
+        m_pSourceMeshMutex->unlock();
+
+        m_templateCloudBuffer.m_bUpdate = true;
+        m_templateMeshBuffer.m_bUpdate = true;
+        m_templateMeshBuffer.m_bUpdateTopology = true;
+        m_templateVerticesNormalesBuffer.m_bUpdate = true;
+        m_templateTrianglesNormalesBuffer.m_bUpdate = true;
+    }
+
+    m_pOSNRICP->displayLevelsStats();
+}
+
 void SWGLOptimalStepNonRigidICP::saveCurrentMeshToObj(const QString &sPath)
 {           
     int l_i32SeparatorsNb = 0;
@@ -439,6 +519,12 @@ void SWGLOptimalStepNonRigidICP::setCoeffAlpha(double dVal)
     m_dCoeffAlpha = dVal;
 }
 
+void SWGLOptimalStepNonRigidICP::setLevelsNumber(int i32Val)
+{
+    QMutexLocker l_oParamLocker(m_pParamMutex);
+    m_i32LevelsNb = i32Val;
+}
+
 void SWGLOptimalStepNonRigidICP::computeDistWAndCorr()
 {
     m_pOSNRICP->computeCorrespondences();
@@ -452,7 +538,7 @@ void SWGLOptimalStepNonRigidICP::transformTarget(cbool bUpdateDisplay)
     {
         m_pTargetMeshMutex->lockForWrite();
 
-            m_pOSNRICP->m_oTargetMesh.cloud()->copy(*m_pOSNRICP->m_oOriginalTargetMesh.cloud());
+            m_pOSNRICP->m_oTargetMesh.copyGeometry(m_pOSNRICP->m_oOriginalTargetMesh);
 
             if(m_fTargetScaling != 1.f)
             {
@@ -464,16 +550,25 @@ void SWGLOptimalStepNonRigidICP::transformTarget(cbool bUpdateDisplay)
             l_oRigidMotion.m_aFTranslation[1] = m_fYTransTarget;
             l_oRigidMotion.m_aFTranslation[2] = m_fZTransTarget;
 
-            m_pOSNRICP->m_oTargetMesh.cloud()->transform(l_oRigidMotion.m_aFRotation, l_oRigidMotion.m_aFTranslation);
-            m_pOSNRICP->m_oTargetMesh.updateNonOrientedTrianglesNormals();
-            m_pOSNRICP->m_oTargetMesh.updateNonOrientedVerticesNormals();
+            // the scaling keeps the normals and the rigid motion only rotates them
+            m_pOSNRICP->m_oTargetMesh.transform(l_oRigidMotion.m_aFRotation, l_oRigidMotion.m_aFTranslation);
+
+            cuint l_ui32DirtyStreams = m_pOSNRICP->m_oTargetMesh.dirtyStreams();
+            m_pOSNRICP->m_oTargetMesh.clearDirtyStreams();
 
         m_pTargetMeshMutex->unlock();
 
-        m_targetCloudBuffer.m_bUpdate = true;
-        m_targetMeshBuffer.m_bUpdate = true;
-        m_targetVerticesNormalesBuffer.m_bUpdate = true;
-        m_targetTrianglesNormalesBuffer.m_bUpdate = true;
+        if(l_ui32DirtyStreams & (swMesh::SWM_VERTICES | swMesh::SWM_NORMALS))
+        {
+            m_targetCloudBuffer.m_bUpdate = true;
+            m_targetMeshBuffer.m_bUpdate = true;
+            m_targetVerticesNormalesBuffer.m_bUpdate = true;
+            m_targetTrianglesNormalesBuffer.m_bUpdate = true;
+        }
+        if(l_ui32DirtyStreams & (swMesh::SWM_TEXTURES | swMesh::SWM_TOPOLOGY))
+        {
+            m_targetMeshBuffer.m_bUpdateTopology = true;
+        }
 
         if(bUpdateDisplay)
         {
@@ -524,11 +619,17 @@ void SWGLOptimalStepNonRigidICP::initializeGL()
 void SWGLOptimalStepNonRigidICP::initBufferList(SWGLBufferList &oBuffer)
 {
     oBuffer.m_bUpdate = false;
+    oBuffer.m_bUpdateTopology = false;
+    oBuffer.m_bUpdateTextures = false;
     initIndexBuffer(oBuffer.m_indexBuffer);
     initVertexBuffer(oBuffer.m_vertexBuffer);
     initVertexBuffer(oBuffer.m_colorBuffer);
     initVertexBuffer(oBuffer.m_normalBuffer);
     initVertexBuffer(oBuffer.m_textureBuffer);
+
+    // positions and normals are rewritten at each morphing step
+    oBuffer.m_vertexBuffer.setUsagePattern(QGLBuffer::DynamicDraw);
+    oBuffer.m_normalBuffer.setUsagePattern(QGLBuffer::DynamicDraw);
 }
 
 void SWGLOptimalStepNonRigidICP::paintGL()
@@ -1151,15 +1252,16 @@ void SWGLOptimalStepNonRigidICP::drawCloud(QGLShaderProgram &oShader, const swCl
     if(m_targetCloudBuffer.m_bUpdate)
     {
         int l_i32SizeIndex      = sizeof(GLuint);
-        int l_i32SizeVertex     = sizeof(float) * 3;
-        uint32 *l_aCloudI       = oCloud.indexBuffer();
-        float  *l_aCloudV       = oCloud.vertexBuffer();
 
-        allocateBuffer(m_targetCloudBuffer.m_indexBuffer,  l_aCloudI, oCloud.size() * l_i32SizeIndex);
-        allocateBuffer(m_targetCloudBuffer.m_vertexBuffer, l_aCloudV, oCloud.size() * l_i32SizeVertex);
+        // the index of a cloud only depends on its size
+        if(m_targetCloudBuffer.m_indexBuffer.size() != static_cast<int>(oCloud.size()) * l_i32SizeIndex)
+        {
+            uint32 *l_aCloudI = oCloud.indexBuffer();
+            allocateBuffer(m_targetCloudBuffer.m_indexBuffer,  l_aCloudI, oCloud.size() * l_i32SizeIndex);
+            deleteAndNullifyArray(l_aCloudI);
+        }
 
-        deleteAndNullifyArray(l_aCloudI);
-        deleteAndNullifyArray(l_aCloudV);
+        updatePlanarVertexBuffer(m_targetCloudBuffer.m_vertexBuffer, oCloud.coord(0), oCloud.coord(1), oCloud.coord(2), oCloud.size());
 
         m_targetCloudBuffer.m_bUpdate = false;
     }
@@ -1198,8 +1300,6 @@ void SWGLOptimalStepNonRigidICP::drawSourceCloud(QGLShaderProgram &oShader, cons
     {
         int l_i32SizeIndex      = sizeof(GLuint);
         int l_i32SizeVertex     = sizeof(float) * 3;
-        uint32 *l_aCloudI       = oCloud.indexBuffer();
-        float  *l_aCloudV       = oCloud.vertexBuffer();
         float *l_aCloudC        = new float[3*oCloud.size()];
 
         // init color point buffer based on weights values (w[i] -> red, w[i] -> white)
@@ -1226,12 +1326,17 @@ void SWGLOptimalStepNonRigidICP::drawSourceCloud(QGLShaderProgram &oShader, cons
                 l_aCloudC[3*ii+2] = l_fCol[2];
             }
 
-        allocateBuffer(m_templateCloudBuffer.m_indexBuffer,  l_aCloudI, oCloud.size() * l_i32SizeIndex);
-        allocateBuffer(m_templateCloudBuffer.m_vertexBuffer, l_aCloudV, oCloud.size() * l_i32SizeVertex);
-        allocateBuffer(m_templateCloudBuffer.m_colorBuffer,  l_aCloudC, oCloud.size() * l_i32SizeVertex);
+        // the index of a cloud only depends on its size
+        if(m_templateCloudBuffer.m_indexBuffer.size() != static_cast<int>(oCloud.size()) * l_i32SizeIndex)
+        {
+            uint32 *l_aCloudI = oCloud.indexBuffer();
+            allocateBuffer(m_templateCloudBuffer.m_indexBuffer,  l_aCloudI, oCloud.size() * l_i32SizeIndex);
+            deleteAndNullifyArray(l_aCloudI);
+        }
+
+        updatePlanarVertexBuffer(m_templateCloudBuffer.m_vertexBuffer, oCloud.coord(0), oCloud.coord(1), oCloud.coord(2), oCloud.size());
+        updateBuffer(m_templateCloudBuffer.m_colorBuffer,  l_aCloudC, oCloud.size() * l_i32SizeVertex);
 
-        deleteAndNullifyArray(l_aCloudI);
-        deleteAndNullifyArray(l_aCloudV);
         deleteAndNullifyArray(l_aCloudC);
 
         m_templateCloudBuffer.m_bUpdate = false;
@@ -1353,11 +1458,13 @@ void SWGLOptimalStepNonRigidICP::resetMorphing()
         // set buffer update to true
             m_templateCloudBuffer.m_bUpdate = true;
             m_templateMeshBuffer.m_bUpdate = true;
+            m_templateMeshBuffer.m_bUpdateTopology = true;
             m_templateVerticesNormalesBuffer.m_bUpdate = true;
             m_templateTrianglesNormalesBuffer.m_bUpdate = true;
 
             m_targetCloudBuffer.m_bUpdate = true;
             m_targetMeshBuffer.m_bUpdate = true;
+            m_targetMeshBuffer.m_bUpdateTopology = true;
             m_targetVerticesNormalesBuffer.m_bUpdate = true;
             m_targetTrianglesNormalesBuffer.m_bUpdate = true;
 
@@ -1422,17 +1529,23 @@ void SWGLOptimalStepNonRigidICP::resetMorphingWithNewMeshes()
 
 void SWGLOptimalStepNonRigidICP::bufferUpdate()
 {
-    // set buffers to update
+    // set buffers to update, the target is not modified by the morphing steps
         m_templateCloudBuffer.m_bUpdate = true;
         m_templateMeshBuffer.m_bUpdate = true;
         m_templateVerticesNormalesBuffer.m_bUpdate = true;
         m_templateTrianglesNormalesBuffer.m_bUpdate = true;
 
-        m_targetCloudBuffer.m_bUpdate = true;
-        m_targetMeshBuffer.m_bUpdate = true;
-        m_targetVerticesNormalesBuffer.m_bUpdate = true;
-        m_targetTrianglesNormalesBuffer.m_bUpdate = true;
-
+    // the texture coordinates of the template are associated again with the target ones at each correspondences computing
+        if(m_pOSNRICP)
+        {
+            m_pSourceMeshMutex->lockForWrite();
+                if(m_pOSNRICP->m_oSourceMesh.dirtyStreams() & swMesh::SWM_TEXTURES)
+                {
+                    m_templateMeshBuffer.m_bUpdateTextures = true;
+                }
+                m_pOSNRICP->m_oSourceMesh.clearDirtyStreams(swMesh::SWM_TEXTURES);
+            m_pSourceMeshMutex->unlock();
+        }
 }
 
 void SWGLOptimalStepNonRigidICP::setSourceMesh(const QString &sPathSource)
@@ -1736,6 +1849,7 @@ void SWGLOptimalStepNonRigidICP::updateTargetTexture(QString pathTargetTexture)
     m_targetTexture = QImage(pathTargetTexture);
     m_targetTextureLocation = bindTexture(m_targetTexture);
     m_targetMeshBuffer.m_bUpdate = true;
+    m_targetMeshBuffer.m_bUpdateTopology = true;
 
     update();
     //    updateGL();
@@ -1793,29 +1907,33 @@ void SWGLOptimalStepNonRigidICP::drawMesh(QGLShaderProgram &shader, SWGLBufferLi
 
             if(buffers.m_bUpdate)
             {
-                // allocate buffers
-                    float  *l_vertexBuffer   = mesh.vertexBuffer();
-                    float  *l_colorBuffer    = mesh.colorBuffer();
-                    uint32 *l_indexBuffer    = mesh.indexVertexTriangleBuffer();
-                    float  *l_normalBuffer   = mesh.normalBuffer();
-                    float  *l_textureBuffer  = NULL;
-
-                    if(l_textureCoordinatesExist && displayMode == GLO_TEXTURE)
+                cint l_i32SizeIndex = mesh.trianglesNumber() * 3 * sizeof(GLuint);
+
+                // the triangles and colors are kept during the morphing steps, the texture coordinates only when not modified
+                    bool l_bUpdateTopology = buffers.m_bUpdateTopology || buffers.m_indexBuffer.size() != l_i32SizeIndex;
+
+                    if(l_textureCoordinatesExist && (l_bUpdateTopology || buffers.m_bUpdateTextures))
                     {
-                        l_textureBuffer = mesh.textureBuffer();
-                        allocateBuffer(buffers.m_textureBuffer, l_textureBuffer, mesh.pointsNumber() * 2 * sizeof(float));
+                        updateBuffer(buffers.m_textureBuffer, mesh.textureBufferData(), mesh.pointsNumber() * 2 * sizeof(float));
                     }
+                    buffers.m_bUpdateTextures = false;
 
-                    allocateBuffer(buffers.m_vertexBuffer,  l_vertexBuffer, mesh.pointsNumber() *  3 * sizeof(float) );
-                    allocateBuffer(buffers.m_indexBuffer,   l_indexBuffer,  mesh.trianglesNumber() * 3* sizeof(GLuint) );
-                    allocateBuffer(buffers.m_colorBuffer,   l_colorBuffer,  mesh.pointsNumber() *  3 * sizeof(float));
-                    allocateBuffer(buffers.m_normalBuffer,  l_normalBuffer, mesh.pointsNumber() *  3 * sizeof(float));
+                    if(l_bUpdateTopology)
+                    {
+                        float  *l_colorBuffer    = mesh.colorBuffer();
+
+                        updateBuffer(buffers.m_indexBuffer,   mesh.indexVertexTriangleBufferData(), l_i32SizeIndex);
+                        updateBuffer(buffers.m_colorBuffer,   l_colorBuffer,  mesh.pointsNumber() *  3 * sizeof(float));
+
+                        deleteAndNullifyArray(l_colorBuffer);
+
+                        buffers.m_bUpdateTopology = false;
+                    }
 
-                    deleteAndNullifyArray(l_vertexBuffer);
-                    deleteAndNullifyArray(l_colorBuffer);
-                    deleteAndNullifyArray(l_indexBuffer);
-                    deleteAndNullifyArray(l_normalBuffer);
-                    deleteAndNullifyArray(l_textureBuffer);
+                // positions and normals are rewritten in place
+                    const swCloud::SWCloud *l_pCloud = mesh.cloud();
+                    updatePlanarVertexBuffer(buffers.m_vertexBuffer, l_pCloud->coord(0), l_pCloud->coord(1), l_pCloud->coord(2), mesh.pointsNumber());
+                    updateBuffer(buffers.m_normalBuffer,  mesh.normalBufferData(), mesh.pointsNumber() *  3 * sizeof(float));
 
                 buffers.m_bUpdate = false;
             }
@@ -58,6 +58,9 @@ void SWMorphingWorker::startMorphing()
 
     qDebug() << "StartMorphing : " << l_dAlpha << " " << l_dMinAlpha << " " << l_dDiffMax << " " << l_dCoeffAlpha << endl;
 
+    // the stiff steps are resolved on the coarse templates
+    m_pGLOSNRICP->startMultiResolution();
+
     while(l_dAlpha > l_dMinAlpha) // outer loop
     {
         l_i32Iteration = 1;
@@ -112,6 +115,9 @@ void SWMorphingWorker::startMorphing()
         l_dDiff   = DBL_MAX;
     }
 
+    m_pGLOSNRICP->endMultiResolution();
+    emit updateSceneDisplaySignal();
+
     m_oMutex.lockForWrite();
         m_bDoMorphing = false;                
     m_oMutex.unlock();
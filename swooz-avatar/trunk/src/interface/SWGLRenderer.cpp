@@ -0,0 +1,282 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWGLRenderer.cpp
+ * \brief Defines SWGLObjectRenderer, SWGLCloudRenderer and SWGLMeshRenderer
+ */
+
+#include "interface/SWGLRenderer.h"
+
+#include "interface/SWGLUtility.h"
+
+#include <iostream>
+
+
+// ############################################# SWGLObjectRenderer
+
+SWGLObjectRenderer::SWGLObjectRenderer()
+{}
+
+SWGLObjectRenderer::~SWGLObjectRenderer()
+{}
+
+void SWGLObjectRenderer::initBuffers()
+{
+    initIndexBuffer(m_indexBuffer);
+    initVertexBuffer(m_vertexBuffer);
+    initVertexBuffer(m_colorBuffer);
+    initVertexBuffer(m_normalBuffer);
+    initVertexBuffer(m_textureBuffer);
+
+    m_indexBuffer.setUsagePattern(QGLBuffer::StaticDraw);
+    m_vertexBuffer.setUsagePattern(QGLBuffer::StaticDraw);
+    m_colorBuffer.setUsagePattern(QGLBuffer::StaticDraw);
+    m_normalBuffer.setUsagePattern(QGLBuffer::StaticDraw);
+    m_textureBuffer.setUsagePattern(QGLBuffer::StaticDraw);
+}
+
+void SWGLObjectRenderer::clearBuffers()
+{
+    QGLBuffer::release(QGLBuffer::VertexBuffer);
+    QGLBuffer::release(QGLBuffer::IndexBuffer);
+
+    float l_aFNULL[1] = {0.f};
+    uint32 l_aUI32NULL[1] = {0};
+    allocateBuffer(m_vertexBuffer,  l_aFNULL, 1 * sizeof(float));
+    allocateBuffer(m_colorBuffer,   l_aFNULL, 1 * sizeof(float));
+    allocateBuffer(m_normalBuffer,  l_aFNULL, 1 * sizeof(float));
+    allocateBuffer(m_textureBuffer, l_aFNULL, 1 * sizeof(float));
+    allocateBuffer(m_indexBuffer,   l_aUI32NULL, 1 * sizeof(GLuint));
+}
+
+void SWGLObjectRenderer::setTransformationUniforms(QGLShaderProgram &oShader, const QVector3D &oCenter, const QVector3D &oRotation,
+                                                   const QVector3D &oTranslation, cfloat fScaling, const QMatrix4x4 &oMVPMatrix)
+{
+    swCloud::SWRigidMotion l_oTransfo(oRotation.x(), oRotation.y(), oRotation.z());
+    l_oTransfo.m_aFTranslation[0] = oTranslation.x();
+    l_oTransfo.m_aFTranslation[1] = oTranslation.y();
+    l_oTransfo.m_aFTranslation[2] = oTranslation.z();
+
+    QMatrix4x4 l_oTransformation(l_oTransfo.m_aFRotation[0], l_oTransfo.m_aFRotation[1], l_oTransfo.m_aFRotation[2],l_oTransfo.m_aFTranslation[0],
+                                 l_oTransfo.m_aFRotation[3], l_oTransfo.m_aFRotation[4], l_oTransfo.m_aFRotation[5],l_oTransfo.m_aFTranslation[1],
+                                 l_oTransfo.m_aFRotation[6], l_oTransfo.m_aFRotation[7], l_oTransfo.m_aFRotation[8],l_oTransfo.m_aFTranslation[2],
+                                 0.0, 0.0, 0.0, 1.0);
+
+    oShader.setUniformValue("scaling", fScaling);
+    oShader.setUniformValue("translationToCenter", -oCenter);
+    oShader.setUniformValue("applyTransformation", true);
+    oShader.setUniformValue("transformation", l_oTransformation);
+    oShader.setUniformValue("mvpMatrix", oMVPMatrix);
+}
+
+
+// ############################################# SWGLCloudRenderer
+
+void SWGLCloudRenderer::updateBuffers(const swCloud::SWCloud &oCloud)
+{
+    QGLBuffer::release(QGLBuffer::VertexBuffer);
+    QGLBuffer::release(QGLBuffer::IndexBuffer);
+
+    cint l_i32SizeIndex = static_cast<int>(oCloud.size() * sizeof(GLuint));
+
+    // the index of a cloud only depends on its size
+    if(m_indexBuffer.size() != l_i32SizeIndex)
+    {
+        uint32 *l_aUI32IndexBuffer = oCloud.indexBuffer();
+        allocateBuffer(m_indexBuffer, l_aUI32IndexBuffer, l_i32SizeIndex);
+        deleteAndNullifyArray(l_aUI32IndexBuffer);
+    }
+
+    float *l_aFColorBuffer = oCloud.colorBuffer();
+    updatePlanarVertexBuffer(m_vertexBuffer, oCloud.coord(0), oCloud.coord(1), oCloud.coord(2), oCloud.size());
+    updateBuffer(m_colorBuffer, l_aFColorBuffer, oCloud.size() * 3 * sizeof(float));
+    deleteAndNullifyArray(l_aFColorBuffer);
+}
+
+void SWGLCloudRenderer::draw(QGLShaderProgram &oShader)
+{
+    drawBufferWithColor(m_indexBuffer, m_vertexBuffer, m_colorBuffer, oShader, GL_POINTS);
+}
+
+void SWGLCloudRenderer::drawDepthRect(QGLShaderProgram &oShader, const QMatrix4x4 &oMVPMatrix, const swCloud::SWCloudBBox &oBBox, cfloat fDepth)
+{
+    if(!m_depthRectIndexBuffer.isCreated())
+    {
+        uint32 l_aUI32DepthRectI[6] = {0, 1, 2, 2, 3, 0};
+
+        initIndexBuffer(m_depthRectIndexBuffer);
+        initVertexBuffer(m_depthRectVertexBuffer);
+        m_depthRectVertexBuffer.setUsagePattern(QGLBuffer::DynamicDraw);
+        allocateBuffer(m_depthRectIndexBuffer, l_aUI32DepthRectI, 6 * sizeof(GLuint));
+    }
+
+    // defines points
+        float l_aFDepthRectV[12];
+        l_aFDepthRectV[2] = l_aFDepthRectV[5] = l_aFDepthRectV[8] = l_aFDepthRectV[11] = fDepth;
+        l_aFDepthRectV[0] = oBBox.m_fMinX; l_aFDepthRectV[3] = oBBox.m_fMinX; l_aFDepthRectV[6] = oBBox.m_fMaxX; l_aFDepthRectV[9]  = oBBox.m_fMaxX;
+        l_aFDepthRectV[1] = oBBox.m_fMaxY; l_aFDepthRectV[4] = oBBox.m_fMinY; l_aFDepthRectV[7] = oBBox.m_fMinY; l_aFDepthRectV[10] = oBBox.m_fMaxY;
+
+        updateBuffer(m_depthRectVertexBuffer, l_aFDepthRectV, 4 * 3 * sizeof(float));
+
+    // set uniform values parameters
+        oShader.setUniformValue("displayMode", 1);
+        oShader.setUniformValue("uniColor", 22, 39, 51);
+        oShader.setUniformValue("mvpMatrix", oMVPMatrix);
+        oShader.setUniformValue("opacity", 0.8f);
+
+    // draw primitives
+        drawBuffer(m_depthRectIndexBuffer, m_depthRectVertexBuffer, oShader, GL_TRIANGLES);
+}
+
+
+// ############################################# SWGLMeshRenderer
+
+SWGLMeshRenderer::SWGLMeshRenderer()
+{}
+
+void SWGLMeshRenderer::initBuffers(cbool bDynamicPositions)
+{
+    SWGLObjectRenderer::initBuffers();
+
+    if(bDynamicPositions)
+    {
+        m_vertexBuffer.setUsagePattern(QGLBuffer::DynamicDraw);
+        m_normalBuffer.setUsagePattern(QGLBuffer::DynamicDraw);
+    }
+}
+
+void SWGLMeshRenderer::updateBuffers(const swMesh::SWMesh &oMesh)
+{
+    QGLBuffer::release(QGLBuffer::VertexBuffer);
+    QGLBuffer::release(QGLBuffer::IndexBuffer);
+
+    float *l_aFColorBuffer = oMesh.colorBuffer();
+    updateBuffer(m_indexBuffer,   oMesh.indexVertexTriangleBufferData(), oMesh.trianglesNumber() * 3 * sizeof(GLuint));
+    updateBuffer(m_colorBuffer,   l_aFColorBuffer,                       oMesh.pointsNumber() * 3 * sizeof(float));
+    updateBuffer(m_textureBuffer, oMesh.textureBufferData(),             oMesh.pointsNumber() * 2 * sizeof(float));
+    deleteAndNullifyArray(l_aFColorBuffer);
+
+    updateVertexBuffers(oMesh);
+}
+
+void SWGLMeshRenderer::updateVertexBuffers(const swMesh::SWMesh &oMesh)
+{
+    QGLBuffer::release(QGLBuffer::VertexBuffer);
+
+    const swCloud::SWCloud *l_pCloud = oMesh.cloud();
+    updatePlanarVertexBuffer(m_vertexBuffer, l_pCloud->coord(0), l_pCloud->coord(1), l_pCloud->coord(2), oMesh.pointsNumber());
+    updateBuffer(m_normalBuffer, oMesh.normalBufferData(), oMesh.pointsNumber() * 3 * sizeof(float));
+}
+
+void SWGLMeshRenderer::updateAnimatedVertexBuffer(const swMesh::SWMesh &oMesh, const QVector<float> &vOffsetX, const QVector<float> &vOffsetY,
+                                                  const QVector<float> &vOffsetZ, const QVector<float> &vRigidMotion, cint i32CenterId)
+{
+    const swCloud::SWCloud *l_pCloud = oMesh.cloud();
+    cint l_i32PointsNb = static_cast<int>(l_pCloud->size());
+
+    if(vOffsetX.size() < l_i32PointsNb || vOffsetY.size() < l_i32PointsNb || vOffsetZ.size() < l_i32PointsNb ||
+       vRigidMotion.size() < 6 || i32CenterId >= l_i32PointsNb)
+    {
+        std::cerr << "-ERROR : updateAnimatedVertexBuffer, invalid animation data. " << std::endl;
+        return;
+    }
+
+    QGLBuffer::release(QGLBuffer::VertexBuffer);
+
+    const float *l_aFX = l_pCloud->coord(0), *l_aFY = l_pCloud->coord(1), *l_aFZ = l_pCloud->coord(2);
+    const float *l_aFOffsetX = vOffsetX.constData(), *l_aFOffsetY = vOffsetY.constData(), *l_aFOffsetZ = vOffsetZ.constData();
+
+    // the rigid motion is applied around the center point
+        float l_aFCenter[3] = {l_aFX[i32CenterId], l_aFY[i32CenterId], l_aFZ[i32CenterId]};
+
+        swCloud::SWRigidMotion l_rigidMotion((180.f/3.14)*vRigidMotion[3],(180.f/3.14)*vRigidMotion[4],(-180.f/3.14)*vRigidMotion[5]);
+        const float *l_aFR = l_rigidMotion.m_aFRotation;
+        float l_aFT[3] = { vRigidMotion[0]/40.f + l_aFCenter[0],
+                           vRigidMotion[1]/40.f + l_aFCenter[1],
+                          -vRigidMotion[2]/40.f + l_aFCenter[2]};
+
+    // write the animated positions directly in the mapped buffer, or in a persistent copy if the mapping is not available
+        cint l_i32SizeData = l_i32PointsNb * 3 * static_cast<int>(sizeof(float));
+        float *l_aFVertex  = static_cast<float*>(mapBufferForWriting(m_vertexBuffer, l_i32SizeData));
+        bool l_bMapped     = (l_aFVertex != NULL);
+
+        if(!l_bMapped)
+        {
+            m_vAnimationVertexBuffer.resize(l_i32PointsNb * 3);
+            l_aFVertex = &m_vAnimationVertexBuffer[0];
+        }
+
+        for(int ii = 0; ii < l_i32PointsNb; ++ii)
+        {
+            float l_fX = l_aFX[ii] - l_aFCenter[0] + l_aFOffsetX[ii];
+            float l_fY = l_aFY[ii] - l_aFCenter[1] + l_aFOffsetY[ii];
+            float l_fZ = l_aFZ[ii] - l_aFCenter[2] + l_aFOffsetZ[ii];
+
+            l_aFVertex[ii*3]     = l_aFR[0] * l_fX + l_aFR[1] * l_fY + l_aFR[2] * l_fZ + l_aFT[0];
+            l_aFVertex[ii*3 + 1] = l_aFR[3] * l_fX + l_aFR[4] * l_fY + l_aFR[5] * l_fZ + l_aFT[1];
+            l_aFVertex[ii*3 + 2] = l_aFR[6] * l_fX + l_aFR[7] * l_fY + l_aFR[8] * l_fZ + l_aFT[2];
+        }
+
+        if(l_bMapped)
+        {
+            unmapBuffer(m_vertexBuffer);
+        }
+        else
+        {
+            updateBuffer(m_vertexBuffer, l_aFVertex, l_i32SizeData);
+        }
+}
+
+void SWGLMeshRenderer::draw(QGLShaderProgram &oShader, const GLObjectDisplayMode oDisplayMode, const GLuint ui32Texture)
+{
+    if(oDisplayMode == GLO_ORIGINAL_COLOR)
+    {
+        drawBufferWithColor(m_indexBuffer, m_vertexBuffer, m_colorBuffer, m_normalBuffer, oShader, GL_TRIANGLES);
+    }
+    else if(oDisplayMode == GLO_TEXTURE)
+    {
+        glEnable(GL_TEXTURE_2D);
+
+        drawWithTexture(oShader, ui32Texture);
+
+        glDisable(GL_TEXTURE_2D);
+    }
+    else if(oDisplayMode == GLO_UNI_COLOR)
+    {
+        drawBuffer(m_indexBuffer, m_vertexBuffer, m_normalBuffer, oShader, GL_TRIANGLES);
+    }
+}
+
+void SWGLMeshRenderer::drawWithTexture(QGLShaderProgram &oShader, const GLuint ui32Texture)
+{
+    // bind texture
+        if(ui32Texture)
+        {
+            glBindTexture(GL_TEXTURE_2D, ui32Texture);
+        }
+
+    drawBufferWithTexture(m_indexBuffer, m_vertexBuffer, m_textureBuffer, m_normalBuffer, oShader, GL_TRIANGLES);
+}
@@ -87,6 +87,7 @@ SWMorphingInterface::SWMorphingInterface(QApplication *parent) : m_uiMorphing(ne
     m_dGamaDefaultValue       = 3.2;//100.0;
     m_dCoeffValueDefaultValue = 0.95;//0.8;
     m_dAngleMaxDefaultValue   = 50.0;
+    m_i32LevelsDefaultValue   = 1;
 
     // parameters
         // spinbox
@@ -98,6 +99,7 @@ SWMorphingInterface::SWMorphingInterface(QApplication *parent) : m_uiMorphing(ne
             m_uiMorphing->dsbAngleMax->setDecimals(2);
             m_uiMorphing->dsbBeta->setMinimum(0.0);         m_uiMorphing->dsbBeta->setMaximum(150.0);
             m_uiMorphing->dsbGama->setMinimum(0.0);         m_uiMorphing->dsbGama->setMaximum(10000.0);
+            m_uiMorphing->sbLevels->setMinimum(1);          m_uiMorphing->sbLevels->setMaximum(4);
 
         // checkbox
             m_uiMorphing->cbTemplateMesh->setChecked(true); m_uiMorphing->cbTargetMesh->setChecked(true);
@@ -194,6 +196,8 @@ SWMorphingInterface::SWMorphingInterface(QApplication *parent) : m_uiMorphing(ne
         QObject::connect(m_uiMorphing->dsbBeta,             SIGNAL(valueChanged(double)),m_pGLOSNRICP,SLOT(setBeta(double)));
         QObject::connect(m_uiMorphing->dsbGama,             SIGNAL(valueChanged(double)),m_pGLOSNRICP,SLOT(setGama(double)));
         QObject::connect(m_uiMorphing->dsbAngleMax,         SIGNAL(valueChanged(double)),m_pGLOSNRICP,SLOT(setAngleMax(double)));
+            // spinboxes
+        QObject::connect(m_uiMorphing->sbLevels,            SIGNAL(valueChanged(int)),   m_pGLOSNRICP,SLOT(setLevelsNumber(int)));
 
 
         // fullscreen
@@ -265,6 +269,7 @@ void SWMorphingInterface::resetAllParameters()
     m_uiMorphing->dsbBeta->setValue(m_dBetaDefaultValue);
     m_uiMorphing->dsbGama->setValue(m_dGamaDefaultValue);
     m_uiMorphing->dsbAngleMax->setValue(m_dAngleMaxDefaultValue);
+    m_uiMorphing->sbLevels->setValue(m_i32LevelsDefaultValue);
 
     m_pGLOSNRICP->setRotTargetX(m_i32RotXDefaultValue); m_pGLOSNRICP->setRotTargetY(m_i32RotYDefaultValue);
     m_pGLOSNRICP->setRotTargetZ(m_i32RotZDefaultValue);
@@ -347,6 +352,7 @@ void SWMorphingInterface::unlockInterface()
         m_uiMorphing->dsbBeta->setEnabled(true);
         m_uiMorphing->dsbGama->setEnabled(true);
         m_uiMorphing->dsbAngleMax->setEnabled(true);
+        m_uiMorphing->sbLevels->setEnabled(true);
 
     m_uiMorphing->pbStop->setEnabled(false);
 }
@@ -380,6 +386,7 @@ void SWMorphingInterface::lockInterface()
         m_uiMorphing->dsbBeta->setDisabled(true);
         m_uiMorphing->dsbGama->setDisabled(true);
         m_uiMorphing->dsbAngleMax->setDisabled(true);
+        m_uiMorphing->sbLevels->setDisabled(true);
 
     m_uiMorphing->pbStop->setDisabled(false);
 }
@@ -34,6 +34,10 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <cmath>
 
 #include "mesh/SWMesh.h"
 #include "geometryUtility.h"
@@ -43,10 +47,10 @@ using namespace swCloud;
 using namespace std;
 
 
-SWMesh::SWMesh() : m_ui32EdgesNumber(0),  m_ui32TrianglesNumber(0)
+SWMesh::SWMesh() : m_ui32EdgesNumber(0),  m_ui32TrianglesNumber(0), m_ui32DirtyStreams(SWM_ALL_STREAMS)
 {}
 
-SWMesh::SWMesh(const std::string &sPathObjFile) : m_ui32TrianglesNumber(0), m_ui32EdgesNumber(0)
+SWMesh::SWMesh(const std::string &sPathObjFile) : m_ui32TrianglesNumber(0), m_ui32EdgesNumber(0), m_ui32DirtyStreams(SWM_ALL_STREAMS)
 {   
     bool l_bIsNormal  = false;
     bool l_bIsTexture = false;
@@ -203,7 +207,7 @@ SWMesh::SWMesh(const std::string &sPathObjFile) : m_ui32TrianglesNumber(0), m_ui
 
 SWMesh::SWMesh(const std::vector<std::vector<float> > &v3FPoints,
                const std::vector<std::vector<uint> >  &v3UIFaces,
-               const std::vector<std::vector<float> > &v2FTextureCoords) : m_ui32EdgesNumber(0),  m_ui32TrianglesNumber(0)
+               const std::vector<std::vector<float> > &v2FTextureCoords) : m_ui32EdgesNumber(0),  m_ui32TrianglesNumber(0), m_ui32DirtyStreams(SWM_ALL_STREAMS)
 {
     set(v3FPoints, v3UIFaces, v2FTextureCoords);
 }
@@ -235,6 +239,8 @@ SWMesh &SWMesh::operator=(const SWMesh &oMesh)
     m_a2VertexLinks     = oMesh.m_a2VertexLinks;
     m_a2VertexNeighbors = oMesh.m_a2VertexNeighbors;
 
+    m_ui32DirtyStreams = SWM_ALL_STREAMS;
+
     return *this;
 }
 
@@ -323,6 +329,8 @@ void SWMesh::clean()
 
     m_ui32EdgesNumber     = 0;
     m_ui32TrianglesNumber = 0;
+
+    m_ui32DirtyStreams = SWM_ALL_STREAMS;
 }
 
 void SWMesh::point(float *aFXYZ, cuint ui32IdVertex) const
@@ -343,6 +351,8 @@ void SWMesh::invertAllNormals()
     {
         m_a3FNormals[ii*3+2] *= -1.f;
     }
+
+    m_ui32DirtyStreams |= SWM_NORMALS;
 }
 
 void SWMesh::deletePointsWithNoFaces()
@@ -404,6 +414,385 @@ void SWMesh::deletePointsWithNoFaces()
     // update normals/textures
         m_a3FNormals  = l_normals;
         m_a2FTextures = l_textures;
+
+    m_ui32DirtyStreams = SWM_ALL_STREAMS;
+}
+
+namespace
+{
+    /**
+     * \brief Symmetric 4x4 matrix of a quadric error metric : sum of the weighted squared distances to a set of planes.
+     */
+    struct SWQuadric
+    {
+        double m_aD[10]; /**< a2 ab ac ad b2 bc bd c2 cd d2 */
+
+        SWQuadric()
+        {
+            std::fill(m_aD, m_aD + 10, 0.0);
+        }
+
+        void addPlane(cdouble dA, cdouble dB, cdouble dC, cdouble dD, cdouble dWeight)
+        {
+            m_aD[0] += dWeight * dA * dA; m_aD[1] += dWeight * dA * dB; m_aD[2] += dWeight * dA * dC; m_aD[3] += dWeight * dA * dD;
+            m_aD[4] += dWeight * dB * dB; m_aD[5] += dWeight * dB * dC; m_aD[6] += dWeight * dB * dD;
+            m_aD[7] += dWeight * dC * dC; m_aD[8] += dWeight * dC * dD;
+            m_aD[9] += dWeight * dD * dD;
+        }
+
+        void add(const SWQuadric &oQuadric)
+        {
+            for(int ii = 0; ii < 10; ++ii)
+            {
+                m_aD[ii] += oQuadric.m_aD[ii];
+            }
+        }
+
+        double error(const float *aFXYZ) const
+        {
+            double l_dX = aFXYZ[0], l_dY = aFXYZ[1], l_dZ = aFXYZ[2];
+
+            return        m_aD[0] * l_dX * l_dX + 2.0 * m_aD[1] * l_dX * l_dY + 2.0 * m_aD[2] * l_dX * l_dZ + 2.0 * m_aD[3] * l_dX
+                        + m_aD[4] * l_dY * l_dY + 2.0 * m_aD[5] * l_dY * l_dZ + 2.0 * m_aD[6] * l_dY
+                        + m_aD[7] * l_dZ * l_dZ + 2.0 * m_aD[8] * l_dZ
+                        + m_aD[9];
+        }
+    };
+
+    /**
+     * \brief Collapse of a vertex onto a neighbour, the stamps invalidate the collapses computed before a change of their vertices.
+     */
+    struct SWCollapse
+    {
+        double m_dCost;         /**< quadric error of the collapse */
+        uint m_ui32From;        /**< removed vertex */
+        uint m_ui32To;          /**< kept vertex */
+        uint m_ui32FromStamp;   /**< stamp of the removed vertex when the cost was computed */
+        uint m_ui32ToStamp;     /**< stamp of the kept vertex when the cost was computed */
+
+        bool operator<(const SWCollapse &oCollapse) const
+        {
+            return m_dCost > oCollapse.m_dCost; // lowest cost on top of the heap
+        }
+    };
+
+    /**
+     * \brief Work data of the decimation.
+     */
+    struct SWDecimationData
+    {
+        std::vector<float> m_vPoints;                   /**< vertices coordinates */
+        std::vector<uint> m_vFaces;                     /**< vertices ids of the faces */
+        std::vector<bool> m_vFaceRemoved;               /**< removed faces */
+        std::vector<std::vector<uint> > m_vVertexFaces; /**< faces of each vertex */
+        std::vector<bool> m_vLocked;                    /**< border and pinned vertices */
+        std::vector<SWQuadric> m_vQuadrics;             /**< quadric of each vertex */
+        std::vector<uint> m_vStamps;                    /**< modifications count of each vertex */
+        std::priority_queue<SWCollapse> m_oHeap;        /**< collapses ordered by cost */
+
+        void neighbours(cuint ui32Vertex, std::vector<uint> &vNeighbours) const
+        {
+            vNeighbours.clear();
+            const std::vector<uint> &l_vFaces = m_vVertexFaces[ui32Vertex];
+
+            for(uint ii = 0; ii < l_vFaces.size(); ++ii)
+            {
+                for(uint jj = 0; jj < 3; ++jj)
+                {
+                    uint l_ui32Vertex = m_vFaces[3 * l_vFaces[ii] + jj];
+                    if(l_ui32Vertex != ui32Vertex && std::find(vNeighbours.begin(), vNeighbours.end(), l_ui32Vertex) == vNeighbours.end())
+                    {
+                        vNeighbours.push_back(l_ui32Vertex);
+                    }
+                }
+            }
+        }
+
+        void pushCollapse(cuint ui32From, cuint ui32To)
+        {
+            if(m_vLocked[ui32From])
+            {
+                return;
+            }
+
+            SWCollapse l_oCollapse;
+            l_oCollapse.m_dCost         = m_vQuadrics[ui32From].error(&m_vPoints[3 * ui32To]) + m_vQuadrics[ui32To].error(&m_vPoints[3 * ui32To]);
+            l_oCollapse.m_ui32From      = ui32From;
+            l_oCollapse.m_ui32To        = ui32To;
+            l_oCollapse.m_ui32FromStamp = m_vStamps[ui32From];
+            l_oCollapse.m_ui32ToStamp   = m_vStamps[ui32To];
+            m_oHeap.push(l_oCollapse);
+        }
+
+        void faceNormal(const float *aFP1, const float *aFP2, const float *aFP3, float *aFNormal) const
+        {
+            float l_aFV1[3] = {aFP2[0] - aFP1[0], aFP2[1] - aFP1[1], aFP2[2] - aFP1[2]};
+            float l_aFV2[3] = {aFP3[0] - aFP1[0], aFP3[1] - aFP1[1], aFP3[2] - aFP1[2]};
+
+            aFNormal[0] = l_aFV1[1] * l_aFV2[2] - l_aFV1[2] * l_aFV2[1];
+            aFNormal[1] = l_aFV1[2] * l_aFV2[0] - l_aFV1[0] * l_aFV2[2];
+            aFNormal[2] = l_aFV1[0] * l_aFV2[1] - l_aFV1[1] * l_aFV2[0];
+        }
+
+        bool isCollapseValid(cuint ui32From, cuint ui32To) const
+        {
+            // link condition : the common neighbours are the opposite vertices of the faces of the edge, the mesh stays manifold
+                std::vector<uint> l_vFromNeighbours, l_vToNeighbours;
+                neighbours(ui32From, l_vFromNeighbours);
+                neighbours(ui32To,   l_vToNeighbours);
+
+                uint l_ui32CommonNeighboursNb = 0;
+                for(uint ii = 0; ii < l_vFromNeighbours.size(); ++ii)
+                {
+                    if(std::find(l_vToNeighbours.begin(), l_vToNeighbours.end(), l_vFromNeighbours[ii]) != l_vToNeighbours.end())
+                    {
+                        ++l_ui32CommonNeighboursNb;
+                    }
+                }
+
+                uint l_ui32EdgeFacesNb = 0;
+                const std::vector<uint> &l_vFromFaces = m_vVertexFaces[ui32From];
+                for(uint ii = 0; ii < l_vFromFaces.size(); ++ii)
+                {
+                    const uint *l_aUI32Face = &m_vFaces[3 * l_vFromFaces[ii]];
+                    if(l_aUI32Face[0] == ui32To || l_aUI32Face[1] == ui32To || l_aUI32Face[2] == ui32To)
+                    {
+                        ++l_ui32EdgeFacesNb;
+                    }
+                }
+
+                if(l_ui32EdgeFacesNb == 0 || l_ui32CommonNeighboursNb != l_ui32EdgeFacesNb)
+                {
+                    return false;
+                }
+
+            // the remaining faces of the removed vertex must not flip or degenerate
+                for(uint ii = 0; ii < l_vFromFaces.size(); ++ii)
+                {
+                    const uint *l_aUI32Face = &m_vFaces[3 * l_vFromFaces[ii]];
+                    if(l_aUI32Face[0] == ui32To || l_aUI32Face[1] == ui32To || l_aUI32Face[2] == ui32To)
+                    {
+                        continue;
+                    }
+
+                    const float *l_aFPts[3], *l_aFNewPts[3];
+                    for(uint jj = 0; jj < 3; ++jj)
+                    {
+                        l_aFPts[jj]    = &m_vPoints[3 * l_aUI32Face[jj]];
+                        l_aFNewPts[jj] = (l_aUI32Face[jj] == ui32From) ? &m_vPoints[3 * ui32To] : l_aFPts[jj];
+                    }
+
+                    float l_aFNormal[3], l_aFNewNormal[3];
+                    faceNormal(l_aFPts[0], l_aFPts[1], l_aFPts[2], l_aFNormal);
+                    faceNormal(l_aFNewPts[0], l_aFNewPts[1], l_aFNewPts[2], l_aFNewNormal);
+
+                    double l_dDot       = l_aFNormal[0] * l_aFNewNormal[0] + l_aFNormal[1] * l_aFNewNormal[1] + l_aFNormal[2] * l_aFNewNormal[2];
+                    double l_dNorms     = sqrt(static_cast<double>(l_aFNormal[0] * l_aFNormal[0] + l_aFNormal[1] * l_aFNormal[1] + l_aFNormal[2] * l_aFNormal[2])) *
+                                          sqrt(static_cast<double>(l_aFNewNormal[0] * l_aFNewNormal[0] + l_aFNewNormal[1] * l_aFNewNormal[1] + l_aFNewNormal[2] * l_aFNewNormal[2]));
+
+                    if(l_dNorms <= 0.0 || l_dDot < 0.2 * l_dNorms)
+                    {
+                        return false;
+                    }
+                }
+
+            return true;
+        }
+    };
+}
+
+uint SWMesh::decimate(SWMesh &oDecimatedMesh, std::vector<uint> &vOldToNew, cuint ui32TrianglesNb, cfloat fMaxError,
+                      const std::vector<uint> &vPinnedVertices) const
+{
+    cuint l_ui32PointsNb = pointsNumber();
+    SWDecimationData l_oData;
+
+    // init work data
+        l_oData.m_vPoints.resize(3 * l_ui32PointsNb);
+        for(uint ii = 0; ii < l_ui32PointsNb; ++ii)
+        {
+            point(&l_oData.m_vPoints[3 * ii], ii);
+        }
+
+        l_oData.m_vFaces = m_aIdFaces;
+        l_oData.m_vFaceRemoved.assign(trianglesNumber(), false);
+        l_oData.m_vVertexFaces.resize(l_ui32PointsNb);
+        for(uint ii = 0; ii < l_oData.m_vFaces.size(); ++ii)
+        {
+            l_oData.m_vVertexFaces[l_oData.m_vFaces[ii]].push_back(ii / 3);
+        }
+
+    // border (as vertexOnBorder) and pinned vertices are never removed
+        l_oData.m_vLocked.assign(l_ui32PointsNb, false);
+        for(uint ii = 0; ii < l_ui32PointsNb && m_a2VertexNeighbors.size() == l_ui32PointsNb; ++ii)
+        {
+            l_oData.m_vLocked[ii] = (m_vVertexIdTriangle[ii].size() != m_a2VertexNeighbors[ii].size());
+        }
+        for(uint ii = 0; ii < vPinnedVertices.size(); ++ii)
+        {
+            if(vPinnedVertices[ii] < l_ui32PointsNb)
+            {
+                l_oData.m_vLocked[vPinnedVertices[ii]] = true;
+            }
+        }
+
+    // quadrics of the planes of the faces, weighted by the faces area
+        l_oData.m_vQuadrics.resize(l_ui32PointsNb);
+        for(uint ii = 0; ii < trianglesNumber(); ++ii)
+        {
+            const float *l_aFP1 = &l_oData.m_vPoints[3 * l_oData.m_vFaces[3*ii]];
+            float l_aFNormal[3];
+            l_oData.faceNormal(l_aFP1, &l_oData.m_vPoints[3 * l_oData.m_vFaces[3*ii+1]], &l_oData.m_vPoints[3 * l_oData.m_vFaces[3*ii+2]], l_aFNormal);
+
+            double l_dNorm = sqrt(static_cast<double>(l_aFNormal[0] * l_aFNormal[0] + l_aFNormal[1] * l_aFNormal[1] + l_aFNormal[2] * l_aFNormal[2]));
+            if(l_dNorm <= 0.0)
+            {
+                continue;
+            }
+
+            double l_dA = l_aFNormal[0] / l_dNorm, l_dB = l_aFNormal[1] / l_dNorm, l_dC = l_aFNormal[2] / l_dNorm;
+            double l_dD = -(l_dA * l_aFP1[0] + l_dB * l_aFP1[1] + l_dC * l_aFP1[2]);
+
+            for(uint jj = 0; jj < 3; ++jj)
+            {
+                l_oData.m_vQuadrics[l_oData.m_vFaces[3*ii+jj]].addPlane(l_dA, l_dB, l_dC, l_dD, 0.5 * l_dNorm);
+            }
+        }
+
+    // init the heap with the collapses of all the edges
+        l_oData.m_vStamps.assign(l_ui32PointsNb, 0);
+        std::vector<uint> l_vNeighbours;
+        for(uint ii = 0; ii < l_ui32PointsNb; ++ii)
+        {
+            l_oData.neighbours(ii, l_vNeighbours);
+            for(uint jj = 0; jj < l_vNeighbours.size(); ++jj)
+            {
+                l_oData.pushCollapse(ii, l_vNeighbours[jj]);
+            }
+        }
+
+    // collapse the lowest cost edges until the budget or the max error is reached
+        std::vector<int> l_vCollapsedTo(l_ui32PointsNb, -1);
+        uint l_ui32TrianglesNb = trianglesNumber();
+
+        while(l_ui32TrianglesNb > ui32TrianglesNb && !l_oData.m_oHeap.empty())
+        {
+            SWCollapse l_oCollapse = l_oData.m_oHeap.top();
+            l_oData.m_oHeap.pop();
+
+            if(l_oCollapse.m_dCost > fMaxError)
+            {
+                break;
+            }
+
+            cuint l_ui32From = l_oCollapse.m_ui32From, l_ui32To = l_oCollapse.m_ui32To;
+
+            if(l_vCollapsedTo[l_ui32From] != -1 || l_vCollapsedTo[l_ui32To] != -1 ||
+               l_oData.m_vStamps[l_ui32From] != l_oCollapse.m_ui32FromStamp || l_oData.m_vStamps[l_ui32To] != l_oCollapse.m_ui32ToStamp ||
+               !l_oData.isCollapseValid(l_ui32From, l_ui32To))
+            {
+                continue;
+            }
+
+            // remove the faces of the edge, the other faces of the removed vertex are given to the kept vertex
+                std::vector<uint> &l_vFromFaces = l_oData.m_vVertexFaces[l_ui32From];
+                for(uint ii = 0; ii < l_vFromFaces.size(); ++ii)
+                {
+                    uint *l_aUI32Face = &l_oData.m_vFaces[3 * l_vFromFaces[ii]];
+
+                    if(l_aUI32Face[0] == l_ui32To || l_aUI32Face[1] == l_ui32To || l_aUI32Face[2] == l_ui32To)
+                    {
+                        l_oData.m_vFaceRemoved[l_vFromFaces[ii]] = true;
+                        --l_ui32TrianglesNb;
+
+                        for(uint jj = 0; jj < 3; ++jj)
+                        {
+                            if(l_aUI32Face[jj] != l_ui32From)
+                            {
+                                std::vector<uint> &l_vFaces = l_oData.m_vVertexFaces[l_aUI32Face[jj]];
+                                l_vFaces.erase(std::find(l_vFaces.begin(), l_vFaces.end(), l_vFromFaces[ii]));
+                            }
+                        }
+                    }
+                    else
+                    {
+                        for(uint jj = 0; jj < 3; ++jj)
+                        {
+                            if(l_aUI32Face[jj] == l_ui32From)
+                            {
+                                l_aUI32Face[jj] = l_ui32To;
+                            }
+                        }
+
+                        l_oData.m_vVertexFaces[l_ui32To].push_back(l_vFromFaces[ii]);
+                    }
+                }
+                l_vFromFaces.clear();
+
+                l_oData.m_vQuadrics[l_ui32To].add(l_oData.m_vQuadrics[l_ui32From]);
+                l_vCollapsedTo[l_ui32From] = static_cast<int>(l_ui32To);
+                ++l_oData.m_vStamps[l_ui32To];
+
+            // the costs of the edges of the kept vertex have changed
+                l_oData.neighbours(l_ui32To, l_vNeighbours);
+                for(uint ii = 0; ii < l_vNeighbours.size(); ++ii)
+                {
+                    l_oData.pushCollapse(l_ui32To, l_vNeighbours[ii]);
+                    l_oData.pushCollapse(l_vNeighbours[ii], l_ui32To);
+                }
+        }
+
+    // new ids of the remaining vertices, the removed vertices take the id of the vertex they have been collapsed onto
+        std::vector<int> l_vNewIds(l_ui32PointsNb, -1);
+        std::vector<std::vector<float> > l_vNewPoints, l_vNewTextures;
+        bool l_bTextures = (m_a2FTextures.size() == 2 * l_ui32PointsNb);
+
+        for(uint ii = 0; ii < l_ui32PointsNb; ++ii)
+        {
+            if(l_vCollapsedTo[ii] == -1)
+            {
+                l_vNewIds[ii] = static_cast<int>(l_vNewPoints.size());
+                l_vNewPoints.push_back(std::vector<float>(l_oData.m_vPoints.begin() + 3 * ii, l_oData.m_vPoints.begin() + 3 * ii + 3));
+
+                if(l_bTextures)
+                {
+                    l_vNewTextures.push_back(std::vector<float>(m_a2FTextures.begin() + 2 * ii, m_a2FTextures.begin() + 2 * ii + 2));
+                }
+            }
+        }
+
+        vOldToNew.resize(l_ui32PointsNb);
+        for(uint ii = 0; ii < l_ui32PointsNb; ++ii)
+        {
+            uint l_ui32Kept = ii;
+            while(l_vCollapsedTo[l_ui32Kept] != -1)
+            {
+                l_ui32Kept = static_cast<uint>(l_vCollapsedTo[l_ui32Kept]);
+            }
+
+            vOldToNew[ii] = static_cast<uint>(l_vNewIds[l_ui32Kept]);
+        }
+
+    // build the decimated mesh (faces ids starting at 1 for SWMesh::set)
+        std::vector<std::vector<uint> > l_vNewFaces;
+        l_vNewFaces.reserve(l_ui32TrianglesNb);
+
+        for(uint ii = 0; ii < l_oData.m_vFaceRemoved.size(); ++ii)
+        {
+            if(!l_oData.m_vFaceRemoved[ii])
+            {
+                std::vector<uint> l_vFace(3);
+                for(uint jj = 0; jj < 3; ++jj)
+                {
+                    l_vFace[jj] = static_cast<uint>(l_vNewIds[l_oData.m_vFaces[3*ii+jj]]) + 1;
+                }
+                l_vNewFaces.push_back(l_vFace);
+            }
+        }
+
+        oDecimatedMesh.set(l_vNewPoints, l_vNewFaces, l_vNewTextures);
+
+    return static_cast<uint>(l_vNewFaces.size());
 }
 
 bool SWMesh::saveToObj(const std::string &sPath, const std::string &sNameObj, const std::string sNameMaterial, const std::string sNameTexture) // TODO : finish
@@ -531,6 +920,92 @@ bool SWMesh::saveToObj(const std::string &sPath, const std::string &sNameObj, co
 void SWMesh::scale(cfloat fScaleValue)
 {
     m_oCloud *= fScaleValue;
+    m_ui32DirtyStreams |= SWM_VERTICES;
+
+    // the triangles normals are invariant by an uniform scaling, only the normals of the vertices without triangles
+    // (oriented toward the mean point) may change with a non positive value
+    if(fScaleValue <= 0.f && m_a3FNonOrientedTrianglesNormals.size() > 0)
+    {
+        updateNonOrientedTrianglesNormals();
+        updateNonOrientedVerticesNormals();
+    }
+}
+
+bool SWMesh::copyGeometry(const SWMesh &oMesh)
+{
+    if(oMesh.pointsNumber() != pointsNumber())
+    {
+        std::cerr << "Error : copyGeometry SWMesh, the points number doesn't match. " << std::endl;
+        return false;
+    }
+
+    m_oCloud.copy(oMesh.m_oCloud);
+
+    m_a3FNormals                     = oMesh.m_a3FNormals;
+    m_a3FNonOrientedVerticesNormals  = oMesh.m_a3FNonOrientedVerticesNormals;
+    m_a3FNonOrientedTrianglesNormals = oMesh.m_a3FNonOrientedTrianglesNormals;
+
+    m_ui32DirtyStreams |= SWM_VERTICES | SWM_NORMALS;
+
+    return true;
+}
+
+void SWMesh::transformNormals(cfloat *aFRotationMatrix)
+{
+    // normals only need to be rotated, the dot products used to orient the vertices normals are kept
+    for(uint ii = 0; ii < m_a3FNormals.size() / 3; ++ii)
+    {
+        float *l_aFNormal = &m_a3FNormals[ii*3];
+        float l_fNewX = aFRotationMatrix[0] * l_aFNormal[0] + aFRotationMatrix[1] * l_aFNormal[1] + aFRotationMatrix[2] * l_aFNormal[2];
+        float l_fNewY = aFRotationMatrix[3] * l_aFNormal[0] + aFRotationMatrix[4] * l_aFNormal[1] + aFRotationMatrix[5] * l_aFNormal[2];
+        float l_fNewZ = aFRotationMatrix[6] * l_aFNormal[0] + aFRotationMatrix[7] * l_aFNormal[1] + aFRotationMatrix[8] * l_aFNormal[2];
+        l_aFNormal[0] = l_fNewX; l_aFNormal[1] = l_fNewY; l_aFNormal[2] = l_fNewZ;
+    }
+
+    for(uint ii = 0; ii < m_a3FNonOrientedVerticesNormals.size(); ++ii)
+    {
+        vector<float> &l_v3FNormal = m_a3FNonOrientedVerticesNormals[ii];
+        float l_fNewX = aFRotationMatrix[0] * l_v3FNormal[0] + aFRotationMatrix[1] * l_v3FNormal[1] + aFRotationMatrix[2] * l_v3FNormal[2];
+        float l_fNewY = aFRotationMatrix[3] * l_v3FNormal[0] + aFRotationMatrix[4] * l_v3FNormal[1] + aFRotationMatrix[5] * l_v3FNormal[2];
+        float l_fNewZ = aFRotationMatrix[6] * l_v3FNormal[0] + aFRotationMatrix[7] * l_v3FNormal[1] + aFRotationMatrix[8] * l_v3FNormal[2];
+        l_v3FNormal[0] = l_fNewX; l_v3FNormal[1] = l_fNewY; l_v3FNormal[2] = l_fNewZ;
+    }
+
+    for(uint ii = 0; ii < m_a3FNonOrientedTrianglesNormals.size(); ++ii)
+    {
+        vector<float> &l_v3FNormal = m_a3FNonOrientedTrianglesNormals[ii];
+        float l_fNewX = aFRotationMatrix[0] * l_v3FNormal[0] + aFRotationMatrix[1] * l_v3FNormal[1] + aFRotationMatrix[2] * l_v3FNormal[2];
+        float l_fNewY = aFRotationMatrix[3] * l_v3FNormal[0] + aFRotationMatrix[4] * l_v3FNormal[1] + aFRotationMatrix[5] * l_v3FNormal[2];
+        float l_fNewZ = aFRotationMatrix[6] * l_v3FNormal[0] + aFRotationMatrix[7] * l_v3FNormal[1] + aFRotationMatrix[8] * l_v3FNormal[2];
+        l_v3FNormal[0] = l_fNewX; l_v3FNormal[1] = l_fNewY; l_v3FNormal[2] = l_fNewZ;
+    }
+
+    m_ui32DirtyStreams |= SWM_NORMALS;
+}
+
+bool SWMesh::transform(cfloat *aFRotationMatrix, cfloat *aFTranslationMatrix)
+{
+    m_oCloud.transform(aFRotationMatrix, aFTranslationMatrix);
+    m_ui32DirtyStreams |= SWM_VERTICES;
+
+    transformNormals(aFRotationMatrix);
+
+    return true;
+}
+
+uint SWMesh::dirtyStreams() const
+{
+    return m_ui32DirtyStreams;
+}
+
+void SWMesh::setDirtyStreams(cuint ui32Streams)
+{
+    m_ui32DirtyStreams |= ui32Streams;
+}
+
+void SWMesh::clearDirtyStreams(cuint ui32Streams)
+{
+    m_ui32DirtyStreams &= ~ui32Streams;
 }
 
 float *SWMesh::vertexBuffer() const
@@ -595,6 +1070,36 @@ float *SWMesh::textureBuffer() const
     return l_aFTexture;
 }
 
+const uint *SWMesh::indexVertexTriangleBufferData() const
+{
+    if(m_aIdFaces.size() == 0)
+    {
+        return NULL;
+    }
+
+    return &m_aIdFaces[0];
+}
+
+const float *SWMesh::normalBufferData() const
+{
+    if(m_a3FNormals.size() == 0)
+    {
+        return NULL;
+    }
+
+    return &m_a3FNormals[0];
+}
+
+const float *SWMesh::textureBufferData() const
+{
+    if(m_a2FTextures.size() == 0)
+    {
+        return NULL;
+    }
+
+    return &m_a2FTextures[0];
+}
+
 uint SWMesh::edgesNumber() const
 {
     return m_ui32EdgesNumber;
@@ -686,6 +1191,11 @@ swCloud::SWCloud *SWMesh::cloud()
     return &m_oCloud;
 }
 
+const swCloud::SWCloud *SWMesh::cloud() const
+{
+    return &m_oCloud;
+}
+
 void SWMesh::updateNonOrientedTrianglesNormals()
 {
     m_a3FNonOrientedTrianglesNormals.clear();
@@ -699,6 +1209,8 @@ void SWMesh::updateNonOrientedTrianglesNormals()
         swUtil::normalize(l_vNormal);
         m_a3FNonOrientedTrianglesNormals.push_back(l_vNormal);        
     }
+
+    m_ui32DirtyStreams |= SWM_NORMALS;
 }
 
 void SWMesh::updateNonOrientedVerticesNormals()
@@ -753,6 +1265,8 @@ void SWMesh::updateNonOrientedVerticesNormals()
                 m_a3FNormals.push_back(m_a3FNonOrientedVerticesNormals[ii][jj]);
             }
         }
+
+        m_ui32DirtyStreams |= SWM_NORMALS;
     }       
     else
     {
@@ -760,6 +1274,145 @@ void SWMesh::updateNonOrientedVerticesNormals()
     }
 }
 
+bool SWMesh::computeNonOrientedVertexNormal(cuint ui32IdVertex)
+{
+    vector<float> &l_v3FNormal = m_a3FNonOrientedVerticesNormals[ui32IdVertex];
+    l_v3FNormal.assign(3, 0.f);
+
+    // same accumulation than updateNonOrientedVerticesNormals : triangles by increasing id, the first vertex of a triangle never inverts
+    const vector<uint> &l_vTriangles = m_vVertexIdTriangle[ui32IdVertex];
+    for(uint ii = 0; ii < l_vTriangles.size(); ++ii)
+    {
+        if(ii > 0 && l_vTriangles[ii] == l_vTriangles[ii-1])
+        {
+            continue; // degenerate triangle, already added for each of its occurrences
+        }
+
+        for(uint jj = 0; jj < 3; ++jj)
+        {
+            if(m_aIdTriangles[l_vTriangles[ii]][jj] != ui32IdVertex)
+            {
+                continue;
+            }
+
+            vector<float> l_v3FCurrNormal = m_a3FNonOrientedTrianglesNormals[l_vTriangles[ii]];
+
+            if(jj >= 1)
+            {
+                if(swUtil::dotProduct(l_v3FCurrNormal, l_v3FNormal) < 0)
+                {
+                    swUtil::inverse(l_v3FCurrNormal);
+                }
+            }
+            swUtil::add(l_v3FNormal, l_v3FCurrNormal);
+        }
+    }
+
+    if(swUtil::norm(l_v3FNormal) <= 0.0)
+    {
+        return false;
+    }
+
+    swUtil::normalize(l_v3FNormal);
+    return true;
+}
+
+void SWMesh::updateNonOrientedNormals(const std::vector<uint> &vModifiedVertices)
+{
+    if(m_a3FNonOrientedTrianglesNormals.size() != trianglesNumber() || m_a3FNonOrientedVerticesNormals.size() != pointsNumber() ||
+       m_vVertexIdTriangle.size() < pointsNumber())
+    {
+        // no cached normals to update
+        updateNonOrientedTrianglesNormals();
+        updateNonOrientedVerticesNormals();
+        return;
+    }
+
+    // triangles using a modified vertex
+        vector<bool> l_vTriangleToUpdate(trianglesNumber(), false);
+        vector<uint> l_vTriangles;
+        for(uint ii = 0; ii < vModifiedVertices.size(); ++ii)
+        {
+            const vector<uint> &l_vVertexTriangles = m_vVertexIdTriangle[vModifiedVertices[ii]];
+            for(uint jj = 0; jj < l_vVertexTriangles.size(); ++jj)
+            {
+                if(!l_vTriangleToUpdate[l_vVertexTriangles[jj]])
+                {
+                    l_vTriangleToUpdate[l_vVertexTriangles[jj]] = true;
+                    l_vTriangles.push_back(l_vVertexTriangles[jj]);
+                }
+            }
+        }
+
+    // update their normals and retrieve the one-ring vertices
+        vector<bool> l_vVertexToUpdate(pointsNumber(), false);
+        vector<uint> l_vVertices;
+        for(uint ii = 0; ii < l_vTriangles.size(); ++ii)
+        {
+            vector<float> l_vP1, l_vP2, l_vP3;
+            trianglePoints(l_vP1, l_vP2, l_vP3, l_vTriangles[ii]);
+
+            vector<float> l_vNormal = swUtil::crossProduct(swUtil::vec(l_vP1, l_vP2), swUtil::vec(l_vP3, l_vP1));
+            swUtil::normalize(l_vNormal);
+            m_a3FNonOrientedTrianglesNormals[l_vTriangles[ii]] = l_vNormal;
+
+            for(uint jj = 0; jj < 3; ++jj)
+            {
+                cuint l_ui32IdVertex = m_aIdTriangles[l_vTriangles[ii]][jj];
+                if(!l_vVertexToUpdate[l_ui32IdVertex])
+                {
+                    l_vVertexToUpdate[l_ui32IdVertex] = true;
+                    l_vVertices.push_back(l_ui32IdVertex);
+                }
+            }
+        }
+
+    // the modified vertices without triangles are oriented toward the mean point
+        for(uint ii = 0; ii < vModifiedVertices.size(); ++ii)
+        {
+            if(!l_vVertexToUpdate[vModifiedVertices[ii]])
+            {
+                l_vVertexToUpdate[vModifiedVertices[ii]] = true;
+                l_vVertices.push_back(vModifiedVertices[ii]);
+            }
+        }
+
+    // update the vertices normals
+        std::vector<float> l_v3FMeanPoint;
+        bool l_bSameSize = (m_a3FNormals.size() == 3 * pointsNumber());
+        for(uint ii = 0; ii < l_vVertices.size(); ++ii)
+        {
+            cuint l_ui32IdVertex = l_vVertices[ii];
+
+            if(!computeNonOrientedVertexNormal(l_ui32IdVertex))
+            {
+                if(l_v3FMeanPoint.size() == 0)
+                {
+                    l_v3FMeanPoint = m_oCloud.meanPoint();
+                }
+
+                vector<float> currPoint;
+                point(currPoint, l_ui32IdVertex);
+                swUtil::add(m_a3FNonOrientedVerticesNormals[l_ui32IdVertex], swUtil::vec(currPoint, l_v3FMeanPoint));
+                swUtil::normalize(m_a3FNonOrientedVerticesNormals[l_ui32IdVertex]);
+            }
+
+            if(l_bSameSize)
+            {
+                m_a3FNormals[l_ui32IdVertex*3]   = m_a3FNonOrientedVerticesNormals[l_ui32IdVertex][0];
+                m_a3FNormals[l_ui32IdVertex*3+1] = m_a3FNonOrientedVerticesNormals[l_ui32IdVertex][1];
+                m_a3FNormals[l_ui32IdVertex*3+2] = m_a3FNonOrientedVerticesNormals[l_ui32IdVertex][2];
+            }
+        }
+
+    if(!l_bSameSize)
+    {
+        updateNonOrientedVerticesNormals();
+    }
+
+    m_ui32DirtyStreams |= SWM_VERTICES | SWM_NORMALS;
+}
+
 void SWMesh::buildEdgeVertexGraph()
 {
     m_a2VertexLinks.clear();
@@ -35,6 +35,8 @@
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <cmath>
 
 // UTILITY
 #include <time.h>
@@ -51,6 +53,22 @@
 
 using namespace swMesh;
 
+static SWOSNRICPLevelStats levelStats(cint i32Level, cuint ui32VerticesNb)
+{
+    SWOSNRICPLevelStats l_oStats;
+    l_oStats.m_i32Level         = i32Level;
+    l_oStats.m_ui32VerticesNb   = ui32VerticesNb;
+    l_oStats.m_i32AlphaStepsNb  = 0;
+    l_oStats.m_i32IterationsNb  = 0;
+    l_oStats.m_fFirstAlpha      = 0.f;
+    l_oStats.m_fLastAlpha       = 0.f;
+    l_oStats.m_fLastDiff        = 0.f;
+    l_oStats.m_fResidual        = 0.f;
+    l_oStats.m_dTime            = 0.0;
+
+    return l_oStats;
+}
+
 SWOptimalStepNonRigidICP::SWOptimalStepNonRigidICP(const SWMesh &oSource, const SWMesh &oTarget,
                                                    const std::string &sPathSourceStasmCorr, const std::string &sPathTargetStasmCorr):
                                                    m_oSourceMesh(oSource), m_oTargetMesh(oTarget), m_oOriginalTargetMesh(oTarget),
@@ -93,6 +111,7 @@ SWOptimalStepNonRigidICP::SWOptimalStepNonRigidICP(const SWMesh &oSource, const
         m_fAngleMax = 50.f;
         m_fLastComputedCost = -1.f;
         m_fWeightVectorDistMax = 0.08f;
+        m_i32CurrentLevel = 0;
 
     // read stasm correspondance files
         updateLandmarksWithSTASM();
@@ -104,6 +123,9 @@ SWOptimalStepNonRigidICP::SWOptimalStepNonRigidICP(const SWMesh &oSource, const
     // update vertices normals
         m_oTargetMesh.updateNonOrientedVerticesNormals();
         m_oSourceMesh.updateNonOrientedVerticesNormals();
+
+    // keep the target normals with the original geometry, they are only rotated when the target is moved
+        m_oOriginalTargetMesh.copyGeometry(m_oTargetMesh);
 }
 
 
@@ -364,8 +386,9 @@ float SWOptimalStepNonRigidICP::computeDiff(cv::Mat &newX)
 float SWOptimalStepNonRigidICP::resolve(cfloat fAlpha, cfloat fBeta, cfloat fGama, cbool bUseLandMarks)
 {
     clock_t m_oProgramTime;
+    clock_t l_oResolveTime = clock();
 
-    cv::Mat MG_A, WD, B, TAA, TAB, TAAInv, newX;
+    cv::Mat MG_A, WD, B, TAA, TAB, newX;
 
     // #### MG
     m_oProgramTime = clock();
@@ -408,17 +431,14 @@ float SWOptimalStepNonRigidICP::resolve(cfloat fAlpha, cfloat fBeta, cfloat fGam
 //    cout << " TAA " << (float)(clock() - m_oProgramTime) / CLOCKS_PER_SEC  << std::endl;
     MG_A.release();
 
-    // #### TAAInv
+    // #### newX : TAA * newX = TAB, TAA is symmetric positive definite, no need to compute its inverse
     m_oProgramTime = clock();
-    swUtil::swCuda::matrixInversion(TAA, TAAInv);
-//    cout << " TAAInv " << (float)(clock() - m_oProgramTime) / CLOCKS_PER_SEC  << std::endl;
-    TAA.release();
-
-//    // #### newX
-    m_oProgramTime = clock();
-    swUtil::swCuda::matrixMultiplication(TAAInv, TAB, newX);
+    if(!swUtil::swCuda::solve(TAA, TAB, newX, true))
+    {
+        swUtil::swCuda::solve(TAA, TAB, newX);
+    }
 //    cout << " newX " << (float)(clock() - m_oProgramTime) / CLOCKS_PER_SEC  << std::endl;
-    TAAInv.release();
+    TAA.release();
     TAB.release();
 
     m_oProgramTime = clock();
@@ -452,6 +472,11 @@ float SWOptimalStepNonRigidICP::resolve(cfloat fAlpha, cfloat fBeta, cfloat fGam
 
             cv::Mat l_oTr(X(ii));
 
+            if(m_i32CurrentLevel > 0)
+            {
+                accumulateTransform(ii, l_oTr, l_fCoeffReduc);
+            }
+
             float l_fNewX =     l_oTr.at<float>(0,0) * l_vPt[0] +
                                 l_oTr.at<float>(1,0) * l_vPt[1] +
                                 l_oTr.at<float>(2,0) * l_vPt[2] +
@@ -482,9 +507,349 @@ float SWOptimalStepNonRigidICP::resolve(cfloat fAlpha, cfloat fBeta, cfloat fGam
 //        std::cout << "TAAInv : " << TAAInv.rows << " " << TAAInv.cols << std::endl;
 //        std::cout << "newX : " << newX.rows << " " << newX.cols << std::endl;
 
+    // update the report of the current level
+        if(m_vLevelsStats.empty())
+        {
+            m_vLevelsStats.push_back(levelStats(m_i32CurrentLevel, m_oSourceMesh.pointsNumber()));
+        }
+
+        SWOSNRICPLevelStats &l_oStats = m_vLevelsStats.back();
+        if(l_oStats.m_i32IterationsNb == 0)
+        {
+            l_oStats.m_fFirstAlpha = fAlpha;
+        }
+        if(l_oStats.m_i32IterationsNb == 0 || l_oStats.m_fLastAlpha != fAlpha)
+        {
+            ++l_oStats.m_i32AlphaStepsNb;
+        }
+
+        ++l_oStats.m_i32IterationsNb;
+        l_oStats.m_fLastAlpha = fAlpha;
+        l_oStats.m_fLastDiff  = l_fDiff;
+        l_oStats.m_fResidual  = residual();
+        l_oStats.m_dTime     += static_cast<double>(clock() - l_oResolveTime) / CLOCKS_PER_SEC;
+
     return l_fDiff;
 }
 
+float SWOptimalStepNonRigidICP::residual() const
+{
+    double l_dSquareDistSum = 0.0;
+    uint l_ui32PointsNb = 0;
+
+    for(uint ii = 0; ii < m_oSourceMesh.pointsNumber(); ++ii)
+    {
+        if(m_w[ii] == 0.f)
+        {
+            continue;
+        }
+
+        float l_aFSourcePt[3], l_aFTargetPt[3];
+        m_oSourceMesh.point(l_aFSourcePt, ii);
+        m_oTargetMesh.point(l_aFTargetPt, m_u[ii]);
+
+        for(int jj = 0; jj < 3; ++jj)
+        {
+            l_dSquareDistSum += (l_aFSourcePt[jj] - l_aFTargetPt[jj]) * (l_aFSourcePt[jj] - l_aFTargetPt[jj]);
+        }
+        ++l_ui32PointsNb;
+    }
+
+    if(l_ui32PointsNb == 0)
+    {
+        return 0.f;
+    }
+
+    return static_cast<float>(sqrt(l_dSquareDistSum / l_ui32PointsNb));
+}
+
+int SWOptimalStepNonRigidICP::buildPyramid(cint i32LevelsNb, cfloat fReductionRatio)
+{
+    // back to the full resolution template if a previous pyramid is still used
+        if(m_i32CurrentLevel > 0)
+        {
+            prolongToLevel(0);
+        }
+
+        m_vPyramidMeshes.clear();
+        m_vFineToCoarse.clear();
+        m_vPyramidLandmarks.clear();
+        m_vLevelsStats.clear();
+
+    // the current template is the full resolution level
+        m_vPyramidMeshes.push_back(m_oSourceMesh);
+        m_vPyramidLandmarks.push_back(m_l);
+
+    // decimate until the levels number is reached or the template can't be reduced anymore
+        for(int ii = 1; ii < i32LevelsNb; ++ii)
+        {
+            SWMesh l_oCoarseMesh;
+            std::vector<uint> l_vFineToCoarse;
+            decimateTemplate(m_vPyramidMeshes.back(), fReductionRatio, m_vPyramidLandmarks.back(), l_oCoarseMesh, l_vFineToCoarse);
+
+            if(l_oCoarseMesh.pointsNumber() < 50 || l_oCoarseMesh.pointsNumber() > 0.9f * m_vPyramidMeshes.back().pointsNumber())
+            {
+                break;
+            }
+
+            // landmarks vertices are pinned by the decimation, they only change of id
+            std::map<uint,uint> l_mCoarseLandmarks;
+            const std::map<uint,uint> &l_mFineLandmarks = m_vPyramidLandmarks.back();
+            for(std::map<uint,uint>::const_iterator it = l_mFineLandmarks.begin(); it != l_mFineLandmarks.end(); ++it)
+            {
+                l_mCoarseLandmarks.insert(std::make_pair(l_vFineToCoarse[it->first], it->second));
+            }
+
+            m_vPyramidMeshes.push_back(l_oCoarseMesh);
+            m_vFineToCoarse.push_back(l_vFineToCoarse);
+            m_vPyramidLandmarks.push_back(l_mCoarseLandmarks);
+        }
+
+        m_i32CurrentLevel = static_cast<int>(m_vPyramidMeshes.size()) - 1;
+
+    if(m_i32CurrentLevel > 0)
+    {
+        // start on the coarsest template, with identity transforms
+            m_oSourceMesh = m_vPyramidMeshes[m_i32CurrentLevel];
+            m_l           = m_vPyramidLandmarks[m_i32CurrentLevel];
+            resizeVerticesArrays();
+
+            m_oAccumulatedX = cv::Mat(4 * m_oSourceMesh.pointsNumber(), 3, CV_32FC1, cv::Scalar(0.f));
+            for(uint ii = 0; ii < m_oSourceMesh.pointsNumber(); ++ii)
+            {
+                m_oAccumulatedX.at<float>(4*ii,  0) = 1.f;
+                m_oAccumulatedX.at<float>(4*ii+1,1) = 1.f;
+                m_oAccumulatedX.at<float>(4*ii+2,2) = 1.f;
+            }
+
+            computeCorrespondences();
+    }
+    else
+    {
+        m_vPyramidMeshes.clear();
+        m_vPyramidLandmarks.clear();
+    }
+
+    m_vLevelsStats.push_back(levelStats(m_i32CurrentLevel, m_oSourceMesh.pointsNumber()));
+
+    return m_i32CurrentLevel + 1;
+}
+
+bool SWOptimalStepNonRigidICP::prolongToLevel(cint i32Level)
+{
+    if(i32Level < 0 || i32Level >= m_i32CurrentLevel)
+    {
+        return false;
+    }
+
+    while(m_i32CurrentLevel > i32Level)
+    {
+        cint l_i32FineLevel = m_i32CurrentLevel - 1;
+        const SWMesh &l_oFineMesh = m_vPyramidMeshes[l_i32FineLevel];
+        const std::vector<uint> &l_vFineToCoarse = m_vFineToCoarse[l_i32FineLevel];
+        cuint l_ui32FinePointsNb = l_oFineMesh.pointsNumber();
+
+        // each fine vertex starts with the transforms and the correspondence of its coarse vertex
+            cv::Mat l_oFineAccumulatedX(4 * l_ui32FinePointsNb, 3, CV_32FC1), l_oFineX(l_oFineAccumulatedX.size(), CV_32FC1), l_oFinePX(l_oFineAccumulatedX.size(), CV_32FC1);
+            std::vector<uint>  l_vFineU(l_ui32FinePointsNb);
+            std::vector<float> l_vFineW(l_ui32FinePointsNb);
+
+            for(uint ii = 0; ii < l_ui32FinePointsNb; ++ii)
+            {
+                cuint l_ui32Coarse = l_vFineToCoarse[ii];
+
+                m_oAccumulatedX.rowRange(4*l_ui32Coarse, 4*l_ui32Coarse + 4).copyTo(l_oFineAccumulatedX.rowRange(4*ii, 4*ii + 4));
+                m_X->rowRange(4*l_ui32Coarse, 4*l_ui32Coarse + 4).copyTo(l_oFineX.rowRange(4*ii, 4*ii + 4));
+                m_pX->rowRange(4*l_ui32Coarse, 4*l_ui32Coarse + 4).copyTo(l_oFinePX.rowRange(4*ii, 4*ii + 4));
+                l_vFineU[ii] = m_u[l_ui32Coarse];
+                l_vFineW[ii] = m_w[l_ui32Coarse];
+            }
+
+        // deform the undeformed fine template with the prolonged transforms
+            m_oSourceMesh = l_oFineMesh;
+            swCloud::SWCloud *l_pSourceCloud = m_oSourceMesh.cloud();
+
+            for(uint ii = 0; ii < l_ui32FinePointsNb; ++ii)
+            {
+                float l_aFPt[3];
+                l_oFineMesh.point(l_aFPt, ii);
+
+                for(int jj = 0; jj < 3; ++jj)
+                {
+                    l_pSourceCloud->coord(jj)[ii] = l_aFPt[0] * l_oFineAccumulatedX.at<float>(4*ii,  jj) +
+                                                    l_aFPt[1] * l_oFineAccumulatedX.at<float>(4*ii+1,jj) +
+                                                    l_aFPt[2] * l_oFineAccumulatedX.at<float>(4*ii+2,jj) +
+                                                                l_oFineAccumulatedX.at<float>(4*ii+3,jj);
+                }
+            }
+
+            updateSourceMeshNormals();
+
+        // the fine level becomes the current one
+            m_oAccumulatedX = l_oFineAccumulatedX;
+            *m_X  = l_oFineX;
+            *m_pX = l_oFinePX;
+            m_u   = l_vFineU;
+            m_w   = l_vFineW;
+            m_w1.assign(l_ui32FinePointsNb, 1.f);
+            m_w2.assign(l_ui32FinePointsNb, 1.f);
+            m_w3.assign(l_ui32FinePointsNb, 1.f);
+            m_l = m_vPyramidLandmarks[l_i32FineLevel];
+
+            m_i32CurrentLevel = l_i32FineLevel;
+            m_vLevelsStats.push_back(levelStats(m_i32CurrentLevel, l_ui32FinePointsNb));
+    }
+
+    // the pyramid is not needed anymore once the full resolution is reached
+        if(m_i32CurrentLevel == 0)
+        {
+            m_vPyramidMeshes.clear();
+            m_vFineToCoarse.clear();
+            m_vPyramidLandmarks.clear();
+            m_oAccumulatedX.release();
+        }
+
+    return true;
+}
+
+int SWOptimalStepNonRigidICP::levelForAlpha(cfloat fAlpha, cfloat fStartAlpha, cfloat fMinAlpha) const
+{
+    cint l_i32LevelsNb = levelsNumber();
+
+    if(l_i32LevelsNb < 2 || fAlpha <= fMinAlpha || fStartAlpha <= fMinAlpha)
+    {
+        return 0;
+    }
+
+    // position of alpha between the min and the start alpha, on the log scale of the alpha steps if possible
+        float l_fPosition;
+        if(fMinAlpha > 0.f)
+        {
+            l_fPosition = log(fAlpha / fMinAlpha) / log(fStartAlpha / fMinAlpha);
+        }
+        else
+        {
+            l_fPosition = fAlpha / fStartAlpha;
+        }
+
+    int l_i32Level = static_cast<int>(l_fPosition * l_i32LevelsNb);
+
+    if(l_i32Level < 0)
+    {
+        return 0;
+    }
+    if(l_i32Level >= l_i32LevelsNb)
+    {
+        return l_i32LevelsNb - 1;
+    }
+
+    return l_i32Level;
+}
+
+int SWOptimalStepNonRigidICP::levelsNumber() const
+{
+    if(m_vPyramidMeshes.size() == 0)
+    {
+        return 1;
+    }
+
+    return static_cast<int>(m_vPyramidMeshes.size());
+}
+
+int SWOptimalStepNonRigidICP::currentLevel() const
+{
+    return m_i32CurrentLevel;
+}
+
+const std::vector<SWOSNRICPLevelStats> &SWOptimalStepNonRigidICP::levelsStats() const
+{
+    return m_vLevelsStats;
+}
+
+void SWOptimalStepNonRigidICP::displayLevelsStats() const
+{
+    for(uint ii = 0; ii < m_vLevelsStats.size(); ++ii)
+    {
+        const SWOSNRICPLevelStats &l_oStats = m_vLevelsStats[ii];
+
+        std::cout << "level " << l_oStats.m_i32Level << " : " << l_oStats.m_ui32VerticesNb << " vertices, "
+                  << l_oStats.m_i32AlphaStepsNb << " alpha steps (" << l_oStats.m_fFirstAlpha << " -> " << l_oStats.m_fLastAlpha << "), "
+                  << l_oStats.m_i32IterationsNb << " iterations, last diff " << l_oStats.m_fLastDiff
+                  << ", residual " << l_oStats.m_fResidual << ", time " << l_oStats.m_dTime << " s" << std::endl;
+    }
+}
+
+void SWOptimalStepNonRigidICP::resizeVerticesArrays()
+{
+    cuint l_ui32PointsNb = m_oSourceMesh.pointsNumber();
+
+    *m_X  = cv::Mat(4 * l_ui32PointsNb, 3, CV_32FC1, cv::Scalar(0.f));
+    *m_pX = cv::Mat(4 * l_ui32PointsNb, 3, CV_32FC1, cv::Scalar(0.f));
+
+    m_w.assign(l_ui32PointsNb, 1.f);
+    m_w1.assign(l_ui32PointsNb, 1.f);
+    m_w2.assign(l_ui32PointsNb, 1.f);
+    m_w3.assign(l_ui32PointsNb, 1.f);
+    m_u.assign(l_ui32PointsNb, 0);
+}
+
+void SWOptimalStepNonRigidICP::accumulateTransform(cuint ui32Vertex, const cv::Mat &oTr, cfloat fCoeff)
+{
+    // transform applied to the source cloud (points as row vectors) : p' = (1 - c) p + c (p L + t) = p ((1 - c) I + c L) + c t
+        float l_aFApplied[4][3];
+        for(int ii = 0; ii < 4; ++ii)
+        {
+            for(int jj = 0; jj < 3; ++jj)
+            {
+                l_aFApplied[ii][jj] = fCoeff * oTr.at<float>(ii,jj) + ((ii == jj) ? 1.f - fCoeff : 0.f);
+            }
+        }
+
+    // accumulated = accumulated * applied, the translation row of applied is added to the translation row
+        float l_aFAccumulated[4][3];
+        for(int ii = 0; ii < 4; ++ii)
+        {
+            for(int jj = 0; jj < 3; ++jj)
+            {
+                l_aFAccumulated[ii][jj] = m_oAccumulatedX.at<float>(4*ui32Vertex + ii, jj);
+            }
+        }
+
+        for(int ii = 0; ii < 4; ++ii)
+        {
+            for(int jj = 0; jj < 3; ++jj)
+            {
+                float l_fValue = (ii == 3) ? l_aFApplied[3][jj] : 0.f;
+
+                for(int kk = 0; kk < 3; ++kk)
+                {
+                    l_fValue += l_aFAccumulated[ii][kk] * l_aFApplied[kk][jj];
+                }
+
+                m_oAccumulatedX.at<float>(4*ui32Vertex + ii, jj) = l_fValue;
+            }
+        }
+}
+
+void SWOptimalStepNonRigidICP::decimateTemplate(const SWMesh &oMesh, cfloat fReductionRatio, const std::map<uint,uint> &mLandmarks,
+                                                SWMesh &oCoarseMesh, std::vector<uint> &vFineToCoarse)
+{
+    if(oMesh.pointsNumber() == 0 || fReductionRatio <= 0.f)
+    {
+        vFineToCoarse.assign(oMesh.pointsNumber(), 0);
+        return;
+    }
+
+    // the landmarks vertices are pinned, they are kept at the same position in all the levels
+        std::vector<uint> l_vPinnedVertices;
+        for(std::map<uint,uint>::const_iterator it = mLandmarks.begin(); it != mLandmarks.end(); ++it)
+        {
+            l_vPinnedVertices.push_back(it->first);
+        }
+
+    oMesh.decimate(oCoarseMesh, vFineToCoarse, static_cast<uint>(fReductionRatio * oMesh.trianglesNumber()), FLT_MAX, l_vPinnedVertices);
+}
+
 
 //void SWOptimalStepNonRigidICP::updateSourceMeshWithMorphModification()
 //{
@@ -0,0 +1,97 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file benchmarkUtility.h
+ * \brief Helpers shared by the benchmark examples : tick timing and a synthetic face mesh.
+ */
+
+#ifndef _SWBENCHMARKUTILITY_
+#define _SWBENCHMARKUTILITY_
+
+#include <vector>
+#include <cmath>
+
+#include "opencv2/core/core.hpp"
+
+#include "mesh/SWMesh.h"
+
+/**
+ * \brief Return the elapsed wall time in ms since i64Start (obtained with cv::getTickCount).
+ */
+inline double elapsedMs(const int64 i64Start)
+{
+    return 1000.0 * static_cast<double>(cv::getTickCount() - i64Start) / cv::getTickFrequency();
+}
+
+/**
+ * \brief Build a face-like height field : an ellipsoid cap sampled on a regular grid, with an optional nose bump.
+ * \param [in]  ui32GridSize : number of vertices on each side of the grid
+ * \param [out] oMesh        : built mesh, with texture coordinates
+ * \param [in]  fNoseHeight  : height of the nose bump, 0 for a plain cap
+ */
+inline void buildFaceMesh(cuint ui32GridSize, swMesh::SWMesh &oMesh, cfloat fNoseHeight = 0.f)
+{
+    std::vector<std::vector<float> > l_vPoints, l_vTextures;
+    std::vector<std::vector<uint> > l_vFaces;
+
+    for(uint ii = 0; ii < ui32GridSize; ++ii)
+    {
+        for(uint jj = 0; jj < ui32GridSize; ++jj)
+        {
+            float l_fX = -0.08f + 0.16f * ii / (ui32GridSize - 1);
+            float l_fY = -0.10f + 0.20f * jj / (ui32GridSize - 1);
+            float l_fCap = 1.f - (l_fX * l_fX) / (0.1f * 0.1f) - (l_fY * l_fY) / (0.13f * 0.13f);
+
+            float l_fZ = 0.05f * sqrt(l_fCap > 0.f ? l_fCap : 0.f) + fNoseHeight * exp(-(l_fX * l_fX + l_fY * l_fY) / (2.f * 0.012f * 0.012f));
+
+            std::vector<float> l_vPoint(3), l_vTexture(2);
+            l_vPoint[0] = l_fX; l_vPoint[1] = l_fY; l_vPoint[2] = l_fZ;
+            l_vTexture[0] = static_cast<float>(ii) / (ui32GridSize - 1);
+            l_vTexture[1] = static_cast<float>(jj) / (ui32GridSize - 1);
+            l_vPoints.push_back(l_vPoint);
+            l_vTextures.push_back(l_vTexture);
+        }
+    }
+
+    // faces ids start at 1 for SWMesh::set
+    for(uint ii = 0; ii < ui32GridSize - 1; ++ii)
+    {
+        for(uint jj = 0; jj < ui32GridSize - 1; ++jj)
+        {
+            uint l_ui32Id = ii * ui32GridSize + jj + 1;
+
+            std::vector<uint> l_vFace1(3), l_vFace2(3);
+            l_vFace1[0] = l_ui32Id; l_vFace1[1] = l_ui32Id + ui32GridSize;     l_vFace1[2] = l_ui32Id + 1;
+            l_vFace2[0] = l_ui32Id + 1; l_vFace2[1] = l_ui32Id + ui32GridSize; l_vFace2[2] = l_ui32Id + ui32GridSize + 1;
+            l_vFaces.push_back(l_vFace1);
+            l_vFaces.push_back(l_vFace2);
+        }
+    }
+
+    oMesh.set(l_vPoints, l_vFaces, l_vTextures);
+}
+
+#endif
@@ -0,0 +1,104 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file benchmark_decimation_main.cpp
+ * \brief Measure the time and the quality of the quadric error metric decimation of SWMesh (SWMesh::decimate)
+ *        on an obj mesh or on synthetic face-like meshes, the time is normalized by n log n to check the complexity.
+ *
+ *  Usage : benchmark_decimation [obj file] [ratio], default ratio : 0.25
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <cmath>
+
+#include "opencv2/core/core.hpp"
+
+#include "mesh/SWMesh.h"
+
+#include "benchmarkUtility.h"
+
+static void benchmark(const swMesh::SWMesh &oMesh, cfloat fRatio, const std::string &sName)
+{
+    swMesh::SWMesh l_oDecimatedMesh;
+    std::vector<uint> l_vOldToNew;
+    cuint l_ui32TrianglesNb = oMesh.trianglesNumber();
+
+    int64 l_i64Start = cv::getTickCount();
+    uint l_ui32DecimatedTrianglesNb = oMesh.decimate(l_oDecimatedMesh, l_vOldToNew, static_cast<uint>(fRatio * l_ui32TrianglesNb));
+    double l_dTime = elapsedMs(l_i64Start);
+
+    // distance between each original vertex and the vertex it has been collapsed onto
+        double l_dMeanError = 0.0, l_dMaxError = 0.0;
+        for(uint ii = 0; ii < oMesh.pointsNumber(); ++ii)
+        {
+            float l_aFPt[3], l_aFKeptPt[3];
+            oMesh.point(l_aFPt, ii);
+            l_oDecimatedMesh.point(l_aFKeptPt, l_vOldToNew[ii]);
+
+            double l_dDist = sqrt(static_cast<double>((l_aFPt[0] - l_aFKeptPt[0]) * (l_aFPt[0] - l_aFKeptPt[0]) +
+                                                      (l_aFPt[1] - l_aFKeptPt[1]) * (l_aFPt[1] - l_aFKeptPt[1]) +
+                                                      (l_aFPt[2] - l_aFKeptPt[2]) * (l_aFPt[2] - l_aFKeptPt[2])));
+            l_dMeanError += l_dDist;
+            l_dMaxError   = l_dDist > l_dMaxError ? l_dDist : l_dMaxError;
+        }
+        l_dMeanError /= oMesh.pointsNumber();
+
+    std::cout << sName << " | triangles : " << l_ui32TrianglesNb << " -> " << l_ui32DecimatedTrianglesNb
+              << " | time : " << l_dTime << " ms"
+              << " | time / (n log n) : " << 1e6 * l_dTime / (l_ui32TrianglesNb * log(static_cast<double>(l_ui32TrianglesNb))) << " ns"
+              << " | vertex displacement mean : " << l_dMeanError << " max : " << l_dMaxError << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    float l_fRatio = 0.25f;
+
+    if(argc > 2)
+    {
+        l_fRatio = static_cast<float>(atof(argv[2]));
+    }
+
+    if(argc > 1)
+    {
+        swMesh::SWMesh l_oMesh(argv[1]);
+        benchmark(l_oMesh, l_fRatio, argv[1]);
+        return 0;
+    }
+
+    // grids of about 20k, 50k, 100k and 200k triangles
+    cuint l_aUI32GridSizes[4] = {101, 159, 225, 317};
+
+    for(uint ii = 0; ii < 4; ++ii)
+    {
+        swMesh::SWMesh l_oMesh;
+        buildFaceMesh(l_aUI32GridSizes[ii], l_oMesh, 0.025f);
+        benchmark(l_oMesh, l_fRatio, "face grid");
+    }
+
+    return 0;
+}
@@ -0,0 +1,336 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+/**
+ * \file benchmark_gl_render_main.cpp
+ * \brief Render an animated mesh and a static cloud in an offscreen pixel buffer with the SWGLRenderer classes used by the
+ *        SWGLWidget family, once for each mesh display mode (original color, texture, unique color), and report the per frame cpu time of :
+ *          - the buffers preparation (animation retrieval, positions / normals upload, the static cloud is uploaded once),
+ *          - the draw submission (uniforms and draw calls),
+ *          - the gpu completion (glFinish).
+ *        No window is needed : it can be run headless with a software opengl implementation
+ *        (ex : LIBGL_ALWAYS_SOFTWARE=1 with Mesa llvmpipe under Xvfb).
+ *
+ *  Usage : benchmark_gl_render [frames number] [mesh obj] [cloud obj] [mod file] [seq file] [correspondence obj] [texture image]
+ *          default frames number : 300, without files a synthetic face grid (about 100k vertices), its cloud,
+ *          synthetic animation offsets and a checkerboard texture are used. The shaders are loaded from ../data/shaders/ like in swooz-viewer.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "opencv2/core/core.hpp"
+
+#include <QApplication>
+#include <QGLPixelBuffer>
+#include <QGLShaderProgram>
+#include <QImage>
+
+#include "interface/SWGLRenderer.h"
+#include "animation/SWAnimation.h"
+
+#include "benchmarkUtility.h"
+
+/**
+ * \brief Mean and max of a per frame time.
+ */
+struct SWFrameTime
+{
+    SWFrameTime() : m_dTotal(0.0), m_dMax(0.0){}
+
+    void add(const double dTime)
+    {
+        m_dTotal += dTime;
+        m_dMax = std::max(m_dMax, dTime);
+    }
+
+    double m_dTotal;
+    double m_dMax;
+};
+
+/**
+ * \brief Load a vertex and a fragment shader and link them.
+ */
+static bool loadShaders(const QString &sName, QGLShaderProgram &oShader)
+{
+    if(!oShader.addShaderFromSourceFile(QGLShader::Vertex, "../data/shaders/" + sName + ".vert") ||
+       !oShader.addShaderFromSourceFile(QGLShader::Fragment, "../data/shaders/" + sName + ".frag") || !oShader.link())
+    {
+        std::cerr << "Can't load the shader " << sName.toStdString() << " : " << oShader.log().toStdString() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * \brief Build a checkerboard texture image.
+ */
+static QImage buildCheckerboardTexture(cint i32Size, cint i32SquareSize)
+{
+    QImage l_oTexture(i32Size, i32Size, QImage::Format_RGB32);
+
+    for(int ii = 0; ii < i32Size; ++ii)
+    {
+        for(int jj = 0; jj < i32Size; ++jj)
+        {
+            bool l_bLight = ((ii / i32SquareSize) + (jj / i32SquareSize)) % 2 == 0;
+            l_oTexture.setPixel(jj, ii, l_bLight ? qRgb(230, 200, 180) : qRgb(120, 80, 60));
+        }
+    }
+
+    return l_oTexture;
+}
+
+/**
+ * \brief Scale in meters the objects saved in millimeters, like SWGLMultiObjectWidget does.
+ */
+static void scaleToMeters(swCloud::SWCloud &oCloud)
+{
+    if(oCloud.bBox().diagLength() > 100.f)
+    {
+        oCloud *= 0.001f;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    QApplication l_oApp(argc, argv);
+
+    uint l_ui32FramesNb = 300;
+
+    if(argc > 1)
+    {
+        l_ui32FramesNb = static_cast<uint>(std::max(1, atoi(argv[1])));
+    }
+
+    // offscreen opengl context
+        if(!QGLPixelBuffer::hasOpenGLPbuffers())
+        {
+            std::cerr << "Pixel buffers are not supported by the opengl implementation. " << std::endl;
+            return -1;
+        }
+
+        QGLPixelBuffer l_oPixelBuffer(QSize(640, 480));
+        if(!l_oPixelBuffer.makeCurrent())
+        {
+            std::cerr << "Can't make the pixel buffer context current. " << std::endl;
+            return -1;
+        }
+
+        std::cout << "opengl : " << reinterpret_cast<const char*>(glGetString(GL_RENDERER)) << " | "
+                  << reinterpret_cast<const char*>(glGetString(GL_VERSION)) << std::endl;
+
+        glViewport(0, 0, 640, 480);
+        glEnable(GL_DEPTH_TEST);
+        glClearColor(49/255.f, 53/255.f, 70/255.f, 1.f);
+
+    // shaders
+        QGLShaderProgram l_oShaderCloud, l_oShaderMesh;
+        if(!loadShaders("cloudViewer", l_oShaderCloud) || !loadShaders("meshViewer", l_oShaderMesh))
+        {
+            return -1;
+        }
+
+    // objects
+        swMesh::SWMesh l_oMesh;
+        if(argc > 2)
+        {
+            l_oMesh = swMesh::SWMesh(argv[2]);
+        }
+        else
+        {
+            buildFaceMesh(317, l_oMesh);
+        }
+
+        if(l_oMesh.pointsNumber() == 0)
+        {
+            std::cerr << "Empty mesh. " << std::endl;
+            return -1;
+        }
+        scaleToMeters(*l_oMesh.cloud());
+
+        swCloud::SWCloud l_oCloud;
+        if(argc > 3)
+        {
+            l_oCloud.loadObj(argv[3]);
+        }
+        else
+        {
+            l_oCloud.copy(*l_oMesh.cloud());
+        }
+        scaleToMeters(l_oCloud);
+
+    // animation
+        swAnimation::SWAnimation l_oAnimation;
+        bool l_bAnimationFiles = false;
+
+        if(argc > 6)
+        {
+            swAnimation::SWMod l_oMod;
+            swAnimation::SWSeq l_oSeq;
+            l_oMod.loadModFile(argv[4]);
+            l_oSeq.loadSeqFile(argv[5]);
+
+            l_oAnimation.setMod(l_oMod);
+            l_oAnimation.setSeq(l_oSeq);
+            l_oAnimation.setCloudCorr(argv[6]);
+            l_oAnimation.constructCorrId();
+            l_bAnimationFiles = true;
+        }
+
+        cint l_i32PointsNb = static_cast<int>(l_oMesh.pointsNumber());
+        QVector<float> l_vOffsetX(l_i32PointsNb, 0.f), l_vOffsetY(l_i32PointsNb, 0.f), l_vOffsetZ(l_i32PointsNb, 0.f), l_vRigidMotion(6, 0.f);
+        cint l_i32CenterId = std::min(352, l_i32PointsNb - 1);
+
+    // renderers
+        SWGLMeshRenderer l_oMeshRenderer;
+        SWGLCloudRenderer l_oCloudRenderer;
+        l_oMeshRenderer.initBuffers(true);
+        l_oCloudRenderer.initBuffers();
+        l_oMeshRenderer.updateBuffers(l_oMesh);
+        l_oCloudRenderer.updateBuffers(l_oCloud); // the cloud is static, it is uploaded only once
+
+    // texture
+        QImage l_oTextureImage;
+        if(argc > 7)
+        {
+            l_oTextureImage = QImage(argv[7]);
+        }
+        if(l_oTextureImage.isNull())
+        {
+            l_oTextureImage = buildCheckerboardTexture(1024, 64);
+        }
+        GLuint l_ui32Texture = l_oPixelBuffer.bindTexture(l_oTextureImage);
+
+    // camera
+        std::vector<float> l_v3FMeshMean = l_oMesh.cloud()->meanPoint(), l_v3FCloudMean = l_oCloud.meanPoint();
+        QVector3D l_oMeshCenter(l_v3FMeshMean[0], l_v3FMeshMean[1], l_v3FMeshMean[2]);
+        QVector3D l_oCloudCenter(l_v3FCloudMean[0], l_v3FCloudMean[1], l_v3FCloudMean[2]);
+
+        QMatrix4x4 l_oProjectionMatrix, l_oViewMatrix;
+        l_oProjectionMatrix.perspective(40.0, 640.0/480.0, 0.01, 10000.0);
+        l_oViewMatrix.lookAt(l_oMeshCenter + QVector3D(0.f, 0.f, l_oMesh.cloud()->bBox().diagLength()), l_oMeshCenter, QVector3D(0.f, 1.f, 0.f));
+        QMatrix4x4 l_oMVPMatrix = l_oProjectionMatrix * l_oViewMatrix;
+
+    const GLObjectDisplayMode l_aDisplayModes[3] = {GLO_ORIGINAL_COLOR, GLO_TEXTURE, GLO_UNI_COLOR};
+    const char *l_aDisplayModesNames[3] = {"original color", "texture", "unique color"};
+
+    std::cout << "mesh vertices : " << l_oMesh.pointsNumber() << " triangles : " << l_oMesh.trianglesNumber()
+              << (l_oMesh.textureBufferData() ? "" : " (no texture coordinates)")
+              << " | cloud points : " << l_oCloud.size() << " | frames : " << l_ui32FramesNb
+              << (l_bAnimationFiles ? " | mod/seq animation" : " | synthetic animation") << std::endl;
+
+    for(int mm = 0; mm < 3; ++mm)
+    {
+        SWFrameTime l_oPreparationTime, l_oSubmissionTime, l_oFinishTime;
+        int l_i32AnimationLine = 0;
+
+        for(uint ii = 0; ii < l_ui32FramesNb; ++ii)
+        {
+            // buffers preparation
+                int64 l_i64Start = cv::getTickCount();
+
+                bool l_bAnimation = false;
+                if(l_bAnimationFiles)
+                {
+                    if(!l_oAnimation.retrieveTransfosToApply(l_i32AnimationLine++, l_vOffsetX, l_vOffsetY, l_vOffsetZ, l_vRigidMotion))
+                    {
+                        l_i32AnimationLine = 0;
+                        l_oAnimation.retrieveTransfosToApply(l_i32AnimationLine++, l_vOffsetX, l_vOffsetY, l_vOffsetZ, l_vRigidMotion);
+                    }
+
+                    l_bAnimation = (l_vOffsetX.size() >= l_i32PointsNb);
+                }
+                else
+                {
+                    float l_fPhase = 0.2f * ii;
+                    for(int jj = 0; jj < l_i32PointsNb; ++jj)
+                    {
+                        l_vOffsetZ[jj] = 0.002f * sin(l_fPhase + 0.001f * jj);
+                    }
+                    l_vRigidMotion[4] = 0.1f * sin(l_fPhase);
+                    l_bAnimation = true;
+                }
+
+                if(l_bAnimation)
+                {
+                    l_oMeshRenderer.updateAnimatedVertexBuffer(l_oMesh, l_vOffsetX, l_vOffsetY, l_vOffsetZ, l_vRigidMotion, l_i32CenterId);
+                }
+                else
+                {
+                    l_oMeshRenderer.updateVertexBuffers(l_oMesh);
+                }
+
+                l_oPreparationTime.add(elapsedMs(l_i64Start));
+
+            // draw submission
+                l_i64Start = cv::getTickCount();
+
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+                l_oShaderCloud.bind();
+                    SWGLObjectRenderer::setTransformationUniforms(l_oShaderCloud, l_oCloudCenter, QVector3D(), QVector3D(0.1f, 0.f, 0.f), 1.f, l_oMVPMatrix);
+                    l_oShaderCloud.setUniformValue("displayMode", GLO_ORIGINAL_COLOR);
+                    l_oShaderCloud.setUniformValue("uniColor", 1.f, 0.f, 0.f);
+                    l_oCloudRenderer.draw(l_oShaderCloud);
+                l_oShaderCloud.release();
+
+                l_oShaderMesh.bind();
+                    SWGLObjectRenderer::setTransformationUniforms(l_oShaderMesh, l_oMeshCenter, QVector3D(), QVector3D(), 1.f, l_oMVPMatrix);
+                    l_oShaderMesh.setUniformValue("viewDirection", l_oMeshCenter);
+                    l_oShaderMesh.setUniformValue("displayMode", l_aDisplayModes[mm]);
+                    l_oShaderMesh.setUniformValue("uniColor", 1.f, 0.f, 0.f);
+                    l_oShaderMesh.setUniformValue("lSourcePos", l_oMeshCenter - QVector3D(0.f, 0.f, 1.f));
+                    l_oShaderMesh.setUniformValue("kAmbiant", 1.f);
+                    l_oShaderMesh.setUniformValue("kDiffus", 0.5f);
+                    l_oShaderMesh.setUniformValue("kSpecular", 1.f);
+                    l_oShaderMesh.setUniformValue("pSpecular", 10.f);
+                    l_oShaderMesh.setUniformValue("lAmbiant", QVector3D(0.3f, 0.3f, 0.3f));
+                    l_oShaderMesh.setUniformValue("lDiffus", QVector3D(1.f, 1.f, 1.f));
+                    l_oShaderMesh.setUniformValue("lSpecular", QVector3D(0.5f, 0.5f, 0.5f));
+                    l_oMeshRenderer.draw(l_oShaderMesh, l_aDisplayModes[mm], l_ui32Texture);
+                l_oShaderMesh.release();
+
+                l_oSubmissionTime.add(elapsedMs(l_i64Start));
+
+            // gpu completion
+                l_i64Start = cv::getTickCount();
+                glFinish();
+                l_oFinishTime.add(elapsedMs(l_i64Start));
+        }
+
+        std::cout << l_aDisplayModesNames[mm] << " mesh, per frame (mean / max ms) | preparation : " << l_oPreparationTime.m_dTotal / l_ui32FramesNb << " / " << l_oPreparationTime.m_dMax
+                  << " | submission : " << l_oSubmissionTime.m_dTotal / l_ui32FramesNb << " / " << l_oSubmissionTime.m_dMax
+                  << " | glFinish : " << l_oFinishTime.m_dTotal / l_ui32FramesNb << " / " << l_oFinishTime.m_dMax << std::endl;
+    }
+
+    l_oPixelBuffer.deleteTexture(l_ui32Texture);
+
+    return 0;
+}
@@ -0,0 +1,264 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file benchmark_head_motion_main.cpp
+ * \brief Compare on recorded kinect data the serial SWCaptureHeadMotion::computeHeadMotion with the SWHeadMotionPipeline,
+ *        and report for each run :
+ *          - the throughput (results per second),
+ *          - the mean / max latency between the input of a frame and its rigid motion,
+ *          - the mean time of each stage (background removal, face detection, nose, cloud creation, alignment).
+ *        The "back to back" runs give the next frame as soon as the previous call returns, the "paced" runs give the frame
+ *        of the current time at the recording frame rate, like a live device.
+ *
+ *  Usage : benchmark_head_motion [data path] [frames number] [pipeline depth] [fps]
+ *          default : ../data/kinect_save/data_ (saved by kinect_data_saver), 100 frames, depth 1, 30 fps.
+ *          The frames are loaded in memory before the runs.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+
+#include "devices/rgbd/SWLoadKinectData.h"
+#include "cloud/SWCaptureHeadMotion.h"
+
+#include "timeUtility.h"
+
+/**
+ * \brief Recorded rgbd frame.
+ */
+struct SWRecordedFrame
+{
+    cv::Mat m_oBgr;     /**< bgr image */
+    cv::Mat m_oCloud;   /**< cloud map */
+};
+
+/**
+ * \brief Results of a run.
+ */
+struct SWRunStats
+{
+    SWRunStats() : m_ui32ResultsNb(0), m_ui32FailuresNb(0), m_dTotalTime(0.), m_dMaxLatency(0.){}
+
+    uint m_ui32ResultsNb;                   /**< number of results */
+    uint m_ui32FailuresNb;                  /**< number of results with an error (face not detected, invalid cloud) */
+    double m_dTotalTime;                    /**< time of the run in ms */
+    double m_dMaxLatency;                   /**< maximum latency in ms */
+    swCloud::SWHeadMotionTimings m_oSum;    /**< sum of the stages times */
+};
+
+/**
+ * \brief Compute the head motion of a frame with the pipeline if there is one, with the serial path otherwise, and add the result to the stats.
+ */
+static void computeHeadMotion(swCloud::SWCaptureHeadMotion &oCapture, swCloud::SWHeadMotionPipeline *pPipeline, const SWRecordedFrame &oFrame, cint i32FrameId, SWRunStats &oStats)
+{
+    swCloud::SWRigidMotion l_oRigidMotion;
+    cv::Mat l_oDisplay;
+    int l_i32Result;
+
+    if(pPipeline)
+    {
+        l_i32Result = pPipeline->computeHeadMotion(l_oRigidMotion, oFrame.m_oBgr, oFrame.m_oCloud, l_oDisplay, i32FrameId);
+    }
+    else
+    {
+        l_i32Result = oCapture.computeHeadMotion(l_oRigidMotion, oFrame.m_oBgr, oFrame.m_oCloud, l_oDisplay);
+    }
+
+    // no result yet
+    if(l_i32Result == 2)
+    {
+        return;
+    }
+
+    if(l_i32Result == -1)
+    {
+        ++oStats.m_ui32FailuresNb;
+    }
+
+    swCloud::SWHeadMotionTimings l_oTimings = oCapture.lastTimings();
+    ++oStats.m_ui32ResultsNb;
+    oStats.m_oSum.m_dBackground    += l_oTimings.m_dBackground;
+    oStats.m_oSum.m_dFaceDetection += l_oTimings.m_dFaceDetection;
+    oStats.m_oSum.m_dNose          += l_oTimings.m_dNose;
+    oStats.m_oSum.m_dCloud         += l_oTimings.m_dCloud;
+    oStats.m_oSum.m_dAlignment     += l_oTimings.m_dAlignment;
+    oStats.m_oSum.m_dLatency       += l_oTimings.m_dLatency;
+    oStats.m_dMaxLatency = std::max(oStats.m_dMaxLatency, l_oTimings.m_dLatency);
+}
+
+/**
+ * \brief Give the frames one after the other, as soon as the previous call returns.
+ */
+static SWRunStats runBackToBack(const std::vector<SWRecordedFrame> &vFrames, swCloud::SWCaptureHeadMotion &oCapture, swCloud::SWHeadMotionPipeline *pPipeline)
+{
+    SWRunStats l_oStats;
+    boost::posix_time::ptime l_oStartTime = boost::posix_time::microsec_clock::local_time();
+
+    for(uint ii = 0; ii < vFrames.size(); ++ii)
+    {
+        computeHeadMotion(oCapture, pPipeline, vFrames[ii], static_cast<int>(ii), l_oStats);
+    }
+
+    l_oStats.m_dTotalTime = swUtil::elapsedMs(l_oStartTime);
+    return l_oStats;
+}
+
+/**
+ * \brief Give the frame of the current time at the recording frame rate, the frames arrived during a call are skipped.
+ * \param [in] bPoll : give again the current frame until the next one, the low latency pipeline ignores it but returns its new results
+ */
+static SWRunStats runPaced(const std::vector<SWRecordedFrame> &vFrames, const double dFps, swCloud::SWCaptureHeadMotion &oCapture, swCloud::SWHeadMotionPipeline *pPipeline,
+                           const bool bPoll = false)
+{
+    SWRunStats l_oStats;
+    boost::posix_time::ptime l_oStartTime = boost::posix_time::microsec_clock::local_time();
+    int l_i32LastIdFrame = -1;
+
+    while(true)
+    {
+        int l_i32IdFrame = static_cast<int>(swUtil::elapsedMs(l_oStartTime) * dFps / 1000.0);
+
+        if(l_i32IdFrame >= static_cast<int>(vFrames.size()))
+        {
+            break;
+        }
+
+        if(l_i32IdFrame != l_i32LastIdFrame || bPoll)
+        {
+            computeHeadMotion(oCapture, pPipeline, vFrames[l_i32IdFrame], l_i32IdFrame, l_oStats);
+            l_i32LastIdFrame = l_i32IdFrame;
+        }
+
+        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    }
+
+    l_oStats.m_dTotalTime = swUtil::elapsedMs(l_oStartTime);
+    return l_oStats;
+}
+
+/**
+ * \brief Display the stats of a run.
+ */
+static void displayStats(const std::string &sName, const SWRunStats &oStats, cuint ui32FramesNb)
+{
+    double l_dResultsNb = std::max(1u, oStats.m_ui32ResultsNb);
+
+    std::cout << sName << " : " << oStats.m_ui32ResultsNb << " results (" << oStats.m_ui32FailuresNb << " failed) for " << ui32FramesNb << " frames in "
+              << oStats.m_dTotalTime << " ms | throughput : " << 1000.0 * oStats.m_ui32ResultsNb / std::max(oStats.m_dTotalTime, 1.0) << " fps"
+              << " | latency mean / max : " << oStats.m_oSum.m_dLatency / l_dResultsNb << " / " << oStats.m_dMaxLatency << " ms" << std::endl;
+    std::cout << "    stages mean (ms) | background : " << oStats.m_oSum.m_dBackground / l_dResultsNb << " face : " << oStats.m_oSum.m_dFaceDetection / l_dResultsNb
+              << " nose : " << oStats.m_oSum.m_dNose / l_dResultsNb << " cloud : " << oStats.m_oSum.m_dCloud / l_dResultsNb
+              << " alignment : " << oStats.m_oSum.m_dAlignment / l_dResultsNb << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string l_sPath("../data/kinect_save/data_");
+    uint l_ui32FramesNb = 100;
+    uint l_ui32Depth    = 1;
+    double l_dFps       = 30.0;
+
+    if(argc > 1)
+    {
+        l_sPath = argv[1];
+    }
+    if(argc > 2)
+    {
+        l_ui32FramesNb = static_cast<uint>(std::max(1, atoi(argv[2])));
+    }
+    if(argc > 3)
+    {
+        l_ui32Depth = static_cast<uint>(std::max(1, atoi(argv[3])));
+    }
+    if(argc > 4)
+    {
+        l_dFps = std::max(1.0, atof(argv[4]));
+    }
+
+    // load the recorded frames
+        std::vector<SWRecordedFrame> l_vFrames;
+
+        swDevice::SWLoadKinectData l_oLoader(l_sPath);
+        l_oLoader.start();
+
+        for(uint ii = 0; ii < l_ui32FramesNb; ++ii)
+        {
+            SWRecordedFrame l_oFrame;
+
+            if(!l_oLoader.grabVideo(l_oFrame.m_oBgr) || !l_oLoader.grabCloud(l_oFrame.m_oCloud))
+            {
+                break;
+            }
+
+            l_oFrame.m_oBgr   = l_oFrame.m_oBgr.clone();
+            l_oFrame.m_oCloud = l_oFrame.m_oCloud.clone();
+            l_vFrames.push_back(l_oFrame);
+        }
+
+        l_oLoader.stop();
+
+        if(l_vFrames.size() == 0)
+        {
+            std::cerr << "No frame loaded from " << l_sPath << std::endl;
+            return -1;
+        }
+
+        std::cout << l_vFrames.size() << " frames loaded, pipeline depth : " << l_ui32Depth << ", fps : " << l_dFps << std::endl;
+
+    // back to back : throughput
+        {
+            swCloud::SWCaptureHeadMotion l_oCapture(20,20);
+            displayStats("serial, back to back", runBackToBack(l_vFrames, l_oCapture, NULL), static_cast<uint>(l_vFrames.size()));
+        }
+        {
+            // the last frames still in the pipeline at the end are not counted
+            swCloud::SWCaptureHeadMotion l_oCapture(20,20);
+            swCloud::SWHeadMotionPipeline l_oPipeline(&l_oCapture, l_ui32Depth, false);
+            displayStats("pipeline, back to back", runBackToBack(l_vFrames, l_oCapture, &l_oPipeline), static_cast<uint>(l_vFrames.size()));
+        }
+
+    // paced : latency on a live stream
+        {
+            swCloud::SWCaptureHeadMotion l_oCapture(20,20);
+            displayStats("serial, paced", runPaced(l_vFrames, l_dFps, l_oCapture, NULL), static_cast<uint>(l_vFrames.size()));
+        }
+        {
+            swCloud::SWCaptureHeadMotion l_oCapture(20,20);
+            swCloud::SWHeadMotionPipeline l_oPipeline(&l_oCapture, l_ui32Depth, false);
+            displayStats("pipeline, paced", runPaced(l_vFrames, l_dFps, l_oCapture, &l_oPipeline), static_cast<uint>(l_vFrames.size()));
+        }
+        {
+            swCloud::SWCaptureHeadMotion l_oCapture(20,20);
+            swCloud::SWHeadMotionPipeline l_oPipeline(&l_oCapture, l_ui32Depth, true);
+            SWRunStats l_oStats = runPaced(l_vFrames, l_dFps, l_oCapture, &l_oPipeline, true);
+            displayStats("low latency pipeline, paced", l_oStats, static_cast<uint>(l_vFrames.size()));
+            std::cout << "    skipped frames : " << l_oPipeline.skippedFramesNb() << std::endl;
+        }
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file benchmark_mat_main.cpp
+ * \brief Compare the throughput of the GPU and CPU backends of the swCuda matrix utilities
+ *        on the systems solved by SWOptimalStepNonRigidICP::resolve (TAA * X = TAB, TAA of size 4n x 4n, TAB of size 4n x 3).
+ *
+ *  Usage : benchmark_mat [nbVertices1 nbVertices2 ...], default : 128 256 512 1024
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+
+#include "gpuMat/gpuMatUtility.h"
+
+#include "benchmarkUtility.h"
+
+/**
+ * \brief Build a random symmetric positive definite matrix looking like the OSNRICP TAA matrix.
+ */
+static void buildSPDMatrix(cint i32Size, cv::Mat &oTAA)
+{
+    cv::Mat l_oA(i32Size, i32Size, CV_32FC1);
+    cv::randu(l_oA, cv::Scalar(-1.f), cv::Scalar(1.f));
+
+    oTAA = l_oA.t() * l_oA + cv::Mat::eye(i32Size, i32Size, CV_32FC1) * static_cast<float>(i32Size);
+}
+
+static void benchmark(cint i32NbVertices, cint i32Backend, const char *sBackendName)
+{
+    setMatBackend(i32Backend);
+
+    int l_i32Size = 4 * i32NbVertices;
+    cv::Mat l_oTAA, l_oTAB(l_i32Size, 3, CV_32FC1), l_oTAAInv, l_oX1, l_oX2, l_oC;
+    buildSPDMatrix(l_i32Size, l_oTAA);
+    cv::randu(l_oTAB, cv::Scalar(-1.f), cv::Scalar(1.f));
+
+    // explicit inverse + multiplication (previous resolve)
+        int64 l_i64Start = cv::getTickCount();
+        swUtil::swCuda::matrixInversion(l_oTAA, l_oTAAInv);
+        swUtil::swCuda::matrixMultiplication(l_oTAAInv, l_oTAB, l_oX1);
+        double l_dTimeInv = elapsedMs(l_i64Start);
+
+    // cholesky solve (current resolve)
+        l_i64Start = cv::getTickCount();
+        swUtil::swCuda::solve(l_oTAA, l_oTAB, l_oX2, true);
+        double l_dTimeSolve = elapsedMs(l_i64Start);
+
+    // square matrix multiplication
+        l_i64Start = cv::getTickCount();
+        swUtil::swCuda::matrixMultiplication(l_oTAA, l_oTAA, l_oC);
+        double l_dTimeGemm = elapsedMs(l_i64Start);
+        double l_dGFlops = 2.0 * l_i32Size * l_i32Size * static_cast<double>(l_i32Size) / (l_dTimeGemm * 1e6);
+
+    std::cout << sBackendName << " n=" << i32NbVertices << " size=" << l_i32Size
+              << " | inverse+mult : " << l_dTimeInv << " ms"
+              << " | solve : " << l_dTimeSolve << " ms"
+              << " | gemm : " << l_dTimeGemm << " ms (" << l_dGFlops << " GFLOPS)"
+              << " | max diff : " << cv::norm(l_oX1, l_oX2, cv::NORM_INF) << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<int> l_vNbVertices;
+
+    for(int ii = 1; ii < argc; ++ii)
+    {
+        l_vNbVertices.push_back(atoi(argv[ii]));
+    }
+
+    if(l_vNbVertices.size() == 0)
+    {
+        l_vNbVertices.push_back(128);
+        l_vNbVertices.push_back(256);
+        l_vNbVertices.push_back(512);
+        l_vNbVertices.push_back(1024);
+    }
+
+    for(uint ii = 0; ii < l_vNbVertices.size(); ++ii)
+    {
+#ifndef SW_CPU_MAT
+        benchmark(l_vNbVertices[ii], SW_MAT_BACKEND_GPU, "GPU");
+#endif
+        benchmark(l_vNbVertices[ii], SW_MAT_BACKEND_CPU, "CPU");
+    }
+
+    return 0;
+}
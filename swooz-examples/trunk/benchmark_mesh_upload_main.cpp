@@ -0,0 +1,200 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+/**
+ * \file benchmark_mesh_upload_main.cpp
+ * \brief Measure the per frame cost of preparing the opengl buffers of an animated mesh on large meshes :
+ *        the copy path (vertexBuffer, indexVertexTriangleBuffer, normalBuffer, textureBuffer copies reallocated at each frame)
+ *        against the persistent path used by the SWGLWidget family (positions interleaved directly in the persistent buffer,
+ *        normals read from the mesh storage, triangles kept, texture coordinates rewritten only when the SWM_TEXTURES
+ *        stream of the mesh is dirty, as the correspondences step of the morphing does).
+ *        The persistent buffers are simulated with preallocated memory, the gpu transfer itself is not measured.
+ *
+ *  Usage : benchmark_mesh_upload [obj file] [frames number], default frames number : 100
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <cmath>
+
+#include "opencv2/core/core.hpp"
+
+#include "mesh/SWMesh.h"
+
+#include "benchmarkUtility.h"
+
+/**
+ * \brief Simulated persistent opengl buffers of a mesh.
+ */
+struct SWBufferList
+{
+    std::vector<float> m_vVertex;
+    std::vector<uint>  m_vIndex;
+    std::vector<float> m_vNormal;
+    std::vector<float> m_vTexture;
+};
+
+/**
+ * \brief Upload of the previous drawMesh : every stream is copied in a new array, then copied in a reallocated buffer.
+ */
+static void uploadWithCopies(const swMesh::SWMesh &oMesh, SWBufferList &oBuffers)
+{
+    float  *l_aFVertexBuffer   = oMesh.vertexBuffer();
+    uint32 *l_aUI32IndexBuffer = oMesh.indexVertexTriangleBuffer();
+    float  *l_aFNormalBuffer   = oMesh.normalBuffer();
+    float  *l_aFTextureBuffer  = oMesh.textureBuffer();
+
+    // allocateBuffer (glBufferData)
+        oBuffers.m_vVertex.assign(l_aFVertexBuffer, l_aFVertexBuffer + oMesh.pointsNumber() * 3);
+        oBuffers.m_vIndex.assign(l_aUI32IndexBuffer, l_aUI32IndexBuffer + oMesh.trianglesNumber() * 3);
+        oBuffers.m_vNormal.assign(l_aFNormalBuffer, l_aFNormalBuffer + oMesh.pointsNumber() * 3);
+        oBuffers.m_vTexture.assign(l_aFTextureBuffer, l_aFTextureBuffer + oMesh.pointsNumber() * 2);
+
+    deleteAndNullifyArray(l_aFVertexBuffer);
+    deleteAndNullifyArray(l_aUI32IndexBuffer);
+    deleteAndNullifyArray(l_aFNormalBuffer);
+    deleteAndNullifyArray(l_aFTextureBuffer);
+}
+
+/**
+ * \brief Upload of the persistent buffers : positions interleaved in the (mapped) buffer, normals written in place,
+ *        texture coordinates written only if they have been modified.
+ */
+static void uploadPersistent(swMesh::SWMesh &oMesh, SWBufferList &oBuffers)
+{
+    const swCloud::SWCloud *l_pCloud = oMesh.cloud();
+    const float *l_aFX = l_pCloud->coord(0), *l_aFY = l_pCloud->coord(1), *l_aFZ = l_pCloud->coord(2);
+    float *l_aFVertex = &oBuffers.m_vVertex[0];
+
+    for(uint ii = 0; ii < oMesh.pointsNumber(); ++ii)
+    {
+        l_aFVertex[ii*3]     = l_aFX[ii];
+        l_aFVertex[ii*3 + 1] = l_aFY[ii];
+        l_aFVertex[ii*3 + 2] = l_aFZ[ii];
+    }
+
+    // updateBuffer (glBufferSubData)
+        memcpy(&oBuffers.m_vNormal[0], oMesh.normalBufferData(), oMesh.pointsNumber() * 3 * sizeof(float));
+
+        if(oMesh.dirtyStreams() & swMesh::SWM_TEXTURES)
+        {
+            memcpy(&oBuffers.m_vTexture[0], oMesh.textureBufferData(), oMesh.pointsNumber() * 2 * sizeof(float));
+            oMesh.clearDirtyStreams(swMesh::SWM_TEXTURES);
+        }
+}
+
+static void benchmark(swMesh::SWMesh &oMesh, cuint ui32FramesNb, const std::string &sName)
+{
+    if(oMesh.pointsNumber() == 0)
+    {
+        std::cerr << "Empty mesh : " << sName << std::endl;
+        return;
+    }
+
+    if(oMesh.textureBufferData() == NULL)
+    {
+        std::vector<float> l_vCoords(2, 0.f);
+        oMesh.setTextureCoordinate(0, l_vCoords);
+    }
+
+    SWBufferList l_oBuffers, l_oCopiesBuffers;
+    uploadWithCopies(oMesh, l_oBuffers);
+    oMesh.clearDirtyStreams();
+
+    std::vector<float> l_vOffset(3, 0.f);
+    double l_dCopiesTime = 0.0, l_dPersistentTime = 0.0, l_dNormalsTime = 0.0;
+
+    for(uint ii = 0; ii < ui32FramesNb; ++ii)
+    {
+        // animate the mesh as a morphing step would
+            l_vOffset[2] = (ii % 2 == 0) ? 0.001f : -0.001f;
+            *oMesh.cloud() += l_vOffset;
+
+            int64 l_i64Start = cv::getTickCount();
+            oMesh.updateNonOrientedTrianglesNormals();
+            oMesh.updateNonOrientedVerticesNormals();
+            l_dNormalsTime += elapsedMs(l_i64Start);
+
+        // the correspondences step associates again a part of the texture coordinates
+            if(ii % 4 == 0)
+            {
+                std::vector<float> l_vCoords(2, 0.f);
+                cuint l_ui32IdVertex = (ii * 7919u) % oMesh.pointsNumber();
+                oMesh.textureCoordinate(l_ui32IdVertex, l_vCoords);
+                l_vCoords[0] += 0.001f;
+                oMesh.setTextureCoordinate(l_ui32IdVertex, l_vCoords);
+            }
+
+        l_i64Start = cv::getTickCount();
+        uploadWithCopies(oMesh, l_oCopiesBuffers);
+        l_dCopiesTime += elapsedMs(l_i64Start);
+
+        l_i64Start = cv::getTickCount();
+        uploadPersistent(oMesh, l_oBuffers);
+        l_dPersistentTime += elapsedMs(l_i64Start);
+    }
+
+    // the persistent texture buffer must follow the modified texture coordinates
+        if(memcmp(&l_oBuffers.m_vTexture[0], oMesh.textureBufferData(), oMesh.pointsNumber() * 2 * sizeof(float)) != 0)
+        {
+            std::cerr << "Error : the persistent texture coordinates buffer is stale : " << sName << std::endl;
+        }
+
+    std::cout << sName << " | vertices : " << oMesh.pointsNumber() << " triangles : " << oMesh.trianglesNumber()
+              << " | per frame, normals : " << l_dNormalsTime / ui32FramesNb << " ms"
+              << " | copies upload : " << l_dCopiesTime / ui32FramesNb << " ms"
+              << " | persistent upload : " << l_dPersistentTime / ui32FramesNb << " ms"
+              << " | speedup : " << l_dCopiesTime / l_dPersistentTime << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    uint l_ui32FramesNb = 100;
+
+    if(argc > 2)
+    {
+        l_ui32FramesNb = static_cast<uint>(atoi(argv[2]));
+    }
+
+    if(argc > 1)
+    {
+        swMesh::SWMesh l_oMesh(argv[1]);
+        benchmark(l_oMesh, l_ui32FramesNb, argv[1]);
+        return 0;
+    }
+
+    // grids of about 100k, 250k, 500k and 1M vertices
+    cuint l_aUI32GridSizes[4] = {317, 500, 708, 1000};
+
+    for(uint ii = 0; ii < 4; ++ii)
+    {
+        swMesh::SWMesh l_oMesh;
+        buildFaceMesh(l_aUI32GridSizes[ii], l_oMesh);
+        benchmark(l_oMesh, l_ui32FramesNb, "face grid");
+    }
+
+    return 0;
+}
@@ -28,11 +28,55 @@
  * \author Florian Lance
  * \date 02-05-2014
  * \brief An example program for loading kinect data using SWoOZ platform.
+ *
+ *  The data files are read on a loading thread which fills a bounded queue ahead of the display,
+ *  the display thread only waits for the frame rate and the window events.
  */
 
 #include <iostream>
 #include <time.h>
 #include "devices/rgbd/SWLoadKinectData.h"
+#include "devices/SWFramePipeline.h"
+
+/**
+ * \brief Kinect frame going through the pipeline.
+ */
+struct KinectFrame
+{
+    cv::Mat bgrImage;   /**< rgb image */
+    cv::Mat cloudMap;   /**< cloud map */
+};
+
+/**
+ * \brief Load stage : read the next saved frame.
+ * \param [in]  pDataLoader   : kinect data loader
+ * \param [in]  bLoadVideo    : load the video data ?
+ * \param [in]  bLoadCloud    : load the cloud data ?
+ * \param [out] oFrame        : loaded frame
+ * \return 1 if a frame has been loaded, -1 at the end of the data
+ */
+static int loadKinect(swDevice::SWLoadKinectData *pDataLoader, const bool bLoadVideo, const bool bLoadCloud, KinectFrame &oFrame)
+{
+    // new mats : the previous ones may still be displayed
+    oFrame = KinectFrame();
+
+    if(bLoadVideo)
+    {
+        if(!pDataLoader->grabVideo(oFrame.bgrImage))
+        {
+            return -1;
+        }
+    }
+    if(bLoadCloud)
+    {
+        if(!pDataLoader->grabCloud(oFrame.cloudMap))
+        {
+            return -1;
+        }
+    }
+
+    return 1;
+}
 
 int main()
 {
@@ -54,35 +98,36 @@ int main()
 
     dataLoader.start();
 
+    // set the pipeline : load -> display, no frame is skipped
+    swDevice::SWFrameQueue<KinectFrame> loadedFrames(static_cast<unsigned int>(fps)); // 1s of frames ahead
+    swDevice::SWFrameStage_thread<KinectFrame> loadStage(boost::bind(&loadKinect, &dataLoader, saveVideoData, saveCloudData, _1));
+    loadStage.addOutput(&loadedFrames);
+    loadStage.startListening();
+
+    KinectFrame frame;
     char key = ' ';
     while(key != 'q')
     {
         clock_t time = clock();
 
-        cv::Mat rgb, cloudMap;
+        // retrieve the next loaded kinect frame
+        if(!loadedFrames.pop(frame))
+        {
+            break;
+        }
 
-        // grab new kinect frame
+        // display the kinect loaded rgb image in the opencv window
         if(saveVideoData)
         {
-            if(!dataLoader.grabVideo(rgb))
-            {
-                break;
-            }
+            cv::imshow("rgb_kinect",frame.bgrImage);
         }
+
+        // display the kinect loaded cloud map in the opencv window
         if(saveCloudData)
         {
-            if(!dataLoader.grabCloud(cloudMap))
-            {
-                break;
-            }
+            cv::imshow("cloud_map_kinect",frame.cloudMap);
         }
 
-        // display the kinect loaded rgb image in the opencv window
-        cv::imshow("rgb_kinect",rgb);
-
-        // display the kinect loaded cloud map in the opencv window
-        cv::imshow("cloud_map_kinect",cloudMap);
-
         // check time
         double elapsedTime = ((float)(clock() - time) / CLOCKS_PER_SEC);
 
@@ -97,6 +142,14 @@ int main()
         }
     }
 
+    // stop the loading thread
+    loadStage.stopListening();
+
+    if(loadStage.hasFailed())
+    {
+        std::cerr << "Error loading kinect data : " << loadStage.errorMessage() << std::endl;
+    }
+
     // stop the loading
     dataLoader.stop();
 
@@ -106,4 +159,3 @@ int main()
 
     return 0;
 }
-
@@ -28,16 +28,69 @@
  * \author Florian Lance
  * \date 02-05-2014
  * \brief An example program for saving kinect data using SWoOZ platform.
+ *
+ *  The kinect is grabbed, the frames are saved and displayed on three threads : every grabbed frame goes through a bounded queue
+ *  to the recorder, the display only shows the latest one, so a slow window never slows down the capture nor the saving.
  */
 
 
 #include <iostream>
-#include <time.h>
-#include "devices/rgbd/SWKinect_thread.h"
+#include "devices/rgbd/SWKinect.h"
 #include "devices/rgbd/SWSaveKinectData.h"
+#include "SWExceptions.h"
+#include "devices/SWFramePipeline.h"
 
 #include "boost/filesystem.hpp"
 
+/**
+ * \brief Kinect frame going through the pipeline.
+ */
+struct KinectFrame
+{
+    cv::Mat bgrImage;   /**< rgb image */
+    cv::Mat cloudMap;   /**< cloud map */
+};
+
+/**
+ * \brief Grab stage : retrieve a new kinect frame.
+ * \param [in]  pKinect : kinect device
+ * \param [out] oFrame  : grabbed frame
+ * \return 1 when a frame has been grabbed, a grab error is thrown and stops the stage (see SWFrameStage_thread::hasFailed)
+ */
+static int grabKinect(swDevice::SWKinect *pKinect, KinectFrame &oFrame)
+{
+    pKinect->grab();
+
+    oFrame.bgrImage = pKinect->bgrImage.clone();
+    oFrame.cloudMap = pKinect->cloudMap.clone();
+
+    return 1;
+}
+
+/**
+ * \brief Record stage : save the frames of the queue in their grab order.
+ * \param [in]  pDataSaver : kinect data saver
+ * \param [in]  pQueue     : grabbed frames
+ * \param [out] oFrame     : saved frame
+ * \return 1 if a frame has been saved, -1 when the queue is closed and empty or when the recording is ended
+ */
+static int saveKinect(swDevice::SWSaveKinectData *pDataSaver, swDevice::SWFrameQueue<KinectFrame> *pQueue, KinectFrame &oFrame)
+{
+    if(!pQueue->pop(oFrame))
+    {
+        return -1;
+    }
+
+    if(!pDataSaver->save(oFrame.bgrImage, oFrame.cloudMap))
+    {
+        // recording ended (max length or size), the grab stage must not wait for the recorder anymore
+        pQueue->close();
+        return -1;
+    }
+
+    return 1;
+}
+
 int main()
 {
 
@@ -48,20 +101,21 @@ int main()
     cvMoveWindow("rgb_kinect",200,200);
     cvMoveWindow("cloud_map_kinect",200+640,200);
 
-    swDevice::SWKinect_thread kinectDeviceT;
+    swDevice::SWKinect kinectDevice;
 
     // init the kinect device
-    if(kinectDeviceT.init(0) == -1)
+    try
     {
-        std::cerr << "Error initializing kinect device. " << std::endl;
-        return -1;
+        if(kinectDevice.init(0) == -1)
+        {
+            std::cerr << "Error initializing kinect device. " << std::endl;
+            return -1;
+        }
     }
-
-    // start listening the kinect device
-    kinectDeviceT.startListening();
-    while(!kinectDeviceT.isDataAvailable())
+    catch(const swExcept::swKinectError &e)
     {
-        cv::waitKey(5);
+        std::cerr << "Error initializing kinect device : " << e.what() << std::endl;
+        return -1;
     }
 
     std::string path("../data/kinect_save/data_");
@@ -70,7 +124,7 @@ int main()
 
     double maxLength = 60.0; // maximum length of the saving
     double maxSize   = 20.0; // maximum size in Go
-    double fps       = 30.0; // fps
+    double fps       = 30.0; // display fps
 
     swDevice::SWSaveKinectData dataSaver(path, maxLength, maxSize);
 
@@ -78,40 +132,48 @@ int main()
     bool saveCloudData = true;
     dataSaver.start(saveVideoData, saveCloudData);
 
-    char key = ' ';
+    // set the pipeline : grab -> (display, record)
+    swDevice::SWLatestFrame<KinectFrame> displayedFrame;
+    swDevice::SWFrameQueue<KinectFrame>  recordedFrames(static_cast<unsigned int>(fps * 2)); // 2s of frames
 
-    while(key != 'q')
-    {
-        clock_t time = clock();
+    swDevice::SWFrameStage_thread<KinectFrame> grabStage(boost::bind(&grabKinect, &kinectDevice, _1));
+    swDevice::SWFrameStage_thread<KinectFrame> recordStage(boost::bind(&saveKinect, &dataSaver, &recordedFrames, _1));
 
-        // display the kinect rgb image in the opencv window
-        cv::imshow("rgb_kinect",kinectDeviceT.bgrImage());
+    grabStage.addOutput(&displayedFrame);
+    grabStage.addOutput(&recordedFrames);
 
-        // display the kinect cloud map in the opencv window
-        cv::imshow("cloud_map_kinect",kinectDeviceT.cloudMap());
+    recordStage.startListening();
+    grabStage.startListening();
+
+    KinectFrame frame;
+    char key = ' ';
 
-        // save current kinect frame
-        if(!dataSaver.save(kinectDeviceT.bgrImage(), kinectDeviceT.cloudMap()))
+    while(key != 'q' && recordStage.isRunning())
+    {
+        if(displayedFrame.pop(frame, static_cast<int>(1000.0 / fps)))
         {
-            break;
-        }
+            // display the kinect rgb image in the opencv window
+            cv::imshow("rgb_kinect", frame.bgrImage);
 
-        // check time
-        double elapsedTime = ((float)(clock() - time) / CLOCKS_PER_SEC);
+            // display the kinect cloud map in the opencv window
+            cv::imshow("cloud_map_kinect", frame.cloudMap);
+        }
 
         // wait for key events
-        if(elapsedTime < 1000.0 / fps)
-        {
-            key = cv::waitKey(static_cast<int>(1000.0 / fps - elapsedTime));
-        }
-        else
-        {
-            key = cv::waitKey(5);
-        }
+        key = cv::waitKey(1);
+    }
+
+    // stop grabbing kinect data, the recorder saves the frames still in the queue
+    grabStage.stopListening();
+    recordStage.waitEnd();
+
+    if(grabStage.hasFailed())
+    {
+        std::cerr << "Error grabbing kinect data : " << grabStage.errorMessage() << std::endl;
     }
 
-    // stop listening kinect data
-    kinectDeviceT.stopListening();
+    std::cout << "Grabbed frames : " << grabStage.framesNb() << " saved frames : " << recordStage.framesNb()
+              << " maximum queue size : " << recordedFrames.maxSize() << std::endl;
 
     // stop the saving and create the data files
     dataSaver.stop();
@@ -41,6 +41,7 @@
 // SWOOZ
 #include "SWExceptions.h"
 #include "commonTypes.h"
+#include "SWTrackingBottle.h"
 
 // INTERFACES
 #include "SWUI_Manipulation.h"
@@ -63,6 +64,10 @@
 //#include <QBasicTimer>
 
 #include <QtGui>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QMutex>
+#include <QWaitCondition>
 
 //using namespace yarp::os;
 //using namespace yarp::dev;
@@ -80,8 +85,12 @@ enum PlanificationMode
 
 struct SWBottleContent
 {
+    SWBottleContent() : idLib(-1), format(swTracking::LIST_BOTTLE)
+    {}
+
     int idLib;
     std::vector<double> dValues;
+    swTracking::BottleFormat format;    /**< format of the received bottle, the modified bottle is sent with the same one */
 
     void display() const
     {
@@ -94,6 +103,54 @@ struct SWBottleContent
     }
 };
 
+/**
+ * \struct SWManipulationParams
+ * \brief Immutable snapshot of the manipulation parameters, published by the interface and read by the worker loop.
+ *
+ * A snapshot is never modified once published : updates are done on a copy which then replaces the current snapshot.
+ */
+struct SWManipulationParams
+{
+    QVector<int> vPlanMode;                         /**< planification mode for each connection */
+    QVector<int> vPlanModifier;                     /**< planification modifier for each connection */
+    QVector<bool> vBActiveBottlesOUTSend;           /**< is output active ? */
+    QVector<QVector<double> > vVDamping;            /**< damping to apply for each connection (not for normal mode) */
+    QVector<QVector<double> > vVShift;              /**< shift to add for each connection (not for normal mode) */
+    QVector<double> vPlanTimeTotal;                 /**< total time for the planification for each connection */
+    QVector<double> vPlanTimeBlock;                 /**< time block for each connection (only for random mode) */
+    QVector<QVector<int> > vPlanSequenceTime;       /**< sequence planification time for each connection (only for sequence mode) */
+    QVector<QVector<int> > vPlanSequenceModifier;   /**< sequence planification modifier for each connection (only for sequence mode) */
+};
+
+class SWManipulationWorker;
+
+/**
+ * \class SWManipulationInputCallback
+ * \brief YARP reader callback forwarding the bottles of an input port to the manipulation worker.
+ */
+class SWManipulationInputCallback : public yarp::os::TypedReaderCallback<yarp::os::Bottle>
+{
+    public :
+
+        /**
+         * @brief SWManipulationInputCallback
+         * @param [in] pWorker   : worker to wake up when a bottle is received
+         * @param [in] i32Index  : index of the input connection
+         */
+        SWManipulationInputCallback(SWManipulationWorker *pWorker, cint i32Index);
+
+        /**
+         * @brief onRead, called by the YARP port thread for each received bottle
+         * @param [in] oBottle : received bottle
+         */
+        virtual void onRead(yarp::os::Bottle &oBottle);
+
+    private :
+
+        SWManipulationWorker *m_pWorker;    /**< worker to notify */
+        int m_i32Index;                     /**< index of the input connection */
+};
+
 /**
  * \class SWManipulationWorker
  * \brief  Worker used in the swooz manipulation interface
@@ -122,29 +179,53 @@ class SWManipulationWorker : public QObject
          */
         bool isInitialized() const;
 
+        /**
+         * @brief pushBottle, store the content of a received bottle and wake up the worker loop (called from the YARP port threads)
+         * @param [in] i32Index : index of the input connection
+         * @param [in] oBottle  : received bottle
+         */
+        void pushBottle(cint i32Index, const yarp::os::Bottle &oBottle);
+
     private :
 
         /**
          * @brief retrieveBottleContent
          * @param oBottleContent
-         * @param oPort
-         * @return
+         * @param oBottle
          */
-        bool retrieveBottleContent(SWBottleContent &oBottleContent, yarp::os::BufferedPort<yarp::os::Bottle> &oPort);
+        void retrieveBottleContent(SWBottleContent &oBottleContent, const yarp::os::Bottle &oBottle) const;
 
         /**
          * @brief applyDampingOnBottle
          * @param oBottleContent
          * @param vDDamping
          */
-        void applyDampingOnBottle(SWBottleContent &oBottleContent, QVector<double> vDDamping);
+        void applyDampingOnBottle(SWBottleContent &oBottleContent, const QVector<double> &vDDamping);
 
         /**
          * @brief applyShiftOnBottle
          * @param oBottleContent
          * @param vDShifts
          */
-        void applyShiftOnBottle(SWBottleContent &oBottleContent, QVector<double> vDShifts);
+        void applyShiftOnBottle(SWBottleContent &oBottleContent, const QVector<double> &vDShifts);
+
+        /**
+         * @brief acquireParams, retrieve the current parameters snapshot without locking
+         * @return the current snapshot, valid until the end of the current loop iteration
+         */
+        const SWManipulationParams *acquireParams();
+
+        /**
+         * @brief publishParams, replace the current parameters snapshot, the previous one is released once the worker loop can't use it anymore
+         * @param [in] pNewParams : new snapshot (the worker takes the ownership)
+         */
+        void publishParams(SWManipulationParams *pNewParams);
+
+        /**
+         * @brief releaseRetiredParams, delete the retired snapshots which can't be used anymore by the worker loop
+         * @param [in] bAll : delete all the retired snapshots (only when the loop is not running)
+         */
+        void releaseRetiredParams(cbool bAll = false);
 
 
     public slots :
@@ -194,18 +275,20 @@ class SWManipulationWorker : public QObject
 
         /**
          * @brief sequencePartModifier
+         * @param oParams
          * @param dCurrentTime
          * @param i32IndexSequence
          * @return
          */
-        int sequencePartModifier(double dCurrentTime, cint i32IndexSequence) const;
+        int sequencePartModifier(const SWManipulationParams &oParams, double dCurrentTime, cint i32IndexSequence) const;
 
         /**
          * @brief addAllTimeSequence
+         * @param oParams
          * @param i32IndexSequence
          * @return
          */
-        double addAllTimeSequence(cint i32IndexSequence) const;
+        double addAllTimeSequence(const SWManipulationParams &oParams, cint i32IndexSequence) const;
 
         /**
          * @brief updateBottleStart
@@ -230,46 +313,41 @@ class SWManipulationWorker : public QObject
 
     private :
 
-        bool m_bDoLoop;                                 /**< do the work ? */
+        QAtomicInt m_aI32DoLoop;                        /**< do the work ? */
         bool m_bInitialization;                         /**< is initialized ? */
 
-        int m_i32LoopPeriod;                            /**< loop period */
+        int m_i32LoopTimeout;                           /**< maximum time in ms to wait for a bottle before updating the planifications */
 
         int m_i32ConnectionsNb;                         /**< number of yarp input/output connections */
         int m_i32ModifiersNb;                           /**< number of bottle modifiers */
 
-        // all modes
-        QVector<SWBottleContent> m_vBottlesContent;     /**< current bottles content */
-        QVector<int> m_vPlanMode;                       /**< planification mode for each connection */
-        QVector<int> m_vPlanModifier;                   /**< planification modifier for each connection */
-        QVector<double> m_vTimePlanification;           /**< time remaining for each connection (not for sequence mode) */
-        QVector<bool> m_vBActiveBottlesOUTSend;         /**< is output active ? */
-        QVector<bool> m_vBStartBottlesOutSend;          /**< is started ? */
-        QVector<QVector<double> > m_vVDamping;          /**< damping to apply for each connection (not for normal mode) */
-        QVector<QVector<double> > m_vVShift;            /**< shift to add for each connection (not for normal mode) */
+        // parameters snapshot (read by the loop, written by the interface slots)
+        QAtomicPointer<SWManipulationParams> m_pParams; /**< current parameters snapshot */
+        QAtomicInt m_aI32LoopEpoch;                     /**< number of finished loop iterations, used to know when a retired snapshot is released */
+        QVector<QPair<SWManipulationParams*,int> > m_vRetiredParams; /**< retired snapshots with the loop epoch of their retirement */
+        QMutex m_oPublishMutex;                         /**< serializes the snapshots publication (never taken by the loop) */
 
-        // NORMAL / MODIFIED mode
-        QVector<double> m_vPlanTimeTotal;               /**< total time for the planification for each connection */
+        // start / stop of the planifications (written by both the interface and the loop)
+        QVector<QAtomicInt> m_vAI32StartBottlesOutSend; /**< is started ? */
 
-        // RANDOM mode
-        QVector<double> m_vPlanTimeBlock;               /**< time block for each connection (only for random mode) */
+        // input bottles
+        QMutex m_oInputMutex;                           /**< mutex for the received bottles */
+        QWaitCondition m_oInputCondition;               /**< wakes up the loop when a bottle is received or when the loop is stopped */
+        QVector<SWBottleContent> m_vPendingBottlesContent; /**< last received bottles content not yet processed */
+        QVector<bool> m_vBPendingBottles;               /**< is a bottle pending for each connection ? */
+        QVector<SWManipulationInputCallback*> m_vInputCallbacks; /**< input ports callbacks */
 
-        // SEQUENCE mode
-        QVector<QVector<int> > m_vPlanSequenceTime;     /**< sequence planification time for each connection (only for sequence mode) */
-        QVector<QVector<int> > m_vPlanSequenceModifier; /**< sequence planification modifier for each connection (only for sequence mode) */
+        // loop only
+        QVector<SWBottleContent> m_vBottlesContent;     /**< current bottles content */
+        QVector<int> m_vPlanModifier;                   /**< current planification modifier for each connection */
+        QVector<double> m_vTimePlanification;           /**< time remaining for each connection (not for sequence mode) */
         QVector<double> m_vTimePlanificationSequence;   /**< time remaining for each connection (only for sequence mode) */
 
-
-        // mutex for protecting data from slot call modifications
-        QReadWriteLock m_oLoopMutex;                    /**< mutex for the main worker loop */
-        QReadWriteLock m_oActiveBottleMutex;            /**< mutex for activating/desactivating bottles output */
-        QReadWriteLock m_oStartBottleMutex;             /**< mutex for starting/stoping the planifications */
-        QReadWriteLock m_oModifiersMutex;               /**< mutex for update the bottles modifiers */
-
         QVector<QString> m_vSManipulationINPortName;    /**< vector of yarp IN port names */
         QVector<QString> m_vSManipulationOUTPortName;   /**< vector of yarp OUT port names */
         QVector<yarp::os::BufferedPort<yarp::os::Bottle>*> m_vManipulationINPort;   /**< ... */
         QVector<yarp::os::BufferedPort<yarp::os::Bottle>*> m_vManipulationOUTPort;  /**< ... */
+        std::vector<char> m_vOUTBottleBuffer;           /**< scratch buffer of the binary output bottles */
 };
 
 
@@ -49,28 +49,43 @@ using namespace swExcept;
 
 QString g_sDefaultSequence("10 s10 10 d10 10 ds10 10");
 
-SWManipulationWorker::SWManipulationWorker() : m_bDoLoop(true), m_bInitialization(true), m_i32LoopPeriod(10)
+SWManipulationInputCallback::SWManipulationInputCallback(SWManipulationWorker *pWorker, cint i32Index) : m_pWorker(pWorker), m_i32Index(i32Index)
+{}
+
+void SWManipulationInputCallback::onRead(yarp::os::Bottle &oBottle)
+{
+    m_pWorker->pushBottle(m_i32Index, oBottle);
+}
+
+SWManipulationWorker::SWManipulationWorker() : m_aI32DoLoop(1), m_bInitialization(true), m_i32LoopTimeout(50), m_pParams(NULL), m_aI32LoopEpoch(0)
 {
     m_i32ConnectionsNb = 5;
     m_i32ModifiersNb = 9;
 
     // init ports vectors and bottles
-    m_vBottlesContent     = QVector<SWBottleContent>(m_i32ConnectionsNb);
+    m_vBottlesContent        = QVector<SWBottleContent>(m_i32ConnectionsNb);
+    m_vPendingBottlesContent = QVector<SWBottleContent>(m_i32ConnectionsNb);
+    m_vBPendingBottles       = QVector<bool>(m_i32ConnectionsNb, false);
     m_vManipulationINPort = QVector<yarp::os::BufferedPort<yarp::os::Bottle>*>(m_i32ConnectionsNb, NULL);
     m_vManipulationOUTPort= QVector<yarp::os::BufferedPort<yarp::os::Bottle>*>(m_i32ConnectionsNb, NULL);
-
-    // init paramters vectors
-    m_vPlanMode     = QVector<int>(m_i32ConnectionsNb, 0);
-    m_vPlanModifier = QVector<int>(m_i32ConnectionsNb, NO_MODIF);
-    m_vPlanTimeTotal= QVector<double>(m_i32ConnectionsNb, 100.0);
-    m_vPlanTimeBlock= QVector<double>(m_i32ConnectionsNb, 25.0);
-    m_vPlanSequenceTime     = QVector<QVector<int> >(m_i32ConnectionsNb, QVector<int>(5, 20));
-    m_vPlanSequenceModifier = QVector<QVector<int> >(m_i32ConnectionsNb, QVector<int>(5, NO_MODIF));
-    m_vVDamping     = QVector<QVector<double> >(m_i32ConnectionsNb, QVector<double>(m_i32ModifiersNb, 1.0));
-    m_vVShift       = QVector<QVector<double> >(m_i32ConnectionsNb, QVector<double>(m_i32ModifiersNb, 0.0));
-
-    m_vBActiveBottlesOUTSend    = QVector<bool>(m_i32ConnectionsNb, false);
-    m_vBStartBottlesOutSend     = QVector<bool>(m_i32ConnectionsNb, false);
+    m_vInputCallbacks     = QVector<SWManipulationInputCallback*>(m_i32ConnectionsNb, NULL);
+
+    // init first parameters snapshot
+    SWManipulationParams *l_pParams = new SWManipulationParams();
+    l_pParams->vPlanMode     = QVector<int>(m_i32ConnectionsNb, 0);
+    l_pParams->vPlanModifier = QVector<int>(m_i32ConnectionsNb, NO_MODIF);
+    l_pParams->vPlanTimeTotal= QVector<double>(m_i32ConnectionsNb, 100.0);
+    l_pParams->vPlanTimeBlock= QVector<double>(m_i32ConnectionsNb, 25.0);
+    l_pParams->vPlanSequenceTime     = QVector<QVector<int> >(m_i32ConnectionsNb, QVector<int>(5, 20));
+    l_pParams->vPlanSequenceModifier = QVector<QVector<int> >(m_i32ConnectionsNb, QVector<int>(5, NO_MODIF));
+    l_pParams->vVDamping     = QVector<QVector<double> >(m_i32ConnectionsNb, QVector<double>(m_i32ModifiersNb, 1.0));
+    l_pParams->vVShift       = QVector<QVector<double> >(m_i32ConnectionsNb, QVector<double>(m_i32ModifiersNb, 0.0));
+    l_pParams->vBActiveBottlesOUTSend = QVector<bool>(m_i32ConnectionsNb, false);
+    m_pParams.fetchAndStoreOrdered(l_pParams);
+
+    // init loop values
+    m_vPlanModifier             = QVector<int>(m_i32ConnectionsNb, NO_MODIF);
+    m_vAI32StartBottlesOutSend  = QVector<QAtomicInt>(m_i32ConnectionsNb);
     m_vTimePlanification        = QVector<double>(m_i32ConnectionsNb, 0.0);
     m_vTimePlanificationSequence= QVector<double>(m_i32ConnectionsNb, 0.0);
 
@@ -100,6 +115,10 @@ SWManipulationWorker::SWManipulationWorker() : m_bDoLoop(true), m_bInitializatio
                 m_bInitialization = false;
                 break;
             }
+
+            // the bottles are pushed to the loop by the port thread, the loop is only waken up when something arrives
+            m_vInputCallbacks[ii] = new SWManipulationInputCallback(this, ii);
+            m_vManipulationINPort[ii]->useCallback(*m_vInputCallbacks[ii]);
         }
 }
 
@@ -107,9 +126,11 @@ SWManipulationWorker::~SWManipulationWorker()
 {
     for(int ii = 0; ii < m_i32ConnectionsNb; ++ii)
     {
+        m_vManipulationINPort[ii]->disableCallback();
         m_vManipulationINPort[ii]->interrupt();
         m_vManipulationINPort[ii]->close();
         delete m_vManipulationINPort[ii];
+        deleteAndNullify(m_vInputCallbacks[ii]);
     }
 
     for(int ii = 0; ii < m_i32ConnectionsNb; ++ii)
@@ -119,6 +140,9 @@ SWManipulationWorker::~SWManipulationWorker()
         delete m_vManipulationOUTPort[ii];
     }
 
+    releaseRetiredParams(true);
+    delete m_pParams.fetchAndStoreOrdered(NULL);
+
     yarp::os::Network::fini();
 }
 
@@ -127,62 +151,103 @@ bool SWManipulationWorker::isInitialized() const
     return m_bInitialization;
 }
 
-void SWManipulationWorker::startLoop()
+void SWManipulationWorker::pushBottle(cint i32Index, const yarp::os::Bottle &oBottle)
+{
+    m_oInputMutex.lock();
+        retrieveBottleContent(m_vPendingBottlesContent[i32Index], oBottle);
+        m_vBPendingBottles[i32Index] = true;
+        m_oInputCondition.wakeOne();
+    m_oInputMutex.unlock();
+}
+
+const SWManipulationParams *SWManipulationWorker::acquireParams()
+{
+    return m_pParams.fetchAndAddAcquire(0);
+}
+
+void SWManipulationWorker::publishParams(SWManipulationParams *pNewParams)
+{
+    // the snapshot retired at epoch E may still be read by the loop iteration E, it can be deleted once the epoch is greater than E
+    SWManipulationParams *l_pOldParams = m_pParams.fetchAndStoreOrdered(pNewParams);
+    m_vRetiredParams.push_back(qMakePair(l_pOldParams, m_aI32LoopEpoch.fetchAndAddOrdered(0)));
+
+    releaseRetiredParams();
+}
+
+void SWManipulationWorker::releaseRetiredParams(cbool bAll)
 {
-    bool l_bDoLoop;
-    m_oLoopMutex.lockForRead();
-        l_bDoLoop = m_bDoLoop;
-    m_oLoopMutex.unlock();
+    int l_i32Epoch = m_aI32LoopEpoch.fetchAndAddOrdered(0);
 
+    int l_i32NbReleased = 0;
+    while(l_i32NbReleased < m_vRetiredParams.size() && (bAll || m_vRetiredParams[l_i32NbReleased].second < l_i32Epoch))
+    {
+        delete m_vRetiredParams[l_i32NbReleased].first;
+        ++l_i32NbReleased;
+    }
+
+    m_vRetiredParams.remove(0, l_i32NbReleased);
+}
+
+void SWManipulationWorker::startLoop()
+{
     QTime l_oStartTime;
     l_oStartTime.start();
 
-    while(l_bDoLoop)
+    QVector<bool> l_vBottlesReceive(m_i32ConnectionsNb, false);
+    QVector<bool> l_vDO(m_i32ConnectionsNb, false);
+    QVector<bool> l_vMODIFIED(m_i32ConnectionsNb, false);
+
+    while(m_aI32DoLoop.fetchAndAddOrdered(0))
     {
-        // control the time of the loop
-            while(l_oStartTime.elapsed() < m_i32LoopPeriod)
-            {
-                QCoreApplication::processEvents(QEventLoop::AllEvents, m_i32LoopPeriod - l_oStartTime.elapsed());
-            }
-            l_oStartTime.restart();
+        // wait for a new bottle or for the timeout
+            m_oInputMutex.lock();
 
-        // retrieve bottles content
-            QVector<bool> l_vBottlesReceive(m_vBottlesContent.size(), false);
-            for(int ii = 0; ii < m_i32ConnectionsNb; ++ii)
-            {
-                l_vBottlesReceive[ii]  = retrieveBottleContent(m_vBottlesContent[ii], *m_vManipulationINPort[ii]);
-            }
+                bool l_bPending = m_vBPendingBottles.contains(true);
+                if(!l_bPending && m_aI32DoLoop.fetchAndAddOrdered(0))
+                {
+                    m_oInputCondition.wait(&m_oInputMutex, m_i32LoopTimeout);
+                }
+
+                // retrieve bottles content
+                for(int ii = 0; ii < m_i32ConnectionsNb; ++ii)
+                {
+                    l_vBottlesReceive[ii] = m_vBPendingBottles[ii];
+
+                    if(m_vBPendingBottles[ii])
+                    {
+                        std::swap(m_vBottlesContent[ii].dValues, m_vPendingBottlesContent[ii].dValues);
+                        m_vBottlesContent[ii].idLib = m_vPendingBottlesContent[ii].idLib;
+                        m_vBPendingBottles[ii] = false;
+                    }
+                }
+
+            m_oInputMutex.unlock();
+
+        // elapsed time since the last iteration
+            double l_dElapsedTime = l_oStartTime.restart()*0.001;
 
         // defines what to do according to the planification of each connection
-            // retrieve mutex protected values
-                m_oStartBottleMutex.lockForRead();
-                    QVector<bool> l_vBStartBottlesOutSend = m_vBStartBottlesOutSend;
-                m_oStartBottleMutex.unlock();
-
-                m_oModifiersMutex.lockForRead();
-                    QVector<double>           l_vPlanTimeTotal  = m_vPlanTimeTotal;
-                    QVector<QVector<double> > l_vVDamping       = m_vVDamping;
-                    QVector<QVector<double> > l_vVShift         = m_vVShift;
-                    QVector<int>              l_vPlanMode       = m_vPlanMode;
-                m_oModifiersMutex.unlock();
-
-                m_oActiveBottleMutex.lockForRead();
-                    QVector<bool> l_vBActiveBottlesOUTSend = m_vBActiveBottlesOUTSend;
-                m_oActiveBottleMutex.unlock();
+            // retrieve the current parameters snapshot, no copy, no lock
+                const SWManipulationParams &l_oParams = *acquireParams();
 
             // init actions booleans for each connection
-                QVector<bool> l_vDO(l_vBStartBottlesOutSend.size(), false);
-                QVector<bool> l_vMODIFIED(l_vBStartBottlesOutSend.size(), false);
+                l_vDO.fill(false);
+                l_vMODIFIED.fill(false);
 
                 for(int ii = 0; ii < m_i32ConnectionsNb; ++ii)
                 {
-                    if(l_vBStartBottlesOutSend[ii])
+                    if(l_oParams.vPlanMode[ii] != SEQUENCE)
+                    {
+                        m_vPlanModifier[ii] = l_oParams.vPlanModifier[ii];
+                    }
+
+                    if(m_vAI32StartBottlesOutSend[ii].fetchAndAddOrdered(0))
                     {
                         // normal mode : no modification on bottles, lasts until time total is less than 0
-                        if(l_vPlanMode[ii] == NORMAL)
+                        if(l_oParams.vPlanMode[ii] == NORMAL)
                         {
                             // update time
-                            m_vTimePlanification[ii] -= m_i32LoopPeriod*0.001;
+                            m_vTimePlanification[ii] -= l_dElapsedTime;
 
                             // check remaining time
                             if(m_vTimePlanification[ii] > 0.0)
@@ -191,16 +256,14 @@ void SWManipulationWorker::startLoop()
                             }
                             else
                             {
-                                m_oStartBottleMutex.lockForWrite();
-                                    m_vBStartBottlesOutSend[ii] = false;
-                                m_oStartBottleMutex.unlock();
+                                m_vAI32StartBottlesOutSend[ii].fetchAndStoreOrdered(0);
                             }
                         }
                         // modified mode : apply modification on bottles, lasts until time total is less than 0
-                        else if(l_vPlanMode[ii] == MODIFIED)
+                        else if(l_oParams.vPlanMode[ii] == MODIFIED)
                         {
                             // update time
-                            m_vTimePlanification[ii] -= m_i32LoopPeriod*0.001;
+                            m_vTimePlanification[ii] -= l_dElapsedTime;
 
                             // check remaining time
                             if(m_vTimePlanification[ii] > 0.0)
@@ -210,21 +273,19 @@ void SWManipulationWorker::startLoop()
                             }
                             else
                             {
-                                m_oStartBottleMutex.lockForWrite();
-                                    m_vBStartBottlesOutSend[ii] = false;
-                                m_oStartBottleMutex.unlock();
+                                m_vAI32StartBottlesOutSend[ii].fetchAndStoreOrdered(0);
                             }
                         }
                          // random mode : ...
-                        else if(l_vPlanMode[ii] == RANDOM)
+                        else if(l_oParams.vPlanMode[ii] == RANDOM)
                         {
                             // ...
                         }
                         // sequence mode : analyse the current sequence to check if the modification must be done, last until the cumulated times of the sequences is less than 0
-                        else if(l_vPlanMode[ii] == SEQUENCE)
+                        else if(l_oParams.vPlanMode[ii] == SEQUENCE)
                         {
                             // update time
-                            m_vTimePlanificationSequence[ii] -= m_i32LoopPeriod*0.001;
+                            m_vTimePlanificationSequence[ii] -= l_dElapsedTime;
 
                             // check remaining time
                             if(m_vTimePlanificationSequence[ii] > 0.0)
@@ -232,7 +293,7 @@ void SWManipulationWorker::startLoop()
                                 l_vDO[ii] = true;
 
                                 // define current modifier
-                                m_vPlanModifier[ii] = sequencePartModifier(m_vTimePlanificationSequence[ii], ii);
+                                m_vPlanModifier[ii] = sequencePartModifier(l_oParams, m_vTimePlanificationSequence[ii], ii);
 
                                 if(m_vPlanModifier[ii] != NO_MODIF)
                                 {
@@ -241,50 +302,49 @@ void SWManipulationWorker::startLoop()
                             }
                             else
                             {
-                                m_oStartBottleMutex.lockForWrite();
-                                    m_vBStartBottlesOutSend[ii] = false;
-                                m_oStartBottleMutex.unlock();
+                                m_vAI32StartBottlesOutSend[ii].fetchAndStoreOrdered(0);
                             }
                         }
                     }
                     else
                     {
                         // if no start planification update the total time with the current value
-                        m_vTimePlanification[ii]         = l_vPlanTimeTotal[ii];
-                        m_vTimePlanificationSequence[ii] = addAllTimeSequence(ii);
+                        m_vTimePlanification[ii]         = l_oParams.vPlanTimeTotal[ii];
+                        m_vTimePlanificationSequence[ii] = addAllTimeSequence(l_oParams, ii);
                     }
                 }
 
         // send bottles to the manipulation/outX ports
             for(int ii = 0; ii < m_i32ConnectionsNb; ++ii)
-            {    
+            {
+                // only the newly received bottles are modified and sent
+                    if(!l_vBottlesReceive[ii])
+                    {
+                        continue;
+                    }
+
                 // apply modifier on the bottle
                     if(l_vMODIFIED[ii])
                     {
                         if(m_vPlanModifier[ii] == DAMPING || m_vPlanModifier[ii] == DAMPING_AND_SHIFT)
                         {
-                            applyDampingOnBottle(m_vBottlesContent[ii], l_vVDamping[ii]);
+                            applyDampingOnBottle(m_vBottlesContent[ii], l_oParams.vVDamping[ii]);
                         }
 
                         if(m_vPlanModifier[ii] == SHIFT || m_vPlanModifier[ii] == DAMPING_AND_SHIFT)
                         {
-                            applyShiftOnBottle(m_vBottlesContent[ii], l_vVShift[ii]);
+                            applyShiftOnBottle(m_vBottlesContent[ii], l_oParams.vVShift[ii]);
                         }
                     }
 
-                // if port is active and planification says to do it and the bottle is received
-                    if(l_vBActiveBottlesOUTSend[ii] && l_vDO[ii] && l_vBottlesReceive[ii])
+                // if port is active and planification says to do it
+                    if(l_oParams.vBActiveBottlesOUTSend[ii] && l_vDO[ii])
                     {
-                        yarp::os::Bottle &l_oBottle = m_vManipulationOUTPort[ii]->prepare();
-                        l_oBottle.clear();
-
-                         // device lib id
-                        l_oBottle.addInt(m_vBottlesContent[ii].idLib);
-
-                        for(uint jj = 0; jj < m_vBottlesContent[ii].dValues.size(); ++jj)
-                        {
-                            l_oBottle.addDouble(m_vBottlesContent[ii].dValues[jj]);
-                        }
+                        // device lib id, then the values with the format of the received bottle
+                        const SWBottleContent &l_oContent = m_vBottlesContent[ii];
+                        swTracking::encodeBottle(m_vManipulationOUTPort[ii]->prepare(), l_oContent.format, l_oContent.idLib,
+                                                 l_oContent.dValues.empty() ? NULL : &l_oContent.dValues[0], static_cast<int>(l_oContent.dValues.size()),
+                                                 m_vOUTBottleBuffer);
 
                         m_vManipulationOUTPort[ii]->write();
                     }
@@ -301,7 +361,7 @@ void SWManipulationWorker::startLoop()
 
                 double l_dTime = m_vTimePlanification[ii];
 
-                if(l_vPlanMode[ii] == SEQUENCE)
+                if(l_oParams.vPlanMode[ii] == SEQUENCE)
                 {
                         l_dTime = m_vTimePlanificationSequence[ii];
                 }
@@ -309,22 +369,21 @@ void SWManipulationWorker::startLoop()
                 emit planificationState(ii, l_vDO[ii], m_vPlanModifier[ii], l_dTime);
             }
 
-        // check end of the loop
-            m_oLoopMutex.lockForRead();
-                l_bDoLoop = m_bDoLoop;
-            m_oLoopMutex.unlock();
+        // the snapshot is not used anymore in this iteration
+            m_aI32LoopEpoch.fetchAndAddOrdered(1);
     }
 }
 
 void SWManipulationWorker::stopLoop()
 {
-    m_oLoopMutex.lockForWrite();
-        m_bDoLoop = false;
-    m_oLoopMutex.unlock();
+    m_oInputMutex.lock();
+        m_aI32DoLoop.fetchAndStoreOrdered(0);
+        m_oInputCondition.wakeAll();
+    m_oInputMutex.unlock();
 }
 
 
-void SWManipulationWorker::applyDampingOnBottle(SWBottleContent &oBottleContent, QVector<double> vDDamping)
+void SWManipulationWorker::applyDampingOnBottle(SWBottleContent &oBottleContent, const QVector<double> &vDDamping)
 {
     for(uint ii = 0; ii < oBottleContent.dValues.size(); ++ii)
     {
@@ -332,7 +391,7 @@ void SWManipulationWorker::applyDampingOnBottle(SWBottleContent &oBottleContent,
     }
 }
 
-void SWManipulationWorker::applyShiftOnBottle(SWBottleContent &oBottleContent, QVector<double> vDShifts)
+void SWManipulationWorker::applyShiftOnBottle(SWBottleContent &oBottleContent, const QVector<double> &vDShifts)
 {
     for(uint ii = 0; ii < oBottleContent.dValues.size(); ++ii)
     {
@@ -341,45 +400,51 @@ void SWManipulationWorker::applyShiftOnBottle(SWBottleContent &oBottleContent, Q
 }
 
 
-bool SWManipulationWorker::retrieveBottleContent(SWBottleContent &oBottleContent, yarp::os::BufferedPort<yarp::os::Bottle> &oPort)
+void SWManipulationWorker::retrieveBottleContent(SWBottleContent &oBottleContent, const yarp::os::Bottle &oBottle) const
 {
-    yarp::os::Bottle *l_pIN = NULL;
-
-    l_pIN = oPort.read(false);
+    // list and binary bottles, the values vector capacity is reused
+    swTracking::decodeBottle(oBottle, oBottleContent.idLib, oBottleContent.dValues, oBottleContent.format);
+}
 
-    if(!l_pIN)
-    {
-        return false;
-    }
+void SWManipulationWorker::updateModifier(QVector<double> vShifts, QVector<double> vConsts, int i32Index)
+{
+    QMutexLocker l_oLocker(&m_oPublishMutex);
 
-    oBottleContent.idLib = l_pIN->get(0).asInt();
-    std::vector<double> l_vDValues;
-    for(int ii = 1; ii < l_pIN->size(); ++ii)
+    const SWManipulationParams *l_pParams = acquireParams();
+    if(l_pParams->vVDamping[i32Index] == vShifts && l_pParams->vVShift[i32Index] == vConsts)
     {
-        l_vDValues.push_back(l_pIN->get(ii).asDouble());
+        return;
     }
-    oBottleContent.dValues = l_vDValues;
 
-    return true;
-}
-
-void SWManipulationWorker::updateModifier(QVector<double> vShifts, QVector<double> vConsts, int i32Index)
-{
-    m_oModifiersMutex.lockForWrite();
-        m_vVDamping[i32Index]   = vShifts;
-        m_vVShift[i32Index] = vConsts;
-    m_oModifiersMutex.unlock();
+    SWManipulationParams *l_pNewParams = new SWManipulationParams(*l_pParams);
+    l_pNewParams->vVDamping[i32Index]   = vShifts;
+    l_pNewParams->vVShift[i32Index] = vConsts;
+    publishParams(l_pNewParams);
 }
 
 void SWManipulationWorker::updatePlanification(int i32Index, int i32Mode, int i32Modifier, double dTimeTotal, double dTimeBlock, QString sSequence)
 {
-    m_oModifiersMutex.lockForWrite();
-        m_vPlanMode[i32Index]      = i32Mode;
-        m_vPlanTimeTotal[i32Index] = dTimeTotal;
-        m_vPlanTimeBlock[i32Index] = dTimeBlock;
-        sequencePartTimeModifier(sSequence, m_vPlanSequenceTime[i32Index], m_vPlanSequenceModifier[i32Index]);
-        m_vPlanModifier[i32Index]  = i32Modifier;
-    m_oModifiersMutex.unlock();
+    QVector<int> l_vSequenceTime, l_vSequenceModifier;
+    sequencePartTimeModifier(sSequence, l_vSequenceTime, l_vSequenceModifier);
+
+    QMutexLocker l_oLocker(&m_oPublishMutex);
+
+    const SWManipulationParams *l_pParams = acquireParams();
+    if(l_pParams->vPlanMode[i32Index] == i32Mode && l_pParams->vPlanTimeTotal[i32Index] == dTimeTotal && l_pParams->vPlanTimeBlock[i32Index] == dTimeBlock &&
+       l_pParams->vPlanModifier[i32Index] == i32Modifier && l_pParams->vPlanSequenceTime[i32Index] == l_vSequenceTime &&
+       l_pParams->vPlanSequenceModifier[i32Index] == l_vSequenceModifier)
+    {
+        return;
+    }
+
+    SWManipulationParams *l_pNewParams = new SWManipulationParams(*l_pParams);
+    l_pNewParams->vPlanMode[i32Index]      = i32Mode;
+    l_pNewParams->vPlanTimeTotal[i32Index] = dTimeTotal;
+    l_pNewParams->vPlanTimeBlock[i32Index] = dTimeBlock;
+    l_pNewParams->vPlanSequenceTime[i32Index]     = l_vSequenceTime;
+    l_pNewParams->vPlanSequenceModifier[i32Index] = l_vSequenceModifier;
+    l_pNewParams->vPlanModifier[i32Index]  = i32Modifier;
+    publishParams(l_pNewParams);
 }
 
 void SWManipulationWorker::sequencePartTimeModifier(const QString &sSequence, QVector<int> &vI32Times, QVector<int> &vI32Modifiers) const
@@ -442,15 +507,15 @@ void SWManipulationWorker::sequencePartTimeModifier(const QString &sSequence, QV
 }
 
 
-int SWManipulationWorker::sequencePartModifier(double dCurrentTime, cint i32IndexSequence) const
+int SWManipulationWorker::sequencePartModifier(const SWManipulationParams &oParams, double dCurrentTime, cint i32IndexSequence) const
 {
-    for(int ii = 0; ii < m_vPlanSequenceTime[i32IndexSequence].size(); ++ii)
+    for(int ii = 0; ii < oParams.vPlanSequenceTime[i32IndexSequence].size(); ++ii)
     {
-        dCurrentTime -= m_vPlanSequenceTime[i32IndexSequence][ii];
+        dCurrentTime -= oParams.vPlanSequenceTime[i32IndexSequence][ii];
 
         if(dCurrentTime < 0)
         {
-            return m_vPlanSequenceModifier[i32IndexSequence][ii];
+            return oParams.vPlanSequenceModifier[i32IndexSequence][ii];
         }
     }
 
@@ -458,19 +523,19 @@ int SWManipulationWorker::sequencePartModifier(double dCurrentTime, cint i32Inde
 }
 
 
-double SWManipulationWorker::addAllTimeSequence(cint i32IndexSequence) const
+double SWManipulationWorker::addAllTimeSequence(const SWManipulationParams &oParams, cint i32IndexSequence) const
 {
     double l_dTotal = 0.0;
 
-    for(int ii = 0; ii < m_vPlanSequenceTime[i32IndexSequence].size(); ++ii)
+    for(int ii = 0; ii < oParams.vPlanSequenceTime[i32IndexSequence].size(); ++ii)
     {
-        if(m_vPlanSequenceTime[i32IndexSequence][ii] < 0)
+        if(oParams.vPlanSequenceTime[i32IndexSequence][ii] < 0)
         {
-            l_dTotal -= m_vPlanSequenceTime[i32IndexSequence][ii];
+            l_dTotal -= oParams.vPlanSequenceTime[i32IndexSequence][ii];
         }
         else
         {
-            l_dTotal += m_vPlanSequenceTime[i32IndexSequence][ii];
+            l_dTotal += oParams.vPlanSequenceTime[i32IndexSequence][ii];
         }
     }
 
@@ -480,16 +545,16 @@ double SWManipulationWorker::addAllTimeSequence(cint i32IndexSequence) const
 
 void SWManipulationWorker::toggleOutPort(int i32IndexPort)
 {
-    m_oActiveBottleMutex.lockForWrite();
-        m_vBActiveBottlesOUTSend[i32IndexPort] = !m_vBActiveBottlesOUTSend[i32IndexPort];
-    m_oActiveBottleMutex.unlock();
+    QMutexLocker l_oLocker(&m_oPublishMutex);
+
+    SWManipulationParams *l_pNewParams = new SWManipulationParams(*acquireParams());
+    l_pNewParams->vBActiveBottlesOUTSend[i32IndexPort] = !l_pNewParams->vBActiveBottlesOUTSend[i32IndexPort];
+    publishParams(l_pNewParams);
 }
 
 void SWManipulationWorker::updateBottleStart(int i32IndexPort, bool bStart)
 {
-    m_oStartBottleMutex.lockForWrite();
-        m_vBStartBottlesOutSend[i32IndexPort] = bStart;
-    m_oStartBottleMutex.unlock();
+    m_vAI32StartBottlesOutSend[i32IndexPort].fetchAndStoreOrdered(bStart ? 1 : 0);
 }
 
 // ########################### SWManipulationInterface
@@ -632,7 +697,7 @@ SWManipulationInterface::SWManipulationInterface(QApplication *parent) : m_uiMan
             QObject::connect(m_uiManipulation->actionAbout, SIGNAL(triggered()), this, SLOT(openAboutWindow()));
         //  loop -> start/stop
             QObject::connect(this, SIGNAL(startLoop()), m_pWManipulation, SLOT(startLoop()));
-            QObject::connect(this, SIGNAL(stopLoop()), m_pWManipulation, SLOT(stopLoop()));
+            QObject::connect(this, SIGNAL(stopLoop()), m_pWManipulation, SLOT(stopLoop()), Qt::DirectConnection);
         //  push buttons
             QObject::connect(m_uiManipulation->pbResetDefaultValues,    SIGNAL(clicked()), this, SLOT(resetModifiers()));
             QObject::connect(m_uiManipulation->pbResetDefaultValuesAll, SIGNAL(clicked()), this, SLOT(resetAllModifiers()));
@@ -648,19 +713,20 @@ SWManipulationInterface::SWManipulationInterface(QApplication *parent) : m_uiMan
         // modifiers
         //  listWidget
             QObject::connect(m_uiManipulation->lwManipulation, SIGNAL(currentRowChanged(int)), SLOT(switchDisplayModifiersValues(int)));
+        //  (the worker loop doesn't process events anymore, the parameters slots are called directly and publish a new snapshot)
         //  update modifiers
-            QObject::connect(this, SIGNAL(sendBottleModifiers(QVector<double>, QVector<double>, int)), m_pWManipulation, SLOT(updateModifier(QVector<double>, QVector<double>, int)));
+            QObject::connect(this, SIGNAL(sendBottleModifiers(QVector<double>, QVector<double>, int)), m_pWManipulation, SLOT(updateModifier(QVector<double>, QVector<double>, int)), Qt::DirectConnection);
         //  udpate planification params
             QObject::connect(this, SIGNAL(sendPlanificationParams(int, int, int, double, double, QString)),
-                             m_pWManipulation, SLOT(updatePlanification(int, int, int, double, double, QString)));;
-            QObject::connect(this, SIGNAL(startBottlePlan(int, bool)), m_pWManipulation, SLOT(updateBottleStart(int, bool)));
+                             m_pWManipulation, SLOT(updatePlanification(int, int, int, double, double, QString)), Qt::DirectConnection);
+            QObject::connect(this, SIGNAL(startBottlePlan(int, bool)), m_pWManipulation, SLOT(updateBottleStart(int, bool)), Qt::DirectConnection);
         //  active click buttons
             for(int ii = 0; ii < m_i32YarpConnectNumber; ++ii)
             {
                 QObject::connect(m_vActiveButtons[ii], SIGNAL(pressed()), this, SLOT(checkActiveClick()));
             }
         //  open / close out ports
-            QObject::connect(this, SIGNAL(activeOutput(int)), m_pWManipulation, SLOT(toggleOutPort(int)));
+            QObject::connect(this, SIGNAL(activeOutput(int)), m_pWManipulation, SLOT(toggleOutPort(int)), Qt::DirectConnection);
 
         // init thread
             m_pWManipulation->moveToThread(&m_TManipulation);
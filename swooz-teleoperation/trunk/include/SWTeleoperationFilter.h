@@ -0,0 +1,77 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWTeleoperationFilter.h
+ * \brief Defines readFilterParams, configuration of the teleoperation targets filters from the module ini file.
+ */
+
+#ifndef _SWTELEOPERATIONFILTER_
+#define _SWTELEOPERATIONFILTER_
+
+#include <string>
+
+// SWOOZ
+#include "commonTypes.h"
+#include "filterUtility.h"
+
+// YARP
+#include <yarp/os/ResourceFinder.h>
+#include <yarp/os/Value.h>
+
+namespace swTeleop
+{
+    /**
+     * \brief Read the filter parameters of a robot part, for example with sPart = "head" :
+     *        headFilter (0 : none, 1 : One-Euro, 2 : alpha-beta), headFilterMinCutoff, headFilterSpeedCoeff, headFilterDerivateCutoff,
+     *        headFilterAlpha, headFilterBeta and headFilterLookAhead (s). Without these keys the targets are not filtered.
+     * \param [in] oRf   : resource finder of the module
+     * \param [in] sPart : name of the part, prefix of the keys
+     * \return the filter parameters
+     */
+    inline swUtil::SWFilterParams readFilterParams(yarp::os::ResourceFinder &oRf, const std::string &sPart)
+    {
+        swUtil::SWFilterParams l_oParams;
+
+        int l_i32Type = oRf.check((sPart + "Filter").c_str(), yarp::os::Value(static_cast<int>(swUtil::NO_FILTER)),
+                                  "Targets filter (int : 0 none, 1 One-Euro, 2 alpha-beta)").asInt();
+
+        if(l_i32Type == swUtil::ONE_EURO_FILTER || l_i32Type == swUtil::ALPHA_BETA_FILTER)
+        {
+            l_oParams.m_eType = static_cast<swUtil::SWFilterType>(l_i32Type);
+        }
+
+        l_oParams.m_dOneEuroMinCutoff       = oRf.check((sPart + "FilterMinCutoff").c_str(),     yarp::os::Value(l_oParams.m_dOneEuroMinCutoff),      "One-Euro min cutoff (double, Hz)").asDouble();
+        l_oParams.m_dOneEuroSpeedCoeff      = oRf.check((sPart + "FilterSpeedCoeff").c_str(),    yarp::os::Value(l_oParams.m_dOneEuroSpeedCoeff),     "One-Euro speed coefficient (double)").asDouble();
+        l_oParams.m_dOneEuroDerivateCutoff  = oRf.check((sPart + "FilterDerivateCutoff").c_str(),yarp::os::Value(l_oParams.m_dOneEuroDerivateCutoff), "One-Euro derivate cutoff (double, Hz)").asDouble();
+        l_oParams.m_dAlpha                  = oRf.check((sPart + "FilterAlpha").c_str(),         yarp::os::Value(l_oParams.m_dAlpha),                 "Alpha-beta alpha gain (double)").asDouble();
+        l_oParams.m_dBeta                   = oRf.check((sPart + "FilterBeta").c_str(),          yarp::os::Value(l_oParams.m_dBeta),                  "Alpha-beta beta gain (double)").asDouble();
+        l_oParams.m_dLookAhead              = oRf.check((sPart + "FilterLookAhead").c_str(),     yarp::os::Value(l_oParams.m_dLookAhead),             "Filter look-ahead (double, s)").asDouble();
+
+        return l_oParams;
+    }
+}
+
+#endif
@@ -39,6 +39,8 @@
 
 // SWOOZ
 #include "commonTypes.h"
+#include "kinematicsUtility.h"
+#include "SWTrackingBottle.h"
 
 // YARP
 #include <yarp/os/Network.h>
@@ -59,6 +61,11 @@
 
 #include <yarp/os/Time.h>
 
+#include "icub/SWVelocityControllerTiming.h"
+#include "icub/SWLeapHandAngles.h"
+#include "icub/SWTeleoperationInput.h"
+#include "SWTeleoperationFilter.h"
+
 
 namespace swTeleop
 {
@@ -74,17 +81,30 @@ namespace swTeleop
              * @brief SWArmVelocityController
              * @param pIArmEncoders
              * @param pIArmVelocity
+             * @param pIArmVelocity2     : optional, used to command the enabled joints subset in one call (NULL if not available)
              * @param vArmJointVelocityK
              * @param i32Rate
              */
-            SWArmVelocityController(yarp::dev::IEncoders *pIArmEncoders, yarp::dev::IVelocityControl *pIArmVelocity,
+            SWArmVelocityController(yarp::dev::IEncoders *pIArmEncoders, yarp::dev::IVelocityControl *pIArmVelocity, yarp::dev::IVelocityControl2 *pIArmVelocity2,
                                  std::vector<double> &vArmJointVelocityK,int i32Rate = 10);
 
             /**
-             * @brief run
+             * @brief run : compute the velocity of the enabled joints and send them with one multi-joint call,
+             *  each enabled joint is commanded separately only if the IVelocityControl2 interface is not available
              */
             void run();
 
+            /**
+             * @brief threadRelease : display the last timing report (verbose mode only)
+             */
+            void threadRelease();
+
+            /**
+             * @brief timing : per-tick statistics of the controller, the reports are displayed only in verbose mode
+             * @return a reference on the controller timing
+             */
+            SWVelocityControllerTiming &timing();
+
             /**
              * @brief setNewCommand
              * @param vArmCommand
@@ -107,9 +127,18 @@ namespace swTeleop
             yarp::os::Mutex m_oMutex;                      /**< ... */
             yarp::dev::IEncoders *m_pIArmEncoders;         /**< ... */
             yarp::dev::IVelocityControl *m_pIArmVelocity;  /**< ... */
+            yarp::dev::IVelocityControl2 *m_pIArmVelocity2;/**< subset velocity control, NULL if not available */
             yarp::sig::Vector m_vLastArmJoint;             /**< ... */
 
             std::vector<double> m_vArmJointVelocityK;      /**< ... */
+
+            int m_i32JointsNb;                              /**< number of axes of the controlled part */
+            yarp::sig::Vector m_vJoints;                    /**< preallocated copy of the last joints targets */
+            yarp::sig::Vector m_vEncoders;                  /**< preallocated encoders buffer */
+            yarp::sig::Vector m_vCommand;                   /**< preallocated masked velocity command */
+            std::vector<int> m_vEnabledJoints;              /**< preallocated ids of the enabled joints */
+            std::vector<double> m_vEnabledCommand;          /**< preallocated velocity command of the enabled joints */
+            SWVelocityControllerTiming m_oTiming;           /**< per-tick duration and overruns */
     };
 
     /**
@@ -141,11 +170,18 @@ namespace swTeleop
             bool init( yarp::os::ResourceFinder &oRf, bool bLeftArm = true);
 
             /**
-             * @brief checkBottles
+             * @brief checkBottles : the bottles are read by the port callback, only the module state is checked here
              * @return
              */
             bool checkBottles();
 
+            /**
+             * @brief onBottle, called by the port thread as soon as a bottle is received, updates the target joints
+             * @param [in] i32Input : input port id
+             * @param [in] oBottle  : received bottle
+             */
+            void onBottle(cint i32Input, yarp::os::Bottle &oBottle);
+
             /**
              * @brief resetArmPosition
              * @return
@@ -167,19 +203,27 @@ namespace swTeleop
 
         private :
 
+            typedef SWBottleReader<SWIcubArm>::Reader SWArmReader; /**< reader of the bottles of one device */
+
             /**
-             * @brief Compute the arm/hand angles values with an input hand yarp bottle
-             * @param [in] handBottle    : hand yarp bottle pointer
-             * @param [out] vHandAngles  : hand angles array
+             * @brief Resolve the reader of the hand fingers port with the device library id.
+             * @param [in] i32DeviceId : device library id
+             * @return the reader, NULL if the device is not supported (the default position is then sent)
              */
-            void computeHandAngles(yarp::os::Bottle* handBottle,std::vector<double> &vHandAngles);
+            static SWArmReader handFingersReader(cint i32DeviceId);
 
             /**
-             * @brief Compute the finger angles values with an input hand finger yarp bottle
-             * @param [in] handFingerBottle : hand fingers  yarp bottle pointer
-             * @param [out] vFingerAngles   : finger angles array
+             * @brief Write the hand and fingers joints from a leap bottle
+             * @param [in] oBottle : hand fingers bottle
              */
-            void computeFingerAngles(yarp::os::Bottle* handFingerBottle,std::vector<double> &vFingerAngles);
+            void readHandFingersLeap(yarp::os::Bottle &oBottle);
+
+            /**
+             * @brief Read all the values used by the hand and finger angles computing in one pass over the decoded bottle
+             * @param [in] oHandValues : decoded hand fingers bottle (list or binary format)
+             * @param [out] oHand      : leap hand data
+             */
+            void readLeapHand(const swTracking::SWBottleValues &oHandValues, SWLeapHandData &oHand) const;
 
             bool m_bInitialized;                /**< is the module initialized */
             bool m_bIsRunning;                  /**< is the module running */
@@ -227,6 +271,7 @@ namespace swTeleop
             yarp::dev::IEncoders        *m_pIArmEncoders;                           /**< arm encoder pointer */
             yarp::dev::IPositionControl *m_pIArmPosition;                           /**< arm position control pointer */
             yarp::dev::IVelocityControl *m_pIArmVelocity;                           /**< arm velocity control pointer */
+            yarp::dev::IVelocityControl2 *m_pIArmVelocity2;                         /**< arm subset velocity control pointer, optional */
             yarp::dev::PolyDriver        m_oRobotArm;                               /**< robot arm controller */
 
             // yarp ports / bottles
@@ -240,6 +285,15 @@ namespace swTeleop
 
             SWArmVelocityController *m_pVelocityController;                         /**< velocity controller class pointer */
 
+            // event-driven input
+            yarp::os::Mutex m_oInputMutex;                                          /**< protects the target joints and the controller commands */
+            yarp::sig::Vector m_vArmJoints;                                         /**< target joints of the arm */
+            yarp::sig::Vector m_vArmFilteredJoints;                                 /**< filtered and cropped joints sent to the velocity controller, kept apart from the raw targets */
+            swTracking::SWBottleValues m_oBottleValues;                             /**< decoder of the received bottles, storage reused between the bottles */
+            swUtil::SWSignalFilter m_oArmFilter;                                    /**< filter of the arm and fingers target joints */
+            SWBottleReader<SWIcubArm> m_oHandFingersReader;                         /**< hand fingers port reader */
+            SWInputCallback<SWIcubArm> *m_pHandFingersCallback;                     /**< hand fingers port callback */
+
             std::string m_sArm;                                                     /**< indicates if left or right arm */
     };
 }
@@ -58,6 +58,10 @@
 
 #include <yarp/os/Time.h>
 
+#include "icub/SWVelocityControllerTiming.h"
+#include "icub/SWTeleoperationInput.h"
+#include "SWTeleoperationFilter.h"
+
 
 namespace swTeleop
 {
@@ -131,17 +135,30 @@ namespace swTeleop
              * @brief SWVelocityController
              * @param pIHeadEncoders
              * @param pIHeadVelocity
+             * @param pIHeadVelocity2     : optional, used to command the enabled joints subset in one call (NULL if not available)
              * @param vHeadJointVelocityK
              * @param i32Rate
              */
-            SWHeadVelocityController(yarp::dev::IEncoders *pIHeadEncoders, yarp::dev::IVelocityControl *pIHeadVelocity,
+            SWHeadVelocityController(yarp::dev::IEncoders *pIHeadEncoders, yarp::dev::IVelocityControl *pIHeadVelocity, yarp::dev::IVelocityControl2 *pIHeadVelocity2,
                                  std::vector<double> &vHeadJointVelocityK, int i32Rate = 10);
 
             /**
-             * @brief run
+             * @brief run : compute the velocity of the enabled joints and send them with one multi-joint call,
+             *  each enabled joint is commanded separately only if the IVelocityControl2 interface is not available
              */
             void run();
 
+            /**
+             * @brief threadRelease : display the last timing report (verbose mode only)
+             */
+            void threadRelease();
+
+            /**
+             * @brief timing : per-tick statistics of the controller, the reports are displayed only in verbose mode
+             * @return a reference on the controller timing
+             */
+            SWVelocityControllerTiming &timing();
+
             /**
              * @brief setNewCommand
              * @param vHeadCommand
@@ -176,11 +193,20 @@ namespace swTeleop
             yarp::os::Mutex m_oMutex;                       /**< ... */
             yarp::dev::IEncoders *m_pIHeadEncoders;         /**< ... */
             yarp::dev::IVelocityControl *m_pIHeadVelocity;  /**< ... */
+            yarp::dev::IVelocityControl2 *m_pIHeadVelocity2;/**< subset velocity control, NULL if not available */
             yarp::sig::Vector m_vLastHeadJoint;             /**< ... */
 
             std::vector<double> m_vHeadJointVelocityK;      /**< ... */
             std::vector<double> m_vMinJoints;
             std::vector<double> m_vMaxJoints;
+
+            int m_i32JointsNb;                              /**< number of axes of the controlled part */
+            yarp::sig::Vector m_vJoints;                    /**< preallocated copy of the last joints targets */
+            yarp::sig::Vector m_vEncoders;                  /**< preallocated encoders buffer */
+            yarp::sig::Vector m_vCommand;                   /**< preallocated masked velocity command */
+            std::vector<int> m_vEnabledJoints;              /**< preallocated ids of the enabled joints */
+            std::vector<double> m_vEnabledCommand;          /**< preallocated velocity command of the enabled joints */
+            SWVelocityControllerTiming m_oTiming;           /**< per-tick duration and overruns */
     };
 
     /**
@@ -211,11 +237,18 @@ namespace swTeleop
             bool init( yarp::os::ResourceFinder &oRf);
 
             /**
-             * @brief checkBottles
+             * @brief checkBottles : the bottles are read by the ports callbacks, only the reset timeouts are managed here
              * @return
              */
             bool checkBottles();
 
+            /**
+             * @brief onBottle, called by the port threads as soon as a bottle is received, updates the target joints
+             * @param [in] i32Input : input port id (SWHeadInput)
+             * @param [in] oBottle  : received bottle
+             */
+            void onBottle(cint i32Input, yarp::os::Bottle &oBottle);
+
             /**
              * @brief resetHeadPosition
              * @return
@@ -247,6 +280,51 @@ namespace swTeleop
 
         private :
 
+            /**
+             * @brief The SWHeadInput enum, input ports of the head
+             */
+            enum SWHeadInput
+            {
+                HEAD_INPUT, GAZE_INPUT, FACE_INPUT
+            };
+
+            typedef SWBottleReader<SWIcubHead>::Reader SWHeadReader; /**< reader of the bottles of one device */
+
+            /**
+             * @brief Resolve the readers of each input port with the device library id.
+             * @param [in] i32DeviceId : device library id
+             * @return the reader, NULL if the device is not supported by the port
+             */
+            static SWHeadReader headReader(cint i32DeviceId);
+            static SWHeadReader gazeReader(cint i32DeviceId);
+            static SWHeadReader faceReader(cint i32DeviceId);
+
+            // head readers, write the head joints
+            void readHeadDummy(yarp::os::Bottle &oBottle);
+            void readHeadFastrak(yarp::os::Bottle &oBottle);
+            void readHeadOculus(yarp::os::Bottle &oBottle);
+            void readHeadForest(yarp::os::Bottle &oBottle);
+            void readHeadCoredata(yarp::os::Bottle &oBottle);
+            void readHeadEmicp(yarp::os::Bottle &oBottle);
+            void readHeadFaceshift(yarp::os::Bottle &oBottle);
+            void readHeadOpenni(yarp::os::Bottle &oBottle);
+
+            // gaze readers, write the eyes joints and the eyelids
+            void readGazeFaceshift(yarp::os::Bottle &oBottle);
+            void readGazeDummy(yarp::os::Bottle &oBottle);
+            void readGazeTobii(yarp::os::Bottle &oBottle);
+            void readGazeCoredata(yarp::os::Bottle &oBottle);
+
+            // face readers, send the LED commands
+            void readFaceFaceshift(yarp::os::Bottle &oBottle);
+            void readFaceCoredata(yarp::os::Bottle &oBottle);
+
+            /**
+             * @brief sendFaceCommand, send a command to the face handler port, shared by the port threads and the module thread
+             * @param [in] sCommand : command
+             */
+            void sendFaceCommand(const std::string &sCommand);
+
 
             /**
              * \brief The eyesOpeningCode function transforms a percentage of opening eyelids
@@ -345,10 +423,25 @@ namespace swTeleop
             yarp::dev::IEncoders        *m_pIHeadEncoders;  /**< ... */
             yarp::dev::IPositionControl *m_pIHeadPosition;  /**< ... */
             yarp::dev::IVelocityControl *m_pIHeadVelocity;  /**< ... */
+            yarp::dev::IVelocityControl2 *m_pIHeadVelocity2;/**< optional subset velocity control */
 
 
             SWHeadVelocityController *m_pVelocityController;    /**< ... */
             SWIcubFaceLabLEDCommand m_ICubFaceLabLED;       /**< ... */
+
+            // event-driven input
+            yarp::os::Mutex m_oInputMutex;                  /**< protects the target joints, the last bottles times and the controller commands */
+            yarp::os::Mutex m_oFaceHandlerMutex;            /**< protects the face handler port */
+            yarp::sig::Vector m_vHeadJoints;                /**< last target joints of the head and the eyes */
+            yarp::sig::Vector m_vHeadFilteredJoints;        /**< filtered and cropped joints sent to the velocity controller, kept apart from the raw targets */
+            swUtil::SWSignalFilter m_oHeadFilter;           /**< filter of the head target joints (neck pitch, roll, yaw) */
+            swUtil::SWSignalFilter m_oGazeFilter;           /**< filter of the gaze target joints (eyes tilt, version, vergence) */
+            SWBottleReader<SWIcubHead> m_oHeadReader;       /**< head port reader */
+            SWBottleReader<SWIcubHead> m_oGazeReader;       /**< gaze port reader */
+            SWBottleReader<SWIcubHead> m_oFaceReader;       /**< face port reader */
+            SWInputCallback<SWIcubHead> *m_pHeadCallback;   /**< head port callback */
+            SWInputCallback<SWIcubHead> *m_pGazeCallback;   /**< gaze port callback */
+            SWInputCallback<SWIcubHead> *m_pFaceCallback;   /**< face port callback */
     };
 }
 
@@ -60,6 +60,10 @@
 
 #include <yarp/os/Time.h>
 
+#include "icub/SWVelocityControllerTiming.h"
+#include "icub/SWTeleoperationInput.h"
+#include "SWTeleoperationFilter.h"
+
 
 namespace swTeleop
 {
@@ -81,10 +85,21 @@ namespace swTeleop
                                  std::vector<double> &vTorsoJointVelocityK, int i32Rate = 10);
 
             /**
-             * @brief run
+             * @brief run : compute the velocity of the enabled joints, sent with one multi-joint call when every joint is enabled
              */
             void run();
 
+            /**
+             * @brief threadRelease : display the last timing report (verbose mode only)
+             */
+            void threadRelease();
+
+            /**
+             * @brief timing : per-tick statistics of the controller, the reports are displayed only in verbose mode
+             * @return a reference on the controller timing
+             */
+            SWVelocityControllerTiming &timing();
+
             /**
              * @brief setNewCommand
              * @param vHeadCommand
@@ -107,6 +122,12 @@ namespace swTeleop
             yarp::sig::Vector m_vLastTorsoJoint;             /**< ... */
 
             std::vector<double> m_vTorsoJointVelocityK;      /**< ... */
+
+            int m_i32JointsNb;                              /**< number of axes of the controlled part */
+            yarp::sig::Vector m_vJoints;                    /**< preallocated copy of the last joints targets */
+            yarp::sig::Vector m_vEncoders;                  /**< preallocated encoders buffer */
+            yarp::sig::Vector m_vCommand;                   /**< preallocated masked velocity command */
+            SWVelocityControllerTiming m_oTiming;           /**< per-tick duration and overruns */
     };
 
     /**
@@ -137,11 +158,18 @@ namespace swTeleop
             bool init( yarp::os::ResourceFinder &oRf);
 
             /**
-             * @brief checkBottles
+             * @brief checkBottles : the bottles are read by the port callback, only the reset timeout is managed here
              * @return
              */
             bool checkBottles();
 
+            /**
+             * @brief onBottle, called by the port thread as soon as a bottle is received, updates the target joints
+             * @param [in] i32Input : input port id
+             * @param [in] oBottle  : received bottle
+             */
+            void onBottle(cint i32Input, yarp::os::Bottle &oBottle);
+
             /**
              * @brief resetTorsoPosition
              * @return
@@ -163,6 +191,19 @@ namespace swTeleop
 
         private :
 
+            typedef SWBottleReader<SWIcubTorso>::Reader SWTorsoReader; /**< reader of the bottles of one device */
+
+            /**
+             * @brief Resolve the reader of the torso port with the device library id.
+             * @param [in] i32DeviceId : device library id
+             * @return the reader, NULL if the device is not supported
+             */
+            static SWTorsoReader torsoReader(cint i32DeviceId);
+
+            // torso readers, write the torso joints
+            void readTorsoDummy(yarp::os::Bottle &oBottle);
+            void readTorsoOpenni(yarp::os::Bottle &oBottle);
+
             bool m_bInitialized;            /**< .... */
             bool m_bIsRunning;              /**< ... */
 
@@ -216,6 +257,14 @@ namespace swTeleop
 
 
             SWTorsoVelocityController *m_pVelocityController;    /**< ... */
+
+            // event-driven input
+            yarp::os::Mutex m_oInputMutex;                  /**< protects the target joints, the last bottle time and the controller commands */
+            yarp::sig::Vector m_vTorsoJoints;               /**< last target joints of the torso */
+            yarp::sig::Vector m_vTorsoFilteredJoints;       /**< filtered and cropped joints sent to the velocity controller, kept apart from the raw targets */
+            swUtil::SWSignalFilter m_oTorsoFilter;          /**< filter of the torso target joints */
+            SWBottleReader<SWIcubTorso> m_oTorsoReader;     /**< torso port reader */
+            SWInputCallback<SWIcubTorso> *m_pTorsoCallback; /**< torso port callback */
     };
 }
 
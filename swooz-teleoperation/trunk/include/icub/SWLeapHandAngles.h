@@ -0,0 +1,72 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWLeapHandAngles.h
+ * \brief Defines the iCub hand and finger angles computing from the Leap hand data, without YARP and without heap allocation.
+ */
+
+#ifndef _SWLEAPHANDANGLES_
+#define _SWLEAPHANDANGLES_
+
+// SWOOZ
+#include "commonTypes.h"
+#include "kinematicsUtility.h"
+
+namespace swTeleop
+{
+    /**
+     * \struct SWLeapHandData
+     * \brief Leap hand values read once from a hand yarp bottle and kept on the stack.
+     */
+    struct SWLeapHandData
+    {
+        swUtil::SWVec3d m_vArmDirection;            /**< arm direction */
+        swUtil::SWVec3d m_vHandDirection;           /**< hand direction */
+        swUtil::SWVec3d m_vHandPalmNormal;          /**< hand palm normal */
+        swUtil::SWVec3d m_vHandPalmNormalE;         /**< hand palm normal euler angles */
+        swUtil::SWVec3d m_aVThumbDirections[3];     /**< thumb bones directions */
+        swUtil::SWVec3d m_aVIndexDirections[4];     /**< index bones directions */
+        swUtil::SWVec3d m_aVMiddleDirections[4];    /**< middle bones directions */
+        swUtil::SWVec3d m_aVPinkyDirections[4];     /**< pinky bones directions */
+    };
+
+    /**
+     * @brief Compute the arm/hand angles values (iCub arm joints 3 to 6) with the leap hand data
+     * @param [in] oHand          : leap hand data
+     * @param [in] bLeftArm       : left arm ? (some signs are mirrored for the right arm)
+     * @param [out] a4DHandAngles : hand angles array
+     */
+    void computeLeapHandAngles(const SWLeapHandData &oHand, cbool bLeftArm, double a4DHandAngles[4]);
+
+    /**
+     * @brief Compute the finger angles values (iCub arm joints 7 to 15) with the leap hand data
+     * @param [in] oHand            : leap hand data
+     * @param [out] a9DFingerAngles : finger angles array
+     */
+    void computeLeapFingerAngles(const SWLeapHandData &oHand, double a9DFingerAngles[9]);
+}
+
+#endif
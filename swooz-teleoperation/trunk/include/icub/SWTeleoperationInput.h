@@ -0,0 +1,133 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWTeleoperationInput.h
+ * \brief Defines SWInputCallback and SWBottleReader, the event-driven input path of the iCub teleoperation parts.
+ */
+
+#ifndef _SWTELEOPERATIONINPUT_
+#define _SWTELEOPERATIONINPUT_
+
+// SWOOZ
+#include "commonTypes.h"
+
+// YARP
+#include <yarp/os/Bottle.h>
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/TypedReaderCallback.h>
+
+namespace swTeleop
+{
+    /**
+     * \class SWInputCallback
+     * \brief YARP reader callback forwarding the bottles of an input port to the teleoperation part owning it,
+     *        TOwner must define void onBottle(cint i32Input, yarp::os::Bottle &oBottle).
+     */
+    template<class TOwner>
+    class SWInputCallback : public yarp::os::TypedReaderCallback<yarp::os::Bottle>
+    {
+        public :
+
+            /**
+             * \brief SWInputCallback constructor
+             * \param [in] pOwner   : part notified for each received bottle
+             * \param [in] i32Input : id of the input port in the part
+             */
+            SWInputCallback(TOwner *pOwner, cint i32Input) : m_pOwner(pOwner), m_i32Input(i32Input)
+            {}
+
+            /**
+             * \brief onRead, called by the YARP port thread as soon as a bottle is received
+             * \param [in] oBottle : received bottle
+             */
+            virtual void onRead(yarp::os::Bottle &oBottle)
+            {
+                m_pOwner->onBottle(m_i32Input, oBottle);
+            }
+
+        private :
+
+            TOwner *m_pOwner;   /**< part to notify */
+            int m_i32Input;     /**< id of the input port */
+    };
+
+    /**
+     * \class SWBottleReader
+     * \brief Reader of an input port, selected with the device library id sent at the beginning of each bottle.
+     *        The id is resolved only when it changes, the following bottles of the same device go straight to the cached reader.
+     */
+    template<class TOwner>
+    class SWBottleReader
+    {
+        public :
+
+            typedef void (TOwner::*Reader)(yarp::os::Bottle &oBottle);  /**< reader of the bottles of one device */
+            typedef Reader (*Resolver)(cint i32DeviceId);               /**< returns the reader of a device, NULL if the device is not supported */
+
+            /**
+             * \brief SWBottleReader constructor
+             * \param [in] pResolver : resolver of the port readers
+             */
+            SWBottleReader(Resolver pResolver) : m_pResolver(pResolver), m_bResolved(false), m_i32DeviceId(0), m_pReader(NULL)
+            {}
+
+            /**
+             * \brief Read a bottle with the reader of its device.
+             * \param [in] pOwner  : part owning the reader
+             * \param [in] oBottle : bottle to read
+             * \return false if the device of the bottle is not supported by the port
+             */
+            bool read(TOwner *pOwner, yarp::os::Bottle &oBottle)
+            {
+                int l_i32DeviceId = oBottle.get(0).asInt();
+
+                if(!m_bResolved || l_i32DeviceId != m_i32DeviceId)
+                {
+                    m_pReader     = m_pResolver(l_i32DeviceId);
+                    m_i32DeviceId = l_i32DeviceId;
+                    m_bResolved   = true;
+                }
+
+                if(!m_pReader)
+                {
+                    return false;
+                }
+
+                (pOwner->*m_pReader)(oBottle);
+
+                return true;
+            }
+
+        private :
+
+            Resolver m_pResolver;   /**< resolver of the port readers */
+            bool m_bResolved;       /**< has a device already been resolved */
+            int m_i32DeviceId;      /**< last resolved device id */
+            Reader m_pReader;       /**< reader of the last resolved device */
+    };
+}
+
+#endif
@@ -0,0 +1,219 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWVelocityControllerTiming.h
+ * \brief Defines SWVelocityControllerTiming, per-tick statistics for the iCub velocity controllers.
+ */
+
+#ifndef _SWVELOCITYCONTROLLERTIMING_
+#define _SWVELOCITYCONTROLLERTIMING_
+
+// STD
+#include <string>
+#include <iostream>
+#include <cmath>
+
+// SWOOZ
+#include "commonTypes.h"
+
+// YARP
+#include <yarp/os/Time.h>
+
+namespace swTeleop
+{
+    /**
+     * \class SWVelocityControllerTiming
+     * \brief Measures the duration of each RateThread tick and counts the overruns against the thread period.
+     *        The statistics are accumulated over windows of dReportPeriod seconds, the summary of each window is only displayed
+     *        in verbose mode, else it can be retrieved with the accessors.
+     */
+    class SWVelocityControllerTiming
+    {
+        public :
+
+            /**
+             * \brief SWVelocityControllerTiming constructor
+             * \param [in] sName          : name displayed in the reports
+             * \param [in] dReportPeriod  : time in seconds between two reports
+             * \param [in] bVerbose       : display the reports
+             */
+            SWVelocityControllerTiming(const std::string &sName, cdouble dReportPeriod = 10.0, cbool bVerbose = false)
+                : m_sName(sName), m_dReportPeriod(dReportPeriod), m_bVerbose(bVerbose), m_dTickStart(0.0), m_dLastReport(-1.0)
+            {
+                reset();
+                m_ui32LastTicksNb    = 0;
+                m_ui32LastOverrunsNb = 0;
+                m_dLastMeanDuration  = 0.0;
+                m_dLastMaxDuration   = 0.0;
+            }
+
+            /**
+             * \brief Enable/disable the display of the reports.
+             * \param [in] bVerbose : display the reports
+             */
+            void setVerbose(cbool bVerbose)
+            {
+                m_bVerbose = bVerbose;
+            }
+
+            /**
+             * \brief Start the measure of a tick.
+             */
+            void startTick()
+            {
+                m_dTickStart = yarp::os::Time::now();
+
+                if(m_dLastReport < 0.0)
+                {
+                    m_dLastReport = m_dTickStart;
+                }
+            }
+
+            /**
+             * \brief Stop the measure of the current tick and close the statistics window if its period is elapsed.
+             * \param [in] dPeriodMs : current period of the rate thread in milliseconds
+             */
+            void stopTick(cdouble dPeriodMs)
+            {
+                double l_dNow      = yarp::os::Time::now();
+                double l_dDuration = 1000.0 * (l_dNow - m_dTickStart);
+
+                ++m_ui32TicksNb;
+                m_dSumDuration   += l_dDuration;
+                m_dSumSqDuration += l_dDuration * l_dDuration;
+
+                if(l_dDuration > m_dMaxDuration)
+                {
+                    m_dMaxDuration = l_dDuration;
+                }
+
+                if(l_dDuration > dPeriodMs)
+                {
+                    ++m_ui32OverrunsNb;
+                }
+
+                if(l_dNow - m_dLastReport >= m_dReportPeriod)
+                {
+                    if(m_bVerbose)
+                    {
+                        display(dPeriodMs);
+                    }
+
+                    m_ui32LastTicksNb    = m_ui32TicksNb;
+                    m_ui32LastOverrunsNb = m_ui32OverrunsNb;
+                    m_dLastMeanDuration  = m_dSumDuration / m_ui32TicksNb;
+                    m_dLastMaxDuration   = m_dMaxDuration;
+
+                    reset();
+                    m_dLastReport = l_dNow;
+                }
+            }
+
+            /**
+             * \brief Return the number of ticks of the last complete statistics window.
+             */
+            uint lastTicksNb() const
+            {
+                return m_ui32LastTicksNb;
+            }
+
+            /**
+             * \brief Return the number of overruns of the last complete statistics window.
+             */
+            uint lastOverrunsNb() const
+            {
+                return m_ui32LastOverrunsNb;
+            }
+
+            /**
+             * \brief Return the mean tick duration (ms) of the last complete statistics window.
+             */
+            double lastMeanDuration() const
+            {
+                return m_dLastMeanDuration;
+            }
+
+            /**
+             * \brief Return the max tick duration (ms) of the last complete statistics window.
+             */
+            double lastMaxDuration() const
+            {
+                return m_dLastMaxDuration;
+            }
+
+            /**
+             * \brief Display the statistics accumulated since the last report (verbose mode only).
+             * \param [in] dPeriodMs : current period of the rate thread in milliseconds
+             */
+            void display(cdouble dPeriodMs) const
+            {
+                if(!m_bVerbose || m_ui32TicksNb == 0)
+                {
+                    return;
+                }
+
+                double l_dMean = m_dSumDuration / m_ui32TicksNb;
+                double l_dVar  = m_dSumSqDuration / m_ui32TicksNb - l_dMean * l_dMean;
+
+                std::cout << "-- " << m_sName << " velocity controller : " << m_ui32TicksNb << " ticks, period " << dPeriodMs
+                          << " ms, tick duration mean " << l_dMean << " ms std " << (l_dVar > 0.0 ? sqrt(l_dVar) : 0.0)
+                          << " ms max " << m_dMaxDuration << " ms, overruns " << m_ui32OverrunsNb << std::endl;
+            }
+
+        private :
+
+            /**
+             * \brief Reset the accumulated statistics.
+             */
+            void reset()
+            {
+                m_ui32TicksNb    = 0;
+                m_ui32OverrunsNb = 0;
+                m_dSumDuration   = 0.0;
+                m_dSumSqDuration = 0.0;
+                m_dMaxDuration   = 0.0;
+            }
+
+            std::string m_sName;            /**< name displayed in the reports */
+            double m_dReportPeriod;         /**< time in seconds between two reports */
+            bool m_bVerbose;                /**< display the reports */
+            double m_dTickStart;            /**< start time of the current tick */
+            double m_dLastReport;           /**< time of the last report */
+
+            uint m_ui32TicksNb;             /**< ticks measured since the last report */
+            uint m_ui32OverrunsNb;          /**< ticks longer than the thread period since the last report */
+            double m_dSumDuration;          /**< sum of the ticks durations (ms) */
+            double m_dSumSqDuration;        /**< sum of the squared ticks durations (ms^2) */
+            double m_dMaxDuration;          /**< max tick duration (ms) */
+
+            uint m_ui32LastTicksNb;         /**< ticks of the last complete window */
+            uint m_ui32LastOverrunsNb;      /**< overruns of the last complete window */
+            double m_dLastMeanDuration;     /**< mean tick duration of the last complete window (ms) */
+            double m_dLastMaxDuration;      /**< max tick duration of the last complete window (ms) */
+    };
+}
+
+#endif
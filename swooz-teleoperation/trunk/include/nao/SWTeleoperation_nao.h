@@ -40,6 +40,9 @@
 
 // SWOOZ
 #include "commonTypes.h"
+#include "SWTeleoperationFilter.h"
+#include "devices/rgbd/SWSkeletonFrame.h"
+#include "SWTrackingBottle.h"
 
 // YARP
 #include <yarp/os/Network.h>
@@ -144,6 +147,15 @@ class SWTeleoperation_nao : public RFModule
 
     private:
 
+        /**
+         * \brief Copy the joints of an OpenNI tracking bottle in the skeleton joints of the current update.
+         * \param [in] pBottle     : tracking bottle, can be NULL
+         * \param [in] aJointsId   : joints of the bottle (swDevice::OPENNI_*_JOINTS)
+         * \param [in] i32JointsNb : number of joints of the bottle
+         * \return true if the bottle is an OpenNI one and has been copied
+         */
+        bool readSkeletonJoints(const yarp::os::Bottle *pBottle, const int *aJointsId, cint i32JointsNb);
+
         bool m_bHeadActivatedDefault;
         bool m_bTorsoActivatedDefault;
         bool m_bLEDSActivatedDefault;
@@ -181,6 +193,8 @@ class SWTeleoperation_nao : public RFModule
         int m_i32HeadTimeoutReset;    /**< head timeout reset nao */
         double m_dJointVelocityValue; /**< ano velocity value */
 
+        swUtil::SWSignalFilter m_oHeadFilter; /**< filter of the head yaw and pitch targets */
+
         // Array for nao's joints
         AL::ALValue m_aHeadAngles;
         AL::ALValue m_aTorsoAngles;
@@ -189,6 +203,17 @@ class SWTeleoperation_nao : public RFModule
         AL::ALValue m_aLLegAngles;
         AL::ALValue m_aRLegAngles;
 
+        // joints names and head targets, built once
+        AL::ALValue m_aHeadNames;           /**< head joints names */
+        AL::ALValue m_aHeadTargetAngles;    /**< head targets of the current update */
+        AL::ALValue m_aTorsoNames;          /**< torso joints names */
+        AL::ALValue m_aLArmName;            /**< left arm chain name */
+        AL::ALValue m_aRArmName;            /**< right arm chain name */
+
+        swUtil::SWVec3d m_aSkeletonJoints[swDevice::UB_JOINTS_NB];  /**< upper body joints gathered from the OpenNI bottles of the current update */
+        swDevice::SWUpperBodyAngles m_oSkeletonAngles;              /**< limbs angles of the gathered joints, computed once per update */
+        swTracking::SWBottleValues m_oRightArmBottleValues;         /**< decoder of the right arm leap bottles (list or binary format), storage reused between the bottles */
+
         std::string m_sModuleName;      /**< name of the mondule (config) */
         std::string m_sRobotAddress;    /**< name of the robot (config) */
 
@@ -16,6 +16,7 @@
 
 // SWOOZ
 //#include "commonTypes.h"
+#include "SWTeleoperationFilter.h"
 
 // YARP
 #include <yarp/os/Network.h>
@@ -135,6 +136,8 @@ class SWTeleoperation_reeti : public RFModule
         int m_i32HeadTimeoutReset;    /**< head timeout reset reeti */
 	int m_i32FaceTimeoutReset;    /**< head timeout reset reeti */
 	int m_i32GazeTimeoutReset;    /**< head timeout reset reeti */
+
+	swUtil::SWSignalFilter m_oHeadFilter; /**< filter of the head target joints */
         
 	// Config variables retrieved from the ini file
         std::string m_sModuleName;      /**< name of the module (config) */
@@ -0,0 +1,354 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWEvaluateFilters.cpp
+ * \brief Offline evaluation of the teleoperation targets filters on a recorded stream :
+ *        lag and jitter of the raw signal and of several One-Euro / alpha-beta configurations.
+ *
+ *  Usage : SWEvaluateFilters <log file> [first value column = 3] [values nb = 3] [time column = 1]
+ *  The log file is a text file with one bottle per line, the default columns are the ones of the yarp dataDumper logs :
+ *  "sequence timestamp deviceId value0 value1 ...".
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+
+#include "filterUtility.h"
+
+namespace
+{
+    const int g_i32ReferenceHalfWindow  = 3;    /**< half size of the centered moving average used as the reference signal */
+    const int g_i32MaxShift             = 30;   /**< max shift (in samples) tested for the lag estimation */
+
+    /**
+     * \brief A recorded stream : acquisition times and values of each channel.
+     */
+    struct SWStream
+    {
+        std::vector<double> m_vTime;                    /**< acquisition times (s) */
+        std::vector<std::vector<double> > m_vValues;    /**< values per channel */
+    };
+
+    /**
+     * \brief Lag and jitter of a signal compared to the reference.
+     */
+    struct SWScore
+    {
+        double m_dLag;      /**< mean lag (ms), negative if the signal is ahead of the reference */
+        double m_dError;    /**< RMS error against the reference once the lag is compensated */
+        double m_dJitter;   /**< RMS of the second difference of the signal */
+    };
+
+    /**
+     * \brief Read a log file.
+     * \param [in]  sPath               : path of the log file
+     * \param [in]  i32FirstValueColumn : column of the first value
+     * \param [in]  i32ValuesNb         : number of values to read
+     * \param [in]  i32TimeColumn       : column of the timestamp
+     * \param [out] oStream             : read stream
+     * \return false if the file can't be read
+     */
+    bool readStream(const std::string &sPath, cint i32FirstValueColumn, cint i32ValuesNb, cint i32TimeColumn, SWStream &oStream)
+    {
+        std::ifstream l_oFile(sPath.c_str());
+
+        if(!l_oFile.is_open())
+        {
+            return false;
+        }
+
+        oStream.m_vTime.clear();
+        oStream.m_vValues = std::vector<std::vector<double> >(i32ValuesNb);
+
+        int l_i32LastColumn = i32FirstValueColumn + i32ValuesNb - 1;
+        if(i32TimeColumn > l_i32LastColumn)
+        {
+            l_i32LastColumn = i32TimeColumn;
+        }
+
+        std::string l_sLine;
+        std::vector<double> l_vColumns(l_i32LastColumn + 1);
+
+        while(std::getline(l_oFile, l_sLine))
+        {
+            // remove the bottles parenthesis
+            for(size_t ii = 0; ii < l_sLine.size(); ++ii)
+            {
+                if(l_sLine[ii] == '(' || l_sLine[ii] == ')')
+                {
+                    l_sLine[ii] = ' ';
+                }
+            }
+
+            std::istringstream l_oLine(l_sLine);
+            int l_i32Column = 0;
+
+            for(; l_i32Column <= l_i32LastColumn; ++l_i32Column)
+            {
+                if(!(l_oLine >> l_vColumns[l_i32Column]))
+                {
+                    break;
+                }
+            }
+
+            // skip incomplete lines and non monotonic timestamps
+            if(l_i32Column <= l_i32LastColumn || (oStream.m_vTime.size() > 0 && l_vColumns[i32TimeColumn] <= oStream.m_vTime.back()))
+            {
+                continue;
+            }
+
+            oStream.m_vTime.push_back(l_vColumns[i32TimeColumn]);
+
+            for(int ii = 0; ii < i32ValuesNb; ++ii)
+            {
+                oStream.m_vValues[ii].push_back(l_vColumns[i32FirstValueColumn + ii]);
+            }
+        }
+
+        return oStream.m_vTime.size() > static_cast<size_t>(2 * g_i32MaxShift + 2 * g_i32ReferenceHalfWindow);
+    }
+
+    /**
+     * \brief Filter a stream, the channels are filtered in the acquisition order as in the teleoperation modules.
+     */
+    void filterStream(const SWStream &oRaw, const swUtil::SWFilterParams &oParams, SWStream &oFiltered)
+    {
+        oFiltered = oRaw;
+
+        swUtil::SWSignalFilter l_oFilter;
+        l_oFilter.reset(static_cast<int>(oRaw.m_vValues.size()), oParams);
+
+        for(size_t ii = 0; ii < oRaw.m_vTime.size(); ++ii)
+        {
+            for(size_t jj = 0; jj < oRaw.m_vValues.size(); ++jj)
+            {
+                oFiltered.m_vValues[jj][ii] = l_oFilter.filter(static_cast<int>(jj), oRaw.m_vValues[jj][ii], oRaw.m_vTime[ii]);
+            }
+        }
+    }
+
+    /**
+     * \brief Build the reference signal : a centered (non causal) moving average of the raw stream, without lag.
+     */
+    void referenceStream(const SWStream &oRaw, SWStream &oReference)
+    {
+        oReference = oRaw;
+
+        int l_i32SamplesNb = static_cast<int>(oRaw.m_vTime.size());
+
+        for(size_t jj = 0; jj < oRaw.m_vValues.size(); ++jj)
+        {
+            for(int ii = 0; ii < l_i32SamplesNb; ++ii)
+            {
+                int l_i32First = ii - g_i32ReferenceHalfWindow < 0 ? 0 : ii - g_i32ReferenceHalfWindow;
+                int l_i32Last  = ii + g_i32ReferenceHalfWindow >= l_i32SamplesNb ? l_i32SamplesNb - 1 : ii + g_i32ReferenceHalfWindow;
+
+                double l_dSum = 0.0;
+                for(int kk = l_i32First; kk <= l_i32Last; ++kk)
+                {
+                    l_dSum += oRaw.m_vValues[jj][kk];
+                }
+
+                oReference.m_vValues[jj][ii] = l_dSum / (l_i32Last - l_i32First + 1);
+            }
+        }
+    }
+
+    /**
+     * \brief Compute the lag, the error and the jitter of a signal.
+     *        The lag is the shift of the reference minimizing the RMS error with the signal.
+     */
+    SWScore score(const SWStream &oSignal, const SWStream &oReference)
+    {
+        SWScore l_oScore;
+
+        int l_i32SamplesNb  = static_cast<int>(oSignal.m_vTime.size());
+        int l_i32ChannelsNb = static_cast<int>(oSignal.m_vValues.size());
+        double l_dPeriod    = (oSignal.m_vTime.back() - oSignal.m_vTime.front()) / (l_i32SamplesNb - 1);
+
+        // lag
+            double l_dBestError = -1.0;
+            int l_i32BestShift  = 0;
+
+            for(int l_i32Shift = -g_i32MaxShift; l_i32Shift <= g_i32MaxShift; ++l_i32Shift)
+            {
+                double l_dSum = 0.0;
+                int l_i32Nb = 0;
+
+                for(int ii = g_i32MaxShift; ii < l_i32SamplesNb - g_i32MaxShift; ++ii)
+                {
+                    for(int jj = 0; jj < l_i32ChannelsNb; ++jj)
+                    {
+                        double l_dDiff = oSignal.m_vValues[jj][ii] - oReference.m_vValues[jj][ii - l_i32Shift];
+                        l_dSum += l_dDiff * l_dDiff;
+                        ++l_i32Nb;
+                    }
+                }
+
+                double l_dError = sqrt(l_dSum / l_i32Nb);
+
+                if(l_dBestError < 0.0 || l_dError < l_dBestError)
+                {
+                    l_dBestError   = l_dError;
+                    l_i32BestShift = l_i32Shift;
+                }
+            }
+
+            l_oScore.m_dLag   = 1000.0 * l_i32BestShift * l_dPeriod;
+            l_oScore.m_dError = l_dBestError;
+
+        // jitter
+            double l_dSum = 0.0;
+            int l_i32Nb = 0;
+
+            for(int ii = 1; ii < l_i32SamplesNb - 1; ++ii)
+            {
+                for(int jj = 0; jj < l_i32ChannelsNb; ++jj)
+                {
+                    double l_dAcc = oSignal.m_vValues[jj][ii + 1] - 2.0 * oSignal.m_vValues[jj][ii] + oSignal.m_vValues[jj][ii - 1];
+                    l_dSum += l_dAcc * l_dAcc;
+                    ++l_i32Nb;
+                }
+            }
+
+            l_oScore.m_dJitter = sqrt(l_dSum / l_i32Nb);
+
+        return l_oScore;
+    }
+
+    /**
+     * \brief Display the score of a configuration.
+     */
+    void displayScore(const std::string &sName, const SWScore &oScore)
+    {
+        printf("%-40s %10.1f %12.4f %12.4f\n", sName.c_str(), oScore.m_dLag, oScore.m_dError, oScore.m_dJitter);
+    }
+
+    swUtil::SWFilterParams oneEuro(cdouble dMinCutoff, cdouble dSpeedCoeff, cdouble dLookAhead)
+    {
+        swUtil::SWFilterParams l_oParams;
+        l_oParams.m_eType               = swUtil::ONE_EURO_FILTER;
+        l_oParams.m_dOneEuroMinCutoff   = dMinCutoff;
+        l_oParams.m_dOneEuroSpeedCoeff  = dSpeedCoeff;
+        l_oParams.m_dLookAhead          = dLookAhead;
+        return l_oParams;
+    }
+
+    swUtil::SWFilterParams alphaBeta(cdouble dAlpha, cdouble dBeta, cdouble dLookAhead)
+    {
+        swUtil::SWFilterParams l_oParams;
+        l_oParams.m_eType       = swUtil::ALPHA_BETA_FILTER;
+        l_oParams.m_dAlpha      = dAlpha;
+        l_oParams.m_dBeta       = dBeta;
+        l_oParams.m_dLookAhead  = dLookAhead;
+        return l_oParams;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc < 2)
+    {
+        std::cerr << "Usage : SWEvaluateFilters <log file> [first value column = 3] [values nb = 3] [time column = 1]" << std::endl;
+        return -1;
+    }
+
+    int l_i32FirstValueColumn   = argc > 2 ? atoi(argv[2]) : 3;
+    int l_i32ValuesNb           = argc > 3 ? atoi(argv[3]) : 3;
+    int l_i32TimeColumn         = argc > 4 ? atoi(argv[4]) : 1;
+
+    if(l_i32FirstValueColumn < 0 || l_i32ValuesNb < 1 || l_i32TimeColumn < 0)
+    {
+        std::cerr << "-ERROR : invalid columns. " << std::endl;
+        return -1;
+    }
+
+    SWStream l_oRaw;
+    if(!readStream(argv[1], l_i32FirstValueColumn, l_i32ValuesNb, l_i32TimeColumn, l_oRaw))
+    {
+        std::cerr << "-ERROR : can't read enough samples from " << argv[1] << std::endl;
+        return -1;
+    }
+
+    SWStream l_oReference;
+    referenceStream(l_oRaw, l_oReference);
+
+    std::cout << l_oRaw.m_vTime.size() << " samples, " << l_i32ValuesNb << " channels, "
+              << (l_oRaw.m_vTime.size() - 1) / (l_oRaw.m_vTime.back() - l_oRaw.m_vTime.front()) << " Hz" << std::endl << std::endl;
+
+    printf("%-40s %10s %12s %12s\n", "filter", "lag (ms)", "error", "jitter");
+    displayScore("raw", score(l_oRaw, l_oReference));
+
+    // configurations to compare
+        std::vector<std::string> l_vNames;
+        std::vector<swUtil::SWFilterParams> l_vParams;
+
+        const double l_aDMinCutoff[]    = {0.5, 1.0, 2.0};
+        const double l_aDSpeedCoeff[]   = {0.0, 0.007, 0.05};
+        const double l_aDAlpha[]        = {0.3, 0.5, 0.8};
+        const double l_aDBeta[]         = {0.05, 0.1, 0.3};
+        const double l_aDLookAhead[]    = {0.0, 0.05};
+
+        char l_aCName[64];
+
+        for(int ll = 0; ll < 2; ++ll)
+        {
+            for(int ii = 0; ii < 3; ++ii)
+            {
+                for(int jj = 0; jj < 3; ++jj)
+                {
+                    sprintf(l_aCName, "one-euro fc=%.1f b=%.3f la=%.2f", l_aDMinCutoff[ii], l_aDSpeedCoeff[jj], l_aDLookAhead[ll]);
+                    l_vNames.push_back(l_aCName);
+                    l_vParams.push_back(oneEuro(l_aDMinCutoff[ii], l_aDSpeedCoeff[jj], l_aDLookAhead[ll]));
+                }
+            }
+
+            for(int ii = 0; ii < 3; ++ii)
+            {
+                for(int jj = 0; jj < 3; ++jj)
+                {
+                    sprintf(l_aCName, "alpha-beta a=%.1f b=%.2f la=%.2f", l_aDAlpha[ii], l_aDBeta[jj], l_aDLookAhead[ll]);
+                    l_vNames.push_back(l_aCName);
+                    l_vParams.push_back(alphaBeta(l_aDAlpha[ii], l_aDBeta[jj], l_aDLookAhead[ll]));
+                }
+            }
+        }
+
+    for(size_t ii = 0; ii < l_vParams.size(); ++ii)
+    {
+        SWStream l_oFiltered;
+        filterStream(l_oRaw, l_vParams[ii], l_oFiltered);
+        displayScore(l_vNames[ii], score(l_oFiltered, l_oReference));
+    }
+
+    return 0;
+}
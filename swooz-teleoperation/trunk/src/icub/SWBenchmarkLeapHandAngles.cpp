@@ -0,0 +1,155 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWBenchmarkLeapHandAngles.cpp
+ * \brief Microbenchmark of the iCub hand and finger angles computing (SWLeapHandAngles) and of the roll-pitch-yaw kernel :
+ *        std::vector path (swUtil::computeRollPitchYaw) against the stack path (swUtil::computeRollPitchYaw3).
+ *
+ *  Usage : SWBenchmarkLeapHandAngles [hands nb = 1000] [repetitions nb = 200]
+ */
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <ctime>
+
+#include "geometryUtility.h"
+#include "kinematicsUtility.h"
+#include "icub/SWLeapHandAngles.h"
+
+namespace
+{
+    /**
+     * \brief Random value in [-1, 1]
+     */
+    double randomValue()
+    {
+        return 2.0 * rand() / RAND_MAX - 1.0;
+    }
+
+    /**
+     * \brief Fill the leap hand data with random directions
+     */
+    void randomHand(swTeleop::SWLeapHandData &oHand)
+    {
+        for(int ii = 0; ii < 3; ++ii)
+        {
+            oHand.m_vArmDirection[ii]    = randomValue();
+            oHand.m_vHandDirection[ii]   = randomValue();
+            oHand.m_vHandPalmNormal[ii]  = randomValue();
+            oHand.m_vHandPalmNormalE[ii] = randomValue();
+
+            for(int jj = 0; jj < 4; ++jj)
+            {
+                if(jj < 3)
+                {
+                    oHand.m_aVThumbDirections[jj][ii] = randomValue();
+                }
+
+                oHand.m_aVIndexDirections[jj][ii]  = randomValue();
+                oHand.m_aVMiddleDirections[jj][ii] = randomValue();
+                oHand.m_aVPinkyDirections[jj][ii]  = randomValue();
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int l_i32HandsNb       = argc > 1 ? atoi(argv[1]) : 1000;
+    int l_i32RepetitionsNb = argc > 2 ? atoi(argv[2]) : 200;
+
+    if(l_i32HandsNb <= 0 || l_i32RepetitionsNb <= 0)
+    {
+        std::cerr << "Usage : SWBenchmarkLeapHandAngles [hands nb = 1000] [repetitions nb = 200]" << std::endl;
+        return -1;
+    }
+
+    std::cout << l_i32HandsNb << " hands, " << l_i32RepetitionsNb << " repetitions" << std::endl;
+
+    srand(42);
+
+    std::vector<swTeleop::SWLeapHandData> l_vHands(l_i32HandsNb);
+    for(int ii = 0; ii < l_i32HandsNb; ++ii)
+    {
+        randomHand(l_vHands[ii]);
+    }
+
+    double l_dChecksum = 0.0;
+
+    // hand and finger angles, once per bottle in the teleoperation
+        clock_t l_oStart = clock();
+        for(int ii = 0; ii < l_i32RepetitionsNb; ++ii)
+        {
+            for(int jj = 0; jj < l_i32HandsNb; ++jj)
+            {
+                double l_a4DHandAngles[4], l_a9DFingerAngles[9];
+                swTeleop::computeLeapHandAngles(l_vHands[jj], (jj & 1) == 0, l_a4DHandAngles);
+                swTeleop::computeLeapFingerAngles(l_vHands[jj], l_a9DFingerAngles);
+                l_dChecksum += l_a4DHandAngles[0] + l_a9DFingerAngles[8];
+            }
+        }
+        double l_dHandTime = static_cast<double>(clock() - l_oStart) / CLOCKS_PER_SEC;
+
+    // roll-pitch-yaw, std::vector path (NAO / Reeti before the stack kernels)
+        l_oStart = clock();
+        for(int ii = 0; ii < l_i32RepetitionsNb; ++ii)
+        {
+            for(int jj = 0; jj < l_i32HandsNb; ++jj)
+            {
+                const swTeleop::SWLeapHandData &l_oHand = l_vHands[jj];
+                std::vector<double> l_vAxis(l_oHand.m_vArmDirection.m_a3D, l_oHand.m_vArmDirection.m_a3D + 3);
+                std::vector<double> l_vRotation(l_oHand.m_vHandDirection.m_a3D, l_oHand.m_vHandDirection.m_a3D + 3);
+                l_dChecksum += swUtil::computeRollPitchYaw(l_vAxis, l_vRotation)[2];
+            }
+        }
+        double l_dVectorTime = static_cast<double>(clock() - l_oStart) / CLOCKS_PER_SEC;
+
+    // roll-pitch-yaw, stack path
+        l_oStart = clock();
+        for(int ii = 0; ii < l_i32RepetitionsNb; ++ii)
+        {
+            for(int jj = 0; jj < l_i32HandsNb; ++jj)
+            {
+                double l_a3DRollPitchYaw[3];
+                swUtil::computeRollPitchYaw3(l_vHands[jj].m_vArmDirection, l_vHands[jj].m_vHandDirection, l_a3DRollPitchYaw);
+                l_dChecksum -= l_a3DRollPitchYaw[2];
+            }
+        }
+        double l_dStackTime = static_cast<double>(clock() - l_oStart) / CLOCKS_PER_SEC;
+
+    double l_dCallsNb = static_cast<double>(l_i32RepetitionsNb) * l_i32HandsNb;
+
+    printf("%-34s %12s\n", "path", "us / call");
+    printf("%-34s %12.3f\n", "hand + finger angles", 1e6 * l_dHandTime / l_dCallsNb);
+    printf("%-34s %12.3f\n", "computeRollPitchYaw (std::vector)", 1e6 * l_dVectorTime / l_dCallsNb);
+    printf("%-34s %12.3f\n", "computeRollPitchYaw3 (stack)", 1e6 * l_dStackTime / l_dCallsNb);
+    printf("checksum %g\n", l_dChecksum);
+
+    return 0;
+}
@@ -34,6 +34,7 @@
 #include <sstream>
 
 #include "geometryUtility.h"
+#include "kinematicsUtility.h"
 #include "SWTrackingDevice.h"
 
 #include "icub/SWIcubArm.h"
@@ -46,7 +47,8 @@
 
 
 swTeleop::SWIcubArm::SWIcubArm() : m_bInitialized(false), m_bIsRunning(false),
-                                       m_pIArmVelocity(NULL), m_pIArmEncoders(NULL), m_pIArmPosition(NULL), m_pVelocityController(NULL)
+                                       m_pIArmVelocity(NULL), m_pIArmVelocity2(NULL), m_pIArmEncoders(NULL), m_pIArmPosition(NULL), m_pVelocityController(NULL),
+                                       m_oHandFingersReader(&SWIcubArm::handFingersReader), m_pHandFingersCallback(NULL)
 {
     // set ini file defaults values
         // parts to be activated
@@ -94,7 +96,11 @@ swTeleop::SWIcubArm::~SWIcubArm()
         }
     }
 
+    // the callback must not be used by the port anymore
+        m_oHandFingersTrackerPort.disableCallback();
+
     deleteAndNullify(m_pVelocityController);
+    deleteAndNullify(m_pHandFingersCallback);
 }
 
 bool swTeleop::SWIcubArm::init( yarp::os::ResourceFinder &oRf, bool bLeftArm)
@@ -188,6 +194,9 @@ bool swTeleop::SWIcubArm::init( yarp::os::ResourceFinder &oRf, bool bLeftArm)
             return (m_bInitialized=false);
         }
 
+        // optional, the velocity controller commands the enabled joints one by one without it
+        m_oRobotArm.view(m_pIArmVelocity2);
+
 
     // init ports
         m_sHandTrackerPortName         = "/teleoperation/" + m_sRobotName + "/" + m_sArm + "_arm/hand";
@@ -222,8 +231,23 @@ bool swTeleop::SWIcubArm::init( yarp::os::ResourceFinder &oRf, bool bLeftArm)
         }
 
     // init controller
-        m_pVelocityController = new swTeleop::SWArmVelocityController(m_pIArmEncoders, m_pIArmVelocity, m_vArmJointVelocityK, m_i32RateVelocityControl);
+        m_pVelocityController = new swTeleop::SWArmVelocityController(m_pIArmEncoders, m_pIArmVelocity, m_pIArmVelocity2, m_vArmJointVelocityK, m_i32RateVelocityControl);
         m_pVelocityController->enable(m_bArmHandActivated, m_bFingersActivated);
+        m_pVelocityController->timing().setVerbose(oRf.check("verboseVelocityControl", yarp::os::Value(0), "Display the velocity controller timing reports (int)").asInt() != 0);
+
+    // init event-driven input : the target joints are updated by the port thread as soon as a bottle arrives
+        m_vArmJoints.resize(m_i32ArmJointsNb);
+        m_vArmJoints = 0.;
+        m_vArmFilteredJoints.resize(m_i32ArmJointsNb);
+        m_vArmFilteredJoints = 0.;
+        m_oArmFilter.reset(m_i32ArmJointsNb, readFilterParams(oRf, m_sArm + "Arm"));
+        m_bIsRunning = true;
+
+        if(m_bArmHandActivated || m_bFingersActivated)
+        {
+            m_pHandFingersCallback = new SWInputCallback<SWIcubArm>(this, 0);
+            m_oHandFingersTrackerPort.useCallback(*m_pHandFingersCallback);
+        }
 
         // display parameters
             std::cout << std::endl << std::endl;
@@ -244,635 +268,145 @@ bool swTeleop::SWIcubArm::init( yarp::os::ResourceFinder &oRf, bool bLeftArm)
     return (m_bIsRunning=m_bInitialized=true);
 }
 
-void swTeleop::SWIcubArm::computeHandAngles(yarp::os::Bottle* handBottle,std::vector<double> &vHandAngles)
+void swTeleop::SWIcubArm::readLeapHand(const swTracking::SWBottleValues &oHandValues, SWLeapHandData &oHand) const
 {
-    vHandAngles = std::vector<double>(4,0.);
-
-    // retrieve leap data
-        std::vector<double> l_vArmDirection(3,0.), l_vHandDirection(3,0.),l_vHandDirectionE(3,0.), l_vHandPalmCoord(3,0.), l_vHandPalmNormal(3,0.), l_vHandPalmNormalE(3,0.);
+    // single pass over the decoded values, same indices than the list bottle
         for(int ii = 0; ii < 3; ++ii)
         {
-            l_vArmDirection[ii]     = handBottle->get(1 + ii).asDouble();
-            l_vHandDirection[ii]    = handBottle->get(4 + ii).asDouble();
-            l_vHandDirectionE[ii]   = handBottle->get(7 + ii).asDouble();
-            l_vHandPalmCoord[ii]    = handBottle->get(10 + ii).asDouble();
-            l_vHandPalmNormal[ii]   = handBottle->get(13 + ii).asDouble();
-            l_vHandPalmNormalE[ii]  = handBottle->get(16 + ii).asDouble();
-        }
-
-    // convert to vec3D
-        cv::Vec3d l_vecHandPalmNormal(l_vHandPalmNormal[0], l_vHandPalmNormal[1], l_vHandPalmNormal[2]);
-        cv::Vec3d l_vecHandPalmCoord(l_vHandPalmCoord[0], l_vHandPalmCoord[1], l_vHandPalmCoord[2]);
-        cv::Vec3d l_vecHandDirection(l_vHandDirection[0], l_vHandDirection[1], l_vHandDirection[2]);
-        cv::Vec3d l_vecArmDirection(l_vArmDirection[0], l_vArmDirection[1], l_vArmDirection[2]);
-
-    // normalize vectors
-        l_vecHandPalmNormal = cv::normalize(l_vecHandPalmNormal);
-        l_vecArmDirection   = cv::normalize(l_vecArmDirection);
-        l_vecHandDirection  = cv::normalize(l_vecHandDirection);
-
-    // convert to mat
-        cv::Mat l_matHandDirection(l_vecHandDirection);
-        cv::Mat l_matHandPalmNormal(l_vecHandPalmNormal);
-        cv::Mat l_matArmDirection(l_vecArmDirection);
-
-    // check hand palm orientation
-        bool l_bHandPalmUp = false;
-         if(swUtil::rad2Deg(acos(cv::Vec3d(0.,-1.,0.).dot(l_vecHandPalmNormal))) > 90.)
-        {
-            l_bHandPalmUp = true;
-        }
-
-    // compute transformation for aligning arm to z axis
-        cv::Mat l_matTransfo;
-        cv::Vec3d l_vecAxis(0.,0.,-1.);
-        swUtil::rodriguesRotation(l_vecArmDirection, l_vecAxis, l_matTransfo);
-    // apply transformation to the arm and the hand
-        cv::Mat l_matTransfoHandDirection = l_matTransfo * l_matHandDirection;
-        cv::Mat l_matTransfoHandNormal    = l_matTransfo * l_matHandPalmNormal;
-        cv::Mat l_matTransfoArmDirection  = l_matTransfo * l_matArmDirection;
-
-    // compute transformation for aligning palm normal to Y axis
-        if(!l_bHandPalmUp)
-        {
-            l_vecAxis = cv::Vec3d(0.,-1.,0.);
-        }
-        else
-        {
-            l_vecAxis = cv::Vec3d(0.,1.,0.);
-        }
-
-        cv::Vec3d l_vecTransfoHandNormal(l_matTransfoHandNormal);
-        swUtil::rodriguesRotation(l_vecTransfoHandNormal, l_vecAxis, l_matTransfo);
-
-        cv::Mat l_matTransfoHandDirection2 = l_matTransfo * l_matTransfoHandDirection;
-
-    // compute angle for wrist yaw
-        double l_dot  = l_matTransfoHandDirection2.dot(l_matTransfoArmDirection);
-        double l_angle = swUtil::rad2Deg(acos(l_dot/(cv::norm(l_matTransfoHandDirection2)* cv::norm(l_matTransfoArmDirection))));
-        cv::Mat l_matCross = l_matTransfoHandDirection2.cross(l_matTransfoArmDirection);
-
-        double l_dCrossY = l_matCross.at<double>(1);
-
-        if(m_sArm != "left")
-        {
-            l_dCrossY *= -1;
-        }
-
-        if(l_dCrossY > 0.)
-        {
-            if(!l_bHandPalmUp)
-            {
-                l_angle = -l_angle;
-            }
-        }
-        else
-        {
-            if(l_bHandPalmUp)
-            {
-                l_angle = -l_angle;
-            }
-        }
-
-        // set joint value
-        vHandAngles[3] = l_angle;
-
-    // compute angle for wrist ptich
-        cv::Vec3d l_vecTransfoHandDirection(l_matTransfoHandDirection);
-        cv::Vec3d l_vecTransfoHandRight = l_vecTransfoHandNormal.cross(l_vecTransfoHandDirection);
-
-        bool l_bHandPalmLeft = true;
-        if(swUtil::rad2Deg(acos(cv::Vec3d(-1.,0.,0.).dot(l_vecHandPalmNormal))) > 90.)
-        {
-            l_bHandPalmLeft = false;
-        }
-
-        // compute transformation for aligning palm normal to X axis
-        if(l_bHandPalmLeft)
-        {
-            l_vecAxis = cv::Vec3d(0.,-1.,0.);
-        }
-        else
-        {
-            l_vecAxis = cv::Vec3d(0.,1.,0.);
-        }
-
-        swUtil::rodriguesRotation(l_vecTransfoHandRight, l_vecAxis, l_matTransfo);
-        l_matTransfoHandDirection2 = l_matTransfo * l_matTransfoHandDirection;
-
-
-        l_dot  = l_matTransfoHandDirection2.dot(l_matTransfoArmDirection);
-        l_angle = swUtil::rad2Deg(acos(l_dot/(cv::norm(l_matTransfoHandDirection2)* cv::norm(l_matTransfoArmDirection))));
-
-
-        l_matCross = l_matTransfoHandDirection2.cross(l_matTransfoArmDirection);
-
-        if(m_sArm != "left")
-        {
-            l_dCrossY *= -1;
-        }
-
-
-        if(l_dCrossY > 0.)
-        {
-            if(l_bHandPalmLeft)
-            {
-                 l_angle = -l_angle;
-            }
-            else
-            {
-                 l_angle = 0.0;
-            }
-
-        }
-        else
-        {
-            if(l_bHandPalmLeft)
-            {
-                 l_angle = 0.0;
-            }
-            else
-            {
-                l_angle = -l_angle;
-            }
-        }
-
-        // set joint value
-        vHandAngles[2] = l_angle;
-
-
-        if(m_sArm != "left")
-        {
-            vHandAngles[1] = (swUtil::rad2Deg(l_vHandPalmNormalE[1]) + 90.0);
-        }
-        else
-        {
-            vHandAngles[1] = -(swUtil::rad2Deg(l_vHandPalmNormalE[1]) - 90.0);
+            oHand.m_vArmDirection[ii]      = oHandValues.get(1 + ii);
+            oHand.m_vHandDirection[ii]     = oHandValues.get(4 + ii);
+            oHand.m_vHandPalmNormal[ii]    = oHandValues.get(13 + ii);
+            oHand.m_vHandPalmNormalE[ii]   = oHandValues.get(16 + ii);
         }
 
-        double l_dAngle = swUtil::rad2Deg(acos(cv::normalize(cv::Vec3d(0.0,l_vArmDirection[1],l_vArmDirection[2])).dot(cv::Vec3d(0.0,1.0,0.0))));
-        l_dAngle *= -1.0;
-        l_dAngle += 140.0;
-        vHandAngles[0] = l_dAngle;
-}
-
-void swTeleop::SWIcubArm::computeFingerAngles(yarp::os::Bottle *handFingersBottle, std::vector<double> &vFingerAngles)
-{
-    // arm joint 0 hand_finger
-    // arm joint 1 thumb_oppose
-    // arm joint 2 thumb_proximal
-    // arm joint 3 thumb_distal
-    // arm joint 4 index_proximal
-    // arm joint 5 index_distal
-    // arm joint 6 middle_proximal
-    // arm joint 7 middle_distal
-    // arm joint 8 pinky
-
-    // init res angles
-        vFingerAngles = std::vector<double>(9,0.);
-
-    // retrieve leap data
-        std::vector<cv::Vec3d> l_vecThumbDirections(3,    cv::Vec3d(0.,0.,0.));
-        std::vector<cv::Vec3d> l_vecIndexDirections(4,    cv::Vec3d(0.,0.,0.));
-        std::vector<cv::Vec3d> l_vecMiddleDirections(4,   cv::Vec3d(0.,0.,0.));
-        std::vector<cv::Vec3d> l_vecRingDirections(4,     cv::Vec3d(0.,0.,0.));
-        std::vector<cv::Vec3d> l_vecPinkyDirections(4,    cv::Vec3d(0.,0.,0.));
-        cv::Vec3d l_vecHandNormal    = cv::normalize(cv::Vec3d(handFingersBottle->get(13).asDouble(), handFingersBottle->get(14).asDouble(), handFingersBottle->get(15).asDouble()));
-        cv::Vec3d l_vecHandDirection = cv::normalize(cv::Vec3d(handFingersBottle->get(4).asDouble(), handFingersBottle->get(5).asDouble(), handFingersBottle->get(6).asDouble()));
-
         for(int ii = 0; ii < 4; ++ii)
         {
             for(int jj = 0; jj < 3; ++jj)
             {
                 if(ii < 3)
                 {
-                    l_vecThumbDirections[ii][jj] = handFingersBottle->get(19 + ii * 3 + jj).asDouble();
+                    oHand.m_aVThumbDirections[ii][jj] = oHandValues.get(19 + ii * 3 + jj);
                 }
 
-                l_vecIndexDirections[ii][jj] = handFingersBottle->get(28 + ii * 3 + jj).asDouble();
-                l_vecMiddleDirections[ii][jj] = handFingersBottle->get(40 + ii * 3 + jj).asDouble();
-                l_vecRingDirections[ii][jj] = handFingersBottle->get(52 + ii * 3 + jj).asDouble();
-                l_vecPinkyDirections[ii][jj] = handFingersBottle->get(64 + ii * 3 + jj).asDouble();
-            }
-
-            if(l_vecThumbDirections[ii][0] != 0 && l_vecThumbDirections[ii][1] != 0 && l_vecThumbDirections[ii][2] != 0)
-            {
-                l_vecThumbDirections[ii]    = cv::normalize(l_vecThumbDirections[ii]);
-            }
-            if(l_vecIndexDirections[ii][0] != 0 && l_vecIndexDirections[ii][1] != 0 && l_vecIndexDirections[ii][2] != 0)
-            {
-                l_vecIndexDirections[ii]    = cv::normalize(l_vecIndexDirections[ii]);
-            }
-            if(l_vecMiddleDirections[ii][0] != 0 && l_vecMiddleDirections[ii][1] != 0 && l_vecMiddleDirections[ii][2] != 0)
-            {
-                l_vecMiddleDirections[ii]   = cv::normalize(l_vecMiddleDirections[ii]);
-            }
-            if(l_vecRingDirections[ii][0] != 0 && l_vecRingDirections[ii][1] != 0 && l_vecRingDirections[ii][2] != 0)
-            {
-                l_vecRingDirections[ii]     = cv::normalize(l_vecRingDirections[ii]);
-            }
-            if(l_vecPinkyDirections[ii][0] != 0 && l_vecPinkyDirections[ii][1] != 0 && l_vecPinkyDirections[ii][2] != 0)
-            {
-                l_vecPinkyDirections[ii]    = cv::normalize(l_vecPinkyDirections[ii]);
+                oHand.m_aVIndexDirections[ii][jj]  = oHandValues.get(28 + ii * 3 + jj);
+                oHand.m_aVMiddleDirections[ii][jj] = oHandValues.get(40 + ii * 3 + jj);
+                oHand.m_aVPinkyDirections[ii][jj]  = oHandValues.get(64 + ii * 3 + jj);
             }
         }
+}
 
+bool swTeleop::SWIcubArm::checkBottles()
+{
+    if(!m_bIsRunning)
+    {
+        return false;
+    }
 
-        std::vector<cv::Mat> l_vMatThumbDirectionsTransfo(3,    cv::Mat(cv::Vec3d(0.,0.,0.)));
-        std::vector<cv::Mat> l_vMatIndexDirectionsTransfo(4,    cv::Mat(cv::Vec3d(0.,0.,0.)));
-        std::vector<cv::Mat> l_vMatMiddleDirectionsTransfo(4,   cv::Mat(cv::Vec3d(0.,0.,0.)));
-        std::vector<cv::Mat> l_vMatRingDirectionsTransfo(4,     cv::Mat(cv::Vec3d(0.,0.,0.)));
-        std::vector<cv::Mat> l_vMatPinkyDirectionsTransfo(4,    cv::Mat(cv::Vec3d(0.,0.,0.)));
-        cv::Mat l_matHandDirectionTransfo(cv::Vec3d(0.,0.,0.));
-
-
-    // compute transformation for aligning palm normal to Y axis
-        cv::Vec3d l_vecAxis;
-
-        bool l_bHandPalmUp = false;
-        if(swUtil::rad2Deg(acos(cv::Vec3d(0.,-1.,0.).dot(l_vecHandNormal))) > 90.)
-        {
-            l_bHandPalmUp = true;
-        }
-        bool l_bHandPalmLeft = true;
-        if(swUtil::rad2Deg(acos(cv::Vec3d(-1.,0.,0.).dot(l_vecHandNormal))) > 90.)
-        {
-            l_bHandPalmLeft = false;
-        }
+    if(!m_bInitialized)
+    {
+        std::cerr << "Icub Arm control module not initialized. " << std::endl;
+        return (m_bIsRunning=false);
+    }
 
-        if(!l_bHandPalmUp)
-        {
-            l_vecAxis = cv::Vec3d(0.,-1.,0.);
-        }
-        else
-        {
-            l_vecAxis = cv::Vec3d(0.,1.,0.);
-        }
+    // the bottles are read by the port callback as soon as they arrive
 
+    return true;
+}
 
-        cv::Mat l_matTransfo;
-        swUtil::rodriguesRotation(l_vecHandNormal, l_vecAxis, l_matTransfo);
+void swTeleop::SWIcubArm::onBottle(cint i32Input, yarp::os::Bottle &oBottle)
+{
+    m_oInputMutex.lock();
 
-        for(int ii = 0; ii < 4; ++ii)
+        if(!m_bIsRunning)
         {
-            if(ii < 3)
-            {
-                l_vMatThumbDirectionsTransfo[ii] = l_matTransfo * cv::Mat(l_vecThumbDirections[ii]);
-            }
-
-            l_vMatIndexDirectionsTransfo[ii]     = l_matTransfo * cv::Mat(l_vecIndexDirections[ii]);
-            l_vMatMiddleDirectionsTransfo[ii]    = l_matTransfo * cv::Mat(l_vecMiddleDirections[ii]);
-            l_vMatRingDirectionsTransfo[ii]      = l_matTransfo * cv::Mat(l_vecRingDirections[ii]);
-            l_vMatPinkyDirectionsTransfo[ii]     = l_matTransfo * cv::Mat(l_vecPinkyDirections[ii]);
+            m_oInputMutex.unlock();
+            return;
         }
 
-        l_matHandDirectionTransfo = l_matTransfo * cv::Mat(l_vecHandDirection);
-
-
-
-
-    // compute fingers interval (hand_finger)
-        // ... better not (hight risk of breaking)
-
-    // compute thumbs angles
-        // thumb metacarpal-> index metarcapal (thumb_oppose)
-            cv::Vec3d l_vecTemp1(cv::normalize(cv::Vec3d(l_vMatThumbDirectionsTransfo[0]))); // TODO :...
-            cv::Vec3d l_vecTemp2(cv::normalize(cv::Vec3d(l_vMatIndexDirectionsTransfo[0])));
-            double l_dDot = l_vecTemp1.dot(l_vecTemp2);
-            double l_dAngle = swUtil::rad2Deg(acos(l_dDot));
-            vFingerAngles[2] = 90.0 - l_dAngle;
-
-        // proximal->intermediate (thumb_proximal)
-            l_vecTemp1 = cv::normalize(l_vecThumbDirections[0]);
-            l_vecTemp2 = cv::normalize(l_vecThumbDirections[1]);
-            l_dDot = l_vecTemp1.dot(l_vecTemp2);
-            cv::Vec3d l_vecCross = l_vecTemp1.cross(l_vecTemp2);
-            l_dAngle = swUtil::rad2Deg(acos(l_dDot));
-//            vFingerAngles[1] += l_dAngle;
-
-        // intermediate->distal (thumb_distal)
-            l_vecTemp1 = cv::normalize(l_vecThumbDirections[1]);
-            l_vecTemp2 = cv::normalize(l_vecThumbDirections[2]);
-            l_dDot     = l_vecTemp1.dot(l_vecTemp2);
-            l_vecCross = l_vecTemp1.cross(l_vecTemp2);
-            l_dAngle = swUtil::rad2Deg(acos(l_dDot));
-            vFingerAngles[3] += l_dAngle;
-
-    // compute index angles
-        // metacarpal->proximal (index_proximal)
-            l_vecTemp1 = cv::normalize(l_vecIndexDirections[0]);
-            l_vecTemp2 = cv::normalize(l_vecIndexDirections[1]);
-            l_dDot     = l_vecTemp1.dot(l_vecTemp2);
-            l_vecCross = l_vecTemp1.cross(l_vecTemp2);
-            l_dAngle = swUtil::rad2Deg(acos(l_dDot));
-
-            if(!l_bHandPalmLeft)
-            {
-                if(l_vecCross[1] < 0.)
-                {
-                    vFingerAngles[4] += l_dAngle;
-                }
-            }
-            else
-            {
-                if(l_vecCross[1] >= 0.)
-                {
-                    vFingerAngles[4] += l_dAngle;
-                }
-            }
-
-        // proximal->intermediate + intermediate->distal (index_distal)
-            l_vecTemp1 = cv::normalize(l_vecIndexDirections[1]);
-            l_vecTemp2 = cv::normalize(l_vecIndexDirections[2]);
-            l_dDot     = l_vecTemp1.dot(l_vecTemp2);
-            l_vecCross = l_vecTemp1.cross(l_vecTemp2);
-            l_dAngle   = swUtil::rad2Deg(acos(l_dDot));
-
-            if(!l_bHandPalmLeft)
-            {
-                if(l_vecCross[1] < 0.)
-                {
-                    vFingerAngles[5] += l_dAngle;
-                }
-            }
-            else
-            {
-                if(l_vecCross[1] >= 0.)
-                {
-                    vFingerAngles[5] += l_dAngle;
-                }
-            }
-
-            l_vecTemp1 = cv::normalize(l_vecIndexDirections[2]);
-            l_vecTemp2 = cv::normalize(l_vecIndexDirections[3]);
-            l_dDot     = l_vecTemp1.dot(l_vecTemp2);
-            l_vecCross = l_vecTemp1.cross(l_vecTemp2);
-            l_dAngle   = swUtil::rad2Deg(acos(l_dDot));
-
-            if(!l_bHandPalmLeft)
-            {
-                if(l_vecCross[1] < 0.)
-                {
-                    vFingerAngles[5] += l_dAngle;
-                }
-            }
-            else
+        // set default values to arm joint
+            for(uint ii = 0; ii < m_vArmJoints.size(); ++ii)
             {
-                if(l_vecCross[1] >= 0.)
-                {
-                    vFingerAngles[5] += l_dAngle;
-                }
+                m_vArmJoints[ii] = m_vArmResetPositionDefault[ii];
             }
 
-    // compute middle angles
-        // metacarpal->proximal (middle_proximal)
-            l_vecTemp1 = cv::normalize(l_vecMiddleDirections[0]);
-            l_vecTemp2 = cv::normalize(l_vecMiddleDirections[1]);
-            l_dDot     = l_vecTemp1.dot(l_vecTemp2);
-            l_vecCross = l_vecTemp1.cross(l_vecTemp2);
-            l_dAngle   = swUtil::rad2Deg(acos(l_dDot));
-
-            if(!l_bHandPalmLeft)
-            {
-                if(l_vecCross[1] < 0.)
-                {
-                    vFingerAngles[6] += l_dAngle;
-                }
-            }
-            else
-            {
-                if(l_vecCross[1] >= 0.)
-                {
-                    vFingerAngles[6] += l_dAngle;
-                }
-            }
-
-        // proximal->intermediate + intermediate->distal (middle_distal)
-            l_vecTemp1 = cv::normalize(l_vecMiddleDirections[1]);
-            l_vecTemp2 = cv::normalize(l_vecMiddleDirections[2]);
-            l_dDot     = l_vecTemp1.dot(l_vecTemp2);
-            l_vecCross = l_vecTemp1.cross(l_vecTemp2);
-            l_dAngle   = swUtil::rad2Deg(acos(l_dDot));
-
-            if(!l_bHandPalmLeft)
-            {
-                if(l_vecCross[1] < 0.)
-                {
-                    vFingerAngles[7] += l_dAngle;
-                }
-            }
-            else
-            {
-                if(l_vecCross[1] >= 0.)
-                {
-                    vFingerAngles[7] += l_dAngle;
-                }
-            }
-
-            l_vecTemp1 = cv::normalize(l_vecMiddleDirections[2]);
-            l_vecTemp2 = cv::normalize(l_vecMiddleDirections[3]);
-            l_dDot     = l_vecTemp1.dot(l_vecTemp2);
-            l_vecCross = l_vecTemp1.cross(l_vecTemp2);
-            l_dAngle   = swUtil::rad2Deg(acos(l_dDot));
-
-            if(!l_bHandPalmLeft)
-            {
-                if(l_vecCross[1] < 0.)
-                {
-                    vFingerAngles[7] += l_dAngle;
-                }
-            }
-            else
-            {
-                if(l_vecCross[1] >= 0.)
-                {
-                    vFingerAngles[7] += l_dAngle;
-                }
-            }
+        // arm joint 0 shoulder_pitch
+        // arm joint 1 shoulder_roll
+        // arm joint 2 shoulder_yaw
+        // arm joint 3 elbow
+        // arm joint 4 wrist_prosup
+        // arm joint 5 wrist_pitch
+        // arm joint 6 wrist_yaw
+        // arm joint 7 hand_finger
+        // arm joint 8 thumb_oppose
+        // arm joint 9 thumb_proximal
+        // arm joint 10 thumb_distal
+        // arm joint 11 index_proximal
+        // arm joint 12 index_distal
+        // arm joint 13 middle_proximal
+        // arm joint 14 middle_distal
+        // arm joint 15 pinky
+            m_oHandFingersReader.read(this, oBottle);
 
-    // compute ring + pinky angles
-        // metacarpal->proximal + proximal->intermediate + intermediate->distal (pinky)
-            l_vecTemp1 = cv::normalize(l_vecPinkyDirections[0]);
-            l_vecTemp2 = cv::normalize(l_vecPinkyDirections[1]);
-            l_dDot     = l_vecTemp1.dot(l_vecTemp2);
-            l_vecCross = l_vecTemp1.cross(l_vecTemp2);
-            l_dAngle   = swUtil::rad2Deg(acos(l_dDot));
+        // filter the raw targets into a separate buffer before cropping them, the filter never sees its own output
+            m_oArmFilter.filter(m_vArmJoints.data(), m_vArmFilteredJoints.data(), m_vArmJoints.size(), yarp::os::Time::now());
 
-            if(!l_bHandPalmLeft)
+        // check each joint value to ensure it is in the right range, if not crop to the max/min values
+            for(uint ii = 0; ii < m_vArmFilteredJoints.size(); ++ii)
             {
-                if(l_vecCross[1] < 0.)
+                if(m_vArmFilteredJoints[ii] < m_vArmMinJoint[ii])
                 {
-                    vFingerAngles[8] += l_dAngle;
+                    m_vArmFilteredJoints[ii] = m_vArmMinJoint[ii];
                 }
-            }
-            else
-            {
-                if(l_vecCross[1] >= 0.)
+                if(m_vArmFilteredJoints[ii] > m_vArmMaxJoint[ii])
                 {
-                    vFingerAngles[8] += l_dAngle;
+                    m_vArmFilteredJoints[ii] = m_vArmMaxJoint[ii];
                 }
             }
 
-            l_vecTemp1 = cv::normalize(l_vecPinkyDirections[1]);
-            l_vecTemp2 = cv::normalize(l_vecPinkyDirections[2]);
-            l_dDot     = l_vecTemp1.dot(l_vecTemp2);
-            l_vecCross = l_vecTemp1.cross(l_vecTemp2);
-            l_dAngle   = swUtil::rad2Deg(acos(l_dDot));
+        m_pVelocityController->setJoints(m_vArmFilteredJoints);
 
-            if(!l_bHandPalmLeft)
-            {
-                if(l_vecCross[1] < 0.)
-                {
-                    vFingerAngles[8] += l_dAngle;
-                }
-            }
-            else
-            {
-                if(l_vecCross[1] >= 0.)
-                {
-                    vFingerAngles[8] += l_dAngle;
-                }
-            }
-
-            l_vecTemp1 = cv::normalize(l_vecPinkyDirections[2]);
-            l_vecTemp2 = cv::normalize(l_vecPinkyDirections[3]);
-            l_dDot     = l_vecTemp1.dot(l_vecTemp2);
-            l_vecCross = l_vecTemp1.cross(l_vecTemp2);
-            l_dAngle   = swUtil::rad2Deg(acos(l_dDot));
+        if(!m_pVelocityController->isRunning())
+        {
+            m_pVelocityController->start();
+        }
 
-            if(!l_bHandPalmLeft)
-            {
-                if(l_vecCross[1] < 0.)
-                {
-                    vFingerAngles[8] += l_dAngle;
-                }
-            }
-            else
-            {
-                if(l_vecCross[1] >= 0.)
-                {
-                    vFingerAngles[8] += l_dAngle;
-                }
-            }
+    m_oInputMutex.unlock();
 }
 
-bool swTeleop::SWIcubArm::checkBottles()
+swTeleop::SWIcubArm::SWArmReader swTeleop::SWIcubArm::handFingersReader(cint i32DeviceId)
 {
-    if(!m_bIsRunning)
+    switch(i32DeviceId)
     {
-        return false;
+        case swTracking::LEAP_LIB :
+            return &SWIcubArm::readHandFingersLeap;
     }
 
-    if(!m_bInitialized)
+    return NULL;
+}
+
+void swTeleop::SWIcubArm::readHandFingersLeap(yarp::os::Bottle &oBottle)
+{
+    if(!m_oBottleValues.decode(oBottle))
     {
-        std::cerr << "Icub Arm control module not initialized. " << std::endl;
-        return (m_bIsRunning=false);
+        return;
     }
 
-    // init command vector
-        yarp::sig::Vector l_vArmJoints;
-        l_vArmJoints.resize(m_i32ArmJointsNb);
-        l_vArmJoints = 0.;
-    // set default values to arm joint
-        for(uint ii = 0; ii < l_vArmJoints.size(); ++ii)
-        {
-            l_vArmJoints[ii] = m_vArmResetPositionDefault[ii];
-        }
-
-    // defines bottles
-        yarp::os::Bottle *l_pHandTarget = NULL;//, *l_pHandCartesianTarget = NULL; // *l_pFingersTarget = NULL, *l_pArmTarget = NULL,
-
-
-        l_pHandTarget = m_oHandFingersTrackerPort.read(false);
-
-
-        if(l_pHandTarget)
-        {
-            int l_deviceId = l_pHandTarget->get(0).asInt();
-
-            // arm joint 0 shoulder_pitch
-            // arm joint 1 shoulder_roll
-            // arm joint 2 shoulder_yaw
-            // arm joint 3 elbow
-            // arm joint 4 wrist_prosup
-            // arm joint 5 wrist_pitch
-            // arm joint 6 wrist_yaw
-            // arm joint 7 hand_finger
-            // arm joint 8 thumb_oppose
-            // arm joint 9 thumb_proximal
-            // arm joint 10 thumb_distal
-            // arm joint 11 index_proximal
-            // arm joint 12 index_distal
-            // arm joint 13 middle_proximal
-            // arm joint 14 middle_distal
-            // arm joint 15 pinky
-
-            switch(l_deviceId)
-            {
-                case swTracking::DUMMY_LIB :
-
-                    // ...
-                break;
-                case swTracking::LEAP_LIB :
+    SWLeapHandData l_oLeapHand;
+    readLeapHand(m_oBottleValues, l_oLeapHand);
 
+    double l_a4DHandAngles[4], l_a9DFingerAngles[9];
+    computeLeapHandAngles(l_oLeapHand, m_sArm == "left", l_a4DHandAngles);
+    computeLeapFingerAngles(l_oLeapHand, l_a9DFingerAngles);
 
-                    // set default joint values
-                        for(int ii = 0; ii < m_i32ArmJointsNb; ++ii)
-                        {
-//                            l_vArmJoints[ii] = m_vArmResetPosition[ii];
-                        }
-
-                        std::vector<double> l_vHandAngles;
-//                        std::cout << "computeHandAngles  ";
-                        computeHandAngles(l_pHandTarget, l_vHandAngles);
-//                        std::cout << "-> end  |";
-
-                        for(uint ii = 0; ii < l_vHandAngles.size(); ++ii)
-                        {
-                            l_vArmJoints[3 + ii] = l_vHandAngles[ii];
-                        }
-
-                        std::vector<double> l_vFingerAngles;
-//                        std::cout << "computeFingerAngles  ";
-                        computeFingerAngles(l_pHandTarget, l_vFingerAngles);
-//                        std::cout << "-> end  |";
-
-                        for(uint ii = 0; ii < l_vFingerAngles.size(); ++ii)
-                        {
-                            l_vArmJoints[7 + ii] = l_vFingerAngles[ii];
-                        }
-
-                break;
-
-            }
-        }
-
-
-    // check each joint value to ensure it is in the right range, if not crop to the max/min values
-        for(uint ii = 0; ii < l_vArmJoints.size(); ++ii)
-        {
-            if(l_vArmJoints[ii] < m_vArmMinJoint[ii])
-            {
-                l_vArmJoints[ii] = m_vArmMinJoint[ii];
-            }
-            if(l_vArmJoints[ii] > m_vArmMaxJoint[ii])
-            {
-                l_vArmJoints[ii] = m_vArmMaxJoint[ii];
-            }
-        }
-
-        if(l_pHandTarget)
-        {
-//            std::cout << "send joints " << std::endl;
-            m_pVelocityController->setJoints(l_vArmJoints);
-
-            if(!m_pVelocityController->isRunning())
-            {                
-                m_pVelocityController->start();
-            }
-        }
+    for(uint ii = 0; ii < 4; ++ii)
+    {
+        m_vArmJoints[3 + ii] = l_a4DHandAngles[ii];
+    }
 
-    return true;
+    for(uint ii = 0; ii < 9; ++ii)
+    {
+        m_vArmJoints[7 + ii] = l_a9DFingerAngles[ii];
+    }
 }
 
 void swTeleop::SWIcubArm::resetArmPosition()
@@ -909,14 +443,16 @@ bool swTeleop::SWIcubArm::close()
 
 bool swTeleop::SWIcubArm::interruptModule()
 {
-
-    m_bIsRunning = false;
+    // no bottle will update the joints or restart the controller after this point
+    m_oInputMutex.lock();
+        m_bIsRunning = false;
 
     // reset positions
         if(m_bArmHandActivated)
         {
             resetArmPosition();
         }
+    m_oInputMutex.unlock();
 
     if(m_pVelocityController->isRunning())
     {
@@ -937,8 +473,9 @@ bool swTeleop::SWIcubArm::interruptModule()
 
 
 swTeleop::SWArmVelocityController::SWArmVelocityController(yarp::dev::IEncoders *pIArmEncoders, yarp::dev::IVelocityControl *pIArmVelocity,
-                                                     std::vector<double> &vArmJointVelocityK, int i32Rate)
-    : RateThread(i32Rate), m_bArmHandEnabled(false), m_bFingersEnabled(false), m_vArmJointVelocityK(vArmJointVelocityK)
+                                                     yarp::dev::IVelocityControl2 *pIArmVelocity2, std::vector<double> &vArmJointVelocityK, int i32Rate)
+    : RateThread(i32Rate), m_bArmHandEnabled(false), m_bFingersEnabled(false), m_pIArmEncoders(NULL), m_pIArmVelocity(NULL), m_pIArmVelocity2(pIArmVelocity2),
+      m_vArmJointVelocityK(vArmJointVelocityK), m_i32JointsNb(0), m_oTiming("Arm")
 {
 
     if(pIArmEncoders)
@@ -948,47 +485,91 @@ swTeleop::SWArmVelocityController::SWArmVelocityController(yarp::dev::IEncoders
     if(pIArmVelocity)
     {
         m_pIArmVelocity = pIArmVelocity;
+        m_pIArmVelocity->getAxes(&m_i32JointsNb);
     }
+
+    // buffers are allocated once, run() only writes into them
+        m_vJoints.resize(m_i32JointsNb, 0.0);
+        m_vEncoders.resize(m_i32JointsNb, 0.0);
+        m_vCommand.resize(m_i32JointsNb, 0.0);
+        m_vEnabledJoints.resize(m_i32JointsNb, 0);
+        m_vEnabledCommand.resize(m_i32JointsNb, 0.0);
 }
 
 void swTeleop::SWArmVelocityController::run()
 {
-//    std::cout << "start run ";
-    m_oMutex.lock();
-        yarp::sig::Vector l_vArmJoints = m_vLastArmJoint; // Check values with Joint before
-    m_oMutex.unlock();
+    m_oTiming.startTick();
 
-    yarp::sig::Vector l_vEncoders, l_vCommand;
-    l_vEncoders.resize(l_vArmJoints.size());
-    l_vCommand.resize(l_vArmJoints.size());
+    m_oMutex.lock();
+        bool l_bArmHandEnabled = m_bArmHandEnabled;
+        bool l_bFingersEnabled = m_bFingersEnabled;
+        int l_i32JointsNb = static_cast<int>(m_vLastArmJoint.size());
+        l_i32JointsNb = (l_i32JointsNb < m_i32JointsNb) ? l_i32JointsNb : m_i32JointsNb;
 
-    m_pIArmEncoders->getEncoders(l_vEncoders.data());
+        for(int ii = 0; ii < l_i32JointsNb; ++ii)
+        {
+            m_vJoints[ii] = m_vLastArmJoint[ii]; // Check values with Joint before
+        }
+    m_oMutex.unlock();
 
-    for(uint ii = 0; ii < l_vCommand.size(); ++ii)
+    if(l_i32JointsNb > 0 && (l_bArmHandEnabled || l_bFingersEnabled))
     {
-        l_vCommand[ii] =  m_vArmJointVelocityK[ii] * (l_vArmJoints[ii] - l_vEncoders[ii]);
+        m_pIArmEncoders->getEncoders(m_vEncoders.data());
 
-    }
-
-    // ...
-    l_vCommand[7] = 0;
+        // masked command : the disabled joints are left to the other controllers
+            for(int ii = 0; ii < l_i32JointsNb; ++ii)
+            {
+                bool l_bJointEnabled = (ii < 7) ? l_bArmHandEnabled : l_bFingersEnabled;
+                m_vCommand[ii] = l_bJointEnabled ? m_vArmJointVelocityK[ii] * (m_vJoints[ii] - m_vEncoders[ii]) : 0.0;
+            }
 
-    if(m_bArmHandEnabled)
-    {
-        for(uint ii = 0; ii < 7; ++ii)
+        // ...
+        if(l_i32JointsNb > 7)
         {
-            m_pIArmVelocity->velocityMove(ii, l_vCommand[ii]);
+            m_vCommand[7] = 0;
         }
-    }
 
-    if(m_bFingersEnabled)
-    {
-        for(uint ii = 7; ii < l_vArmJoints.size(); ++ii)
-        {
-            m_pIArmVelocity->velocityMove(ii, l_vCommand[ii]);
-        }
+        // ids and velocities of the enabled joints
+            int l_i32EnabledJointsNb = 0;
+            for(int ii = 0; ii < l_i32JointsNb; ++ii)
+            {
+                if((ii < 7) ? l_bArmHandEnabled : l_bFingersEnabled)
+                {
+                    m_vEnabledJoints[l_i32EnabledJointsNb]  = ii;
+                    m_vEnabledCommand[l_i32EnabledJointsNb] = m_vCommand[ii];
+                    ++l_i32EnabledJointsNb;
+                }
+            }
+
+        // velocity move : one call for the enabled joints, one call per joint if the subset interface is missing
+            if(m_pIArmVelocity2)
+            {
+                m_pIArmVelocity2->velocityMove(l_i32EnabledJointsNb, m_vEnabledJoints.data(), m_vEnabledCommand.data());
+            }
+            else if(l_i32EnabledJointsNb == m_i32JointsNb)
+            {
+                m_pIArmVelocity->velocityMove(m_vCommand.data());
+            }
+            else
+            {
+                for(int ii = 0; ii < l_i32EnabledJointsNb; ++ii)
+                {
+                    m_pIArmVelocity->velocityMove(m_vEnabledJoints[ii], m_vEnabledCommand[ii]);
+                }
+            }
     }
-//    std::cout << " - end run |";
+
+    m_oTiming.stopTick(getRate());
+}
+
+void swTeleop::SWArmVelocityController::threadRelease()
+{
+    m_oTiming.display(getRate());
+}
+
+swTeleop::SWVelocityControllerTiming &swTeleop::SWArmVelocityController::timing()
+{
+    return m_oTiming;
 }
 
 void swTeleop::SWArmVelocityController::enable(cbool bArmHandActivated, cbool bFingersActivated)
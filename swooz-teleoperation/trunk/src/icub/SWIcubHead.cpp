@@ -43,8 +43,10 @@
 using namespace yarp::os;
 
 
-swTeleop::SWIcubHead::SWIcubHead() : m_bInitialized(false), m_bIsRunning(false), m_dHeadTimeLastBottle(-1.), m_dGazeTimeLastBottle(-1.),
-                                     m_pIHeadVelocity(NULL), m_pIHeadEncoders(NULL), m_pIHeadPosition(NULL), m_pVelocityController(NULL)
+swTeleop::SWIcubHead::SWIcubHead() : m_bInitialized(false), m_bIsRunning(false), m_dHeadTimeLastBottle(-1.), m_dGazeTimeLastBottle(-1.), m_dLEDTimeLastBottle(-1.),
+                                     m_pIHeadVelocity(NULL), m_pIHeadVelocity2(NULL), m_pIHeadEncoders(NULL), m_pIHeadPosition(NULL), m_pVelocityController(NULL),
+                                     m_oHeadReader(&SWIcubHead::headReader), m_oGazeReader(&SWIcubHead::gazeReader), m_oFaceReader(&SWIcubHead::faceReader),
+                                     m_pHeadCallback(NULL), m_pGazeCallback(NULL), m_pFaceCallback(NULL)
 {        
     // set ini file defaults values
         // parts to be activated
@@ -100,7 +102,15 @@ swTeleop::SWIcubHead::~SWIcubHead()
         }
     }
 
+    // the callbacks must not be used by the ports anymore
+        m_oHeadTrackerPort.disableCallback();
+        m_oGazeTrackerPort.disableCallback();
+        m_oFaceTrackerPort.disableCallback();
+
     deleteAndNullify(m_pVelocityController);
+    deleteAndNullify(m_pHeadCallback);
+    deleteAndNullify(m_pGazeCallback);
+    deleteAndNullify(m_pFaceCallback);
 }
 
 bool swTeleop::SWIcubHead::init( yarp::os::ResourceFinder &oRf)
@@ -175,6 +185,10 @@ bool swTeleop::SWIcubHead::init( yarp::os::ResourceFinder &oRf)
         m_i32TimeoutGazeReset  = oRf.check("gazeTimeoutReset",   Value(m_i32TimeoutGazeResetDefault), "Gaze timeout reset iCub (int)").asInt();
         m_i32TimeoutLEDReset   = oRf.check("LEDTimeoutReset",    Value(m_i32TimeoutLEDResetDefault), "LED display timeout reset iCub (int)").asInt();
 
+    // targets filters
+        m_oHeadFilter.reset(3, readFilterParams(oRf, "head"));
+        m_oGazeFilter.reset(3, readFilterParams(oRf, "gaze"));
+
     // set polydriver options
         m_oHeadOptions.put("robot",     m_sRobotName.c_str());
         m_oHeadOptions.put("device",    "remote_controlboard");
@@ -199,6 +213,9 @@ bool swTeleop::SWIcubHead::init( yarp::os::ResourceFinder &oRf)
             return (m_bInitialized=false);
         }
 
+        // optional, the velocity controller commands the enabled joints one by one without it
+        m_oRobotHead.view(m_pIHeadVelocity2);
+
     // init ports
         m_sHeadTrackerPortName  = "/teleoperation/" + m_sRobotName + "/head";
         m_sGazeTrackerPortName  = "/teleoperation/" + m_sRobotName + "/gaze";
@@ -262,10 +279,35 @@ bool swTeleop::SWIcubHead::init( yarp::os::ResourceFinder &oRf)
         }
 
     // init controller
-        m_pVelocityController = new swTeleop::SWHeadVelocityController(m_pIHeadEncoders, m_pIHeadVelocity, m_vHeadJointVelocityK, m_i32RateVelocityControl);
+        m_pVelocityController = new swTeleop::SWHeadVelocityController(m_pIHeadEncoders, m_pIHeadVelocity, m_pIHeadVelocity2, m_vHeadJointVelocityK, m_i32RateVelocityControl);
         m_pVelocityController->enableHead(m_bHeadActivated);
         m_pVelocityController->enableGaze(m_bGazeActivated);
         m_pVelocityController->setMinMaxJoints(m_vHeadMinJoint, m_vHeadMaxJoint);
+        m_pVelocityController->timing().setVerbose(oRf.check("verboseVelocityControl", Value(0), "Display the velocity controller timing reports (int)").asInt() != 0);
+
+    // init event-driven input : the target joints are updated by the ports threads as soon as a bottle arrives
+        m_vHeadJoints.resize(m_i32HeadJointsNb);
+        m_vHeadJoints = 0.;
+        m_vHeadFilteredJoints.resize(m_i32HeadJointsNb);
+        m_vHeadFilteredJoints = 0.;
+        m_dHeadTimeLastBottle = m_dGazeTimeLastBottle = m_dLEDTimeLastBottle = yarp::os::Time::now();
+        m_bIsRunning = true;
+
+        if(m_bHeadActivated)
+        {
+            m_pHeadCallback = new SWInputCallback<SWIcubHead>(this, HEAD_INPUT);
+            m_oHeadTrackerPort.useCallback(*m_pHeadCallback);
+        }
+        if(m_bGazeActivated)
+        {
+            m_pGazeCallback = new SWInputCallback<SWIcubHead>(this, GAZE_INPUT);
+            m_oGazeTrackerPort.useCallback(*m_pGazeCallback);
+        }
+        if(m_bLEDActivated)
+        {
+            m_pFaceCallback = new SWInputCallback<SWIcubHead>(this, FACE_INPUT);
+            m_oFaceTrackerPort.useCallback(*m_pFaceCallback);
+        }
 
     // display parameters
         std::cout << std::endl << std::endl;
@@ -306,433 +348,443 @@ bool swTeleop::SWIcubHead::checkBottles()
         return (m_bIsRunning=false);
     }
 
-    // init command vector
-        yarp::sig::Vector l_vHeadJoints;
-        l_vHeadJoints.resize(m_i32HeadJointsNb);
-        l_vHeadJoints = 0.;
-
-    // defines bottles
-        Bottle *l_pHeadTarget = NULL, *l_pFaceTarget = NULL, *l_pGazeTarget = NULL;
+    // the bottles are read by the ports callbacks as soon as they arrive, manage only the timeouts and reset positions
+        double l_dNow = yarp::os::Time::now();
+        bool l_bLEDTimeout = false;
 
-    // read head command
-        if(m_bHeadActivated)
-        {
-            l_pHeadTarget = m_oHeadTrackerPort.read(false);
+        m_oInputMutex.lock();
 
-            if(l_pHeadTarget)
+            if(m_bHeadActivated && l_dNow - m_dHeadTimeLastBottle > 0.001 * m_i32TimeoutHeadReset)
             {
-                int l_deviceId = l_pHeadTarget->get(0).asInt();
-
-                switch(l_deviceId)
-                {
-                    case swTracking::DUMMY_LIB :
-                        {
-                            l_vHeadJoints[0] = l_pHeadTarget->get(1).asDouble();
-                            l_vHeadJoints[1] = l_pHeadTarget->get(2).asDouble();
-                            l_vHeadJoints[2] = l_pHeadTarget->get(3).asDouble();
-                        }
-                    break;
-                    case swTracking::FASTRAK_LIB :
-                        {
-                            l_vHeadJoints[0] = l_pHeadTarget->get(2).asDouble();
-                            l_vHeadJoints[1] = l_pHeadTarget->get(3).asDouble();
-                            l_vHeadJoints[2] = -(l_pHeadTarget->get(1).asDouble()-90.0);
-                        }
-                    break;
-			case swTracking::OCULUS_LIB :
-			{
-				l_vHeadJoints[0] = l_pHeadTarget->get(2).asDouble();
-				l_vHeadJoints[1] = -l_pHeadTarget->get(3).asDouble();
-				l_vHeadJoints[2] = l_pHeadTarget->get(1).asDouble();
-			}
-                    break;
-                    case swTracking::FOREST_LIB :
-                        {
-                            l_vHeadJoints[0] = -l_pHeadTarget->get(1).asDouble(); //head rotation "yes" [-40 30]
-                            l_vHeadJoints[1] = -l_pHeadTarget->get(3).asDouble(); //head rotation [-70 60]
-                            l_vHeadJoints[2] = -l_pHeadTarget->get(2).asDouble(); //head rotation "no" [-55 55]
-                        }
-                    break;
-                    case swTracking::COREDATA_LIB :
-                        {
-                            l_vHeadJoints[0] =  swUtil::rad2Deg(l_pHeadTarget->get(4).asDouble()); // up/down head
-                            l_vHeadJoints[1] = -swUtil::rad2Deg(l_pHeadTarget->get(6).asDouble()); // left/right head
-                            l_vHeadJoints[2] =  swUtil::rad2Deg(l_pHeadTarget->get(5).asDouble()); // head
-                        }
-                    break;
-                    case swTracking::EMICP_LIB :
-                        {
-                            l_vHeadJoints[0] = -l_pHeadTarget->get(4).asDouble(); // up/down head
-                            l_vHeadJoints[1] = -l_pHeadTarget->get(6).asDouble(); // left/right head
-                            l_vHeadJoints[2] = -l_pHeadTarget->get(5).asDouble(); // head
-                        }
-                    break;
-                    case swTracking::FACESHIFT_LIB :
-                        {
-                            l_vHeadJoints[0] = -swUtil::rad2Deg(l_pHeadTarget->get(4).asDouble()); // up/down head
-                            l_vHeadJoints[1] = swUtil::rad2Deg(l_pHeadTarget->get(6).asDouble()); // left/right head
-                            l_vHeadJoints[2] = swUtil::rad2Deg(l_pHeadTarget->get(5).asDouble()); // head
-                        }
-                    break;
-                    case swTracking::OPENNI_LIB :
-                    {
-                        std::vector<double> l_pointNeck(3), l_pointHead(3), l_pointLShoulder(3), l_pointRShoulder(3);
-                        l_pointNeck[0] = l_pHeadTarget->get(1).asDouble();
-                        l_pointNeck[1] = l_pHeadTarget->get(2).asDouble();
-                        l_pointNeck[2] = l_pHeadTarget->get(3).asDouble();
-                        l_pointHead[0] = l_pHeadTarget->get(4).asDouble();
-                        l_pointHead[1] = l_pHeadTarget->get(5).asDouble();
-                        l_pointHead[2] = l_pHeadTarget->get(6).asDouble();
-                        l_pointLShoulder[0] = l_pHeadTarget->get(7).asDouble();
-                        l_pointLShoulder[1] = l_pHeadTarget->get(8).asDouble();
-                        l_pointLShoulder[2] = l_pHeadTarget->get(9).asDouble();
-                        l_pointRShoulder[0] = l_pHeadTarget->get(10).asDouble();
-                        l_pointRShoulder[1] = l_pHeadTarget->get(11).asDouble();
-                        l_pointRShoulder[2] = l_pHeadTarget->get(12).asDouble();
-
-                        std::vector<double> l_vecClavicles  = swUtil::vec(l_pointLShoulder,	l_pointRShoulder);
-                        std::vector<double> l_vecHead       = swUtil::vec(l_pointNeck,		l_pointHead);
-                        std::vector<double> l_rpyHead = swUtil::computeRollPitchYaw(l_vecHead, l_vecClavicles);
-
-                        l_vHeadJoints[0] = -l_rpyHead[1];
-                        l_vHeadJoints[1] = -l_rpyHead[0];
-                        l_vHeadJoints[2] =  l_rpyHead[2];
-                    }
-                    break;
-                }
+                m_pVelocityController->enableHead(false);
+                resetHeadPosition();
+                m_oHeadFilter.reset();
+                m_dHeadTimeLastBottle = l_dNow;
+            }
 
-                m_dHeadTimeLastBottle = -1.;
-                m_pVelocityController->enableHead(true);
+            if(m_bGazeActivated && l_dNow - m_dGazeTimeLastBottle > 0.001 * m_i32TimeoutGazeReset)
+            {
+                m_pVelocityController->enableGaze(false);
+                resetGazePosition();
+                m_oGazeFilter.reset();
+                m_dGazeTimeLastBottle = l_dNow;
             }
-            else // manage timeout and reset position
+
+            if(m_bLEDActivated && l_dNow - m_dLEDTimeLastBottle > 0.001 * m_i32TimeoutLEDReset)
             {
-                if(m_dHeadTimeLastBottle < 0.)
-                {
-                    m_dHeadTimeLastBottle = yarp::os::Time::now();
-                }
-                else
-                {
-                    if(yarp::os::Time::now() - m_dHeadTimeLastBottle > 0.001 * m_i32TimeoutHeadReset)
-                    {
-                        m_pVelocityController->enableHead(false);
-                        resetHeadPosition();
-                        m_dHeadTimeLastBottle = -1.;
-                    }
-                }
+                l_bLEDTimeout = true;
+                m_dLEDTimeLastBottle = l_dNow;
             }
-        }
 
-    // read gaze commands
-        if(m_bGazeActivated)
+        m_oInputMutex.unlock();
+
+        if(l_bLEDTimeout)
         {
-            l_pGazeTarget = m_oGazeTrackerPort.read(false);
+            resetLEDS();
+        }
+
+    return true;
+}
 
-            if(l_pGazeTarget)
+void swTeleop::SWIcubHead::onBottle(cint i32Input, yarp::os::Bottle &oBottle)
+{
+    // the LED commands do not move any joint
+        if(i32Input == FACE_INPUT)
+        {
+            if(m_bIsRunning)
             {
-                int l_deviceId = l_pGazeTarget->get(0).asInt();
+                m_oFaceReader.read(this, oBottle);
 
-                switch(l_deviceId)
-                {
-                    case swTracking::FACESHIFT_LIB :
-                    {
+                m_oInputMutex.lock();
+                    m_dLEDTimeLastBottle = yarp::os::Time::now();
+                m_oInputMutex.unlock();
+            }
+            return;
+        }
 
-                        l_vHeadJoints[3] = -(l_pGazeTarget->get(1).asDouble() + l_pGazeTarget->get(3).asDouble())*0.5; // up/down eye [-35; +15]
-                        l_vHeadJoints[4] = -(l_pGazeTarget->get(2).asDouble() + l_pGazeTarget->get(4).asDouble())*0.5; // version angle [-50; 52] = (L+R)/2
-                        l_vHeadJoints[5] =  -l_pGazeTarget->get(2).asDouble() + l_pGazeTarget->get(4).asDouble();     // vergence angle [0 90] = R-L
-                    }
-                    break;
-                    case swTracking::DUMMY_LIB :
-                    {
-                        // eye position
-                            l_vHeadJoints[3] = l_pGazeTarget->get(1).asDouble();
-                            l_vHeadJoints[4] = l_pGazeTarget->get(2).asDouble();
-                            l_vHeadJoints[5] = l_pGazeTarget->get(3).asDouble();
-                    }
-                    break;
-                    case swTracking::TOBII_LIB :
-                    {
-			    // eye position
-			    int l_i32ScreenHeight = l_pGazeTarget->get(27).asInt();
-			    int l_i32ScreenWidth  = l_pGazeTarget->get(28).asInt();
-			    int l_i32DistanceInterEye  = l_pGazeTarget->get(29).asInt();
-
-			    double l_leftValidity = l_pGazeTarget->get(1).asDouble();
-			    double l_rightValidity = l_pGazeTarget->get(2).asDouble();
-
-			    std::vector<double> l_vRightEyePosition3D;
-			    l_vRightEyePosition3D.push_back(l_pGazeTarget->get(8).asDouble());
-			    l_vRightEyePosition3D.push_back(l_pGazeTarget->get(9).asDouble());
-			    l_vRightEyePosition3D.push_back(l_pGazeTarget->get(10).asDouble());
-			    std::vector<double> l_vRightGazePoint2D;
-			    l_vRightGazePoint2D.push_back(l_pGazeTarget->get(25).asDouble());
-			    l_vRightGazePoint2D.push_back(l_pGazeTarget->get(26).asDouble());
-
-			    std::vector<double> l_vLeftEyePosition3D;
-			    l_vLeftEyePosition3D.push_back(l_pGazeTarget->get(5).asDouble());
-			    l_vLeftEyePosition3D.push_back(l_pGazeTarget->get(6).asDouble());
-			    l_vLeftEyePosition3D.push_back(l_pGazeTarget->get(7).asDouble());
-			    std::vector<double> l_vLeftGazePoint2D;
-			    l_vLeftGazePoint2D.push_back(l_pGazeTarget->get(23).asDouble());
-			    l_vLeftGazePoint2D.push_back(l_pGazeTarget->get(24).asDouble());
-
-                            bool l_blink = (l_leftValidity + l_rightValidity) == 8;
-
-                            double l_subjectDistance, l_rightEyeRotationY, l_leftEyeRotationY, l_rightEyeRotationX, l_leftEyeRotationX;
-
-                            // TODO : simon code, check
-			    if(l_blink)
-			    {
-				// eye closure
-				Bottle &l_oFaceMotionBottle = m_oFaceHandlerPort.prepare();
-				l_oFaceMotionBottle.clear();
-				double l_dLeftEyeClosure = l_pGazeTarget->get(8).asDouble(), l_dRightEyeClosure = l_pGazeTarget->get(13).asDouble();
-				l_oFaceMotionBottle.addString(eyesOpeningCode(0.0, m_dMinEyelids, m_dMaxEyelids).c_str());
-				m_oFaceHandlerPort.write();
-			    }
-                            else
-			    {
-					if(l_leftValidity == 4) //Right eye only is valid
-					{
-						l_subjectDistance = l_vRightEyePosition3D[2];
-
-						l_rightEyeRotationY = (atan((l_vRightGazePoint2D[1] -0.5)*l_i32ScreenHeight/l_subjectDistance))*180/PI;
-						l_leftEyeRotationY  = l_rightEyeRotationY;  // we hypothesize that both eyes are going up/down synchronously
-						l_vHeadJoints[3] = -(l_leftEyeRotationY + l_rightEyeRotationY)/2;
-
-						l_rightEyeRotationX = (atan(((l_vRightGazePoint2D[0] -0.5)*l_i32ScreenWidth - l_i32DistanceInterEye/2)/l_subjectDistance))*180/PI;
-						l_leftEyeRotationX = l_rightEyeRotationX;
-						l_vHeadJoints[4] = (l_leftEyeRotationX + l_rightEyeRotationX)/2;
-						l_vHeadJoints[5] = -l_leftEyeRotationX + l_rightEyeRotationX;
-					}
-					else if(l_rightValidity == 4) // left eye is valid
-					{
-						l_subjectDistance = l_vLeftEyePosition3D[2];
-
-						l_leftEyeRotationY = (atan(l_vLeftGazePoint2D[1] -0.5) * l_i32ScreenHeight/l_subjectDistance)*180/PI;
-						l_rightEyeRotationY = l_leftEyeRotationY; // we hypothesize that both eyes are going up/down synchronously
-						l_vHeadJoints[3] = -(l_leftEyeRotationY + l_rightEyeRotationY)/2;
-
-						l_rightEyeRotationX = (atan(((l_vLeftGazePoint2D[0]-.5)*l_i32ScreenWidth-l_i32DistanceInterEye/2)/l_subjectDistance))*180/PI;
-						l_leftEyeRotationX = (atan(((l_vLeftGazePoint2D[0]-.5)*l_i32ScreenWidth+l_i32DistanceInterEye/2)/l_subjectDistance))*180/PI;
-						l_vHeadJoints[4] = (l_leftEyeRotationX + l_rightEyeRotationX)/2;
-						l_vHeadJoints[5] = -l_leftEyeRotationX + l_rightEyeRotationX;
-					}
-					else //Both eyes are valid - use the average of values
-					{
-						l_subjectDistance = (l_vLeftEyePosition3D[2] +  l_vRightEyePosition3D[2])/2;
-
-						l_leftEyeRotationY = (atan((l_vLeftGazePoint2D[1]-.5)*l_i32ScreenHeight/l_subjectDistance))*180/PI;
-						l_rightEyeRotationY = (atan((l_vRightGazePoint2D[1]-.5)*l_i32ScreenHeight/l_subjectDistance))*180/PI;
-						l_vHeadJoints[3] = -(l_leftEyeRotationY + l_rightEyeRotationY)/2;
-
-						l_rightEyeRotationX = (atan(((l_vRightGazePoint2D[0]-.5)*l_i32ScreenWidth-l_i32DistanceInterEye/2)/l_subjectDistance))*180/PI;
-						l_leftEyeRotationX = (atan(((l_vLeftGazePoint2D[0]-.5)*l_i32ScreenWidth+l_i32DistanceInterEye/2)/l_subjectDistance))*180/PI;
-						l_vHeadJoints[4] = (l_leftEyeRotationX + l_rightEyeRotationX)/2;
-						l_vHeadJoints[5] = -l_leftEyeRotationX + l_rightEyeRotationX;
-					}
-				
-				// eye closure
-				Bottle &l_oFaceMotionBottle = m_oFaceHandlerPort.prepare();
-				l_oFaceMotionBottle.clear();
-				double l_dLeftEyeClosure = l_pGazeTarget->get(8).asDouble(), l_dRightEyeClosure = l_pGazeTarget->get(13).asDouble();
-				l_oFaceMotionBottle.addString(eyesOpeningCode(1.0, m_dMinEyelids, m_dMaxEyelids).c_str());
-				m_oFaceHandlerPort.write();
-					
-			}
-                    }
-                    break;
-                    case swTracking::COREDATA_LIB :
-                    {
-                        // eye position
-                            l_vHeadJoints[3] = swUtil::rad2Deg( (l_pGazeTarget->get(9) .asDouble() + l_pGazeTarget->get(14).asDouble())/2.); // up/down eye [-35; +15]
-                            l_vHeadJoints[4] = swUtil::rad2Deg(-(l_pGazeTarget->get(10).asDouble() + l_pGazeTarget->get(15).asDouble())/2.); // version angle [-50; 52] = (L+R)/2
-                            l_vHeadJoints[5] = swUtil::rad2Deg( -l_pGazeTarget->get(10).asDouble() + l_pGazeTarget->get(15).asDouble());     // vergence angle [0 90] = R-L
-
-                        // eye closure
-                            Bottle &l_oFaceMotionBottle = m_oFaceHandlerPort.prepare();
-                            l_oFaceMotionBottle.clear();
-                            double l_dLeftEyeClosure = l_pGazeTarget->get(8).asDouble(), l_dRightEyeClosure = l_pGazeTarget->get(13).asDouble();
-                            l_oFaceMotionBottle.addString(eyesOpeningCode((1.0-(l_dLeftEyeClosure + l_dRightEyeClosure)/2.0), m_dMinEyelids, m_dMaxEyelids).c_str());
-                            m_oFaceHandlerPort.write();
-                    }
-                    break;
-                }
+    m_oInputMutex.lock();
 
-                m_dGazeTimeLastBottle = -1.;
+        if(!m_bIsRunning)
+        {
+            m_oInputMutex.unlock();
+            return;
+        }
+
+        // update the joints of the port, the joints of the other port keep their last values
+        // the raw targets of the port are filtered into a separate buffer before being cropped, the filter never sees its own output
+            if(i32Input == HEAD_INPUT)
+            {
+                m_oHeadReader.read(this, oBottle);
+                m_dHeadTimeLastBottle = yarp::os::Time::now();
+                m_oHeadFilter.filter(m_vHeadJoints.data(), m_vHeadFilteredJoints.data(), 3, m_dHeadTimeLastBottle);
+                m_pVelocityController->enableHead(true);
+            }
+            else
+            {
+                m_oGazeReader.read(this, oBottle);
+                m_dGazeTimeLastBottle = yarp::os::Time::now();
+                m_oGazeFilter.filter(m_vHeadJoints.data() + 3, m_vHeadFilteredJoints.data() + 3, 3, m_dGazeTimeLastBottle);
                 m_pVelocityController->enableGaze(true);
             }
-            else // manage timeout and reset position
+
+        // check each joint value to ensure it is in the right range, if not crop to the max/min values
+            for(uint ii = 0; ii < m_vHeadFilteredJoints.size(); ++ii)
             {
-                if(m_dGazeTimeLastBottle < 0.)
+                if(m_vHeadFilteredJoints[ii] < m_vHeadMinJoint[ii])
                 {
-                    m_dGazeTimeLastBottle = yarp::os::Time::now();
+                    m_vHeadFilteredJoints[ii] = m_vHeadMinJoint[ii];
                 }
-                else
+                if(m_vHeadFilteredJoints[ii] > m_vHeadMaxJoint[ii])
                 {
-                    if(yarp::os::Time::now() - m_dGazeTimeLastBottle > 0.001 * m_i32TimeoutGazeReset)
-                    {
-                        m_pVelocityController->enableGaze(false);
-                        resetGazePosition();
-                        m_dGazeTimeLastBottle = -1.;
-                    }
+                    m_vHeadFilteredJoints[ii] = m_vHeadMaxJoint[ii];
                 }
             }
-        }
 
-    // read face commands
-        if(m_bLEDActivated)
+        m_pVelocityController->setJoints(m_vHeadFilteredJoints);
+
+        if(!m_pVelocityController->isRunning())
         {
-            l_pFaceTarget = m_oFaceTrackerPort.read(false);
+            m_pVelocityController->start(); // TODO : check
+        }
 
-            if(l_pFaceTarget)
+    m_oInputMutex.unlock();
+}
+
+swTeleop::SWIcubHead::SWHeadReader swTeleop::SWIcubHead::headReader(cint i32DeviceId)
+{
+    switch(i32DeviceId)
+    {
+        case swTracking::DUMMY_LIB :
+            return &SWIcubHead::readHeadDummy;
+        case swTracking::FASTRAK_LIB :
+            return &SWIcubHead::readHeadFastrak;
+        case swTracking::OCULUS_LIB :
+            return &SWIcubHead::readHeadOculus;
+        case swTracking::FOREST_LIB :
+            return &SWIcubHead::readHeadForest;
+        case swTracking::COREDATA_LIB :
+            return &SWIcubHead::readHeadCoredata;
+        case swTracking::EMICP_LIB :
+            return &SWIcubHead::readHeadEmicp;
+        case swTracking::FACESHIFT_LIB :
+            return &SWIcubHead::readHeadFaceshift;
+        case swTracking::OPENNI_LIB :
+            return &SWIcubHead::readHeadOpenni;
+    }
+
+    return NULL;
+}
+
+swTeleop::SWIcubHead::SWHeadReader swTeleop::SWIcubHead::gazeReader(cint i32DeviceId)
+{
+    switch(i32DeviceId)
+    {
+        case swTracking::FACESHIFT_LIB :
+            return &SWIcubHead::readGazeFaceshift;
+        case swTracking::DUMMY_LIB :
+            return &SWIcubHead::readGazeDummy;
+        case swTracking::TOBII_LIB :
+            return &SWIcubHead::readGazeTobii;
+        case swTracking::COREDATA_LIB :
+            return &SWIcubHead::readGazeCoredata;
+    }
+
+    return NULL;
+}
+
+swTeleop::SWIcubHead::SWHeadReader swTeleop::SWIcubHead::faceReader(cint i32DeviceId)
+{
+    switch(i32DeviceId)
+    {
+        case swTracking::FACESHIFT_LIB :
+            return &SWIcubHead::readFaceFaceshift;
+        case swTracking::COREDATA_LIB :
+            return &SWIcubHead::readFaceCoredata;
+    }
+
+    return NULL;
+}
+
+void swTeleop::SWIcubHead::readHeadDummy(yarp::os::Bottle &oBottle)
+{
+    m_vHeadJoints[0] = oBottle.get(1).asDouble();
+    m_vHeadJoints[1] = oBottle.get(2).asDouble();
+    m_vHeadJoints[2] = oBottle.get(3).asDouble();
+}
+
+void swTeleop::SWIcubHead::readHeadFastrak(yarp::os::Bottle &oBottle)
+{
+    m_vHeadJoints[0] = oBottle.get(2).asDouble();
+    m_vHeadJoints[1] = oBottle.get(3).asDouble();
+    m_vHeadJoints[2] = -(oBottle.get(1).asDouble()-90.0);
+}
+
+void swTeleop::SWIcubHead::readHeadOculus(yarp::os::Bottle &oBottle)
+{
+    m_vHeadJoints[0] = oBottle.get(2).asDouble();
+    m_vHeadJoints[1] = -oBottle.get(3).asDouble();
+    m_vHeadJoints[2] = oBottle.get(1).asDouble();
+}
+
+void swTeleop::SWIcubHead::readHeadForest(yarp::os::Bottle &oBottle)
+{
+    m_vHeadJoints[0] = -oBottle.get(1).asDouble(); //head rotation "yes" [-40 30]
+    m_vHeadJoints[1] = -oBottle.get(3).asDouble(); //head rotation [-70 60]
+    m_vHeadJoints[2] = -oBottle.get(2).asDouble(); //head rotation "no" [-55 55]
+}
+
+void swTeleop::SWIcubHead::readHeadCoredata(yarp::os::Bottle &oBottle)
+{
+    m_vHeadJoints[0] =  swUtil::rad2Deg(oBottle.get(4).asDouble()); // up/down head
+    m_vHeadJoints[1] = -swUtil::rad2Deg(oBottle.get(6).asDouble()); // left/right head
+    m_vHeadJoints[2] =  swUtil::rad2Deg(oBottle.get(5).asDouble()); // head
+}
+
+void swTeleop::SWIcubHead::readHeadEmicp(yarp::os::Bottle &oBottle)
+{
+    m_vHeadJoints[0] = -oBottle.get(4).asDouble(); // up/down head
+    m_vHeadJoints[1] = -oBottle.get(6).asDouble(); // left/right head
+    m_vHeadJoints[2] = -oBottle.get(5).asDouble(); // head
+}
+
+void swTeleop::SWIcubHead::readHeadFaceshift(yarp::os::Bottle &oBottle)
+{
+    m_vHeadJoints[0] = -swUtil::rad2Deg(oBottle.get(4).asDouble()); // up/down head
+    m_vHeadJoints[1] = swUtil::rad2Deg(oBottle.get(6).asDouble()); // left/right head
+    m_vHeadJoints[2] = swUtil::rad2Deg(oBottle.get(5).asDouble()); // head
+}
+
+void swTeleop::SWIcubHead::readHeadOpenni(yarp::os::Bottle &oBottle)
+{
+    std::vector<double> l_pointNeck(3), l_pointHead(3), l_pointLShoulder(3), l_pointRShoulder(3);
+    l_pointNeck[0] = oBottle.get(1).asDouble();
+    l_pointNeck[1] = oBottle.get(2).asDouble();
+    l_pointNeck[2] = oBottle.get(3).asDouble();
+    l_pointHead[0] = oBottle.get(4).asDouble();
+    l_pointHead[1] = oBottle.get(5).asDouble();
+    l_pointHead[2] = oBottle.get(6).asDouble();
+    l_pointLShoulder[0] = oBottle.get(7).asDouble();
+    l_pointLShoulder[1] = oBottle.get(8).asDouble();
+    l_pointLShoulder[2] = oBottle.get(9).asDouble();
+    l_pointRShoulder[0] = oBottle.get(10).asDouble();
+    l_pointRShoulder[1] = oBottle.get(11).asDouble();
+    l_pointRShoulder[2] = oBottle.get(12).asDouble();
+
+    std::vector<double> l_vecClavicles  = swUtil::vec(l_pointLShoulder,	l_pointRShoulder);
+    std::vector<double> l_vecHead       = swUtil::vec(l_pointNeck,		l_pointHead);
+    std::vector<double> l_rpyHead = swUtil::computeRollPitchYaw(l_vecHead, l_vecClavicles);
+
+    m_vHeadJoints[0] = -l_rpyHead[1];
+    m_vHeadJoints[1] = -l_rpyHead[0];
+    m_vHeadJoints[2] =  l_rpyHead[2];
+}
+
+void swTeleop::SWIcubHead::readGazeFaceshift(yarp::os::Bottle &oBottle)
+{
+    m_vHeadJoints[3] = -(oBottle.get(1).asDouble() + oBottle.get(3).asDouble())*0.5; // up/down eye [-35; +15]
+    m_vHeadJoints[4] = -(oBottle.get(2).asDouble() + oBottle.get(4).asDouble())*0.5; // version angle [-50; 52] = (L+R)/2
+    m_vHeadJoints[5] =  -oBottle.get(2).asDouble() + oBottle.get(4).asDouble();     // vergence angle [0 90] = R-L
+}
+
+void swTeleop::SWIcubHead::readGazeDummy(yarp::os::Bottle &oBottle)
+{
+    // eye position
+        m_vHeadJoints[3] = oBottle.get(1).asDouble();
+        m_vHeadJoints[4] = oBottle.get(2).asDouble();
+        m_vHeadJoints[5] = oBottle.get(3).asDouble();
+}
+
+void swTeleop::SWIcubHead::readGazeTobii(yarp::os::Bottle &oBottle)
+{
+    // eye position
+        int l_i32ScreenHeight = oBottle.get(27).asInt();
+        int l_i32ScreenWidth  = oBottle.get(28).asInt();
+        int l_i32DistanceInterEye  = oBottle.get(29).asInt();
+
+        double l_leftValidity = oBottle.get(1).asDouble();
+        double l_rightValidity = oBottle.get(2).asDouble();
+
+        std::vector<double> l_vRightEyePosition3D;
+        l_vRightEyePosition3D.push_back(oBottle.get(8).asDouble());
+        l_vRightEyePosition3D.push_back(oBottle.get(9).asDouble());
+        l_vRightEyePosition3D.push_back(oBottle.get(10).asDouble());
+        std::vector<double> l_vRightGazePoint2D;
+        l_vRightGazePoint2D.push_back(oBottle.get(25).asDouble());
+        l_vRightGazePoint2D.push_back(oBottle.get(26).asDouble());
+
+        std::vector<double> l_vLeftEyePosition3D;
+        l_vLeftEyePosition3D.push_back(oBottle.get(5).asDouble());
+        l_vLeftEyePosition3D.push_back(oBottle.get(6).asDouble());
+        l_vLeftEyePosition3D.push_back(oBottle.get(7).asDouble());
+        std::vector<double> l_vLeftGazePoint2D;
+        l_vLeftGazePoint2D.push_back(oBottle.get(23).asDouble());
+        l_vLeftGazePoint2D.push_back(oBottle.get(24).asDouble());
+
+        bool l_blink = (l_leftValidity + l_rightValidity) == 8;
+
+        double l_subjectDistance, l_rightEyeRotationY, l_leftEyeRotationY, l_rightEyeRotationX, l_leftEyeRotationX;
+
+        // TODO : simon code, check
+        if(l_blink)
+        {
+            // eye closure
+            sendFaceCommand(eyesOpeningCode(0.0, m_dMinEyelids, m_dMaxEyelids));
+        }
+        else
+        {
+            if(l_leftValidity == 4) //Right eye only is valid
             {
-                int l_deviceId = l_pFaceTarget->get(0).asInt();
+                l_subjectDistance = l_vRightEyePosition3D[2];
 
-                switch(l_deviceId)
-                {
-                    case swTracking::FACESHIFT_LIB :
-                    {
-                    //           0 brow_left_center
-                    //           1 brow_left_inner
-                    //           2 brow_left_outer
-                    //           3 brow_right_center
-                    //           4 brow_right_inner
-                    //           5 brow_right_outer
-                    //           6 mouth_center_lower
-                    //           7 mouth_center_philtrum
-                    //           8 mouth_down_left_1
-                    //           9 mouth_down_left_2
-                    //           10 mouth_down_right_1
-                    //           11 mouth_down_right_2
-                    //           12 mouth_inner_down
-                    //           13 mouth_inner_down_left
-                    //           14 mouth_inner_down_right
-                    //           15 mouth_inner_up
-                    //           16 mouth_inner_up_left
-                    //           17 mouth_inner_up_right
-                    //           18 mouth_left_corner
-                    //           19 mouth_left_philtrum
-                    //           20 mouth_right_corner
-                    //           21 mouth_right_philtrum
-                    //           22 mouth_up_left_1
-                    //           23 mouth_up_left_2
-                    //           24 mouth_up_right_1
-                    //           25 mouth_up_right_2
-                    //           26 nose_tip
-                    //           27 chin
-
-                        std::vector<double> l_vMouthInnerUp(3,0.0);
-                        l_vMouthInnerUp[0] = l_pFaceTarget->get(46).asDouble();
-                        l_vMouthInnerUp[1] = l_pFaceTarget->get(47).asDouble();
-                        l_vMouthInnerUp[2] = l_pFaceTarget->get(48).asDouble();
-                        std::vector<double> l_vMouthInnerDown(3,0.0);
-                        l_vMouthInnerDown[0] = l_pFaceTarget->get(37).asDouble();
-                        l_vMouthInnerDown[1] = l_pFaceTarget->get(38).asDouble();
-                        l_vMouthInnerDown[2] = l_pFaceTarget->get(39).asDouble();
-
-                        double l_dLipsDistance = swUtil::norm(swUtil::vec(l_vMouthInnerUp,l_vMouthInnerDown));
-                        std::string l_sMouthCmd("M08");
-                        if(l_dLipsDistance > 0.001)
-                        {
-                            l_sMouthCmd = "M16";
-                        }
-
-                        // mouth
-                            Bottle &l_oFaceMotionBottle = m_oFaceHandlerPort.prepare();
-                            l_oFaceMotionBottle.clear();
-                            l_oFaceMotionBottle.addString(l_sMouthCmd.c_str());
-                            m_oFaceHandlerPort.write();
-                            Time::delay(0.001);
-                    }
-                    break;
-                    case swTracking::COREDATA_LIB :
-                    {
-                        Bottle &l_oFaceMotionBottle = m_oFaceHandlerPort.prepare();
-                        // retrieve values
-                            // eyebrows
-                            std::vector<double> l_vLeftEyeBrowPoints, l_vRightEyeBrowPoints;
-                            for(int ii = 0; ii < 9; ++ii)
-                            {
-                                l_vLeftEyeBrowPoints.push_back(l_pFaceTarget->get(52+ii).asDouble());
-                                l_vRightEyeBrowPoints.push_back(l_pFaceTarget->get(43+ii).asDouble());
-                            }
-
-                            // mouth
-                            std::vector<double> l_vInnerLip2, l_vInnerLip6;
-                            for(int ii = 0; ii < 3; ++ii)
-                            {
-                                l_vInnerLip2.push_back(l_pFaceTarget->get(25+ii).asDouble());
-                                l_vInnerLip6.push_back(l_pFaceTarget->get(37+ii).asDouble());
-                            }
-
-                            std::string l_sNewMouth         = m_ICubFaceLabLED.lipCommand(l_vInnerLip2, l_vInnerLip6);
-                            std::string l_sNewLeftEyebrow   = m_ICubFaceLabLED.leftEyeBrowCommand(l_vLeftEyeBrowPoints);
-                            std::string l_sNewRightEyebrow  = m_ICubFaceLabLED.rightEyeBrowCommand(l_vRightEyeBrowPoints);
-
-                            // mouth
-                                l_oFaceMotionBottle.clear();
-                                l_oFaceMotionBottle.addString(l_sNewMouth.c_str());
-                                m_oFaceHandlerPort.write();
-                                Time::delay(0.001);
-
-                            // left eyebrow
-                                l_oFaceMotionBottle.clear();
-                                l_oFaceMotionBottle.addString(l_sNewLeftEyebrow.c_str());
-                                m_oFaceHandlerPort.write();
-                                Time::delay(0.001);
-
-                            // right eyebrow
-                                l_oFaceMotionBottle.clear();
-                                l_oFaceMotionBottle.addString(l_sNewRightEyebrow.c_str());
-                                m_oFaceHandlerPort.write();
-                                Time::delay(0.001);
-                    }
-                    break;
-                }
+                l_rightEyeRotationY = (atan((l_vRightGazePoint2D[1] -0.5)*l_i32ScreenHeight/l_subjectDistance))*180/PI;
+                l_leftEyeRotationY  = l_rightEyeRotationY;  // we hypothesize that both eyes are going up/down synchronously
+                m_vHeadJoints[3] = -(l_leftEyeRotationY + l_rightEyeRotationY)/2;
 
-                m_dLEDTimeLastBottle = -1.;
+                l_rightEyeRotationX = (atan(((l_vRightGazePoint2D[0] -0.5)*l_i32ScreenWidth - l_i32DistanceInterEye/2)/l_subjectDistance))*180/PI;
+                l_leftEyeRotationX = l_rightEyeRotationX;
+                m_vHeadJoints[4] = (l_leftEyeRotationX + l_rightEyeRotationX)/2;
+                m_vHeadJoints[5] = -l_leftEyeRotationX + l_rightEyeRotationX;
             }
-            else // manage timeout and reset position
+            else if(l_rightValidity == 4) // left eye is valid
             {
-                if(m_dLEDTimeLastBottle < 0.)
-                {
-                    m_dLEDTimeLastBottle = yarp::os::Time::now();
-                }
-                else
-                {
-                    if(yarp::os::Time::now() - m_dLEDTimeLastBottle > 0.001 * m_i32TimeoutLEDReset)
-                    {
-                        resetLEDS();
-                        m_dLEDTimeLastBottle = -1.;
-                    }
-                }
-            }
-        }
+                l_subjectDistance = l_vLeftEyePosition3D[2];
 
-    // check each joint value to ensure it is in the right range, if not crop to the max/min values
-        for(uint ii = 0; ii < l_vHeadJoints.size(); ++ii)
-        {
-            if(l_vHeadJoints[ii] < m_vHeadMinJoint[ii])
-            {
-                l_vHeadJoints[ii] = m_vHeadMinJoint[ii];
+                l_leftEyeRotationY = (atan(l_vLeftGazePoint2D[1] -0.5) * l_i32ScreenHeight/l_subjectDistance)*180/PI;
+                l_rightEyeRotationY = l_leftEyeRotationY; // we hypothesize that both eyes are going up/down synchronously
+                m_vHeadJoints[3] = -(l_leftEyeRotationY + l_rightEyeRotationY)/2;
+
+                l_rightEyeRotationX = (atan(((l_vLeftGazePoint2D[0]-.5)*l_i32ScreenWidth-l_i32DistanceInterEye/2)/l_subjectDistance))*180/PI;
+                l_leftEyeRotationX = (atan(((l_vLeftGazePoint2D[0]-.5)*l_i32ScreenWidth+l_i32DistanceInterEye/2)/l_subjectDistance))*180/PI;
+                m_vHeadJoints[4] = (l_leftEyeRotationX + l_rightEyeRotationX)/2;
+                m_vHeadJoints[5] = -l_leftEyeRotationX + l_rightEyeRotationX;
             }
-            if(l_vHeadJoints[ii] > m_vHeadMaxJoint[ii])
+            else //Both eyes are valid - use the average of values
             {
-                l_vHeadJoints[ii] = m_vHeadMaxJoint[ii];
+                l_subjectDistance = (l_vLeftEyePosition3D[2] +  l_vRightEyePosition3D[2])/2;
+
+                l_leftEyeRotationY = (atan((l_vLeftGazePoint2D[1]-.5)*l_i32ScreenHeight/l_subjectDistance))*180/PI;
+                l_rightEyeRotationY = (atan((l_vRightGazePoint2D[1]-.5)*l_i32ScreenHeight/l_subjectDistance))*180/PI;
+                m_vHeadJoints[3] = -(l_leftEyeRotationY + l_rightEyeRotationY)/2;
+
+                l_rightEyeRotationX = (atan(((l_vRightGazePoint2D[0]-.5)*l_i32ScreenWidth-l_i32DistanceInterEye/2)/l_subjectDistance))*180/PI;
+                l_leftEyeRotationX = (atan(((l_vLeftGazePoint2D[0]-.5)*l_i32ScreenWidth+l_i32DistanceInterEye/2)/l_subjectDistance))*180/PI;
+                m_vHeadJoints[4] = (l_leftEyeRotationX + l_rightEyeRotationX)/2;
+                m_vHeadJoints[5] = -l_leftEyeRotationX + l_rightEyeRotationX;
             }
+
+            // eye closure
+            sendFaceCommand(eyesOpeningCode(1.0, m_dMinEyelids, m_dMaxEyelids));
         }
+}
+
+void swTeleop::SWIcubHead::readGazeCoredata(yarp::os::Bottle &oBottle)
+{
+    // eye position
+        m_vHeadJoints[3] = swUtil::rad2Deg( (oBottle.get(9) .asDouble() + oBottle.get(14).asDouble())/2.); // up/down eye [-35; +15]
+        m_vHeadJoints[4] = swUtil::rad2Deg(-(oBottle.get(10).asDouble() + oBottle.get(15).asDouble())/2.); // version angle [-50; 52] = (L+R)/2
+        m_vHeadJoints[5] = swUtil::rad2Deg( -oBottle.get(10).asDouble() + oBottle.get(15).asDouble());     // vergence angle [0 90] = R-L
+
+    // eye closure
+        double l_dLeftEyeClosure = oBottle.get(8).asDouble(), l_dRightEyeClosure = oBottle.get(13).asDouble();
+        sendFaceCommand(eyesOpeningCode((1.0-(l_dLeftEyeClosure + l_dRightEyeClosure)/2.0), m_dMinEyelids, m_dMaxEyelids));
+}
+
+void swTeleop::SWIcubHead::readFaceFaceshift(yarp::os::Bottle &oBottle)
+{
+    //           0 brow_left_center
+    //           1 brow_left_inner
+    //           2 brow_left_outer
+    //           3 brow_right_center
+    //           4 brow_right_inner
+    //           5 brow_right_outer
+    //           6 mouth_center_lower
+    //           7 mouth_center_philtrum
+    //           8 mouth_down_left_1
+    //           9 mouth_down_left_2
+    //           10 mouth_down_right_1
+    //           11 mouth_down_right_2
+    //           12 mouth_inner_down
+    //           13 mouth_inner_down_left
+    //           14 mouth_inner_down_right
+    //           15 mouth_inner_up
+    //           16 mouth_inner_up_left
+    //           17 mouth_inner_up_right
+    //           18 mouth_left_corner
+    //           19 mouth_left_philtrum
+    //           20 mouth_right_corner
+    //           21 mouth_right_philtrum
+    //           22 mouth_up_left_1
+    //           23 mouth_up_left_2
+    //           24 mouth_up_right_1
+    //           25 mouth_up_right_2
+    //           26 nose_tip
+    //           27 chin
+
+    std::vector<double> l_vMouthInnerUp(3,0.0);
+    l_vMouthInnerUp[0] = oBottle.get(46).asDouble();
+    l_vMouthInnerUp[1] = oBottle.get(47).asDouble();
+    l_vMouthInnerUp[2] = oBottle.get(48).asDouble();
+    std::vector<double> l_vMouthInnerDown(3,0.0);
+    l_vMouthInnerDown[0] = oBottle.get(37).asDouble();
+    l_vMouthInnerDown[1] = oBottle.get(38).asDouble();
+    l_vMouthInnerDown[2] = oBottle.get(39).asDouble();
+
+    double l_dLipsDistance = swUtil::norm(swUtil::vec(l_vMouthInnerUp,l_vMouthInnerDown));
+    std::string l_sMouthCmd("M08");
+    if(l_dLipsDistance > 0.001)
+    {
+        l_sMouthCmd = "M16";
+    }
 
-        if(l_pHeadTarget || l_pGazeTarget)
+    // mouth
+        sendFaceCommand(l_sMouthCmd);
+        Time::delay(0.001);
+}
+
+void swTeleop::SWIcubHead::readFaceCoredata(yarp::os::Bottle &oBottle)
+{
+    // retrieve values
+        // eyebrows
+        std::vector<double> l_vLeftEyeBrowPoints, l_vRightEyeBrowPoints;
+        for(int ii = 0; ii < 9; ++ii)
         {
-            m_pVelocityController->setJoints(l_vHeadJoints);
+            l_vLeftEyeBrowPoints.push_back(oBottle.get(52+ii).asDouble());
+            l_vRightEyeBrowPoints.push_back(oBottle.get(43+ii).asDouble());
+        }
 
-            if(!m_pVelocityController->isRunning())
-            {
-                m_pVelocityController->start(); // TODO : check
-            }
+        // mouth
+        std::vector<double> l_vInnerLip2, l_vInnerLip6;
+        for(int ii = 0; ii < 3; ++ii)
+        {
+            l_vInnerLip2.push_back(oBottle.get(25+ii).asDouble());
+            l_vInnerLip6.push_back(oBottle.get(37+ii).asDouble());
         }
 
-    return true;
+        std::string l_sNewMouth         = m_ICubFaceLabLED.lipCommand(l_vInnerLip2, l_vInnerLip6);
+        std::string l_sNewLeftEyebrow   = m_ICubFaceLabLED.leftEyeBrowCommand(l_vLeftEyeBrowPoints);
+        std::string l_sNewRightEyebrow  = m_ICubFaceLabLED.rightEyeBrowCommand(l_vRightEyeBrowPoints);
+
+        // mouth
+            sendFaceCommand(l_sNewMouth);
+            Time::delay(0.001);
+
+        // left eyebrow
+            sendFaceCommand(l_sNewLeftEyebrow);
+            Time::delay(0.001);
+
+        // right eyebrow
+            sendFaceCommand(l_sNewRightEyebrow);
+            Time::delay(0.001);
+}
+
+void swTeleop::SWIcubHead::sendFaceCommand(const std::string &sCommand)
+{
+    m_oFaceHandlerMutex.lock();
+        Bottle &l_oFaceMotionBottle = m_oFaceHandlerPort.prepare();
+        l_oFaceMotionBottle.clear();
+        l_oFaceMotionBottle.addString(sCommand.c_str());
+        m_oFaceHandlerPort.write();
+    m_oFaceHandlerMutex.unlock();
 }
 
 
@@ -757,10 +809,7 @@ void swTeleop::SWIcubHead::resetGazePosition()
         }
 
         // eye closure
-            Bottle &l_oFaceMotionBottle = m_oFaceHandlerPort.prepare();
-            l_oFaceMotionBottle.clear();
-            l_oFaceMotionBottle.addString(std::string(eyesOpeningCode(1., m_dMinEyelids, m_dMaxEyelids)).c_str());
-            m_oFaceHandlerPort.write();
+            sendFaceCommand(eyesOpeningCode(1., m_dMinEyelids, m_dMaxEyelids));
     }
 }
 
@@ -768,24 +817,16 @@ void swTeleop::SWIcubHead::resetLEDS()
 {
     if(m_bLEDActivated)
     {
-        Bottle &l_oFaceMotionBottle = m_oFaceHandlerPort.prepare();
-
             // mouth
-                l_oFaceMotionBottle.clear();
-                l_oFaceMotionBottle.addString(std::string("M08").c_str());
-                m_oFaceHandlerPort.write();
+                sendFaceCommand("M08");
                 Time::delay(0.001);
 
             // left eyebrow
-                l_oFaceMotionBottle.clear();
-                l_oFaceMotionBottle.addString(std::string("L02").c_str());
-                m_oFaceHandlerPort.write();
+                sendFaceCommand("L02");
                 Time::delay(0.001);
 
             // right eyebrow
-                l_oFaceMotionBottle.clear();
-                l_oFaceMotionBottle.addString(std::string("R02").c_str());
-                m_oFaceHandlerPort.write();
+                sendFaceCommand("R02");
                 Time::delay(0.001);
     }
 }
@@ -822,7 +863,9 @@ bool swTeleop::SWIcubHead::close()
 
 bool swTeleop::SWIcubHead::interruptModule()
 {
-    m_bIsRunning = false;
+    // no bottle will update the joints or restart the controller after this point
+    m_oInputMutex.lock();
+        m_bIsRunning = false;
 
     // reset positions
         if(m_bHeadActivated)
@@ -833,6 +876,7 @@ bool swTeleop::SWIcubHead::interruptModule()
         {
             resetGazePosition();
         }
+    m_oInputMutex.unlock();
         if(m_bLEDActivated)
         {
             resetLEDS();
@@ -875,8 +919,9 @@ std::string swTeleop::SWIcubHead::eyesOpeningCode(cdouble dEyeLids, cdouble dMin
 }
 
 swTeleop::SWHeadVelocityController::SWHeadVelocityController(yarp::dev::IEncoders *pIHeadEncoders, yarp::dev::IVelocityControl *pIHeadVelocity,
-                                                     std::vector<double> &vHeadJointVelocityK, int i32Rate)
-    : RateThread(i32Rate), m_bHeadEnabled(false), m_bGazeEnabled(false) , m_vHeadJointVelocityK(vHeadJointVelocityK)
+                                                     yarp::dev::IVelocityControl2 *pIHeadVelocity2, std::vector<double> &vHeadJointVelocityK, int i32Rate)
+    : RateThread(i32Rate), m_bGazeEnabled(false), m_bHeadEnabled(false), m_pIHeadEncoders(NULL), m_pIHeadVelocity(NULL), m_pIHeadVelocity2(pIHeadVelocity2),
+      m_vHeadJointVelocityK(vHeadJointVelocityK), m_i32JointsNb(0), m_oTiming("Head")
 {   
     if(pIHeadEncoders)
     {
@@ -885,30 +930,55 @@ swTeleop::SWHeadVelocityController::SWHeadVelocityController(yarp::dev::IEncoder
     if(pIHeadVelocity)
     {
         m_pIHeadVelocity = pIHeadVelocity;
+        m_pIHeadVelocity->getAxes(&m_i32JointsNb);
     }    
+
+    // buffers are allocated once, run() only writes into them
+        m_vJoints.resize(m_i32JointsNb, 0.0);
+        m_vEncoders.resize(m_i32JointsNb, 0.0);
+        m_vCommand.resize(m_i32JointsNb, 0.0);
+        m_vEnabledJoints.resize(m_i32JointsNb, 0);
+        m_vEnabledCommand.resize(m_i32JointsNb, 0.0);
 }
 
 void swTeleop::SWHeadVelocityController::run()
 {
+    m_oTiming.startTick();
+
     m_oMutex.lock();
         bool l_bHeadEnabled = m_bHeadEnabled;
         bool l_bGazeEnabled = m_bGazeEnabled;
-        yarp::sig::Vector l_vHeadJoints = m_vLastHeadJoint;
+        int l_i32JointsNb = static_cast<int>(m_vLastHeadJoint.size());
+        l_i32JointsNb = (l_i32JointsNb < m_i32JointsNb) ? l_i32JointsNb : m_i32JointsNb;
+
+        for(int ii = 0; ii < l_i32JointsNb; ++ii)
+        {
+            m_vJoints[ii] = m_vLastHeadJoint[ii];
+        }
     m_oMutex.unlock();
 
-    yarp::sig::Vector l_vEncoders, l_vCommand;
-    l_vEncoders.resize(l_vHeadJoints.size());
-    l_vCommand.resize(l_vHeadJoints.size());
+    if(l_i32JointsNb == 0 || (!l_bHeadEnabled && !l_bGazeEnabled))
+    {
+        m_oTiming.stopTick(getRate());
+        return;
+    }
 
     // retrieve current values
-        m_pIHeadEncoders->getEncoders(l_vEncoders.data());
+        m_pIHeadEncoders->getEncoders(m_vEncoders.data());
 
-        // head rotation / gaze
-            for(uint ii = 0; ii < l_vCommand.size(); ++ii)
+        // head rotation / gaze, the disabled joints are left to the other controllers
+            int l_i32EnabledJointsNb = 0;
+            for(int ii = 0; ii < l_i32JointsNb; ++ii)
             {
+                if(!((ii < 3) ? l_bHeadEnabled : (ii < 6 && l_bGazeEnabled)))
+                {
+                    m_vCommand[ii] = 0.0;
+                    continue;
+                }
+
                 if(ii < 3)
                 {
-                    double l_dDiff = l_vHeadJoints[ii] - l_vEncoders[ii];
+                    double l_dDiff = m_vJoints[ii] - m_vEncoders[ii];
                     double l_dAmplitude = (m_vMaxJoints[ii] - m_vMinJoints[ii]);
                     l_dAmplitude *= l_dAmplitude;
                     l_dAmplitude = sqrt(l_dAmplitude);
@@ -919,37 +989,51 @@ void swTeleop::SWHeadVelocityController::run()
 
                     if(l_dCoeff < 0.025)
                     {
-                        l_vCommand[ii] = 0.5 * l_dDiff;
+                        m_vCommand[ii] = 0.5 * l_dDiff;
                     }
                     else
                     {
-                        l_vCommand[ii] = m_vHeadJointVelocityK[ii] * l_dDiff;
+                        m_vCommand[ii] = m_vHeadJointVelocityK[ii] * l_dDiff;
                     }
                 }
                 else
                 {
-                    l_vCommand[ii] = (m_vHeadJointVelocityK[ii] * (l_vHeadJoints[ii] - l_vEncoders[ii]));
+                    m_vCommand[ii] = (m_vHeadJointVelocityK[ii] * (m_vJoints[ii] - m_vEncoders[ii]));
                 }
 
+                m_vEnabledJoints[l_i32EnabledJointsNb]  = ii;
+                m_vEnabledCommand[l_i32EnabledJointsNb] = m_vCommand[ii];
+                ++l_i32EnabledJointsNb;
             }
 
-        // velocity move
-        //  head
-            if(l_bHeadEnabled)
+        // velocity move : one call for the enabled joints, one call per joint if the subset interface is missing
+            if(m_pIHeadVelocity2)
             {
-                for(int ii = 0; ii < 3; ++ii)
-                {
-                    m_pIHeadVelocity->velocityMove(ii, l_vCommand[ii]);
-                }
+                m_pIHeadVelocity2->velocityMove(l_i32EnabledJointsNb, m_vEnabledJoints.data(), m_vEnabledCommand.data());
             }
-        //  gaze
-            if(l_bGazeEnabled)
+            else if(l_i32EnabledJointsNb == m_i32JointsNb)
             {
-                for(int ii = 3; ii < 6; ++ii)
+                m_pIHeadVelocity->velocityMove(m_vCommand.data());
+            }
+            else
+            {
+                for(int ii = 0; ii < l_i32EnabledJointsNb; ++ii)
                 {
-                    m_pIHeadVelocity->velocityMove(ii, l_vCommand[ii]);
+                    m_pIHeadVelocity->velocityMove(m_vEnabledJoints[ii], m_vEnabledCommand[ii]);
                 }
             }
+
+    m_oTiming.stopTick(getRate());
+}
+
+void swTeleop::SWHeadVelocityController::threadRelease()
+{
+    m_oTiming.display(getRate());
+}
+
+swTeleop::SWVelocityControllerTiming &swTeleop::SWHeadVelocityController::timing()
+{
+    return m_oTiming;
 }
 
 
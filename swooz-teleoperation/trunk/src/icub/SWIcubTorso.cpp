@@ -42,7 +42,8 @@ using namespace yarp::os;
 
 
 swTeleop::SWIcubTorso::SWIcubTorso() : m_bInitialized(false), m_bIsRunning(false), m_dTorsoTimeLastBottle(-1.),
-                                       m_pITorsoVelocity(NULL), m_pITorsoEncoders(NULL), m_pITorsoPosition(NULL), m_pVelocityController(NULL)
+                                       m_pITorsoVelocity(NULL), m_pITorsoEncoders(NULL), m_pITorsoPosition(NULL), m_pVelocityController(NULL),
+                                       m_oTorsoReader(&SWIcubTorso::torsoReader), m_pTorsoCallback(NULL)
 {
     // set ini file defaults values
         // parts to be activated
@@ -88,7 +89,11 @@ swTeleop::SWIcubTorso::~SWIcubTorso()
         }
     }
 
+    // the callback must not be used by the port anymore
+        m_oTorsoTrackerPort.disableCallback();
+
     deleteAndNullify(m_pVelocityController);
+    deleteAndNullify(m_pTorsoCallback);
 }
 
 bool swTeleop::SWIcubTorso::init( yarp::os::ResourceFinder &oRf)
@@ -201,6 +206,22 @@ bool swTeleop::SWIcubTorso::init( yarp::os::ResourceFinder &oRf)
     // init controller                
         m_pVelocityController = new swTeleop::SWTorsoVelocityController(m_pITorsoEncoders, m_pITorsoVelocity, m_vTorsoJointVelocityK, m_i32RateVelocityControl);
         m_pVelocityController->enableTorso(m_bTorsoActivated);
+        m_pVelocityController->timing().setVerbose(oRf.check("verboseVelocityControl", Value(0), "Display the velocity controller timing reports (int)").asInt() != 0);
+
+    // init event-driven input : the target joints are updated by the port thread as soon as a bottle arrives
+        m_vTorsoJoints.resize(m_i32TorsoJointsNb);
+        m_vTorsoJoints = 0.;
+        m_vTorsoFilteredJoints.resize(m_i32TorsoJointsNb);
+        m_vTorsoFilteredJoints = 0.;
+        m_oTorsoFilter.reset(m_i32TorsoJointsNb, readFilterParams(oRf, "torso"));
+        m_dTorsoTimeLastBottle = yarp::os::Time::now();
+        m_bIsRunning = true;
+
+        if(m_bTorsoActivated)
+        {
+            m_pTorsoCallback = new SWInputCallback<SWIcubTorso>(this, 0);
+            m_oTorsoTrackerPort.useCallback(*m_pTorsoCallback);
+        }
 
     // display parameters
         std::cout << std::endl << std::endl;
@@ -234,106 +255,107 @@ bool swTeleop::SWIcubTorso::checkBottles()
         return (m_bIsRunning=false);
     }
 
-    // init command vector
-        yarp::sig::Vector l_vTorsoJoints;
-        l_vTorsoJoints.resize(m_i32TorsoJointsNb);
-        l_vTorsoJoints = 0.;
+    // the bottles are read by the port callback as soon as they arrive, manage only the timeout and reset position
+        double l_dNow = yarp::os::Time::now();
 
-    // defines bottles
-        Bottle *l_pTorsoTarget = NULL;
+        m_oInputMutex.lock();
 
-        // read torso commands
-        if(m_bTorsoActivated)
-        {
-            l_pTorsoTarget = m_oTorsoTrackerPort.read(false);
-
-            if (l_pTorsoTarget)
+            if(m_bTorsoActivated && l_dNow - m_dTorsoTimeLastBottle > 0.001 * m_i32TimeoutTorsoReset)
             {
-                int l_deviceId = l_pTorsoTarget->get(0).asInt();
+                m_pVelocityController->enableTorso(false);
+                resetTorsoPosition();
+                m_oTorsoFilter.reset();
+                m_dTorsoTimeLastBottle = l_dNow;
+            }
 
-                switch(l_deviceId)
-                {
-                    case swTracking::DUMMY_LIB:
-                    {
-                        for(uint ii = 0; ii < l_vTorsoJoints.size(); ++ii)
-                        {
-                            l_vTorsoJoints[ii] = l_pTorsoTarget->get(ii+1).asDouble();
-                        }
-                    }
-                    break;
-                    case swTracking::OPENNI_LIB:
-                    {
-                        std::vector<double> l_pointTorso(3), l_pointNeck(3), l_pointLShoulder(3), l_pointRShoulder(3);
-                        l_pointTorso[0] = l_pTorsoTarget->get(1).asDouble();
-                        l_pointTorso[1] = l_pTorsoTarget->get(2).asDouble();
-                        l_pointTorso[2] = l_pTorsoTarget->get(3).asDouble();
-                        l_pointNeck[0] = l_pTorsoTarget->get(4).asDouble();
-                        l_pointNeck[1] = l_pTorsoTarget->get(5).asDouble();
-                        l_pointNeck[2] = l_pTorsoTarget->get(6).asDouble();
-                        l_pointLShoulder[0] = l_pTorsoTarget->get(7).asDouble();
-                        l_pointLShoulder[1] = l_pTorsoTarget->get(8).asDouble();
-                        l_pointLShoulder[2] = l_pTorsoTarget->get(9).asDouble();
-                        l_pointRShoulder[0] = l_pTorsoTarget->get(10).asDouble();
-                        l_pointRShoulder[1] = l_pTorsoTarget->get(11).asDouble();
-                        l_pointRShoulder[2] = l_pTorsoTarget->get(12).asDouble();
-
-                        std::vector<double> l_vecTorso      = swUtil::vec(l_pointTorso, l_pointNeck);
-                        std::vector<double> l_vecClavicles  = swUtil::vec(l_pointLShoulder, l_pointRShoulder);
-                        std::vector<double> l_rpyTorso      = swUtil::computeRollPitchYaw(l_vecTorso, l_vecClavicles);
-
-                        l_vTorsoJoints[0] = l_rpyTorso[2];
-                        l_vTorsoJoints[1] = l_rpyTorso[0];
-                        l_vTorsoJoints[2] = l_rpyTorso[1];
+        m_oInputMutex.unlock();
 
-                    }
-                    break;
-                }
+    return true;
+}
 
-                m_dTorsoTimeLastBottle = -1.;
-                m_pVelocityController->enableTorso(true);
-            }
-            else // manage timeout and reset position
+void swTeleop::SWIcubTorso::onBottle(cint i32Input, yarp::os::Bottle &oBottle)
+{
+    m_oInputMutex.lock();
+
+        if(!m_bIsRunning)
+        {
+            m_oInputMutex.unlock();
+            return;
+        }
+
+        m_oTorsoReader.read(this, oBottle);
+        m_dTorsoTimeLastBottle = yarp::os::Time::now();
+        // the raw targets are filtered into a separate buffer, the filter never sees its own output
+        m_oTorsoFilter.filter(m_vTorsoJoints.data(), m_vTorsoFilteredJoints.data(), m_vTorsoJoints.size(), m_dTorsoTimeLastBottle);
+        m_pVelocityController->enableTorso(true);
+
+        // check each joint value to ensure it is in the right range, if not crop to the max/min values
+            for(uint ii = 0; ii < m_vTorsoFilteredJoints.size(); ++ii)
             {
-                if(m_dTorsoTimeLastBottle < 0.)
+                if(m_vTorsoFilteredJoints[ii] < m_vTorsoMinJoint[ii])
                 {
-                    m_dTorsoTimeLastBottle = yarp::os::Time::now();
+                    m_vTorsoFilteredJoints[ii] = m_vTorsoMinJoint[ii];
                 }
-                else
+                if(m_vTorsoFilteredJoints[ii] > m_vTorsoMaxJoint[ii])
                 {
-                    if(yarp::os::Time::now() - m_dTorsoTimeLastBottle > 0.001 * m_i32TimeoutTorsoReset)
-                    {
-                        m_pVelocityController->enableTorso(false);
-                        resetTorsoPosition();
-                        m_dTorsoTimeLastBottle = -1.;
-                    }
+                    m_vTorsoFilteredJoints[ii] = m_vTorsoMaxJoint[ii];
                 }
             }
-        }
 
-    // check each joint value to ensure it is in the right range, if not crop to the max/min values
-        for(uint ii = 0; ii < l_vTorsoJoints.size(); ++ii)
+        m_pVelocityController->setJoints(m_vTorsoFilteredJoints);
+
+        if(!m_pVelocityController->isRunning())
         {
-            if(l_vTorsoJoints[ii] < m_vTorsoMinJoint[ii])
-            {
-                l_vTorsoJoints[ii] = m_vTorsoMinJoint[ii];
-            }
-            if(l_vTorsoJoints[ii] > m_vTorsoMaxJoint[ii])
-            {
-                l_vTorsoJoints[ii] = m_vTorsoMaxJoint[ii];
-            }
+            m_pVelocityController->start();
         }
 
-        if(l_pTorsoTarget)
-        {
-            m_pVelocityController->setJoints(l_vTorsoJoints);
+    m_oInputMutex.unlock();
+}
 
-            if(!m_pVelocityController->isRunning())
-            {
-                m_pVelocityController->start();
-            }
-        }
+swTeleop::SWIcubTorso::SWTorsoReader swTeleop::SWIcubTorso::torsoReader(cint i32DeviceId)
+{
+    switch(i32DeviceId)
+    {
+        case swTracking::DUMMY_LIB :
+            return &SWIcubTorso::readTorsoDummy;
+        case swTracking::OPENNI_LIB :
+            return &SWIcubTorso::readTorsoOpenni;
+    }
 
-    return true;
+    return NULL;
+}
+
+void swTeleop::SWIcubTorso::readTorsoDummy(yarp::os::Bottle &oBottle)
+{
+    for(uint ii = 0; ii < m_vTorsoJoints.size(); ++ii)
+    {
+        m_vTorsoJoints[ii] = oBottle.get(ii+1).asDouble();
+    }
+}
+
+void swTeleop::SWIcubTorso::readTorsoOpenni(yarp::os::Bottle &oBottle)
+{
+    std::vector<double> l_pointTorso(3), l_pointNeck(3), l_pointLShoulder(3), l_pointRShoulder(3);
+    l_pointTorso[0] = oBottle.get(1).asDouble();
+    l_pointTorso[1] = oBottle.get(2).asDouble();
+    l_pointTorso[2] = oBottle.get(3).asDouble();
+    l_pointNeck[0] = oBottle.get(4).asDouble();
+    l_pointNeck[1] = oBottle.get(5).asDouble();
+    l_pointNeck[2] = oBottle.get(6).asDouble();
+    l_pointLShoulder[0] = oBottle.get(7).asDouble();
+    l_pointLShoulder[1] = oBottle.get(8).asDouble();
+    l_pointLShoulder[2] = oBottle.get(9).asDouble();
+    l_pointRShoulder[0] = oBottle.get(10).asDouble();
+    l_pointRShoulder[1] = oBottle.get(11).asDouble();
+    l_pointRShoulder[2] = oBottle.get(12).asDouble();
+
+    std::vector<double> l_vecTorso      = swUtil::vec(l_pointTorso, l_pointNeck);
+    std::vector<double> l_vecClavicles  = swUtil::vec(l_pointLShoulder, l_pointRShoulder);
+    std::vector<double> l_rpyTorso      = swUtil::computeRollPitchYaw(l_vecTorso, l_vecClavicles);
+
+    m_vTorsoJoints[0] = l_rpyTorso[2];
+    m_vTorsoJoints[1] = l_rpyTorso[0];
+    m_vTorsoJoints[2] = l_rpyTorso[1];
 }
 
 void swTeleop::SWIcubTorso::resetTorsoPosition()
@@ -369,13 +391,16 @@ bool swTeleop::SWIcubTorso::close()
 
 bool swTeleop::SWIcubTorso::interruptModule()
 {
-    m_bIsRunning = false;
+    // no bottle will update the joints or restart the controller after this point
+    m_oInputMutex.lock();
+        m_bIsRunning = false;
 
     // reset positions
         if(m_bTorsoActivated)
         {
             resetTorsoPosition();
         }
+    m_oInputMutex.unlock();
 
     if(m_pVelocityController->isRunning())
     {
@@ -396,7 +421,8 @@ bool swTeleop::SWIcubTorso::interruptModule()
 
 swTeleop::SWTorsoVelocityController::SWTorsoVelocityController(yarp::dev::IEncoders *pITorsoEncoders, yarp::dev::IVelocityControl *pITorsoVelocity,
                                                      std::vector<double> &vTorsoJointVelocityK, int i32Rate)
-    : RateThread(i32Rate), m_bTorsoEnabled(false), m_vTorsoJointVelocityK(vTorsoJointVelocityK)
+    : RateThread(i32Rate), m_bTorsoEnabled(false), m_pITorsoEncoders(NULL), m_pITorsoVelocity(NULL),
+      m_vTorsoJointVelocityK(vTorsoJointVelocityK), m_i32JointsNb(0), m_oTiming("Torso")
 {
     if(pITorsoEncoders)
     {
@@ -405,37 +431,65 @@ swTeleop::SWTorsoVelocityController::SWTorsoVelocityController(yarp::dev::IEncod
     if(pITorsoVelocity)
     {
         m_pITorsoVelocity = pITorsoVelocity;
+        m_pITorsoVelocity->getAxes(&m_i32JointsNb);
     }
+
+    // buffers are allocated once, run() only writes into them
+        m_vJoints.resize(m_i32JointsNb, 0.0);
+        m_vEncoders.resize(m_i32JointsNb, 0.0);
+        m_vCommand.resize(m_i32JointsNb, 0.0);
 }
 
 void swTeleop::SWTorsoVelocityController::run()
 {
+        m_oTiming.startTick();
+
         m_oMutex.lock();
             bool l_bTorsoEnabled = m_bTorsoEnabled;
-            yarp::sig::Vector l_vTorsoJoints = m_vLastTorsoJoint;
-        m_oMutex.unlock();
+            int l_i32JointsNb = static_cast<int>(m_vLastTorsoJoint.size());
+            l_i32JointsNb = (l_i32JointsNb < m_i32JointsNb) ? l_i32JointsNb : m_i32JointsNb;
 
-        yarp::sig::Vector l_vEncoders, l_vCommand;
-        l_vEncoders.resize(l_vTorsoJoints.size());
-        l_vCommand.resize(l_vTorsoJoints.size());
-
-        m_pITorsoEncoders->getEncoders(l_vEncoders.data());
-
-        // Torso
-            for(uint ii = 0; ii < l_vCommand.size(); ++ii)
+            for(int ii = 0; ii < l_i32JointsNb; ++ii)
             {
-                l_vCommand[ii] = m_vTorsoJointVelocityK[ii] * (l_vTorsoJoints[ii] - l_vEncoders[ii]);
+                m_vJoints[ii] = m_vLastTorsoJoint[ii];
             }
+        m_oMutex.unlock();
 
-        // velocity move
-        //  Torso
-            if(l_bTorsoEnabled)
-            {
-                for(uint ii = 0; ii < l_vCommand.size(); ++ii)
+        if(l_bTorsoEnabled && l_i32JointsNb > 0)
+        {
+            m_pITorsoEncoders->getEncoders(m_vEncoders.data());
+
+            // Torso
+                for(int ii = 0; ii < l_i32JointsNb; ++ii)
                 {
-                    m_pITorsoVelocity->velocityMove(ii, l_vCommand[ii]);
+                    m_vCommand[ii] = m_vTorsoJointVelocityK[ii] * (m_vJoints[ii] - m_vEncoders[ii]);
                 }
-            }
+
+            // velocity move : one call when all the joints have a target, else only the joints with a target are commanded
+                if(l_i32JointsNb == m_i32JointsNb)
+                {
+                    m_pITorsoVelocity->velocityMove(m_vCommand.data());
+                }
+                else
+                {
+                    for(int ii = 0; ii < l_i32JointsNb; ++ii)
+                    {
+                        m_pITorsoVelocity->velocityMove(ii, m_vCommand[ii]);
+                    }
+                }
+        }
+
+        m_oTiming.stopTick(getRate());
+}
+
+void swTeleop::SWTorsoVelocityController::threadRelease()
+{
+    m_oTiming.display(getRate());
+}
+
+swTeleop::SWVelocityControllerTiming &swTeleop::SWTorsoVelocityController::timing()
+{
+    return m_oTiming;
 }
 
 void swTeleop::SWTorsoVelocityController::enableTorso(cbool bActivated)
@@ -0,0 +1,217 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWLeapHandAngles.cpp
+ * \brief Defines the iCub hand and finger angles computing from the Leap hand data.
+ */
+
+#include <cmath>
+
+#include "geometryUtility.h"
+#include "icub/SWLeapHandAngles.h"
+
+
+void swTeleop::computeLeapHandAngles(const SWLeapHandData &oHand, cbool bLeftArm, double a4DHandAngles[4])
+{
+    // normalize vectors
+        swUtil::SWVec3d l_vecHandPalmNormal = swUtil::normalize3(oHand.m_vHandPalmNormal);
+        swUtil::SWVec3d l_vecArmDirection   = swUtil::normalize3(oHand.m_vArmDirection);
+        swUtil::SWVec3d l_vecHandDirection  = swUtil::normalize3(oHand.m_vHandDirection);
+
+    // check hand palm orientation : acos(x) > 90 deg <=> x < 0
+        bool l_bHandPalmUp   = -l_vecHandPalmNormal[1] < 0.;
+        bool l_bHandPalmLeft = !(-l_vecHandPalmNormal[0] < 0.);
+
+    // compute transformation for aligning arm to z axis and apply it to the arm and the hand
+        swUtil::SWRot3d l_oTransfo;
+        swUtil::rodriguesRotation3(l_vecArmDirection, swUtil::vec3(0.,0.,-1.), l_oTransfo);
+
+        swUtil::SWVec3d l_vecTransfoHandDirection = swUtil::mul3(l_oTransfo, l_vecHandDirection);
+        swUtil::SWVec3d l_vecTransfoHandNormal    = swUtil::mul3(l_oTransfo, l_vecHandPalmNormal);
+        swUtil::SWVec3d l_vecTransfoArmDirection  = swUtil::mul3(l_oTransfo, l_vecArmDirection);
+        double l_dNormTransfoArmDirection         = swUtil::norm3(l_vecTransfoArmDirection);
+
+    // compute transformation for aligning palm normal to Y axis
+        swUtil::rodriguesRotation3(l_vecTransfoHandNormal, swUtil::vec3(0., l_bHandPalmUp ? 1. : -1., 0.), l_oTransfo);
+        swUtil::SWVec3d l_vecTransfoHandDirection2 = swUtil::mul3(l_oTransfo, l_vecTransfoHandDirection);
+
+    // compute angle for wrist yaw
+        double l_angle = swUtil::rad2Deg(acos(swUtil::dot3(l_vecTransfoHandDirection2, l_vecTransfoArmDirection) /
+                                             (swUtil::norm3(l_vecTransfoHandDirection2) * l_dNormTransfoArmDirection)));
+
+        double l_dCrossY = swUtil::cross3(l_vecTransfoHandDirection2, l_vecTransfoArmDirection)[1];
+
+        if(!bLeftArm)
+        {
+            l_dCrossY *= -1;
+        }
+
+        if(l_dCrossY > 0.)
+        {
+            if(!l_bHandPalmUp)
+            {
+                l_angle = -l_angle;
+            }
+        }
+        else
+        {
+            if(l_bHandPalmUp)
+            {
+                l_angle = -l_angle;
+            }
+        }
+
+        // set joint value
+        a4DHandAngles[3] = l_angle;
+
+    // compute angle for wrist pitch
+        swUtil::SWVec3d l_vecTransfoHandRight = swUtil::cross3(l_vecTransfoHandNormal, l_vecTransfoHandDirection);
+
+        // compute transformation for aligning palm normal to X axis
+        swUtil::rodriguesRotation3(l_vecTransfoHandRight, swUtil::vec3(0., l_bHandPalmLeft ? -1. : 1., 0.), l_oTransfo);
+        l_vecTransfoHandDirection2 = swUtil::mul3(l_oTransfo, l_vecTransfoHandDirection);
+
+        l_angle = swUtil::rad2Deg(acos(swUtil::dot3(l_vecTransfoHandDirection2, l_vecTransfoArmDirection) /
+                                      (swUtil::norm3(l_vecTransfoHandDirection2) * l_dNormTransfoArmDirection)));
+
+        // the sign still comes from the wrist yaw cross product (flipped twice for the right arm)
+        if(!bLeftArm)
+        {
+            l_dCrossY *= -1;
+        }
+
+        if(l_dCrossY > 0.)
+        {
+            l_angle = l_bHandPalmLeft ? -l_angle : 0.0;
+        }
+        else
+        {
+            l_angle = l_bHandPalmLeft ? 0.0 : -l_angle;
+        }
+
+        // set joint value
+        a4DHandAngles[2] = l_angle;
+
+        if(!bLeftArm)
+        {
+            a4DHandAngles[1] = (swUtil::rad2Deg(oHand.m_vHandPalmNormalE[1]) + 90.0);
+        }
+        else
+        {
+            a4DHandAngles[1] = -(swUtil::rad2Deg(oHand.m_vHandPalmNormalE[1]) - 90.0);
+        }
+
+        // acos of the Y component of the normalized (0, y, z) arm direction
+        double l_dAngle = swUtil::rad2Deg(acos(swUtil::normalize3(swUtil::vec3(0.0, oHand.m_vArmDirection[1], oHand.m_vArmDirection[2]))[1]));
+        l_dAngle *= -1.0;
+        l_dAngle += 140.0;
+        a4DHandAngles[0] = l_dAngle;
+}
+
+/**
+ * \brief Sum of the flexion angles in degrees between the consecutive bones [i32First, i32Last] of a finger,
+ *        only the bendings in the palm direction are accumulated.
+ */
+static double fingerFlexion(const swUtil::SWVec3d *aVBones, cint i32First, cint i32Last, cbool bHandPalmLeft)
+{
+    double l_dFlexion = 0.0;
+    swUtil::SWVec3d l_vecBone1 = swUtil::normalize3(aVBones[i32First]);
+
+    for(int ii = i32First + 1; ii <= i32Last; ++ii)
+    {
+        swUtil::SWVec3d l_vecBone2 = swUtil::normalize3(aVBones[ii]);
+
+        double l_dCrossY = swUtil::cross3(l_vecBone1, l_vecBone2)[1];
+
+        if((!bHandPalmLeft && l_dCrossY < 0.) || (bHandPalmLeft && l_dCrossY >= 0.))
+        {
+            l_dFlexion += swUtil::rad2Deg(acos(swUtil::dot3(l_vecBone1, l_vecBone2)));
+        }
+
+        l_vecBone1 = l_vecBone2;
+    }
+
+    return l_dFlexion;
+}
+
+void swTeleop::computeLeapFingerAngles(const SWLeapHandData &oHand, double a9DFingerAngles[9])
+{
+    // arm joint 0 hand_finger
+    // arm joint 1 thumb_oppose
+    // arm joint 2 thumb_proximal
+    // arm joint 3 thumb_distal
+    // arm joint 4 index_proximal
+    // arm joint 5 index_distal
+    // arm joint 6 middle_proximal
+    // arm joint 7 middle_distal
+    // arm joint 8 pinky
+
+    // init res angles
+        for(int ii = 0; ii < 9; ++ii)
+        {
+            a9DFingerAngles[ii] = 0.;
+        }
+
+        swUtil::SWVec3d l_vecHandNormal = swUtil::normalize3(oHand.m_vHandPalmNormal);
+
+    // check hand palm orientation : acos(x) > 90 deg <=> x < 0
+        bool l_bHandPalmUp   = -l_vecHandNormal[1] < 0.;
+        bool l_bHandPalmLeft = !(-l_vecHandNormal[0] < 0.);
+
+    // compute transformation for aligning palm normal to Y axis
+        swUtil::SWRot3d l_oTransfo;
+        swUtil::rodriguesRotation3(l_vecHandNormal, swUtil::vec3(0., l_bHandPalmUp ? 1. : -1., 0.), l_oTransfo);
+
+    // compute fingers interval (hand_finger)
+        // ... better not (hight risk of breaking)
+
+    // compute thumbs angles
+        // thumb metacarpal-> index metarcapal (thumb_oppose)
+            swUtil::SWVec3d l_vecTemp1 = swUtil::normalize3(swUtil::mul3(l_oTransfo, swUtil::normalize3(oHand.m_aVThumbDirections[0])));
+            swUtil::SWVec3d l_vecTemp2 = swUtil::normalize3(swUtil::mul3(l_oTransfo, swUtil::normalize3(oHand.m_aVIndexDirections[0])));
+            a9DFingerAngles[2] = 90.0 - swUtil::rad2Deg(acos(swUtil::dot3(l_vecTemp1, l_vecTemp2)));
+
+        // intermediate->distal (thumb_distal)
+            l_vecTemp1 = swUtil::normalize3(oHand.m_aVThumbDirections[1]);
+            l_vecTemp2 = swUtil::normalize3(oHand.m_aVThumbDirections[2]);
+            a9DFingerAngles[3] = swUtil::rad2Deg(acos(swUtil::dot3(l_vecTemp1, l_vecTemp2)));
+
+    // compute index angles
+        // metacarpal->proximal (index_proximal)
+            a9DFingerAngles[4] = fingerFlexion(oHand.m_aVIndexDirections, 0, 1, l_bHandPalmLeft);
+        // proximal->intermediate + intermediate->distal (index_distal)
+            a9DFingerAngles[5] = fingerFlexion(oHand.m_aVIndexDirections, 1, 3, l_bHandPalmLeft);
+
+    // compute middle angles
+        // metacarpal->proximal (middle_proximal)
+            a9DFingerAngles[6] = fingerFlexion(oHand.m_aVMiddleDirections, 0, 1, l_bHandPalmLeft);
+        // proximal->intermediate + intermediate->distal (middle_distal)
+            a9DFingerAngles[7] = fingerFlexion(oHand.m_aVMiddleDirections, 1, 3, l_bHandPalmLeft);
+
+    // compute ring + pinky angles
+        // metacarpal->proximal + proximal->intermediate + intermediate->distal (pinky)
+            a9DFingerAngles[8] = fingerFlexion(oHand.m_aVPinkyDirections, 0, 3, l_bHandPalmLeft);
+}
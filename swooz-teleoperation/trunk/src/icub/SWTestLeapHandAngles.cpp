@@ -0,0 +1,207 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWTestLeapHandAngles.cpp
+ * \brief Golden test of the iCub hand and finger angles computing (SWLeapHandAngles) and of the kinematicsUtility kernels.
+ *
+ *  The expected angles were computed with the previous cv::Mat / std::vector implementation of SWIcubArm
+ *  on the same pseudo-random hands (the last hand is null to pin the degenerate cases).
+ *  Usage : SWTestLeapHandAngles, returns 0 if all the values match.
+ */
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+#include "geometryUtility.h"
+#include "kinematicsUtility.h"
+#include "icub/SWLeapHandAngles.h"
+
+namespace
+{
+    const double NAN_V = std::numeric_limits<double>::quiet_NaN();  /**< expected NaN value */
+
+    const int HANDS_NB      = 17;       /**< number of golden hands */
+    const int BOTTLE_SIZE   = 80;       /**< number of values of a leap hand fingers bottle */
+    const double TOLERANCE  = 1e-9;     /**< max difference in degrees */
+
+    /**
+     * \brief Expected values for each hand : left arm hand angles [4], right arm hand angles [4], finger angles [9]
+     */
+    const double GOLDEN_ANGLES[HANDS_NB][17] =
+    {
+        {140, 37.342745386249376, -151.15139589806645, 71.686648020869782, 140, 142.65725461375064, -151.15139589806645, -71.686648020869782, 0, 0, -6.2301822383289931, 27.362301831638216, 41.963336709885233, 0, 64.582300510310688, 0, 223.416720547323},
+        {54.089235855345152, 57.911955694389796, 0, 58.678184639031286, 54.089235855345152, 122.0880443056102, 0, -58.678184639031286, 0, 0, -25.707526546171195, 39.968223185813805, 0, 239.02651667733153, 155.27713608251699, 0, 263.54193832892258},
+        {58.968114125194575, 109.39010109134286, 0, -98.726006540057099, 58.968114125194575, 70.609898908657144, 0, 98.726006540057099, 0, 0, 10.229814288372935, 64.563726027508011, 0, 97.246184446375963, 109.14692451599817, 102.44957138779939, 0},
+        {70.440226348084636, 127.35264483482896, -65.13463664031778, -85.09639750154966, 70.440226348084636, 52.647355165171035, -65.13463664031778, 85.09639750154966, 0, 0, 13.809267726983464, 103.08736154608448, 153.89799693368892, 0, 0, 46.498471741091528, 0},
+        {27.092107320678039, 99.187444546934458, -100.76067190639061, 152.84863321067235, 27.092107320678039, 80.812555453065542, -100.76067190639061, -152.84863321067235, 0, 0, 11.091749154191319, 75.812592848593823, 26.602957087409933, 123.28526341499021, 86.617507666024238, 51.173763296994956, 172.52703238881543},
+        {-14.29670536284172, 142.87646953516219, -61.69784676736198, 50.799115137200189, -14.29670536284172, 37.123530464837827, -61.69784676736198, -50.799115137200189, 0, 0, 7.6983743687602981, 37.456001662713945, 88.4672467504287, 0, 7.0127077288622637, 281.85668194869146, 204.55070176930295},
+        {110.39924790155897, 127.411220537151, -161.38447066032907, -105.38674175127215, 110.39924790155897, 52.588779462849011, -161.38447066032907, 105.38674175127215, 0, 0, -5.1415780137603946, 100.0235523572198, 0, 146.91282368967435, 77.736115576195033, 0, 36.790087436967454},
+        {-19.324894453956603, 95.349124120197658, 0, -144.34861380704641, -19.324894453956603, 84.650875879802342, 0, 144.34861380704641, 0, 0, -61.839772247215961, 46.740397052129879, 37.163624515382004, 189.3921977641254, 0, 88.768493900067085, 195.38769285414469},
+        {140, 112.41213194999315, -9.4086361117824424, -33.685186939702234, 140, 67.587868050006847, -9.4086361117824424, 33.685186939702234, 0, 0, 36.22485508484268, 115.02079246769672, 0, 0, 89.549350514759809, 109.66194153063599, 34.215072489082473},
+        {-32.930435425654366, 117.08525858765636, 0, 96.060348535310411, -32.930435425654366, 62.914741412343645, 0, -96.060348535310411, 0, 0, -48.197752031764395, 123.58326353255177, 0, 0, 56.33045054335917, 0, 85.100480605723959},
+        {13.578347646936891, 113.98985783694179, -1.2393026427967788, 81.677343469837098, 13.578347646936891, 66.010142163058205, -1.2393026427967788, -81.677343469837098, 0, 0, 49.765739021744743, 63.512624320101665, 0, 292.22388647971428, 111.72536563663026, 127.10576043966783, 98.480294694959753},
+        {140, 138.073781039133, 0, 107.47564173799715, 140, 41.926218960866997, 0, -107.47564173799715, 0, 0, 0.26701577369077256, 51.645551046036218, 77.997674653730655, 28.623776675041515, 155.60500571294082, 55.824010762136702, 131.47834999934577},
+        {-6.7582044803660892, 104.20991487007629, -162.18845316775446, -158.43122145287896, -6.7582044803660892, 75.79008512992371, -162.18845316775446, 158.43122145287896, 0, 0, -38.885078656247401, 84.028842250509314, 0, 0, 136.56343705778079, 74.762560025306769, 0},
+        {100.734122202028, 115.16102354373464, -38.854418832025672, -49.660648872758102, 100.734122202028, 64.838976456265357, -38.854418832025672, 49.660648872758102, 0, 0, -64.390374011998944, 170.3082917106158, 38.698753937848394, 74.309851534915012, 87.171553695729415, 0, 100.22747155031831},
+        {133.43944510549235, 81.995195877664003, 0, 46.238443297167642, 133.43944510549235, 98.004804122335997, 0, -46.238443297167642, 0, 0, -39.90423260109597, 142.01122347656712, 115.22160591500977, 0, 90.786522610102708, 89.661869301729013, 60.76854831273323},
+        {9.880627080621764, 146.64224652272426, 0, -108.03498344440946, 9.880627080621764, 33.357753477275736, 0, 108.03498344440946, 0, 0, -70.521571058563239, 112.12124270386964, 0, 113.10085399370995, 0, 40.200907733530684, 89.104213233445506},
+        {50.000000000005926, 90, 0, NAN_V, 50.000000000005926, 90, 0, NAN_V, 0, 0, NAN_V, 89.999999999994074, 89.999999999994074, 179.99999999998815, 89.999999999994074, 179.99999999998815, 269.99999999998221}
+    };
+
+    /**
+     * \brief Portable pseudo-random generator (same sequence on every platform), some values are set to 0.
+     */
+    double nextValue(unsigned int &ui32Seed)
+    {
+        ui32Seed = 1664525u * ui32Seed + 1013904223u;
+
+        if((ui32Seed >> 4) % 23 == 0)
+        {
+            return 0.0;
+        }
+
+        return 2.0 * (ui32Seed >> 8) / 16777216.0 - 1.0;
+    }
+
+    /**
+     * \brief Fill the leap hand data with the values of a hand fingers bottle (same indices than SWIcubArm::readLeapHand)
+     */
+    void readLeapHand(const double *aDValues, swTeleop::SWLeapHandData &oHand)
+    {
+        for(int ii = 0; ii < 3; ++ii)
+        {
+            oHand.m_vArmDirection[ii]      = aDValues[1 + ii];
+            oHand.m_vHandDirection[ii]     = aDValues[4 + ii];
+            oHand.m_vHandPalmNormal[ii]    = aDValues[13 + ii];
+            oHand.m_vHandPalmNormalE[ii]   = aDValues[16 + ii];
+        }
+
+        for(int ii = 0; ii < 4; ++ii)
+        {
+            for(int jj = 0; jj < 3; ++jj)
+            {
+                if(ii < 3)
+                {
+                    oHand.m_aVThumbDirections[ii][jj] = aDValues[19 + ii * 3 + jj];
+                }
+
+                oHand.m_aVIndexDirections[ii][jj]  = aDValues[28 + ii * 3 + jj];
+                oHand.m_aVMiddleDirections[ii][jj] = aDValues[40 + ii * 3 + jj];
+                oHand.m_aVPinkyDirections[ii][jj]  = aDValues[64 + ii * 3 + jj];
+            }
+        }
+    }
+
+    /**
+     * \brief Compare a value with the expected one, NaN must match NaN.
+     * \return true if the values match
+     */
+    bool check(const char *sName, cint i32Hand, cint i32Index, cdouble dValue, cdouble dExpected)
+    {
+        bool l_bNaN         = dValue != dValue;
+        bool l_bExpectedNaN = dExpected != dExpected;
+
+        if(l_bNaN == l_bExpectedNaN && (l_bNaN || std::fabs(dValue - dExpected) <= TOLERANCE))
+        {
+            return true;
+        }
+
+        printf("-ERROR : %s hand %d value %d : %.17g instead of %.17g\n", sName, i32Hand, i32Index, dValue, dExpected);
+        return false;
+    }
+}
+
+int main()
+{
+    int l_i32ErrorsNb = 0;
+
+    // hand and finger angles against the golden values
+    unsigned int l_ui32Seed = 12345u;
+    double l_aDValues[BOTTLE_SIZE];
+
+    for(int ii = 0; ii < HANDS_NB; ++ii)
+    {
+        for(int jj = 0; jj < BOTTLE_SIZE; ++jj)
+        {
+            l_aDValues[jj] = (ii == HANDS_NB - 1) ? 0.0 : nextValue(l_ui32Seed);
+        }
+
+        swTeleop::SWLeapHandData l_oHand;
+        readLeapHand(l_aDValues, l_oHand);
+
+        double l_a4DLeftHandAngles[4], l_a4DRightHandAngles[4], l_a9DFingerAngles[9];
+        swTeleop::computeLeapHandAngles(l_oHand, true, l_a4DLeftHandAngles);
+        swTeleop::computeLeapHandAngles(l_oHand, false, l_a4DRightHandAngles);
+        swTeleop::computeLeapFingerAngles(l_oHand, l_a9DFingerAngles);
+
+        for(int jj = 0; jj < 4; ++jj)
+        {
+            l_i32ErrorsNb += !check("left hand", ii, jj, l_a4DLeftHandAngles[jj], GOLDEN_ANGLES[ii][jj]);
+            l_i32ErrorsNb += !check("right hand", ii, jj, l_a4DRightHandAngles[jj], GOLDEN_ANGLES[ii][4 + jj]);
+        }
+
+        for(int jj = 0; jj < 9; ++jj)
+        {
+            l_i32ErrorsNb += !check("fingers", ii, jj, l_a9DFingerAngles[jj], GOLDEN_ANGLES[ii][8 + jj]);
+        }
+    }
+
+    // stack kernels against the std::vector versions of geometryUtility
+    for(int ii = 0; ii < 10000; ++ii)
+    {
+        std::vector<double> l_vAxis(3), l_vRotation(3);
+        swUtil::SWVec3d l_vAxis3, l_vRotation3;
+
+        for(int jj = 0; jj < 3; ++jj)
+        {
+            l_vAxis3[jj]     = l_vAxis[jj]     = nextValue(l_ui32Seed);
+            l_vRotation3[jj] = l_vRotation[jj] = nextValue(l_ui32Seed);
+        }
+
+        std::vector<double> l_vRollPitchYaw = swUtil::computeRollPitchYaw(l_vAxis, l_vRotation);
+        double l_a3DRollPitchYaw[3];
+        swUtil::computeRollPitchYaw3(l_vAxis3, l_vRotation3, l_a3DRollPitchYaw);
+
+        for(int jj = 0; jj < 3; ++jj)
+        {
+            l_i32ErrorsNb += !check("computeRollPitchYaw3", ii, jj, l_a3DRollPitchYaw[jj], l_vRollPitchYaw[jj]);
+        }
+
+        l_i32ErrorsNb += !check("vectorAngle3", ii, 0, swUtil::vectorAngle3(l_vAxis3, l_vRotation3), swUtil::vectorAngle(l_vAxis, l_vRotation));
+    }
+
+    if(l_i32ErrorsNb > 0)
+    {
+        std::cerr << "SWTestLeapHandAngles : " << l_i32ErrorsNb << " error(s). " << std::endl;
+        return 1;
+    }
+
+    std::cout << "SWTestLeapHandAngles : all the values match. " << std::endl;
+    return 0;
+}
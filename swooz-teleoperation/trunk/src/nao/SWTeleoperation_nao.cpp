@@ -43,6 +43,7 @@
 #include "opencv2/core/core.hpp"
 #include "opencvUtility.h"
 #include "geometryUtility.h"
+#include "kinematicsUtility.h"
 
 SWTeleoperation_nao::SWTeleoperation_nao() :  m_i32HeadTimeLastBottle(0)
 {    
@@ -79,6 +80,17 @@ SWTeleoperation_nao::SWTeleoperation_nao() :  m_i32HeadTimeLastBottle(0)
     m_aRArmAngles.arraySetSize(6);
     m_aLLegAngles.arraySetSize(6);
     m_aRLegAngles.arraySetSize(6);   
+
+    m_aHeadNames        = AL::ALValue::array("HeadYaw", "HeadPitch");
+    m_aHeadTargetAngles = AL::ALValue::array(0.f,0.f);
+    m_aTorsoNames       = AL::ALValue::array("LHipPitch","RHipPitch");
+    m_aLArmName         = AL::ALValue("LArm");
+    m_aRArmName         = AL::ALValue("RArm");
+
+    for(int ii = 0; ii < swDevice::UB_JOINTS_NB; ++ii)
+    {
+        m_aSkeletonJoints[ii] = swUtil::vec3(0., 0., 0.);
+    }
 }
 
 
@@ -145,6 +157,9 @@ bool SWTeleoperation_nao::configure(ResourceFinder &oRf)
         m_i32Fps                    = oRf.check("fps",              yarp::os::Value(100),  "Frame per second (int)").asInt();
         m_i32HeadTimeoutReset       = oRf.check("headTimeoutReset", yarp::os::Value(3000), "Head gaze timeout reset iCub (int)").asInt();
 
+    // targets filters
+        m_oHeadFilter.reset(2, swTeleop::readFilterParams(oRf, "head"));
+
     // init ports
         std::string l_sHeadTrackerPortName  = "/teleoperation/nao/head";
         std::string l_sTorsoTrackerPortName = "/teleoperation/nao/torso";
@@ -396,66 +411,74 @@ bool SWTeleoperation_nao::updateModule()
 {
     std::cout << "u-> ";
 
-    AL::ALValue l_headNames = AL::ALValue::array("HeadYaw", "HeadPitch");
-    AL::ALValue l_headAngles = AL::ALValue::array(0.f,0.f);
-
-    AL::ALValue l_torsoNames = AL::ALValue::array("LHipYawPitch", "RHipYawPitch");
-    AL::ALValue l_torsoAngles = AL::ALValue::array(0.f,0.f);
-
-    AL::ALValue l_rightArmNames = AL::ALValue::array("RShoulderPitch", "RElbowYaw", "RElbowRoll");
-    AL::ALValue l_rightArmAngles = AL::ALValue::array(0.f,0.f,0.f);
-
-    AL::ALValue l_leftArmNames = AL::ALValue::array("LShoulderPitch", "LElbowYaw", "LElbowRoll");
-    AL::ALValue l_lefttArmAngles = AL::ALValue::array(0.f,0.f,0.f);
-
-
     Bottle *l_pHeadTarget = NULL, *l_pTorsoTarget = NULL, *l_pLeftArmTarget = NULL, *l_pRightArmTarget = NULL, *l_pFaceTarget = NULL;
 
     bool l_bHeadCapture = false, l_bTorsoCapture = false, l_bLeftArmCapture = false, l_bRightArmCapture = false, l_bFaceCapture = false;
 
-    // read head commands
+    // read the commands of the activated parts
     if(m_bHeadActivated)
     {
         l_pHeadTarget = m_oHeadTrackerPort.read(false);
+    }
+    if(m_bTorsoActivated)
+    {
+        l_pTorsoTarget = m_oTorsoTrackerPort.read(false);
+    }
+    if(m_bLeftArmActivated)
+    {
+        l_pLeftArmTarget = m_oLeftArmTrackerPort.read(false);
+    }
+    if(m_bRightArmActivated)
+    {
+        l_pRightArmTarget = m_oRightArmTrackerPort.read(false);
+    }
 
+    // gather the joints of the OpenNI bottles, then compute the angles of all the limbs in one pass
+    bool l_bSkeleton = readSkeletonJoints(l_pHeadTarget, swDevice::OPENNI_HEAD_JOINTS, swDevice::OPENNI_HEAD_JOINTS_NB);
+    l_bSkeleton = readSkeletonJoints(l_pTorsoTarget,     swDevice::OPENNI_TORSO_JOINTS,     swDevice::OPENNI_TORSO_JOINTS_NB) || l_bSkeleton;
+    l_bSkeleton = readSkeletonJoints(l_pLeftArmTarget,   swDevice::OPENNI_LEFT_ARM_JOINTS,  swDevice::OPENNI_ARM_JOINTS_NB)   || l_bSkeleton;
+    l_bSkeleton = readSkeletonJoints(l_pRightArmTarget,  swDevice::OPENNI_RIGHT_ARM_JOINTS, swDevice::OPENNI_ARM_JOINTS_NB)   || l_bSkeleton;
+
+    if(l_bSkeleton)
+    {
+        swDevice::computeUpperBodyAngles(m_aSkeletonJoints, m_oSkeletonAngles);
+    }
+
+    // head commands
+    if(m_bHeadActivated)
+    {
         if(l_pHeadTarget)
         {
+            m_aHeadTargetAngles[0] = 0.f;
+            m_aHeadTargetAngles[1] = 0.f;
+
             int l_deviceId = l_pHeadTarget->get(0).asInt();
             switch(l_deviceId)
             {
                 case swTracking::OPENNI_LIB :
                 {
-                    std::vector<double> l_pointNeck(3), l_pointHead(3), l_pointLShoulder(3), l_pointRShoulder(3);
-                    l_pointNeck[0] = l_pHeadTarget->get(1).asDouble();
-                    l_pointNeck[1] = l_pHeadTarget->get(2).asDouble();
-                    l_pointNeck[2] = l_pHeadTarget->get(3).asDouble();
-                    l_pointHead[0] = l_pHeadTarget->get(4).asDouble();
-                    l_pointHead[1] = l_pHeadTarget->get(5).asDouble();
-                    l_pointHead[2] = l_pHeadTarget->get(6).asDouble();
-                    l_pointLShoulder[0] = l_pHeadTarget->get(7).asDouble();
-                    l_pointLShoulder[1] = l_pHeadTarget->get(8).asDouble();
-                    l_pointLShoulder[2] = l_pHeadTarget->get(9).asDouble();
-                    l_pointRShoulder[0] = l_pHeadTarget->get(10).asDouble();
-                    l_pointRShoulder[1] = l_pHeadTarget->get(11).asDouble();
-                    l_pointRShoulder[2] = l_pHeadTarget->get(12).asDouble();
-
-                    std::vector<double> l_vecClavicles		= swUtil::vec(l_pointLShoulder,	l_pointRShoulder);
-                    std::vector<double> l_vecHead			= swUtil::vec(l_pointNeck,		l_pointHead);
-
-                    std::vector<double> l_rpyHead = swUtil::computeRollPitchYaw(l_vecHead, l_vecClavicles);
-
-                    l_headAngles[0] = swUtil::deg2rad(l_rpyHead[2]);
-                    l_headAngles[1] = swUtil::deg2rad(l_rpyHead[1]);
+                    const double *l_rpyHead = m_oSkeletonAngles.m_a3DRollPitchYaw[swDevice::LIMB_HEAD];
+
+                    m_aHeadTargetAngles[0] = swUtil::deg2rad(l_rpyHead[2]);
+                    m_aHeadTargetAngles[1] = swUtil::deg2rad(l_rpyHead[1]);
                 }
                 break;
                 case swTracking::FOREST_LIB :
                 {                
-                    l_headAngles[0] = swUtil::deg2rad(-l_pHeadTarget->get(2).asDouble());  // HeadYaw -5?
-                    l_headAngles[1] = swUtil::deg2rad(l_pHeadTarget->get(1).asDouble() );  // HeadPitch  -5?
+                    m_aHeadTargetAngles[0] = swUtil::deg2rad(-l_pHeadTarget->get(2).asDouble());  // HeadYaw -5?
+                    m_aHeadTargetAngles[1] = swUtil::deg2rad(l_pHeadTarget->get(1).asDouble() );  // HeadPitch  -5?
                 }
                 break;
             }
 
+            // filter the head angles before sending them
+            if(m_oHeadFilter.isEnabled())
+            {
+                double l_dTime = yarp::os::Time::now();
+                m_aHeadTargetAngles[0] = static_cast<float>(m_oHeadFilter.filter(0, m_aHeadTargetAngles[0].getUnionValue().asFloat, l_dTime));
+                m_aHeadTargetAngles[1] = static_cast<float>(m_oHeadFilter.filter(1, m_aHeadTargetAngles[1].getUnionValue().asFloat, l_dTime));
+            }
+
             m_i32HeadTimeLastBottle = 0;
             l_bHeadCapture = true;
         }
@@ -467,15 +490,14 @@ bool SWTeleoperation_nao::updateModule()
             {
                 m_i32HeadTimeLastBottle = 0;
                 resetHeadPosition();
+                m_oHeadFilter.reset();
             }
         }
     }
 
-    //read torso commands
+    // torso commands
     if(m_bTorsoActivated)
     {
-        l_pTorsoTarget = m_oTorsoTrackerPort.read(false);
-
         if (l_pTorsoTarget)
         {
             int l_deviceId = l_pTorsoTarget->get(0).asInt();
@@ -483,23 +505,7 @@ bool SWTeleoperation_nao::updateModule()
             {
                 case swTracking::OPENNI_LIB:
                 {
-                    std::vector<double> l_pointTorso(3), l_pointNeck(3), l_pointLShoulder(3), l_pointRShoulder(3);
-                    l_pointTorso[0] = l_pTorsoTarget->get(1).asDouble();
-                    l_pointTorso[1] = l_pTorsoTarget->get(2).asDouble();
-                    l_pointTorso[2] = l_pTorsoTarget->get(3).asDouble();
-                    l_pointNeck[0] = l_pTorsoTarget->get(4).asDouble();
-                    l_pointNeck[1] = l_pTorsoTarget->get(5).asDouble();
-                    l_pointNeck[2] = l_pTorsoTarget->get(6).asDouble();
-                    l_pointLShoulder[0] = l_pTorsoTarget->get(7).asDouble();
-                    l_pointLShoulder[1] = l_pTorsoTarget->get(8).asDouble();
-                    l_pointLShoulder[2] = l_pTorsoTarget->get(9).asDouble();
-                    l_pointRShoulder[0] = l_pTorsoTarget->get(10).asDouble();
-                    l_pointRShoulder[1] = l_pTorsoTarget->get(11).asDouble();
-                    l_pointRShoulder[2] = l_pTorsoTarget->get(12).asDouble();
-
-                    std::vector<double> l_vecTorso     = swUtil::vec(l_pointTorso, l_pointNeck);
-                    std::vector<double> l_vecClavicles = swUtil::vec(l_pointLShoulder, l_pointRShoulder);
-                    std::vector<double> l_rpyTorso     = swUtil::computeRollPitchYaw(l_vecTorso, l_vecClavicles);
+                    const double *l_rpyTorso = m_oSkeletonAngles.m_a3DRollPitchYaw[swDevice::LIMB_TORSO];
 
                     m_aTorsoAngles[0] = -swUtil::deg2rad(l_rpyTorso[1]+28.5);
                     m_aTorsoAngles[1] = m_aTorsoAngles[0];
@@ -511,11 +517,9 @@ bool SWTeleoperation_nao::updateModule()
         }
     }
 
-    //read left arm
+    // left arm commands
     if(m_bLeftArmActivated)
     {
-        l_pLeftArmTarget = m_oLeftArmTrackerPort.read(false);
-
         if(l_pLeftArmTarget)
         {
             int l_deviceId = l_pLeftArmTarget->get(0).asInt();
@@ -524,29 +528,8 @@ bool SWTeleoperation_nao::updateModule()
             {
                 case swTracking::OPENNI_LIB :
                 {
-                    std::vector<double> l_pointTorso(3), l_pointNeck(3), l_pointLShoulder(3), l_pointLElbow(3), l_pointLHand(3);
-                    l_pointTorso[0] = l_pLeftArmTarget->get(1).asDouble();
-                    l_pointTorso[1] = l_pLeftArmTarget->get(2).asDouble();
-                    l_pointTorso[2] = l_pLeftArmTarget->get(3).asDouble();
-                    l_pointNeck[0] = l_pLeftArmTarget->get(4).asDouble();
-                    l_pointNeck[1] = l_pLeftArmTarget->get(5).asDouble();
-                    l_pointNeck[2] = l_pLeftArmTarget->get(6).asDouble();
-                    l_pointLShoulder[0] = l_pLeftArmTarget->get(7).asDouble();
-                    l_pointLShoulder[1] = l_pLeftArmTarget->get(8).asDouble();
-                    l_pointLShoulder[2] = l_pLeftArmTarget->get(9).asDouble();
-                    l_pointLElbow[0] = l_pLeftArmTarget->get(10).asDouble();
-                    l_pointLElbow[1] = l_pLeftArmTarget->get(11).asDouble();
-                    l_pointLElbow[2] = l_pLeftArmTarget->get(12).asDouble();
-                    l_pointLHand[0] = l_pLeftArmTarget->get(13).asDouble();
-                    l_pointLHand[1] = l_pLeftArmTarget->get(14).asDouble();
-                    l_pointLHand[2] = l_pLeftArmTarget->get(15).asDouble();
-
-                    std::vector<double> l_vecTorso = swUtil::vec(l_pointTorso, l_pointNeck);
-                    std::vector<double> l_vecLForearm = swUtil::vec(l_pointLElbow, l_pointLHand);
-                    std::vector<double> l_vecLArm = swUtil::vec(l_pointLShoulder, l_pointLElbow);
-                    std::vector<double> l_rpyLShoulder = swUtil::computeRollPitchYaw(l_vecLArm, l_vecTorso);
-                    std::vector<double> l_rpyLElbow = swUtil::computeRollPitchYaw(l_vecLForearm, l_vecLArm);
-
+                    const double *l_rpyLShoulder = m_oSkeletonAngles.m_a3DRollPitchYaw[swDevice::LIMB_LEFT_SHOULDER];
+                    const double *l_rpyLElbow    = m_oSkeletonAngles.m_a3DRollPitchYaw[swDevice::LIMB_LEFT_ELBOW];
 
                     m_aLArmAngles[0] = swUtil::deg2rad(swUtil::degree180(l_rpyLShoulder[1] - 90.));
                     m_aLArmAngles[1] = swUtil::deg2rad(swUtil::degree180(- l_rpyLShoulder[0] - 180.));
@@ -567,11 +550,9 @@ bool SWTeleoperation_nao::updateModule()
         }
     }
 
-    //read right arm
+    // right arm commands
     if(m_bRightArmActivated)
     {
-        l_pRightArmTarget = m_oRightArmTrackerPort.read(false);
-
         if(l_pRightArmTarget)
         {
             int l_deviceId = l_pRightArmTarget->get(0).asInt();
@@ -582,16 +563,21 @@ bool SWTeleoperation_nao::updateModule()
                 {
 //                AL::ALValue l_rightArmNames = AL::ALValue::array("RShoulderPitch", "RShoulderRoll", "RElbowYaw", "RElbowRoll", "RWristYaw");
 
-                    // retrieve leap data
+                    // retrieve leap data, the bottle can use the list or the binary format (an invalid payload keeps the previous targets)
+                    if(!m_oRightArmBottleValues.decode(*l_pRightArmTarget))
+                    {
+                        break;
+                    }
+
                     std::vector<double> l_vArmDirection(3,0.), l_vHandDirection(3,0.),l_vHandDirectionE(3,0.), l_vHandPalmCoord(3,0.), l_vHandPalmNormal(3,0.), l_vHandPalmNormalE(3,0.);
                     for(int ii = 0; ii < 3; ++ii)
                     {
-                        l_vArmDirection[ii]     = l_pRightArmTarget->get(1 + ii).asDouble();
-                        l_vHandDirection[ii]    = l_pRightArmTarget->get(4 + ii).asDouble();
-                        l_vHandDirectionE[ii]   = l_pRightArmTarget->get(7 + ii).asDouble();
-                        l_vHandPalmCoord[ii]    = l_pRightArmTarget->get(10 + ii).asDouble();
-                        l_vHandPalmNormal[ii]   = l_pRightArmTarget->get(13 + ii).asDouble();
-                        l_vHandPalmNormalE[ii]  = l_pRightArmTarget->get(16 + ii).asDouble();
+                        l_vArmDirection[ii]     = m_oRightArmBottleValues.get(1 + ii);
+                        l_vHandDirection[ii]    = m_oRightArmBottleValues.get(4 + ii);
+                        l_vHandDirectionE[ii]   = m_oRightArmBottleValues.get(7 + ii);
+                        l_vHandPalmCoord[ii]    = m_oRightArmBottleValues.get(10 + ii);
+                        l_vHandPalmNormal[ii]   = m_oRightArmBottleValues.get(13 + ii);
+                        l_vHandPalmNormalE[ii]  = m_oRightArmBottleValues.get(16 + ii);
                     }
 
                     // convert to vec3D
@@ -632,34 +618,8 @@ bool SWTeleoperation_nao::updateModule()
                 break;
                 case swTracking::OPENNI_LIB :
                 {
-                    std::vector<double> l_pointTorso(3), l_pointNeck(3), l_pointLShoulder(3), l_pointLElbow(3), l_pointLHand(3), l_rpyRShoulder(3), l_rpyRElbow(3);
-                    l_pointTorso[0] = l_pRightArmTarget->get(1).asDouble();
-                    l_pointTorso[1] = l_pRightArmTarget->get(2).asDouble();
-                    l_pointTorso[2] = l_pRightArmTarget->get(3).asDouble();
-                    l_pointNeck[0] = l_pRightArmTarget->get(4).asDouble();
-                    l_pointNeck[1] = l_pRightArmTarget->get(5).asDouble();
-                    l_pointNeck[2] = l_pRightArmTarget->get(6).asDouble();
-                    l_pointLShoulder[0] = l_pRightArmTarget->get(7).asDouble();
-                    l_pointLShoulder[1] = l_pRightArmTarget->get(8).asDouble();
-                    l_pointLShoulder[2] = l_pRightArmTarget->get(9).asDouble();
-                    l_pointLElbow[0] = l_pRightArmTarget->get(10).asDouble();
-                    l_pointLElbow[1] = l_pRightArmTarget->get(11).asDouble();
-                    l_pointLElbow[2] = l_pRightArmTarget->get(12).asDouble();
-                    l_pointLHand[0] = l_pRightArmTarget->get(13).asDouble();
-                    l_pointLHand[1] = l_pRightArmTarget->get(14).asDouble();
-                    l_pointLHand[2] = l_pRightArmTarget->get(15).asDouble();
-                    l_rpyRShoulder[0] = l_pRightArmTarget->get(1).asDouble();
-                    l_rpyRShoulder[1] = l_pRightArmTarget->get(2).asDouble();
-                    l_rpyRShoulder[2] = l_pRightArmTarget->get(3).asDouble();
-                    l_rpyRElbow[0] = l_pRightArmTarget->get(4).asDouble();
-                    l_rpyRElbow[1] = l_pRightArmTarget->get(5).asDouble();
-                    l_rpyRElbow[2] = l_pRightArmTarget->get(6).asDouble();
-
-                    std::vector<double> l_vecTorso      = swUtil::vec(l_pointTorso, l_pointNeck);
-                    std::vector<double> l_vecLForearm   = swUtil::vec(l_pointLElbow, l_pointLHand);
-                    std::vector<double> l_vecLArm       = swUtil::vec(l_pointLShoulder, l_pointLElbow);
-                    std::vector<double> l_rpyLShoulder  = swUtil::computeRollPitchYaw(l_vecLArm, l_vecTorso);
-                    std::vector<double> l_rpyLElbow     = swUtil::computeRollPitchYaw(l_vecLForearm, l_vecLArm);
+                    const double *l_rpyRShoulder = m_oSkeletonAngles.m_a3DRollPitchYaw[swDevice::LIMB_RIGHT_SHOULDER];
+                    const double *l_rpyRElbow    = m_oSkeletonAngles.m_a3DRollPitchYaw[swDevice::LIMB_RIGHT_ELBOW];
 
                     m_aRArmAngles[0] = swUtil::deg2rad(swUtil::degree180(l_rpyRShoulder[1] - 90.));
                     m_aRArmAngles[1] = swUtil::deg2rad(swUtil::degree180(-l_rpyRShoulder[0]-180));
@@ -743,22 +703,22 @@ bool SWTeleoperation_nao::updateModule()
     if (l_bHeadCapture)
     {
 //        m_oRobotMotionProxy->setAngles(AL::ALValue("Head"), m_aHeadAngles, static_cast<float>(m_dJointVelocityValue));
-        m_oRobotMotionProxy->setAngles(l_headNames, l_headAngles, static_cast<float>(m_dJointVelocityValue));
+        m_oRobotMotionProxy->setAngles(m_aHeadNames, m_aHeadTargetAngles, static_cast<float>(m_dJointVelocityValue));
     }
 
     if (l_bTorsoCapture)
     {
-        m_oRobotMotionProxy->setAngles(AL::ALValue::array("LHipPitch","RHipPitch"), m_aTorsoAngles, static_cast<float>(m_dJointVelocityValue));
+        m_oRobotMotionProxy->setAngles(m_aTorsoNames, m_aTorsoAngles, static_cast<float>(m_dJointVelocityValue));
     }
 
     if (l_bLeftArmCapture)
     {
-        m_oRobotMotionProxy->setAngles(AL::ALValue("LArm"), m_aLArmAngles, static_cast<float>(m_dJointVelocityValue));
+        m_oRobotMotionProxy->setAngles(m_aLArmName, m_aLArmAngles, static_cast<float>(m_dJointVelocityValue));
     }
 
     if (l_bRightArmCapture)
     {       
-        m_oRobotMotionProxy->setAngles(AL::ALValue("RArm"), m_aRArmAngles, static_cast<float>(m_dJointVelocityValue));
+        m_oRobotMotionProxy->setAngles(m_aRArmName, m_aRArmAngles, static_cast<float>(m_dJointVelocityValue));
     }
 
     std::cout << " <-u\n";
@@ -767,6 +727,24 @@ bool SWTeleoperation_nao::updateModule()
 }
 
 
+bool SWTeleoperation_nao::readSkeletonJoints(const yarp::os::Bottle *pBottle, const int *aJointsId, cint i32JointsNb)
+{
+    if(!pBottle || pBottle->get(0).asInt() != swTracking::OPENNI_LIB || pBottle->size() < 1 + 3 * i32JointsNb)
+    {
+        return false;
+    }
+
+    for(int ii = 0; ii < i32JointsNb; ++ii)
+    {
+        swUtil::SWVec3d &l_joint = m_aSkeletonJoints[aJointsId[ii]];
+        l_joint[0] = pBottle->get(1 + 3 * ii).asDouble();
+        l_joint[1] = pBottle->get(2 + 3 * ii).asDouble();
+        l_joint[2] = pBottle->get(3 + 3 * ii).asDouble();
+    }
+
+    return true;
+}
+
 double SWTeleoperation_nao::getPeriod()
 {
     return 1./m_i32Fps;
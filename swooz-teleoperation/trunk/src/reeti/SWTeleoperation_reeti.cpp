@@ -14,6 +14,7 @@
 #include <iostream>
 
 #include "geometryUtility.h"
+#include "kinematicsUtility.h"
 
 
 //using namespace std;
@@ -119,6 +120,9 @@ bool SWTeleoperation_reeti::configure(ResourceFinder &oRf)
 	m_i32FaceTimeoutReset      	= oRf.check("faceTimeoutReset", yarp::os::Value(3000), "Face timeout reset Reeti (int)").asInt();
 	m_i32GazeTimeoutReset      	= oRf.check("gazeTimeoutReset", yarp::os::Value(3000), "Gaze timeout reset Reeti (int)").asInt();
 
+	// targets filters
+	m_oHeadFilter.reset(3, swTeleop::readFilterParams(oRf, "head"));
+
 	// init ports
         std::string l_sHeadTrackerPortName  = "/teleoperation/" + m_sRobotName + "/head";
 	std::string l_sGazeTrackerPortName  = "/teleoperation/" + m_sRobotName + "/gaze";
@@ -322,7 +326,7 @@ bool SWTeleoperation_reeti::updateModule()
 				break;
 				case swTracking::OPENNI_LIB :
 				{
-					std::vector<double> l_pointNeck(3), l_pointHead(3), l_pointLShoulder(3), l_pointRShoulder(3);
+					swUtil::SWVec3d l_pointNeck, l_pointHead, l_pointLShoulder, l_pointRShoulder;
 					l_pointNeck[0] = l_pHeadTarget->get(1).asDouble();
 					l_pointNeck[1] = l_pHeadTarget->get(2).asDouble();
 					l_pointNeck[2] = l_pHeadTarget->get(3).asDouble();
@@ -336,9 +340,10 @@ bool SWTeleoperation_reeti::updateModule()
 					l_pointRShoulder[1] = l_pHeadTarget->get(11).asDouble();
 					l_pointRShoulder[2] = l_pHeadTarget->get(12).asDouble();
 
-					std::vector<double> l_vecClavicles  = swUtil::vec(l_pointLShoulder,	l_pointRShoulder);
-					std::vector<double> l_vecHead       = swUtil::vec(l_pointNeck,		l_pointHead);
-					std::vector<double> l_rpyHead = swUtil::computeRollPitchYaw(l_vecHead, l_vecClavicles);
+					swUtil::SWVec3d l_vecClavicles  = swUtil::vec3(l_pointLShoulder,	l_pointRShoulder);
+					swUtil::SWVec3d l_vecHead       = swUtil::vec3(l_pointNeck,		l_pointHead);
+					double l_rpyHead[3];
+					swUtil::computeRollPitchYaw3(l_vecHead, l_vecClavicles, l_rpyHead);
 
 					l_vHeadJoints[0] = -l_rpyHead[1];
 					l_vHeadJoints[1] = -l_rpyHead[0];
@@ -347,6 +352,9 @@ bool SWTeleoperation_reeti::updateModule()
 				break;
 			}
 			
+			// filter the head joints before sending them
+			m_oHeadFilter.filter(l_vHeadJoints.data(), 3, yarp::os::Time::now());
+
 			// fills the joint variables (neutral value is not 0! therefore need to rereference the data)
 			l_dNeckRotatValueJoint = l_vHeadJoints[2] * m_dNeckRotatCoeffValueJoint + m_dNeckRotatNeuValueJoint;
 			l_dNeckTiltValueJoint = l_vHeadJoints[0] * m_dNeckTiltCoeffValueJoint + m_dNeckTiltNeuValueJoint;
@@ -362,6 +370,7 @@ bool SWTeleoperation_reeti::updateModule()
 			{
 				m_i32HeadTimeLastBottle = 0;
 				resetPosition();
+				m_oHeadFilter.reset();
 			}
 		}
 	}
@@ -0,0 +1,311 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWBenchmarkSkeletonAngles.cpp
+ * \brief Benchmark of the upper body joint angles computation on a recorded skeleton stream :
+ *        per limb std::vector path (swUtil::vec / swUtil::computeRollPitchYaw) against the batched swDevice::computeUpperBodyAngles.
+ *
+ *  Usage : SWBenchmarkSkeletonAngles [record file] [repetitions nb = 20]
+ *  The record file is written by SWOpenNITracking --recordSkeleton <file> : one line per tracked user and per frame,
+ *  "time userId" then the 9 upper body joints (x y z). Without file, a synthetic stream of 3 users is used.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <ctime>
+
+#include "geometryUtility.h"
+#include "devices/rgbd/SWSkeletonFrame.h"
+
+namespace
+{
+    /**
+     * \brief A recorded user : id and upper body joints.
+     */
+    struct SWRecordedUser
+    {
+        int m_i32Id;                                            /**< user id */
+        double m_aDJoints[swDevice::UB_JOINTS_NB * 3];          /**< joints x y z */
+    };
+
+    /**
+     * \brief A recorded stream : users of all the frames, and index of the first user of each frame.
+     */
+    struct SWSkeletonStream
+    {
+        std::vector<SWRecordedUser> m_vUsers;   /**< users of all the frames */
+        std::vector<int> m_vFramesFirstUser;    /**< first user of each frame, the last value is the users nb */
+    };
+
+    /**
+     * \brief Read a skeleton record file, the consecutive lines with the same time are the users of a frame.
+     */
+    bool readStream(const std::string &sPath, SWSkeletonStream &oStream)
+    {
+        std::ifstream l_oFile(sPath.c_str());
+        if(!l_oFile.is_open())
+        {
+            std::cerr << "-ERROR : can't open " << sPath << std::endl;
+            return false;
+        }
+
+        std::string l_sLine;
+        double l_dLastTime = -1.0;
+
+        while(std::getline(l_oFile, l_sLine))
+        {
+            std::istringstream l_oLine(l_sLine);
+            double l_dTime;
+            SWRecordedUser l_oUser;
+
+            if(!(l_oLine >> l_dTime >> l_oUser.m_i32Id))
+            {
+                continue;
+            }
+
+            bool l_bValid = true;
+            for(int ii = 0; ii < swDevice::UB_JOINTS_NB * 3 && l_bValid; ++ii)
+            {
+                l_bValid = static_cast<bool>(l_oLine >> l_oUser.m_aDJoints[ii]);
+            }
+
+            if(!l_bValid)
+            {
+                continue;
+            }
+
+            if(l_dTime != l_dLastTime || oStream.m_vUsers.size() - oStream.m_vFramesFirstUser.back() >= swDevice::SKELETON_MAX_USERS)
+            {
+                oStream.m_vFramesFirstUser.push_back(static_cast<int>(oStream.m_vUsers.size()));
+                l_dLastTime = l_dTime;
+            }
+
+            oStream.m_vUsers.push_back(l_oUser);
+        }
+
+        oStream.m_vFramesFirstUser.push_back(static_cast<int>(oStream.m_vUsers.size()));
+
+        return oStream.m_vUsers.size() > 0;
+    }
+
+    /**
+     * \brief Synthetic stream : 3 users moving their head and arms (mm, as OpenNI).
+     */
+    void syntheticStream(cint i32FramesNb, SWSkeletonStream &oStream)
+    {
+        // rest pose : torso, neck, head, left shoulder, right shoulder, left elbow, right elbow, left hand, right hand
+        const double l_aDRest[swDevice::UB_JOINTS_NB * 3] = {
+            0., 0., 2000.,   0., 400., 2000.,   0., 600., 1980.,   -200., 400., 2000.,   200., 400., 2000.,
+            -250., 100., 2000.,   250., 100., 2000.,   -280., -150., 1950.,   280., -150., 1950.};
+
+        for(int ii = 0; ii < i32FramesNb; ++ii)
+        {
+            oStream.m_vFramesFirstUser.push_back(static_cast<int>(oStream.m_vUsers.size()));
+
+            for(int jj = 0; jj < 3; ++jj)
+            {
+                SWRecordedUser l_oUser;
+                l_oUser.m_i32Id = jj + 1;
+
+                double l_dT = ii / 30.0 + jj;
+
+                for(int kk = 0; kk < swDevice::UB_JOINTS_NB * 3; ++kk)
+                {
+                    l_oUser.m_aDJoints[kk] = l_aDRest[kk] + (kk % 3 == 0 ? 800. * (jj - 1) : 0.);
+                }
+
+                // head and hands motions
+                l_oUser.m_aDJoints[swDevice::UB_HEAD * 3]           += 80. * sin(1.3 * l_dT);
+                l_oUser.m_aDJoints[swDevice::UB_HEAD * 3 + 2]       += 60. * sin(0.7 * l_dT);
+                l_oUser.m_aDJoints[swDevice::UB_LEFT_HAND * 3 + 1]  += 300. * sin(2.1 * l_dT);
+                l_oUser.m_aDJoints[swDevice::UB_LEFT_HAND * 3 + 2]  -= 200. * fabs(sin(1.1 * l_dT));
+                l_oUser.m_aDJoints[swDevice::UB_RIGHT_HAND * 3 + 1] += 300. * cos(1.7 * l_dT);
+                l_oUser.m_aDJoints[swDevice::UB_RIGHT_ELBOW * 3]    += 100. * sin(0.9 * l_dT);
+
+                oStream.m_vUsers.push_back(l_oUser);
+            }
+        }
+
+        oStream.m_vFramesFirstUser.push_back(static_cast<int>(oStream.m_vUsers.size()));
+    }
+
+    /**
+     * \brief Per limb path : joints copied in std::vector, then swUtil::vec and swUtil::computeRollPitchYaw for each limb.
+     */
+    void legacyAngles(const SWRecordedUser &oUser, swDevice::SWUpperBodyAngles &oAngles)
+    {
+        std::vector<std::vector<double> > l_vJoints(swDevice::UB_JOINTS_NB, std::vector<double>(3));
+        for(int ii = 0; ii < swDevice::UB_JOINTS_NB; ++ii)
+        {
+            for(int jj = 0; jj < 3; ++jj)
+            {
+                l_vJoints[ii][jj] = oUser.m_aDJoints[ii * 3 + jj];
+            }
+        }
+
+        std::vector<double> l_vRpy[swDevice::LIMBS_NB];
+
+        l_vRpy[swDevice::LIMB_HEAD]  = swUtil::computeRollPitchYaw(swUtil::vec(l_vJoints[swDevice::UB_NECK],  l_vJoints[swDevice::UB_HEAD]),
+                                                                   swUtil::vec(l_vJoints[swDevice::UB_LEFT_SHOULDER], l_vJoints[swDevice::UB_RIGHT_SHOULDER]));
+        l_vRpy[swDevice::LIMB_TORSO] = swUtil::computeRollPitchYaw(swUtil::vec(l_vJoints[swDevice::UB_TORSO], l_vJoints[swDevice::UB_NECK]),
+                                                                   swUtil::vec(l_vJoints[swDevice::UB_LEFT_SHOULDER], l_vJoints[swDevice::UB_RIGHT_SHOULDER]));
+        l_vRpy[swDevice::LIMB_LEFT_SHOULDER]  = swUtil::computeRollPitchYaw(swUtil::vec(l_vJoints[swDevice::UB_LEFT_SHOULDER], l_vJoints[swDevice::UB_LEFT_ELBOW]),
+                                                                            swUtil::vec(l_vJoints[swDevice::UB_TORSO], l_vJoints[swDevice::UB_NECK]));
+        l_vRpy[swDevice::LIMB_LEFT_ELBOW]     = swUtil::computeRollPitchYaw(swUtil::vec(l_vJoints[swDevice::UB_LEFT_ELBOW], l_vJoints[swDevice::UB_LEFT_HAND]),
+                                                                            swUtil::vec(l_vJoints[swDevice::UB_LEFT_SHOULDER], l_vJoints[swDevice::UB_LEFT_ELBOW]));
+        l_vRpy[swDevice::LIMB_RIGHT_SHOULDER] = swUtil::computeRollPitchYaw(swUtil::vec(l_vJoints[swDevice::UB_RIGHT_SHOULDER], l_vJoints[swDevice::UB_RIGHT_ELBOW]),
+                                                                            swUtil::vec(l_vJoints[swDevice::UB_TORSO], l_vJoints[swDevice::UB_NECK]));
+        l_vRpy[swDevice::LIMB_RIGHT_ELBOW]    = swUtil::computeRollPitchYaw(swUtil::vec(l_vJoints[swDevice::UB_RIGHT_ELBOW], l_vJoints[swDevice::UB_RIGHT_HAND]),
+                                                                            swUtil::vec(l_vJoints[swDevice::UB_RIGHT_SHOULDER], l_vJoints[swDevice::UB_RIGHT_ELBOW]));
+
+        for(int ii = 0; ii < swDevice::LIMBS_NB; ++ii)
+        {
+            for(int jj = 0; jj < 3; ++jj)
+            {
+                oAngles.m_a3DRollPitchYaw[ii][jj] = l_vRpy[ii][jj];
+            }
+        }
+    }
+
+    /**
+     * \brief Copy the users of a recorded frame in a preallocated skeleton frame, as SWKinectSkeleton::grab does.
+     */
+    void fillFrame(const SWSkeletonStream &oStream, cint i32Frame, swDevice::SWSkeletonFrame &oFrame)
+    {
+        int l_i32First      = oStream.m_vFramesFirstUser[i32Frame];
+        oFrame.m_i32UsersNb  = oStream.m_vFramesFirstUser[i32Frame + 1] - l_i32First;
+        oFrame.m_i32JointsNb = swDevice::UB_JOINTS_NB;
+
+        for(int ii = 0; ii < oFrame.m_i32UsersNb; ++ii)
+        {
+            const SWRecordedUser &l_oUser = oStream.m_vUsers[l_i32First + ii];
+            swDevice::SWSkeletonUser &l_oFrameUser = oFrame.m_aUsers[ii];
+
+            l_oFrameUser.m_i32Id = l_oUser.m_i32Id;
+            for(int jj = 0; jj < swDevice::UB_JOINTS_NB; ++jj)
+            {
+                l_oFrameUser.m_aJoints[jj] = swUtil::vec3(l_oUser.m_aDJoints[jj * 3], l_oUser.m_aDJoints[jj * 3 + 1], l_oUser.m_aDJoints[jj * 3 + 2]);
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    SWSkeletonStream l_oStream;
+
+    if(argc > 1)
+    {
+        if(!readStream(argv[1], l_oStream))
+        {
+            return -1;
+        }
+    }
+    else
+    {
+        syntheticStream(3000, l_oStream);
+    }
+
+    int l_i32RepetitionsNb = argc > 2 ? atoi(argv[2]) : 20;
+    int l_i32FramesNb      = static_cast<int>(l_oStream.m_vFramesFirstUser.size()) - 1;
+    int l_i32UsersNb       = static_cast<int>(l_oStream.m_vUsers.size());
+
+    std::cout << l_i32FramesNb << " frames, " << l_i32UsersNb << " users skeletons, " << l_i32RepetitionsNb << " repetitions" << std::endl;
+
+    swDevice::SWSkeletonFrame l_oFrame;
+    swDevice::SWUpperBodyAngles l_aBatchedAngles[swDevice::SKELETON_MAX_USERS];
+    swDevice::SWUpperBodyAngles l_oLegacyAngles;
+    double l_dChecksum = 0.0;
+
+    // per limb path
+        clock_t l_oStart = clock();
+        for(int ii = 0; ii < l_i32RepetitionsNb; ++ii)
+        {
+            for(int jj = 0; jj < l_i32UsersNb; ++jj)
+            {
+                legacyAngles(l_oStream.m_vUsers[jj], l_oLegacyAngles);
+                l_dChecksum += l_oLegacyAngles.m_a3DRollPitchYaw[swDevice::LIMB_HEAD][2];
+            }
+        }
+        double l_dLegacyTime = static_cast<double>(clock() - l_oStart) / CLOCKS_PER_SEC;
+
+    // batched path, all the users of a frame at once
+        l_oStart = clock();
+        for(int ii = 0; ii < l_i32RepetitionsNb; ++ii)
+        {
+            for(int jj = 0; jj < l_i32FramesNb; ++jj)
+            {
+                fillFrame(l_oStream, jj, l_oFrame);
+                int l_i32FrameUsersNb = swDevice::computeUpperBodyAngles(l_oFrame, l_aBatchedAngles);
+
+                for(int kk = 0; kk < l_i32FrameUsersNb; ++kk)
+                {
+                    l_dChecksum -= l_aBatchedAngles[kk].m_a3DRollPitchYaw[swDevice::LIMB_HEAD][2];
+                }
+            }
+        }
+        double l_dBatchedTime = static_cast<double>(clock() - l_oStart) / CLOCKS_PER_SEC;
+
+    // results comparison
+        double l_dMaxDiff = 0.0;
+        for(int ii = 0; ii < l_i32FramesNb; ++ii)
+        {
+            fillFrame(l_oStream, ii, l_oFrame);
+            int l_i32FrameUsersNb = swDevice::computeUpperBodyAngles(l_oFrame, l_aBatchedAngles);
+
+            for(int jj = 0; jj < l_i32FrameUsersNb; ++jj)
+            {
+                legacyAngles(l_oStream.m_vUsers[l_oStream.m_vFramesFirstUser[ii] + jj], l_oLegacyAngles);
+
+                for(int kk = 0; kk < swDevice::LIMBS_NB; ++kk)
+                {
+                    for(int ll = 0; ll < 3; ++ll)
+                    {
+                        double l_dDiff = fabs(l_oLegacyAngles.m_a3DRollPitchYaw[kk][ll] - l_aBatchedAngles[jj].m_a3DRollPitchYaw[kk][ll]);
+                        if(l_dDiff > l_dMaxDiff)
+                        {
+                            l_dMaxDiff = l_dDiff;
+                        }
+                    }
+                }
+            }
+        }
+
+    double l_dSkeletonsNb = static_cast<double>(l_i32RepetitionsNb) * l_i32UsersNb;
+
+    printf("%-30s %12s\n", "path", "us / skeleton");
+    printf("%-30s %12.3f\n", "per limb std::vector", 1e6 * l_dLegacyTime / l_dSkeletonsNb);
+    printf("%-30s %12.3f\n", "batched", 1e6 * l_dBatchedTime / l_dSkeletonsNb);
+    printf("max angle difference : %g deg (checksum %g)\n", l_dMaxDiff, l_dChecksum);
+
+    return 0;
+}
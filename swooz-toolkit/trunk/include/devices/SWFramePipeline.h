@@ -0,0 +1,542 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWFramePipeline.h
+ * \brief Defines SWLatestFrame, SWFrameQueue and SWFrameStage_thread
+ *
+ *  Small producer/consumer pipeline for the capture loops : each stage (grab, processing, recording...) runs on its own
+ *  SWFrameStage_thread and hands its frames to the next ones through :
+ *      - a SWLatestFrame slot for the displays : the newest frame replaces the unread one, a slow display never slows down the capture,
+ *      - a bounded SWFrameQueue for the recorders : no frame is dropped, the producer waits when the recorder is late by more than the queue capacity.
+ *  The frames are copied between the stages (shallow copies for cv::Mat), so a stage must write each new frame in new buffers (clone / create)
+ *  and must not modify a frame after it has been published.
+ */
+
+#ifndef _SWFRAMEPIPELINE_
+#define _SWFRAMEPIPELINE_
+
+#include <deque>
+#include <vector>
+#include <string>
+#include <exception>
+
+#include "boost/thread.hpp"
+#include "boost/function.hpp"
+#include "boost/bind.hpp"
+
+#include "devices/SWDevice_thread.h"
+
+namespace swDevice
+{
+    /**
+     * \class SWLatestFrame
+     * \brief Latest-frame-wins slot between a producer and a display.
+     */
+    template<typename TFrame>
+    class SWLatestFrame
+    {
+        public :
+
+            /**
+             * \brief Default SWLatestFrame constructor.
+             */
+            SWLatestFrame() : m_bClosed(false), m_bNewFrame(false), m_ui32PushedNb(0), m_ui32SkippedNb(0)
+            {}
+
+            /**
+             * \brief Replace the current frame, the previous one is skipped if it has not been read.
+             * \param [in] oFrame : new frame
+             * \return false if the slot is closed
+             */
+            bool push(const TFrame &oFrame)
+            {
+                {
+                    boost::lock_guard<boost::mutex> l_oLock(m_oMutex);
+
+                    if(m_bClosed)
+                    {
+                        return false;
+                    }
+
+                    if(m_bNewFrame)
+                    {
+                        ++m_ui32SkippedNb;
+                    }
+
+                    m_oFrame    = oFrame;
+                    m_bNewFrame = true;
+                    ++m_ui32PushedNb;
+                }
+
+                m_oCondition.notify_all();
+                return true;
+            }
+
+            /**
+             * \brief Wait for a frame newer than the last one read.
+             * \param [out] oFrame       : frame
+             * \param [in]  i32TimeOutMs : maximum waiting time in ms, negative to wait until a frame or the closing
+             * \return false if the time out is reached or if the slot has been closed
+             */
+            bool pop(TFrame &oFrame, const int i32TimeOutMs = -1)
+            {
+                boost::unique_lock<boost::mutex> l_oLock(m_oMutex);
+
+                boost::system_time l_oEnd = boost::get_system_time() + boost::posix_time::milliseconds(i32TimeOutMs);
+
+                while(!m_bNewFrame && !m_bClosed)
+                {
+                    if(i32TimeOutMs < 0)
+                    {
+                        m_oCondition.wait(l_oLock);
+                    }
+                    else if(!m_oCondition.timed_wait(l_oLock, l_oEnd))
+                    {
+                        return false;
+                    }
+                }
+
+                if(!m_bNewFrame)
+                {
+                    return false;
+                }
+
+                oFrame      = m_oFrame;
+                m_bNewFrame = false;
+
+                return true;
+            }
+
+            /**
+             * \brief Close the slot and wake up the waiting readers.
+             */
+            void close()
+            {
+                {
+                    boost::lock_guard<boost::mutex> l_oLock(m_oMutex);
+                    m_bClosed = true;
+                }
+
+                m_oCondition.notify_all();
+            }
+
+            /**
+             * \brief Number of frames replaced before having been read.
+             */
+            unsigned int skippedFramesNb()
+            {
+                boost::lock_guard<boost::mutex> l_oLock(m_oMutex);
+                return m_ui32SkippedNb;
+            }
+
+            /**
+             * \brief Number of frames pushed.
+             */
+            unsigned int pushedFramesNb()
+            {
+                boost::lock_guard<boost::mutex> l_oLock(m_oMutex);
+                return m_ui32PushedNb;
+            }
+
+        private :
+
+            bool m_bClosed;                         /**< is the slot closed ? */
+            bool m_bNewFrame;                       /**< has the current frame not been read yet ? */
+            unsigned int m_ui32PushedNb;            /**< number of pushed frames */
+            unsigned int m_ui32SkippedNb;           /**< number of frames replaced before having been read */
+
+            TFrame m_oFrame;                        /**< current frame */
+
+            boost::mutex m_oMutex;                  /**< mutex */
+            boost::condition_variable m_oCondition; /**< signaled for each new frame and at the closing */
+    };
+
+    /**
+     * \class SWFrameQueue
+     * \brief Bounded FIFO between a producer and a recorder, no frame is dropped.
+     */
+    template<typename TFrame>
+    class SWFrameQueue
+    {
+        public :
+
+            /**
+             * \brief SWFrameQueue constructor.
+             * \param [in] ui32Capacity : maximum number of frames waiting in the queue
+             */
+            SWFrameQueue(const unsigned int ui32Capacity = 60) : m_ui32Capacity(ui32Capacity > 0 ? ui32Capacity : 1), m_bClosed(false), m_ui32MaxSize(0)
+            {}
+
+            /**
+             * \brief Add a frame at the end of the queue, wait while the queue is full.
+             * \param [in] oFrame : frame
+             * \return false if the queue has been closed, the frame is not added
+             */
+            bool push(const TFrame &oFrame)
+            {
+                {
+                    boost::unique_lock<boost::mutex> l_oLock(m_oMutex);
+
+                    while(m_dFrames.size() >= m_ui32Capacity && !m_bClosed)
+                    {
+                        m_oNotFull.wait(l_oLock);
+                    }
+
+                    if(m_bClosed)
+                    {
+                        return false;
+                    }
+
+                    m_dFrames.push_back(oFrame);
+
+                    if(m_dFrames.size() > m_ui32MaxSize)
+                    {
+                        m_ui32MaxSize = static_cast<unsigned int>(m_dFrames.size());
+                    }
+                }
+
+                m_oNotEmpty.notify_one();
+                return true;
+            }
+
+            /**
+             * \brief Retrieve the oldest frame of the queue.
+             *  The frames already in the queue are still retrieved after the closing.
+             * \param [out] oFrame       : frame
+             * \param [in]  i32TimeOutMs : maximum waiting time in ms, negative to wait until a frame or the closing
+             * \return false if the time out is reached or if the queue is closed and empty
+             */
+            bool pop(TFrame &oFrame, const int i32TimeOutMs = -1)
+            {
+                {
+                    boost::unique_lock<boost::mutex> l_oLock(m_oMutex);
+
+                    boost::system_time l_oEnd = boost::get_system_time() + boost::posix_time::milliseconds(i32TimeOutMs);
+
+                    while(m_dFrames.empty() && !m_bClosed)
+                    {
+                        if(i32TimeOutMs < 0)
+                        {
+                            m_oNotEmpty.wait(l_oLock);
+                        }
+                        else if(!m_oNotEmpty.timed_wait(l_oLock, l_oEnd))
+                        {
+                            return false;
+                        }
+                    }
+
+                    if(m_dFrames.empty())
+                    {
+                        return false;
+                    }
+
+                    oFrame = m_dFrames.front();
+                    m_dFrames.pop_front();
+                }
+
+                m_oNotFull.notify_one();
+                return true;
+            }
+
+            /**
+             * \brief Close the queue : the pushes are refused and the readers are woken up once the queue is empty.
+             */
+            void close()
+            {
+                {
+                    boost::lock_guard<boost::mutex> l_oLock(m_oMutex);
+                    m_bClosed = true;
+                }
+
+                m_oNotFull.notify_all();
+                m_oNotEmpty.notify_all();
+            }
+
+            /**
+             * \brief Current number of frames in the queue.
+             */
+            unsigned int size()
+            {
+                boost::lock_guard<boost::mutex> l_oLock(m_oMutex);
+                return static_cast<unsigned int>(m_dFrames.size());
+            }
+
+            /**
+             * \brief Highest number of frames reached by the queue, equal to the capacity if the producer had to wait.
+             */
+            unsigned int maxSize()
+            {
+                boost::lock_guard<boost::mutex> l_oLock(m_oMutex);
+                return m_ui32MaxSize;
+            }
+
+        private :
+
+            unsigned int m_ui32Capacity;            /**< maximum number of frames in the queue */
+            bool m_bClosed;                         /**< is the queue closed ? */
+            unsigned int m_ui32MaxSize;             /**< highest number of frames reached */
+
+            std::deque<TFrame> m_dFrames;           /**< waiting frames */
+
+            boost::mutex m_oMutex;                  /**< mutex */
+            boost::condition_variable m_oNotEmpty;  /**< signaled when a frame is added and at the closing */
+            boost::condition_variable m_oNotFull;   /**< signaled when a frame is removed and at the closing */
+    };
+
+    /**
+     * \class SWFrameStage_thread
+     * \brief A pipeline stage : calls its work function in a loop on its own thread and publishes each produced frame in its outputs.
+     *
+     *  The work function returns 1 when a frame has been produced, 0 when no frame is available yet (the loop goes on)
+     *  and -1 at the end of the stream : the stage then closes its outputs and stops by itself.
+     *  An exception thrown by the work function (a device error for example) also stops the stage and closes its outputs,
+     *  the consumers find the error with hasFailed / errorMessage.
+     */
+    template<typename TFrame>
+    class SWFrameStage_thread : public SWDevice_thread
+    {
+        public :
+
+            typedef boost::function<int (TFrame &)> WorkFunction;
+
+            /**
+             * \brief SWFrameStage_thread constructor.
+             * \param [in] fWork : work function, fills the frame to publish
+             */
+            SWFrameStage_thread(const WorkFunction &fWork) : m_fWork(fWork), m_ui32FramesNb(0), m_bFailed(false)
+            {}
+
+            /**
+             * \brief SWFrameStage_thread destructor.
+             */
+            virtual ~SWFrameStage_thread()
+            {
+                stopListening();
+            }
+
+            /**
+             * \brief Add a latest frame output, must be called before startListening.
+             * \param [in] pLatestFrame : slot to fill
+             */
+            void addOutput(SWLatestFrame<TFrame> *pLatestFrame)
+            {
+                m_vLatestFrameOutputs.push_back(pLatestFrame);
+            }
+
+            /**
+             * \brief Add a queue output, must be called before startListening.
+             * \param [in] pQueue : queue to fill
+             */
+            void addOutput(SWFrameQueue<TFrame> *pQueue)
+            {
+                m_vQueueOutputs.push_back(pQueue);
+            }
+
+            /**
+             * \brief Launch the stage thread.
+             */
+            virtual void startListening()
+            {
+                if(!m_bListening)
+                {
+                    m_bListening       = true;
+                    m_pListeningThread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&SWFrameStage_thread::doWork, this)));
+                }
+            }
+
+            /**
+             * \brief Stop the stage thread, a wait on a full queue or on an empty input is interrupted, then close the outputs.
+             */
+            virtual void stopListening()
+            {
+                if(m_pListeningThread)
+                {
+                    {
+                        boost::lock_guard<boost::mutex> l_oLock(m_oMutex);
+                        m_bListening = false;
+                    }
+
+                    m_pListeningThread->interrupt();
+                    m_pListeningThread->join();
+                    m_pListeningThread.reset();
+
+                    closeOutputs();
+                }
+            }
+
+            /**
+             * \brief Wait for the end of the stream (work function returned -1).
+             */
+            void waitEnd()
+            {
+                if(m_pListeningThread)
+                {
+                    m_pListeningThread->join();
+                    m_pListeningThread.reset();
+                }
+            }
+
+            /**
+             * \brief Is the stage thread still running ?
+             */
+            bool isRunning()
+            {
+                boost::lock_guard<boost::mutex> l_oLock(m_oMutex);
+                return m_bListening;
+            }
+
+            /**
+             * \brief Number of frames produced by the work function.
+             */
+            unsigned int framesNb()
+            {
+                boost::lock_guard<boost::mutex> l_oLock(m_oMutex);
+                return m_ui32FramesNb;
+            }
+
+            /**
+             * \brief Has the stage been stopped by an exception of its work function ?
+             */
+            bool hasFailed()
+            {
+                boost::lock_guard<boost::mutex> l_oLock(m_oMutex);
+                return m_bFailed;
+            }
+
+            /**
+             * \brief Message of the exception which stopped the stage, empty if none.
+             */
+            std::string errorMessage()
+            {
+                boost::lock_guard<boost::mutex> l_oLock(m_oMutex);
+                return m_sErrorMessage;
+            }
+
+        protected :
+
+            /**
+             * \brief Work thread.
+             */
+            virtual void doWork()
+            {
+                TFrame l_oFrame;
+
+                while(m_bListening)
+                {
+                    int l_i32Result = -1;
+
+                    try
+                    {
+                        l_i32Result = m_fWork(l_oFrame);
+                    }
+                    catch(const boost::thread_interrupted &)
+                    {
+                        throw; // stopListening
+                    }
+                    catch(const std::exception &e)
+                    {
+                        setError(e.what());
+                    }
+                    catch(...)
+                    {
+                        setError("unknown exception in the work function");
+                    }
+
+                    if(l_i32Result < 0)
+                    {
+                        break;
+                    }
+
+                    if(l_i32Result == 0)
+                    {
+                        boost::this_thread::interruption_point();
+                        continue;
+                    }
+
+                    {
+                        boost::lock_guard<boost::mutex> l_oLock(m_oMutex);
+                        ++m_ui32FramesNb;
+                    }
+
+                    for(size_t ii = 0; ii < m_vLatestFrameOutputs.size(); ++ii)
+                    {
+                        m_vLatestFrameOutputs[ii]->push(l_oFrame);
+                    }
+
+                    for(size_t ii = 0; ii < m_vQueueOutputs.size(); ++ii)
+                    {
+                        m_vQueueOutputs[ii]->push(l_oFrame);
+                    }
+                }
+
+                {
+                    boost::lock_guard<boost::mutex> l_oLock(m_oMutex);
+                    m_bListening = false;
+                }
+
+                closeOutputs();
+            }
+
+            /**
+             * \brief Close the outputs, the next stages finish the frames already queued.
+             */
+            void closeOutputs()
+            {
+                for(size_t ii = 0; ii < m_vLatestFrameOutputs.size(); ++ii)
+                {
+                    m_vLatestFrameOutputs[ii]->close();
+                }
+
+                for(size_t ii = 0; ii < m_vQueueOutputs.size(); ++ii)
+                {
+                    m_vQueueOutputs[ii]->close();
+                }
+            }
+
+            /**
+             * \brief Store the error which stops the stage.
+             * \param [in] sMessage : error message
+             */
+            void setError(const std::string &sMessage)
+            {
+                boost::lock_guard<boost::mutex> l_oLock(m_oMutex);
+                m_bFailed       = true;
+                m_sErrorMessage = sMessage;
+            }
+
+        private :
+
+            WorkFunction m_fWork;                                       /**< work function of the stage */
+            unsigned int m_ui32FramesNb;                                /**< number of produced frames */
+            bool m_bFailed;                                             /**< has the work function thrown an exception ? */
+            std::string m_sErrorMessage;                                /**< message of the exception */
+
+            std::vector<SWLatestFrame<TFrame>*> m_vLatestFrameOutputs;  /**< latest frame outputs (displays) */
+            std::vector<SWFrameQueue<TFrame>*>  m_vQueueOutputs;        /**< queue outputs (recorders) */
+    };
+}
+
+#endif
@@ -44,6 +44,18 @@
 #include <iterator>
 #include <algorithm>
 #include <fstream>
+#include <cfloat>
+
+/**
+ * @brief A composed frame of the SWDimenco3DDisplay frames pool
+ */
+struct SWDimencoFrameBuffer
+{
+    cv::Mat frame;          /**< side-by-side, zero-line interleaved output frame */
+    cv::Size rgbSize;       /**< rgb size of the last composition */
+    cv::Size depthSize;     /**< depth size of the last composition */
+    cv::Rect fpsTextRect;   /**< area covered by the fps text of the last composition */
+};
 
 /**
  * @brief The SWDimenco3DDisplay class
@@ -91,12 +103,22 @@ class SWDimenco3DDisplay
 		int init(int msize);
 
         /**
-         * @brief refresh
+         * @brief refresh : compose the 3D frame and display it
          * @param rgbImg
          * @param depthImg
          */
 		void refresh(const cv::Mat& rgbImg, const cv::Mat& depthImg);
 
+        /**
+         * @brief compose the 3D frame (2D + depth side by side, zero lines and 3D header) without displaying it,
+         *        can be called from a processing thread, the frame must then be shown from the window thread
+         * @param rgbImg
+         * @param depthImg
+         * @return the composed frame (empty if the input images are bigger than the display), it is taken from a pool and not
+         *         overwritten while a copy of its header is kept : it can be published to another thread without being cloned
+         */
+		const cv::Mat &compose(const cv::Mat& rgbImg, const cv::Mat& depthImg);
+
         /**
          * @brief depth2disparity
          * @param depthImg
@@ -139,6 +161,37 @@ class SWDimenco3DDisplay
          * @param len
          */
 		void embedBlueBit7B(unsigned char *data, unsigned char *hd, int len);
+
+	private:
+
+        /**
+         * @brief disparity value of a depth, uses the display equation
+         * @param fDepth
+         * @return
+         */
+        int disparity(cfloat fDepth) const;
+
+        /**
+         * @brief build the disparity lookup table of the current display constants
+         */
+        void buildDisparityLUT();
+
+        /**
+         * @brief convert a row of depth values to a row of 3 channels disparity values
+         * @param aFDepth         : depth row
+         * @param aUi8Disparity   : output disparity row (3 bytes per pixel)
+         * @param i32Cols         : number of pixels
+         */
+        void depthRow2Disparity(const float *aFDepth, uchar *aUi8Disparity, cint i32Cols) const;
+
+        static const int m_i32DisparityBinsNb = 4096;   /**< number of bins of the disparity lookup table for depth values in [0,1] */
+
+        std::vector<float> m_vFDisparityThreshold;      /**< first depth of each bin with the after value (FLT_MAX if none, -1 to evaluate the equation) */
+        std::vector<uchar> m_vUi8DisparityBefore;       /**< disparity of each bin before the threshold */
+        std::vector<uchar> m_vUi8DisparityAfter;        /**< disparity of each bin after the threshold */
+
+        std::vector<SWDimencoFrameBuffer> m_vFramesPool;/**< persistent output frames, a frame is reused once it is not referenced outside the pool */
+        cv::Mat m_oEmptyFrame;                          /**< returned when the input images can't be displayed */
 };
 
 #endif
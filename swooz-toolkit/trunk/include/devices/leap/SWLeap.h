@@ -35,6 +35,7 @@
 
 
 #include <iostream>
+#include <vector>
 
 
 #include "commonTypes.h"
@@ -46,6 +47,34 @@
 //! namespace for devices interfaces
 namespace swDevice
 {
+    /**
+     * \brief Offsets of the values in SWLeapHandSnapshot::m_aFHand, in the order of the leap tracking bottles.
+     */
+    enum SWLeapHandValue
+    {
+        LEAP_ARM_DIRECTION      = 0,    /**< arm direction x,y,z */
+        LEAP_HAND_DIRECTION     = 3,    /**< hand direction x,y,z */
+        LEAP_HAND_DIRECTION_E   = 6,    /**< hand direction pitch,roll,yaw */
+        LEAP_PALM_COORD         = 9,    /**< hand palm coord x,y,z */
+        LEAP_PALM_NORMAL        = 12,   /**< hand palm normal x,y,z */
+        LEAP_PALM_NORMAL_E      = 15,   /**< hand palm normal pitch,roll,yaw */
+        LEAP_HAND_VALUES_NB     = 18    /**< number of hand values */
+    };
+
+    /**
+     * \struct SWLeapHandSnapshot
+     * \brief Fixed layout of one hand for one leap frame, filled once per SWLeap::grab.
+     *
+     * Bones are indexed with [Leap::Finger::Type][Leap::Bone::Type][x,y,z] (the leap thumb metacarpal has a null length).
+     * The values of an undetected hand or of an invalid bone are the ones of the last valid frame.
+     */
+    struct SWLeapHandSnapshot
+    {
+        float m_aFHand[LEAP_HAND_VALUES_NB];        /**< hand values, see SWLeapHandValue */
+        float m_aFBoneDirections[5][4][3];          /**< bones directions */
+        float m_aFBonePositions[5][4][3];           /**< bones centers */
+    };
+
     class SWLeap
     {
 
@@ -117,7 +146,7 @@ namespace swDevice
              * @param boneType
              * @param vBoneDirection
              */
-            void boneDirection(const bool bLeftHand, const Leap::Finger::Type fingerType, const Leap::Bone::Type boneType, std::vector<float> &vBoneDirection);
+            void boneDirection(const bool bLeftHand, const Leap::Finger::Type fingerType, const Leap::Bone::Type boneType, std::vector<float> &vBoneDirection) const;
 
             /**
              * @brief bonePosition
@@ -126,7 +155,14 @@ namespace swDevice
              * @param boneType
              * @param vBonePosition
              */
-            void bonePosition(const bool bLeftHand, const Leap::Finger::Type fingerType, const Leap::Bone::Type boneType, std::vector<float> &vBonePosition);
+            void bonePosition(const bool bLeftHand, const Leap::Finger::Type fingerType, const Leap::Bone::Type boneType, std::vector<float> &vBonePosition) const;
+
+            /**
+             * @brief hand
+             * @param bLeftHand
+             * @return the snapshot of the hand filled by the last grab
+             */
+            const SWLeapHandSnapshot &hand(cbool bLeftHand) const;
 
             /**
              * @brief fps
@@ -136,7 +172,19 @@ namespace swDevice
 
         private :
 
-            void toStdVector(std::vector<float> &oSTDVec, Leap::Vector &oVector);
+            /**
+             * @brief copy a leap vector if none of its components is null
+             * @param a3FDest
+             * @param oVector
+             */
+            void copyVector(float *a3FDest, const Leap::Vector &oVector) const;
+
+            /**
+             * @brief fill a hand snapshot with a leap hand
+             * @param oHand
+             * @param oSnapshot
+             */
+            void updateHand(const Leap::Hand &oHand, SWLeapHandSnapshot &oSnapshot) const;
 
             /**
              * @brief finger
@@ -160,49 +208,8 @@ namespace swDevice
 
             int m_fps;  /**< ... */
 
-            // left
-            //      arm
-            std::vector<float> m_vLeftDirectionArm;     /**< ... */
-            //      hand
-            std::vector<float> m_vLeftCoordPalmHand;    /**< ... */
-            std::vector<float> m_vLeftNormalPalmHand;   /**< ... */
-            std::vector<float> m_vLeftDirectionHand;    /**< ... */
-            std::vector<float> m_vLeftNormalPalmHandE;  /**< ... */
-            std::vector<float> m_vLeftDirectionHandE;   /**< ... */
-            //      hand fingers directions
-            std::vector<std::vector<float> > m_vLeftThumbDirections;    /**< ... */
-            std::vector<std::vector<float> > m_vLeftIndexDirections;    /**< ... */
-            std::vector<std::vector<float> > m_vLeftMiddleDirections;   /**< ... */
-            std::vector<std::vector<float> > m_vLeftRingDirections;     /**< ... */
-            std::vector<std::vector<float> > m_vLeftPinkyDirections;    /**< ... */
-
-            std::vector<std::vector<float> > m_vLeftThumbPositions; /**< ... */
-            std::vector<std::vector<float> > m_vLeftIndexPositions; /**< ... */
-            std::vector<std::vector<float> > m_vLeftMiddlePositions;/**< ... */
-            std::vector<std::vector<float> > m_vLeftRingPositions;  /**< ... */
-            std::vector<std::vector<float> > m_vLeftPinkyPositions; /**< ... */
-
-            // right
-            //      arm
-            std::vector<float> m_vRightDirectionArm;    /**< ... */
-            //      hand
-            std::vector<float> m_vRightCoordPalmHand;   /**< ... */
-            std::vector<float> m_vRightNormalPalmHand;  /**< ... */
-            std::vector<float> m_vRightDirectionHand;   /**< ... */
-            std::vector<float> m_vRightDirectionHandE;  /**< ... */
-            std::vector<float> m_vRightNormalPalmHandE; /**< ... */
-            //      hand fingers directions
-            std::vector<std::vector<float> > m_vRightThumbDirections;   /**< ... */
-            std::vector<std::vector<float> > m_vRightIndexDirections;   /**< ... */
-            std::vector<std::vector<float> > m_vRightMiddleDirections;  /**< ... */
-            std::vector<std::vector<float> > m_vRightRingDirections;    /**< ... */
-            std::vector<std::vector<float> > m_vRightPinkyDirections;   /**< ... */
-
-            std::vector<std::vector<float> > m_vRightThumbPositions; /**< ... */
-            std::vector<std::vector<float> > m_vRightIndexPositions; /**< ... */
-            std::vector<std::vector<float> > m_vRightMiddlePositions;/**< ... */
-            std::vector<std::vector<float> > m_vRightRingPositions;  /**< ... */
-            std::vector<std::vector<float> > m_vRightPinkyPositions; /**< ... */
+            SWLeapHandSnapshot m_oLeftHand;     /**< last left hand snapshot */
+            SWLeapHandSnapshot m_oRightHand;    /**< last right hand snapshot */
     };
 }
 
@@ -39,6 +39,7 @@
 #include "commonTypes.h"
 
 #include <iostream>
+#include <vector>
 
 namespace swDevice
 {
@@ -124,6 +125,14 @@ namespace swDevice
             int maxDepthValue ;
             cv::Mat normalizedDepthMap;
             void normalizeDepthImage(void);
+
+        private:
+
+            cv::Mat m_oRecalibratedBgrImage;        /**< buffer swapped with bgrImage by recalibrate, reused between the frames */
+
+            std::vector<float> m_vFDepthLUT;        /**< normalized value for each 16 bits depth value */
+            int m_i32LUTMinDepth;                   /**< minDepthValue used to build m_vFDepthLUT */
+            int m_i32LUTMaxDepth;                   /**< maxDepthValue used to build m_vFDepthLUT */
     };
 }
 
@@ -42,6 +42,9 @@
 #include <vector>
 #include <string>
 
+// SWOOZ
+#include "devices/rgbd/SWSkeletonFrame.h"
+
 
 namespace swDevice
 {
@@ -65,7 +68,7 @@ namespace swDevice
 
 		XnBool m_bNeedPose;
 		XnChar m_strPose[20];
-		static const int m_maxNumUsers = 15;
+		static const int m_maxNumUsers = SKELETON_MAX_USERS;
 
         bool m_verbose;
 		SkeletonProfile m_skeletonProfile;
@@ -139,6 +142,13 @@ namespace swDevice
 		 */
 		int grab(std::vector<SWKinectSkeleton::Coordinates> & values);
 
+		/*
+		 * /brief Grabs the skeleton data of all the tracked users without allocation. init and selectProfile must have been called
+		 * /param [out] oFrame : users joints in the order defined by the selected profile (the first SKELETON_MAX_JOINTS joints)
+		 * /return 0 if at least one user is tracked, else 1
+		 */
+		int grab(SWSkeletonFrame &oFrame);
+
 	};
 }
 
@@ -113,6 +113,13 @@ namespace swDevice
 			 */		
 			cv::Mat grayImage();
 		
+			/**
+			 * \brief Id of the last grabbed frame, incremented at each grab.
+			 *        Read it before the images : a frame read twice then keeps the same id.
+			 * \return the frame id
+			 */
+			uint frameId();
+
 			/**
 			 * \brief Indicates if kinect data is available.
 			 * \return true if data available, else return false.
@@ -155,6 +162,7 @@ namespace swDevice
 		
 			bool m_bInitialized;	/**< is the module initialized ? */
 			bool m_bDataAvailable;	/**< is the data available ? */
+			uint m_ui32FrameId;		/**< id of the last grabbed frame */
 		
 			SWKinect m_oKinect; 	/**< kinect module */
 	};
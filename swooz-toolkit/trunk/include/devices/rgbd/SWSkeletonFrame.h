@@ -0,0 +1,157 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWSkeletonFrame.h
+ * \brief Defines SWSkeletonFrame and the batched upper body joint angles solver
+ *
+ *  Does not depend on OpenNI : the teleoperation modules use it to decode the OpenNI tracking bottles.
+ */
+
+#ifndef _SWSKELETONFRAME_
+#define _SWSKELETONFRAME_
+
+#include "kinematicsUtility.h"
+
+namespace swDevice
+{
+    const int SKELETON_MAX_USERS  = 15; /**< maximum number of users tracked at the same time */
+    const int SKELETON_MAX_JOINTS = 24; /**< maximum number of joints of a profile (all the OpenNI joints) */
+
+    /**
+     * Joints of the SWKinectSkeleton::UpperBody profile, in the profile order.
+     */
+    enum SWUpperBodyJoint
+    {
+        UB_TORSO, UB_NECK, UB_HEAD, UB_LEFT_SHOULDER, UB_RIGHT_SHOULDER, UB_LEFT_ELBOW, UB_RIGHT_ELBOW, UB_LEFT_HAND, UB_RIGHT_HAND,
+        UB_JOINTS_NB
+    };
+
+    /**
+     * Joints sent on each OpenNI tracking port (x, y, z values after the device lib id), shared by the tracker and the teleoperation modules.
+     */
+    const int OPENNI_HEAD_JOINTS_NB      = 4;
+    const int OPENNI_TORSO_JOINTS_NB     = 4;
+    const int OPENNI_ARM_JOINTS_NB       = 5;
+    static const int OPENNI_HEAD_JOINTS[OPENNI_HEAD_JOINTS_NB]          = {UB_NECK,  UB_HEAD, UB_LEFT_SHOULDER,  UB_RIGHT_SHOULDER};
+    static const int OPENNI_TORSO_JOINTS[OPENNI_TORSO_JOINTS_NB]        = {UB_TORSO, UB_NECK, UB_LEFT_SHOULDER,  UB_RIGHT_SHOULDER};
+    static const int OPENNI_LEFT_ARM_JOINTS[OPENNI_ARM_JOINTS_NB]       = {UB_TORSO, UB_NECK, UB_LEFT_SHOULDER,  UB_LEFT_ELBOW,  UB_LEFT_HAND};
+    static const int OPENNI_RIGHT_ARM_JOINTS[OPENNI_ARM_JOINTS_NB]      = {UB_TORSO, UB_NECK, UB_RIGHT_SHOULDER, UB_RIGHT_ELBOW, UB_RIGHT_HAND};
+
+    /**
+     * \struct SWSkeletonUser
+     * \brief Joints of a tracked user.
+     */
+    struct SWSkeletonUser
+    {
+        int m_i32Id;                                        /**< OpenNI user id */
+        swUtil::SWVec3d m_aJoints[SKELETON_MAX_JOINTS];     /**< joints positions in the selected profile order */
+        float m_aFConfidence[SKELETON_MAX_JOINTS];          /**< joints positions confidences */
+    };
+
+    /**
+     * \struct SWSkeletonFrame
+     * \brief Preallocated skeleton data of all the tracked users, filled by SWKinectSkeleton::grab without any allocation.
+     */
+    struct SWSkeletonFrame
+    {
+        SWSkeletonFrame() : m_i32UsersNb(0), m_i32JointsNb(0)
+        {}
+
+        int m_i32UsersNb;                                   /**< number of tracked users in the frame */
+        int m_i32JointsNb;                                  /**< number of joints of each user (size of the selected profile) */
+        SWSkeletonUser m_aUsers[SKELETON_MAX_USERS];        /**< tracked users, only the m_i32UsersNb first ones are valid */
+    };
+
+    /**
+     * Limbs whose roll-pitch-yaw angles are computed by computeUpperBodyAngles.
+     */
+    enum SWUpperBodyLimb
+    {
+        LIMB_HEAD,              /**< neck->head        around the clavicles */
+        LIMB_TORSO,             /**< torso->neck       around the clavicles */
+        LIMB_LEFT_SHOULDER,     /**< shoulder->elbow   around torso->neck */
+        LIMB_LEFT_ELBOW,        /**< elbow->hand       around shoulder->elbow */
+        LIMB_RIGHT_SHOULDER,    /**< shoulder->elbow   around torso->neck */
+        LIMB_RIGHT_ELBOW,       /**< elbow->hand       around shoulder->elbow */
+        LIMBS_NB
+    };
+
+    /**
+     * \struct SWUpperBodyAngles
+     * \brief Roll-pitch-yaw angles in degrees of the upper body limbs.
+     */
+    struct SWUpperBodyAngles
+    {
+        double m_a3DRollPitchYaw[LIMBS_NB][3];  /**< roll, pitch, yaw of each limb */
+    };
+
+    /**
+     * \brief Compute the angles of all the upper body limbs in one pass, each limb vector is computed once
+     *        (same results than swUtil::computeRollPitchYaw on each limb).
+     * \param [in]  aJoints : joints in the SWUpperBodyJoint order
+     * \param [out] oAngles : limbs angles
+     */
+    inline void computeUpperBodyAngles(const swUtil::SWVec3d *aJoints, SWUpperBodyAngles &oAngles)
+    {
+        swUtil::SWVec3d l_vecClavicles  = swUtil::vec3(aJoints[UB_LEFT_SHOULDER],  aJoints[UB_RIGHT_SHOULDER]);
+        swUtil::SWVec3d l_vecHead       = swUtil::vec3(aJoints[UB_NECK],           aJoints[UB_HEAD]);
+        swUtil::SWVec3d l_vecTorso      = swUtil::vec3(aJoints[UB_TORSO],          aJoints[UB_NECK]);
+        swUtil::SWVec3d l_vecLArm       = swUtil::vec3(aJoints[UB_LEFT_SHOULDER],  aJoints[UB_LEFT_ELBOW]);
+        swUtil::SWVec3d l_vecLForearm   = swUtil::vec3(aJoints[UB_LEFT_ELBOW],     aJoints[UB_LEFT_HAND]);
+        swUtil::SWVec3d l_vecRArm       = swUtil::vec3(aJoints[UB_RIGHT_SHOULDER], aJoints[UB_RIGHT_ELBOW]);
+        swUtil::SWVec3d l_vecRForearm   = swUtil::vec3(aJoints[UB_RIGHT_ELBOW],    aJoints[UB_RIGHT_HAND]);
+
+        swUtil::computeRollPitchYaw3(l_vecHead,     l_vecClavicles, oAngles.m_a3DRollPitchYaw[LIMB_HEAD]);
+        swUtil::computeRollPitchYaw3(l_vecTorso,    l_vecClavicles, oAngles.m_a3DRollPitchYaw[LIMB_TORSO]);
+        swUtil::computeRollPitchYaw3(l_vecLArm,     l_vecTorso,     oAngles.m_a3DRollPitchYaw[LIMB_LEFT_SHOULDER]);
+        swUtil::computeRollPitchYaw3(l_vecLForearm, l_vecLArm,      oAngles.m_a3DRollPitchYaw[LIMB_LEFT_ELBOW]);
+        swUtil::computeRollPitchYaw3(l_vecRArm,     l_vecTorso,     oAngles.m_a3DRollPitchYaw[LIMB_RIGHT_SHOULDER]);
+        swUtil::computeRollPitchYaw3(l_vecRForearm, l_vecRArm,      oAngles.m_a3DRollPitchYaw[LIMB_RIGHT_ELBOW]);
+    }
+
+    /**
+     * \brief Compute the upper body angles of all the users of a frame grabbed with the SWKinectSkeleton::UpperBody profile.
+     * \param [in]  oFrame  : skeleton frame
+     * \param [out] aAngles : angles of each user, in the frame users order
+     * \return the number of users
+     */
+    inline int computeUpperBodyAngles(const SWSkeletonFrame &oFrame, SWUpperBodyAngles aAngles[SKELETON_MAX_USERS])
+    {
+        if(oFrame.m_i32JointsNb < UB_JOINTS_NB)
+        {
+            return 0;
+        }
+
+        for(int ii = 0; ii < oFrame.m_i32UsersNb; ++ii)
+        {
+            computeUpperBodyAngles(oFrame.m_aUsers[ii].m_aJoints, aAngles[ii]);
+        }
+
+        return oFrame.m_i32UsersNb;
+    }
+}
+
+#endif
@@ -0,0 +1,336 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file filterUtility.h
+ * \brief low-latency filters for the teleoperation targets and the head motion : One-Euro and alpha-beta predictor
+ */
+
+#ifndef _SWFILTERUTILITY_
+#define _SWFILTERUTILITY_
+
+#include <vector>
+#include <cmath>
+
+#include "commonTypes.h"
+
+//! SWoOz utility functions namespace
+namespace swUtil
+{
+    /**
+     * \brief Filters available for a signal.
+     */
+    enum SWFilterType
+    {
+        NO_FILTER           = 0,    /**< values are sent untouched */
+        ONE_EURO_FILTER     = 1,    /**< speed-adaptive low-pass filter */
+        ALPHA_BETA_FILTER   = 2     /**< constant-velocity predictor */
+    };
+
+    /**
+     * \struct SWFilterParams
+     * \brief Parameters of a signal filter, the default values keep the signal untouched.
+     */
+    struct SWFilterParams
+    {
+        SWFilterParams() : m_eType(NO_FILTER), m_dOneEuroMinCutoff(1.0), m_dOneEuroSpeedCoeff(0.007), m_dOneEuroDerivateCutoff(1.0),
+            m_dAlpha(0.5), m_dBeta(0.1), m_dLookAhead(0.0)
+        {}
+
+        SWFilterType m_eType;           /**< filter to use */
+        double m_dOneEuroMinCutoff;     /**< One-Euro : cutoff frequency (Hz) of the signal at rest */
+        double m_dOneEuroSpeedCoeff;    /**< One-Euro : increase of the cutoff frequency with the speed of the signal */
+        double m_dOneEuroDerivateCutoff;/**< One-Euro : cutoff frequency (Hz) of the speed estimation */
+        double m_dAlpha;                /**< alpha-beta : position correction gain, in ]0, 1] */
+        double m_dBeta;                 /**< alpha-beta : velocity correction gain, in [0, 2[ */
+        double m_dLookAhead;            /**< prediction horizon (s) added to the output with the estimated speed, compensates the robot latency */
+    };
+
+    /**
+     * \class SWOneEuroFilter
+     * \brief One-Euro filter of a scalar signal : a low-pass filter whose cutoff frequency rises with the speed,
+     *        low jitter at rest and low lag during fast movements.
+     */
+    class SWOneEuroFilter
+    {
+        public :
+
+            SWOneEuroFilter() : m_bInit(false), m_dLastTime(0.0), m_dLastValue(0.0), m_dValue(0.0), m_dDerivate(0.0)
+            {}
+
+            /**
+             * \brief Reset the filter, the next value will be sent untouched.
+             * \param [in] oParams : filter parameters
+             */
+            void reset(const SWFilterParams &oParams)
+            {
+                m_oParams = oParams;
+                m_bInit   = false;
+            }
+
+            /**
+             * \brief Filter a new value of the signal.
+             * \param [in] dValue : raw value
+             * \param [in] dTime  : acquisition time (s) of the value
+             * \return the filtered value, extrapolated of the look-ahead duration
+             */
+            double filter(cdouble dValue, cdouble dTime)
+            {
+                double l_dDt = dTime - m_dLastTime;
+
+                if(!m_bInit || l_dDt <= 0.0)
+                {
+                    if(!m_bInit)
+                    {
+                        m_dValue     = dValue;
+                        m_dLastValue = dValue;
+                        m_dDerivate  = 0.0;
+                        m_dLastTime  = dTime;
+                        m_bInit      = true;
+                    }
+
+                    return m_dValue + m_dDerivate * m_oParams.m_dLookAhead;
+                }
+
+                m_dLastTime = dTime;
+
+                // the speed is estimated on the raw signal, so it can also be used for the look-ahead
+                double l_dDerivate = (dValue - m_dLastValue) / l_dDt;
+                m_dLastValue = dValue;
+                m_dDerivate += smoothingFactor(l_dDt, m_oParams.m_dOneEuroDerivateCutoff) * (l_dDerivate - m_dDerivate);
+
+                double l_dCutoff = m_oParams.m_dOneEuroMinCutoff + m_oParams.m_dOneEuroSpeedCoeff * fabs(m_dDerivate);
+                m_dValue += smoothingFactor(l_dDt, l_dCutoff) * (dValue - m_dValue);
+
+                return m_dValue + m_dDerivate * m_oParams.m_dLookAhead;
+            }
+
+        private :
+
+            /**
+             * \brief Smoothing factor of an exponential filter for a sampling period and a cutoff frequency.
+             */
+            static double smoothingFactor(cdouble dDt, cdouble dCutoff)
+            {
+                double l_dTau = 1.0 / (2.0 * 3.14159265358979323846 * dCutoff);
+                return 1.0 / (1.0 + l_dTau / dDt);
+            }
+
+            SWFilterParams m_oParams;   /**< filter parameters */
+            bool m_bInit;               /**< has the filter received a value */
+            double m_dLastTime;         /**< time of the last value */
+            double m_dLastValue;        /**< last raw value */
+            double m_dValue;            /**< filtered value */
+            double m_dDerivate;         /**< filtered speed */
+    };
+
+    /**
+     * \class SWAlphaBetaFilter
+     * \brief Alpha-beta filter of a scalar signal : constant-velocity model corrected by each measure,
+     *        the steady-state form of a Kalman filter with a constant-velocity model.
+     */
+    class SWAlphaBetaFilter
+    {
+        public :
+
+            SWAlphaBetaFilter() : m_bInit(false), m_dLastTime(0.0), m_dValue(0.0), m_dVelocity(0.0)
+            {}
+
+            /**
+             * \brief Reset the filter, the next value will be sent untouched.
+             * \param [in] oParams : filter parameters
+             */
+            void reset(const SWFilterParams &oParams)
+            {
+                m_oParams = oParams;
+                m_bInit   = false;
+            }
+
+            /**
+             * \brief Filter a new value of the signal.
+             * \param [in] dValue : raw value
+             * \param [in] dTime  : acquisition time (s) of the value
+             * \return the estimated value, extrapolated of the look-ahead duration
+             */
+            double filter(cdouble dValue, cdouble dTime)
+            {
+                double l_dDt = dTime - m_dLastTime;
+
+                if(!m_bInit || l_dDt <= 0.0)
+                {
+                    if(!m_bInit)
+                    {
+                        m_dValue    = dValue;
+                        m_dVelocity = 0.0;
+                        m_dLastTime = dTime;
+                        m_bInit     = true;
+                    }
+
+                    return m_dValue + m_dVelocity * m_oParams.m_dLookAhead;
+                }
+
+                m_dLastTime = dTime;
+
+                // predict with the constant-velocity model, then correct with the residual
+                double l_dPrediction = m_dValue + m_dVelocity * l_dDt;
+                double l_dResidual   = dValue - l_dPrediction;
+
+                m_dValue    = l_dPrediction + m_oParams.m_dAlpha * l_dResidual;
+                m_dVelocity = m_dVelocity   + (m_oParams.m_dBeta / l_dDt) * l_dResidual;
+
+                return m_dValue + m_dVelocity * m_oParams.m_dLookAhead;
+            }
+
+        private :
+
+            SWFilterParams m_oParams;   /**< filter parameters */
+            bool m_bInit;               /**< has the filter received a value */
+            double m_dLastTime;         /**< time of the last value */
+            double m_dValue;            /**< estimated value */
+            double m_dVelocity;         /**< estimated speed */
+    };
+
+    /**
+     * \class SWSignalFilter
+     * \brief Filter of a multichannel signal, each channel is filtered independently with the same parameters.
+     */
+    class SWSignalFilter
+    {
+        public :
+
+            SWSignalFilter()
+            {}
+
+            /**
+             * \brief Reset the filter.
+             * \param [in] i32ChannelsNb : number of channels of the signal
+             * \param [in] oParams       : filter parameters
+             */
+            void reset(cint i32ChannelsNb, const SWFilterParams &oParams)
+            {
+                m_oParams = oParams;
+                m_vOneEuro    = std::vector<SWOneEuroFilter>(i32ChannelsNb);
+                m_vAlphaBeta  = std::vector<SWAlphaBetaFilter>(i32ChannelsNb);
+
+                for(int ii = 0; ii < i32ChannelsNb; ++ii)
+                {
+                    m_vOneEuro[ii].reset(oParams);
+                    m_vAlphaBeta[ii].reset(oParams);
+                }
+            }
+
+            /**
+             * \brief Reset the filters states, the next values will be sent untouched.
+             */
+            void reset()
+            {
+                reset(static_cast<int>(m_vOneEuro.size()), m_oParams);
+            }
+
+            /**
+             * \brief Return true if the values are modified by the filter.
+             */
+            bool isEnabled() const
+            {
+                return m_oParams.m_eType != NO_FILTER && m_vOneEuro.size() > 0;
+            }
+
+            /**
+             * \brief Return the filter parameters.
+             */
+            const SWFilterParams &params() const
+            {
+                return m_oParams;
+            }
+
+            /**
+             * \brief Filter a new value of a channel.
+             * \param [in] i32Channel : channel id, the value is sent untouched if out of range
+             * \param [in] dValue     : raw value
+             * \param [in] dTime      : acquisition time (s) of the value
+             * \return the filtered value
+             */
+            double filter(cint i32Channel, cdouble dValue, cdouble dTime)
+            {
+                if(i32Channel < 0 || i32Channel >= static_cast<int>(m_vOneEuro.size()))
+                {
+                    return dValue;
+                }
+
+                switch(m_oParams.m_eType)
+                {
+                    case ONE_EURO_FILTER :
+                        return m_vOneEuro[i32Channel].filter(dValue, dTime);
+                    case ALPHA_BETA_FILTER :
+                        return m_vAlphaBeta[i32Channel].filter(dValue, dTime);
+                    default :
+                        return dValue;
+                }
+            }
+
+            /**
+             * \brief Filter in place the first channels of the signal.
+             * \param [in,out] aDValues      : values to filter
+             * \param [in]     i32ValuesNb   : number of values
+             * \param [in]     dTime         : acquisition time (s) of the values
+             */
+            void filter(double *aDValues, cint i32ValuesNb, cdouble dTime)
+            {
+                if(!isEnabled())
+                {
+                    return;
+                }
+
+                for(int ii = 0; ii < i32ValuesNb; ++ii)
+                {
+                    aDValues[ii] = filter(ii, aDValues[ii], dTime);
+                }
+            }
+
+            /**
+             * \brief Filter the first channels of the signal into a separate buffer, the input values are left untouched.
+             *        The values are copied when the filter is disabled.
+             * \param [in]  aDValues      : raw values to filter
+             * \param [out] aDFiltered    : filtered values
+             * \param [in]  i32ValuesNb   : number of values
+             * \param [in]  dTime         : acquisition time (s) of the values
+             */
+            void filter(const double *aDValues, double *aDFiltered, cint i32ValuesNb, cdouble dTime)
+            {
+                for(int ii = 0; ii < i32ValuesNb; ++ii)
+                {
+                    aDFiltered[ii] = isEnabled() ? filter(ii, aDValues[ii], dTime) : aDValues[ii];
+                }
+            }
+
+        private :
+
+            SWFilterParams m_oParams;                   /**< filter parameters */
+            std::vector<SWOneEuroFilter> m_vOneEuro;    /**< One-Euro filters of the channels */
+            std::vector<SWAlphaBetaFilter> m_vAlphaBeta;/**< alpha-beta filters of the channels */
+    };
+}
+
+#endif
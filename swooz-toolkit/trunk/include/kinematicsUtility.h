@@ -0,0 +1,187 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file kinematicsUtility.h
+ * \brief stack-only kinematics functions on fixed 3D vectors and 3x3 rotations
+ */
+
+#ifndef _SWKINEMATICSUTILITY_
+#define _SWKINEMATICSUTILITY_
+
+#include "commonTypes.h"
+#include "geometryUtility.h"
+
+//! SWoOz utility functions namespace
+namespace swUtil
+{
+    /**
+     * \struct SWVec3d
+     * \brief A fixed 3D vector of doubles, never allocated on the heap.
+     */
+    struct SWVec3d
+    {
+        double m_a3D[3];    /**< x, y, z values */
+
+        double &operator[](cint i32Index)       { return m_a3D[i32Index]; }
+        double  operator[](cint i32Index) const { return m_a3D[i32Index]; }
+    };
+
+    /**
+     * \struct SWRot3d
+     * \brief A fixed 3x3 row-major matrix of doubles, never allocated on the heap.
+     */
+    struct SWRot3d
+    {
+        double m_a9D[9];    /**< row-major values */
+
+        double &operator()(cint i32Row, cint i32Col)       { return m_a9D[i32Row * 3 + i32Col]; }
+        double  operator()(cint i32Row, cint i32Col) const { return m_a9D[i32Row * 3 + i32Col]; }
+    };
+
+    /**
+     * \brief Build a 3D vector.
+     */
+    inline SWVec3d vec3(cdouble dX, cdouble dY, cdouble dZ)
+    {
+        SWVec3d l_v = {{dX, dY, dZ}};
+        return l_v;
+    }
+
+    /**
+     * \brief Vector from v1 to v2 (same convention than swUtil::vec).
+     */
+    inline SWVec3d vec3(const SWVec3d &v1, const SWVec3d &v2)
+    {
+        return vec3(v2[0] - v1[0], v2[1] - v1[1], v2[2] - v1[2]);
+    }
+
+    inline double dot3(const SWVec3d &v1, const SWVec3d &v2)
+    {
+        return v1[0] * v2[0] + v1[1] * v2[1] + v1[2] * v2[2];
+    }
+
+    inline SWVec3d cross3(const SWVec3d &v1, const SWVec3d &v2)
+    {
+        return vec3(v1[1] * v2[2] - v1[2] * v2[1],
+                    v1[2] * v2[0] - v1[0] * v2[2],
+                    v1[0] * v2[1] - v1[1] * v2[0]);
+    }
+
+    inline double norm3(const SWVec3d &v)
+    {
+        return sqrt(dot3(v, v));
+    }
+
+    /**
+     * \brief Return the normalized vector, a null vector stays null (same behaviour than cv::normalize).
+     */
+    inline SWVec3d normalize3(const SWVec3d &v)
+    {
+        double l_dNorm  = norm3(v);
+        double l_dScale = l_dNorm ? 1.0 / l_dNorm : 0.0;
+
+        return vec3(v[0] * l_dScale, v[1] * l_dScale, v[2] * l_dScale);
+    }
+
+    /**
+     * \brief Apply a rotation to a vector.
+     */
+    inline SWVec3d mul3(const SWRot3d &oRot, const SWVec3d &v)
+    {
+        return vec3(oRot(0,0) * v[0] + oRot(0,1) * v[1] + oRot(0,2) * v[2],
+                    oRot(1,0) * v[0] + oRot(1,1) * v[1] + oRot(1,2) * v[2],
+                    oRot(2,0) * v[0] + oRot(2,1) * v[1] + oRot(2,2) * v[2]);
+    }
+
+    /**
+     * \brief Compute the rotation aligning oU on oV, same result than the cv::Mat version of swUtil::rodriguesRotation.
+     * \param [in]  oU   : vector to rotate
+     * \param [in]  oV   : target vector
+     * \param [out] oRot : rotation matrix, values in ]-1e-5, 1e-5[ are set to 0
+     */
+    inline void rodriguesRotation3(const SWVec3d &oU, const SWVec3d &oV, SWRot3d &oRot)
+    {
+        SWVec3d u = normalize3(oU);
+        SWVec3d v = normalize3(oV);
+
+        SWVec3d uXv     = cross3(u, v);
+        double cosTheta = dot3(u, v);
+        double sinTheta = norm3(uXv);
+        double l_dInvSin = 1.0 / sinTheta;
+
+        SWVec3d a = vec3(uXv[0] * l_dInvSin, uXv[1] * l_dInvSin, uXv[2] * l_dInvSin);
+
+        // cos * I + (1 - cos) * a.a^t + sin * [a]x
+        for(int ii = 0; ii < 3; ++ii)
+        {
+            for(int jj = 0; jj < 3; ++jj)
+            {
+                oRot(ii,jj) = (ii == jj ? cosTheta : 0.0) + a[ii] * a[jj] * (1.0 - cosTheta);
+            }
+        }
+
+        oRot(0,1) -= a[2] * sinTheta; oRot(0,2) += a[1] * sinTheta;
+        oRot(1,0) += a[2] * sinTheta; oRot(1,2) -= a[0] * sinTheta;
+        oRot(2,0) -= a[1] * sinTheta; oRot(2,1) += a[0] * sinTheta;
+
+        for(int ii = 0; ii < 9; ++ii)
+        {
+            if(oRot.m_a9D[ii] < 0.00001 && oRot.m_a9D[ii] > -0.00001)
+            {
+                oRot.m_a9D[ii] = 0.0;
+            }
+        }
+    }
+
+    /**
+     * \brief Angle in degrees between two vectors (same result than swUtil::vectorAngle).
+     */
+    inline double vectorAngle3(const SWVec3d &v1, const SWVec3d &v2)
+    {
+        return acos(dot3(v1,v2)/(norm3(v1)*norm3(v2))) * 180.0 / PI;
+    }
+
+    /**
+     * \brief Calculates roll-pitch-yaw angles in degrees between two vectors (same result than swUtil::computeRollPitchYaw).
+     * \param [in]  vecAxis     : ...
+     * \param [in]  vecRotation : ...
+     * \param [out] a3DRollPitchYaw : roll, pitch, yaw
+     */
+    inline void computeRollPitchYaw3(const SWVec3d &vecAxis, const SWVec3d &vecRotation, double a3DRollPitchYaw[3])
+    {
+        const SWVec3d vecUp   = vec3(0., 1., 0.);
+        const SWVec3d vecLeft = vec3(1., 0., 0.);
+
+        SWVec3d vecAxisX = vecAxis; vecAxisX[0] = 0.;
+        SWVec3d vecAxisZ = vecAxis; vecAxisZ[2] = 0.;
+
+        a3DRollPitchYaw[1] = (vecAxisX[2]>=0?-1:1)    * vectorAngle3(vecAxisX, vecUp);
+        a3DRollPitchYaw[0] = (vecAxisZ[0]>=0?-1:1)    * vectorAngle3(vecAxisZ, vecUp);
+        a3DRollPitchYaw[2] = (vecRotation[1]>=0?1:-1) * vectorAngle3(vecRotation, vecLeft);
+    }
+}
+
+#endif
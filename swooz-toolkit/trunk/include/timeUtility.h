@@ -0,0 +1,50 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file timeUtility.h
+ * \brief Wall time measurement helpers used for the timings reports.
+ */
+
+#ifndef _SWTIMEUTILITY_
+#define _SWTIMEUTILITY_
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+//! SWoOz utility functions namespace
+namespace swUtil
+{
+    /**
+     * \brief Return the elapsed time in ms since the input time
+     * \param [in] oStartTime : time obtained with boost::posix_time::microsec_clock::local_time()
+     * \return elapsed time in ms
+     */
+    inline double elapsedMs(const boost::posix_time::ptime &oStartTime)
+    {
+        return (boost::posix_time::microsec_clock::local_time() - oStartTime).total_microseconds() * 0.001;
+    }
+}
+
+#endif
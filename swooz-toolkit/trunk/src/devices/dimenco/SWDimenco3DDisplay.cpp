@@ -27,6 +27,9 @@
 #include "devices/dimenco/SWDimenco3DDisplay.h"
 
 #include "devices/rgbd/SWKinect.h"
+#include "devices/SWFramePipeline.h"
+
+#include <cstring>
 
 	
 SWDimenco3DDisplay::~SWDimenco3DDisplay(void)
@@ -82,6 +85,10 @@ int SWDimenco3DDisplay::init(int msize) //the buffer
 			C  = 127.5;
 		}
 	}
+
+	// builds the disparity lookup table and releases the previous output frames
+	buildDisparityLUT();
+	m_vFramesPool.clear();
 	
 	// creates a full screen cv window
 	cv::namedWindow("dimenco3D", CV_WINDOW_NORMAL);
@@ -95,41 +102,198 @@ int SWDimenco3DDisplay::init(int msize) //the buffer
 
 
 
+int SWDimenco3DDisplay::disparity(cfloat fDepth) const
+{
+	double l_dDepth = fDepth;
+	return static_cast<int>(floor(M*(1 - vz/(l_dDepth - Zd + vz))+C));
+}
+
+void SWDimenco3DDisplay::buildDisparityLUT()
+{
+	// D(Z) is monotonic over [0,1] and its slope is well below one disparity step per bin,
+	// so each bin holds at most one step : the first depth of the step is searched once here
+	// by bisection on the float representation, then a depth is converted with one comparison
+	// and gives exactly the value of the equation
+	m_vFDisparityThreshold.resize(m_i32DisparityBinsNb + 1);
+	m_vUi8DisparityBefore.resize(m_i32DisparityBinsNb + 1);
+	m_vUi8DisparityAfter.resize(m_i32DisparityBinsNb + 1);
+
+	for(int l_i32Bin = 0; l_i32Bin <= m_i32DisparityBinsNb; ++l_i32Bin)
+	{
+		// positive floats are ordered as their bit patterns : the last depth of the bin precedes the first depth of the next one
+		float l_fFirst = static_cast<float>(l_i32Bin) / m_i32DisparityBinsNb;
+		float l_fLast  = l_fFirst;
+		if(l_i32Bin < m_i32DisparityBinsNb)
+		{
+			float l_fNext = static_cast<float>(l_i32Bin + 1) / m_i32DisparityBinsNb;
+			int l_i32Next;
+			memcpy(&l_i32Next, &l_fNext, sizeof(float));
+			--l_i32Next;
+			memcpy(&l_fLast, &l_i32Next, sizeof(float));
+		}
+
+		int l_i32Before = disparity(l_fFirst);
+		int l_i32After  = disparity(l_fLast);
+
+		m_vUi8DisparityBefore[l_i32Bin] = static_cast<uchar>(l_i32Before);
+		m_vUi8DisparityAfter[l_i32Bin]  = static_cast<uchar>(l_i32After);
+
+		if(l_i32Before == l_i32After)
+		{
+			m_vFDisparityThreshold[l_i32Bin] = FLT_MAX;
+			continue;
+		}
+
+		int l_i32Low, l_i32High;
+		memcpy(&l_i32Low,  &l_fFirst, sizeof(float));
+		memcpy(&l_i32High, &l_fLast,  sizeof(float));
+
+		while(l_i32High - l_i32Low > 1)
+		{
+			int l_i32Mid = l_i32Low + (l_i32High - l_i32Low) / 2;
+			float l_fMid;
+			memcpy(&l_fMid, &l_i32Mid, sizeof(float));
+
+			if(disparity(l_fMid) == l_i32Before)
+			{
+				l_i32Low = l_i32Mid;
+			}
+			else
+			{
+				l_i32High = l_i32Mid;
+			}
+		}
+
+		float l_fThreshold;
+		memcpy(&l_fThreshold, &l_i32High, sizeof(float));
+
+		// more than one step in the bin, the equation will be evaluated for each depth
+		if(disparity(l_fThreshold) != l_i32After)
+		{
+			l_fThreshold = -1.f;
+		}
+
+		m_vFDisparityThreshold[l_i32Bin] = l_fThreshold;
+	}
+}
+
+void SWDimenco3DDisplay::depthRow2Disparity(const float *aFDepth, uchar *aUi8Disparity, cint i32Cols) const
+{
+	const float *l_aFThreshold = &m_vFDisparityThreshold[0];
+	const uchar *l_aUi8Before  = &m_vUi8DisparityBefore[0];
+	const uchar *l_aUi8After   = &m_vUi8DisparityAfter[0];
+
+	for(int l_col = 0; l_col < i32Cols; ++l_col, aUi8Disparity += 3)
+	{
+		float l_fDepth = aFDepth[l_col];
+		uchar l_ui8Disparity;
+
+		if(l_fDepth >= 0.f && l_fDepth <= 1.f)
+		{
+			int l_i32Bin = static_cast<int>(l_fDepth * m_i32DisparityBinsNb);
+			float l_fThreshold = l_aFThreshold[l_i32Bin];
+
+			if(l_fThreshold < 0.f)
+			{
+				l_ui8Disparity = static_cast<uchar>(disparity(l_fDepth));
+			}
+			else
+			{
+				l_ui8Disparity = (l_fDepth < l_fThreshold) ? l_aUi8Before[l_i32Bin] : l_aUi8After[l_i32Bin];
+			}
+		}
+		else // out of the normalized range (or NaN)
+		{
+			l_ui8Disparity = static_cast<uchar>(disparity(l_fDepth));
+		}
+
+		aUi8Disparity[0] = l_ui8Disparity;
+		aUi8Disparity[1] = l_ui8Disparity;
+		aUi8Disparity[2] = l_ui8Disparity;
+	}
+}
+
 void SWDimenco3DDisplay::refresh(const cv::Mat& rgbImg, const cv::Mat& depthImg)
+{
+	const cv::Mat &l_oFrame = compose(rgbImg, depthImg);
+
+	if(!l_oFrame.empty())
+	{
+		cv::imshow("dimenco3D", l_oFrame);
+	}
+}
+
+const cv::Mat &SWDimenco3DDisplay::compose(const cv::Mat& rgbImg, const cv::Mat& depthImg)
 {
 	// retrieves information on RGB original image
 	//cvtColor(rgbImg, m_rgbImg, CV_BGR2RGB );
 	m_rgbImg = rgbImg;
 	originalRGBImgWidth = rgbImg.cols;
 	originalRGBImgHeight= rgbImg.rows;
-		
-	// creates a padded RGB image
-	cv::Mat paddedRGBImg( cv::Size(displayImgWidth, displayImgHeight), CV_8UC3, cv::Scalar::all(0) );
-	padImageBorder( rgbImg, paddedRGBImg );
-	//~ cv::imshow("zero",paddedRGBImg );
+
 	// retrieves information on Depth image
 	m_depthImg = depthImg;
 	originalDepthImgWidth = depthImg.cols;
 	originalDepthImgHeight= depthImg.rows;
-		
-	// converts the depth image into a disparity image
-	cv::Mat disparityImg(cv::Size(originalDepthImgWidth, originalDepthImgHeight), CV_8UC3, cv::Scalar::all(0));
-	depth2disparity(depthImg, disparityImg);
-	
-	// creates a padded Disparity Image
-	cv::Mat paddedDisparityImg( cv::Size(displayImgWidth, displayImgHeight), CV_8UC3, cv::Scalar::all(0) );
-	padImageBorder( disparityImg, paddedDisparityImg );
 
-	// concats the RGB and Disparity images
-	cv::Mat rgbdImg( cv::Size( paddedRGBImg.cols+paddedDisparityImg.cols, paddedRGBImg.rows ), CV_8UC3 );
-	concatRGBDImages( paddedRGBImg, paddedDisparityImg, rgbdImg );
+	if(rgbImg.cols > displayImgWidth || rgbImg.rows > displayImgHeight || depthImg.cols > displayImgWidth || depthImg.rows > displayImgHeight)
+	{
+		std::cerr << "-ERROR : SWDimenco3DDisplay::compose -> input images are bigger than the display. " << std::endl;
+		return m_oEmptyFrame;
+	}
+
+	// takes a frame of the pool only referenced by the pool : the frames published to a display thread are shallow copies,
+	// they are left untouched until the display releases them
+	size_t l_ui32IdBuffer = 0;
+	while(l_ui32IdBuffer < m_vFramesPool.size() && m_vFramesPool[l_ui32IdBuffer].frame.refcount && *m_vFramesPool[l_ui32IdBuffer].frame.refcount > 1)
+	{
+		++l_ui32IdBuffer;
+	}
 
-	// adds zero lines for even rows
-	cv::Mat zeroAddedRGBDImg( cv::Size(rgbdImg.cols, rgbdImg.rows*2), CV_8UC3, cv::Scalar::all(0) );
-	addZeroLines( rgbdImg, zeroAddedRGBDImg);
+	if(l_ui32IdBuffer == m_vFramesPool.size())
+	{
+		m_vFramesPool.push_back(SWDimencoFrameBuffer());
+	}
+
+	SWDimencoFrameBuffer &l_oBuffer = m_vFramesPool[l_ui32IdBuffer];
+	cv::Mat &l_oDisplayFrame = l_oBuffer.frame;
+
+	// the output frame is the padded rgb image and the padded disparity image side by side, with zero lines
+	// for odd rows : it is kept between compositions so the padding and the zero lines are written only once
+	if(l_oDisplayFrame.rows != displayImgHeight*2 || l_oDisplayFrame.cols != displayImgWidth*2 ||
+	   l_oBuffer.rgbSize != rgbImg.size() || l_oBuffer.depthSize != depthImg.size())
+	{
+		l_oDisplayFrame.create(displayImgHeight*2, displayImgWidth*2, CV_8UC3);
+		l_oDisplayFrame.setTo(cv::Scalar::all(0));
+		l_oBuffer.rgbSize     = rgbImg.size();
+		l_oBuffer.depthSize   = depthImg.size();
+		l_oBuffer.fpsTextRect = cv::Rect();
+	}
+	else
+	{
+		// erases the fps text of the previous composition of this frame
+		l_oDisplayFrame(l_oBuffer.fpsTextRect).setTo(cv::Scalar::all(0));
+	}
+
+	int l_i32RGBOffsetX   = (displayImgWidth  - rgbImg.cols)/2;
+	int l_i32RGBOffsetY   = (displayImgHeight - rgbImg.rows)/2;
+	int l_i32DepthOffsetX = displayImgWidth + (displayImgWidth - depthImg.cols)/2;
+	int l_i32DepthOffsetY = (displayImgHeight - depthImg.rows)/2;
+
+	// copies the rgb rows in the even rows of the left half
+	for(int l_row = 0; l_row < rgbImg.rows; ++l_row)
+	{
+		memcpy(l_oDisplayFrame.ptr<uchar>((l_row + l_i32RGBOffsetY)*2) + l_i32RGBOffsetX*3, rgbImg.ptr<uchar>(l_row), rgbImg.cols*3);
+	}
+
+	// converts the depth rows into disparity rows in the even rows of the right half
+	for(int l_row = 0; l_row < depthImg.rows; ++l_row)
+	{
+		depthRow2Disparity(depthImg.ptr<float>(l_row), l_oDisplayFrame.ptr<uchar>((l_row + l_i32DepthOffsetY)*2) + l_i32DepthOffsetX*3, depthImg.cols);
+	}
 
 	// adds the 3D header, this way the display will interpret the image as 3D
-	add3DHeader( zeroAddedRGBDImg ); //be aware of the Mat, the rgb order is actually bgr;
+	add3DHeader( l_oDisplayFrame ); //be aware of the Mat, the rgb order is actually bgr;
 
 	// determines the fps
 	static double freq = cv::getTickFrequency();
@@ -137,32 +301,23 @@ void SWDimenco3DDisplay::refresh(const cv::Mat& rgbImg, const cv::Mat& depthImg)
 	int64 fps = static_cast<int64>(freq/(cv::getTickCount() - tm) );
 	tm = cv::getTickCount();
 
-	cv::putText( zeroAddedRGBDImg, "fps: " + swUtil::int2string(static_cast<int>(fps)), cv::Point( 15,50), cv::FONT_HERSHEY_SIMPLEX, 1, RED, 3 );
-	cv::imshow("dimenco3D",zeroAddedRGBDImg );
-	
+	std::string l_sFps = "fps: " + swUtil::int2string(static_cast<int>(fps));
+	int l_i32Thickness = 3, l_i32Baseline = 0;
+	cv::Size l_oTextSize = cv::getTextSize(l_sFps, cv::FONT_HERSHEY_SIMPLEX, 1, l_i32Thickness, &l_i32Baseline);
+	l_oBuffer.fpsTextRect = cv::Rect(15 - l_i32Thickness, 50 - l_oTextSize.height - l_i32Thickness,
+	                                 l_oTextSize.width + 2*l_i32Thickness, l_oTextSize.height + l_i32Baseline + 2*l_i32Thickness)
+	                        & cv::Rect(0, 0, l_oDisplayFrame.cols, l_oDisplayFrame.rows);
+
+	cv::putText( l_oDisplayFrame, l_sFps, cv::Point( 15,50), cv::FONT_HERSHEY_SIMPLEX, 1, RED, l_i32Thickness );
+
+	return l_oDisplayFrame;
 }
 
 void SWDimenco3DDisplay::depth2disparity(const cv::Mat& depthImg, cv::Mat& disparityImg)
 {	
-	int numRows = depthImg.rows;
-	int numCols = depthImg.cols;
-	
-	for (int l_row=0; l_row<numRows; l_row++)
+	for (int l_row=0; l_row<depthImg.rows; l_row++)
 	{
-		for (int l_col=0; l_col<numCols; l_col++)
-		{
-			double depthValue = depthImg.at<float>(l_row,l_col);
-			int disparity = static_cast<int>(floor(M*(1 - vz/(depthValue - Zd + vz))+C));
-			
-			//~ if (l_row==numRows/2 && l_col==numCols/2)
-				//~ std::cout << "disparity = " <<disparity <<std::endl;
-			
-			for(int k=0; k<disparityImg.channels(); k++) //all channels
-			{
-				disparityImg.at<cv::Vec3b>(l_row,l_col)[k] = disparity;
-			}
-			
-		}
+		depthRow2Disparity(depthImg.ptr<float>(l_row), disparityImg.ptr<uchar>(l_row), depthImg.cols);
 	}
 	
 //   cv::flip(disparityImg, disparityImg, 0);
@@ -312,6 +467,60 @@ void SWDimenco3DDisplay::embedBlueBit7B(unsigned char *data, unsigned char *hd,
 	}
 }
 
+/**
+ * @brief rgb and normalized depth images grabbed from the kinect
+ */
+struct SWKinectFrame
+{
+    cv::Mat bgrImage;           /**< bgr image */
+    cv::Mat normalizedDepthMap; /**< depth map normalized in [0,1] */
+};
+
+/**
+ * @brief grab stage : retrieves a new set of images (rgb + depth)
+ * @param pKinect
+ * @param oFrame
+ * @return 1 when a frame has been grabbed, a grab error is thrown and stops the stage
+ */
+static int grabKinectFrame(swDevice::SWKinect *pKinect, SWKinectFrame &oFrame)
+{
+    pKinect->grab();
+
+    oFrame.bgrImage           = pKinect->bgrImage.clone();
+    oFrame.normalizedDepthMap = pKinect->normalizedDepthMap.clone();
+
+    return 1;
+}
+
+/**
+ * @brief processing stage : composes the 3D frame of the latest grabbed images
+ * @param pDimenco
+ * @param pGrabbedFrame
+ * @param oFrame
+ * @return 1 if a frame has been composed, 0 if the images can't be displayed, -1 when the grab stage is stopped
+ */
+static int composeDimencoFrame(SWDimenco3DDisplay *pDimenco, swDevice::SWLatestFrame<SWKinectFrame> *pGrabbedFrame, cv::Mat &oFrame)
+{
+    SWKinectFrame l_oKinectFrame;
+
+    if(!pGrabbedFrame->pop(l_oKinectFrame))
+    {
+        return -1;
+    }
+
+    const cv::Mat &l_oComposedFrame = pDimenco->compose(l_oKinectFrame.bgrImage, l_oKinectFrame.normalizedDepthMap);
+
+    if(l_oComposedFrame.empty())
+    {
+        return 0;
+    }
+
+    // the frame comes from the display pool and is not reused while it is referenced : no clone needed
+    oFrame = l_oComposedFrame;
+
+    return 1;
+}
+
 int main(int argc, char* argv[])
 {
     // get the 3d monitor screen size
@@ -338,19 +547,44 @@ int main(int argc, char* argv[])
     swKinect.init(0);
     swDimenco.init(monitorSize);
 
-    for (;;)
+    // the kinect is grabbed and the 3D frame is composed on their own threads, the window thread only displays the latest frame :
+    // the display vsync and the HighGUI events don't throttle the capture anymore
+    swDevice::SWLatestFrame<SWKinectFrame> l_oGrabbedFrame;
+    swDevice::SWLatestFrame<cv::Mat> l_oComposedFrame;
+
+    swDevice::SWFrameStage_thread<SWKinectFrame> l_oGrabStage(boost::bind(&grabKinectFrame, &swKinect, _1));
+    swDevice::SWFrameStage_thread<cv::Mat> l_oComposeStage(boost::bind(&composeDimencoFrame, &swDimenco, &l_oGrabbedFrame, _1));
+
+    l_oGrabStage.addOutput(&l_oGrabbedFrame);
+    l_oComposeStage.addOutput(&l_oComposedFrame);
+
+    l_oComposeStage.startListening();
+    l_oGrabStage.startListening();
+
+    cv::Mat l_oFrame;
+
+    while(l_oComposeStage.isRunning())
     {
-        // grabs a new set of images (rgb + depth)
-        swKinect.grab();
-        // swKinect.normalizeDepthImage();
-        // displays them on the 3D display
-        // swDimenco.refresh(swKinect.bgrImage,swKinect.normalizedDepthMap);
-        swDimenco.refresh(swKinect.bgrImage,swKinect.normalizedDepthMap);
-        // waits 30ms before looking for new images
-        if( cv::waitKey( 16 ) >= 0 )
+        // displays the latest composed frame on the 3D display
+        if(l_oComposedFrame.pop(l_oFrame, 16))
+        {
+            cv::imshow("dimenco3D", l_oFrame);
+        }
+
+        // processes the window events
+        if( cv::waitKey( 1 ) >= 0 )
             break;
     }
 
+    // stops the grab stage first, the compose stage ends with it
+    l_oGrabStage.stopListening();
+    l_oComposeStage.stopListening();
+
+    if(l_oGrabStage.hasFailed())
+    {
+        std::cerr << "-ERROR : kinect grab -> " << l_oGrabStage.errorMessage() << std::endl;
+        return -1;
+    }
+
     return 0;
 }
-
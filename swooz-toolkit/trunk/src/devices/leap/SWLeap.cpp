@@ -33,37 +33,26 @@
 
 #include "devices/leap/SWLeap.h"
 
+#include <algorithm>
+
 
 using namespace swDevice;
 
-SWLeap::SWLeap()
+SWLeap::SWLeap() : m_fps(0)
 {
-    std::vector<float> l_vInitVector(3,0.f);
-    std::vector<std::vector<float> > l_vBonesInitVector3(3, l_vInitVector);
-    std::vector<std::vector<float> > l_vBonesInitVector4(4, l_vInitVector);
-
-    m_vLeftCoordPalmHand = m_vLeftNormalPalmHand = m_vLeftDirectionArm = m_vLeftDirectionHand = m_vLeftDirectionHandE = m_vLeftNormalPalmHandE = l_vInitVector;
-//    m_vLeftThumbRotation =  m_vLeftIndexRotation = m_vLeftMiddleRotation = m_vLeftRingRotation =  m_vLeftPinkyRotation = l_vInitVector;
-
-    m_vRightCoordPalmHand = m_vRightNormalPalmHand = m_vRightDirectionArm = m_vRightDirectionHand = m_vRightDirectionHandE = m_vRightNormalPalmHandE = l_vInitVector;
-//    m_vRightThumbRotation =  m_vRightIndexRotation = m_vRightMiddleRotation = m_vRightRingRotation =  m_vRightPinkyRotation = l_vInitVector;
-
-    m_vLeftThumbDirections = m_vRightThumbDirections = l_vBonesInitVector3;
-    m_vLeftIndexDirections = m_vLeftMiddleDirections = m_vLeftRingDirections = m_vLeftPinkyDirections = l_vBonesInitVector4;
-    m_vRightIndexDirections = m_vRightMiddleDirections = m_vRightRingDirections = m_vRightPinkyDirections = l_vBonesInitVector4;
-
-    m_vLeftThumbPositions = m_vRightThumbPositions = l_vBonesInitVector3;
-    m_vLeftIndexPositions = m_vLeftMiddlePositions = m_vLeftRingPositions = m_vLeftPinkyPositions = l_vBonesInitVector4;
-    m_vRightIndexPositions = m_vRightMiddlePositions = m_vRightRingPositions = m_vRightPinkyPositions = l_vBonesInitVector4;
+    std::fill(&m_oLeftHand.m_aFHand[0],                 &m_oLeftHand.m_aFHand[0] + LEAP_HAND_VALUES_NB, 0.f);
+    std::fill(&m_oLeftHand.m_aFBoneDirections[0][0][0], &m_oLeftHand.m_aFBoneDirections[0][0][0] + 60,   0.f);
+    std::fill(&m_oLeftHand.m_aFBonePositions[0][0][0],  &m_oLeftHand.m_aFBonePositions[0][0][0]  + 60,   0.f);
+    m_oRightHand = m_oLeftHand;
 }
 
-void SWLeap::toStdVector(std::vector<float> &oSTDVec, Leap::Vector &oVector)
+void SWLeap::copyVector(float *a3FDest, const Leap::Vector &oVector) const
 {
     if(oVector.x != 0 && oVector.y != 0 && oVector.z != 0)
     {
-        oSTDVec[0] = oVector.x;
-        oSTDVec[1] = oVector.y;
-        oSTDVec[2] = oVector.z;
+        a3FDest[0] = oVector.x;
+        a3FDest[1] = oVector.y;
+        a3FDest[2] = oVector.z;
     }
 }
 
@@ -90,364 +79,21 @@ bool SWLeap::init()
     return true;
 }
 
-void SWLeap::boneDirection(const bool bLeftHand, const Leap::Finger::Type fingerType, const Leap::Bone::Type boneType, std::vector<float> &vBoneDirection)
+const SWLeapHandSnapshot &SWLeap::hand(cbool bLeftHand) const
 {
-    if(bLeftHand)
-    {
-        switch(fingerType)
-        {
-            case  Leap::Finger::TYPE_THUMB :
-                switch(boneType)
-                {
-                    case Leap::Bone::TYPE_PROXIMAL :
-                        vBoneDirection = m_vLeftThumbDirections[0];
-                    break;
-                    case Leap::Bone::TYPE_INTERMEDIATE :
-                        vBoneDirection = m_vLeftThumbDirections[1];
-                    break;
-                    case Leap::Bone::TYPE_DISTAL :
-                        vBoneDirection = m_vLeftThumbDirections[2];
-                    break;
-                }
-            break;
-            case  Leap::Finger::TYPE_INDEX :
-                switch(boneType)
-                {
-                    case Leap::Bone::TYPE_METACARPAL :
-                        vBoneDirection = m_vLeftIndexDirections[0];
-                    break;
-                    case Leap::Bone::TYPE_PROXIMAL :
-                        vBoneDirection = m_vLeftIndexDirections[1];
-                    break;
-                    case Leap::Bone::TYPE_INTERMEDIATE :
-                        vBoneDirection = m_vLeftIndexDirections[2];
-                    break;
-                    case Leap::Bone::TYPE_DISTAL :
-                        vBoneDirection = m_vLeftIndexDirections[3];
-                    break;
-                }
-            break;
-            case  Leap::Finger::TYPE_MIDDLE :
-                switch(boneType)
-                {
-                    case Leap::Bone::TYPE_METACARPAL :
-                        vBoneDirection = m_vLeftMiddleDirections[0];
-                    break;
-                    case Leap::Bone::TYPE_PROXIMAL :
-                        vBoneDirection = m_vLeftMiddleDirections[1];
-                    break;
-                    case Leap::Bone::TYPE_INTERMEDIATE :
-                        vBoneDirection = m_vLeftMiddleDirections[2];
-                    break;
-                    case Leap::Bone::TYPE_DISTAL :
-                        vBoneDirection = m_vLeftMiddleDirections[3];
-                    break;
-                }
-            break;
-            case  Leap::Finger::TYPE_RING :
-                switch(boneType)
-                {
-                    case Leap::Bone::TYPE_METACARPAL :
-                        vBoneDirection = m_vLeftRingDirections[0];
-                    break;
-                    case Leap::Bone::TYPE_PROXIMAL :
-                        vBoneDirection = m_vLeftRingDirections[1];
-                    break;
-                    case Leap::Bone::TYPE_INTERMEDIATE :
-                        vBoneDirection = m_vLeftRingDirections[2];
-                    break;
-                    case Leap::Bone::TYPE_DISTAL :
-                        vBoneDirection = m_vLeftRingDirections[3];
-                    break;
-                }
-            break;
-            case  Leap::Finger::TYPE_PINKY :
-                switch(boneType)
-                {
-                    case Leap::Bone::TYPE_METACARPAL :
-                        vBoneDirection = m_vLeftPinkyDirections[0];
-                    break;
-                    case Leap::Bone::TYPE_PROXIMAL :
-                        vBoneDirection = m_vLeftPinkyDirections[1];
-                    break;
-                    case Leap::Bone::TYPE_INTERMEDIATE :
-                        vBoneDirection = m_vLeftPinkyDirections[2];
-                    break;
-                    case Leap::Bone::TYPE_DISTAL :
-                        vBoneDirection = m_vLeftPinkyDirections[3];
-                    break;
-                }
-            break;
-        }
-    }
-    else
-    {
-        switch(fingerType)
-        {
-            case  Leap::Finger::TYPE_THUMB :
-                switch(boneType)
-                {
-                    case Leap::Bone::TYPE_PROXIMAL :
-                        vBoneDirection = m_vRightThumbDirections[0];
-                    break;
-                    case Leap::Bone::TYPE_INTERMEDIATE :
-                        vBoneDirection = m_vRightThumbDirections[1];
-                    break;
-                    case Leap::Bone::TYPE_DISTAL :
-                        vBoneDirection = m_vRightThumbDirections[2];
-                    break;
-                }
-            break;
-            case  Leap::Finger::TYPE_INDEX :
-                switch(boneType)
-                {
-                    case Leap::Bone::TYPE_METACARPAL :
-                        vBoneDirection = m_vRightIndexDirections[0];
-                    break;
-                    case Leap::Bone::TYPE_PROXIMAL :
-                        vBoneDirection = m_vRightIndexDirections[1];
-                    break;
-                    case Leap::Bone::TYPE_INTERMEDIATE :
-                        vBoneDirection = m_vRightIndexDirections[2];
-                    break;
-                    case Leap::Bone::TYPE_DISTAL :
-                        vBoneDirection = m_vRightIndexDirections[3];
-                    break;
-                }
-            break;
-            case  Leap::Finger::TYPE_MIDDLE :
-                switch(boneType)
-                {
-                    case Leap::Bone::TYPE_METACARPAL :
-                        vBoneDirection = m_vRightMiddleDirections[0];
-                    break;
-                    case Leap::Bone::TYPE_PROXIMAL :
-                        vBoneDirection = m_vRightMiddleDirections[1];
-                    break;
-                    case Leap::Bone::TYPE_INTERMEDIATE :
-                        vBoneDirection = m_vRightMiddleDirections[2];
-                    break;
-                    case Leap::Bone::TYPE_DISTAL :
-                        vBoneDirection = m_vRightMiddleDirections[3];
-                    break;
-                }
-            break;
-            case  Leap::Finger::TYPE_RING :
-                switch(boneType)
-                {
-                    case Leap::Bone::TYPE_METACARPAL :
-                        vBoneDirection = m_vRightRingDirections[0];
-                    break;
-                    case Leap::Bone::TYPE_PROXIMAL :
-                        vBoneDirection = m_vRightRingDirections[1];
-                    break;
-                    case Leap::Bone::TYPE_INTERMEDIATE :
-                        vBoneDirection = m_vRightRingDirections[2];
-                    break;
-                    case Leap::Bone::TYPE_DISTAL :
-                        vBoneDirection = m_vRightRingDirections[3];
-                    break;
-                }
-            break;
-            case  Leap::Finger::TYPE_PINKY :
-                switch(boneType)
-                {
-                    case Leap::Bone::TYPE_METACARPAL :
-                        vBoneDirection = m_vRightPinkyDirections[0];
-                    break;
-                    case Leap::Bone::TYPE_PROXIMAL :
-                        vBoneDirection = m_vRightPinkyDirections[1];
-                    break;
-                    case Leap::Bone::TYPE_INTERMEDIATE :
-                        vBoneDirection = m_vRightPinkyDirections[2];
-                    break;
-                    case Leap::Bone::TYPE_DISTAL :
-                        vBoneDirection = m_vRightPinkyDirections[3];
-                    break;
-                }
-            break;
-        }
-    }
+    return bLeftHand ? m_oLeftHand : m_oRightHand;
 }
 
-void SWLeap::bonePosition(const bool bLeftHand, const Leap::Finger::Type fingerType, const Leap::Bone::Type boneType, std::vector<float> &vBonePosition)
+void SWLeap::boneDirection(const bool bLeftHand, const Leap::Finger::Type fingerType, const Leap::Bone::Type boneType, std::vector<float> &vBoneDirection) const
 {
-    if(bLeftHand)
-    {
-        switch(fingerType)
-        {
-            case  Leap::Finger::TYPE_THUMB :
-                switch(boneType)
-                {
-                    case Leap::Bone::TYPE_PROXIMAL :
-                        vBonePosition = m_vLeftThumbPositions[0];
-                    break;
-                    case Leap::Bone::TYPE_INTERMEDIATE :
-                        vBonePosition = m_vLeftThumbPositions[1];
-                    break;
-                    case Leap::Bone::TYPE_DISTAL :
-                        vBonePosition = m_vLeftThumbPositions[2];
-                    break;
-                }
-            break;
-            case  Leap::Finger::TYPE_INDEX :
-                switch(boneType)
-                {
-                    case Leap::Bone::TYPE_METACARPAL :
-                        vBonePosition = m_vLeftIndexPositions[0];
-                    break;
-                    case Leap::Bone::TYPE_PROXIMAL :
-                        vBonePosition = m_vLeftIndexPositions[1];
-                    break;
-                    case Leap::Bone::TYPE_INTERMEDIATE :
-                        vBonePosition = m_vLeftIndexPositions[2];
-                    break;
-                    case Leap::Bone::TYPE_DISTAL :
-                        vBonePosition = m_vLeftIndexPositions[3];
-                    break;
-                }
-            break;
-            case  Leap::Finger::TYPE_MIDDLE :
-                switch(boneType)
-                {
-                    case Leap::Bone::TYPE_METACARPAL :
-                        vBonePosition = m_vLeftMiddlePositions[0];
-                    break;
-                    case Leap::Bone::TYPE_PROXIMAL :
-                        vBonePosition = m_vLeftMiddlePositions[1];
-                    break;
-                    case Leap::Bone::TYPE_INTERMEDIATE :
-                        vBonePosition = m_vLeftMiddlePositions[2];
-                    break;
-                    case Leap::Bone::TYPE_DISTAL :
-                        vBonePosition = m_vLeftMiddlePositions[3];
-                    break;
-                }
-            break;
-            case  Leap::Finger::TYPE_RING :
-                switch(boneType)
-                {
-                    case Leap::Bone::TYPE_METACARPAL :
-                        vBonePosition = m_vLeftRingPositions[0];
-                    break;
-                    case Leap::Bone::TYPE_PROXIMAL :
-                        vBonePosition = m_vLeftRingPositions[1];
-                    break;
-                    case Leap::Bone::TYPE_INTERMEDIATE :
-                        vBonePosition = m_vLeftRingPositions[2];
-                    break;
-                    case Leap::Bone::TYPE_DISTAL :
-                        vBonePosition = m_vLeftRingPositions[3];
-                    break;
-                }
-            break;
-            case  Leap::Finger::TYPE_PINKY :
-                switch(boneType)
-                {
-                    case Leap::Bone::TYPE_METACARPAL :
-                        vBonePosition = m_vLeftPinkyPositions[0];
-                    break;
-                    case Leap::Bone::TYPE_PROXIMAL :
-                        vBonePosition = m_vLeftPinkyPositions[1];
-                    break;
-                    case Leap::Bone::TYPE_INTERMEDIATE :
-                        vBonePosition = m_vLeftPinkyPositions[2];
-                    break;
-                    case Leap::Bone::TYPE_DISTAL :
-                        vBonePosition = m_vLeftPinkyPositions[3];
-                    break;
-                }
-            break;
-        }
-    }
-    else
-    {
-        switch(fingerType)
-        {
-            case  Leap::Finger::TYPE_THUMB :
-                switch(boneType)
-                {
-                    case Leap::Bone::TYPE_PROXIMAL :
-                        vBonePosition = m_vRightThumbPositions[0];
-                    break;
-                    case Leap::Bone::TYPE_INTERMEDIATE :
-                        vBonePosition = m_vRightThumbPositions[1];
-                    break;
-                    case Leap::Bone::TYPE_DISTAL :
-                        vBonePosition = m_vRightThumbPositions[2];
-                    break;
-                }
-            break;
-            case  Leap::Finger::TYPE_INDEX :
-                switch(boneType)
-                {
-                    case Leap::Bone::TYPE_METACARPAL :
-                        vBonePosition = m_vRightIndexPositions[0];
-                    break;
-                    case Leap::Bone::TYPE_PROXIMAL :
-                        vBonePosition = m_vRightIndexPositions[1];
-                    break;
-                    case Leap::Bone::TYPE_INTERMEDIATE :
-                        vBonePosition = m_vRightIndexPositions[2];
-                    break;
-                    case Leap::Bone::TYPE_DISTAL :
-                        vBonePosition = m_vRightIndexPositions[3];
-                    break;
-                }
-            break;
-            case  Leap::Finger::TYPE_MIDDLE :
-                switch(boneType)
-                {
-                    case Leap::Bone::TYPE_METACARPAL :
-                        vBonePosition = m_vRightMiddlePositions[0];
-                    break;
-                    case Leap::Bone::TYPE_PROXIMAL :
-                        vBonePosition = m_vRightMiddlePositions[1];
-                    break;
-                    case Leap::Bone::TYPE_INTERMEDIATE :
-                        vBonePosition = m_vRightMiddlePositions[2];
-                    break;
-                    case Leap::Bone::TYPE_DISTAL :
-                        vBonePosition = m_vRightMiddlePositions[3];
-                    break;
-                }
-            break;
-            case  Leap::Finger::TYPE_RING :
-                switch(boneType)
-                {
-                    case Leap::Bone::TYPE_METACARPAL :
-                        vBonePosition = m_vRightRingPositions[0];
-                    break;
-                    case Leap::Bone::TYPE_PROXIMAL :
-                        vBonePosition = m_vRightRingPositions[1];
-                    break;
-                    case Leap::Bone::TYPE_INTERMEDIATE :
-                        vBonePosition = m_vRightRingPositions[2];
-                    break;
-                    case Leap::Bone::TYPE_DISTAL :
-                        vBonePosition = m_vRightRingPositions[3];
-                    break;
-                }
-            break;
-            case  Leap::Finger::TYPE_PINKY :
-                switch(boneType)
-                {
-                    case Leap::Bone::TYPE_METACARPAL :
-                        vBonePosition = m_vRightPinkyPositions[0];
-                    break;
-                    case Leap::Bone::TYPE_PROXIMAL :
-                        vBonePosition = m_vRightPinkyPositions[1];
-                    break;
-                    case Leap::Bone::TYPE_INTERMEDIATE :
-                        vBonePosition = m_vRightPinkyPositions[2];
-                    break;
-                    case Leap::Bone::TYPE_DISTAL :
-                        vBonePosition = m_vRightPinkyPositions[3];
-                    break;
-                }
-            break;
-        }
-    }
+    const float *l_a3FBone = hand(bLeftHand).m_aFBoneDirections[fingerType][boneType];
+    vBoneDirection.assign(l_a3FBone, l_a3FBone + 3);
+}
+
+void SWLeap::bonePosition(const bool bLeftHand, const Leap::Finger::Type fingerType, const Leap::Bone::Type boneType, std::vector<float> &vBonePosition) const
+{
+    const float *l_a3FBone = hand(bLeftHand).m_aFBonePositions[fingerType][boneType];
+    vBonePosition.assign(l_a3FBone, l_a3FBone + 3);
 }
 
 
@@ -466,73 +112,95 @@ int SWLeap::numFingerType(const Leap::FingerList &fingerList, const Leap::Finger
 
 void SWLeap::directionArm(cbool leftArm, std::vector<float> &vDirectionArm) const
 {
-    if(leftArm)
-    {
-        vDirectionArm = m_vLeftDirectionArm;
-    }
-    else
-    {
-        vDirectionArm = m_vRightDirectionArm;
-    }
+    const float *l_aFHand = hand(leftArm).m_aFHand + LEAP_ARM_DIRECTION;
+    vDirectionArm.assign(l_aFHand, l_aFHand + 3);
 }
 
 void SWLeap::directionHandEuclidian(cbool leftHand, std::vector<float> &vDirectionHandE) const
 {
-    if(leftHand)
-    {
-        vDirectionHandE = m_vLeftDirectionHandE;
-    }
-    else
-    {
-        vDirectionHandE = m_vRightDirectionHandE;
-    }
+    const float *l_aFHand = hand(leftHand).m_aFHand + LEAP_HAND_DIRECTION_E;
+    vDirectionHandE.assign(l_aFHand, l_aFHand + 3);
 }
 
 void SWLeap::normalPalmHandEuclidian(cbool leftHand, std::vector<float> &vNormalPalmHandE) const
 {
-    if(leftHand)
-    {
-        vNormalPalmHandE = m_vLeftNormalPalmHandE;
-    }
-    else
-    {
-        vNormalPalmHandE = m_vRightNormalPalmHandE;
-    }
+    const float *l_aFHand = hand(leftHand).m_aFHand + LEAP_PALM_NORMAL_E;
+    vNormalPalmHandE.assign(l_aFHand, l_aFHand + 3);
 }
 
 void SWLeap::directionHand(cbool leftHand, std::vector<float> &vDirectionHand) const
 {
-    if(leftHand)
-    {
-        vDirectionHand = m_vLeftDirectionHand;
-    }
-    else
-    {
-        vDirectionHand = m_vRightDirectionHand;
-    }
+    const float *l_aFHand = hand(leftHand).m_aFHand + LEAP_HAND_DIRECTION;
+    vDirectionHand.assign(l_aFHand, l_aFHand + 3);
 }
 
 void SWLeap::normalPalmHand(cbool leftHand, std::vector<float> &vNormalPalmHand) const
 {
-    if(leftHand)
-    {
-        vNormalPalmHand = m_vLeftNormalPalmHand;
-    }
-    else
-    {
-        vNormalPalmHand = m_vRightNormalPalmHand;
-    }
+    const float *l_aFHand = hand(leftHand).m_aFHand + LEAP_PALM_NORMAL;
+    vNormalPalmHand.assign(l_aFHand, l_aFHand + 3);
 }
 
 void SWLeap::coordPalmHand(cbool leftHand, std::vector<float> &vCoordPalmHand) const
 {
-    if(leftHand)
+    const float *l_aFHand = hand(leftHand).m_aFHand + LEAP_PALM_COORD;
+    vCoordPalmHand.assign(l_aFHand, l_aFHand + 3);
+}
+
+void SWLeap::updateHand(const Leap::Hand &oHand, SWLeapHandSnapshot &oSnapshot) const
+{
+    if(!oHand.isValid() || oHand.confidence() <= 0.3f)
     {
-        vCoordPalmHand = m_vLeftCoordPalmHand;
+        return;
     }
-    else
+
+    Leap::Vector l_palmCoord     = oHand.palmPosition();
+    Leap::Vector l_palmNormal    = oHand.palmNormal();
+    Leap::Vector l_handDirection = oHand.direction();
+
+    Leap::Arm l_arm              = oHand.arm();
+    bool l_bArmValid             = l_arm.isValid();
+    Leap::Vector l_armDirection  = l_arm.direction();
+
+    float *l_aFHand = oSnapshot.m_aFHand;
+
+    for(int ii = 0; ii < 3; ++ii)
+    {
+        l_aFHand[LEAP_ARM_DIRECTION + ii]  = l_bArmValid ? l_armDirection[ii] : 0.f;
+        l_aFHand[LEAP_HAND_DIRECTION + ii] = l_handDirection[ii];
+        l_aFHand[LEAP_PALM_COORD + ii]     = l_palmCoord[ii];
+        l_aFHand[LEAP_PALM_NORMAL + ii]    = l_palmNormal[ii];
+    }
+
+    l_aFHand[LEAP_HAND_DIRECTION_E]     = l_handDirection.pitch();
+    l_aFHand[LEAP_HAND_DIRECTION_E + 1] = l_handDirection.roll();
+    l_aFHand[LEAP_HAND_DIRECTION_E + 2] = l_handDirection.yaw();
+
+    l_aFHand[LEAP_PALM_NORMAL_E]        = l_palmNormal.pitch();
+    l_aFHand[LEAP_PALM_NORMAL_E + 1]    = l_palmNormal.roll();
+    l_aFHand[LEAP_PALM_NORMAL_E + 2]    = l_palmNormal.yaw();
+
+    // fingers
+    Leap::FingerList l_fingerList = oHand.fingers();
+
+    for(int ii = Leap::Finger::TYPE_THUMB; ii <= Leap::Finger::TYPE_PINKY; ++ii)
     {
-        vCoordPalmHand = m_vRightCoordPalmHand;
+        Leap::Finger l_finger = l_fingerList[numFingerType(l_fingerList, static_cast<Leap::Finger::Type>(ii))];
+
+        if(!l_finger.isValid())
+        {
+            continue;
+        }
+
+        for(int jj = Leap::Bone::TYPE_METACARPAL; jj <= Leap::Bone::TYPE_DISTAL; ++jj)
+        {
+            Leap::Bone l_oBone = l_finger.bone(static_cast<Leap::Bone::Type>(jj));
+
+            if(l_oBone.isValid())
+            {
+                copyVector(oSnapshot.m_aFBoneDirections[ii][jj], l_oBone.direction());
+                copyVector(oSnapshot.m_aFBonePositions[ii][jj],  l_oBone.center());
+            }
+        }
     }
 }
 
@@ -558,10 +226,6 @@ int SWLeap::grab()
         {
             currentIdRightHand = handList[1].id();
         }
-        else
-        {
-            currentIdRightHand = -1;
-        }
     }
     else
     {
@@ -571,378 +235,18 @@ int SWLeap::grab()
         {
             currentIdLeftHand = handList[1].id();
         }
-        else
-        {
-            currentIdLeftHand = -1;
-        }
     }
 
     // update left hand
     if(currentIdLeftHand != -1)
     {
-        Leap::Hand l_leftHand = l_frame.hand(currentIdLeftHand);
-
-        if(l_leftHand.isValid() && l_leftHand.confidence() > 0.3f)
-        {
-            Leap::Vector l_palmCoord     = l_leftHand.palmPosition();
-            Leap::Vector l_palmNormal    = l_leftHand.palmNormal();
-            Leap::Vector l_handDirection = l_leftHand.direction();
-
-            Leap::Arm l_leftArm          = l_leftHand.arm();
-            Leap::Vector l_armDirection  = l_leftArm.direction();
-
-            std::vector<float> l_vInitVector(3,0.f);
-            m_vLeftCoordPalmHand  = l_vInitVector;
-            m_vLeftNormalPalmHand = l_vInitVector;
-            m_vLeftDirectionHand  = l_vInitVector;
-            m_vLeftDirectionArm   = l_vInitVector;
-            m_vLeftDirectionHandE = l_vInitVector;
-            m_vLeftNormalPalmHandE= l_vInitVector;
-
-            for(uint ii = 0; ii < l_vInitVector.size(); ++ii)
-            {
-                m_vLeftCoordPalmHand[ii]  = l_palmCoord[ii];
-                m_vLeftNormalPalmHand[ii] = l_palmNormal[ii];
-                m_vLeftDirectionHand[ii]  = l_handDirection[ii];
-
-                if(l_leftArm.isValid())
-                {
-                    m_vLeftDirectionArm[ii] = l_armDirection[ii];
-                }
-            }
-
-            m_vLeftDirectionHandE[0] = l_handDirection.pitch();
-            m_vLeftDirectionHandE[1] = l_handDirection.roll();
-            m_vLeftDirectionHandE[2] = l_handDirection.yaw();
-
-            m_vLeftNormalPalmHandE[0] = l_palmNormal.pitch();
-            m_vLeftNormalPalmHandE[1] = l_palmNormal.roll();
-            m_vLeftNormalPalmHandE[2] = l_palmNormal.yaw();
-
-            // left fingers
-            Leap::FingerList l_fingerList = l_leftHand.fingers();
-            Leap::Finger l_thumb  = l_fingerList[numFingerType(l_fingerList, Leap::Finger::TYPE_THUMB)];
-            Leap::Finger l_index  = l_fingerList[numFingerType(l_fingerList, Leap::Finger::TYPE_INDEX)];
-            Leap::Finger l_middle = l_fingerList[numFingerType(l_fingerList, Leap::Finger::TYPE_MIDDLE)];
-            Leap::Finger l_ring   = l_fingerList[numFingerType(l_fingerList, Leap::Finger::TYPE_RING)];
-            Leap::Finger l_pinky  = l_fingerList[numFingerType(l_fingerList, Leap::Finger::TYPE_PINKY)];
-
-            Leap::Bone l_oBone;
-
-            if(l_thumb.isValid())
-            {
-                l_oBone = l_thumb.bone(Leap::Bone::TYPE_PROXIMAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vLeftThumbDirections[0], l_oBone.direction());
-                    toStdVector(m_vLeftThumbPositions[0], l_oBone.center());
-                }
-                l_oBone = l_thumb.bone(Leap::Bone::TYPE_INTERMEDIATE);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vLeftThumbDirections[1], l_oBone.direction());
-                    toStdVector(m_vLeftThumbPositions[1], l_oBone.center());
-                }
-                l_oBone = l_thumb.bone(Leap::Bone::TYPE_DISTAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vLeftThumbDirections[2], l_oBone.direction());
-                    toStdVector(m_vLeftThumbPositions[2], l_oBone.center());
-                }
-            }
-            if(l_index.isValid())
-            {
-                l_oBone = l_index.bone(Leap::Bone::TYPE_METACARPAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vLeftIndexDirections[0], l_oBone.direction());
-                    toStdVector(m_vLeftIndexPositions[0], l_oBone.center());
-                }
-                l_oBone = l_index.bone(Leap::Bone::TYPE_PROXIMAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vLeftIndexDirections[1], l_oBone.direction());
-                    toStdVector(m_vLeftIndexPositions[1], l_oBone.center());
-                }                
-                l_oBone = l_index.bone(Leap::Bone::TYPE_INTERMEDIATE);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vLeftIndexDirections[2], l_oBone.direction());
-                    toStdVector(m_vLeftIndexPositions[2], l_oBone.center());
-                }
-                l_oBone = l_index.bone(Leap::Bone::TYPE_DISTAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vLeftIndexDirections[3], l_oBone.direction());
-                    toStdVector(m_vLeftIndexPositions[3], l_oBone.center());
-                }
-            }
-            if(l_middle.isValid())
-            {
-                l_oBone = l_middle.bone(Leap::Bone::TYPE_METACARPAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vLeftMiddleDirections[0], l_oBone.direction());
-                    toStdVector(m_vLeftMiddlePositions[0], l_oBone.center());
-                }
-                l_oBone = l_middle.bone(Leap::Bone::TYPE_PROXIMAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vLeftMiddleDirections[1], l_oBone.direction());
-                    toStdVector(m_vLeftMiddlePositions[1], l_oBone.center());
-                }
-                l_oBone = l_middle.bone(Leap::Bone::TYPE_INTERMEDIATE);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vLeftMiddleDirections[2], l_oBone.direction());
-                    toStdVector(m_vLeftMiddlePositions[2], l_oBone.center());
-                }
-                l_oBone = l_middle.bone(Leap::Bone::TYPE_DISTAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vLeftMiddleDirections[3], l_oBone.direction());
-                    toStdVector(m_vLeftMiddlePositions[3], l_oBone.center());
-                }
-            }
-            if(l_ring.isValid())
-            {                
-                l_oBone = l_ring.bone(Leap::Bone::TYPE_METACARPAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vLeftRingDirections[0], l_oBone.direction());
-                    toStdVector(m_vLeftRingPositions[0], l_oBone.center());
-                }
-                l_oBone = l_ring.bone(Leap::Bone::TYPE_PROXIMAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vLeftRingDirections[1], l_oBone.direction());
-                    toStdVector(m_vLeftRingPositions[1], l_oBone.center());
-                }
-                l_oBone = l_ring.bone(Leap::Bone::TYPE_INTERMEDIATE);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vLeftRingDirections[2], l_oBone.direction());
-                    toStdVector(m_vLeftRingPositions[2], l_oBone.center());
-                }
-                l_oBone = l_ring.bone(Leap::Bone::TYPE_DISTAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vLeftRingDirections[3], l_oBone.direction());
-                    toStdVector(m_vLeftRingPositions[3], l_oBone.center());
-                }
-            }
-            if(l_pinky.isValid())
-            {
-                l_oBone = l_pinky.bone(Leap::Bone::TYPE_METACARPAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vLeftPinkyDirections[0], l_oBone.direction());
-                    toStdVector(m_vLeftPinkyPositions[0], l_oBone.center());
-                }
-                l_oBone = l_pinky.bone(Leap::Bone::TYPE_PROXIMAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vLeftPinkyDirections[1], l_oBone.direction());
-                    toStdVector(m_vLeftPinkyPositions[1], l_oBone.center());
-                }
-                l_oBone = l_pinky.bone(Leap::Bone::TYPE_INTERMEDIATE);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vLeftPinkyDirections[2], l_oBone.direction());
-                    toStdVector(m_vLeftPinkyPositions[2], l_oBone.center());
-                }
-                l_oBone = l_pinky.bone(Leap::Bone::TYPE_DISTAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vLeftPinkyDirections[3], l_oBone.direction());
-                    toStdVector(m_vLeftPinkyPositions[3], l_oBone.center());
-                }
-            }
-        }
+        updateHand(l_frame.hand(currentIdLeftHand), m_oLeftHand);
     }
 
     // update right hand
     if(currentIdRightHand != -1)
     {
-        Leap::Hand l_rightHand = l_frame.hand(currentIdRightHand);
-
-        if(l_rightHand.isValid() && l_rightHand.confidence() > 0.3f)
-        {
-            Leap::Vector l_palmCoord     = l_rightHand.palmPosition();
-            Leap::Vector l_palmNormal    = l_rightHand.palmNormal();
-            Leap::Vector l_handDirection = l_rightHand.direction();
-
-            Leap::Arm l_rightArm         = l_rightHand.arm();
-            Leap::Vector l_armDirection  = l_rightArm.direction();
-
-            std::vector<float> l_vInitVector(3,0.f);
-            m_vRightCoordPalmHand  = l_vInitVector;
-            m_vRightNormalPalmHand = l_vInitVector;
-            m_vRightDirectionHand  = l_vInitVector;
-            m_vRightDirectionArm   = l_vInitVector;
-            m_vRightDirectionHandE = l_vInitVector;
-            m_vRightNormalPalmHandE= l_vInitVector;
-
-            for(uint ii = 0; ii < l_vInitVector.size(); ++ii)
-            {
-                m_vRightCoordPalmHand[ii]  = l_palmCoord[ii];
-                m_vRightNormalPalmHand[ii] = l_palmNormal[ii];
-                m_vRightDirectionHand[ii]  = l_handDirection[ii];
-
-                if(l_rightArm.isValid())
-                {
-                    m_vRightDirectionArm[ii] = l_armDirection[ii];
-                }
-            }
-
-            m_vRightDirectionHandE[0] = l_handDirection.pitch();
-            m_vRightDirectionHandE[1] = l_handDirection.roll();
-            m_vRightDirectionHandE[2] = l_handDirection.yaw();
-
-            m_vRightNormalPalmHandE[0] = l_palmNormal.pitch();
-            m_vRightNormalPalmHandE[1] = l_palmNormal.roll();
-            m_vRightNormalPalmHandE[2] = l_palmNormal.yaw();
-
-            // left fingers
-            Leap::FingerList l_fingerList = l_rightHand.fingers();
-            Leap::Finger l_thumb  = l_fingerList[numFingerType(l_fingerList, Leap::Finger::TYPE_THUMB)];
-            Leap::Finger l_index  = l_fingerList[numFingerType(l_fingerList, Leap::Finger::TYPE_INDEX)];
-            Leap::Finger l_middle = l_fingerList[numFingerType(l_fingerList, Leap::Finger::TYPE_MIDDLE)];
-            Leap::Finger l_ring   = l_fingerList[numFingerType(l_fingerList, Leap::Finger::TYPE_RING)];
-            Leap::Finger l_pinky  = l_fingerList[numFingerType(l_fingerList, Leap::Finger::TYPE_PINKY)];
-
-            Leap::Bone l_oBone;
-
-            if(l_thumb.isValid())
-            {
-                l_oBone = l_thumb.bone(Leap::Bone::TYPE_PROXIMAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vRightThumbDirections[0], l_oBone.direction());
-                    toStdVector(m_vRightThumbPositions[0], l_oBone.center());
-                }
-                l_oBone = l_thumb.bone(Leap::Bone::TYPE_INTERMEDIATE);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vRightThumbDirections[1], l_oBone.direction());
-                    toStdVector(m_vRightThumbPositions[1], l_oBone.center());
-                }
-                l_oBone = l_thumb.bone(Leap::Bone::TYPE_DISTAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vRightThumbDirections[2], l_oBone.direction());
-                    toStdVector(m_vRightThumbPositions[2], l_oBone.center());
-                }
-            }
-            if(l_index.isValid())
-            {
-                l_oBone = l_index.bone(Leap::Bone::TYPE_METACARPAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vRightIndexDirections[0], l_oBone.direction());
-                    toStdVector(m_vRightIndexPositions[0], l_oBone.center());
-                }
-                l_oBone = l_index.bone(Leap::Bone::TYPE_PROXIMAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vRightIndexDirections[1], l_oBone.direction());
-                    toStdVector(m_vRightIndexPositions[1], l_oBone.center());
-                }
-                l_oBone = l_index.bone(Leap::Bone::TYPE_INTERMEDIATE);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vRightIndexDirections[2], l_oBone.direction());
-                    toStdVector(m_vRightIndexPositions[2], l_oBone.center());
-                }
-                l_oBone = l_index.bone(Leap::Bone::TYPE_DISTAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vRightIndexDirections[3], l_oBone.direction());
-                    toStdVector(m_vRightIndexPositions[3], l_oBone.center());
-                }
-            }
-            if(l_middle.isValid())
-            {
-                l_oBone = l_middle.bone(Leap::Bone::TYPE_METACARPAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vRightMiddleDirections[0], l_oBone.direction());
-                    toStdVector(m_vRightMiddlePositions[0], l_oBone.center());
-                }
-                l_oBone = l_middle.bone(Leap::Bone::TYPE_PROXIMAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vRightMiddleDirections[1], l_oBone.direction());
-                    toStdVector(m_vRightMiddlePositions[1], l_oBone.center());
-                }
-                l_oBone = l_middle.bone(Leap::Bone::TYPE_INTERMEDIATE);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vRightMiddleDirections[2], l_oBone.direction());
-                    toStdVector(m_vRightMiddlePositions[2], l_oBone.center());
-                }
-                l_oBone = l_middle.bone(Leap::Bone::TYPE_DISTAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vRightMiddleDirections[3], l_oBone.direction());
-                    toStdVector(m_vRightMiddlePositions[3], l_oBone.center());
-                }
-            }
-            if(l_ring.isValid())
-            {
-                l_oBone = l_ring.bone(Leap::Bone::TYPE_METACARPAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vRightRingDirections[0], l_oBone.direction());
-                    toStdVector(m_vRightRingPositions[0], l_oBone.center());
-                }
-                l_oBone = l_ring.bone(Leap::Bone::TYPE_PROXIMAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vRightRingDirections[1], l_oBone.direction());
-                    toStdVector(m_vRightRingPositions[1], l_oBone.center());
-                }
-                l_oBone = l_ring.bone(Leap::Bone::TYPE_INTERMEDIATE);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vRightRingDirections[2], l_oBone.direction());
-                    toStdVector(m_vRightRingPositions[2], l_oBone.center());
-                }
-                l_oBone = l_ring.bone(Leap::Bone::TYPE_DISTAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vRightRingDirections[3], l_oBone.direction());
-                    toStdVector(m_vRightRingPositions[3], l_oBone.center());
-                }
-            }
-            if(l_pinky.isValid())
-            {
-                l_oBone = l_pinky.bone(Leap::Bone::TYPE_METACARPAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vRightPinkyDirections[0], l_oBone.direction());
-                    toStdVector(m_vRightPinkyPositions[0], l_oBone.center());
-                }
-                l_oBone = l_pinky.bone(Leap::Bone::TYPE_PROXIMAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vRightPinkyDirections[1], l_oBone.direction());
-                    toStdVector(m_vRightPinkyPositions[1], l_oBone.center());
-                }
-                l_oBone = l_pinky.bone(Leap::Bone::TYPE_INTERMEDIATE);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vRightPinkyDirections[2], l_oBone.direction());
-                    toStdVector(m_vRightPinkyPositions[2], l_oBone.center());
-                }
-                l_oBone = l_pinky.bone(Leap::Bone::TYPE_DISTAL);
-                if(l_oBone.isValid())
-                {
-                    toStdVector(m_vRightPinkyDirections[3], l_oBone.direction());
-                    toStdVector(m_vRightPinkyPositions[3], l_oBone.center());
-                }
-            }
-        }
+        updateHand(l_frame.hand(currentIdRightHand), m_oRightHand);
     }
 
     m_fps = static_cast<int>(l_frame.currentFramesPerSecond());
@@ -954,6 +258,3 @@ int SWLeap::fps() const
 {
     return m_fps;
 }
-
-
-
@@ -51,6 +51,10 @@ SWKinect::SWKinect(bool bVerbose) : m_bVerbose(bVerbose)
     m_bRecalibrate      = false;//true;
 	m_i32XCalibrate = 0;//4;
 	m_i32YCalibrate = 0;//-7;
+
+    // the depth lookup table is built at the first normalization
+    m_i32LUTMinDepth = -1;
+    m_i32LUTMaxDepth = -1;
 }
 
 SWKinect::~SWKinect(void)
@@ -204,72 +208,34 @@ int SWKinect::grab(void)
 
 void SWKinect::recalibrate()
 {
-	cv::Scalar l_oBlack(0,0,0), l_oCurrColor;
-	cv::Mat l_oNewBgrImage(cv::Size(bgrImage.size()), CV_8UC3, l_oBlack);
-	
-	for(int ii = 0; ii < l_oNewBgrImage.rows; ++ii)
-	{
-		for(int jj = 0; jj < l_oNewBgrImage.cols; ++jj)
-		{		
-			int l_i32CurrII;
-			int l_i32CurrJJ;
-			bool l_bPaintBlack = false;			
-
-			if(m_i32XCalibrate < 0)
-			{
-				if( jj < l_oNewBgrImage.cols + m_i32XCalibrate-1)
-				{
-					l_i32CurrJJ = jj - m_i32XCalibrate;					
-				}
-				else
-				{
-					l_bPaintBlack = true;
-				}
-			}
-			else
-			{
-				if( jj > m_i32XCalibrate)
-				{
-					l_i32CurrJJ = jj - m_i32XCalibrate;
-				}	
-				else
-				{
-					l_bPaintBlack = true;
-				}				
-			}
-			
-			if(m_i32YCalibrate < 0)
-			{
-				if( ii < l_oNewBgrImage.rows + m_i32YCalibrate-1)
-				{
-					l_i32CurrII = ii - m_i32YCalibrate;				
-				}
-				else
-				{
-					l_bPaintBlack = true;
-				}				
-			}
-			else
-			{
-				if( ii > m_i32YCalibrate)
-				{
-					l_i32CurrII = ii - m_i32YCalibrate;
-				}		
-				else
-				{
-					l_bPaintBlack = true;
-				}				
-			}			
-			
-			if(!l_bPaintBlack)
-			{					
-				l_oNewBgrImage.at<cv::Vec3b> (ii,jj) = bgrImage.at<cv::Vec3b>(l_i32CurrII,l_i32CurrJJ);					
-			}			
-		}
-	}
-	
-	
-	bgrImage = l_oNewBgrImage.clone();
+    // the shifted pixels are copied as one ROI : dst(ii,jj) = src(ii - m_i32YCalibrate, jj - m_i32XCalibrate),
+    // the first/last row and column of the shifted side stay black (same behaviour as the previous per-pixel version)
+    int l_i32Width  = bgrImage.cols - abs(m_i32XCalibrate) - 1;
+    int l_i32Height = bgrImage.rows - abs(m_i32YCalibrate) - 1;
+
+    m_oRecalibratedBgrImage.create(bgrImage.size(), CV_8UC3);
+
+    if(l_i32Width <= 0 || l_i32Height <= 0)
+    {
+        m_oRecalibratedBgrImage.setTo(cv::Scalar(0,0,0));
+    }
+    else
+    {
+        cv::Rect l_oSrcRoi(m_i32XCalibrate < 0 ? -m_i32XCalibrate : 1, m_i32YCalibrate < 0 ? -m_i32YCalibrate : 1, l_i32Width, l_i32Height);
+        cv::Rect l_oDstRoi(m_i32XCalibrate < 0 ? 0 : m_i32XCalibrate + 1, m_i32YCalibrate < 0 ? 0 : m_i32YCalibrate + 1, l_i32Width, l_i32Height);
+
+        bgrImage(l_oSrcRoi).copyTo(m_oRecalibratedBgrImage(l_oDstRoi));
+
+        // black borders (only the strips outside the ROI are written)
+        cv::Scalar l_oBlack(0,0,0);
+        m_oRecalibratedBgrImage.rowRange(0, l_oDstRoi.y).setTo(l_oBlack);
+        m_oRecalibratedBgrImage.rowRange(l_oDstRoi.y + l_oDstRoi.height, bgrImage.rows).setTo(l_oBlack);
+        m_oRecalibratedBgrImage.rowRange(l_oDstRoi.y, l_oDstRoi.y + l_oDstRoi.height).colRange(0, l_oDstRoi.x).setTo(l_oBlack);
+        m_oRecalibratedBgrImage.rowRange(l_oDstRoi.y, l_oDstRoi.y + l_oDstRoi.height).colRange(l_oDstRoi.x + l_oDstRoi.width, bgrImage.cols).setTo(l_oBlack);
+    }
+
+    // the previous bgr buffer will be reused by the next recalibration
+    cv::swap(bgrImage, m_oRecalibratedBgrImage);
 }
 
 cv::Size SWKinect::sizeFrame()
@@ -284,25 +250,44 @@ int SWKinect::fps()
 
 void SWKinect::normalizeDepthImage(void)
 {
-	normalizedDepthMap = Mat(depthMap.rows, depthMap.cols, CV_32FC1);
-	
-	for (int l_row=0; l_row<depthMap.rows; l_row++)
-	{
-		for (int l_col =0; l_col<depthMap.cols; l_col++)
-		{
-			if (depthMap.at<unsigned short>(l_row,l_col) <= minDepthValue)
-			{
-				normalizedDepthMap.at<float>(l_row,l_col) = 0.0f;
-			}
-			if (depthMap.at<unsigned short>(l_row,l_col) >= maxDepthValue)
-			{
-				normalizedDepthMap.at<float>(l_row,l_col) = 1.0f;
-			}
-			if (depthMap.at<unsigned short>(l_row,l_col) < maxDepthValue && depthMap.at<unsigned short>(l_row,l_col) > minDepthValue)
-			{
-				normalizedDepthMap.at<float>(l_row,l_col) = ((float)depthMap.at<unsigned short>(l_row,l_col) - minDepthValue) / (maxDepthValue-minDepthValue);
-			}
-		}
-	}
-//    std::cout << "normalizedDepthMap.at<float>(l_row,l_col) = " <<normalizedDepthMap.at<float>(depthMap.rows/2,depthMap.cols/2) <<std::endl;
+    // build the lookup table when the depth range changes
+    if(m_i32LUTMinDepth != minDepthValue || m_i32LUTMaxDepth != maxDepthValue)
+    {
+        m_vFDepthLUT.resize(65536);
+
+        for(int ii = 0; ii < 65536; ++ii)
+        {
+            if(ii >= maxDepthValue)
+            {
+                m_vFDepthLUT[ii] = 1.0f;
+            }
+            else if(ii <= minDepthValue)
+            {
+                m_vFDepthLUT[ii] = 0.0f;
+            }
+            else
+            {
+                m_vFDepthLUT[ii] = ((float)ii - minDepthValue) / (maxDepthValue-minDepthValue);
+            }
+        }
+
+        m_i32LUTMinDepth = minDepthValue;
+        m_i32LUTMaxDepth = maxDepthValue;
+    }
+
+    // the normalized map is only reallocated when the depth map size changes
+    normalizedDepthMap.create(depthMap.rows, depthMap.cols, CV_32FC1);
+
+    const float *l_aFLUT = &m_vFDepthLUT[0];
+
+    for (int l_row=0; l_row<depthMap.rows; l_row++)
+    {
+        const unsigned short *l_aUi16Depth = depthMap.ptr<unsigned short>(l_row);
+        float *l_aFNormalized = normalizedDepthMap.ptr<float>(l_row);
+
+        for (int l_col =0; l_col<depthMap.cols; l_col++)
+        {
+            l_aFNormalized[l_col] = l_aFLUT[l_aUi16Depth[l_col]];
+        }
+    }
 }
@@ -126,6 +126,49 @@ int SWKinectSkeleton::grab(std::vector<Coordinates> &values)
 	return 0;
 }
 
+int SWKinectSkeleton::grab(SWSkeletonFrame &oFrame)
+{
+	XnUserID aUsers[m_maxNumUsers];
+	XnUInt16 nUsers = m_maxNumUsers;
+
+	oFrame.m_i32UsersNb  = 0;
+	oFrame.m_i32JointsNb = static_cast<int>(m_skeletonProfile.size()) < SKELETON_MAX_JOINTS ? static_cast<int>(m_skeletonProfile.size()) : SKELETON_MAX_JOINTS;
+
+	m_Context.WaitOneUpdateAll(m_UserGenerator);
+	m_UserGenerator.GetUsers(aUsers, nUsers);
+
+	if(m_i32PreviousDetected != static_cast<int>(nUsers))
+	{
+		std::cout << (int)nUsers << " user(s) detected" << std::endl;
+		m_i32PreviousDetected = static_cast<int>(nUsers);
+	}
+
+	xn::SkeletonCapability l_skeletonCap = m_UserGenerator.GetSkeletonCap();
+
+	for(int ii = 0; ii < static_cast<int>(nUsers); ++ii)
+	{
+		// only the calibrated users have valid joints
+		if(!l_skeletonCap.IsTracking(aUsers[ii]))
+		{
+			continue;
+		}
+
+		SWSkeletonUser &l_user = oFrame.m_aUsers[oFrame.m_i32UsersNb++];
+		l_user.m_i32Id = static_cast<int>(aUsers[ii]);
+
+		for(int jj = 0; jj < oFrame.m_i32JointsNb; ++jj)
+		{
+			XnSkeletonJointPosition l_joint;
+			l_skeletonCap.GetSkeletonJointPosition(aUsers[ii], m_skeletonProfile[jj], l_joint);
+
+			l_user.m_aJoints[jj]      = swUtil::vec3(l_joint.position.X, l_joint.position.Y, l_joint.position.Z);
+			l_user.m_aFConfidence[jj] = l_joint.fConfidence;
+		}
+	}
+
+	return oFrame.m_i32UsersNb > 0 ? 0 : 1;
+}
+
 
 int SWKinectSkeleton::init(const char* xmlConfigFile)
 {
@@ -39,7 +39,7 @@ using namespace std;
 using namespace swDevice;
 using namespace swExcept;
 
-SWKinect_thread::SWKinect_thread(bool bVerbose) : m_oKinect(SWKinect(bVerbose)),m_bInitialized(false), m_bDataAvailable(false)
+SWKinect_thread::SWKinect_thread(bool bVerbose) : m_oKinect(SWKinect(bVerbose)),m_bInitialized(false), m_bDataAvailable(false), m_ui32FrameId(0)
 {}
 
 SWKinect_thread::~SWKinect_thread(void)
@@ -134,6 +134,7 @@ void SWKinect_thread::doWork()
             m_oDepthMap         = m_oKinect.depthMap.clone();
 			m_oGrayImage		= m_oKinect.grayImage.clone();	
 			m_bDataAvailable	= true;
+			++m_ui32FrameId;
 		}
 	}
 }
@@ -144,6 +145,12 @@ bool SWKinect_thread::isDataAvailable()
 	return m_bDataAvailable;
 }
 
+uint SWKinect_thread::frameId()
+{
+	boost::lock_guard<boost::mutex> lock(m_oMutex);
+	return m_ui32FrameId;
+}
+
 cv::Mat SWKinect_thread::cloudMap()
 {
 	{
@@ -0,0 +1,272 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWTrackingBottle.h
+ * \brief Binary payload of the tracking bottles, with the encode and decode helpers of both bottles formats
+ */
+
+#ifndef _SWTRACKINGBOTTLE_
+#define _SWTRACKINGBOTTLE_
+
+#include <vector>
+#include <cstring>
+
+#include <yarp/os/Bottle.h>
+#include <yarp/os/Value.h>
+
+#include "commonTypes.h"
+
+
+namespace swTracking
+{
+    /**
+     * Bottles formats of the tracking values :
+     *  list   : device lib id / get(0).asInt(), then one double per value / get(1 -> n).asDouble()
+     *  binary : device lib id / get(0).asInt(), then a single blob / get(1).asBlob() containing a SWBinaryBottleHeader
+     *           followed by the n values as native doubles.
+     * The list format stays the default one, every receiver decoding with SWBottleValues accepts both.
+     */
+    enum BottleFormat
+    {
+        LIST_BOTTLE, BINARY_BOTTLE
+    };
+
+    const int BINARY_BOTTLE_TAG     = 0x31425753;   /**< "SWB1" blob tag */
+    const int BINARY_BOTTLE_VERSION = 1;            /**< current version of the blob layout */
+
+    /**
+     * \struct SWBinaryBottleHeader
+     * \brief Header of the binary payload, 16 bytes so the values stay aligned on doubles.
+     */
+    struct SWBinaryBottleHeader
+    {
+        int m_i32Tag;       /**< BINARY_BOTTLE_TAG */
+        int m_i32Version;   /**< BINARY_BOTTLE_VERSION */
+        int m_i32ValuesNb;  /**< number of values following the header */
+        int m_i32Reserved;  /**< unused, 0 */
+    };
+
+    /**
+     * \brief Fill a bottle with the list format.
+     * \param [out] oBottle     : bottle to fill, cleared first
+     * \param [in]  i32DeviceId : device lib id
+     * \param [in]  aDValues    : values
+     * \param [in]  i32ValuesNb : number of values
+     */
+    inline void encodeListBottle(yarp::os::Bottle &oBottle, cint i32DeviceId, const double *aDValues, cint i32ValuesNb)
+    {
+        oBottle.clear();
+        oBottle.addInt(i32DeviceId);
+
+        for(int ii = 0; ii < i32ValuesNb; ++ii)
+        {
+            oBottle.addDouble(aDValues[ii]);
+        }
+    }
+
+    /**
+     * \brief Fill a bottle with the binary format.
+     * \param [out]    oBottle     : bottle to fill, cleared first
+     * \param [in]     i32DeviceId : device lib id
+     * \param [in]     aDValues    : values
+     * \param [in]     i32ValuesNb : number of values
+     * \param [in,out] vBuffer     : scratch buffer kept by the caller, only resized when the payload grows
+     */
+    inline void encodeBinaryBottle(yarp::os::Bottle &oBottle, cint i32DeviceId, const double *aDValues, cint i32ValuesNb, std::vector<char> &vBuffer)
+    {
+        SWBinaryBottleHeader l_oHeader = {BINARY_BOTTLE_TAG, BINARY_BOTTLE_VERSION, i32ValuesNb, 0};
+
+        size_t l_ui32Size = sizeof(SWBinaryBottleHeader) + i32ValuesNb * sizeof(double);
+        if(vBuffer.size() < l_ui32Size)
+        {
+            vBuffer.resize(l_ui32Size);
+        }
+
+        memcpy(&vBuffer[0], &l_oHeader, sizeof(SWBinaryBottleHeader));
+        if(i32ValuesNb > 0)
+        {
+            memcpy(&vBuffer[sizeof(SWBinaryBottleHeader)], aDValues, i32ValuesNb * sizeof(double));
+        }
+
+        oBottle.clear();
+        oBottle.addInt(i32DeviceId);
+        oBottle.add(yarp::os::Value(&vBuffer[0], static_cast<int>(l_ui32Size)));
+    }
+
+    /**
+     * \brief Fill a bottle with the wanted format.
+     */
+    inline void encodeBottle(yarp::os::Bottle &oBottle, const BottleFormat eFormat, cint i32DeviceId, const double *aDValues, cint i32ValuesNb,
+                             std::vector<char> &vBuffer)
+    {
+        if(eFormat == BINARY_BOTTLE)
+        {
+            encodeBinaryBottle(oBottle, i32DeviceId, aDValues, i32ValuesNb, vBuffer);
+        }
+        else
+        {
+            encodeListBottle(oBottle, i32DeviceId, aDValues, i32ValuesNb);
+        }
+    }
+
+    /**
+     * \brief Decode a bottle of any format.
+     * \param [in]  oBottle     : bottle to decode
+     * \param [out] i32DeviceId : device lib id, -1 if the bottle is empty
+     * \param [out] vDValues    : values, the vector capacity is reused
+     * \param [out] eFormat     : format of the bottle
+     * \return false if the bottle is empty or if its binary payload is not valid
+     */
+    inline bool decodeBottle(const yarp::os::Bottle &oBottle, int &i32DeviceId, std::vector<double> &vDValues, BottleFormat &eFormat)
+    {
+        vDValues.clear();
+        i32DeviceId = -1;
+        eFormat     = LIST_BOTTLE;
+
+        if(oBottle.size() == 0)
+        {
+            return false;
+        }
+
+        i32DeviceId = oBottle.get(0).asInt();
+
+        if(oBottle.size() == 2 && oBottle.get(1).isBlob())
+        {
+            eFormat = BINARY_BOTTLE;
+
+            const yarp::os::Value &l_oBlob = oBottle.get(1);
+            size_t l_ui32Size = l_oBlob.asBlobLength();
+
+            if(l_ui32Size < sizeof(SWBinaryBottleHeader))
+            {
+                return false;
+            }
+
+            SWBinaryBottleHeader l_oHeader;
+            memcpy(&l_oHeader, l_oBlob.asBlob(), sizeof(SWBinaryBottleHeader));
+
+            if(l_oHeader.m_i32Tag != BINARY_BOTTLE_TAG || l_oHeader.m_i32Version != BINARY_BOTTLE_VERSION || l_oHeader.m_i32ValuesNb < 0 ||
+               l_ui32Size != sizeof(SWBinaryBottleHeader) + l_oHeader.m_i32ValuesNb * sizeof(double))
+            {
+                return false;
+            }
+
+            vDValues.resize(l_oHeader.m_i32ValuesNb);
+            if(l_oHeader.m_i32ValuesNb > 0)
+            {
+                memcpy(&vDValues[0], l_oBlob.asBlob() + sizeof(SWBinaryBottleHeader), l_oHeader.m_i32ValuesNb * sizeof(double));
+            }
+
+            return true;
+        }
+
+        vDValues.resize(oBottle.size() - 1);
+
+        for(int ii = 1; ii < oBottle.size(); ++ii)
+        {
+            vDValues[ii - 1] = oBottle.get(ii).asDouble();
+        }
+
+        return true;
+    }
+
+    /**
+     * \class SWBottleValues
+     * \brief Decoder of the tracking bottles, accepts both formats.
+     *        The values keep the bottle indices : get(ii) returns the value of oBottle.get(ii).asDouble() in the list format.
+     */
+    class SWBottleValues
+    {
+        public :
+
+            SWBottleValues() : m_i32DeviceId(-1), m_eFormat(LIST_BOTTLE)
+            {}
+
+            /**
+             * \brief Decode a bottle, the values storage is reused between the bottles.
+             * \param [in] oBottle : bottle to decode
+             * \return false if the bottle is empty or if its binary payload is not valid
+             */
+            bool decode(const yarp::os::Bottle &oBottle)
+            {
+                return decodeBottle(oBottle, m_i32DeviceId, m_vDValues, m_eFormat);
+            }
+
+            /**
+             * \brief Return the device lib id of the last decoded bottle.
+             */
+            int deviceId() const
+            {
+                return m_i32DeviceId;
+            }
+
+            /**
+             * \brief Return the format of the last decoded bottle.
+             */
+            BottleFormat format() const
+            {
+                return m_eFormat;
+            }
+
+            /**
+             * \brief Return the number of values of the last decoded bottle (the device id is not counted).
+             */
+            int valuesNb() const
+            {
+                return static_cast<int>(m_vDValues.size());
+            }
+
+            /**
+             * \brief Return the values of the last decoded bottle, NULL if there is none.
+             */
+            const double *values() const
+            {
+                return m_vDValues.size() > 0 ? &m_vDValues[0] : NULL;
+            }
+
+            /**
+             * \brief Return a value with its list bottle index (1 for the first value), 0 if the index is out of range as yarp::os::Bottle::get.
+             * \param [in] i32BottleIndex : index
+             */
+            double get(cint i32BottleIndex) const
+            {
+                if(i32BottleIndex < 1 || i32BottleIndex > static_cast<int>(m_vDValues.size()))
+                {
+                    return 0.0;
+                }
+
+                return m_vDValues[i32BottleIndex - 1];
+            }
+
+        private :
+
+            int m_i32DeviceId;                  /**< device lib id */
+            BottleFormat m_eFormat;             /**< format of the last decoded bottle */
+            std::vector<double> m_vDValues;     /**< decoded values */
+    };
+}
+
+#endif
@@ -35,6 +35,7 @@
 
 // SWOOZ
 #include "SWExceptions.h"
+#include "SWTrackingBottle.h"
 
 // LEAP
 #include "devices/leap/SWLeap.h"
@@ -53,9 +54,15 @@
  * \class SWLeapTracking
  * \brief This module sends leap data...
  *
- * Bottles contents :
- *
+ * Bottles contents (same layout for the left and right hands) :
+ *  hand         : LEAP_LIB id / get(0).asInt(),
+ *                 arm direction x,y,z / get(1 -> 3), hand direction x,y,z / get(4 -> 6), hand direction pitch,roll,yaw / get(7 -> 9),
+ *                 hand palm coord x,y,z / get(10 -> 12), hand palm normal x,y,z / get(13 -> 15), hand palm normal pitch,roll,yaw / get(16 -> 18)
+ *  hand_fingers : hand bottle values / get(0 -> 18),
+ *                 thumb proximal, intermediate, distal directions x,y,z / get(19 -> 27),
+ *                 index, middle, ring, pinky metacarpal, proximal, intermediate, distal directions x,y,z / get(28 -> 75)
  *
+ * With --binaryBottles 1 the values are sent with the binary format of SWTrackingBottle.h (same indices once decoded with swTracking::SWBottleValues).
  */
 class SWLeapTracking : public yarp::os::RFModule
 {
@@ -68,7 +75,7 @@ class SWLeapTracking : public yarp::os::RFModule
 
         /**
          * \brief Init configuration values with the config file
-         * \param [in] oRf : icub resource config file
+         * \param [in] oRf : icub resource config file, binaryBottles (int) : send the values with the binary bottle format
          * \return true if configuration successful
          */
         bool configure(yarp::os::ResourceFinder &oRf);
@@ -105,6 +112,15 @@ class SWLeapTracking : public yarp::os::RFModule
          */
         bool updateModule();
 
+        /**
+         * \brief Write a hand snapshot in the hand and hand fingers bottles with a single pass over its values.
+         * \param [in] oHand            : leap hand snapshot
+         * \param [in] oHandPort        : hand port
+         * \param [in] oHandFingersPort : hand fingers port
+         */
+        void fillHandBottles(const swDevice::SWLeapHandSnapshot &oHand,
+                             yarp::os::BufferedPort<yarp::os::Bottle> &oHandPort, yarp::os::BufferedPort<yarp::os::Bottle> &oHandFingersPort);
+
         /**
          * \brief Retrieve the update function call period of the module.
          * \return the period
@@ -116,6 +132,9 @@ class SWLeapTracking : public yarp::os::RFModule
         bool m_bIsLeapInitialized;  /**< is leap initialized ? */
         int m_i32Fps;               /**< refresh rate of updateModule calling */
 
+        swTracking::BottleFormat m_eBottleFormat;   /**< format of the sent bottles */
+        std::vector<char> m_vBottleBuffer;          /**< scratch buffer of the binary bottles */
+
         std::string m_sHandFingersTrackingPortNameLeft;  /**< ... */
         std::string m_sHandFingersTrackingPortNameRight; /**< ... */
         std::string m_sHandTrackingPortNameLeft;         /**< ... */
@@ -52,6 +52,8 @@
 // EMICP
 #include "cloud/SWCaptureHeadMotion.h"
 
+#include <boost/scoped_ptr.hpp>
+
 // YARP
 #include <yarp/dev/all.h>
 #include <yarp/os/all.h>
@@ -171,6 +173,9 @@ class SWEmicpHeadTrackingWorker : public QObject
         bool m_bWorkStopped;            /**< is the work stopped ? */
 
         int m_i32Fps;                   /**< refresh rate of updateModule calling */
+        int m_i32PipelineDepth;         /**< number of frames detected ahead of the alignment, 0 (default) : no pipeline, the stages run in sequence */
+
+        bool m_bLowLatencyPipeline;     /**< the pipeline skips the stale frames */
 
         std::string m_sHeadTrackingPortName;    /**< yarp head tracking port name */
 
@@ -55,6 +55,7 @@
 #include <string>
 #include <vector>
 #include <iostream>
+#include <fstream>
 
 // BOOST
 #include <boost/scoped_ptr.hpp>
@@ -62,6 +63,11 @@
 /**
  * \class SWOpenNITracking
  * \brief This module sends OpenNI upper body skeleton data on a multitude of differents ports
+ *
+ *  The head, torso and arms ports send the joints of the first tracked user (layouts defined in SWSkeletonFrame.h),
+ *  "/tracking/joints:o" sends the upper body joints of all the tracked users : OPENNI_LIB, users nb, then for each user its id and 9 x 3 values.
+ *  With --recordSkeleton <file>, the upper body joints of all the tracked users are written in a text file, one line per user and per frame :
+ *  time, user id, 9 x 3 values (used by the teleoperation skeleton angles benchmark).
  */
 class SWOpenNITracking : public yarp::os::RFModule
 {
@@ -130,6 +136,9 @@ class SWOpenNITracking : public yarp::os::RFModule
         yarp::os::BufferedPort<yarp::os::Bottle> m_oAllJointsTrackingPort;   /**< ... */
 
         boost::scoped_ptr<swDevice::SWKinectSkeleton> m_oKinectSkeleton;     /**< kinect skeleton */
+        swDevice::SWSkeletonFrame m_oSkeletonFrame;                         /**< skeleton data of all the tracked users, reused for each grab */
+
+        std::ofstream m_oSkeletonRecord;                                    /**< skeleton record file, if opened */
 };
 
 #endif
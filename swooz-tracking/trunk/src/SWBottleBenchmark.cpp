@@ -0,0 +1,158 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWBottleBenchmark.cpp
+ * \brief Throughput of the list and binary tracking bottles formats : encoding with serialization (send), parsing and decoding.
+ *
+ *  Usage : SWBottleBenchmark [values nb = 75] [iterations nb = 100000]
+ *  No YARP server is needed, the bottles are serialized with yarp::os::Bottle::toBinary / fromBinary as done by the ports.
+ */
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+
+#include <yarp/os/Bottle.h>
+#include <yarp/os/Time.h>
+
+#include "commonTypes.h"
+#include "SWTrackingDevice.h"
+#include "SWTrackingBottle.h"
+
+/**
+ * \brief Run the benchmark of a bottle format. Each stage is timed as a whole loop of i32IterNb runs and divided by the
+ *        iterations number, a single run lasts less than a microsecond and is below the resolution of a per run timing.
+ * \param [in] eFormat      : bottle format
+ * \param [in] vDValues     : values to send
+ * \param [in] i32IterNb    : number of bottles
+ * \return false if a decoded bottle does not match the sent values
+ */
+static bool benchmark(const swTracking::BottleFormat eFormat, const std::vector<double> &vDValues, cint i32IterNb)
+{
+    yarp::os::Bottle l_oSent, l_oReceived;
+    std::vector<char> l_vBuffer;
+    swTracking::SWBottleValues l_oValues;
+
+    double l_dChecksum = 0.0;
+    size_t l_ui32WireSize = 0;
+    const char *l_aCWire = NULL;
+    int l_i32ValuesNb = static_cast<int>(vDValues.size());
+
+    // sender : fill the bottle and serialize it as done by the ports (the bottle is rewritten at each run, so it is serialized again)
+        double l_dStart = yarp::os::Time::now();
+
+        for(int ii = 0; ii < i32IterNb; ++ii)
+        {
+            swTracking::encodeBottle(l_oSent, eFormat, swTracking::LEAP_LIB, &vDValues[0], l_i32ValuesNb, l_vBuffer);
+            l_aCWire = l_oSent.toBinary(&l_ui32WireSize);
+        }
+
+        double l_dSendTime = yarp::os::Time::now() - l_dStart;
+
+    // ports : parse the serialized bottle
+        l_dStart = yarp::os::Time::now();
+
+        for(int ii = 0; ii < i32IterNb; ++ii)
+        {
+            l_oReceived.fromBinary(l_aCWire, static_cast<int>(l_ui32WireSize));
+        }
+
+        double l_dParseTime = yarp::os::Time::now() - l_dStart;
+
+    // receiver : retrieve the values
+        l_dStart = yarp::os::Time::now();
+
+        for(int ii = 0; ii < i32IterNb; ++ii)
+        {
+            if(!l_oValues.decode(l_oReceived))
+            {
+                return false;
+            }
+
+            for(int jj = 1; jj <= l_i32ValuesNb; ++jj)
+            {
+                l_dChecksum += l_oValues.get(jj);
+            }
+        }
+
+        double l_dDecodeTime = yarp::os::Time::now() - l_dStart;
+
+    // check the last decoded bottle
+        if(l_oValues.deviceId() != swTracking::LEAP_LIB || l_oValues.valuesNb() != l_i32ValuesNb)
+        {
+            return false;
+        }
+
+        for(int ii = 0; ii < l_i32ValuesNb; ++ii)
+        {
+            if(l_oValues.values()[ii] != vDValues[ii])
+            {
+                return false;
+            }
+        }
+
+    double l_dTotal = l_dSendTime + l_dParseTime + l_dDecodeTime;
+
+    printf("%-8s %8d bytes   send %7.3f us   parse %7.3f us   decode %7.3f us   total %7.3f us   %9.0f bottles/s   (checksum %g)\n",
+           eFormat == swTracking::BINARY_BOTTLE ? "binary" : "list", static_cast<int>(l_ui32WireSize),
+           1e6 * l_dSendTime / i32IterNb, 1e6 * l_dParseTime / i32IterNb, 1e6 * l_dDecodeTime / i32IterNb, 1e6 * l_dTotal / i32IterNb,
+           i32IterNb / l_dTotal, l_dChecksum);
+
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    int l_i32ValuesNb = argc > 1 ? atoi(argv[1]) : 75;
+    int l_i32IterNb   = argc > 2 ? atoi(argv[2]) : 100000;
+
+    if(l_i32ValuesNb < 1 || l_i32IterNb < 1)
+    {
+        std::cerr << "Usage : SWBottleBenchmark [values nb = 75] [iterations nb = 100000]" << std::endl;
+        return -1;
+    }
+
+    // values similar to the leap hand fingers bottles
+        std::vector<double> l_vDValues(l_i32ValuesNb);
+        for(int ii = 0; ii < l_i32ValuesNb; ++ii)
+        {
+            l_vDValues[ii] = sin(0.1 * ii) * 100.0;
+        }
+
+    std::cout << l_i32ValuesNb << " values, " << l_i32IterNb << " bottles per format" << std::endl;
+
+    bool l_bValid = benchmark(swTracking::LIST_BOTTLE, l_vDValues, l_i32IterNb) && benchmark(swTracking::BINARY_BOTTLE, l_vDValues, l_i32IterNb);
+
+    if(!l_bValid)
+    {
+        std::cerr << "-ERROR : decoded values differ from the sent ones. " << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
@@ -42,11 +42,18 @@
 #include <fstream>
 #include <vector>
 #include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
 
 #include <time.h>
 
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/thread/thread.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#define BOOST_CHRONO_HEADER_ONLY
+#include <boost/chrono.hpp>
 
 
 #include "SWTrackingDevice.h"
@@ -56,6 +63,62 @@
 // 0.52 1.04 0.87
 
 
+// ########################### binary recording format
+//  header : SWFakeRecordingHeader
+//  frames : i32FramesNb * [double time (s), double values[i32ValuesNb]]
+
+#define FAKE_RECORDING_MAGIC "SWFT"     /**< magic number of the binary recordings */
+#define FAKE_RECORDING_VERSION 2        /**< version of the binary recordings (1 : float values) */
+#define FAKE_RECORDING_NAME_SIZE 32     /**< size of the names stored in the header */
+
+/**
+ * \struct SWFakeRecordingHeader
+ * \brief Header of a binary tracking recording
+ */
+struct SWFakeRecordingHeader
+{
+    char aCMagic[4];                                /**< FAKE_RECORDING_MAGIC */
+    int32 i32Version;                               /**< FAKE_RECORDING_VERSION */
+    int32 i32FramesNb;                              /**< number of frames */
+    int32 i32ValuesNb;                              /**< number of values for each frame */
+    char aCDevice[FAKE_RECORDING_NAME_SIZE];        /**< device name */
+    char aCLib[FAKE_RECORDING_NAME_SIZE];           /**< lib name */
+    char aCRobotPart[FAKE_RECORDING_NAME_SIZE];     /**< robot part */
+    char aCLibDevice[FAKE_RECORDING_NAME_SIZE];     /**< device lib id (swTracking::DeviceLib string) */
+};
+
+/**
+ * \brief Size in bytes of one frame of a binary recording
+ */
+static int frameSize(cint i32ValuesNb)
+{
+    return static_cast<int>((1 + i32ValuesNb) * sizeof(double));
+}
+
+/**
+ * \brief Copy a string in a fixed size header field
+ */
+static void setHeaderName(char *aCField, const std::string &sName)
+{
+    std::memset(aCField, 0, FAKE_RECORDING_NAME_SIZE);
+    std::strncpy(aCField, sName.c_str(), FAKE_RECORDING_NAME_SIZE - 1);
+}
+
+/**
+ * \brief Retrieve a string from a fixed size header field
+ */
+static std::string headerName(const char *aCField)
+{
+    int l_i32Length = 0;
+    while(l_i32Length < FAKE_RECORDING_NAME_SIZE && aCField[l_i32Length] != '\0')
+    {
+        ++l_i32Length;
+    }
+
+    return std::string(aCField, l_i32Length);
+}
+
+
 int countWhiteSpaces(std::ifstream  &oFileStream)
 {
     int l_i32Pos = static_cast<int>(oFileStream.tellg());
@@ -78,36 +141,25 @@ int countWhiteSpaces(std::ifstream  &oFileStream)
     return l_i32WhiteSpaces;
 }
 
-
-int main(int argc, char* argv[])
+/**
+ * \brief Load a whitespace-separated text recording and store it with the binary recording layout
+ * \param [in]  sPathFile : path of the text file
+ * \param [out] vBuffer   : binary recording (header + frames)
+ * \return true if success
+ */
+bool loadTextRecording(const std::string &sPathFile, std::vector<char> &vBuffer)
 {
-    // initialize yarp network
-    yarp::os::Network l_oYarp;
-    if (!l_oYarp.checkNetwork())
-    {
-        std::cerr << "-ERROR: Problem connecting to YARP server" << std::endl;
-        return -1;
-    }
-
-    if(argc < 2)
-    {
-        std::cerr << "Specify a tracking data txt file to be emulated in the command line. " << std::endl;
-        return -1;
-    }
-
-    std::string l_sPathFile(argv[1]);
-
     std::ifstream  l_oFileStream;
-    l_oFileStream.open(l_sPathFile);
+    l_oFileStream.open(sPathFile.c_str());
 
     if(l_oFileStream.is_open())
     {
-        std::cout << "Data file " << l_sPathFile << " opened. " << std::endl;
+        std::cout << "Data file " << sPathFile << " opened. " << std::endl;
     }
     else
     {
-        std::cerr << "Can't open " << l_sPathFile << " file. " << std::endl;
-        return -1;
+        std::cerr << "Can't open " << sPathFile << " file. " << std::endl;
+        return false;
     }
 
     std::string l_sDevice, l_sLib, l_sRobotPart, l_sLIB_DEVICE, l_sLine;
@@ -117,11 +169,6 @@ int main(int argc, char* argv[])
     l_oFileStream >> l_sLIB_DEVICE;
     getline(l_oFileStream, l_sLine);
 
-    std::cout << "Device : " << l_sDevice << std::endl;
-    std::cout << "Lib : " << l_sLib << std::endl;
-    std::cout << "Robot part : " << l_sRobotPart << std::endl;
-    std::cout << "Lib device : " << l_sLIB_DEVICE << std::endl;
-
     bool l_bEndFile = false;
 
     std::string l_sValue = "";
@@ -159,14 +206,108 @@ int main(int argc, char* argv[])
             }
         }
 
-
-
         l_sValue = "";
     }
 
     l_oFileStream.close();
 
-    // ###################################
+    // only the complete frames are kept
+    int l_i32ValuesNb = l_i32WhiteSpaces;
+    int l_i32FramesNb = 0;
+    while(l_i32FramesNb < static_cast<int>(l_vBottlesTimes.size()) && static_cast<int>(l_vVData[l_i32FramesNb].size()) == l_i32ValuesNb)
+    {
+        ++l_i32FramesNb;
+    }
+
+    // fill the binary buffer
+    SWFakeRecordingHeader l_oHeader;
+    std::memcpy(l_oHeader.aCMagic, FAKE_RECORDING_MAGIC, 4);
+    l_oHeader.i32Version  = FAKE_RECORDING_VERSION;
+    l_oHeader.i32FramesNb = l_i32FramesNb;
+    l_oHeader.i32ValuesNb = l_i32ValuesNb;
+    setHeaderName(l_oHeader.aCDevice, l_sDevice);
+    setHeaderName(l_oHeader.aCLib, l_sLib);
+    setHeaderName(l_oHeader.aCRobotPart, l_sRobotPart);
+    setHeaderName(l_oHeader.aCLibDevice, l_sLIB_DEVICE);
+
+    int l_i32FrameSize = frameSize(l_i32ValuesNb);
+    vBuffer.resize(sizeof(SWFakeRecordingHeader) + l_i32FramesNb * l_i32FrameSize);
+    std::memcpy(&vBuffer[0], &l_oHeader, sizeof(SWFakeRecordingHeader));
+
+    for(int ii = 0; ii < l_i32FramesNb; ++ii)
+    {
+        char *l_pFrame = &vBuffer[sizeof(SWFakeRecordingHeader) + ii * l_i32FrameSize];
+        std::memcpy(l_pFrame, &l_vBottlesTimes[ii], sizeof(double));
+
+        for(int jj = 0; jj < l_i32ValuesNb; ++jj)
+        {
+            std::memcpy(l_pFrame + (1 + jj) * sizeof(double), &l_vVData[ii][jj], sizeof(double));
+        }
+    }
+
+    return true;
+}
+
+/**
+ * \brief Check the header of a binary recording
+ * \param [in] pData      : recording data
+ * \param [in] i64Size    : size of the data in bytes
+ * \return the header if the recording is valid, else NULL
+ */
+const SWFakeRecordingHeader *checkRecording(const char *pData, const int64 i64Size)
+{
+    if(i64Size < static_cast<int64>(sizeof(SWFakeRecordingHeader)))
+    {
+        std::cerr << "Invalid recording : file too small. " << std::endl;
+        return NULL;
+    }
+
+    const SWFakeRecordingHeader *l_pHeader = reinterpret_cast<const SWFakeRecordingHeader*>(pData);
+
+    if(std::memcmp(l_pHeader->aCMagic, FAKE_RECORDING_MAGIC, 4) != 0 || l_pHeader->i32Version != FAKE_RECORDING_VERSION)
+    {
+        std::cerr << "Invalid recording : bad magic number or version, convert the text recording again. " << std::endl;
+        return NULL;
+    }
+
+    if(i64Size < static_cast<int64>(sizeof(SWFakeRecordingHeader)) + static_cast<int64>(l_pHeader->i32FramesNb) * frameSize(l_pHeader->i32ValuesNb))
+    {
+        std::cerr << "Invalid recording : truncated file. " << std::endl;
+        return NULL;
+    }
+
+    return l_pHeader;
+}
+
+/**
+ * \brief Replay a binary recording on one or several yarp ports
+ * \param [in] pData      : recording data (header + frames)
+ * \param [in] dSpeed     : playback speed factor (2.0 -> two times faster), <= 0 for as fast as possible
+ * \param [in] i32PortsNb : number of ports to fan out the bottles
+ * \param [in] i32LoopsNb : number of times the recording is replayed
+ * \param [in] bPrompt    : wait for a key before starting
+ */
+void replay(const char *pData, cdouble dSpeed, cint i32PortsNb, cint i32LoopsNb, cbool bPrompt)
+{
+    const SWFakeRecordingHeader *l_pHeader = reinterpret_cast<const SWFakeRecordingHeader*>(pData);
+    const char *l_pFrames = pData + sizeof(SWFakeRecordingHeader);
+    int l_i32FrameSize = frameSize(l_pHeader->i32ValuesNb);
+
+    std::string l_sDevice    = headerName(l_pHeader->aCDevice);
+    std::string l_sLib       = headerName(l_pHeader->aCLib);
+    std::string l_sRobotPart = headerName(l_pHeader->aCRobotPart);
+    std::string l_sLIB_DEVICE= headerName(l_pHeader->aCLibDevice);
+
+    std::cout << "Device : " << l_sDevice << std::endl;
+    std::cout << "Lib : " << l_sLib << std::endl;
+    std::cout << "Robot part : " << l_sRobotPart << std::endl;
+    std::cout << "Lib device : " << l_sLIB_DEVICE << std::endl;
+    std::cout << "Frames : " << l_pHeader->i32FramesNb << " Values : " << l_pHeader->i32ValuesNb << std::endl;
+
+    if(l_pHeader->i32FramesNb == 0)
+    {
+        return;
+    }
 
     int l_i32Lib_Id = 0;
 
@@ -179,43 +320,285 @@ int main(int argc, char* argv[])
         }
     }
 
-    yarp::os::BufferedPort<yarp::os::Bottle> l_oFakeTrackingPort;
+    // open ports
     std::string l_sPortName =  "/tracking/" + l_sDevice + "/"+ l_sLib + "/" + l_sRobotPart;
-    l_oFakeTrackingPort.open(l_sPortName.c_str());
+    std::vector<yarp::os::BufferedPort<yarp::os::Bottle>*> l_vFakeTrackingPorts(i32PortsNb, NULL);
+
+    for(int ii = 0; ii < i32PortsNb; ++ii)
+    {
+        std::ostringstream l_sCurrentPortName;
+        l_sCurrentPortName << l_sPortName;
+
+        if(i32PortsNb > 1)
+        {
+            l_sCurrentPortName << "/" << ii;
+        }
+
+        l_vFakeTrackingPorts[ii] = new yarp::os::BufferedPort<yarp::os::Bottle>();
+        l_vFakeTrackingPorts[ii]->open(l_sCurrentPortName.str().c_str());
+        std::cout << "Port " << l_sCurrentPortName.str() << " opened. " << std::endl;
+    }
+
+    if(bPrompt)
+    {
+        std::cout << "Start sending bottles to " << l_sPortName << " ? " << std::endl;
+        char l_cKey;
+        std::cin >> l_cKey;
+    }
+
+    double l_dFirstTime;
+    std::memcpy(&l_dFirstTime, l_pFrames, sizeof(double));
+
+    double l_dLastTime;
+    std::memcpy(&l_dLastTime, l_pFrames + (l_pHeader->i32FramesNb - 1) * l_i32FrameSize, sizeof(double));
+
+    // mean frame period, added between the last frame of a loop and the first frame of the next one
+    double l_dFramePeriod = 0.0;
+    if(l_pHeader->i32FramesNb > 1)
+    {
+        l_dFramePeriod = (l_dLastTime - l_dFirstTime) / (l_pHeader->i32FramesNb - 1);
+    }
+
+    double l_dLoopDuration = l_dLastTime - l_dFirstTime + l_dFramePeriod;
 
-    std::cout << "Start sending bottles to " << l_sPortName << " ? " << std::endl;
-    char l_cKey;
-    std::cin >> l_cKey;
+    bool l_bAsFastAsPossible = dSpeed <= 0.0;
 
+    // jitter statistics (difference between the scheduled and the effective sending times)
+    double l_dJitterSum = 0.0, l_dJitterSquareSum = 0.0, l_dJitterMax = 0.0;
+    int64 l_i64SentNb = 0;
 
-    clock_t l_oInitialTime = clock();
+    typedef boost::chrono::steady_clock SWClock;
+    SWClock::time_point l_oStartTime = SWClock::now();
 
-    for(uint ii = 0; ii < l_vBottlesTimes.size(); ++ii)
+    for(int kk = 0; kk < i32LoopsNb; ++kk)
     {
-        double l_dTimeToWait = l_vBottlesTimes[ii] - (float)(clock() - l_oInitialTime)/CLOCKS_PER_SEC;
-        boost::this_thread::sleep(boost::posix_time::milliseconds(static_cast<int64>(1000*l_dTimeToWait)));
+        // each loop is scheduled after the previous one
+        double l_dLoopOffset = kk * l_dLoopDuration;
 
-        // stuff to do
-        yarp::os::Bottle &l_oFakeTrackingBottle = l_oFakeTrackingPort.prepare();
-        l_oFakeTrackingBottle.clear();
+        for(int ii = 0; ii < l_pHeader->i32FramesNb; ++ii)
+        {
+            const char *l_pFrame = l_pFrames + ii * l_i32FrameSize;
 
-            // device lib id
-            l_oFakeTrackingBottle.addInt(l_i32Lib_Id); //head : l_i32Lib_Id id / get(0).asInt()
+            double l_dFrameTime;
+            std::memcpy(&l_dFrameTime, l_pFrame, sizeof(double));
 
-//            std::cout << l_vBottlesTimes[ii] << " ";
+            if(!l_bAsFastAsPossible)
+            {
+                double l_dScheduledTime = (l_dLoopOffset + l_dFrameTime - l_dFirstTime) / dSpeed;
+                double l_dTimeToWait    = l_dScheduledTime - boost::chrono::duration<double>(SWClock::now() - l_oStartTime).count();
+
+                // sleep for the main part of the waiting time, then yield until the scheduled time for a better precision
+                if(l_dTimeToWait > 0.002)
+                {
+                    boost::this_thread::sleep(boost::posix_time::microseconds(static_cast<int64>(1000000*(l_dTimeToWait - 0.001))));
+                }
+
+                double l_dCurrentTime;
+                while((l_dCurrentTime = boost::chrono::duration<double>(SWClock::now() - l_oStartTime).count()) < l_dScheduledTime)
+                {
+                    boost::this_thread::yield();
+                }
+
+                double l_dJitter = l_dCurrentTime - l_dScheduledTime;
+                l_dJitterSum        += l_dJitter;
+                l_dJitterSquareSum  += l_dJitter * l_dJitter;
+                l_dJitterMax         = std::max(l_dJitterMax, l_dJitter);
+            }
 
-            for(uint jj = 0; jj < l_vVData[ii].size(); ++jj)
+            // stuff to do
+            for(int jj = 0; jj < i32PortsNb; ++jj)
             {
-                l_oFakeTrackingBottle.addDouble(l_vVData[ii][jj]);
-//                std::cout << l_vVData[ii][jj] << " ";
+                yarp::os::Bottle &l_oFakeTrackingBottle = l_vFakeTrackingPorts[jj]->prepare();
+                l_oFakeTrackingBottle.clear();
+
+                    // device lib id
+                    l_oFakeTrackingBottle.addInt(l_i32Lib_Id); //head : l_i32Lib_Id id / get(0).asInt()
+
+                    for(int ll = 0; ll < l_pHeader->i32ValuesNb; ++ll)
+                    {
+                        double l_dValue;
+                        std::memcpy(&l_dValue, l_pFrame + (1 + ll) * sizeof(double), sizeof(double));
+                        l_oFakeTrackingBottle.addDouble(l_dValue);
+                    }
+
+                l_vFakeTrackingPorts[jj]->write(); // true
             }
 
-//            std::cout << std::endl;
+            ++l_i64SentNb;
+        }
+    }
+
+    double l_dTotalTime = boost::chrono::duration<double>(SWClock::now() - l_oStartTime).count();
+
+    // report
+    std::cout << "Frames sent : " << l_i64SentNb << " on " << i32PortsNb << " port(s) in " << l_dTotalTime << " s" << std::endl;
+    std::cout << "Achieved rate : " << l_i64SentNb / check0Div(l_dTotalTime) << " frames/s";
+
+    if(!l_bAsFastAsPossible)
+    {
+        double l_dRecordingDuration = (i32LoopsNb * l_dLoopDuration - l_dFramePeriod) / dSpeed;
+        double l_dMean = l_dJitterSum / l_i64SentNb;
+        double l_dStd  = std::sqrt(std::max(0.0, l_dJitterSquareSum / l_i64SentNb - l_dMean * l_dMean));
+
+        std::cout << " | requested rate : " << (l_i64SentNb - 1) / check0Div(l_dRecordingDuration) << " frames/s" << std::endl;
+        std::cout << "Jitter : mean " << 1000.0 * l_dMean << " ms, std " << 1000.0 * l_dStd << " ms, max " << 1000.0 * l_dJitterMax << " ms" << std::endl;
+    }
+    else
+    {
+        std::cout << " (as fast as possible)" << std::endl;
+    }
+
+    for(int ii = 0; ii < i32PortsNb; ++ii)
+    {
+        l_vFakeTrackingPorts[ii]->close();
+        delete l_vFakeTrackingPorts[ii];
+    }
+}
+
+/**
+ * \brief Display the command line usage
+ */
+void displayUsage()
+{
+    std::cerr << "Usage : " << std::endl;
+    std::cerr << "  SWFakeTracking <data.txt>                           : replay a text recording" << std::endl;
+    std::cerr << "  SWFakeTracking -convert <data.txt> <data.swb>       : convert a text recording to the binary format" << std::endl;
+    std::cerr << "  SWFakeTracking -binary <data.swb> [options]         : replay a memory-mapped binary recording" << std::endl;
+    std::cerr << "Options : " << std::endl;
+    std::cerr << "  -speed <x>  : playback speed factor (default 1.0)" << std::endl;
+    std::cerr << "  -fast       : send the bottles as fast as possible" << std::endl;
+    std::cerr << "  -ports <n>  : number of ports to fan out the bottles (default 1)" << std::endl;
+    std::cerr << "  -loops <n>  : number of times the recording is replayed (default 1)" << std::endl;
+    std::cerr << "  -noprompt   : start without waiting for a key" << std::endl;
+}
+
+
+int main(int argc, char* argv[])
+{
+    if(argc < 2)
+    {
+        std::cerr << "Specify a tracking data txt file to be emulated in the command line. " << std::endl;
+        displayUsage();
+        return -1;
+    }
+
+    std::string l_sMode(argv[1]);
+
+    // conversion, no need of the yarp network
+    if(l_sMode == "-convert")
+    {
+        if(argc < 4)
+        {
+            displayUsage();
+            return -1;
+        }
+
+        std::vector<char> l_vBuffer;
+        if(!loadTextRecording(argv[2], l_vBuffer))
+        {
+            return -1;
+        }
+
+        std::ofstream l_oOutputStream(argv[3], std::ios::out | std::ios::binary);
+        if(!l_oOutputStream.is_open())
+        {
+            std::cerr << "Can't open " << argv[3] << " file. " << std::endl;
+            return -1;
+        }
+
+        l_oOutputStream.write(&l_vBuffer[0], l_vBuffer.size());
+        l_oOutputStream.close();
+
+        std::cout << "Binary recording " << argv[3] << " saved. " << std::endl;
+        return 0;
+    }
+
+    // replay options
+    double l_dSpeed = 1.0;
+    int l_i32PortsNb = 1, l_i32LoopsNb = 1;
+    bool l_bPrompt = true;
+    bool l_bBinary = (l_sMode == "-binary");
+    int l_i32FirstOption = l_bBinary ? 3 : 2;
+
+    if(l_bBinary && argc < 3)
+    {
+        displayUsage();
+        return -1;
+    }
+
+    for(int ii = l_i32FirstOption; ii < argc; ++ii)
+    {
+        std::string l_sOption(argv[ii]);
+
+        if(l_sOption == "-speed" && ii + 1 < argc)
+        {
+            l_dSpeed = atof(argv[++ii]);
+        }
+        else if(l_sOption == "-fast")
+        {
+            l_dSpeed = 0.0;
+        }
+        else if(l_sOption == "-ports" && ii + 1 < argc)
+        {
+            l_i32PortsNb = std::max(1, atoi(argv[++ii]));
+        }
+        else if(l_sOption == "-loops" && ii + 1 < argc)
+        {
+            l_i32LoopsNb = std::max(1, atoi(argv[++ii]));
+        }
+        else if(l_sOption == "-noprompt")
+        {
+            l_bPrompt = false;
+        }
+        else
+        {
+            std::cerr << "Unknown option : " << l_sOption << std::endl;
+            displayUsage();
+            return -1;
+        }
+    }
+
+    // initialize yarp network
+    yarp::os::Network l_oYarp;
+    if (!l_oYarp.checkNetwork())
+    {
+        std::cerr << "-ERROR: Problem connecting to YARP server" << std::endl;
+        return -1;
+    }
+
+    if(l_bBinary)
+    {
+        boost::iostreams::mapped_file_source l_oMappedFile;
 
-        l_oFakeTrackingPort.write(); // true
+        try
+        {
+            l_oMappedFile.open(argv[2]);
+        }
+        catch(const std::exception &e)
+        {
+            std::cerr << "Can't map " << argv[2] << " file : " << e.what() << std::endl;
+            return -1;
+        }
+
+        if(!checkRecording(l_oMappedFile.data(), static_cast<int64>(l_oMappedFile.size())))
+        {
+            return -1;
+        }
+
+        replay(l_oMappedFile.data(), l_dSpeed, l_i32PortsNb, l_i32LoopsNb, l_bPrompt);
+
+        l_oMappedFile.close();
     }
+    else
+    {
+        std::vector<char> l_vBuffer;
+        if(!loadTextRecording(argv[1], l_vBuffer))
+        {
+            return -1;
+        }
 
-    l_oFakeTrackingPort.close();
+        replay(&l_vBuffer[0], l_dSpeed, l_i32PortsNb, l_i32LoopsNb, l_bPrompt);
+    }
 
     // terminate network
     yarp::os::Network::fini();
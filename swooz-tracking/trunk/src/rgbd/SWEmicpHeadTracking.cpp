@@ -50,7 +50,7 @@ using namespace swExcept;
 
 SWEmicpHeadTrackingWorker::SWEmicpHeadTrackingWorker() : m_oCaptureHeadMotion(swCloud::SWCaptureHeadMotion(20,20)),
     m_bIsRGBDDeviceInitialized(true), m_bVerbose(false), m_bDoWork(true), m_i32Fps(100), m_pCurrentFaceRect(NULL), m_pCurrentNoseRect(NULL),
-    m_pCurrentRigidMotion(NULL), m_pCurrCloud(NULL),m_pReferenceCloud(NULL), m_bWorkStopped(true)
+    m_pCurrentRigidMotion(NULL), m_pCurrCloud(NULL),m_pReferenceCloud(NULL), m_bWorkStopped(true), m_i32PipelineDepth(0), m_bLowLatencyPipeline(false)
 {        
     // set yarp port name
         std::string l_sDeviceName   = "rgbd";
@@ -127,6 +127,13 @@ void SWEmicpHeadTrackingWorker::doWork()
     m_bDoWork     = true;
     m_bWorkStopped= false;
 
+    // the detection of the next frames runs on its own thread during the alignment of the current one
+    boost::scoped_ptr<swCloud::SWHeadMotionPipeline> l_pHeadMotionPipeline;
+
+    if(m_i32PipelineDepth > 0 || m_bLowLatencyPipeline)
+    {
+        l_pHeadMotionPipeline.reset(new swCloud::SWHeadMotionPipeline(&m_oCaptureHeadMotion, m_i32PipelineDepth, m_bLowLatencyPipeline));
+    }
 
     while(l_bContinueLoop)
     {
@@ -141,8 +148,16 @@ void SWEmicpHeadTrackingWorker::doWork()
             }
 
         // tracking
+            // the frame id is read before the images, a frame read twice keeps its id
+            uint l_ui32FrameId = m_oKinectThread.frameId();
             cv::Mat l_oBGR   = m_oKinectThread.bgrImage();
 
+            // the pipeline keeps a shallow copy of the frame, the kinect buffer must not be modified while it is detected
+            if(l_pHeadMotionPipeline)
+            {
+                l_oBGR = l_oBGR.clone();
+            }
+
             for(int ii = 0; ii < l_oBGR.rows/5; ++ii)
             {
                 for(int jj = 0; jj < l_oBGR.cols; ++jj)
@@ -170,9 +185,32 @@ void SWEmicpHeadTrackingWorker::doWork()
             swCloud::SWRigidMotion l_oRigidMotion;
 
             m_oParametersMutex.lockForRead();
-                int l_i32Res = m_oCaptureHeadMotion.computeHeadMotion(l_oRigidMotion, l_oBGR, l_oCloud, l_oRGBDetect);
+                int l_i32Res;
+
+                if(l_pHeadMotionPipeline)
+                {
+                    l_i32Res = l_pHeadMotionPipeline->computeHeadMotion(l_oRigidMotion, l_oBGR, l_oCloud, l_oRGBDetect, static_cast<int>(l_ui32FrameId));
+                }
+                else
+                {
+                    l_i32Res = m_oCaptureHeadMotion.computeHeadMotion(l_oRigidMotion, l_oBGR, l_oCloud, l_oRGBDetect);
+                }
             m_oParametersMutex.unlock();
 
+            // no result yet, the pipeline is filling
+            if(l_i32Res == 2)
+            {
+                continue;
+            }
+
+            swCloud::SWHeadMotionTimings l_oTimings = m_oCaptureHeadMotion.lastTimings();
+
+            if(m_bVerbose)
+            {
+                std::cout << "Stages (ms) : background " << l_oTimings.m_dBackground << " face " << l_oTimings.m_dFaceDetection << " nose " << l_oTimings.m_dNose
+                          << " cloud " << l_oTimings.m_dCloud << " alignment " << l_oTimings.m_dAlignment << " latency " << l_oTimings.m_dLatency << std::endl;
+            }
+
             if(l_i32Res == -1)
             {
                 std::cerr << "ERROR : Capture head motion, invalid result, neutral rigid motion used. " << std::endl;
@@ -263,9 +301,16 @@ void SWEmicpHeadTrackingWorker::doWork()
             // compute total delay between the getting of the kinect data and the send of the bottle conainting the rigid motion
                 float l_fDelay = (float)(clock() - l_oFirstTime) / CLOCKS_PER_SEC;
 
+                if(l_pHeadMotionPipeline)
+                {
+                    // the frame of the result has been given by a previous loop
+                    l_fDelay = static_cast<float>(l_oTimings.m_dLatency * 0.001);
+                }
+
             // send the delay to be displayed in a widget
                 emit sendDelay(l_fDelay);
     }
+    l_pHeadMotionPipeline.reset();
     m_oCaptureHeadMotion.reset();
     m_bWorkStopped = true;
 }
@@ -297,7 +342,8 @@ void SWEmicpHeadTrackingWorker::configure(yarp::os::ResourceFinder &pRF)
         std::cout << "Configure Emicp head tracking module. " << std::endl;
     }
 
-    // ...
+    m_i32PipelineDepth      = pRF.check("pipelineDepth", yarp::os::Value(0), "Number of frames detected ahead of the alignment, 0 (default) to run the stages in sequence (int)").asInt();
+    m_bLowLatencyPipeline   = pRF.check("lowLatency", yarp::os::Value(0), "Skip the stale frames in the pipeline (int)").asInt() != 0;
 }
 
 // ########################### SWEmicpHeadTrackingInterface
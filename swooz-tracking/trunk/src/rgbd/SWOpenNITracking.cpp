@@ -37,6 +37,8 @@
 #include "geometryUtility.h"
 #include "SWExceptions.h"
 
+#include <yarp/os/Time.h>
+
 
 SWOpenNITracking::SWOpenNITracking()
     :m_IsOpenNiInitialized(false)
@@ -107,10 +109,43 @@ bool SWOpenNITracking::interruptModule() {
 
 bool SWOpenNITracking::configure(yarp::os::ResourceFinder & rf)
 {
-	// nothing
+    std::string l_sRecordFile = rf.check("recordSkeleton", yarp::os::Value(""), "Skeleton record file (string)").asString();
+
+    if(l_sRecordFile.size() > 0)
+    {
+        m_oSkeletonRecord.open(l_sRecordFile.c_str());
+
+        if(!m_oSkeletonRecord.is_open())
+        {
+            std::cerr << "-ERROR : can't open the skeleton record file : " << l_sRecordFile << std::endl;
+            return false;
+        }
+
+        std::cout << "Recording the skeleton in : " << l_sRecordFile << std::endl;
+    }
+
 	return true;
 }
 
+/**
+ * @brief Fill a tracking bottle with a subset of the joints of a user.
+ * @param [out] oBottle     : bottle to fill
+ * @param [in]  aJoints     : user joints in the UpperBody profile order
+ * @param [in]  aJointsId   : joints to add
+ * @param [in]  i32JointsNb : number of joints to add
+ */
+static void fillJointsBottle(yarp::os::Bottle &oBottle, const swUtil::SWVec3d *aJoints, const int *aJointsId, const int i32JointsNb)
+{
+    oBottle.clear();
+    oBottle.addInt(swTracking::OPENNI_LIB);
+
+    for(int ii = 0; ii < i32JointsNb; ++ii)
+    {
+        const swUtil::SWVec3d &l_joint = aJoints[aJointsId[ii]];
+        oBottle.addDouble(l_joint[0]);  oBottle.addDouble(l_joint[1]);  oBottle.addDouble(l_joint[2]);
+    }
+}
+
 
 bool SWOpenNITracking::updateModule()
 {
@@ -119,69 +154,59 @@ bool SWOpenNITracking::updateModule()
 		return false;
 	}
 
-	std::vector<swDevice::SWKinectSkeleton::Coordinates> l_values;
-    if (m_oKinectSkeleton->grab(l_values) == 0)
+    if (m_oKinectSkeleton->grab(m_oSkeletonFrame) == 0)
 	{
-		swDevice::SWKinectSkeleton::Coordinates l_pointTorso		= l_values[0];
-		swDevice::SWKinectSkeleton::Coordinates l_pointNeck			= l_values[1];
-		swDevice::SWKinectSkeleton::Coordinates l_pointHead			= l_values[2];
-		swDevice::SWKinectSkeleton::Coordinates l_pointLShoulder	= l_values[3];
-		swDevice::SWKinectSkeleton::Coordinates l_pointRShoulder	= l_values[4];
-		swDevice::SWKinectSkeleton::Coordinates l_pointLElbow		= l_values[5];
-		swDevice::SWKinectSkeleton::Coordinates l_pointRElbow		= l_values[6];
-		swDevice::SWKinectSkeleton::Coordinates l_pointLHand		= l_values[7];
-		swDevice::SWKinectSkeleton::Coordinates l_pointRHand		= l_values[8];
-
-        yarp::os::Bottle & l_HeadBottle		= m_oHeadTrackingPort.prepare();
-		l_HeadBottle.clear();
-			l_HeadBottle.addInt(swTracking::OPENNI_LIB);
-			l_HeadBottle.addDouble(l_pointNeck.X);			l_HeadBottle.addDouble(l_pointNeck.Y);			l_HeadBottle.addDouble(l_pointNeck.Z);
-			l_HeadBottle.addDouble(l_pointHead.X);			l_HeadBottle.addDouble(l_pointHead.Y);			l_HeadBottle.addDouble(l_pointHead.Z);
-			l_HeadBottle.addDouble(l_pointLShoulder.X);		l_HeadBottle.addDouble(l_pointLShoulder.Y);		l_HeadBottle.addDouble(l_pointLShoulder.Z);
-			l_HeadBottle.addDouble(l_pointRShoulder.X);		l_HeadBottle.addDouble(l_pointRShoulder.Y);		l_HeadBottle.addDouble(l_pointRShoulder.Z);
+        // first tracked user on the body parts ports
+        const swUtil::SWVec3d *l_aJoints = m_oSkeletonFrame.m_aUsers[0].m_aJoints;
+
+        fillJointsBottle(m_oHeadTrackingPort.prepare(),     l_aJoints, swDevice::OPENNI_HEAD_JOINTS,      swDevice::OPENNI_HEAD_JOINTS_NB);
         m_oHeadTrackingPort.write();
 
-        yarp::os::Bottle & l_TorsoBottle 	= m_oTorsoTrackingPort.prepare();
-		l_TorsoBottle.clear();
-			l_TorsoBottle.addInt(swTracking::OPENNI_LIB);
-			l_TorsoBottle.addDouble(l_pointTorso.X);		l_TorsoBottle.addDouble(l_pointTorso.Y);		l_TorsoBottle.addDouble(l_pointTorso.Z);
-			l_TorsoBottle.addDouble(l_pointNeck.X);			l_TorsoBottle.addDouble(l_pointNeck.Y);			l_TorsoBottle.addDouble(l_pointNeck.Z);
-			l_TorsoBottle.addDouble(l_pointLShoulder.X);	l_TorsoBottle.addDouble(l_pointLShoulder.Y);	l_TorsoBottle.addDouble(l_pointLShoulder.Z);
-			l_TorsoBottle.addDouble(l_pointRShoulder.X);	l_TorsoBottle.addDouble(l_pointRShoulder.Y);	l_TorsoBottle.addDouble(l_pointRShoulder.Z);
+        fillJointsBottle(m_oTorsoTrackingPort.prepare(),    l_aJoints, swDevice::OPENNI_TORSO_JOINTS,     swDevice::OPENNI_TORSO_JOINTS_NB);
         m_oTorsoTrackingPort.write();
 
-        yarp::os::Bottle & l_LeftArmBottle 	= m_oLeftArmTrackingPort.prepare();
-		l_LeftArmBottle.clear();
-			l_LeftArmBottle.addInt(swTracking::OPENNI_LIB);
-			l_LeftArmBottle.addDouble(l_pointTorso.X);		l_LeftArmBottle.addDouble(l_pointTorso.Y);		l_LeftArmBottle.addDouble(l_pointTorso.Z);
-			l_LeftArmBottle.addDouble(l_pointNeck.X);		l_LeftArmBottle.addDouble(l_pointNeck.Y);		l_LeftArmBottle.addDouble(l_pointNeck.Z);
-			l_LeftArmBottle.addDouble(l_pointLShoulder.X);	l_LeftArmBottle.addDouble(l_pointLShoulder.Y);	l_LeftArmBottle.addDouble(l_pointLShoulder.Z);
-			l_LeftArmBottle.addDouble(l_pointLElbow.X);		l_LeftArmBottle.addDouble(l_pointLElbow.Y);		l_LeftArmBottle.addDouble(l_pointLElbow.Z);
-			l_LeftArmBottle.addDouble(l_pointLHand.X);		l_LeftArmBottle.addDouble(l_pointLHand.Y);		l_LeftArmBottle.addDouble(l_pointLHand.Z);
+        fillJointsBottle(m_oLeftArmTrackingPort.prepare(),  l_aJoints, swDevice::OPENNI_LEFT_ARM_JOINTS,  swDevice::OPENNI_ARM_JOINTS_NB);
         m_oLeftArmTrackingPort.write();
 
-        yarp::os::Bottle & l_RightArmBottle = m_oRightArmTrackingPort.prepare();
-		l_RightArmBottle.clear();
-			l_RightArmBottle.addInt(swTracking::OPENNI_LIB);
-			l_RightArmBottle.addDouble(l_pointTorso.X);		l_RightArmBottle.addDouble(l_pointTorso.Y);		l_RightArmBottle.addDouble(l_pointTorso.Z);
-			l_RightArmBottle.addDouble(l_pointNeck.X);		l_RightArmBottle.addDouble(l_pointNeck.Y);		l_RightArmBottle.addDouble(l_pointNeck.Z);
-			l_RightArmBottle.addDouble(l_pointRShoulder.X);	l_RightArmBottle.addDouble(l_pointRShoulder.Y);	l_RightArmBottle.addDouble(l_pointRShoulder.Z);
-			l_RightArmBottle.addDouble(l_pointRElbow.X);	l_RightArmBottle.addDouble(l_pointRElbow.Y);	l_RightArmBottle.addDouble(l_pointRElbow.Z);
-			l_RightArmBottle.addDouble(l_pointRHand.X);		l_RightArmBottle.addDouble(l_pointRHand.Y);		l_RightArmBottle.addDouble(l_pointRHand.Z);
-        m_oRightArmTrackingPort.write();      
-
+        fillJointsBottle(m_oRightArmTrackingPort.prepare(), l_aJoints, swDevice::OPENNI_RIGHT_ARM_JOINTS, swDevice::OPENNI_ARM_JOINTS_NB);
+        m_oRightArmTrackingPort.write();
 
+        // all the tracked users on the joints port
         yarp::os::Bottle &l_allJointsBottle = m_oAllJointsTrackingPort.prepare();
         l_allJointsBottle.clear();
-            l_HeadBottle.addDouble(l_pointNeck.X);			l_HeadBottle.addDouble(l_pointNeck.Y);			l_HeadBottle.addDouble(l_pointNeck.Z);
-            l_HeadBottle.addDouble(l_pointHead.X);			l_HeadBottle.addDouble(l_pointHead.Y);			l_HeadBottle.addDouble(l_pointHead.Z);
-            l_HeadBottle.addDouble(l_pointLShoulder.X);		l_HeadBottle.addDouble(l_pointLShoulder.Y);		l_HeadBottle.addDouble(l_pointLShoulder.Z);
-            l_HeadBottle.addDouble(l_pointRShoulder.X);		l_HeadBottle.addDouble(l_pointRShoulder.Y);		l_HeadBottle.addDouble(l_pointRShoulder.Z);
-            l_TorsoBottle.addDouble(l_pointTorso.X);		l_TorsoBottle.addDouble(l_pointTorso.Y);		l_TorsoBottle.addDouble(l_pointTorso.Z);
-            l_LeftArmBottle.addDouble(l_pointLElbow.X);		l_LeftArmBottle.addDouble(l_pointLElbow.Y);		l_LeftArmBottle.addDouble(l_pointLElbow.Z);
-            l_RightArmBottle.addDouble(l_pointRElbow.X);	l_RightArmBottle.addDouble(l_pointRElbow.Y);	l_RightArmBottle.addDouble(l_pointRElbow.Z);
-            l_LeftArmBottle.addDouble(l_pointLHand.X);		l_LeftArmBottle.addDouble(l_pointLHand.Y);		l_LeftArmBottle.addDouble(l_pointLHand.Z);
-            l_RightArmBottle.addDouble(l_pointRHand.X);		l_RightArmBottle.addDouble(l_pointRHand.Y);		l_RightArmBottle.addDouble(l_pointRHand.Z);
+        l_allJointsBottle.addInt(swTracking::OPENNI_LIB);
+        l_allJointsBottle.addInt(m_oSkeletonFrame.m_i32UsersNb);
+
+        double l_dTime = yarp::os::Time::now();
+
+        for(int ii = 0; ii < m_oSkeletonFrame.m_i32UsersNb; ++ii)
+        {
+            const swDevice::SWSkeletonUser &l_user = m_oSkeletonFrame.m_aUsers[ii];
+            l_allJointsBottle.addInt(l_user.m_i32Id);
+
+            if(m_oSkeletonRecord.is_open())
+            {
+                m_oSkeletonRecord << l_dTime << " " << l_user.m_i32Id;
+            }
+
+            for(int jj = 0; jj < swDevice::UB_JOINTS_NB; ++jj)
+            {
+                for(int kk = 0; kk < 3; ++kk)
+                {
+                    l_allJointsBottle.addDouble(l_user.m_aJoints[jj][kk]);
+
+                    if(m_oSkeletonRecord.is_open())
+                    {
+                        m_oSkeletonRecord << " " << l_user.m_aJoints[jj][kk];
+                    }
+                }
+            }
+
+            if(m_oSkeletonRecord.is_open())
+            {
+                m_oSkeletonRecord << "\n";
+            }
+        }
         m_oAllJointsTrackingPort.write();
 	}
 
@@ -203,16 +228,16 @@ int main(int argc, char **argv)
     SWOpenNITracking l_OpenNITracking;
 
     // prepare and configure the resource finder
-//    yarp::os::ResourceFinder rf;
-//    rf.setVerbose(true);
-//    rf.setDefaultConfigFile("openniTracking.ini");
-//    rf.setDefaultContext("swtracking/conf");
-//    rf.configure("YARP_DIR", argc, argv);
-
-//    if(l_OpenNITracking.configure(rf))
-//    {
-         l_OpenNITracking.runModule();
-//    }
+    yarp::os::ResourceFinder rf;
+    rf.setVerbose(true);
+    rf.setDefaultConfigFile("openniTracking.ini");
+    rf.setDefaultContext("swooz-tracking/conf");
+    rf.configure("ICUB_ROOT", argc, argv);
+
+    if(l_OpenNITracking.configure(rf))
+    {
+        l_OpenNITracking.runModule();
+    }
 
     std::cout << "Ending OpenNI Skeleton capture module..." << std::endl;
 }
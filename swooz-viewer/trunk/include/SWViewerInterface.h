@@ -285,14 +285,21 @@ class SWViewerWorker : public QObject
 
         /**
          * \brief constructor of SWViewerWorker
+         * \param [in] pGLMultiObject : GL widget receiving the animation data
          */
-        SWViewerWorker();
+        SWViewerWorker(SWGLMultiObjectWidget *pGLMultiObject);
 
         /**
          * \brief destructor of SWViewerWorker
          */
 //        ~SWViewerWorker();
 
+        /**
+         * \brief Display the animation period statistics at the end of each loop (disabled by default)
+         * \param [in] bVerbose : display the statistics ?
+         */
+        void setVerbosePacing(cbool bVerbose);
+
 
     public slots:
 
@@ -366,13 +373,6 @@ class SWViewerWorker : public QObject
          */
         void startAnimation(bool, int);
 
-        /**
-         * @brief sendOffsetAnimation
-         */
-//        void sendOffsetAnimation(bool, int, QVector<float>, QVector<float>, QVector<float>, QVector<float>, int);
-        void sendOffsetAnimation(SWAnimationSendDataPtr);
-
-
         /**
          * @brief drawSceneSignal
          */
@@ -383,6 +383,10 @@ class SWViewerWorker : public QObject
 
         int m_i32LoopPeriod;    /**< loop period */
 
+        bool m_bVerbosePacing;  /**< display the animation period statistics ? */
+
+        SWGLMultiObjectWidget *m_pGLMultiObject; /**< GL widget, the animation data is written in its animation channels */
+
         bool m_bDoLoop;
 
         QReadWriteLock m_oLoopMutex;    /**< mutex for the main worker loop */
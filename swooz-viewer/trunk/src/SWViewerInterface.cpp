@@ -38,6 +38,8 @@
 
 #include <QCheckBox>
 #include <time.h>
+#include <cmath>
+#include <algorithm>
 
 
 SWViewerInterface::SWViewerInterface(QApplication *parent) : m_uiViewer(new Ui::SWUI_Viewer), m_bDesactiveUpdateParameters(false), m_bGLFullScreen(false)
@@ -65,7 +67,12 @@ SWViewerInterface::SWViewerInterface(QApplication *parent) : m_uiViewer(new Ui::
         m_uiViewer->glScene->addWidget(m_pGLContainer);
 
     // init worker
-        m_pWViewer = new SWViewerWorker();
+        m_pWViewer = new SWViewerWorker(m_pGLMultiObject);
+
+    // frame pacing statistics, displayed only with the -verbosePacing argument
+        cbool l_bVerbosePacing = parent->arguments().contains("-verbosePacing");
+        m_pGLMultiObject->setVerbosePacing(l_bVerbosePacing);
+        m_pWViewer->setVerbosePacing(l_bVerbosePacing);
 
     // init connections
         // menu
@@ -149,8 +156,6 @@ SWViewerInterface::SWViewerInterface(QApplication *parent) : m_uiViewer(new Ui::
             QObject::connect(m_pWViewer, SIGNAL(sendAnimationPathFile(QString,QString,QString)), this, SLOT(updateAnimationPathFileDisplay(QString,QString,QString)));
             QObject::connect(this, SIGNAL(deleteAnimation(bool,int)), m_pWViewer, SLOT(deleteAnimation(bool,int)));
             QObject::connect(this, SIGNAL(addAnimation(bool)), m_pWViewer, SLOT(addAnimation(bool)));
-            QObject::connect(m_pWViewer, SIGNAL(sendOffsetAnimation(SWAnimationSendDataPtr)),m_pGLMultiObject, SLOT(setAnimationOffset(SWAnimationSendDataPtr)),Qt::DirectConnection);
-//            QObject::connect(m_pWViewer, SIGNAL(sendOffsetAnimation(SWAnimationSendDataPtr)),m_pGLMultiObject, SLOT(setAnimationOffset(SWAnimationSendDataPtr)));
             QObject::connect(m_pWViewer, SIGNAL(startAnimation(bool,int)), m_pGLMultiObject, SLOT(beginAnimation(bool,int)));
 
             QObject::connect(m_pWViewer, SIGNAL(drawSceneSignal()), m_pGLMultiObject, SLOT(updateGL()));
@@ -803,7 +808,7 @@ int main(int argc, char* argv[])
     return l_app.exec();
 }
 
-SWViewerWorker::SWViewerWorker() : m_i32LoopPeriod(1000/60)
+SWViewerWorker::SWViewerWorker(SWGLMultiObjectWidget *pGLMultiObject) : m_i32LoopPeriod(1000/60), m_bVerbosePacing(false), m_pGLMultiObject(pGLMultiObject)
 {
     m_bDoLoop = true;
 
@@ -829,7 +834,26 @@ void SWViewerWorker::startLoop()
     QVector<bool> l_currentAnimCloud(m_vCloudsAnimation.size(),true);
     QVector<bool> l_currentAnimMesh(m_vMeshesAnimation.size(),true);
 
-    clock_t l_oProgramTime = clock();
+    // retrieve the animation channels of the widget, the slots are preallocated and reused for each frame
+    QVector<SWAnimationTripleBufferPtr> l_cloudsAnimationBuffer(m_vCloudsAnimation.size());
+    QVector<SWAnimationTripleBufferPtr> l_meshesAnimationBuffer(m_vMeshesAnimation.size());
+
+    for(int ii = 0; ii < l_cloudsAnimationBuffer.size(); ++ii)
+    {
+        l_cloudsAnimationBuffer[ii] = m_pGLMultiObject->animationBuffer(true, ii);
+        l_currentAnimCloud[ii] = (l_cloudsAnimationBuffer[ii].get() != NULL);
+    }
+    for(int ii = 0; ii < l_meshesAnimationBuffer.size(); ++ii)
+    {
+        l_meshesAnimationBuffer[ii] = m_pGLMultiObject->animationBuffer(false, ii);
+        l_currentAnimMesh[ii] = (l_meshesAnimationBuffer[ii].get() != NULL);
+    }
+
+    // frame pacing
+    QTime l_oPacingTime;
+    l_oPacingTime.start();
+    double l_dPeriodSum = 0., l_dPeriodSquareSum = 0.;
+    int l_i32PeriodMax = 0;
 
     while(l_bDoLoop)
     {
@@ -838,7 +862,14 @@ void SWViewerWorker::startLoop()
             {
                 QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents, m_i32LoopPeriod - l_oStartTime.elapsed());
             }
-            l_oStartTime.restart();
+
+            int l_i32Period = l_oStartTime.restart();
+            if(l_numLine > 0)
+            {
+                l_dPeriodSum += l_i32Period;
+                l_dPeriodSquareSum += l_i32Period * l_i32Period;
+                l_i32PeriodMax = std::max(l_i32PeriodMax, l_i32Period);
+            }
 
 
             bool l_cloudAnimStillRunning = false;
@@ -874,23 +905,24 @@ void SWViewerWorker::startLoop()
                     continue;
                 }
 
-                SWAnimationSendDataPtr dataToSend = SWAnimationSendDataPtr(new SWAnimationSendData());
-                dataToSend->m_index = ii;
-                dataToSend->m_isCloud = true;
+                SWAnimationSendData &dataToSend = l_cloudsAnimationBuffer[ii]->backSlot();
+                dataToSend.m_index = ii;
+                dataToSend.m_isCloud = true;
 
-                if(!m_vCloudsAnimation[ii].retrieveTransfosToApply(l_numLine, dataToSend->m_animationOffsetsX,
-                                    dataToSend->m_animationOffsetsY,dataToSend->m_animationOffsetsZ,dataToSend->m_animationRigidMotion))
+                if(!m_vCloudsAnimation[ii].retrieveTransfosToApply(l_numLine, dataToSend.m_animationOffsetsX,
+                                    dataToSend.m_animationOffsetsY,dataToSend.m_animationOffsetsZ,dataToSend.m_animationRigidMotion))
                 {
                     l_currentAnimCloud[ii] = false;
                 }
                 else
                 {
+                    l_cloudsAnimationBuffer[ii]->publish();
+
                     if(l_numLine == 0)
                     {
                         emit startAnimation(true, ii);
                     }
-                    emit sendOffsetAnimation(dataToSend);
-                }                
+                }
             }
             for(int ii = 0; ii < m_vMeshesAnimation.size(); ++ii)
             {
@@ -899,23 +931,23 @@ void SWViewerWorker::startLoop()
                     continue;
                 }
 
-                SWAnimationSendDataPtr dataToSend = SWAnimationSendDataPtr(new SWAnimationSendData());
-                dataToSend->m_index = ii;
-                dataToSend->m_isCloud = false;
+                SWAnimationSendData &dataToSend = l_meshesAnimationBuffer[ii]->backSlot();
+                dataToSend.m_index = ii;
+                dataToSend.m_isCloud = false;
 
-                if(!m_vMeshesAnimation[ii].retrieveTransfosToApply(l_numLine, dataToSend->m_animationOffsetsX,
-                                    dataToSend->m_animationOffsetsY,dataToSend->m_animationOffsetsZ,dataToSend->m_animationRigidMotion))
+                if(!m_vMeshesAnimation[ii].retrieveTransfosToApply(l_numLine, dataToSend.m_animationOffsetsX,
+                                    dataToSend.m_animationOffsetsY,dataToSend.m_animationOffsetsZ,dataToSend.m_animationRigidMotion))
                 {
                     l_currentAnimMesh[ii] = false;
                 }
                 else
                 {
+                    l_meshesAnimationBuffer[ii]->publish();
+
                     if(l_numLine == 0)
                     {
                         emit startAnimation(false, ii);
                     }
-
-                    emit sendOffsetAnimation(dataToSend);
                 }
             }
 
@@ -928,6 +960,21 @@ void SWViewerWorker::startLoop()
 
             emit drawSceneSignal();
     }
+
+    // display the worker frame pacing
+    if(m_bVerbosePacing && l_numLine > 1)
+    {
+        double l_dPeriodMean = l_dPeriodSum / (l_numLine - 1);
+        double l_dPeriodStd  = sqrt(std::max(0., l_dPeriodSquareSum / (l_numLine - 1) - l_dPeriodMean * l_dPeriodMean));
+
+        qDebug() << "[SWViewerWorker] animation frames : " << l_numLine << " in " << l_oPacingTime.elapsed() << " ms | period target : " << m_i32LoopPeriod
+                 << " ms, mean : " << l_dPeriodMean << " ms, std : " << l_dPeriodStd << " ms, max : " << l_i32PeriodMax << " ms";
+    }
+}
+
+void SWViewerWorker::setVerbosePacing(cbool bVerbose)
+{
+    m_bVerbosePacing = bVerbose;
 }
 
 void SWViewerWorker::stopLoop()